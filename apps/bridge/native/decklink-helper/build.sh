@@ -11,6 +11,22 @@ INCLUDE_DIR="${SDK_ROOT}/Mac/include"
 FRAMEWORK_PATH="${DECKLINK_FRAMEWORK_PATH:-/Library/Frameworks}"
 DISPATCH_SRC="${INCLUDE_DIR}/DeckLinkAPIDispatch.cpp"
 
+# The playout scheduler has no SDK dependency; its mock-output test runs
+# before the helper is built. The meeting-helper CMake build runs it too.
+TEST_DIR="$(mktemp -d)"
+trap 'rm -rf "${TEST_DIR}"' EXIT
+clang++ \
+  -std=c++17 \
+  -Wall \
+  -Wextra \
+  -O2 \
+  -I "${SRC_DIR}" \
+  "${ROOT_DIR}/../meeting-helper/tests/decklink_playout_scheduler_test.cpp" \
+  "${SRC_DIR}/playout_scheduler.cpp" \
+  -o "${TEST_DIR}/playout-scheduler-test"
+"${TEST_DIR}/playout-scheduler-test"
+echo "Playout scheduler test passed"
+
 if [[ ! -d "${INCLUDE_DIR}" ]]; then
   echo "DeckLink SDK headers not found at ${INCLUDE_DIR}" >&2
   exit 1
@@ -34,6 +50,7 @@ clang++ \
   -framework DeckLinkAPI \
   "${DISPATCH_SRC}" \
   "${SRC_DIR}/decklink-helper.cpp" \
+  "${SRC_DIR}/playout_scheduler.cpp" \
   -o "${OUT_DIR}/decklink-helper"
 
 echo "Built ${OUT_DIR}/decklink-helper"
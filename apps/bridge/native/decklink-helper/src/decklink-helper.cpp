@@ -5,6 +5,7 @@
     --list       : print JSON array of devices to stdout
     --watch      : print JSON events (one per line) to stdout
     --list-modes : print JSON array of display modes for a device
+    --playback   : play FrameBus/stdin RGBA frames on one or more outputs
 */
 
 #include <DeckLinkAPI.h>
@@ -22,6 +23,7 @@
 #include <deque>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <csignal>
@@ -34,9 +36,18 @@
 #include <sys/stat.h>
 
 #include "../../framebus/include/framebus.h"
+#include "playout_scheduler.h"
 
 namespace {
 
+using broadify::decklink::ConvertedFrame;
+using broadify::decklink::PlayoutBatch;
+using broadify::decklink::PlayoutCompletion;
+using broadify::decklink::PlayoutFormat;
+using broadify::decklink::PlayoutScheduler;
+using broadify::decklink::PlayoutSink;
+using broadify::decklink::PlayoutStats;
+
 std::atomic<bool> gShouldExit{false};
 const REFIID kIID_IUnknown = CFUUIDGetUUIDBytes(IUnknownUUID);
 constexpr uint8_t kLegalMin = 16;
@@ -214,9 +225,7 @@ bool parseColorspaceLabel(const std::string& value,
   return false;
 }
 
-struct PlaybackConfig;
-
-bool parseOutputPort(const PlaybackConfig& config,
+bool parseOutputPort(const std::string& portId,
                      std::string& outDeviceId,
                      BMDVideoConnection& outConnection);
 
@@ -248,7 +257,7 @@ public:
   FrameBufferLock() = default;
   ~FrameBufferLock() { release(); }
 
-  bool acquire(IDeckLinkMutableVideoFrame* frame, BMDBufferAccessFlags flags) {
+  bool acquire(IDeckLinkVideoFrame* frame, BMDBufferAccessFlags flags) {
     release();
     if (!frame) {
       return false;
@@ -583,17 +592,23 @@ private:
   std::atomic<ULONG> refCount;
 };
 
-struct PlaybackConfig {
+// One playout port: a single video output or an external key/fill pair.
+struct OutputConfig {
   std::string deviceId;
-  int width = 0;
-  int height = 0;
-  double fps = 0;
   std::string outputPortId;
   std::string fillPortId;
   std::string keyPortId;
   std::vector<BMDPixelFormat> pixelFormatPriority;
   bool useLegalRange = true;
   BMDColorspace colorspaceOverride = bmdColorspaceUnknown;
+};
+
+struct PlaybackConfig {
+  int width = 0;
+  int height = 0;
+  double fps = 0;
+  // All outputs play the same source from one reader.
+  std::vector<OutputConfig> outputs;
   std::string frameBusName;
   size_t frameBusSize = 0;
 };
@@ -623,6 +638,7 @@ constexpr uint16_t kFrameTypeFrame = 1;
 constexpr uint16_t kFrameTypeShutdown = 2;
 constexpr size_t kFrameHeaderSize = 28;
 constexpr size_t kMaxQueuedFrames = 4;
+constexpr size_t kPrerollFrames = 3;
 
 struct FrameBusReader {
   int fd = -1;
@@ -630,6 +646,8 @@ struct FrameBusReader {
   size_t size = 0;
   FrameBusHeader* header = nullptr;
   uint8_t* slots = nullptr;
+  // Geometry at open; the loop reopens once the live header departs from it.
+  FrameBusSegmentGeometry geometry{};
 };
 
 #ifndef bmdSupportedVideoModeDefault
@@ -713,12 +731,19 @@ bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::strin
     error = "FrameBus header invalid";
     return false;
   }
+  if ((header->flags & FRAMEBUS_FLAG_RETIRED) != 0) {
+    munmap(base, totalSize);
+    close(fd);
+    error = "FrameBus segment retired";
+    return false;
+  }
 
   out.fd = fd;
   out.base = static_cast<uint8_t*>(base);
   out.size = totalSize;
   out.header = header;
   out.slots = out.base + FRAMEBUS_HEADER_SIZE;
+  out.geometry = framebus_segment_geometry(header);
   return true;
 }
 
@@ -767,65 +792,6 @@ bool discardBytes(int fd, size_t length) {
   return true;
 }
 
-class FrameQueue {
-public:
-  void push(std::vector<uint8_t>&& frame) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (frames.size() >= kMaxQueuedFrames) {
-      frames.pop_front();
-    }
-    frames.push_back(std::move(frame));
-  }
-
-  bool pop(std::vector<uint8_t>& out) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (frames.empty()) {
-      return false;
-    }
-    out = std::move(frames.front());
-    frames.pop_front();
-    return true;
-  }
-
-  bool empty() const {
-    std::lock_guard<std::mutex> lock(mutex);
-    return frames.empty();
-  }
-
-private:
-  mutable std::mutex mutex;
-  std::deque<std::vector<uint8_t>> frames;
-};
-
-struct PlaybackState {
-  IDeckLinkOutput* output = nullptr;
-  BMDPixelFormat pixelFormat = bmdFormat8BitARGB;
-  BMDPixelFormat sourcePixelFormat = bmdFormat8BitBGRA;
-  BMDColorspace colorspace = bmdColorspaceUnknown;
-  BMDTimeValue frameDuration = 0;
-  BMDTimeScale timeScale = 0;
-  BMDTimeValue nextFrameTime = 0;
-  int width = 0;
-  int height = 0;
-  bool useLegalRange = true;
-  bool started = false;
-  size_t prerollTarget = 3;
-  size_t prerollScheduled = 0;
-  FrameQueue queue;
-  std::vector<uint8_t> lastFrame;
-  bool hasLastFrame = false;
-  IDeckLinkVideoConversion* converter = nullptr;
-  std::chrono::steady_clock::time_point lastBufferedLog =
-      std::chrono::steady_clock::now();
-  std::chrono::steady_clock::time_point lastCompletionLog =
-      std::chrono::steady_clock::now();
-  uint64_t completedFrames = 0;
-  uint64_t lateFrames = 0;
-  uint64_t droppedFrames = 0;
-  bool sampleLogged = false;
-  int debugLogFramesRemaining = 2;
-};
-
 bool isYuvPixelFormat(BMDPixelFormat format) {
   return format == bmdFormat8BitYUV || format == bmdFormat10BitYUV;
 }
@@ -923,249 +889,340 @@ bool convertRgbaToOutputRows(const uint8_t* src,
   return true;
 }
 
-bool scheduleFrame(PlaybackState& state, const std::vector<uint8_t>& frameData) {
-  if (!state.output || frameData.empty()) {
-    std::cerr << "[DeckLinkHelper] ScheduleFrame aborted: "
-              << (!state.output ? "output=null" : "frameData=empty")
-              << std::endl;
-    return false;
-  }
+// Produces the frame an output schedules, once per distinct PlayoutFormat.
+// The result is a DeckLink frame every output sharing the format schedules
+// as is: RGB formats are range-mapped and swizzled straight into it, YUV
+// formats go through a reused BGRA frame and the SDK converter, whose output
+// frame is kept. Frames are allocated from the first output, which every
+// output accepts as a conversion source.
+class DeckLinkFrameConverter {
+public:
+  explicit DeckLinkFrameConverter(IDeckLinkOutput* output) : output_(output) {}
 
-  const bool shouldLogDetails = state.debugLogFramesRemaining > 0;
-  if (shouldLogDetails) {
-    state.debugLogFramesRemaining -= 1;
-  }
-
-  const bool shouldLogSamples = !state.sampleLogged;
-  if (shouldLogSamples) {
-    const size_t inputSize =
-        static_cast<size_t>(state.width) * static_cast<size_t>(state.height) * 4;
-    std::cerr << "[DeckLinkHelper] Input RGBA samples (rowBytes="
-              << (state.width * 4) << "): "
-              << formatSampleSet(frameData.data(),
-                                 inputSize,
-                                 state.width,
-                                 state.height,
-                                 state.width * 4)
-              << std::endl;
+  ~DeckLinkFrameConverter() {
+    if (sourceFrame_) {
+      sourceFrame_->Release();
+    }
+    if (converter_) {
+      converter_->Release();
+    }
   }
 
-  IDeckLinkVideoFrame* scheduledFrame = nullptr;
-
-  if (isYuvPixelFormat(state.pixelFormat)) {
-    if (!state.converter) {
-      state.converter = CreateVideoConversionInstance();
-      if (!state.converter) {
-        std::cerr << "Failed to create video conversion instance." << std::endl;
-        return false;
-      }
-    }
+  DeckLinkFrameConverter(const DeckLinkFrameConverter&) = delete;
+  DeckLinkFrameConverter& operator=(const DeckLinkFrameConverter&) = delete;
 
-    int32_t srcRowBytes = 0;
-    HRESULT srcRowBytesResult = state.output->RowBytesForPixelFormat(
-        state.sourcePixelFormat, state.width, &srcRowBytes);
-    if (srcRowBytesResult != S_OK) {
-      std::cerr << "[DeckLinkHelper] RowBytesForPixelFormat failed (source): "
-                << "format=" << pixelFormatLabel(state.sourcePixelFormat)
-                << " width=" << state.width << " height=" << state.height
-                << " hresult=0x" << std::hex
-                << static_cast<uint32_t>(srcRowBytesResult) << std::dec
+  bool convert(const uint8_t* rgba,
+               int width,
+               int height,
+               const PlayoutFormat& format,
+               ConvertedFrame& out) {
+    if (!inputSampleLogged_) {
+      std::cerr << "[DeckLinkHelper] Input RGBA samples (rowBytes="
+                << (width * 4) << "): "
+                << formatSampleSet(rgba,
+                                   static_cast<size_t>(width) * height * 4,
+                                   width,
+                                   height,
+                                   width * 4)
                 << std::endl;
-      return false;
-    }
-    if (shouldLogDetails) {
-      std::cerr << "[DeckLinkHelper] RowBytesForPixelFormat (source) ok: "
-                << "format=" << pixelFormatLabel(state.sourcePixelFormat)
-                << " rowBytes=" << srcRowBytes << std::endl;
-    }
-
-    IDeckLinkMutableVideoFrame* srcFrame = nullptr;
-    HRESULT srcCreateResult = state.output->CreateVideoFrame(
-        state.width,
-        state.height,
-        srcRowBytes,
-        state.sourcePixelFormat,
-        bmdFrameFlagDefault,
-        &srcFrame);
-    if (srcCreateResult != S_OK) {
-      std::cerr << "[DeckLinkHelper] CreateVideoFrame failed (source): "
-                << "format=" << pixelFormatLabel(state.sourcePixelFormat)
-                << " width=" << state.width << " height=" << state.height
-                << " rowBytes=" << srcRowBytes << " hresult=0x" << std::hex
-                << static_cast<uint32_t>(srcCreateResult) << std::dec
-                << std::endl;
-      return false;
-    }
-    if (shouldLogDetails) {
-      std::cerr << "[DeckLinkHelper] CreateVideoFrame (source) ok: "
-                << "format=" << pixelFormatLabel(state.sourcePixelFormat)
-                << " width=" << state.width << " height=" << state.height
-                << " rowBytes=" << srcRowBytes << std::endl;
+      inputSampleLogged_ = true;
     }
 
-    FrameBufferLock srcLock;
-    if (!srcLock.acquire(srcFrame, bmdBufferAccessWrite)) {
-      std::cerr << "[DeckLinkHelper] getFrameBytes failed (source)" << std::endl;
-      srcFrame->Release();
+    const BMDPixelFormat pixelFormat = static_cast<BMDPixelFormat>(format.pixelFormat);
+    const bool converted = isYuvPixelFormat(pixelFormat)
+                               ? convertYuv(rgba, width, height, format, out)
+                               : convertRgb(rgba, width, height, format, out);
+    if (!converted) {
       return false;
     }
 
-    if (!convertRgbaToOutputRows(frameData.data(),
-                                 static_cast<uint8_t*>(srcLock.bytes()),
-                                 state.width,
-                                 state.height,
-                                 srcRowBytes,
-                                 state.sourcePixelFormat,
-                                 state.useLegalRange)) {
-      std::cerr << "Unsupported pixel format for RGBA conversion: "
-                << pixelFormatLabel(state.sourcePixelFormat) << std::endl;
-      srcFrame->Release();
-      return false;
-    }
-    if (shouldLogSamples) {
-      const size_t srcSize = static_cast<size_t>(srcRowBytes) *
-                             static_cast<size_t>(state.height);
-      std::cerr << "[DeckLinkHelper] Output samples (pre-YUV "
-                << pixelFormatLabel(state.sourcePixelFormat) << ", rowBytes="
-                << srcRowBytes << ", range="
-                << (state.useLegalRange ? "legal" : "full") << "): "
-                << formatSampleSet(static_cast<uint8_t*>(srcLock.bytes()),
-                                   srcSize,
-                                   state.width,
-                                   state.height,
-                                   srcRowBytes)
-                << std::endl;
-      state.sampleLogged = true;
+    if (std::find(sampledFormats_.begin(), sampledFormats_.end(), format) ==
+        sampledFormats_.end()) {
+      auto* frame = static_cast<IDeckLinkVideoFrame*>(out.deviceFrame.get());
+      FrameBufferLock sampleLock;
+      if (sampleLock.acquire(frame, bmdBufferAccessRead)) {
+        std::cerr << "[DeckLinkHelper] Output samples ("
+                  << pixelFormatLabel(pixelFormat) << ", rowBytes="
+                  << out.rowBytes << ", range="
+                  << (format.legalRange ? "legal" : "full") << "): "
+                  << formatSampleSet(static_cast<const uint8_t*>(sampleLock.bytes()),
+                                     static_cast<size_t>(out.rowBytes) * height,
+                                     width,
+                                     height,
+                                     out.rowBytes)
+                  << std::endl;
+      }
+      sampledFormats_.push_back(format);
     }
+    return true;
+  }
 
-    srcLock.release();
-    HRESULT converted = state.converter->ConvertNewFrame(
-        srcFrame, state.pixelFormat, state.colorspace, nullptr, &scheduledFrame);
-    srcFrame->Release();
-    if (converted != S_OK || !scheduledFrame) {
-      std::cerr << "ConvertNewFrame failed. HRESULT=0x" << std::hex
-                << static_cast<uint32_t>(converted) << std::dec << std::endl;
-      return false;
-    }
-  } else {
-    IDeckLinkMutableVideoFrame* frame = nullptr;
+private:
+  // Hands one reference to `frame` to `out`. It is released when the pooled
+  // ConvertedFrame is reused; the SDK keeps its own for as long as the frame
+  // is scheduled.
+  static void adoptDeviceFrame(ConvertedFrame& out, IDeckLinkVideoFrame* frame) {
+    out.deviceFrame = std::shared_ptr<void>(frame, [](void* held) {
+      static_cast<IDeckLinkVideoFrame*>(held)->Release();
+    });
+  }
+
+  IDeckLinkMutableVideoFrame* createFrame(BMDPixelFormat pixelFormat,
+                                          int width,
+                                          int height,
+                                          const char* role) {
     int32_t rowBytes = 0;
-    HRESULT rowBytesResult =
-        state.output->RowBytesForPixelFormat(state.pixelFormat,
-                                             state.width,
-                                             &rowBytes);
+    const HRESULT rowBytesResult =
+        output_->RowBytesForPixelFormat(pixelFormat, width, &rowBytes);
     if (rowBytesResult != S_OK) {
-      std::cerr << "[DeckLinkHelper] RowBytesForPixelFormat failed (output): "
-                << "format=" << pixelFormatLabel(state.pixelFormat)
-                << " width=" << state.width << " height=" << state.height
+      std::cerr << "[DeckLinkHelper] RowBytesForPixelFormat failed (" << role << "): "
+                << "format=" << pixelFormatLabel(pixelFormat)
+                << " width=" << width << " height=" << height
                 << " hresult=0x" << std::hex
                 << static_cast<uint32_t>(rowBytesResult) << std::dec
                 << std::endl;
-      return false;
+      return nullptr;
     }
-    if (shouldLogDetails) {
-      std::cerr << "[DeckLinkHelper] RowBytesForPixelFormat (output) ok: "
-                << "format=" << pixelFormatLabel(state.pixelFormat)
-                << " rowBytes=" << rowBytes << std::endl;
-    }
-
-    HRESULT createResult = state.output->CreateVideoFrame(state.width,
-                                                          state.height,
-                                                          rowBytes,
-                                                          state.pixelFormat,
-                                                          bmdFrameFlagDefault,
-                                                          &frame);
-    if (createResult != S_OK) {
-      std::cerr << "[DeckLinkHelper] CreateVideoFrame failed (output): "
-                << "format=" << pixelFormatLabel(state.pixelFormat)
-                << " width=" << state.width << " height=" << state.height
+
+    IDeckLinkMutableVideoFrame* frame = nullptr;
+    const HRESULT createResult = output_->CreateVideoFrame(width,
+                                                           height,
+                                                           rowBytes,
+                                                           pixelFormat,
+                                                           bmdFrameFlagDefault,
+                                                           &frame);
+    if (createResult != S_OK || !frame) {
+      std::cerr << "[DeckLinkHelper] CreateVideoFrame failed (" << role << "): "
+                << "format=" << pixelFormatLabel(pixelFormat)
+                << " width=" << width << " height=" << height
                 << " rowBytes=" << rowBytes << " hresult=0x" << std::hex
-                << static_cast<uint32_t>(createResult) << std::dec << std::endl;
-      return false;
+                << static_cast<uint32_t>(createResult) << std::dec
+                << std::endl;
+      return nullptr;
     }
-    if (shouldLogDetails) {
-      std::cerr << "[DeckLinkHelper] CreateVideoFrame (output) ok: "
-                << "format=" << pixelFormatLabel(state.pixelFormat)
-                << " width=" << state.width << " height=" << state.height
-                << " rowBytes=" << rowBytes << std::endl;
+    return frame;
+  }
+
+  bool convertRgb(const uint8_t* rgba,
+                  int width,
+                  int height,
+                  const PlayoutFormat& format,
+                  ConvertedFrame& out) {
+    const BMDPixelFormat pixelFormat = static_cast<BMDPixelFormat>(format.pixelFormat);
+    // A fresh frame each time: the previous one may still be queued on an
+    // output.
+    IDeckLinkMutableVideoFrame* frame = createFrame(pixelFormat, width, height, "output");
+    if (!frame) {
+      return false;
     }
+    adoptDeviceFrame(out, frame);
 
     FrameBufferLock frameLock;
     if (!frameLock.acquire(frame, bmdBufferAccessWrite)) {
       std::cerr << "[DeckLinkHelper] getFrameBytes failed (output)" << std::endl;
-      frame->Release();
       return false;
     }
-
-    if (!convertRgbaToOutputRows(frameData.data(),
+    out.rowBytes = static_cast<int>(frame->GetRowBytes());
+    if (!convertRgbaToOutputRows(rgba,
                                  static_cast<uint8_t*>(frameLock.bytes()),
-                                 state.width,
-                                 state.height,
-                                 rowBytes,
-                                 state.pixelFormat,
-                                 state.useLegalRange)) {
+                                 width,
+                                 height,
+                                 out.rowBytes,
+                                 pixelFormat,
+                                 format.legalRange)) {
       std::cerr << "Unsupported pixel format for RGBA conversion: "
-                << pixelFormatLabel(state.pixelFormat) << std::endl;
-      frame->Release();
+                << pixelFormatLabel(pixelFormat) << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  bool convertYuv(const uint8_t* rgba,
+                  int width,
+                  int height,
+                  const PlayoutFormat& format,
+                  ConvertedFrame& out) {
+    if (!converter_) {
+      converter_ = CreateVideoConversionInstance();
+      if (!converter_) {
+        std::cerr << "Failed to create video conversion instance." << std::endl;
+        return false;
+      }
+    }
+
+    // The BGRA source is only read during ConvertNewFrame, so one frame
+    // serves every conversion of this size.
+    if (sourceFrame_ && (sourceFrame_->GetWidth() != width ||
+                         sourceFrame_->GetHeight() != height)) {
+      sourceFrame_->Release();
+      sourceFrame_ = nullptr;
+    }
+    if (!sourceFrame_) {
+      sourceFrame_ = createFrame(kSourcePixelFormat, width, height, "source");
+      if (!sourceFrame_) {
+        return false;
+      }
+    }
+
+    FrameBufferLock srcLock;
+    if (!srcLock.acquire(sourceFrame_, bmdBufferAccessWrite)) {
+      std::cerr << "[DeckLinkHelper] getFrameBytes failed (source)" << std::endl;
       return false;
     }
-    if (shouldLogSamples) {
-      const size_t outSize =
-          static_cast<size_t>(rowBytes) * static_cast<size_t>(state.height);
-      std::cerr << "[DeckLinkHelper] Output samples ("
-                << pixelFormatLabel(state.pixelFormat) << ", rowBytes="
-                << rowBytes << ", range="
-                << (state.useLegalRange ? "legal" : "full") << "): "
-                << formatSampleSet(static_cast<uint8_t*>(frameLock.bytes()),
-                                   outSize,
-                                   state.width,
-                                   state.height,
-                                   rowBytes)
+    convertRgbaToOutputRows(rgba,
+                            static_cast<uint8_t*>(srcLock.bytes()),
+                            width,
+                            height,
+                            static_cast<int>(sourceFrame_->GetRowBytes()),
+                            kSourcePixelFormat,
+                            format.legalRange);
+    srcLock.release();
+
+    // The converted frame is what the outputs schedule; nothing copies it.
+    IDeckLinkVideoFrame* yuvFrame = nullptr;
+    const HRESULT converted = converter_->ConvertNewFrame(
+        sourceFrame_,
+        static_cast<BMDPixelFormat>(format.pixelFormat),
+        static_cast<BMDColorspace>(format.colorspace),
+        nullptr,
+        &yuvFrame);
+    if (converted != S_OK || !yuvFrame) {
+      std::cerr << "ConvertNewFrame failed. HRESULT=0x" << std::hex
+                << static_cast<uint32_t>(converted) << std::dec << std::endl;
+      return false;
+    }
+    adoptDeviceFrame(out, yuvFrame);
+    out.rowBytes = static_cast<int>(yuvFrame->GetRowBytes());
+    return true;
+  }
+
+  static constexpr BMDPixelFormat kSourcePixelFormat = bmdFormat8BitBGRA;
+
+  IDeckLinkOutput* output_ = nullptr;
+  IDeckLinkVideoConversion* converter_ = nullptr;
+  IDeckLinkMutableVideoFrame* sourceFrame_ = nullptr;
+  bool inputSampleLogged_ = false;
+  std::vector<PlayoutFormat> sampledFormats_;
+};
+
+class DeckLinkPlaybackCallback;
+
+// One enabled DeckLink output. Owns its SDK interfaces; shutdown() (also run
+// by the destructor) stops playback and releases them in SDK order.
+class DeckLinkOutputSink : public PlayoutSink {
+public:
+  ~DeckLinkOutputSink() override { shutdown(); }
+
+  PlayoutFormat format() const override {
+    PlayoutFormat result;
+    result.pixelFormat = pixelFormat;
+    result.colorspace = isYuvPixelFormat(pixelFormat) ? colorspace : 0;
+    result.legalRange = useLegalRange;
+    return result;
+  }
+
+  int64_t frameDuration() const override { return frameTicks; }
+
+  bool schedule(const ConvertedFrame& frame, int64_t streamTime) override;
+
+  bool start() override {
+    const HRESULT startResult = output->StartScheduledPlayback(0, timeScale, 1.0);
+    if (startResult != S_OK) {
+      std::cerr << "StartScheduledPlayback failed (" << label << "). HRESULT=0x"
+                << std::hex << static_cast<uint32_t>(startResult) << std::dec
                 << std::endl;
-      state.sampleLogged = true;
+      return false;
     }
+    playbackStarted = true;
+    return true;
+  }
+
+  void shutdown();
+
+  std::string label;
+  IDeckLink* deckLink = nullptr;
+  IDeckLinkOutput* output = nullptr;
+  IDeckLinkKeyer* keyer = nullptr;
+  DeckLinkPlaybackCallback* callback = nullptr;
+  BMDPixelFormat pixelFormat = bmdFormat8BitARGB;
+  BMDColorspace colorspace = bmdColorspaceUnknown;
+  BMDTimeValue frameTicks = 0;
+  BMDTimeScale timeScale = 0;
+  int width = 0;
+  int height = 0;
+  bool useLegalRange = true;
+  bool videoEnabled = false;
+  bool keyerEnabled = false;
+  bool playbackStarted = false;
+  std::chrono::steady_clock::time_point lastBufferedLog =
+      std::chrono::steady_clock::now();
+  int debugLogFramesRemaining = 2;
+};
 
-    frameLock.release();
-    scheduledFrame = frame;
+bool DeckLinkOutputSink::schedule(const ConvertedFrame& frame, int64_t streamTime) {
+  if (!output || frame.width != width || frame.height != height ||
+      !frame.deviceFrame) {
+    std::cerr << "[DeckLinkHelper] ScheduleFrame aborted (" << label << "): "
+              << (!output ? "output=null" : "frame mismatch") << std::endl;
+    return false;
   }
 
-  HRESULT scheduled = state.output->ScheduleVideoFrame(
-      scheduledFrame, state.nextFrameTime, state.frameDuration, state.timeScale);
+  const bool shouldLogDetails = debugLogFramesRemaining > 0;
+  if (shouldLogDetails) {
+    debugLogFramesRemaining -= 1;
+  }
+
+  // The conversion already rendered into a DeckLink frame shared by every
+  // output with this format; scheduling hands it over without copying.
+  auto* videoFrame = static_cast<IDeckLinkVideoFrame*>(frame.deviceFrame.get());
+  if (shouldLogDetails) {
+    std::cerr << "[DeckLinkHelper] Scheduling converted frame: "
+              << "port=" << label
+              << " format=" << pixelFormatLabel(pixelFormat)
+              << " width=" << width << " height=" << height
+              << " rowBytes=" << frame.rowBytes << std::endl;
+  }
+
+  const HRESULT scheduled =
+      output->ScheduleVideoFrame(videoFrame, streamTime, frameTicks, timeScale);
   if (scheduled != S_OK) {
-    std::cerr << "ScheduleVideoFrame failed. HRESULT=0x" << std::hex
-              << static_cast<uint32_t>(scheduled) << std::dec;
+    std::cerr << "ScheduleVideoFrame failed (" << label << "). HRESULT=0x"
+              << std::hex << static_cast<uint32_t>(scheduled) << std::dec;
     if (shouldLogDetails) {
-      std::cerr << " nextFrameTime=" << state.nextFrameTime
-                << " frameDuration=" << state.frameDuration
-                << " timeScale=" << state.timeScale;
+      std::cerr << " nextFrameTime=" << streamTime
+                << " frameDuration=" << frameTicks
+                << " timeScale=" << timeScale;
     }
     std::cerr << std::endl;
-    scheduledFrame->Release();
     return false;
   }
 
-  auto now = std::chrono::steady_clock::now();
-  if (now - state.lastBufferedLog >= std::chrono::seconds(2)) {
+  const auto now = std::chrono::steady_clock::now();
+  if (now - lastBufferedLog >= std::chrono::seconds(2)) {
     uint32_t bufferedCount = 0;
-    HRESULT countResult = state.output->GetBufferedVideoFrameCount(&bufferedCount);
+    const HRESULT countResult = output->GetBufferedVideoFrameCount(&bufferedCount);
     if (countResult == S_OK) {
-      std::cerr << "Buffered video frame count: " << bufferedCount << std::endl;
+      std::cerr << "Buffered video frame count (" << label
+                << "): " << bufferedCount << std::endl;
     } else {
       std::cerr << "GetBufferedVideoFrameCount failed. HRESULT=0x" << std::hex
                 << static_cast<uint32_t>(countResult) << std::dec << std::endl;
     }
-    state.lastBufferedLog = now;
+    lastBufferedLog = now;
   }
 
-  state.nextFrameTime += state.frameDuration;
-  scheduledFrame->Release();
   return true;
 }
 
 class DeckLinkPlaybackCallback : public IDeckLinkVideoOutputCallback {
 public:
-  explicit DeckLinkPlaybackCallback(PlaybackState* state)
-      : refCount(1), playbackState(state) {}
+  DeckLinkPlaybackCallback(PlayoutScheduler* scheduler,
+                           size_t outputIndex,
+                           std::string label)
+      : refCount(1),
+        scheduler(scheduler),
+        outputIndex(outputIndex),
+        label(std::move(label)) {}
 
   HRESULT QueryInterface(REFIID iid, void** ppv) override {
     if (!ppv) {
@@ -1197,43 +1254,34 @@ public:
   HRESULT ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame,
                                   BMDOutputFrameCompletionResult result) override {
     (void)completedFrame;
-    if (!playbackState) {
+    if (!scheduler) {
       return S_OK;
     }
 
-    playbackState->completedFrames += 1;
+    PlayoutCompletion completion = PlayoutCompletion::kCompleted;
     switch (result) {
       case bmdOutputFrameDisplayedLate:
-        playbackState->lateFrames += 1;
+        completion = PlayoutCompletion::kLate;
         break;
       case bmdOutputFrameDropped:
       case bmdOutputFrameFlushed:
-        playbackState->droppedFrames += 1;
+        completion = PlayoutCompletion::kDropped;
         break;
       case bmdOutputFrameCompleted:
       default:
         break;
     }
-    auto now = std::chrono::steady_clock::now();
-    if (now - playbackState->lastCompletionLog >= std::chrono::seconds(1)) {
-      std::cerr << "Playback stats: completed="
-                << playbackState->completedFrames
-                << " late=" << playbackState->lateFrames
-                << " dropped=" << playbackState->droppedFrames << std::endl;
-      playbackState->lastCompletionLog = now;
-    }
+    scheduler->onCompleted(outputIndex, completion);
 
-    std::vector<uint8_t> frameData;
-    if (!playbackState->queue.pop(frameData)) {
-      if (playbackState->hasLastFrame) {
-        frameData = playbackState->lastFrame;
-      }
-    }
-
-    if (!frameData.empty()) {
-      playbackState->lastFrame = frameData;
-      playbackState->hasLastFrame = true;
-      scheduleFrame(*playbackState, frameData);
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastCompletionLog >= std::chrono::seconds(1)) {
+      const PlayoutStats stats = scheduler->stats(outputIndex);
+      std::cerr << "Playback stats (" << label << "): completed="
+                << stats.completed << " late=" << stats.late
+                << " dropped=" << stats.dropped
+                << " repeated=" << stats.repeated
+                << " superseded=" << stats.superseded << std::endl;
+      lastCompletionLog = now;
     }
     return S_OK;
   }
@@ -1244,9 +1292,47 @@ public:
 
 private:
   std::atomic<ULONG> refCount;
-  PlaybackState* playbackState = nullptr;
+  PlayoutScheduler* scheduler = nullptr;
+  size_t outputIndex = 0;
+  std::string label;
+  std::chrono::steady_clock::time_point lastCompletionLog =
+      std::chrono::steady_clock::now();
 };
 
+void DeckLinkOutputSink::shutdown() {
+  if (output) {
+    if (playbackStarted) {
+      output->StopScheduledPlayback(0, nullptr, 0);
+      playbackStarted = false;
+    }
+    if (keyer && keyerEnabled) {
+      keyer->Disable();
+      keyerEnabled = false;
+    }
+    if (videoEnabled) {
+      output->DisableVideoOutput();
+      videoEnabled = false;
+    }
+    output->SetScheduledFrameCompletionCallback(nullptr);
+  }
+  if (callback) {
+    callback->Release();
+    callback = nullptr;
+  }
+  if (keyer) {
+    keyer->Release();
+    keyer = nullptr;
+  }
+  if (output) {
+    output->Release();
+    output = nullptr;
+  }
+  if (deckLink) {
+    deckLink->Release();
+    deckLink = nullptr;
+  }
+}
+
 bool matchDeckLinkId(IDeckLink* deckLink, const std::string& targetId) {
   if (!deckLink) {
     return false;
@@ -1448,9 +1534,7 @@ bool listDisplayModes(const ModeListConfig& config, std::ostream& out) {
 
   std::string outputDeviceId;
   BMDVideoConnection outputConnection = bmdVideoConnectionUnspecified;
-  PlaybackConfig portConfig;
-  portConfig.outputPortId = config.outputPortId;
-  if (!parseOutputPort(portConfig, outputDeviceId, outputConnection) ||
+  if (!parseOutputPort(config.outputPortId, outputDeviceId, outputConnection) ||
       outputDeviceId != config.deviceId) {
     std::cerr << "Output port does not match the selected device."
               << std::endl;
@@ -1585,10 +1669,10 @@ bool listDisplayModes(const ModeListConfig& config, std::ostream& out) {
   return true;
 }
 
-bool parseOutputPort(const PlaybackConfig& config,
+bool parseOutputPort(const std::string& portId,
                      std::string& outDeviceId,
                      BMDVideoConnection& outConnection) {
-  if (config.outputPortId.empty()) {
+  if (portId.empty()) {
     return false;
   }
 
@@ -1596,18 +1680,18 @@ bool parseOutputPort(const PlaybackConfig& config,
   const std::string sdiSuffix = "-sdi";
   const std::string hdmiSuffix = "-hdmi";
 
-  if (config.outputPortId.size() <= sdiSuffix.size() ||
-      config.outputPortId.size() <= hdmiSuffix.size()) {
+  if (portId.size() <= sdiSuffix.size() ||
+      portId.size() <= hdmiSuffix.size()) {
     return false;
   }
 
-  if (config.outputPortId.size() >= sdiFillSuffix.size() &&
-      config.outputPortId.compare(
-          config.outputPortId.size() - sdiFillSuffix.size(),
+  if (portId.size() >= sdiFillSuffix.size() &&
+      portId.compare(
+          portId.size() - sdiFillSuffix.size(),
           sdiFillSuffix.size(),
           sdiFillSuffix) == 0) {
-    outDeviceId = config.outputPortId.substr(
-        0, config.outputPortId.size() - sdiFillSuffix.size());
+    outDeviceId = portId.substr(
+        0, portId.size() - sdiFillSuffix.size());
     if (outDeviceId.empty()) {
       return false;
     }
@@ -1615,13 +1699,13 @@ bool parseOutputPort(const PlaybackConfig& config,
     return true;
   }
 
-  if (config.outputPortId.size() >= sdiSuffix.size() &&
-      config.outputPortId.compare(
-          config.outputPortId.size() - sdiSuffix.size(),
+  if (portId.size() >= sdiSuffix.size() &&
+      portId.compare(
+          portId.size() - sdiSuffix.size(),
           sdiSuffix.size(),
           sdiSuffix) == 0) {
-    outDeviceId = config.outputPortId.substr(
-        0, config.outputPortId.size() - sdiSuffix.size());
+    outDeviceId = portId.substr(
+        0, portId.size() - sdiSuffix.size());
     if (outDeviceId.empty()) {
       return false;
     }
@@ -1629,13 +1713,13 @@ bool parseOutputPort(const PlaybackConfig& config,
     return true;
   }
 
-  if (config.outputPortId.size() >= hdmiSuffix.size() &&
-      config.outputPortId.compare(
-          config.outputPortId.size() - hdmiSuffix.size(),
+  if (portId.size() >= hdmiSuffix.size() &&
+      portId.compare(
+          portId.size() - hdmiSuffix.size(),
           hdmiSuffix.size(),
           hdmiSuffix) == 0) {
-    outDeviceId = config.outputPortId.substr(
-        0, config.outputPortId.size() - hdmiSuffix.size());
+    outDeviceId = portId.substr(
+        0, portId.size() - hdmiSuffix.size());
     if (outDeviceId.empty()) {
       return false;
     }
@@ -1696,45 +1780,156 @@ bool configureOutputConnection(IDeckLink* deckLink,
   return setResult == S_OK;
 }
 
-int runPlayback(const PlaybackConfig& config) {
-  if (config.deviceId.empty() || config.width <= 0 || config.height <= 0 ||
-      config.fps <= 0) {
+bool parsePixelFormatPriority(const std::string& value,
+                              char separator,
+                              std::vector<BMDPixelFormat>& out) {
+  out.clear();
+  std::stringstream stream(value);
+  std::string token;
+  while (std::getline(stream, token, separator)) {
+    if (token.empty()) {
+      continue;
+    }
+    BMDPixelFormat format = bmdFormatUnspecified;
+    if (!parsePixelFormatLabel(token, format)) {
+      std::cerr << "Unknown pixel format: " << token << std::endl;
+      return false;
+    }
+    out.push_back(format);
+  }
+  return true;
+}
+
+// Parses an additional playout port given as `--output key=value,...`:
+//   port=<id> | fill=<id>,key=<id>   (required)
+//   device=<id>                      (default: derived from the port)
+//   pixel-format=<label> | pixel-format-priority=<label>|<label>
+//   range=legal|full, colorspace=<label>
+// Unset pixel format, range and colorspace inherit the primary output's.
+bool parseOutputSpec(const std::string& spec,
+                     const OutputConfig& defaults,
+                     OutputConfig& out) {
+  out = OutputConfig{};
+  out.pixelFormatPriority = defaults.pixelFormatPriority;
+  out.useLegalRange = defaults.useLegalRange;
+  out.colorspaceOverride = defaults.colorspaceOverride;
+
+  std::stringstream stream(spec);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    const size_t equals = item.find('=');
+    const std::string key = item.substr(0, equals);
+    const std::string value =
+        equals == std::string::npos ? std::string() : item.substr(equals + 1);
+    if (value.empty()) {
+      std::cerr << "Invalid output spec entry: " << item << std::endl;
+      return false;
+    }
+    if (key == "device") {
+      out.deviceId = value;
+    } else if (key == "port") {
+      out.outputPortId = value;
+    } else if (key == "fill") {
+      out.fillPortId = value;
+    } else if (key == "key") {
+      out.keyPortId = value;
+    } else if (key == "pixel-format" || key == "pixel-format-priority") {
+      if (!parsePixelFormatPriority(value, '|', out.pixelFormatPriority) ||
+          out.pixelFormatPriority.empty()) {
+        std::cerr << "Invalid pixel format for output: " << value << std::endl;
+        return false;
+      }
+    } else if (key == "range") {
+      if (value != "legal" && value != "full") {
+        std::cerr << "Unknown range: " << value << std::endl;
+        return false;
+      }
+      out.useLegalRange = value == "legal";
+    } else if (key == "colorspace") {
+      if (!parseColorspaceLabel(value, out.colorspaceOverride)) {
+        std::cerr << "Unknown colorspace: " << value << std::endl;
+        return false;
+      }
+    } else {
+      std::cerr << "Unknown output spec key: " << key << std::endl;
+      return false;
+    }
+  }
+
+  if (out.deviceId.empty()) {
+    const std::string fillSuffix = "-sdi-a";
+    BMDVideoConnection connection = bmdVideoConnectionUnspecified;
+    if (!out.outputPortId.empty()) {
+      parseOutputPort(out.outputPortId, out.deviceId, connection);
+    } else if (out.fillPortId.size() > fillSuffix.size()) {
+      out.deviceId =
+          out.fillPortId.substr(0, out.fillPortId.size() - fillSuffix.size());
+    }
+  }
+  if (out.deviceId.empty() ||
+      (out.outputPortId.empty() && out.fillPortId.empty() && out.keyPortId.empty())) {
+    std::cerr << "Output spec needs a port or fill/key pair: " << spec << std::endl;
+    return false;
+  }
+  return true;
+}
+
+std::string outputLabel(const OutputConfig& output) {
+  if (!output.fillPortId.empty() || !output.keyPortId.empty()) {
+    return output.fillPortId + "+" + output.keyPortId;
+  }
+  return output.outputPortId;
+}
+
+// Validates one output's ports, picks its display mode and pixel format and
+// enables video (and the external keyer). On failure the sink's destructor
+// releases whatever was acquired.
+bool openPlaybackOutput(const PlaybackConfig& config,
+                        const OutputConfig& outputConfig,
+                        DeckLinkOutputSink& sink) {
+  if (outputConfig.deviceId.empty()) {
     std::cerr << "Invalid playback configuration." << std::endl;
-    return 1;
+    return false;
   }
 
   const bool useKeyer =
-      !config.fillPortId.empty() || !config.keyPortId.empty();
+      !outputConfig.fillPortId.empty() || !outputConfig.keyPortId.empty();
   std::string outputDeviceId;
   BMDVideoConnection outputConnection = bmdVideoConnectionUnspecified;
 
   if (useKeyer) {
-    const std::string expectedFill = config.deviceId + "-sdi-a";
-    const std::string expectedKey = config.deviceId + "-sdi-b";
-    if (config.fillPortId != expectedFill || config.keyPortId != expectedKey) {
+    const std::string expectedFill = outputConfig.deviceId + "-sdi-a";
+    const std::string expectedKey = outputConfig.deviceId + "-sdi-b";
+    if (outputConfig.fillPortId != expectedFill ||
+        outputConfig.keyPortId != expectedKey) {
       std::cerr << "Fill/key ports do not match the selected device."
                 << std::endl;
-      return 1;
+      return false;
     }
-    outputDeviceId = config.deviceId;
+    outputDeviceId = outputConfig.deviceId;
     outputConnection = bmdVideoConnectionSDI;
-  } else if (!config.outputPortId.empty()) {
-    if (!parseOutputPort(config, outputDeviceId, outputConnection)) {
-      std::cerr << "Output port does not match the selected device."
-                << std::endl;
-      return 1;
-    }
-    if (outputDeviceId != config.deviceId) {
+  } else if (!outputConfig.outputPortId.empty()) {
+    if (!parseOutputPort(outputConfig.outputPortId, outputDeviceId, outputConnection) ||
+        outputDeviceId != outputConfig.deviceId) {
       std::cerr << "Output port does not match the selected device."
                 << std::endl;
-      return 1;
+      return false;
     }
   } else {
     std::cerr << "Output port is required for video playback." << std::endl;
-    return 1;
+    return false;
   }
 
-  std::cerr << "Playback config: device=" << config.deviceId
+  sink.label = outputLabel(outputConfig);
+  sink.width = config.width;
+  sink.height = config.height;
+  sink.useLegalRange = outputConfig.useLegalRange;
+
+  std::cerr << "Playback config: device=" << outputConfig.deviceId
+            << " port=" << sink.label
             << " output="
             << (outputConnection == bmdVideoConnectionSDI
                     ? "sdi"
@@ -1746,34 +1941,32 @@ int runPlayback(const PlaybackConfig& config) {
             << " fps=" << std::fixed << std::setprecision(3) << config.fps
             << std::endl;
 
-  IDeckLink* deckLink = findDeckLinkById(config.deviceId);
-  if (!deckLink) {
-    std::cerr << "DeckLink device not found: " << config.deviceId << std::endl;
-    return 1;
+  sink.deckLink = findDeckLinkById(outputConfig.deviceId);
+  if (!sink.deckLink) {
+    std::cerr << "DeckLink device not found: " << outputConfig.deviceId
+              << std::endl;
+    return false;
   }
 
-  IDeckLinkOutput* output = nullptr;
-  if (deckLink->QueryInterface(IID_IDeckLinkOutput, (void**)&output) != S_OK ||
-      !output) {
+  if (sink.deckLink->QueryInterface(IID_IDeckLinkOutput, (void**)&sink.output) != S_OK ||
+      !sink.output) {
+    sink.output = nullptr;
     std::cerr << "Failed to acquire IDeckLinkOutput." << std::endl;
-    deckLink->Release();
-    return 1;
+    return false;
   }
 
-  IDeckLinkKeyer* keyer = nullptr;
   if (useKeyer) {
-    if (deckLink->QueryInterface(IID_IDeckLinkKeyer, (void**)&keyer) != S_OK ||
-        !keyer) {
+    if (sink.deckLink->QueryInterface(IID_IDeckLinkKeyer, (void**)&sink.keyer) != S_OK ||
+        !sink.keyer) {
+      sink.keyer = nullptr;
       std::cerr << "Failed to acquire IDeckLinkKeyer." << std::endl;
-      output->Release();
-      deckLink->Release();
-      return 1;
+      return false;
     }
 
     IDeckLinkProfileAttributes* attributes = nullptr;
     bool supportsExternalKeying = false;
-    if (deckLink->QueryInterface(IID_IDeckLinkProfileAttributes,
-                                 (void**)&attributes) == S_OK) {
+    if (sink.deckLink->QueryInterface(IID_IDeckLinkProfileAttributes,
+                                      (void**)&attributes) == S_OK) {
       getFlagAttribute(attributes, BMDDeckLinkSupportsExternalKeying,
                        supportsExternalKeying);
       attributes->Release();
@@ -1781,32 +1974,23 @@ int runPlayback(const PlaybackConfig& config) {
 
     if (!supportsExternalKeying) {
       std::cerr << "External keying not supported by device." << std::endl;
-      keyer->Release();
-      output->Release();
-      deckLink->Release();
-      return 1;
+      return false;
     }
   }
 
   BMDDisplayMode displayMode = bmdModeUnknown;
   BMDDisplayModeFlags displayModeFlags = 0;
-  PlaybackState state;
-  state.output = output;
-  state.width = config.width;
-  state.height = config.height;
-  state.useLegalRange = config.useLegalRange;
-
   const BMDSupportedVideoModeFlags modeFlags =
       useKeyer ? bmdSupportedVideoModeKeying : bmdSupportedVideoModeDefault;
 
-  std::vector<BMDPixelFormat> pixelFormats = config.pixelFormatPriority;
+  std::vector<BMDPixelFormat> pixelFormats = outputConfig.pixelFormatPriority;
   if (pixelFormats.empty()) {
     // ARGB is the only permitted fallback pixel format; BGRA is disallowed.
     pixelFormats = { bmdFormat8BitARGB };
   }
 
   BMDPixelFormat selectedPixelFormat = bmdFormat8BitARGB;
-  if (!findDisplayMode(output,
+  if (!findDisplayMode(sink.output,
                        config.width,
                        config.height,
                        config.fps,
@@ -1815,18 +1999,13 @@ int runPlayback(const PlaybackConfig& config) {
                        modeFlags,
                        displayMode,
                        selectedPixelFormat,
-                       state.frameDuration,
-                       state.timeScale,
+                       sink.frameTicks,
+                       sink.timeScale,
                        displayModeFlags)) {
     std::cerr << "No supported display mode for requested format." << std::endl;
-    if (keyer) {
-      keyer->Release();
-    }
-    output->Release();
-    deckLink->Release();
-    return 1;
+    return false;
   }
-  state.pixelFormat = selectedPixelFormat;
+  sink.pixelFormat = selectedPixelFormat;
   BMDColorspace autoColorspace =
       selectColorspaceFromFlags(displayModeFlags, config.height);
   if (autoColorspace == bmdColorspaceUnknown) {
@@ -1837,17 +2016,17 @@ int runPlayback(const PlaybackConfig& config) {
               << "." << std::endl;
   }
 
-  state.colorspace = autoColorspace;
-  if (config.colorspaceOverride != bmdColorspaceUnknown) {
-    if (config.colorspaceOverride == bmdColorspaceRec2020 &&
+  sink.colorspace = autoColorspace;
+  if (outputConfig.colorspaceOverride != bmdColorspaceUnknown) {
+    if (outputConfig.colorspaceOverride == bmdColorspaceRec2020 &&
         !(displayModeFlags & bmdDisplayModeColorspaceRec2020)) {
       std::cerr << "Requested colorspace rec2020 is not supported by "
                    "display mode. Using auto colorspace."
                 << std::endl;
     } else {
-      state.colorspace = config.colorspaceOverride;
+      sink.colorspace = outputConfig.colorspaceOverride;
       std::cerr << "Using colorspace override: "
-                << colorspaceLabel(state.colorspace) << std::endl;
+                << colorspaceLabel(sink.colorspace) << std::endl;
     }
   }
 
@@ -1857,7 +2036,7 @@ int runPlayback(const PlaybackConfig& config) {
     BMDTimeValue frameDuration = 0;
     BMDTimeScale timeScale = 0;
     BMDDisplayModeFlags modeFlags = 0;
-    if (getDisplayModeDetails(output,
+    if (getDisplayModeDetails(sink.output,
                               displayMode,
                               modeName,
                               dominance,
@@ -1869,42 +2048,33 @@ int runPlayback(const PlaybackConfig& config) {
               ? static_cast<double>(timeScale) /
                     static_cast<double>(frameDuration)
               : 0.0;
-      std::cerr << "Selected display mode: "
+      std::cerr << "Selected display mode (" << sink.label << "): "
                 << (modeName.empty() ? "unknown" : modeName) << " ("
                 << config.width << "x" << config.height << " @ " << std::fixed
                 << std::setprecision(3) << fps << ", "
                 << fieldDominanceLabel(dominance) << ", pixelFormat "
-                << pixelFormatLabel(state.pixelFormat) << ", colorspace "
-                << colorspaceLabel(state.colorspace)
-                << ", range " << (state.useLegalRange ? "legal" : "full")
+                << pixelFormatLabel(sink.pixelFormat) << ", colorspace "
+                << colorspaceLabel(sink.colorspace)
+                << ", range " << (sink.useLegalRange ? "legal" : "full")
                 << ")" << std::endl;
     }
   }
 
-  if (!supportsOutputConnection(deckLink, outputConnection)) {
+  if (!supportsOutputConnection(sink.deckLink, outputConnection)) {
     std::cerr << "Requested output connection not supported by device."
               << std::endl;
-    if (keyer) {
-      keyer->Release();
-    }
-    output->Release();
-    deckLink->Release();
-    return 1;
+    return false;
   }
 
-  if (!configureOutputConnection(deckLink, outputConnection)) {
+  if (!configureOutputConnection(sink.deckLink, outputConnection)) {
     std::cerr << "Failed to set output connection." << std::endl;
-    if (keyer) {
-      keyer->Release();
-    }
-    output->Release();
-    deckLink->Release();
-    return 1;
+    return false;
   }
 
   HRESULT enableResult = E_FAIL;
   for (int attempt = 1; attempt <= kEnableVideoOutputRetryCount; ++attempt) {
-    enableResult = output->EnableVideoOutput(displayMode, bmdVideoOutputFlagDefault);
+    enableResult =
+        sink.output->EnableVideoOutput(displayMode, bmdVideoOutputFlagDefault);
     if (enableResult == S_OK) {
       break;
     }
@@ -1931,27 +2101,20 @@ int runPlayback(const PlaybackConfig& config) {
     std::cerr << "EnableVideoOutput failed. HRESULT=0x" << std::hex
               << static_cast<uint32_t>(enableResult) << std::dec << " ("
               << hresultLabel(enableResult) << ")" << std::endl;
-    if (keyer) {
-      keyer->Release();
-    }
-    output->Release();
-    deckLink->Release();
-    return 1;
+    return false;
   }
+  sink.videoEnabled = true;
 
-  if (keyer) {
-    const HRESULT keyerEnableResult = keyer->Enable(true);
+  if (sink.keyer) {
+    const HRESULT keyerEnableResult = sink.keyer->Enable(true);
     if (keyerEnableResult != S_OK) {
       std::cerr << "Keyer enable failed. HRESULT=0x" << std::hex
                 << static_cast<uint32_t>(keyerEnableResult) << std::dec
                 << std::endl;
-      output->DisableVideoOutput();
-      keyer->Release();
-      output->Release();
-      deckLink->Release();
-      return 1;
+      return false;
     }
-    const HRESULT keyerLevelResult = keyer->SetLevel(255);
+    sink.keyerEnabled = true;
+    const HRESULT keyerLevelResult = sink.keyer->SetLevel(255);
     if (keyerLevelResult != S_OK) {
       std::cerr << "Keyer SetLevel failed. HRESULT=0x" << std::hex
                 << static_cast<uint32_t>(keyerLevelResult) << std::dec
@@ -1959,42 +2122,122 @@ int runPlayback(const PlaybackConfig& config) {
     }
   }
 
-  DeckLinkPlaybackCallback* callback = new DeckLinkPlaybackCallback(&state);
-  output->SetScheduledFrameCompletionCallback(callback);
+  return true;
+}
+
+size_t frameBusExpectedSize(const FrameBusReader& reader) {
+  return static_cast<size_t>(reader.header->header_size) +
+         static_cast<size_t>(reader.geometry.slot_stride) *
+             static_cast<size_t>(reader.geometry.slot_count);
+}
 
+// Whether the mapped segment can feed the configured outputs. The DeckLink
+// display mode is fixed for the helper's lifetime, so the geometry must match.
+bool checkFrameBusSegment(const PlaybackConfig& config, const FrameBusReader& reader,
+                          std::string& error) {
   const size_t expectedBytes =
-      static_cast<size_t>(config.width) *
-      static_cast<size_t>(config.height) * 4;
-  auto maybeStartPlayback = [&]() {
-    if (state.started) {
-      return;
-    }
-    while (state.prerollScheduled < state.prerollTarget) {
-      std::vector<uint8_t> frameData;
-      if (!state.queue.pop(frameData)) {
-        break;
-      }
-      state.lastFrame = frameData;
-      state.hasLastFrame = true;
-      if (scheduleFrame(state, frameData)) {
-        state.prerollScheduled += 1;
-      } else {
-        break;
+      static_cast<size_t>(config.width) * static_cast<size_t>(config.height) * 4;
+  const size_t headerExpectedSize = frameBusExpectedSize(reader);
+  if (reader.size < headerExpectedSize) {
+    std::ostringstream out;
+    out << "FrameBus size mismatch (too small). expected=" << headerExpectedSize
+        << " got=" << reader.size;
+    error = out.str();
+    return false;
+  }
+  if (reader.geometry.frame_size != expectedBytes ||
+      reader.geometry.width != static_cast<uint32_t>(config.width) ||
+      reader.geometry.height != static_cast<uint32_t>(config.height)) {
+    std::ostringstream out;
+    out << "FrameBus header mismatch. expected=" << config.width << "x"
+        << config.height << " bytes=" << expectedBytes
+        << " got=" << reader.geometry.width << "x" << reader.geometry.height
+        << " bytes=" << reader.geometry.frame_size;
+    error = out.str();
+    return false;
+  }
+  if (reader.header->pixel_format != FRAMEBUS_PIXELFORMAT_RGBA8) {
+    error = "FrameBus pixel format mismatch (expected RGBA8).";
+    return false;
+  }
+  return true;
+}
+
+// Reopens the FrameBus name after the writer retired the segment, waiting
+// until a segment with the configured geometry is published. Each distinct
+// reason for waiting is logged once. False only when the helper is exiting.
+bool reopenFrameBusReader(const PlaybackConfig& config, FrameBusReader& reader) {
+  std::string lastError;
+  while (!gShouldExit.load()) {
+    std::string error;
+    if (openFrameBusReader(config.frameBusName, reader, error)) {
+      if (checkFrameBusSegment(config, reader, error)) {
+        std::cerr << "FrameBus segment replaced; reopened." << std::endl;
+        return true;
       }
+      closeFrameBusReader(reader);
+    }
+    if (error != lastError) {
+      std::cerr << "FrameBus reopen waiting: " << error << std::endl;
+      lastError = error;
     }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
 
-    if (state.prerollScheduled >= state.prerollTarget) {
-      const HRESULT startResult =
-          output->StartScheduledPlayback(0, state.timeScale, 1.0);
-      if (startResult == S_OK) {
-        state.started = true;
-      } else {
-        std::cerr << "StartScheduledPlayback failed. HRESULT=0x" << std::hex
-                  << static_cast<uint32_t>(startResult) << std::dec
-                  << std::endl;
+int runPlayback(const PlaybackConfig& config) {
+  if (config.outputs.empty() || config.width <= 0 || config.height <= 0 ||
+      config.fps <= 0) {
+    std::cerr << "Invalid playback configuration." << std::endl;
+    return 1;
+  }
+  for (size_t i = 0; i < config.outputs.size(); ++i) {
+    for (size_t j = i + 1; j < config.outputs.size(); ++j) {
+      if (config.outputs[i].deviceId == config.outputs[j].deviceId) {
+        // One IDeckLinkOutput per (sub-)device; fill+key is a single output.
+        std::cerr << "Playback outputs must use distinct devices: "
+                  << config.outputs[i].deviceId << std::endl;
+        return 1;
       }
     }
-  };
+  }
+
+  // Sinks outlive the scheduler: their completion callbacks call into it
+  // until shutdown() below has stopped playback.
+  std::vector<std::unique_ptr<DeckLinkOutputSink>> sinks;
+  for (const OutputConfig& outputConfig : config.outputs) {
+    auto sink = std::make_unique<DeckLinkOutputSink>();
+    if (!openPlaybackOutput(config, outputConfig, *sink)) {
+      return 1;
+    }
+    sinks.push_back(std::move(sink));
+  }
+
+  DeckLinkFrameConverter converter(sinks.front()->output);
+  PlayoutScheduler scheduler(
+      config.width,
+      config.height,
+      kPrerollFrames,
+      kMaxQueuedFrames,
+      [&converter](const uint8_t* rgba, int width, int height,
+                   const PlayoutFormat& format, ConvertedFrame& out) {
+        return converter.convert(rgba, width, height, format, out);
+      });
+  for (auto& sink : sinks) {
+    const size_t index = scheduler.addOutput(sink.get());
+    sink->callback = new DeckLinkPlaybackCallback(&scheduler, index, sink->label);
+    sink->output->SetScheduledFrameCompletionCallback(sink->callback);
+  }
+  if (sinks.size() > 1) {
+    std::cerr << "Playback outputs: " << sinks.size()
+              << " conversions per frame: " << scheduler.formatCount()
+              << std::endl;
+  }
+
+  const size_t expectedBytes =
+      static_cast<size_t>(config.width) *
+      static_cast<size_t>(config.height) * 4;
 
   if (!config.frameBusName.empty()) {
     FrameBusReader reader;
@@ -2003,39 +2246,19 @@ int runPlayback(const PlaybackConfig& config) {
       std::cerr << "FrameBus open failed: " << frameBusError << std::endl;
       gShouldExit.store(true);
     } else {
-      const size_t headerExpectedSize =
-          static_cast<size_t>(reader.header->header_size) +
-          static_cast<size_t>(reader.header->slot_stride) *
-              static_cast<size_t>(reader.header->slot_count);
-      if (reader.size < headerExpectedSize) {
-        std::cerr << "FrameBus size mismatch (too small). expected="
-                  << headerExpectedSize << " got=" << reader.size << std::endl;
-        closeFrameBusReader(reader);
-        gShouldExit.store(true);
-      } else if (reader.size > headerExpectedSize) {
+      const size_t headerExpectedSize = frameBusExpectedSize(reader);
+      if (reader.size > headerExpectedSize) {
         std::cerr << "FrameBus size mismatch (tolerated). expected="
                   << headerExpectedSize << " got=" << reader.size << std::endl;
       }
-
       if (config.frameBusSize > 0 && config.frameBusSize != headerExpectedSize) {
         std::cerr << "FrameBus expected size differs from config. expected="
                   << headerExpectedSize << " config=" << config.frameBusSize
                   << std::endl;
       }
 
-      if (reader.header->frame_size != expectedBytes ||
-                 reader.header->width != static_cast<uint32_t>(config.width) ||
-                 reader.header->height != static_cast<uint32_t>(config.height)) {
-        std::cerr << "FrameBus header mismatch. expected="
-                  << config.width << "x" << config.height
-                  << " bytes=" << expectedBytes
-                  << " got=" << reader.header->width << "x"
-                  << reader.header->height
-                  << " bytes=" << reader.header->frame_size << std::endl;
-        closeFrameBusReader(reader);
-        gShouldExit.store(true);
-      } else if (reader.header->pixel_format != FRAMEBUS_PIXELFORMAT_RGBA8) {
-        std::cerr << "FrameBus pixel format mismatch (expected RGBA8)." << std::endl;
+      if (!checkFrameBusSegment(config, reader, frameBusError)) {
+        std::cerr << frameBusError << std::endl;
         closeFrameBusReader(reader);
         gShouldExit.store(true);
       } else {
@@ -2079,6 +2302,16 @@ int runPlayback(const PlaybackConfig& config) {
 
         while (!gShouldExit.load()) {
           const uint64_t seq = atomicLoad64(&reader.header->seq);
+          if (framebus_segment_stale(reader.header, &reader.geometry)) {
+            // output.framebus.configure replaced the segment: follow the name
+            // to the new one. The outputs hold their last frame meanwhile.
+            closeFrameBusReader(reader);
+            if (!reopenFrameBusReader(config, reader)) {
+              break;
+            }
+            lastSeq = 0;
+            continue;
+          }
           if (seq == 0 || seq == lastSeq) {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
@@ -2102,13 +2335,22 @@ int runPlayback(const PlaybackConfig& config) {
           framesObserved += 1;
           logMetricsIfNeeded();
           const uint32_t slotIndex =
-              static_cast<uint32_t>((seq - 1) % reader.header->slot_count);
+              static_cast<uint32_t>((seq - 1) % reader.geometry.slot_count);
           const uint8_t* slotPtr =
-              reader.slots + (static_cast<size_t>(slotIndex) * reader.header->slot_stride);
-          std::vector<uint8_t> frameBuffer(reader.header->frame_size);
-          std::memcpy(frameBuffer.data(), slotPtr, frameBuffer.size());
-          state.queue.push(std::move(frameBuffer));
-          maybeStartPlayback();
+              reader.slots + (static_cast<size_t>(slotIndex) * reader.geometry.slot_stride);
+          // Convert straight out of the slot, once per output format, and
+          // drop the batch if the writer may have started rendering into the
+          // slot meanwhile (it does so right after committing
+          // seq + slot_count - 1).
+          PlayoutBatch batch;
+          if (!scheduler.convert(slotPtr, seq, batch)) {
+            continue;
+          }
+          if (atomicLoad64(&reader.header->seq) + 1u >= seq + reader.geometry.slot_count) {
+            droppedFrames += 1;
+            continue;
+          }
+          scheduler.enqueue(batch);
         }
         closeFrameBusReader(reader);
       }
@@ -2153,6 +2395,8 @@ int runPlayback(const PlaybackConfig& config) {
 
     const int stdinFd = fileno(stdin);
     std::vector<uint8_t> headerBuffer(kFrameHeaderSize);
+    std::vector<uint8_t> frameBuffer(expectedBytes);
+    uint64_t framesRead = 0;
     int headerMismatchLogsRemaining = 2;
     int headerInvalidLogsRemaining = 2;
 
@@ -2213,7 +2457,6 @@ int runPlayback(const PlaybackConfig& config) {
         continue;
       }
 
-      std::vector<uint8_t> frameBuffer(header.bufferLength);
       if (!readExact(stdinFd, frameBuffer.data(), frameBuffer.size())) {
         break;
       }
@@ -2233,28 +2476,14 @@ int runPlayback(const PlaybackConfig& config) {
       framesObserved += 1;
       logMetricsIfNeeded();
 
-      state.queue.push(std::move(frameBuffer));
-      maybeStartPlayback();
+      framesRead += 1;
+      scheduler.submit(frameBuffer.data(), framesRead);
     }
   }
 
-  output->StopScheduledPlayback(0, nullptr, 0);
-  if (keyer) {
-    keyer->Disable();
-  }
-  output->DisableVideoOutput();
-  output->SetScheduledFrameCompletionCallback(nullptr);
-
-  callback->Release();
-  if (keyer) {
-    keyer->Release();
+  for (auto& sink : sinks) {
+    sink->shutdown();
   }
-  if (state.converter) {
-    state.converter->Release();
-    state.converter = nullptr;
-  }
-  output->Release();
-  deckLink->Release();
   return 0;
 }
 
@@ -2384,10 +2613,12 @@ int main(int argc, char** argv) {
 
   if (mode == "--playback") {
     PlaybackConfig config;
+    OutputConfig primary;
+    std::vector<std::string> extraOutputSpecs;
     for (int i = 2; i < argc; ++i) {
       std::string arg = argv[i];
       if (arg == "--device" && i + 1 < argc) {
-        config.deviceId = argv[++i];
+        primary.deviceId = argv[++i];
         continue;
       }
       if (arg == "--width" && i + 1 < argc) {
@@ -2415,15 +2646,15 @@ int main(int argc, char** argv) {
         continue;
       }
       if (arg == "--fill-port" && i + 1 < argc) {
-        config.fillPortId = argv[++i];
+        primary.fillPortId = argv[++i];
         continue;
       }
       if (arg == "--key-port" && i + 1 < argc) {
-        config.keyPortId = argv[++i];
+        primary.keyPortId = argv[++i];
         continue;
       }
       if (arg == "--output-port" && i + 1 < argc) {
-        config.outputPortId = argv[++i];
+        primary.outputPortId = argv[++i];
         continue;
       }
       if (arg == "--pixel-format" && i + 1 < argc) {
@@ -2433,27 +2664,16 @@ int main(int argc, char** argv) {
           std::cerr << "Unknown pixel format: " << value << std::endl;
           return 1;
         }
-        config.pixelFormatPriority.clear();
-        config.pixelFormatPriority.push_back(format);
+        primary.pixelFormatPriority.clear();
+        primary.pixelFormatPriority.push_back(format);
         continue;
       }
       if (arg == "--pixel-format-priority" && i + 1 < argc) {
         const std::string value = argv[++i];
-        config.pixelFormatPriority.clear();
-        std::stringstream stream(value);
-        std::string token;
-        while (std::getline(stream, token, ',')) {
-          if (token.empty()) {
-            continue;
-          }
-          BMDPixelFormat format = bmdFormatUnspecified;
-          if (!parsePixelFormatLabel(token, format)) {
-            std::cerr << "Unknown pixel format: " << token << std::endl;
-            return 1;
-          }
-          config.pixelFormatPriority.push_back(format);
+        if (!parsePixelFormatPriority(value, ',', primary.pixelFormatPriority)) {
+          return 1;
         }
-        if (config.pixelFormatPriority.empty()) {
+        if (primary.pixelFormatPriority.empty()) {
           std::cerr << "Pixel format priority cannot be empty." << std::endl;
           return 1;
         }
@@ -2462,9 +2682,9 @@ int main(int argc, char** argv) {
       if (arg == "--range" && i + 1 < argc) {
         const std::string value = argv[++i];
         if (value == "full") {
-          config.useLegalRange = false;
+          primary.useLegalRange = false;
         } else if (value == "legal") {
-          config.useLegalRange = true;
+          primary.useLegalRange = true;
         } else {
           std::cerr << "Unknown range: " << value << std::endl;
           return 1;
@@ -2478,7 +2698,11 @@ int main(int argc, char** argv) {
           std::cerr << "Unknown colorspace: " << value << std::endl;
           return 1;
         }
-        config.colorspaceOverride = override;
+        primary.colorspaceOverride = override;
+        continue;
+      }
+      if (arg == "--output" && i + 1 < argc) {
+        extraOutputSpecs.push_back(argv[++i]);
         continue;
       }
       if (arg == "--framebus-name" && i + 1 < argc) {
@@ -2542,6 +2766,20 @@ int main(int argc, char** argv) {
       config.frameBusSize = readEnvSize("BRIDGE_FRAMEBUS_SIZE");
     }
 
+    // The legacy single-output flags describe the first output; every
+    // --output spec adds another one fed from the same reader.
+    if (!primary.outputPortId.empty() || !primary.fillPortId.empty() ||
+        !primary.keyPortId.empty()) {
+      config.outputs.push_back(primary);
+    }
+    for (const std::string& spec : extraOutputSpecs) {
+      OutputConfig output;
+      if (!parseOutputSpec(spec, primary, output)) {
+        return 1;
+      }
+      config.outputs.push_back(output);
+    }
+
     return runPlayback(config);
   }
 
@@ -0,0 +1,197 @@
+#include "playout_scheduler.h"
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace broadify::decklink {
+
+namespace {
+
+// Converted buffers kept for reuse per format: enough for every output's
+// queue plus the frames the hardware still holds.
+constexpr size_t kMaxPooledFrames = 12;
+
+}  // namespace
+
+// Recycles converted buffers so steady-state playout does not allocate. The
+// shared_ptr deleter hands a buffer back once the last output released it;
+// the pool outlives the scheduler while any frame is still referenced.
+class PlayoutScheduler::FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+  std::unique_ptr<ConvertedFrame> take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+      return std::make_unique<ConvertedFrame>();
+    }
+    std::unique_ptr<ConvertedFrame> frame = std::move(free_.back());
+    free_.pop_back();
+    return frame;
+  }
+
+  ConvertedFramePtr share(std::unique_ptr<ConvertedFrame> frame) {
+    std::shared_ptr<FramePool> self = shared_from_this();
+    return ConvertedFramePtr(frame.release(), [self](const ConvertedFrame* released) {
+      self->give(std::unique_ptr<ConvertedFrame>(const_cast<ConvertedFrame*>(released)));
+    });
+  }
+
+private:
+  void give(std::unique_ptr<ConvertedFrame> frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.size() < kMaxPooledFrames) {
+      free_.push_back(std::move(frame));
+    }
+  }
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ConvertedFrame>> free_;
+};
+
+struct PlayoutScheduler::Output {
+  PlayoutSink* sink = nullptr;
+  size_t formatIndex = 0;
+  mutable std::mutex mutex;
+  std::deque<ConvertedFramePtr> queue;
+  ConvertedFramePtr lastFrame;
+  int64_t nextStreamTime = 0;
+  size_t prerolled = 0;
+  PlayoutStats stats;
+};
+
+PlayoutScheduler::PlayoutScheduler(int width,
+                                   int height,
+                                   size_t prerollTarget,
+                                   size_t maxQueuedFrames,
+                                   PlayoutConvertFn convert)
+    : width_(width),
+      height_(height),
+      prerollTarget_(prerollTarget),
+      maxQueuedFrames_(maxQueuedFrames > 0 ? maxQueuedFrames : 1),
+      convert_(std::move(convert)) {}
+
+PlayoutScheduler::~PlayoutScheduler() = default;
+
+size_t PlayoutScheduler::addOutput(PlayoutSink* sink) {
+  auto output = std::make_unique<Output>();
+  output->sink = sink;
+  const PlayoutFormat format = sink->format();
+  size_t formatIndex = 0;
+  while (formatIndex < formats_.size() && formats_[formatIndex] != format) {
+    ++formatIndex;
+  }
+  if (formatIndex == formats_.size()) {
+    formats_.push_back(format);
+    pools_.push_back(std::make_shared<FramePool>());
+  }
+  output->formatIndex = formatIndex;
+  outputs_.push_back(std::move(output));
+  return outputs_.size() - 1;
+}
+
+bool PlayoutScheduler::convert(const uint8_t* rgba, uint64_t seq, PlayoutBatch& batch) {
+  batch.seq = seq;
+  batch.frames.clear();
+  batch.frames.reserve(formats_.size());
+  for (size_t index = 0; index < formats_.size(); ++index) {
+    std::unique_ptr<ConvertedFrame> frame = pools_[index]->take();
+    frame->seq = seq;
+    frame->format = formats_[index];
+    frame->width = width_;
+    frame->height = height_;
+    if (!convert_(rgba, width_, height_, formats_[index], *frame)) {
+      batch.frames.clear();
+      return false;
+    }
+    ++conversions_;
+    batch.frames.push_back(pools_[index]->share(std::move(frame)));
+  }
+  return true;
+}
+
+void PlayoutScheduler::enqueue(const PlayoutBatch& batch) {
+  if (batch.frames.size() != formats_.size()) {
+    return;
+  }
+  for (auto& output : outputs_) {
+    std::lock_guard<std::mutex> lock(output->mutex);
+    if (output->queue.size() >= maxQueuedFrames_) {
+      output->queue.pop_front();
+      output->stats.superseded += 1;
+    }
+    output->queue.push_back(batch.frames[output->formatIndex]);
+    if (!output->stats.started) {
+      prerollLocked(*output);
+    }
+  }
+}
+
+bool PlayoutScheduler::submit(const uint8_t* rgba, uint64_t seq) {
+  PlayoutBatch batch;
+  if (!convert(rgba, seq, batch)) {
+    return false;
+  }
+  enqueue(batch);
+  return true;
+}
+
+void PlayoutScheduler::onCompleted(size_t index, PlayoutCompletion result) {
+  if (index >= outputs_.size()) {
+    return;
+  }
+  Output& output = *outputs_[index];
+  std::lock_guard<std::mutex> lock(output.mutex);
+  output.stats.completed += 1;
+  if (result == PlayoutCompletion::kLate) {
+    output.stats.late += 1;
+  } else if (result == PlayoutCompletion::kDropped) {
+    output.stats.dropped += 1;
+  }
+
+  ConvertedFramePtr frame;
+  if (!output.queue.empty()) {
+    frame = std::move(output.queue.front());
+    output.queue.pop_front();
+  } else if (output.lastFrame) {
+    frame = output.lastFrame;
+    output.stats.repeated += 1;
+  }
+  if (frame) {
+    scheduleLocked(output, frame);
+  }
+}
+
+PlayoutStats PlayoutScheduler::stats(size_t index) const {
+  if (index >= outputs_.size()) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(outputs_[index]->mutex);
+  return outputs_[index]->stats;
+}
+
+void PlayoutScheduler::prerollLocked(Output& output) {
+  while (output.prerolled < prerollTarget_ && !output.queue.empty()) {
+    ConvertedFramePtr frame = std::move(output.queue.front());
+    output.queue.pop_front();
+    if (!scheduleLocked(output, frame)) {
+      return;
+    }
+    output.prerolled += 1;
+  }
+  if (output.prerolled >= prerollTarget_) {
+    output.stats.started = output.sink->start();
+  }
+}
+
+bool PlayoutScheduler::scheduleLocked(Output& output, const ConvertedFramePtr& frame) {
+  output.lastFrame = frame;
+  if (!output.sink->schedule(*frame, output.nextStreamTime)) {
+    output.stats.scheduleFailures += 1;
+    return false;
+  }
+  output.nextStreamTime += output.sink->frameDuration();
+  output.stats.scheduled += 1;
+  return true;
+}
+
+}  // namespace broadify::decklink
@@ -0,0 +1,141 @@
+#pragma once
+
+/*
+  Playout scheduling core of `decklink-helper --playback`.
+
+  One FrameBus/stdin reader feeds N outputs (fill+key pair, program out, a
+  second program out, ...). Every source frame is converted once per distinct
+  PlayoutFormat and the converted buffer is shared by all outputs using that
+  format; queueing, preroll, repeat-on-underrun, stream time and stats stay
+  per output. The core has no DeckLink SDK dependency: DeckLink outputs
+  implement PlayoutSink in decklink-helper.cpp, tests use a mock sink.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace broadify::decklink {
+
+// What an output needs from the converter. Outputs with equal formats share
+// one converted buffer per frame.
+struct PlayoutFormat {
+  uint32_t pixelFormat = 0;  // BMDPixelFormat FourCC
+  uint32_t colorspace = 0;   // BMDColorspace; only set for YUV formats
+  bool legalRange = true;
+
+  bool operator==(const PlayoutFormat& other) const {
+    return pixelFormat == other.pixelFormat && colorspace == other.colorspace &&
+           legalRange == other.legalRange;
+  }
+  bool operator!=(const PlayoutFormat& other) const { return !(*this == other); }
+};
+
+struct ConvertedFrame {
+  uint64_t seq = 0;
+  PlayoutFormat format;
+  int width = 0;
+  int height = 0;
+  int rowBytes = 0;
+  std::vector<uint8_t> pixels;
+  // Device frame the converter rendered into instead of `pixels` (the
+  // DeckLink helper's IDeckLinkVideoFrame); sinks schedule it as is. Opaque
+  // to the scheduler.
+  std::shared_ptr<void> deviceFrame;
+};
+using ConvertedFramePtr = std::shared_ptr<const ConvertedFrame>;
+
+enum class PlayoutCompletion { kCompleted, kLate, kDropped };
+
+class PlayoutSink {
+public:
+  virtual ~PlayoutSink() = default;
+
+  virtual PlayoutFormat format() const = 0;
+  // Stream-time increment per frame, in the sink's own time scale.
+  virtual int64_t frameDuration() const = 0;
+  virtual bool schedule(const ConvertedFrame& frame, int64_t streamTime) = 0;
+  virtual bool start() = 0;
+};
+
+struct PlayoutStats {
+  uint64_t scheduled = 0;
+  uint64_t repeated = 0;          // underrun: last frame scheduled again
+  uint64_t scheduleFailures = 0;
+  uint64_t superseded = 0;        // dropped from the queue before scheduling
+  uint64_t completed = 0;
+  uint64_t late = 0;
+  uint64_t dropped = 0;
+  bool started = false;
+};
+
+// Converts one RGBA8 frame (rows of width * 4 bytes) into `out`. `out.pixels`
+// and `out.deviceFrame` may still hold an earlier frame's buffers: resize the
+// pixels, don't reallocate, and replace a device frame an output may still
+// have queued.
+using PlayoutConvertFn = std::function<bool(const uint8_t* rgba,
+                                            int width,
+                                            int height,
+                                            const PlayoutFormat& format,
+                                            ConvertedFrame& out)>;
+
+// One source frame converted for every registered format, indexed like the
+// scheduler's formats.
+struct PlayoutBatch {
+  uint64_t seq = 0;
+  std::vector<ConvertedFramePtr> frames;
+};
+
+class PlayoutScheduler {
+public:
+  PlayoutScheduler(int width,
+                   int height,
+                   size_t prerollTarget,
+                   size_t maxQueuedFrames,
+                   PlayoutConvertFn convert);
+  ~PlayoutScheduler();
+
+  PlayoutScheduler(const PlayoutScheduler&) = delete;
+  PlayoutScheduler& operator=(const PlayoutScheduler&) = delete;
+
+  // Registers an output; call before the first frame. Returns its index.
+  size_t addOutput(PlayoutSink* sink);
+  size_t outputCount() const { return outputs_.size(); }
+  size_t formatCount() const { return formats_.size(); }
+
+  // Producer thread. convert() fills pooled buffers once per format; callers
+  // reading from shared memory can validate the source afterwards and drop
+  // a torn batch before enqueue() hands it to every output and prerolls or
+  // starts the outputs that are not running yet.
+  bool convert(const uint8_t* rgba, uint64_t seq, PlayoutBatch& batch);
+  void enqueue(const PlayoutBatch& batch);
+  bool submit(const uint8_t* rgba, uint64_t seq);
+
+  // Completion callback of output `index` (any thread): records the result
+  // and schedules the next queued frame, or repeats the last one.
+  void onCompleted(size_t index, PlayoutCompletion result);
+
+  PlayoutStats stats(size_t index) const;
+  uint64_t conversions() const { return conversions_; }
+
+private:
+  struct Output;
+  class FramePool;
+
+  void prerollLocked(Output& output);
+  bool scheduleLocked(Output& output, const ConvertedFramePtr& frame);
+
+  int width_ = 0;
+  int height_ = 0;
+  size_t prerollTarget_ = 0;
+  size_t maxQueuedFrames_ = 0;
+  PlayoutConvertFn convert_;
+  std::vector<PlayoutFormat> formats_;
+  std::vector<std::shared_ptr<FramePool>> pools_;
+  std::vector<std::unique_ptr<Output>> outputs_;
+  uint64_t conversions_ = 0;
+};
+
+}  // namespace broadify::decklink
@@ -434,6 +434,8 @@ struct FrameBusReader {
   size_t size = 0;
   FrameBusHeader* header = nullptr;
   uint8_t* slots = nullptr;
+  // Geometry at open; the loop reopens once the live header departs from it.
+  FrameBusSegmentGeometry geometry{};
 };
 
 uint64_t atomicLoad64(uint64_t* ptr) {
@@ -469,17 +471,8 @@ std::string normalizeFrameBusObjectName(const std::string& input) {
 #endif
 }
 
-bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::string& error) {
-  if (name.empty()) {
-    error = "FrameBus name is empty";
-    return false;
-  }
-  const std::string shmName = normalizeFrameBusObjectName(name);
-  if (shmName.empty()) {
-    error = "FrameBus name is invalid";
-    return false;
-  }
-
+// Maps one segment object; false when it is missing, invalid or retired.
+bool openFrameBusSegment(const std::string& shmName, FrameBusReader& out, std::string& error) {
 #if defined(_WIN32)
   HANDLE mapHandle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, shmName.c_str());
   if (!mapHandle) {
@@ -509,6 +502,12 @@ bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::strin
     error = "FrameBus header invalid";
     return false;
   }
+  if ((header->flags & FRAMEBUS_FLAG_RETIRED) != 0) {
+    UnmapViewOfFile(base);
+    CloseHandle(mapHandle);
+    error = "FrameBus segment retired";
+    return false;
+  }
 
   const uint64_t expectedSize64 = static_cast<uint64_t>(FRAMEBUS_HEADER_SIZE) +
                                   static_cast<uint64_t>(header->slot_stride) *
@@ -526,6 +525,7 @@ bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::strin
   out.size = static_cast<size_t>(expectedSize64);
   out.header = header;
   out.slots = out.base + FRAMEBUS_HEADER_SIZE;
+  out.geometry = framebus_segment_geometry(header);
   return true;
 #else
   const int fd = shm_open(shmName.c_str(), O_RDWR, 0600);
@@ -562,16 +562,50 @@ bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::strin
     error = "FrameBus header invalid";
     return false;
   }
+  if ((header->flags & FRAMEBUS_FLAG_RETIRED) != 0) {
+    munmap(base, totalSize);
+    close(fd);
+    error = "FrameBus segment retired";
+    return false;
+  }
 
   out.fd = fd;
   out.base = static_cast<uint8_t*>(base);
   out.size = totalSize;
   out.header = header;
   out.slots = out.base + FRAMEBUS_HEADER_SIZE;
+  out.geometry = framebus_segment_geometry(header);
   return true;
 #endif
 }
 
+bool openFrameBusReader(const std::string& name, FrameBusReader& out, std::string& error) {
+  if (name.empty()) {
+    error = "FrameBus name is empty";
+    return false;
+  }
+  const std::string shmName = normalizeFrameBusObjectName(name);
+  if (shmName.empty()) {
+    error = "FrameBus name is invalid";
+    return false;
+  }
+  // Earlier generations may be gone or retired; the writer keeps one live
+  // segment per name. The error of the base name is the one worth reporting.
+  std::string firstError;
+  for (uint32_t generation = 0; generation < FRAMEBUS_MAX_GENERATIONS; ++generation) {
+    char objectName[320];
+    framebus_generation_name(shmName.c_str(), generation, objectName, sizeof(objectName));
+    if (openFrameBusSegment(objectName, out, error)) {
+      return true;
+    }
+    if (generation == 0u) {
+      firstError = error;
+    }
+  }
+  error = firstError;
+  return false;
+}
+
 void closeFrameBusReader(FrameBusReader& reader) {
 #if defined(_WIN32)
   if (reader.base) {
@@ -600,6 +634,50 @@ void signalHandler(int) {
   gShouldExit.store(true);
 }
 
+// Quits on window close, Escape or Cmd/Ctrl+Q.
+void pollSdlEvents() {
+  SDL_Event e;
+  while (SDL_PollEvent(&e)) {
+    if (e.type == SDL_QUIT) gShouldExit.store(true);
+    if (e.type == SDL_KEYDOWN) {
+      const bool quitShortcut =
+          e.key.keysym.sym == SDLK_q &&
+          ((e.key.keysym.mod & KMOD_GUI) || (e.key.keysym.mod & KMOD_CTRL));
+      if (e.key.keysym.sym == SDLK_ESCAPE ||
+          quitShortcut) {
+        gShouldExit.store(true);
+      }
+    }
+  }
+}
+
+// Reopens the FrameBus name after the writer retired the segment (shutdown or
+// output.framebus.configure), waiting until the replacement is published. The
+// window keeps showing the last frame and stays responsive meanwhile. False
+// only when the helper is exiting.
+bool reopenFrameBusReader(const std::string& name, FrameBusReader& reader) {
+  std::string lastError;
+  while (!gShouldExit.load()) {
+    std::string error;
+    if (openFrameBusReader(name, reader, error)) {
+      if (reader.header->pixel_format == FRAMEBUS_PIXELFORMAT_RGBA8 &&
+          reader.geometry.width > 0 && reader.geometry.height > 0 &&
+          reader.geometry.frame_size == reader.geometry.width * reader.geometry.height * 4u) {
+        return true;
+      }
+      error = "FrameBus pixel format mismatch (expected RGBA8)";
+      closeFrameBusReader(reader);
+    }
+    if (error != lastError) {
+      std::cerr << "FrameBus reopen waiting: " << error << std::endl;
+      lastError = error;
+    }
+    pollSdlEvents();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -845,7 +923,7 @@ int main(int argc, char* argv[]) {
   std::cout << "{\"type\":\"ready\"}" << std::endl;
   std::cout.flush();
 
-  const size_t frameSize = reader.header->frame_size;
+  size_t frameSize = reader.geometry.frame_size;
   uint64_t lastSeq = 0;
   const std::chrono::milliseconds frameInterval(fps > 0 ? std::max(1, 1000 / static_cast<int>(fps)) : 16);
   auto nextFrameAt = std::chrono::steady_clock::now();
@@ -865,27 +943,44 @@ int main(int argc, char* argv[]) {
     }
 #endif
     const uint64_t seq = atomicLoad64(&reader.header->seq);
-    if (seq == 0 || seq == lastSeq) {
-      SDL_Event e;
-      while (SDL_PollEvent(&e)) {
-        if (e.type == SDL_QUIT) gShouldExit.store(true);
-        if (e.type == SDL_KEYDOWN) {
-          const bool quitShortcut =
-              e.key.keysym.sym == SDLK_q &&
-              ((e.key.keysym.mod & KMOD_GUI) || (e.key.keysym.mod & KMOD_CTRL));
-          if (e.key.keysym.sym == SDLK_ESCAPE ||
-              quitShortcut) {
-            gShouldExit.store(true);
-          }
+    if (framebus_segment_stale(reader.header, &reader.geometry)) {
+      closeFrameBusReader(reader);
+      if (!reopenFrameBusReader(frameBusName, reader)) {
+        break;
+      }
+      if (reader.geometry.width != width || reader.geometry.height != height) {
+        // New output geometry: only the texture follows it, the fullscreen
+        // window scales whatever size it is given.
+        SDL_Texture* resized = SDL_CreateTexture(
+          renderer,
+          SDL_PIXELFORMAT_RGBA32,
+          SDL_TEXTUREACCESS_STREAMING,
+          static_cast<int>(reader.geometry.width),
+          static_cast<int>(reader.geometry.height)
+        );
+        if (!resized) {
+          std::cerr << "SDL_CreateTexture failed: " << SDL_GetError() << std::endl;
+          break;
         }
+        SDL_DestroyTexture(texture);
+        texture = resized;
+        width = reader.geometry.width;
+        height = reader.geometry.height;
       }
+      frameSize = reader.geometry.frame_size;
+      lastSeq = 0;
+      std::cerr << "FrameBus segment replaced; reopened at " << width << "x" << height << std::endl;
+      continue;
+    }
+    if (seq == 0 || seq == lastSeq) {
+      pollSdlEvents();
       std::this_thread::sleep_for(std::chrono::milliseconds(1));
       continue;
     }
     lastSeq = seq;
 
-    const uint32_t slotIndex = static_cast<uint32_t>((seq - 1) % reader.header->slot_count);
-    const uint8_t* slotPtr = reader.slots + (static_cast<size_t>(slotIndex) * reader.header->slot_stride);
+    const uint32_t slotIndex = static_cast<uint32_t>((seq - 1) % reader.geometry.slot_count);
+    const uint8_t* slotPtr = reader.slots + (static_cast<size_t>(slotIndex) * reader.geometry.slot_stride);
 
     void* texPixels = nullptr;
     int texPitch = 0;
@@ -909,19 +1004,7 @@ int main(int argc, char* argv[]) {
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
 
-    SDL_Event e;
-    while (SDL_PollEvent(&e)) {
-      if (e.type == SDL_QUIT) gShouldExit.store(true);
-      if (e.type == SDL_KEYDOWN) {
-        const bool quitShortcut =
-            e.key.keysym.sym == SDLK_q &&
-            ((e.key.keysym.mod & KMOD_GUI) || (e.key.keysym.mod & KMOD_CTRL));
-        if (e.key.keysym.sym == SDLK_ESCAPE ||
-            quitShortcut) {
-          gShouldExit.store(true);
-        }
-      }
-    }
+    pollSdlEvents();
 
     nextFrameAt += frameInterval;
     auto now = std::chrono::steady_clock::now();
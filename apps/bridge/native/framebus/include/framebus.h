@@ -1,10 +1,25 @@
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #define FRAMEBUS_MAGIC_LE 0x46475242u /* "BRGF" in Little Endian */
 #define FRAMEBUS_VERSION 1
 #define FRAMEBUS_HEADER_SIZE 128
 
+/* Header flags. RETIRED is set by the writer before it drops a segment (on
+ * shutdown or when the output geometry is reconfigured); readers must close
+ * and reopen the name to follow the replacement segment. */
+#define FRAMEBUS_FLAG_RETIRED 0x0001u
+
+/* A Windows mapping lives on while any reader holds it, and creating its name
+ * again returns that old object, size and live header included. A writer
+ * that finds its name taken moves on to "<name>.1", "<name>.2", ... (at most
+ * FRAMEBUS_MAX_GENERATIONS names) instead of re-initialising it, and readers
+ * open the first of those names that holds a segment that is not retired.
+ * POSIX writers unlink and recreate the name, so they only use generation 0. */
+#define FRAMEBUS_MAX_GENERATIONS 8u
+
 typedef enum FrameBusPixelFormat {
   FRAMEBUS_PIXELFORMAT_RGBA8 = 1,
   FRAMEBUS_PIXELFORMAT_BGRA8 = 2,
@@ -37,3 +52,46 @@ static_assert(sizeof(FrameBusHeader) == FRAMEBUS_HEADER_SIZE,
 _Static_assert(sizeof(FrameBusHeader) == FRAMEBUS_HEADER_SIZE,
               "FrameBusHeader size must be 128");
 #endif
+
+/* Geometry a reader mapped the segment with. Readers keep it next to their
+ * mapping and compare it with the live header, which the writer rewrites when
+ * it reconfigures. */
+typedef struct FrameBusSegmentGeometry {
+  uint32_t width;
+  uint32_t height;
+  uint32_t frame_size;
+  uint32_t slot_count;
+  uint32_t slot_stride;
+} FrameBusSegmentGeometry;
+
+static inline FrameBusSegmentGeometry framebus_segment_geometry(const FrameBusHeader *header) {
+  FrameBusSegmentGeometry geometry;
+  geometry.width = header->width;
+  geometry.height = header->height;
+  geometry.frame_size = header->frame_size;
+  geometry.slot_count = header->slot_count;
+  geometry.slot_stride = header->slot_stride;
+  return geometry;
+}
+
+/* Non-zero once the writer retired the segment or changed its geometry since
+ * `opened` was taken: the reader must close its mapping and reopen the name.
+ * Call after loading seq with acquire ordering, which is what makes the
+ * writer's flag visible. */
+static inline int framebus_segment_stale(const FrameBusHeader *header,
+                                         const FrameBusSegmentGeometry *opened) {
+  const volatile FrameBusHeader *live = (const volatile FrameBusHeader *)header;
+  return (live->flags & FRAMEBUS_FLAG_RETIRED) != 0 || live->width != opened->width ||
+         live->height != opened->height || live->frame_size != opened->frame_size ||
+         live->slot_count != opened->slot_count || live->slot_stride != opened->slot_stride;
+}
+
+/* Object name of segment generation `generation` of `name` (see
+ * FRAMEBUS_MAX_GENERATIONS); `name` is already normalised for the platform. */
+static inline void framebus_generation_name(const char *name, uint32_t generation, char *out, size_t out_size) {
+  if (generation == 0u) {
+    snprintf(out, out_size, "%s", name);
+  } else {
+    snprintf(out, out_size, "%s.%u", name, (unsigned)generation);
+  }
+}
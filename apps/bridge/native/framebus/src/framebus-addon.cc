@@ -560,15 +560,34 @@ napi_value OpenReader(napi_env env, napi_callback_info info) {
     return ThrowError(env, "FrameBus name is required");
   }
 #if defined(_WIN32)
-  HANDLE map_handle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
-  if (!map_handle) {
-    return ThrowError(env, "Failed to open shared memory");
+  // A reconfigured writer moves to the next generation name while the old
+  // segment is still mapped somewhere; open the first one that is not retired.
+  HANDLE map_handle = nullptr;
+  void* base = nullptr;
+  bool mapped_any = false;
+  for (uint32_t generation = 0; generation < FRAMEBUS_MAX_GENERATIONS && !base; ++generation) {
+    char generation_name[320];
+    framebus_generation_name(name.c_str(), generation, generation_name, sizeof(generation_name));
+    map_handle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, generation_name);
+    if (!map_handle) {
+      continue;
+    }
+    base = MapViewOfFile(map_handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+    if (!base) {
+      CloseHandle(map_handle);
+      map_handle = nullptr;
+      continue;
+    }
+    mapped_any = true;
+    if ((static_cast<const FrameBusHeader*>(base)->flags & FRAMEBUS_FLAG_RETIRED) != 0) {
+      UnmapViewOfFile(base);
+      CloseHandle(map_handle);
+      base = nullptr;
+      map_handle = nullptr;
+    }
   }
-
-  void* base = MapViewOfFile(map_handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
   if (!base) {
-    CloseHandle(map_handle);
-    return ThrowError(env, "Failed to map shared memory");
+    return ThrowError(env, mapped_any ? "FrameBus segment retired" : "Failed to open shared memory");
   }
 #else
   int fd = shm_open(name.c_str(), O_RDWR, 0600);
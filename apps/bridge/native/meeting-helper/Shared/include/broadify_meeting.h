@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * In-process embedding of the meeting pipeline (camera, keyer, compositor,
+ * program state) for hosts that want program frames without the helper
+ * process and its IPC hops. The meeting-helper executable is a thin wrapper
+ * around the same engine.
+ *
+ * Functions returning int return 0 on success and -1 on failure (invalid
+ * handle or argument, unknown section, camera failure, or an internal error
+ * such as failed allocation; no exception reaches the host). All functions are
+ * thread-safe; callbacks run on engine threads and must not call
+ * broadify_meeting_set_frame_callback, broadify_meeting_set_metrics_callback,
+ * broadify_meeting_stop or broadify_meeting_destroy.
+ */
+
+#define BROADIFY_MEETING_API_VERSION 1u
+
+typedef struct broadify_meeting broadify_meeting_t;
+
+typedef struct broadify_meeting_config {
+  uint32_t width;             /* 0: 1920 */
+  uint32_t height;            /* 0: 1080 */
+  uint32_t fps;               /* 0: 30 */
+  const char *framebus_name;  /* required with framebus_output */
+  const char *models_dir;     /* NULL: the working directory */
+  /* Non-zero also publishes every frame to the FrameBus segment named by
+   * framebus_name, for out-of-process readers (virtual camera, recorder).
+   * The segment is only created while output is on; creating an engine
+   * with output on and no name fails. */
+  int framebus_output;
+} broadify_meeting_config_t;
+
+/*
+ * A newly rendered program frame, handed over in place: `rgba` points at the
+ * compositor's output (usually the FrameBus slot about to be published) and
+ * is only valid for the duration of the callback. Copy what you keep.
+ */
+typedef struct broadify_meeting_frame {
+  const uint8_t *rgba;  /* width * height * 4 bytes, tightly packed RGBA8 */
+  size_t size;
+  uint32_t width;
+  uint32_t height;
+  uint64_t timestamp_ns; /* camera capture time, or render time without one */
+} broadify_meeting_frame_t;
+
+typedef void (*broadify_meeting_frame_callback)(const broadify_meeting_frame_t *frame, void *user_data);
+
+/* Timings are -1 until measured. */
+typedef struct broadify_meeting_metrics {
+  int camera_running;
+  int keyer_enabled;
+  double program_fps;
+  double program_frame_ms;
+  double keyer_fps;
+  double keyer_processing_ms;
+  double mask_age_ms;
+  uint64_t rendered_frames;
+  uint64_t reused_frames;
+  uint64_t composed_tiles;
+  uint64_t recomposed_tiles;
+  uint64_t written_framebus_frames;
+  uint64_t dropped_frames;
+} broadify_meeting_metrics_t;
+
+typedef void (*broadify_meeting_metrics_callback)(const broadify_meeting_metrics_t *metrics, void *user_data);
+
+uint32_t broadify_meeting_api_version(void);
+
+/* config may be NULL for the defaults. Returns NULL on failure. */
+broadify_meeting_t *broadify_meeting_create(const broadify_meeting_config_t *config);
+/* Stops the engine if needed and releases it. */
+void broadify_meeting_destroy(broadify_meeting_t *meeting);
+
+/* Starts the frame pipeline; frames flow once a consumer (frame callback or
+ * FrameBus output) is active. */
+int broadify_meeting_start(broadify_meeting_t *meeting);
+/* Stops the camera and the pipeline. A stopped engine cannot be restarted. */
+void broadify_meeting_stop(broadify_meeting_t *meeting);
+
+int broadify_meeting_camera_start(broadify_meeting_t *meeting, int camera_index);
+void broadify_meeting_camera_stop(broadify_meeting_t *meeting);
+
+/*
+ * Typed program updates. Each is one atomic change, the same as the
+ * corresponding keyer.configure or program.update call of the control
+ * socket; the next rendered frame reflects all of it or none.
+ */
+
+/* model: "modnet", "vision_person_segmentation", "chroma_key",
+ * "clean_plate", or NULL to keep the current one. */
+int broadify_meeting_set_keyer(broadify_meeting_t *meeting, int enabled, const char *model);
+/* mode: "transparent", "gradient", "solid_light" or "checkerboard" (any
+ * other mode fails); image_path is a company background image drawn over it
+ * (NULL or "" for none). */
+int broadify_meeting_set_background(broadify_meeting_t *meeting, const char *mode, const char *image_path);
+/* layout NULL keeps the current layout. */
+int broadify_meeting_set_speaker_layout(broadify_meeting_t *meeting, int enabled, const char *layout, double scale);
+int broadify_meeting_set_camera(broadify_meeting_t *meeting, int enabled, int mirror);
+int broadify_meeting_set_cornerbug(broadify_meeting_t *meeting, int enabled, double x, double y, double size);
+/*
+ * Any program section ("speaker_layout", "cornerbug", "media_layer",
+ * "graphics", "camera") from a JSON object of members: replaces the section,
+ * or with `patch` non-zero only touches the members it names (null removes
+ * one). *field_revision (may be NULL) receives the resulting revision.
+ */
+int broadify_meeting_update_program(broadify_meeting_t *meeting, const char *section, const char *members_json,
+                                    int patch, uint64_t *field_revision);
+
+/* Registers (callback NULL: removes) the program frame callback. Runs on the
+ * pipeline thread before the frame reaches the FrameBus; keep it short. Once
+ * this returns, a replaced callback is no longer running. */
+int broadify_meeting_set_frame_callback(broadify_meeting_t *meeting, broadify_meeting_frame_callback callback,
+                                        void *user_data);
+/* Registers (callback NULL: removes) a metrics callback, called every
+ * interval_ms (0: 1000) while the engine runs. */
+int broadify_meeting_set_metrics_callback(broadify_meeting_t *meeting, broadify_meeting_metrics_callback callback,
+                                          void *user_data, uint32_t interval_ms);
+int broadify_meeting_get_metrics(broadify_meeting_t *meeting, broadify_meeting_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
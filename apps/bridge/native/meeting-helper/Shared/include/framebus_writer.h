@@ -17,12 +17,24 @@ typedef struct framebus_writer_info {
   uint64_t seq;
 } framebus_writer_info_t;
 
+/*
+ * Creates a fresh segment under `name`. An existing segment is never reused:
+ * POSIX unlinks the name first, and on Windows, where a mapping a reader still
+ * holds keeps its name, the writer moves to the next generation name (see
+ * FRAMEBUS_MAX_GENERATIONS in framebus.h).
+ */
 framebus_writer_t *framebus_writer_open(const char *name,
                                         uint32_t width,
                                         uint32_t height,
                                         uint32_t fps,
                                         uint32_t slot_count);
 
+/*
+ * Marks the segment retired (FRAMEBUS_FLAG_RETIRED) and releases it. Readers
+ * still mapping it see the flag and reopen, which is how a reconfigure
+ * (close + open with the same name and a new geometry) reaches them. The
+ * retired segment is never written again.
+ */
 void framebus_writer_close(framebus_writer_t *writer);
 
 int framebus_writer_get_info(const framebus_writer_t *writer,
@@ -33,6 +45,27 @@ int framebus_writer_write_rgba(framebus_writer_t *writer,
                                size_t rgba_size,
                                uint64_t timestamp_ns);
 
+/*
+ * Zero-copy write. acquire returns the slot the next frame goes to
+ * (frame_size bytes, stored in *size) so the producer can render straight
+ * into shared memory; readers never look at it until commit publishes it with
+ * its timestamp. The slot stays writable until the next commit. Returns NULL
+ * when the writer is invalid.
+ *
+ * The producer may already be writing into the slot of frame N once frame
+ * N + slot_count - 1 is committed, so a reader that copied frame N must treat
+ * the copy as torn when seq has reached N + slot_count - 1 afterwards.
+ */
+uint8_t *framebus_writer_acquire(framebus_writer_t *writer, size_t *size);
+
+/*
+ * Most recently committed slot (NULL before the first commit). It stays
+ * intact until the writer laps it, i.e. for slot_count - 1 further acquires.
+ */
+const uint8_t *framebus_writer_latest(const framebus_writer_t *writer);
+
+int framebus_writer_commit(framebus_writer_t *writer, uint64_t timestamp_ns);
+
 #ifdef __cplusplus
 }
 #endif
@@ -117,9 +117,20 @@ framebus_writer_t *framebus_writer_open(const char *name,
   }
 
 #if defined(_WIN32)
-  writer->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
-                                       (DWORD)((map_size >> 32u) & 0xffffffffu),
-                                       (DWORD)(map_size & 0xffffffffu), mapping_name);
+  /* A name some reader still maps returns that old segment: leave it retired
+   * and take the next generation's name (see FRAMEBUS_MAX_GENERATIONS). */
+  for (uint32_t generation = 0; generation < FRAMEBUS_MAX_GENERATIONS; generation++) {
+    char generation_name[272];
+    framebus_generation_name(mapping_name, generation, generation_name, sizeof(generation_name));
+    writer->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                         (DWORD)((map_size >> 32u) & 0xffffffffu),
+                                         (DWORD)(map_size & 0xffffffffu), generation_name);
+    if (writer->mapping == NULL || GetLastError() != ERROR_ALREADY_EXISTS) {
+      break;
+    }
+    CloseHandle(writer->mapping);
+    writer->mapping = NULL;
+  }
   if (writer->mapping == NULL) {
     free(writer);
     return NULL;
@@ -162,10 +173,21 @@ framebus_writer_t *framebus_writer_open(const char *name,
   return writer;
 }
 
+static void retire_header(FrameBusHeader *header) {
+  if (header == NULL) {
+    return;
+  }
+  /* Readers check the flag after loading seq; re-publishing seq with release
+   * ordering makes the flag visible no later than the next seq load. */
+  ((volatile FrameBusHeader *)header)->flags |= FRAMEBUS_FLAG_RETIRED;
+  store_u64(&header->seq, load_seq(header));
+}
+
 void framebus_writer_close(framebus_writer_t *writer) {
   if (writer == NULL) {
     return;
   }
+  retire_header(writer->header);
 #if defined(_WIN32)
   if (writer->base != NULL) {
     UnmapViewOfFile(writer->base);
@@ -200,23 +222,56 @@ int framebus_writer_get_info(const framebus_writer_t *writer,
   return 0;
 }
 
+static uint8_t *slot_for_seq(const framebus_writer_t *writer, uint64_t seq) {
+  const FrameBusHeader *header = writer->header;
+  const uint32_t slot_index = (uint32_t)(seq % header->slot_count);
+  return writer->base + FRAMEBUS_HEADER_SIZE + (size_t)slot_index * header->slot_stride;
+}
+
+uint8_t *framebus_writer_acquire(framebus_writer_t *writer, size_t *size) {
+  if (writer == NULL || writer->header == NULL || writer->header->slot_count == 0) {
+    return NULL;
+  }
+  if (size != NULL) {
+    *size = writer->header->frame_size;
+  }
+  /* Only this process advances seq, so the slot cannot move under us. */
+  return slot_for_seq(writer, load_seq(writer->header));
+}
+
+const uint8_t *framebus_writer_latest(const framebus_writer_t *writer) {
+  if (writer == NULL || writer->header == NULL || writer->header->slot_count == 0) {
+    return NULL;
+  }
+  const uint64_t seq = load_seq(writer->header);
+  if (seq == 0) {
+    return NULL;
+  }
+  return slot_for_seq(writer, seq - 1u);
+}
+
+int framebus_writer_commit(framebus_writer_t *writer, uint64_t timestamp_ns) {
+  if (writer == NULL || writer->header == NULL || writer->header->slot_count == 0) {
+    return -1;
+  }
+  FrameBusHeader *header = writer->header;
+  store_u64(&header->last_write_ns, timestamp_ns);
+  store_u64(&header->seq, load_seq(header) + 1u);
+  return 0;
+}
+
 int framebus_writer_write_rgba(framebus_writer_t *writer,
                                const uint8_t *rgba,
                                size_t rgba_size,
                                uint64_t timestamp_ns) {
-  if (writer == NULL || writer->header == NULL || rgba == NULL) {
+  if (rgba == NULL) {
     return -1;
   }
-  FrameBusHeader *header = writer->header;
-  if (rgba_size != header->frame_size || header->slot_count == 0) {
+  size_t slot_size = 0;
+  uint8_t *slot = framebus_writer_acquire(writer, &slot_size);
+  if (slot == NULL || rgba_size != slot_size) {
     return -1;
   }
-
-  const uint64_t seq = load_seq(header);
-  const uint32_t slot_index = (uint32_t)(seq % header->slot_count);
-  uint8_t *slot = writer->base + FRAMEBUS_HEADER_SIZE + (size_t)slot_index * header->slot_stride;
   memcpy(slot, rgba, rgba_size);
-  store_u64(&header->last_write_ns, timestamp_ns);
-  store_u64(&header->seq, seq + 1u);
-  return 0;
+  return framebus_writer_commit(writer, timestamp_ns);
 }
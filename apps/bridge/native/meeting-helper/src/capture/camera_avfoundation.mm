@@ -377,6 +377,18 @@ class AvFoundationCameraSource final : public CameraSource {
     return true;
   }
 
+  bool readLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs,
+                           const std::function<void(const VideoFrame &)> &read) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = streams_.find(cameraIndex);
+    if (it == streams_.end() || !it->second->hasFrame ||
+        it->second->latestFrame.timestampNs == lastTimestampNs) {
+      return false;
+    }
+    read(it->second->latestFrame);
+    return true;
+  }
+
   bool isRunning() const override {
     std::lock_guard<std::mutex> lock(mutex_);
     return running_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -86,6 +87,21 @@ class CameraSource {
     return copyLatestFrameIfNew(lastTimestampNs, frame);
   }
 
+  // Like copyLatestFrameFrom, but hands the newest frame to `read` in place
+  // instead of copying it: backends that keep it call `read` under their frame
+  // lock, so it should be short (e.g. a thumbnail downscale) and must not call
+  // back into the source. False, without calling `read`, when there is
+  // nothing newer than lastTimestampNs.
+  virtual bool readLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs,
+                                   const std::function<void(const VideoFrame &)> &read) {
+    VideoFrame frame;
+    if (!copyLatestFrameFrom(cameraIndex, lastTimestampNs, frame)) {
+      return false;
+    }
+    read(frame);
+    return true;
+  }
+
   // --- Auto-director (V3) ----------------------------------------------------
   // Recent audio level (0..1, smoothed RMS) of each open camera's paired
   // microphone, keyed by camera index. Empty when audio capture is unsupported.
@@ -1,6 +1,6 @@
 #include "capture/camera_source.h"
 
-#if !defined(__APPLE__)
+#if !defined(__APPLE__) && !defined(__linux__)
 
 #include "util/json_utils.h"
 
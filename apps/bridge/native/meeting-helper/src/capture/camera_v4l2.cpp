@@ -0,0 +1,767 @@
+#include "capture/camera_source.h"
+
+#if defined(__linux__)
+
+#include "capture/yuv_convert.h"
+#include "util/json_utils.h"
+#include "util/thread_roles.h"
+#include "util/worker_pool.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#if BROADIFY_ENABLE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+constexpr uint32_t kCaptureBufferCount = 4;
+constexpr int kPollTimeoutMs = 200;
+// Rows per conversion band; 1080p splits into ~8 bands.
+constexpr uint32_t kConversionBandRows = 136;
+constexpr size_t kMaxSpareFrames = 3;
+
+std::string lowerAscii(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) {
+    return static_cast<char>(std::tolower(ch));
+  });
+  return value;
+}
+
+bool isBroadifyVirtualCamera(const std::string &card) {
+  const std::string haystack = lowerAscii(card);
+  return haystack.find("broadify camera") != std::string::npos ||
+         haystack.find("broadify virtual camera") != std::string::npos;
+}
+
+int retryIoctl(int fd, unsigned long request, void *arg) {
+  int result = 0;
+  do {
+    result = ioctl(fd, request, arg);
+  } while (result == -1 && errno == EINTR);
+  return result;
+}
+
+std::string errnoMessage(const std::string &what) {
+  return what + ": " + std::strerror(errno);
+}
+
+#if BROADIFY_ENABLE_LIBJPEG
+struct JpegErrorManager {
+  jpeg_error_mgr base;
+  jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info) {
+  longjmp(reinterpret_cast<JpegErrorManager *>(info->err)->jump, 1);
+}
+
+void jpegSilence(j_common_ptr, int) {}
+
+// Decodes one UVC MJPEG frame straight to RGBA. libjpeg-turbo substitutes
+// the standard Huffman tables that many webcams omit.
+bool decodeMjpegToRgba(const std::vector<uint8_t> &jpeg, VideoFrame &frame) {
+  jpeg_decompress_struct decoder;
+  JpegErrorManager errors;
+  decoder.err = jpeg_std_error(&errors.base);
+  errors.base.error_exit = jpegErrorExit;
+  errors.base.emit_message = jpegSilence;
+  if (setjmp(errors.jump)) {
+    jpeg_destroy_decompress(&decoder);
+    return false;
+  }
+  jpeg_create_decompress(&decoder);
+  jpeg_mem_src(&decoder, jpeg.data(), static_cast<unsigned long>(jpeg.size()));
+  if (jpeg_read_header(&decoder, TRUE) != JPEG_HEADER_OK) {
+    jpeg_destroy_decompress(&decoder);
+    return false;
+  }
+  decoder.out_color_space = JCS_EXT_RGBA;
+  decoder.dct_method = JDCT_IFAST;
+  jpeg_start_decompress(&decoder);
+  frame.width = decoder.output_width;
+  frame.height = decoder.output_height;
+  frame.rgba.resize(static_cast<size_t>(frame.width) * frame.height * 4u);
+  while (decoder.output_scanline < decoder.output_height) {
+    JSAMPROW row = frame.rgba.data() + static_cast<size_t>(decoder.output_scanline) * frame.width * 4u;
+    jpeg_read_scanlines(&decoder, &row, 1);
+  }
+  jpeg_finish_decompress(&decoder);
+  jpeg_destroy_decompress(&decoder);
+  return true;
+}
+#endif
+
+bool isSupportedPixelFormat(uint32_t pixelFormat) {
+#if BROADIFY_ENABLE_LIBJPEG
+  if (pixelFormat == V4L2_PIX_FMT_MJPEG) {
+    return true;
+  }
+#endif
+  return pixelFormat == V4L2_PIX_FMT_NV12 || pixelFormat == V4L2_PIX_FMT_YUYV;
+}
+
+// Raw formats first: they need no decode. MJPEG wins only when the raw
+// formats cannot reach the requested size at the requested rate (typical
+// for 1080p30 over USB 2).
+int pixelFormatPreference(uint32_t pixelFormat) {
+  switch (pixelFormat) {
+    case V4L2_PIX_FMT_NV12:
+      return 0;
+    case V4L2_PIX_FMT_YUYV:
+      return 1;
+    default:
+      return 2;
+  }
+}
+
+bool supportsFrameRate(int fd, uint32_t pixelFormat, uint32_t width, uint32_t height, uint32_t fps) {
+  v4l2_frmivalenum interval{};
+  interval.pixel_format = pixelFormat;
+  interval.width = width;
+  interval.height = height;
+  if (retryIoctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &interval) != 0) {
+    // Drivers without interval enumeration: trust S_PARM later.
+    return true;
+  }
+  if (interval.type != V4L2_FRMIVAL_TYPE_DISCRETE) {
+    const v4l2_fract &fastest = interval.stepwise.min;
+    return static_cast<uint64_t>(fastest.numerator) * fps <= fastest.denominator;
+  }
+  do {
+    if (static_cast<uint64_t>(interval.discrete.numerator) * fps <= interval.discrete.denominator) {
+      return true;
+    }
+    ++interval.index;
+  } while (retryIoctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &interval) == 0);
+  return false;
+}
+
+struct CaptureFormat {
+  uint32_t pixelFormat = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// Same scoring as the AVFoundation backend: closest size, never below target
+// when avoidable, and only formats that can deliver the requested rate.
+bool chooseCaptureFormat(int fd, uint32_t targetWidth, uint32_t targetHeight,
+                         uint32_t targetFps, CaptureFormat &chosen) {
+  double bestScore = std::numeric_limits<double>::max();
+  bool found = false;
+  v4l2_fmtdesc description{};
+  description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  for (; retryIoctl(fd, VIDIOC_ENUM_FMT, &description) == 0; ++description.index) {
+    if (!isSupportedPixelFormat(description.pixelformat)) {
+      continue;
+    }
+    std::vector<CaptureFormat> sizes;
+    v4l2_frmsizeenum size{};
+    size.pixel_format = description.pixelformat;
+    if (retryIoctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) != 0) {
+      sizes.push_back({description.pixelformat, targetWidth, targetHeight});
+    } else if (size.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+      do {
+        sizes.push_back({description.pixelformat, size.discrete.width, size.discrete.height});
+        ++size.index;
+      } while (retryIoctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0);
+    } else {
+      const v4l2_frmsize_stepwise &range = size.stepwise;
+      const auto snap = [](uint32_t value, uint32_t low, uint32_t high, uint32_t step) {
+        value = std::clamp(value, low, high);
+        return step > 1u ? low + (value - low) / step * step : value;
+      };
+      sizes.push_back({description.pixelformat,
+                       snap(targetWidth, range.min_width, range.max_width, range.step_width),
+                       snap(targetHeight, range.min_height, range.max_height, range.step_height)});
+    }
+
+    for (const CaptureFormat &candidate : sizes) {
+      const bool belowTarget = candidate.width < targetWidth || candidate.height < targetHeight;
+      const bool rateOk = targetFps == 0u ||
+          supportsFrameRate(fd, candidate.pixelFormat, candidate.width, candidate.height, targetFps);
+      const double score =
+          std::abs(static_cast<double>(candidate.width) - targetWidth) +
+          std::abs(static_cast<double>(candidate.height) - targetHeight) +
+          (belowTarget ? 1000000.0 : 0.0) + (rateOk ? 0.0 : 10000000.0) +
+          pixelFormatPreference(candidate.pixelFormat) * 0.25;
+      if (score < bestScore) {
+        bestScore = score;
+        chosen = candidate;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+struct MappedBuffer {
+  void *start = MAP_FAILED;
+  size_t length = 0;
+};
+
+struct CameraStream {
+  int cameraIndex = -1;
+  int fd = -1;
+  uint32_t pixelFormat = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t bytesPerLine = 0;
+  std::vector<MappedBuffer> buffers;
+  std::thread captureThread;
+  std::atomic<bool> running{false};
+  std::atomic<uint32_t> decodesInFlight{0};
+  std::atomic<uint64_t> droppedFrames{0};
+
+  // Guarded by the owning source's mutex.
+  VideoFrame latestFrame;
+  bool hasFrame = false;
+  std::vector<VideoFrame> spareFrames;
+};
+
+uint64_t bufferTimestampNs(const v4l2_buffer &buffer) {
+  if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+    // Same clock as steady_clock (CLOCK_MONOTONIC), so frame ages stay
+    // comparable with nowNs() across the pipeline.
+    return static_cast<uint64_t>(buffer.timestamp.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(buffer.timestamp.tv_usec) * 1000ull;
+  }
+  return nowNs();
+}
+
+void closeStreamDevice(CameraStream &stream) {
+  if (stream.fd >= 0) {
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    retryIoctl(stream.fd, VIDIOC_STREAMOFF, &type);
+  }
+  for (MappedBuffer &buffer : stream.buffers) {
+    if (buffer.start != MAP_FAILED) {
+      munmap(buffer.start, buffer.length);
+    }
+  }
+  stream.buffers.clear();
+  if (stream.fd >= 0) {
+    v4l2_requestbuffers release{};
+    release.count = 0;
+    release.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    release.memory = V4L2_MEMORY_MMAP;
+    retryIoctl(stream.fd, VIDIOC_REQBUFS, &release);
+    close(stream.fd);
+    stream.fd = -1;
+  }
+}
+
+}  // namespace
+
+class V4l2CameraSource final : public CameraSource {
+ public:
+  V4l2CameraSource() = default;
+
+  ~V4l2CameraSource() override {
+    stop();
+  }
+
+  std::vector<CameraInfo> listCameras() override {
+    std::vector<CameraInfo> cameras;
+    for (const std::string &path : captureDevicePaths()) {
+      const int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+      if (fd < 0) {
+        if (errno == EACCES) {
+          setPermissionStatus("denied");
+        }
+        continue;
+      }
+      v4l2_capability capability{};
+      const bool queried = retryIoctl(fd, VIDIOC_QUERYCAP, &capability) == 0;
+      close(fd);
+      if (!queried) {
+        continue;
+      }
+      const uint32_t caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) != 0u
+          ? capability.device_caps
+          : capability.capabilities;
+      if ((caps & V4L2_CAP_VIDEO_CAPTURE) == 0u || (caps & V4L2_CAP_STREAMING) == 0u) {
+        // Metadata nodes and M2M devices share the /dev/video namespace.
+        continue;
+      }
+      const std::string card = reinterpret_cast<const char *>(capability.card);
+      const std::string driver = reinterpret_cast<const char *>(capability.driver);
+      const std::string busInfo = reinterpret_cast<const char *>(capability.bus_info);
+      if (isBroadifyVirtualCamera(card)) {
+        continue;
+      }
+
+      CameraInfo info;
+      info.cameraIndex = static_cast<int>(cameras.size());
+      info.label = card;
+      info.cameraId = path;
+      info.displayName = card;
+      info.stableKey = busInfo + ":" + card;
+      info.backend = "v4l2";
+      info.deviceName = path;
+      const std::string lowerCard = lowerAscii(card);
+      info.builtinCandidate = lowerCard.find("integrated") != std::string::npos ||
+                              lowerCard.find("built-in") != std::string::npos;
+      info.virtualCandidate = driver == "v4l2 loopback" ||
+                              lowerCard.find("virtual") != std::string::npos ||
+                              lowerCard.find("obs") != std::string::npos;
+      info.continuityCandidate = false;
+      info.available = true;
+      info.active = isOpen(info.cameraIndex);
+      cameras.push_back(info);
+    }
+    return cameras;
+  }
+
+  bool selectCamera(int cameraIndex) override {
+    const std::vector<CameraInfo> cameras = listCameras();
+    const bool known = std::any_of(cameras.begin(), cameras.end(), [cameraIndex](const CameraInfo &info) {
+      return info.cameraIndex == cameraIndex;
+    });
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!known) {
+      lastError_ = "Requested camera index is not available.";
+      return false;
+    }
+    programIndex_ = cameraIndex;
+    lastError_.clear();
+    return true;
+  }
+
+  bool start(int cameraIndex, uint32_t width, uint32_t height, uint32_t fps) override {
+    int resolvedIndex = cameraIndex;
+    if (resolvedIndex < 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      resolvedIndex = programIndex_;
+    }
+    return startSet({resolvedIndex}, width, height, fps);
+  }
+
+  bool startSet(const std::vector<int> &cameraIndices, uint32_t width,
+                uint32_t height, uint32_t fps) override {
+    stop();
+    if (cameraIndices.empty()) {
+      setError("No cameras requested.");
+      return false;
+    }
+    if (!pool_) {
+      // Own pool rather than the shared render one: MJPEG decodes queue here
+      // and must not delay compositor work.
+      const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+      pool_ = std::make_unique<WorkerPool>(std::clamp(cores / 2u, 1u, 4u));
+    }
+
+    const std::vector<CameraInfo> cameras = listCameras();
+    std::map<int, std::shared_ptr<CameraStream>> opened;
+    std::string openError;
+    for (int requestedIndex : cameraIndices) {
+      const auto camera = std::find_if(cameras.begin(), cameras.end(), [requestedIndex](const CameraInfo &info) {
+        return info.cameraIndex == requestedIndex;
+      });
+      if (camera == cameras.end()) {
+        openError = "Requested camera index is not available.";
+        continue;
+      }
+      auto stream = openStream(camera->cameraIndex, camera->cameraId, width, height, fps, openError);
+      if (stream) {
+        opened[camera->cameraIndex] = stream;
+      }
+    }
+    if (opened.empty()) {
+      setError(openError.empty() ? "No requested camera could be opened." : openError);
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      streams_ = opened;
+      programIndex_ = opened.count(cameraIndices.front()) ? cameraIndices.front() : opened.begin()->first;
+      running_ = true;
+      lastError_.clear();
+      permissionStatus_ = "authorized";
+    }
+    for (auto &entry : opened) {
+      std::shared_ptr<CameraStream> stream = entry.second;
+      stream->running.store(true);
+      stream->captureThread = std::thread([this, stream]() {
+        ScopedThreadRole role("camera_capture");
+        captureLoop(stream);
+      });
+    }
+    return true;
+  }
+
+  void stop() override {
+    std::map<int, std::shared_ptr<CameraStream>> streams;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      streams.swap(streams_);
+      running_ = false;
+    }
+    for (auto &entry : streams) {
+      entry.second->running.store(false);
+    }
+    for (auto &entry : streams) {
+      if (entry.second->captureThread.joinable()) {
+        entry.second->captureThread.join();
+      }
+    }
+    if (pool_) {
+      // Pending MJPEG decodes only hold copies of the compressed data; let
+      // them drain so no worker publishes into a closed stream afterwards.
+      pool_->waitIdle();
+    }
+    for (auto &entry : streams) {
+      closeStreamDevice(*entry.second);
+    }
+  }
+
+  bool isRunning() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+  }
+
+  int activeCameraIndex() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_ ? programIndex_ : -1;
+  }
+
+  bool copyLatestFrame(VideoFrame &frame) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = streams_.find(programIndex_);
+    if (it == streams_.end() || !it->second->hasFrame) {
+      return false;
+    }
+    frame = it->second->latestFrame;
+    return true;
+  }
+
+  bool copyLatestFrameIfNew(uint64_t lastTimestampNs, VideoFrame &frame) override {
+    return copyLatestFrameFrom(activeCameraIndex(), lastTimestampNs, frame);
+  }
+
+  bool setProgramCamera(int cameraIndex) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (streams_.count(cameraIndex) == 0) {
+      lastError_ = "Requested program camera is not open.";
+      return false;
+    }
+    programIndex_ = cameraIndex;
+    lastError_.clear();
+    return true;
+  }
+
+  std::vector<int> activeCameraSet() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int> indices;
+    indices.reserve(streams_.size());
+    for (const auto &entry : streams_) {
+      indices.push_back(entry.first);
+    }
+    return indices;
+  }
+
+  bool copyLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs,
+                           VideoFrame &frame) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = streams_.find(cameraIndex);
+    if (it == streams_.end() || !it->second->hasFrame ||
+        it->second->latestFrame.timestampNs == lastTimestampNs) {
+      return false;
+    }
+    frame = it->second->latestFrame;
+    return true;
+  }
+
+  bool readLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs,
+                           const std::function<void(const VideoFrame &)> &read) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = streams_.find(cameraIndex);
+    if (it == streams_.end() || !it->second->hasFrame ||
+        it->second->latestFrame.timestampNs == lastTimestampNs) {
+      return false;
+    }
+    read(it->second->latestFrame);
+    return true;
+  }
+
+  std::string lastError() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+  }
+
+  // V4L2 has no consent prompt; access is governed by /dev/video* file
+  // permissions (usually the "video" group).
+  std::string cameraPermissionStatus() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return permissionStatus_;
+  }
+
+  std::string requestCameraPermission() override {
+    listCameras();
+    return cameraPermissionStatus();
+  }
+
+ private:
+  static std::vector<std::string> captureDevicePaths() {
+    std::vector<std::pair<int, std::string>> numbered;
+    DIR *dir = opendir("/dev");
+    if (dir == nullptr) {
+      return {};
+    }
+    while (const dirent *entry = readdir(dir)) {
+      const std::string name = entry->d_name;
+      if (name.rfind("video", 0) != 0 || name.size() == 5u ||
+          !std::all_of(name.begin() + 5, name.end(), [](unsigned char ch) { return std::isdigit(ch) != 0; })) {
+        continue;
+      }
+      numbered.emplace_back(std::stoi(name.substr(5)), "/dev/" + name);
+    }
+    closedir(dir);
+    std::sort(numbered.begin(), numbered.end());
+    std::vector<std::string> paths;
+    for (auto &entry : numbered) {
+      paths.push_back(std::move(entry.second));
+    }
+    return paths;
+  }
+
+  bool isOpen(int cameraIndex) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_ && streams_.count(cameraIndex) != 0;
+  }
+
+  void setError(const std::string &message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastError_ = message;
+  }
+
+  void setPermissionStatus(const std::string &status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    permissionStatus_ = status;
+  }
+
+  std::shared_ptr<CameraStream> openStream(int cameraIndex, const std::string &path,
+                                           uint32_t width, uint32_t height, uint32_t fps,
+                                           std::string &error) {
+    auto stream = std::make_shared<CameraStream>();
+    stream->cameraIndex = cameraIndex;
+    stream->fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+    if (stream->fd < 0) {
+      if (errno == EACCES) {
+        setPermissionStatus("denied");
+      }
+      error = errnoMessage("Could not open " + path);
+      return nullptr;
+    }
+
+    CaptureFormat format;
+    if (!chooseCaptureFormat(stream->fd, width, height, fps, format)) {
+      error = "Camera " + path + " offers no supported pixel format (NV12, YUYV or MJPEG).";
+      closeStreamDevice(*stream);
+      return nullptr;
+    }
+    v4l2_format requested{};
+    requested.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    requested.fmt.pix.width = format.width;
+    requested.fmt.pix.height = format.height;
+    requested.fmt.pix.pixelformat = format.pixelFormat;
+    requested.fmt.pix.field = V4L2_FIELD_NONE;
+    if (retryIoctl(stream->fd, VIDIOC_S_FMT, &requested) != 0 ||
+        !isSupportedPixelFormat(requested.fmt.pix.pixelformat) ||
+        requested.fmt.pix.width % 2u != 0u) {
+      error = errnoMessage("Could not set the capture format of " + path);
+      closeStreamDevice(*stream);
+      return nullptr;
+    }
+    stream->pixelFormat = requested.fmt.pix.pixelformat;
+    stream->width = requested.fmt.pix.width;
+    stream->height = requested.fmt.pix.height;
+    stream->bytesPerLine = requested.fmt.pix.bytesperline;
+
+    if (fps > 0u) {
+      v4l2_streamparm parameters{};
+      parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      parameters.parm.capture.timeperframe.numerator = 1;
+      parameters.parm.capture.timeperframe.denominator = fps;
+      retryIoctl(stream->fd, VIDIOC_S_PARM, &parameters);
+    }
+
+    v4l2_requestbuffers request{};
+    request.count = kCaptureBufferCount;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (retryIoctl(stream->fd, VIDIOC_REQBUFS, &request) != 0 || request.count < 2u) {
+      error = errnoMessage("Could not allocate capture buffers for " + path);
+      closeStreamDevice(*stream);
+      return nullptr;
+    }
+    for (uint32_t i = 0; i < request.count; ++i) {
+      v4l2_buffer buffer{};
+      buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buffer.memory = V4L2_MEMORY_MMAP;
+      buffer.index = i;
+      MappedBuffer mapped;
+      if (retryIoctl(stream->fd, VIDIOC_QUERYBUF, &buffer) == 0) {
+        mapped.length = buffer.length;
+        mapped.start = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, stream->fd, buffer.m.offset);
+      }
+      if (mapped.start == MAP_FAILED || retryIoctl(stream->fd, VIDIOC_QBUF, &buffer) != 0) {
+        error = errnoMessage("Could not map capture buffers for " + path);
+        stream->buffers.push_back(mapped);
+        closeStreamDevice(*stream);
+        return nullptr;
+      }
+      stream->buffers.push_back(mapped);
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (retryIoctl(stream->fd, VIDIOC_STREAMON, &type) != 0) {
+      error = errnoMessage("Could not start streaming from " + path);
+      closeStreamDevice(*stream);
+      return nullptr;
+    }
+    return stream;
+  }
+
+  // Takes a recycled frame buffer so steady-state capture does not allocate.
+  VideoFrame takeSpareFrame(CameraStream &stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stream.spareFrames.empty()) {
+      return VideoFrame{};
+    }
+    VideoFrame frame = std::move(stream.spareFrames.back());
+    stream.spareFrames.pop_back();
+    return frame;
+  }
+
+  // Swaps `frame` in as the newest frame of `stream`. Out-of-order MJPEG
+  // decodes are dropped rather than moving the stream back in time.
+  void publishFrame(CameraStream &stream, VideoFrame &&frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stream.hasFrame && frame.timestampNs <= stream.latestFrame.timestampNs) {
+      stream.droppedFrames.fetch_add(1u);
+    } else {
+      std::swap(stream.latestFrame, frame);
+      stream.hasFrame = true;
+    }
+    if (!frame.rgba.empty() && stream.spareFrames.size() < kMaxSpareFrames) {
+      stream.spareFrames.push_back(std::move(frame));
+    }
+  }
+
+  void convertRawFrame(CameraStream &stream, const uint8_t *data, VideoFrame &frame) {
+    frame.width = stream.width;
+    frame.height = stream.height;
+    frame.rgba.resize(static_cast<size_t>(stream.width) * stream.height * 4u);
+    const uint32_t bands = std::max(1u, (stream.height + kConversionBandRows - 1u) / kConversionBandRows);
+    pool_->parallelFor(bands, [&](uint32_t band) {
+      const uint32_t rowBegin = band * kConversionBandRows;
+      const uint32_t rowEnd = std::min(stream.height, rowBegin + kConversionBandRows);
+      if (stream.pixelFormat == V4L2_PIX_FMT_NV12) {
+        // Even band heights keep each chroma row inside one band.
+        convertNv12ToRgba(data, stream.bytesPerLine,
+                          data + static_cast<size_t>(stream.bytesPerLine) * stream.height, stream.bytesPerLine,
+                          frame.rgba.data(), stream.width, rowBegin, rowEnd);
+      } else {
+        convertYuyvToRgba(data, stream.bytesPerLine, frame.rgba.data(), stream.width, rowBegin, rowEnd);
+      }
+    });
+  }
+
+  void captureLoop(std::shared_ptr<CameraStream> stream) {
+    pollfd descriptor{};
+    descriptor.fd = stream->fd;
+    descriptor.events = POLLIN;
+    while (stream->running.load()) {
+      const int ready = poll(&descriptor, 1, kPollTimeoutMs);
+      if (ready <= 0) {
+        continue;
+      }
+      v4l2_buffer buffer{};
+      buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buffer.memory = V4L2_MEMORY_MMAP;
+      if (retryIoctl(stream->fd, VIDIOC_DQBUF, &buffer) != 0) {
+        if (errno == EAGAIN) {
+          continue;
+        }
+        setError(errnoMessage("Camera capture stopped"));
+        return;
+      }
+      const uint64_t timestampNs = bufferTimestampNs(buffer);
+      const uint8_t *data = static_cast<const uint8_t *>(stream->buffers[buffer.index].start);
+      const bool usable = (buffer.flags & V4L2_BUF_FLAG_ERROR) == 0u && buffer.bytesused > 0u;
+
+      if (usable && stream->pixelFormat == V4L2_PIX_FMT_MJPEG) {
+#if BROADIFY_ENABLE_LIBJPEG
+        // Copy out the compressed frame (a few hundred KB), hand the kernel
+        // buffer straight back and decode on the pool. When every worker is
+        // busy the frame is dropped instead of queueing latency.
+        if (stream->decodesInFlight.load() < pool_->workerCount()) {
+          stream->decodesInFlight.fetch_add(1u);
+          auto jpeg = std::make_shared<std::vector<uint8_t>>(data, data + buffer.bytesused);
+          pool_->post([this, stream, jpeg, timestampNs]() {
+            VideoFrame frame = takeSpareFrame(*stream);
+            if (decodeMjpegToRgba(*jpeg, frame)) {
+              frame.timestampNs = timestampNs;
+              publishFrame(*stream, std::move(frame));
+            }
+            stream->decodesInFlight.fetch_sub(1u);
+          });
+        } else {
+          stream->droppedFrames.fetch_add(1u);
+        }
+#endif
+        retryIoctl(stream->fd, VIDIOC_QBUF, &buffer);
+        continue;
+      }
+
+      if (usable) {
+        // Raw formats convert straight out of the mmap'd kernel buffer into
+        // the RGBA frame the pipeline reads: one pass, no staging copy.
+        VideoFrame frame = takeSpareFrame(*stream);
+        convertRawFrame(*stream, data, frame);
+        frame.timestampNs = timestampNs;
+        retryIoctl(stream->fd, VIDIOC_QBUF, &buffer);
+        publishFrame(*stream, std::move(frame));
+      } else {
+        retryIoctl(stream->fd, VIDIOC_QBUF, &buffer);
+      }
+    }
+  }
+
+  mutable std::mutex mutex_;
+  bool running_ = false;
+  int programIndex_ = 0;
+  std::string lastError_;
+  std::string permissionStatus_ = "authorized";
+  std::map<int, std::shared_ptr<CameraStream>> streams_;
+  std::unique_ptr<WorkerPool> pool_;
+};
+
+std::unique_ptr<CameraSource> createCameraSource() {
+  return std::make_unique<V4l2CameraSource>();
+}
+
+}  // namespace broadify::meeting
+
+#endif
@@ -0,0 +1,203 @@
+#include "capture/yuv_convert.h"
+
+#include "util/simd.h"
+
+#include <algorithm>
+
+namespace broadify::meeting {
+namespace {
+
+// 8.8 fixed point BT.601 limited-range coefficients.
+constexpr int kYScale = 298;
+constexpr int kRFromV = 409;
+constexpr int kGFromU = 100;
+constexpr int kGFromV = 208;
+constexpr int kBFromU = 516;
+
+inline uint8_t clampToByte(int value) {
+  return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+// Writes two horizontally adjacent pixels that share one chroma sample.
+// Branch-free so the row loops vectorise.
+inline void storePair(uint8_t *out, int y0, int y1, int u, int v) {
+  const int d = u - 128;
+  const int e = v - 128;
+  const int rOffset = kRFromV * e + 128;
+  const int gOffset = -kGFromU * d - kGFromV * e + 128;
+  const int bOffset = kBFromU * d + 128;
+  const int c0 = kYScale * (y0 - 16);
+  const int c1 = kYScale * (y1 - 16);
+  out[0] = clampToByte((c0 + rOffset) >> 8);
+  out[1] = clampToByte((c0 + gOffset) >> 8);
+  out[2] = clampToByte((c0 + bOffset) >> 8);
+  out[3] = 255;
+  out[4] = clampToByte((c1 + rOffset) >> 8);
+  out[5] = clampToByte((c1 + gOffset) >> 8);
+  out[6] = clampToByte((c1 + bOffset) >> 8);
+  out[7] = 255;
+}
+
+#if defined(BROADIFY_SIMD_SSE2)
+// Eight pixels from int16 luma C = Y - 16 and per-pixel chroma D = U - 128,
+// E = V - 128. Products are formed in 32 bits with madd, so results are
+// bit-exact with storePair; packs/packus provide the clamp.
+inline void storeEightSse2(uint8_t *out, __m128i c, __m128i d, __m128i e) {
+  const __m128i rCoeff = _mm_set1_epi32(kYScale | (kRFromV << 16));
+  const __m128i gCoeffCd = _mm_set1_epi32(kYScale | ((-kGFromU & 0xffff) << 16));
+  const __m128i gCoeffE = _mm_set1_epi32(-kGFromV & 0xffff);
+  const __m128i bCoeff = _mm_set1_epi32(kYScale | (kBFromU << 16));
+  const __m128i round = _mm_set1_epi32(128);
+  const __m128i zero = _mm_setzero_si128();
+
+  const __m128i ceLo = _mm_unpacklo_epi16(c, e);
+  const __m128i ceHi = _mm_unpackhi_epi16(c, e);
+  const __m128i cdLo = _mm_unpacklo_epi16(c, d);
+  const __m128i cdHi = _mm_unpackhi_epi16(c, d);
+  const __m128i eLo = _mm_unpacklo_epi16(e, zero);
+  const __m128i eHi = _mm_unpackhi_epi16(e, zero);
+
+  const __m128i r = _mm_packs_epi32(
+      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, rCoeff), round), 8),
+      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, rCoeff), round), 8));
+  const __m128i g = _mm_packs_epi32(
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, gCoeffCd),
+                                                 _mm_madd_epi16(eLo, gCoeffE)), round), 8),
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, gCoeffCd),
+                                                 _mm_madd_epi16(eHi, gCoeffE)), round), 8));
+  const __m128i b = _mm_packs_epi32(
+      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, bCoeff), round), 8),
+      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, bCoeff), round), 8));
+
+  const __m128i r8 = _mm_packus_epi16(r, r);
+  const __m128i g8 = _mm_packus_epi16(g, g);
+  const __m128i b8 = _mm_packus_epi16(b, b);
+  const __m128i a8 = _mm_set1_epi8(static_cast<char>(0xff));
+  const __m128i rg = _mm_unpacklo_epi8(r8, g8);
+  const __m128i ba = _mm_unpacklo_epi8(b8, a8);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi16(rg, ba));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi16(rg, ba));
+}
+
+// Splits int16 lanes U0 V0 U1 V1 .. into per-pixel D and E (each chroma
+// sample duplicated for its two pixels), both already offset by -128.
+inline void splitChromaSse2(__m128i uv, __m128i &d, __m128i &e) {
+  const __m128i bias = _mm_set1_epi16(128);
+  d = _mm_sub_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+                                        _MM_SHUFFLE(2, 2, 0, 0)), bias);
+  e = _mm_sub_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+                                        _MM_SHUFFLE(3, 3, 1, 1)), bias);
+}
+#elif defined(BROADIFY_SIMD_NEON)
+inline uint8x8_t narrowChannel(int32x4_t lo, int32x4_t hi) {
+  const int32x4_t round = vdupq_n_s32(128);
+  return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(vaddq_s32(lo, round), 8)),
+                                  vqmovn_s32(vshrq_n_s32(vaddq_s32(hi, round), 8))));
+}
+
+// Same arithmetic as storePair on eight pixels; vst4 does the interleave.
+inline void storeEightNeon(uint8_t *out, int16x8_t c, int16x8_t d, int16x8_t e) {
+  const int16x4_t cLo = vget_low_s16(c);
+  const int16x4_t cHi = vget_high_s16(c);
+  const int16x4_t dLo = vget_low_s16(d);
+  const int16x4_t dHi = vget_high_s16(d);
+  const int16x4_t eLo = vget_low_s16(e);
+  const int16x4_t eHi = vget_high_s16(e);
+  const int32x4_t yLo = vmull_n_s16(cLo, kYScale);
+  const int32x4_t yHi = vmull_n_s16(cHi, kYScale);
+  uint8x8x4_t pixels;
+  pixels.val[0] = narrowChannel(vmlal_n_s16(yLo, eLo, kRFromV), vmlal_n_s16(yHi, eHi, kRFromV));
+  pixels.val[1] = narrowChannel(
+      vmlsl_n_s16(vmlsl_n_s16(yLo, dLo, kGFromU), eLo, kGFromV),
+      vmlsl_n_s16(vmlsl_n_s16(yHi, dHi, kGFromU), eHi, kGFromV));
+  pixels.val[2] = narrowChannel(vmlal_n_s16(yLo, dLo, kBFromU), vmlal_n_s16(yHi, dHi, kBFromU));
+  pixels.val[3] = vdup_n_u8(255);
+  vst4_u8(out, pixels);
+}
+
+inline void splitChromaNeon(uint8x8_t uv, int16x8_t &d, int16x8_t &e) {
+  const uint8x8x2_t planar = vuzp_u8(uv, uv);
+  const int16x8_t bias = vdupq_n_s16(128);
+  d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vzip_u8(planar.val[0], planar.val[0]).val[0])), bias);
+  e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vzip_u8(planar.val[1], planar.val[1]).val[0])), bias);
+}
+#endif
+
+}  // namespace
+
+void convertYuyvToRgba(const uint8_t *src, size_t srcStride,
+                       uint8_t *dst, uint32_t width,
+                       uint32_t rowBegin, uint32_t rowEnd) {
+  const size_t dstStride = static_cast<size_t>(width) * 4u;
+  for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+    const uint8_t *in = src + static_cast<size_t>(y) * srcStride;
+    uint8_t *out = dst + static_cast<size_t>(y) * dstStride;
+    uint32_t x = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+    const __m128i lumaMask = _mm_set1_epi16(0x00ff);
+    const __m128i lumaBias = _mm_set1_epi16(16);
+    for (; x + 8u <= width; x += 8u) {
+      const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x * 2u));
+      __m128i d;
+      __m128i e;
+      splitChromaSse2(_mm_srli_epi16(packed, 8), d, e);
+      storeEightSse2(out + static_cast<size_t>(x) * 4u,
+                     _mm_sub_epi16(_mm_and_si128(packed, lumaMask), lumaBias), d, e);
+    }
+#elif defined(BROADIFY_SIMD_NEON)
+    for (; x + 8u <= width; x += 8u) {
+      const uint8x8x2_t packed = vld2_u8(in + x * 2u);
+      int16x8_t d;
+      int16x8_t e;
+      splitChromaNeon(packed.val[1], d, e);
+      storeEightNeon(out + static_cast<size_t>(x) * 4u,
+                     vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(packed.val[0])), vdupq_n_s16(16)), d, e);
+    }
+#endif
+    for (; x + 1u < width; x += 2u) {
+      storePair(out + static_cast<size_t>(x) * 4u,
+                in[x * 2u + 0u], in[x * 2u + 2u], in[x * 2u + 1u], in[x * 2u + 3u]);
+    }
+  }
+}
+
+void convertNv12ToRgba(const uint8_t *yPlane, size_t yStride,
+                       const uint8_t *uvPlane, size_t uvStride,
+                       uint8_t *dst, uint32_t width,
+                       uint32_t rowBegin, uint32_t rowEnd) {
+  const size_t dstStride = static_cast<size_t>(width) * 4u;
+  for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+    const uint8_t *luma = yPlane + static_cast<size_t>(y) * yStride;
+    const uint8_t *chroma = uvPlane + static_cast<size_t>(y / 2u) * uvStride;
+    uint8_t *out = dst + static_cast<size_t>(y) * dstStride;
+    uint32_t x = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lumaBias = _mm_set1_epi16(16);
+    for (; x + 8u <= width; x += 8u) {
+      const __m128i lumaWide = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(luma + x)), zero);
+      const __m128i chromaWide = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(chroma + x)), zero);
+      __m128i d;
+      __m128i e;
+      splitChromaSse2(chromaWide, d, e);
+      storeEightSse2(out + static_cast<size_t>(x) * 4u, _mm_sub_epi16(lumaWide, lumaBias), d, e);
+    }
+#elif defined(BROADIFY_SIMD_NEON)
+    for (; x + 8u <= width; x += 8u) {
+      int16x8_t d;
+      int16x8_t e;
+      splitChromaNeon(vld1_u8(chroma + x), d, e);
+      storeEightNeon(out + static_cast<size_t>(x) * 4u,
+                     vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(luma + x))), vdupq_n_s16(16)), d, e);
+    }
+#endif
+    for (; x + 1u < width; x += 2u) {
+      storePair(out + static_cast<size_t>(x) * 4u,
+                luma[x], luma[x + 1u], chroma[x], chroma[x + 1u]);
+    }
+  }
+}
+
+}  // namespace broadify::meeting
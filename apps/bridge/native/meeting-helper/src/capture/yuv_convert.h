@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace broadify::meeting {
+
+// Camera YUV -> RGBA8 conversion (BT.601, limited range, as delivered by UVC
+// webcams). Both converters take a row range so a large frame can be split
+// into bands across threads; rows outside [rowBegin, rowEnd) are untouched.
+// Output alpha is 255 and `dst` rows are width * 4 bytes apart.
+
+// Packed 4:2:2 Y0 U Y1 V (V4L2_PIX_FMT_YUYV). `width` must be even.
+void convertYuyvToRgba(const uint8_t *src, size_t srcStride,
+                       uint8_t *dst, uint32_t width,
+                       uint32_t rowBegin, uint32_t rowEnd);
+
+// Semi-planar 4:2:0 (V4L2_PIX_FMT_NV12): a Y plane followed by an
+// interleaved U/V plane at half resolution. `width` must be even.
+void convertNv12ToRgba(const uint8_t *yPlane, size_t yStride,
+                       const uint8_t *uvPlane, size_t uvStride,
+                       uint8_t *dst, uint32_t width,
+                       uint32_t rowBegin, uint32_t rowEnd);
+
+}  // namespace broadify::meeting
@@ -38,7 +38,8 @@ uint16_t parseU16(const char *value, uint16_t fallback) {
 }
 
 bool isForwardedEnvironmentKey(const std::string &key) {
-  static constexpr std::array<const char *, 14> kAllowedKeys = {
+  static constexpr std::array<const char *, 18> kAllowedKeys = {
+      "BROADIFY_MEETING_CAMERA_PASSTHROUGH",
       "BROADIFY_MEETING_COREML_UNITS",
       "BROADIFY_MEETING_GPU_COMPOSITOR",
       "BROADIFY_MEETING_GPU_COMPOSITOR_D3D11",
@@ -52,7 +53,10 @@ bool isForwardedEnvironmentKey(const std::string &key) {
       "BROADIFY_MEETING_GUIDED_EPSILON",
       "BROADIFY_MEETING_GUIDED_RADIUS",
       "BROADIFY_MEETING_GUIDED_REFINE",
+      "BROADIFY_MEETING_INCREMENTAL_COMPOSITOR",
       "BROADIFY_MEETING_KEYER_DML_LEGACY",
+      "BROADIFY_MEETING_KEYER_FLOAT_INPUT",
+      "BROADIFY_MEETING_STREAMING_COPY",
   };
   return std::find(kAllowedKeys.begin(), kAllowedKeys.end(), key) !=
       kAllowedKeys.end();
@@ -87,6 +91,7 @@ Options parseOptions(int argc, char **argv) {
   options.fps = parseU32(getenvOrNull("MEETING_FRAME_FPS"), options.fps);
   options.previewPort = parseU16(getenvOrNull("MEETING_PREVIEW_PORT"), options.previewPort);
   options.vcamFramePort = parseU16(getenvOrNull("MEETING_VCAM_FRAME_PORT"), options.vcamFramePort);
+  options.mosaicPort = parseU16(getenvOrNull("MEETING_MOSAIC_PORT"), options.mosaicPort);
 
   for (int i = 1; i < argc; ++i) {
     const std::string arg = argv[i];
@@ -120,6 +125,8 @@ Options parseOptions(int argc, char **argv) {
       options.previewPort = parseU16(next(), options.previewPort);
     } else if (arg == "--vcam-frame-port") {
       options.vcamFramePort = parseU16(next(), options.vcamFramePort);
+    } else if (arg == "--mosaic-port") {
+      options.mosaicPort = parseU16(next(), options.mosaicPort);
     } else if (arg == "--env") {
       const std::string keyValue = next();
       const size_t separator = keyValue.find('=');
@@ -18,6 +18,7 @@ struct Options {
   uint32_t fps = 30;
   uint16_t previewPort = 9123;
   uint16_t vcamFramePort = 18787;
+  uint16_t mosaicPort = 9124;
 };
 
 Options parseOptions(int argc, char **argv);
@@ -0,0 +1,75 @@
+#include "compose/camera_framing.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace broadify::meeting {
+namespace {
+
+// Share of the window the keyer input adds on every side.
+constexpr double kKeyerMargin = 0.125;
+constexpr uint64_t kKeyerGridSteps = 16u;
+
+// [start, end) of one axis of the keyer input: the window span grown by the
+// margin, snapped outward to the grid and to even pixels.
+void keyerSpan(uint32_t start, uint32_t extent, uint32_t frameExtent, uint32_t &outStart, uint32_t &outExtent) {
+  const uint32_t margin = static_cast<uint32_t>(std::lround(extent * kKeyerMargin));
+  const uint64_t first = start > margin ? start - margin : 0u;
+  const uint64_t last = std::min<uint64_t>(frameExtent, static_cast<uint64_t>(start) + extent + margin);
+  uint64_t snappedFirst = (first * kKeyerGridSteps / frameExtent) * frameExtent / kKeyerGridSteps;
+  uint64_t snappedLast =
+      ((last * kKeyerGridSteps + frameExtent - 1u) / frameExtent) * frameExtent / kKeyerGridSteps;
+  snappedFirst &= ~uint64_t{1};
+  snappedLast = std::min<uint64_t>(frameExtent, (snappedLast + 1u) & ~uint64_t{1});
+  outStart = static_cast<uint32_t>(snappedFirst);
+  outExtent = static_cast<uint32_t>(snappedLast - snappedFirst);
+}
+
+}  // namespace
+
+CameraFraming clampCameraFraming(const CameraFraming &framing) {
+  CameraFraming clamped;
+  clamped.zoom = std::isfinite(framing.zoom) ? std::clamp(framing.zoom, 1.0, kMaxCameraZoom) : 1.0;
+  const double half = 0.5 / clamped.zoom;
+  clamped.centerX = std::isfinite(framing.centerX) ? std::clamp(framing.centerX, half, 1.0 - half) : 0.5;
+  clamped.centerY = std::isfinite(framing.centerY) ? std::clamp(framing.centerY, half, 1.0 - half) : 0.5;
+  return clamped;
+}
+
+CameraFraming manualCameraFraming(double zoom, double panX, double panY) {
+  CameraFraming framing;
+  framing.zoom = std::isfinite(zoom) ? std::clamp(zoom, 1.0, kMaxCameraZoom) : 1.0;
+  const double travel = 0.5 - 0.5 / framing.zoom;
+  framing.centerX = 0.5 + (std::isfinite(panX) ? std::clamp(panX, -1.0, 1.0) : 0.0) * travel;
+  framing.centerY = 0.5 + (std::isfinite(panY) ? std::clamp(panY, -1.0, 1.0) : 0.0) * travel;
+  return clampCameraFraming(framing);
+}
+
+CameraWindow framingWindow(const CameraFraming &framing, uint32_t frameWidth, uint32_t frameHeight) {
+  if (frameWidth == 0u || frameHeight == 0u) {
+    return {0u, 0u, frameWidth, frameHeight};
+  }
+  const CameraFraming clamped = clampCameraFraming(framing);
+  CameraWindow window;
+  window.width = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(frameWidth / clamped.zoom)), 1u, frameWidth);
+  window.height =
+      std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(frameHeight / clamped.zoom)), 1u, frameHeight);
+  window.x = static_cast<uint32_t>(std::clamp<long>(std::lround(clamped.centerX * frameWidth - window.width / 2.0), 0L,
+                                                    static_cast<long>(frameWidth - window.width)));
+  window.y = static_cast<uint32_t>(std::clamp<long>(std::lround(clamped.centerY * frameHeight - window.height / 2.0),
+                                                    0L, static_cast<long>(frameHeight - window.height)));
+  return window;
+}
+
+CameraWindow keyerInputWindow(const CameraFraming &framing, uint32_t frameWidth, uint32_t frameHeight) {
+  const CameraWindow window = framingWindow(framing, frameWidth, frameHeight);
+  if (window.width == frameWidth && window.height == frameHeight) {
+    return window;
+  }
+  CameraWindow input;
+  keyerSpan(window.x, window.width, frameWidth, input.x, input.width);
+  keyerSpan(window.y, window.height, frameHeight, input.y, input.height);
+  return input;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace broadify::meeting {
+
+constexpr double kMaxCameraZoom = 4.0;
+
+// Digital pan/zoom of the program camera, expressed as a source transform:
+// the part of the camera frame that every camera placement (CPU cover crop,
+// GPU mappings, display scale) treats as the whole frame. Nothing is cropped
+// or copied, so a framing change costs nothing at render time. Fractions of
+// the frame, so one framing fits the full frame, its display-scaled copy and
+// the mask alike.
+struct CameraFraming {
+  double zoom = 1.0;     // 1 = whole frame, up to kMaxCameraZoom
+  double centerX = 0.5;  // window centre
+  double centerY = 0.5;
+};
+
+// A pixel rectangle of a camera frame.
+struct CameraWindow {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// Clamps the zoom to [1, kMaxCameraZoom] and the centre so the window stays
+// inside the frame.
+CameraFraming clampCameraFraming(const CameraFraming &framing);
+
+// The camera section's manual framing: `panX`/`panY` (-1..1) move the window
+// across the travel the zoom leaves, 0 keeps it centred.
+CameraFraming manualCameraFraming(double zoom, double panX, double panY);
+
+// The window of a frameWidth x frameHeight frame that `framing` shows: 1/zoom
+// of the frame at the frame's aspect. The whole frame at zoom 1.
+CameraWindow framingWindow(const CameraFraming &framing, uint32_t frameWidth, uint32_t frameHeight);
+
+// The keyer input for `framing`: the window grown by a margin on every side
+// and snapped outward to sixteenths of the frame, with even edges. The
+// subject can move (and auto-framing follow it) before the region, and with
+// it the keyer's temporal state, changes. The whole frame at zoom 1.
+CameraWindow keyerInputWindow(const CameraFraming &framing, uint32_t frameWidth, uint32_t frameHeight);
+
+}  // namespace broadify::meeting
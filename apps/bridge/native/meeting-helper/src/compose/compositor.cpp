@@ -1,26 +1,28 @@
 #include "compose/compositor.h"
+#include "compose/graphics_template.h"
+#include "compose/image_decode.h"
 #include "compose/metal_compositor.h"
+#include "compose/rgba_image.h"
+#include "compose/shape_rasterizer.h"
+#include "compose/tile_damage.h"
 #if defined(_WIN32)
 #include "compose/d3d11_compositor.h"
 #endif
+#include "util/frame_copy.h"
+#include "util/image_resample.h"
 #include "util/json_utils.h"
 
 #include <algorithm>
-#include <cctype>
 #include <cstdint>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
-#if defined(__APPLE__)
-#include <CoreFoundation/CoreFoundation.h>
-#include <CoreGraphics/CoreGraphics.h>
-#include <ImageIO/ImageIO.h>
-#endif
-
 namespace broadify::meeting {
 namespace {
 
@@ -38,11 +40,11 @@ struct SourceRect {
   uint32_t height = 0;
 };
 
-struct RgbaImage {
-  uint32_t width = 0;
-  uint32_t height = 0;
-  std::vector<uint8_t> rgba;
-};
+// The layers that can be clipped take the output regions to draw; a full
+// render passes the whole frame as its only region.
+std::vector<Rect> wholeFrame(uint32_t width, uint32_t height) {
+  return {{0, 0, static_cast<int>(width), static_cast<int>(height)}};
+}
 
 uint8_t clampByte(int value) {
   return static_cast<uint8_t>(std::clamp(value, 0, 255));
@@ -52,7 +54,7 @@ double clamp01(double value) {
   return std::clamp(value, 0.0, 1.0);
 }
 
-void setPixel(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+void setPixel(RgbaFrameRef frame, uint32_t width, uint32_t height, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
   if (x < 0 || y < 0 || x >= static_cast<int>(width) || y >= static_cast<int>(height)) {
     return;
   }
@@ -63,7 +65,7 @@ void setPixel(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, int
   frame[offset + 3] = a;
 }
 
-void blendPixel(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+void blendPixel(RgbaFrameRef frame, uint32_t width, uint32_t height, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
   if (x < 0 || y < 0 || x >= static_cast<int>(width) || y >= static_cast<int>(height)) {
     return;
   }
@@ -78,132 +80,28 @@ void blendPixel(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, in
   frame[offset + 3] = 255u;
 }
 
-std::vector<uint8_t> decodeBase64(const std::string &value) {
-  std::vector<int> table(256, -1);
-  for (int i = 0; i < 26; ++i) {
-    table[static_cast<size_t>('A' + i)] = i;
-    table[static_cast<size_t>('a' + i)] = i + 26;
-  }
-  for (int i = 0; i < 10; ++i) {
-    table[static_cast<size_t>('0' + i)] = i + 52;
-  }
-  table[static_cast<size_t>('+')] = 62;
-  table[static_cast<size_t>('/')] = 63;
-
-  std::vector<uint8_t> decoded;
-  int accumulator = 0;
-  int bits = -8;
-  for (unsigned char ch : value) {
-    if (ch == '=') {
-      break;
-    }
-    if (std::isspace(ch)) {
-      continue;
-    }
-    const int part = table[ch];
-    if (part < 0) {
-      return {};
-    }
-    accumulator = (accumulator << 6) + part;
-    bits += 6;
-    if (bits >= 0) {
-      decoded.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xff));
-      bits -= 8;
-    }
-  }
-  return decoded;
-}
-
-std::vector<uint8_t> decodeDataUrlBytes(const std::string &dataUrl) {
-  const size_t comma = dataUrl.find(',');
-  if (comma == std::string::npos) {
-    return {};
-  }
-  const std::string metadata = dataUrl.substr(0, comma);
-  if (metadata.find(";base64") == std::string::npos) {
-    return {};
-  }
-  return decodeBase64(dataUrl.substr(comma + 1));
-}
-
-#if defined(__APPLE__)
-std::shared_ptr<const RgbaImage> decodeImageBytes(const std::vector<uint8_t> &bytes) {
-  if (bytes.empty()) {
-    return nullptr;
-  }
-
-  CFDataRef data = CFDataCreate(kCFAllocatorDefault, bytes.data(), static_cast<CFIndex>(bytes.size()));
-  if (!data) {
-    return nullptr;
-  }
-
-  CGImageSourceRef source = CGImageSourceCreateWithData(data, nullptr);
-  CFRelease(data);
-  if (!source) {
-    return nullptr;
-  }
-
-  CGImageRef image = CGImageSourceCreateImageAtIndex(source, 0, nullptr);
-  CFRelease(source);
-  if (!image) {
-    return nullptr;
-  }
-
-  const size_t width = CGImageGetWidth(image);
-  const size_t height = CGImageGetHeight(image);
-  if (width == 0 || height == 0 || width > 4096 || height > 4096) {
-    CGImageRelease(image);
-    return nullptr;
-  }
-
-  auto decoded = std::make_shared<RgbaImage>();
-  decoded->width = static_cast<uint32_t>(width);
-  decoded->height = static_cast<uint32_t>(height);
-  decoded->rgba.assign(width * height * 4u, 0);
-
-  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
-  CGContextRef context = CGBitmapContextCreate(decoded->rgba.data(),
-                                               width,
-                                               height,
-                                               8,
-                                               width * 4u,
-                                               colorSpace,
-                                               kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
-  CGColorSpaceRelease(colorSpace);
-  if (!context) {
-    CGImageRelease(image);
-    return nullptr;
-  }
-
-  CGContextClearRect(context, CGRectMake(0, 0, static_cast<CGFloat>(width), static_cast<CGFloat>(height)));
-  CGContextDrawImage(context, CGRectMake(0, 0, static_cast<CGFloat>(width), static_cast<CGFloat>(height)), image);
-  CGContextRelease(context);
-  CGImageRelease(image);
-  return decoded;
-}
-#else
-std::shared_ptr<const RgbaImage> decodeImageBytes(const std::vector<uint8_t> &) {
-  return nullptr;
-}
-#endif
-
+// Keyed on the image_data_url member revision: moving or resizing the bug
+// never re-reads (or even compares) the embedded image.
 std::shared_ptr<const RgbaImage> getCornerbugImage(const CornerbugState &cornerbug) {
-  const std::string dataUrl = extractStringField(cornerbug.rawJson, "image_data_url");
-  if (dataUrl.empty()) {
+  if (!cornerbug.fields.has("image_data_url")) {
     return nullptr;
   }
 
   static std::mutex cacheMutex;
-  static std::string cachedDataUrl;
+  static uint64_t cachedRevision = 0;
+  static bool cacheValid = false;
   static std::shared_ptr<const RgbaImage> cachedImage;
 
+  const uint64_t revision = cornerbug.fields.revision("image_data_url");
   std::lock_guard<std::mutex> lock(cacheMutex);
-  if (dataUrl == cachedDataUrl) {
+  if (cacheValid && revision == cachedRevision) {
     return cachedImage;
   }
 
-  cachedDataUrl = dataUrl;
-  cachedImage = decodeImageBytes(decodeDataUrlBytes(dataUrl));
+  const std::string dataUrl = parseStringValue(cornerbug.fields.raw("image_data_url"));
+  cachedRevision = revision;
+  cacheValid = true;
+  cachedImage = dataUrl.empty() ? nullptr : decodeImageBytes(decodeDataUrlBytes(dataUrl));
   return cachedImage;
 }
 
@@ -264,7 +162,9 @@ std::shared_ptr<const RgbaImage> getBackgroundImage(const std::string &path) {
   return cachedImage;
 }
 
-void drawImageFit(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const Rect &target, const RgbaImage &image) {
+// Axis-aligned fit: the scale is uniform, so the sharpest mip level at most
+// 2x larger than the drawn size is resampled to it in one separable pass.
+void drawImageFit(RgbaFrameRef frame, uint32_t width, uint32_t height, const Rect &target, const RgbaImage &image) {
   if (target.width <= 0 || target.height <= 0 || image.width == 0 || image.height == 0 || image.rgba.empty()) {
     return;
   }
@@ -276,34 +176,25 @@ void drawImageFit(std::vector<uint8_t> &frame, uint32_t width, uint32_t height,
   const int drawHeight = std::max(1, static_cast<int>(std::round(image.height * scale)));
   const int drawX = target.x + (target.width - drawWidth) / 2;
   const int drawY = target.y + (target.height - drawHeight) / 2;
-
+  const ImageLevel level = image.level(static_cast<uint32_t>(mipLodForFootprint(1.0 / scale)));
+
+  thread_local std::vector<uint8_t> fitted;
+  fitted.resize(static_cast<size_t>(drawWidth) * drawHeight * 4u);
+  const size_t fittedStride = static_cast<size_t>(drawWidth) * 4u;
+  resampleImage({level.rgba, level.width, level.height, static_cast<size_t>(level.width) * 4u, 4u},
+                {fitted.data(), static_cast<uint32_t>(drawWidth), static_cast<uint32_t>(drawHeight), fittedStride, 4u},
+                ResampleFilter::kBilinear);
   for (int y = 0; y < drawHeight; ++y) {
-    const double sourceY = ((static_cast<double>(y) + 0.5) * image.height / drawHeight) - 0.5;
-    const uint32_t y0 = static_cast<uint32_t>(std::clamp(static_cast<int>(std::floor(sourceY)), 0, static_cast<int>(image.height) - 1));
-    const uint32_t y1 = std::min(y0 + 1u, image.height - 1u);
-    const double yWeight = std::clamp(sourceY - std::floor(sourceY), 0.0, 1.0);
-    for (int x = 0; x < drawWidth; ++x) {
-      const double sourceX = ((static_cast<double>(x) + 0.5) * image.width / drawWidth) - 0.5;
-      const uint32_t x0 = static_cast<uint32_t>(std::clamp(static_cast<int>(std::floor(sourceX)), 0, static_cast<int>(image.width) - 1));
-      const uint32_t x1 = std::min(x0 + 1u, image.width - 1u);
-      const double xWeight = std::clamp(sourceX - std::floor(sourceX), 0.0, 1.0);
-      const size_t topLeftOffset = (static_cast<size_t>(y0) * image.width + x0) * 4u;
-      const size_t topRightOffset = (static_cast<size_t>(y0) * image.width + x1) * 4u;
-      const size_t bottomLeftOffset = (static_cast<size_t>(y1) * image.width + x0) * 4u;
-      const size_t bottomRightOffset = (static_cast<size_t>(y1) * image.width + x1) * 4u;
-      const auto sample = [&](size_t channel) {
-        const double top = image.rgba[topLeftOffset + channel] * (1.0 - xWeight) + image.rgba[topRightOffset + channel] * xWeight;
-        const double bottom = image.rgba[bottomLeftOffset + channel] * (1.0 - xWeight) + image.rgba[bottomRightOffset + channel] * xWeight;
-        return clampByte(static_cast<int>(std::round(top * (1.0 - yWeight) + bottom * yWeight)));
-      };
-      const uint8_t alpha = sample(3u);
+    const uint8_t *sample = fitted.data() + static_cast<size_t>(y) * fittedStride;
+    for (int x = 0; x < drawWidth; ++x, sample += 4) {
+      const uint8_t alpha = sample[3];
       if (alpha == 0u) {
         continue;
       }
-      uint8_t r = sample(0u);
-      uint8_t g = sample(1u);
-      uint8_t b = sample(2u);
-      if (alpha > 0u && alpha < 255u) {
+      uint8_t r = sample[0];
+      uint8_t g = sample[1];
+      uint8_t b = sample[2];
+      if (alpha < 255u) {
         r = clampByte((static_cast<int>(r) * 255) / alpha);
         g = clampByte((static_cast<int>(g) * 255) / alpha);
         b = clampByte((static_cast<int>(b) * 255) / alpha);
@@ -313,103 +204,91 @@ void drawImageFit(std::vector<uint8_t> &frame, uint32_t width, uint32_t height,
   }
 }
 
-void fillRect(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+void fillRect(RgbaFrameRef frame, uint32_t width, uint32_t height, const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
   const int minX = std::max(0, rect.x);
   const int minY = std::max(0, rect.y);
   const int maxX = std::min(static_cast<int>(width), rect.x + rect.width);
   const int maxY = std::min(static_cast<int>(height), rect.y + rect.height);
-  for (int y = minY; y < maxY; ++y) {
-    for (int x = minX; x < maxX; ++x) {
-      if (a == 255) {
-        setPixel(frame, width, height, x, y, r, g, b, a);
-        continue;
-      }
-      const size_t offset = (static_cast<size_t>(y) * width + static_cast<uint32_t>(x)) * 4u;
-      frame[offset + 0] = clampByte((r * a + frame[offset + 0] * (255 - a)) / 255);
-      frame[offset + 1] = clampByte((g * a + frame[offset + 1] * (255 - a)) / 255);
-      frame[offset + 2] = clampByte((b * a + frame[offset + 2] * (255 - a)) / 255);
-      frame[offset + 3] = 255;
-    }
-  }
-}
-
-void fillRotatedRect(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const Rect &rect, double rotationDeg, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
-  if (rect.width <= 0 || rect.height <= 0) {
-    return;
-  }
-  if (std::abs(rotationDeg) < 0.001) {
-    fillRect(frame, width, height, rect, r, g, b, a);
+  if (minX >= maxX) {
     return;
   }
-
-  constexpr double kPi = 3.14159265358979323846;
-  const double radians = rotationDeg * kPi / 180.0;
-  const double cosTheta = std::cos(radians);
-  const double sinTheta = std::sin(radians);
-  const double centerX = rect.x + rect.width / 2.0;
-  const double centerY = rect.y + rect.height / 2.0;
-  const double halfWidth = rect.width / 2.0;
-  const double halfHeight = rect.height / 2.0;
-  const double extentX = std::abs(halfWidth * cosTheta) + std::abs(halfHeight * sinTheta);
-  const double extentY = std::abs(halfWidth * sinTheta) + std::abs(halfHeight * cosTheta);
-  const int minX = std::max(0, static_cast<int>(std::floor(centerX - extentX)));
-  const int minY = std::max(0, static_cast<int>(std::floor(centerY - extentY)));
-  const int maxX = std::min(static_cast<int>(width), static_cast<int>(std::ceil(centerX + extentX)));
-  const int maxY = std::min(static_cast<int>(height), static_cast<int>(std::ceil(centerY + extentY)));
-
   for (int y = minY; y < maxY; ++y) {
-    for (int x = minX; x < maxX; ++x) {
-      const double dx = (x + 0.5) - centerX;
-      const double dy = (y + 0.5) - centerY;
-      const double localX = dx * cosTheta + dy * sinTheta;
-      const double localY = -dx * sinTheta + dy * cosTheta;
-      if (std::abs(localX) <= halfWidth && std::abs(localY) <= halfHeight) {
-        blendPixel(frame, width, height, x, y, r, g, b, a);
-      }
-    }
+    const size_t offset = (static_cast<size_t>(y) * width + static_cast<uint32_t>(minX)) * 4u;
+    blendSpanRgba(frame.data() + offset, static_cast<size_t>(maxX - minX), r, g, b, a);
   }
 }
 
-void drawGlassRect(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const Rect &rect, double rotationDeg = 0.0) {
+RasterShape rasterRect(const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+  RasterShape shape;
+  shape.x = rect.x;
+  shape.y = rect.y;
+  shape.width = rect.width;
+  shape.height = rect.height;
+  shape.r = r;
+  shape.g = g;
+  shape.b = b;
+  shape.a = a;
+  return shape;
+}
+
+// Glass panel in paint order: drop shadow, translucent body, then the bevel
+// highlights (bright top/left, dim right/bottom). Callers append their own
+// decorations and rasterize the batch in one pass around the panel centre.
+std::vector<RasterShape> glassPanelShapes(const Rect &rect) {
   if (rect.width <= 0 || rect.height <= 0) {
-    return;
+    return {};
   }
+  RasterShape shadow = rasterRect(rect, 0, 0, 0, 46);
+  shadow.offsetX = 8.0;
+  shadow.offsetY = 10.0;
+  return {
+    shadow,
+    rasterRect(rect, 255, 255, 255, 36),
+    rasterRect({rect.x + 1, rect.y + 1, std::max(0, rect.width - 2), 2}, 255, 255, 255, 92),
+    rasterRect({rect.x + 1, rect.y + 1, 2, std::max(0, rect.height - 2)}, 255, 255, 255, 54),
+    rasterRect({rect.x + rect.width - 3, rect.y + 1, 2, std::max(0, rect.height - 2)}, 255, 255, 255, 24),
+    rasterRect({rect.x + 1, rect.y + rect.height - 3, std::max(0, rect.width - 2), 2}, 255, 255, 255, 24),
+  };
+}
 
-  fillRotatedRect(frame, width, height, {rect.x + 8, rect.y + 10, rect.width, rect.height}, rotationDeg, 0, 0, 0, 46);
-  fillRotatedRect(frame, width, height, rect, rotationDeg, 255, 255, 255, 36);
-  fillRotatedRect(frame, width, height, {rect.x + 1, rect.y + 1, std::max(0, rect.width - 2), 2}, rotationDeg, 255, 255, 255, 92);
-  fillRotatedRect(frame, width, height, {rect.x + 1, rect.y + 1, 2, std::max(0, rect.height - 2)}, rotationDeg, 255, 255, 255, 54);
-  fillRotatedRect(frame, width, height, {rect.x + rect.width - 3, rect.y + 1, 2, std::max(0, rect.height - 2)}, rotationDeg, 255, 255, 255, 24);
-  fillRotatedRect(frame, width, height, {rect.x + 1, rect.y + rect.height - 3, std::max(0, rect.width - 2), 2}, rotationDeg, 255, 255, 255, 24);
+void drawPanel(RgbaFrameRef frame, uint32_t width, uint32_t height, const Rect &rect,
+               const std::vector<RasterShape> &shapes, double rotationDeg) {
+  rasterizeShapes(frame, width, height, shapes,
+                  rect.x + rect.width / 2.0, rect.y + rect.height / 2.0, rotationDeg);
 }
 
-void fillBackground(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const std::string &mode, uint64_t frameIndex) {
-  frame.assign(static_cast<size_t>(width) * height * 4u, 255u);
-  for (uint32_t y = 0; y < height; ++y) {
-    for (uint32_t x = 0; x < width; ++x) {
-      uint8_t r = 8;
-      uint8_t g = 10;
-      uint8_t b = 14;
-      if (mode == "gradient") {
-        const int wave = static_cast<int>((x + y + frameIndex) % 96u);
-        r = clampByte(20 + static_cast<int>((120.0 * x) / std::max<uint32_t>(1, width)) + wave / 5);
-        g = clampByte(54 + static_cast<int>((90.0 * y) / std::max<uint32_t>(1, height)));
-        b = clampByte(94 + wave);
-      } else if (mode == "solid_light") {
-        r = 232;
-        g = 236;
-        b = 229;
-      } else if (mode == "checkerboard") {
-        const bool tile = ((x / 48u) + (y / 48u)) % 2u == 0u;
-        r = tile ? 42 : 70;
-        g = tile ? 45 : 74;
-        b = tile ? 50 : 82;
-      } else if (mode == "transparent") {
-        r = 0;
-        g = 0;
-        b = 0;
+void fillBackground(RgbaFrameRef frame, uint32_t width, uint32_t height, const std::string &mode, uint64_t frameIndex,
+                    const std::vector<Rect> &regions) {
+  for (const Rect &region : regions) {
+    const uint32_t x0 = static_cast<uint32_t>(region.x);
+    const uint32_t x1 = static_cast<uint32_t>(region.x + region.width);
+    const uint32_t y1 = static_cast<uint32_t>(region.y + region.height);
+    for (uint32_t y = static_cast<uint32_t>(region.y); y < y1; ++y) {
+      for (uint32_t x = x0; x < x1; ++x) {
+        uint8_t r = 8;
+        uint8_t g = 10;
+        uint8_t b = 14;
+        if (mode == "gradient") {
+          const int wave = static_cast<int>((x + y + frameIndex) % 96u);
+          r = clampByte(20 + static_cast<int>((120.0 * x) / std::max<uint32_t>(1, width)) + wave / 5);
+          g = clampByte(54 + static_cast<int>((90.0 * y) / std::max<uint32_t>(1, height)));
+          b = clampByte(94 + wave);
+        } else if (mode == "solid_light") {
+          r = 232;
+          g = 236;
+          b = 229;
+        } else if (mode == "checkerboard") {
+          const bool tile = ((x / 48u) + (y / 48u)) % 2u == 0u;
+          r = tile ? 42 : 70;
+          g = tile ? 45 : 74;
+          b = tile ? 50 : 82;
+        } else if (mode == "transparent") {
+          r = 0;
+          g = 0;
+          b = 0;
+        }
+        setPixel(frame, width, height, static_cast<int>(x), static_cast<int>(y), r, g, b);
       }
-      setPixel(frame, width, height, static_cast<int>(x), static_cast<int>(y), r, g, b);
     }
   }
 }
@@ -467,13 +346,143 @@ SourceRect coverSourceRect(uint32_t sourceWidth, uint32_t sourceHeight, int targ
   return {0, (sourceHeight - std::min(sourceHeight, cropHeight)) / 2u, sourceWidth, std::min(sourceHeight, cropHeight)};
 }
 
-void drawCamera(std::vector<uint8_t> &frame,
+// coverSourceRect inside the part of the camera frame `framing` shows.
+SourceRect framedSourceRect(uint32_t sourceWidth, uint32_t sourceHeight, const CameraFraming &framing,
+                            int targetWidth, int targetHeight) {
+  const CameraWindow window = framingWindow(framing, sourceWidth, sourceHeight);
+  const SourceRect crop = coverSourceRect(window.width, window.height, targetWidth, targetHeight);
+  return {window.x + crop.x, window.y + crop.y, crop.width, crop.height};
+}
+
+// blendPixel over a whole row of straight-alpha source pixels.
+void blendRowRgba(uint8_t *dst, const uint8_t *src, uint32_t count) {
+  for (uint32_t x = 0; x < count; ++x, dst += 4, src += 4) {
+    const int a = src[3];
+    if (a == 255) {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+    } else {
+      dst[0] = clampByte((src[0] * a + dst[0] * (255 - a)) / 255);
+      dst[1] = clampByte((src[1] * a + dst[1] * (255 - a)) / 255);
+      dst[2] = clampByte((src[2] * a + dst[2] * (255 - a)) / 255);
+    }
+    dst[3] = 255u;
+  }
+}
+
+// Premultiplied source-over of a whole row: dst = src + dst * (1 - srcA).
+void blendPremultipliedRowRgba(uint8_t *dst, const uint8_t *src, uint32_t count) {
+  for (uint32_t x = 0; x < count; ++x, dst += 4, src += 4) {
+    const int inverse = 255 - src[3];
+    dst[0] = clampByte(src[0] + (dst[0] * inverse + 127) / 255);
+    dst[1] = clampByte(src[1] + (dst[1] * inverse + 127) / 255);
+    dst[2] = clampByte(src[2] + (dst[2] * inverse + 127) / 255);
+    dst[3] = 255u;
+  }
+}
+
+// Premultiplied copy of a straight-alpha RGBA image, so filtering weighs
+// colour by coverage instead of pulling in the (usually black) colour of
+// transparent pixels.
+void premultiplyRgba(const uint8_t *src, size_t pixels, std::vector<uint8_t> &dst) {
+  dst.resize(pixels * 4u);
+  uint8_t *out = dst.data();
+  for (size_t i = 0; i < pixels; ++i, src += 4, out += 4) {
+    const int a = src[3];
+    out[0] = static_cast<uint8_t>((src[0] * a + 127) / 255);
+    out[1] = static_cast<uint8_t>((src[1] * a + 127) / 255);
+    out[2] = static_cast<uint8_t>((src[2] * a + 127) / 255);
+    out[3] = static_cast<uint8_t>(a);
+  }
+}
+
+// Cover-fits an RGBA source over the whole frame and blends it within
+// `regions`. Same crop as the GPU layer mapping (coverSourceRect); a source
+// already at frame size is blended straight from its own rows. A scaled
+// source is resampled premultiplied (straight-alpha sources are premultiplied
+// first), so translucent edges don't pick up dark fringes.
+void drawRgbaCover(RgbaFrameRef frame, uint32_t width, uint32_t height,
+                   const uint8_t *rgba, uint32_t sourceWidth, uint32_t sourceHeight,
+                   bool premultiplied, const std::vector<Rect> &regions) {
+  if (regions.empty()) {
+    return;
+  }
+  const SourceRect source = coverSourceRect(sourceWidth, sourceHeight,
+                                            static_cast<int>(width), static_cast<int>(height));
+  const uint8_t *rows = rgba;
+  size_t rowStride = static_cast<size_t>(sourceWidth) * 4u;
+  thread_local std::vector<uint8_t> scaled;
+  if (source.x != 0u || source.y != 0u || source.width != width || source.height != height) {
+    const uint8_t *premultipliedSource = rgba;
+    thread_local std::vector<uint8_t> premultipliedCopy;
+    if (!premultiplied) {
+      premultiplyRgba(rgba, static_cast<size_t>(sourceWidth) * sourceHeight, premultipliedCopy);
+      premultipliedSource = premultipliedCopy.data();
+      premultiplied = true;
+    }
+    scaled.resize(static_cast<size_t>(width) * height * 4u);
+    resampleImage({premultipliedSource, sourceWidth, sourceHeight, rowStride, 4u},
+                  {static_cast<double>(source.x), static_cast<double>(source.y),
+                   static_cast<double>(source.width), static_cast<double>(source.height)},
+                  {scaled.data(), width, height, static_cast<size_t>(width) * 4u, 4u},
+                  ResampleFilter::kBilinear);
+    rows = scaled.data();
+    rowStride = static_cast<size_t>(width) * 4u;
+  }
+  for (const Rect &region : regions) {
+    const size_t x = static_cast<size_t>(region.x);
+    for (int y = region.y; y < region.y + region.height; ++y) {
+      uint8_t *dst = frame.data() + (static_cast<size_t>(y) * width + x) * 4u;
+      const uint8_t *src = rows + static_cast<size_t>(y) * rowStride + x * 4u;
+      if (premultiplied) {
+        blendPremultipliedRowRgba(dst, src, static_cast<uint32_t>(region.width));
+      } else {
+        blendRowRgba(dst, src, static_cast<uint32_t>(region.width));
+      }
+    }
+  }
+}
+
+// The uploaded background rescaled to the output once, so per-frame CPU
+// renders only blend it. Keyed on the decoded image instance (a new upload
+// decodes a new one) and the output size.
+std::shared_ptr<const RgbaImage> getCoverFittedBackground(const std::shared_ptr<const RgbaImage> &image,
+                                                          uint32_t width, uint32_t height) {
+  static std::mutex cacheMutex;
+  static std::shared_ptr<const RgbaImage> cachedSource;
+  static std::shared_ptr<const RgbaImage> cachedImage;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  if (image == cachedSource && cachedImage && cachedImage->width == width && cachedImage->height == height) {
+    return cachedImage;
+  }
+
+  auto fitted = std::make_shared<RgbaImage>();
+  fitted->width = width;
+  fitted->height = height;
+  fitted->rgba.assign(static_cast<size_t>(width) * height * 4u, 0u);
+  const SourceRect source = coverSourceRect(image->width, image->height,
+                                            static_cast<int>(width), static_cast<int>(height));
+  resampleImage({image->rgba.data(), image->width, image->height, static_cast<size_t>(image->width) * 4u, 4u},
+                {static_cast<double>(source.x), static_cast<double>(source.y),
+                 static_cast<double>(source.width), static_cast<double>(source.height)},
+                {fitted->rgba.data(), width, height, static_cast<size_t>(width) * 4u, 4u},
+                ResampleFilter::kBilinear);
+  cachedSource = image;
+  cachedImage = std::move(fitted);
+  return cachedImage;
+}
+
+void drawCamera(RgbaFrameRef frame,
                 uint32_t width,
                 uint32_t height,
                 const Rect &rect,
                 const VideoFrame *cameraFrame,
                 const AlphaMask *cameraMask,
-                bool mirror) {
+                bool mirror,
+                const CameraFraming &framing,
+                const std::vector<Rect> &regions) {
   if (rect.width <= 0 || rect.height <= 0) {
     return;
   }
@@ -481,85 +490,72 @@ void drawCamera(std::vector<uint8_t> &frame,
     return;
   }
 
-  const int minX = std::max(0, rect.x);
-  const int minY = std::max(0, rect.y);
-  const int maxX = std::min(static_cast<int>(width), rect.x + rect.width);
-  const int maxY = std::min(static_cast<int>(height), rect.y + rect.height);
-  const SourceRect source = coverSourceRect(cameraFrame->width, cameraFrame->height, rect.width, rect.height);
-  for (int y = minY; y < maxY; ++y) {
-    const uint32_t sy = std::min(
-        cameraFrame->height - 1u,
-        source.y + static_cast<uint32_t>((static_cast<uint64_t>(y - rect.y) * source.height) / static_cast<uint32_t>(rect.height)));
-    for (int x = minX; x < maxX; ++x) {
-      const uint32_t sampledX = std::min(
-          cameraFrame->width - 1u,
-          source.x + static_cast<uint32_t>((static_cast<uint64_t>(x - rect.x) * source.width) / static_cast<uint32_t>(rect.width)));
-      const uint32_t sx = mirror
-          ? source.x + source.width - 1u - (sampledX - source.x)
-          : sampledX;
-      const size_t srcOffset = (static_cast<size_t>(sy) * cameraFrame->width + sx) * 4u;
-      uint8_t alpha = cameraFrame->rgba[srcOffset + 3];
-      if (cameraMask != nullptr && !cameraMask->alpha.empty() &&
-          cameraMask->width > 0u && cameraMask->height > 0u) {
-        const double maskX = cameraFrame->width > 1u
-            ? static_cast<double>(sx) * static_cast<double>(cameraMask->width - 1u) /
-                  static_cast<double>(cameraFrame->width - 1u)
-            : 0.0;
-        const double maskY = cameraFrame->height > 1u
-            ? static_cast<double>(sy) * static_cast<double>(cameraMask->height - 1u) /
-                  static_cast<double>(cameraFrame->height - 1u)
-            : 0.0;
-        const uint32_t mx0 = static_cast<uint32_t>(std::floor(maskX));
-        const uint32_t my0 = static_cast<uint32_t>(std::floor(maskY));
-        const uint32_t mx1 = std::min(mx0 + 1u, cameraMask->width - 1u);
-        const uint32_t my1 = std::min(my0 + 1u, cameraMask->height - 1u);
-        const double wx = maskX - static_cast<double>(mx0);
-        const double wy = maskY - static_cast<double>(my0);
-        const double top = cameraMask->alpha[static_cast<size_t>(my0) * cameraMask->width + mx0] * (1.0 - wx) +
-            cameraMask->alpha[static_cast<size_t>(my0) * cameraMask->width + mx1] * wx;
-        const double bottom = cameraMask->alpha[static_cast<size_t>(my1) * cameraMask->width + mx0] * (1.0 - wx) +
-            cameraMask->alpha[static_cast<size_t>(my1) * cameraMask->width + mx1] * wx;
-        alpha = clampByte(static_cast<int>(std::round(top * (1.0 - wy) + bottom * wy)));
+  const SourceRect source =
+      framedSourceRect(cameraFrame->width, cameraFrame->height, framing, rect.width, rect.height);
+  for (const Rect &region : regions) {
+    const int minX = std::max({0, rect.x, region.x});
+    const int minY = std::max({0, rect.y, region.y});
+    const int maxX = std::min({static_cast<int>(width), rect.x + rect.width, region.x + region.width});
+    const int maxY = std::min({static_cast<int>(height), rect.y + rect.height, region.y + region.height});
+    for (int y = minY; y < maxY; ++y) {
+      const uint32_t sy = std::min(
+          cameraFrame->height - 1u,
+          source.y + static_cast<uint32_t>((static_cast<uint64_t>(y - rect.y) * source.height) / static_cast<uint32_t>(rect.height)));
+      for (int x = minX; x < maxX; ++x) {
+        const uint32_t sampledX = std::min(
+            cameraFrame->width - 1u,
+            source.x + static_cast<uint32_t>((static_cast<uint64_t>(x - rect.x) * source.width) / static_cast<uint32_t>(rect.width)));
+        const uint32_t sx = mirror
+            ? source.x + source.width - 1u - (sampledX - source.x)
+            : sampledX;
+        const size_t srcOffset = (static_cast<size_t>(sy) * cameraFrame->width + sx) * 4u;
+        uint8_t alpha = cameraFrame->rgba[srcOffset + 3];
+        if (cameraMask != nullptr && !cameraMask->alpha.empty() &&
+            cameraMask->width > 0u && cameraMask->height > 0u) {
+          const double maskX = cameraFrame->width > 1u
+              ? static_cast<double>(sx) * static_cast<double>(cameraMask->width - 1u) /
+                    static_cast<double>(cameraFrame->width - 1u)
+              : 0.0;
+          const double maskY = cameraFrame->height > 1u
+              ? static_cast<double>(sy) * static_cast<double>(cameraMask->height - 1u) /
+                    static_cast<double>(cameraFrame->height - 1u)
+              : 0.0;
+          const uint32_t mx0 = static_cast<uint32_t>(std::floor(maskX));
+          const uint32_t my0 = static_cast<uint32_t>(std::floor(maskY));
+          const uint32_t mx1 = std::min(mx0 + 1u, cameraMask->width - 1u);
+          const uint32_t my1 = std::min(my0 + 1u, cameraMask->height - 1u);
+          const double wx = maskX - static_cast<double>(mx0);
+          const double wy = maskY - static_cast<double>(my0);
+          const double top = cameraMask->alpha[static_cast<size_t>(my0) * cameraMask->width + mx0] * (1.0 - wx) +
+              cameraMask->alpha[static_cast<size_t>(my0) * cameraMask->width + mx1] * wx;
+          const double bottom = cameraMask->alpha[static_cast<size_t>(my1) * cameraMask->width + mx0] * (1.0 - wx) +
+              cameraMask->alpha[static_cast<size_t>(my1) * cameraMask->width + mx1] * wx;
+          alpha = clampByte(static_cast<int>(std::round(top * (1.0 - wy) + bottom * wy)));
+        }
+        blendPixel(frame, width, height, x, y,
+                   cameraFrame->rgba[srcOffset + 0],
+                   cameraFrame->rgba[srcOffset + 1],
+                   cameraFrame->rgba[srcOffset + 2],
+                   alpha);
       }
-      blendPixel(frame, width, height, x, y,
-                 cameraFrame->rgba[srcOffset + 0],
-                 cameraFrame->rgba[srcOffset + 1],
-                 cameraFrame->rgba[srcOffset + 2],
-                 alpha);
     }
   }
 }
 
 
-void sampleImageBilinear(const RgbaImage &image, double sourceX, double sourceY, uint8_t sample[4]) {
-  const uint32_t x0 = static_cast<uint32_t>(std::clamp(static_cast<int>(std::floor(sourceX)), 0, static_cast<int>(image.width) - 1));
-  const uint32_t x1 = std::min(x0 + 1u, image.width - 1u);
-  const double xWeight = std::clamp(sourceX - std::floor(sourceX), 0.0, 1.0);
-  const uint32_t y0 = static_cast<uint32_t>(std::clamp(static_cast<int>(std::floor(sourceY)), 0, static_cast<int>(image.height) - 1));
-  const uint32_t y1 = std::min(y0 + 1u, image.height - 1u);
-  const double yWeight = std::clamp(sourceY - std::floor(sourceY), 0.0, 1.0);
-  const size_t topLeftOffset = (static_cast<size_t>(y0) * image.width + x0) * 4u;
-  const size_t topRightOffset = (static_cast<size_t>(y0) * image.width + x1) * 4u;
-  const size_t bottomLeftOffset = (static_cast<size_t>(y1) * image.width + x0) * 4u;
-  const size_t bottomRightOffset = (static_cast<size_t>(y1) * image.width + x1) * 4u;
-  for (size_t channel = 0; channel < 4u; ++channel) {
-    const double top = image.rgba[topLeftOffset + channel] * (1.0 - xWeight) + image.rgba[topRightOffset + channel] * xWeight;
-    const double bottom = image.rgba[bottomLeftOffset + channel] * (1.0 - xWeight) + image.rgba[bottomRightOffset + channel] * xWeight;
-    sample[channel] = clampByte(static_cast<int>(std::round(top * (1.0 - yWeight) + bottom * yWeight)));
-  }
-}
-
-// Samples one fitted-image pixel (bilinear, un-premultiplied) and blends it.
-void blendSampledImagePixel(std::vector<uint8_t> &frame,
+// Samples one fitted-image pixel (trilinear across the mip chain at `lod`,
+// un-premultiplied) and blends it.
+void blendSampledImagePixel(RgbaFrameRef frame,
                             uint32_t width,
                             uint32_t height,
                             const RgbaImage &image,
                             double sourceX,
                             double sourceY,
+                            double lod,
                             int x,
                             int y) {
   uint8_t sample[4];
-  sampleImageBilinear(image, sourceX, sourceY, sample);
+  sampleImageMip(image, sourceX, sourceY, lod, MipFilter::kTrilinear, sample);
   const uint8_t alpha = sample[3];
   if (alpha == 0u) {
     return;
@@ -587,7 +583,7 @@ constexpr double kMediaPerspectiveFactor = 3.0;
 // is drawn through an inverse affine map; X/Y rotation leaves the image
 // plane and is projected with a CSS-like perspective, inverted per pixel via
 // the homography of the projected quad.
-void drawImageFitRotated(std::vector<uint8_t> &frame,
+void drawImageFitRotated(RgbaFrameRef frame,
                          uint32_t width,
                          uint32_t height,
                          const Rect &target,
@@ -706,7 +702,15 @@ void drawImageFitRotated(std::vector<uint8_t> &frame,
             }
             const double sourceX = u * image.width - 0.5;
             const double sourceY = v * image.height - 0.5;
-            blendSampledImagePixel(frame, width, height, image, sourceX, sourceY, x, y);
+            // Perspective foreshortening varies the footprint across the
+            // panel: take it from the screen-space derivatives of (u, v).
+            const double dudx = (inv00 - u * inv20) / w * image.width;
+            const double dvdx = (inv10 - v * inv20) / w * image.height;
+            const double dudy = (inv01 - u * inv21) / w * image.width;
+            const double dvdy = (inv11 - v * inv21) / w * image.height;
+            const double lod = mipLodForFootprint(
+                std::max(std::hypot(dudx, dvdx), std::hypot(dudy, dvdy)));
+            blendSampledImagePixel(frame, width, height, image, sourceX, sourceY, lod, x, y);
           }
         }
         return;
@@ -734,6 +738,9 @@ void drawImageFitRotated(std::vector<uint8_t> &frame,
   const int minY = std::max(0, static_cast<int>(std::floor(centerY - extentY)));
   const int maxX = std::min(static_cast<int>(width), static_cast<int>(std::ceil(centerX + extentX)));
   const int maxY = std::min(static_cast<int>(height), static_cast<int>(std::ceil(centerY + extentY)));
+  // Affine: one footprint (texels per screen pixel) for the whole panel.
+  const double lod = mipLodForFootprint(
+      std::max(std::hypot(inv00, inv10), std::hypot(inv01, inv11)) / scale);
 
   for (int y = minY; y < maxY; ++y) {
     for (int x = minX; x < maxX; ++x) {
@@ -746,12 +753,12 @@ void drawImageFitRotated(std::vector<uint8_t> &frame,
       }
       const double sourceX = ((localX + halfWidth) / drawWidth) * image.width - 0.5;
       const double sourceY = ((localY + halfHeight) / drawHeight) * image.height - 0.5;
-      blendSampledImagePixel(frame, width, height, image, sourceX, sourceY, x, y);
+      blendSampledImagePixel(frame, width, height, image, sourceX, sourceY, lod, x, y);
     }
   }
 }
 
-void drawMediaLayer(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const MediaLayerState &mediaLayer) {
+void drawMediaLayer(RgbaFrameRef frame, uint32_t width, uint32_t height, const MediaLayerState &mediaLayer) {
   if (!mediaLayer.enabled) {
     return;
   }
@@ -778,46 +785,42 @@ void drawMediaLayer(std::vector<uint8_t> &frame, uint32_t width, uint32_t height
     return;
   }
 
-  drawGlassRect(frame, width, height, rect, mediaLayer.rotation);
-  fillRotatedRect(frame, width, height, {rect.x + 12, rect.y + 12, std::max(0, rect.width - 24), 4}, mediaLayer.rotation, 255, 255, 255, 108);
-  fillRotatedRect(frame, width, height, {rect.x + 12, rect.y + rect.height - 18, std::max(0, (rect.width - 24) * 2 / 3), 6}, mediaLayer.rotation, 255, 255, 255, 78);
+  std::vector<RasterShape> shapes = glassPanelShapes(rect);
+  shapes.push_back(rasterRect({rect.x + 12, rect.y + 12, std::max(0, rect.width - 24), 4}, 255, 255, 255, 108));
+  shapes.push_back(rasterRect({rect.x + 12, rect.y + rect.height - 18, std::max(0, (rect.width - 24) * 2 / 3), 6}, 255, 255, 255, 78));
+  drawPanel(frame, width, height, rect, shapes, mediaLayer.rotation);
 }
 
-void drawGraphicsFrame(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const VideoFrame *graphicsFrame) {
+void drawGraphicsFrame(RgbaFrameRef frame, uint32_t width, uint32_t height, const VideoFrame *graphicsFrame,
+                       const std::vector<Rect> &regions) {
   if (graphicsFrame == nullptr || graphicsFrame->rgba.empty() || graphicsFrame->width == 0u || graphicsFrame->height == 0u) {
     return;
   }
-
-  const Rect rect{0, 0, static_cast<int>(width), static_cast<int>(height)};
-  const SourceRect source = coverSourceRect(graphicsFrame->width, graphicsFrame->height, rect.width, rect.height);
-  for (uint32_t y = 0; y < height; ++y) {
-    const uint32_t sy = std::min(
-        graphicsFrame->height - 1u,
-        source.y + static_cast<uint32_t>((static_cast<uint64_t>(y) * source.height) / height));
-    for (uint32_t x = 0; x < width; ++x) {
-      const uint32_t sx = std::min(
-          graphicsFrame->width - 1u,
-          source.x + static_cast<uint32_t>((static_cast<uint64_t>(x) * source.width) / width));
-      const size_t srcOffset = (static_cast<size_t>(sy) * graphicsFrame->width + sx) * 4u;
-      blendPixel(frame, width, height, static_cast<int>(x), static_cast<int>(y),
-                 graphicsFrame->rgba[srcOffset + 0],
-                 graphicsFrame->rgba[srcOffset + 1],
-                 graphicsFrame->rgba[srcOffset + 2],
-                 graphicsFrame->rgba[srcOffset + 3]);
-    }
-  }
+  drawRgbaCover(frame, width, height, graphicsFrame->rgba.data(), graphicsFrame->width, graphicsFrame->height,
+                false, regions);
 }
 
-void drawGraphics(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const GraphicsState &graphics) {
+void drawGraphics(RgbaFrameRef frame, uint32_t width, uint32_t height, const GraphicsState &graphics) {
   if (!graphics.enabled) {
     return;
   }
+  if (graphics.source == "native") {
+    // Templates rendered in-process; the cached layer only changes when the
+    // graphics section does.
+    static std::mutex rendererMutex;
+    static GraphicsTemplateRenderer renderer;
+    std::lock_guard<std::mutex> lock(rendererMutex);
+    renderer.update(graphics, width, height);
+    renderer.draw(frame);
+    return;
+  }
+  // Placeholder strap for browser-sourced graphics without a frame yet.
   const Rect lowerThird{static_cast<int>(width * 0.08), static_cast<int>(height * 0.76), static_cast<int>(width * 0.48), static_cast<int>(height * 0.10)};
   fillRect(frame, width, height, lowerThird, 255, 255, 255, 225);
   fillRect(frame, width, height, {lowerThird.x, lowerThird.y, lowerThird.width, 5}, 255, 132, 28, 255);
 }
 
-void drawCornerbug(std::vector<uint8_t> &frame, uint32_t width, uint32_t height, const CornerbugState &cornerbug) {
+void drawCornerbug(RgbaFrameRef frame, uint32_t width, uint32_t height, const CornerbugState &cornerbug) {
   if (!cornerbug.enabled) {
     return;
   }
@@ -832,9 +835,10 @@ void drawCornerbug(std::vector<uint8_t> &frame, uint32_t width, uint32_t height,
     drawImageFit(frame, width, height, rect, *image);
     return;
   }
-  drawGlassRect(frame, width, height, rect);
-  fillRect(frame, width, height, {rect.x + size / 5, rect.y + size / 5, size * 3 / 5, size * 3 / 5}, 255, 255, 255, 72);
-  fillRect(frame, width, height, {rect.x + size / 3, rect.y + size / 3, size / 3, size / 3}, 255, 255, 255, 52);
+  std::vector<RasterShape> shapes = glassPanelShapes(rect);
+  shapes.push_back(rasterRect({rect.x + size / 5, rect.y + size / 5, size * 3 / 5, size * 3 / 5}, 255, 255, 255, 72));
+  shapes.push_back(rasterRect({rect.x + size / 3, rect.y + size / 3, size / 3, size / 3}, 255, 255, 255, 52));
+  drawPanel(frame, width, height, rect, shapes, 0.0);
 }
 
 int gpuBackgroundMode(const std::string &mode) {
@@ -846,14 +850,14 @@ int gpuBackgroundMode(const std::string &mode) {
 }
 
 GpuLayerMapping layerMapping(const VideoFrame *frame, const Rect &target,
-                             bool mirror, bool keyed) {
+                             bool mirror, bool keyed, const CameraFraming &framing = CameraFraming{}) {
   GpuLayerMapping mapping;
   if (frame == nullptr || frame->rgba.empty() || frame->width == 0u ||
       frame->height == 0u || target.width <= 0 || target.height <= 0) {
     return mapping;
   }
-  const SourceRect source = coverSourceRect(frame->width, frame->height,
-                                             target.width, target.height);
+  const SourceRect source = framedSourceRect(frame->width, frame->height, framing,
+                                              target.width, target.height);
   mapping.present = true;
   mapping.keyed = keyed;
   mapping.mirror = mirror;
@@ -950,14 +954,17 @@ GpuComposePlan buildGpuPlan(const Options &options,
           offsetX += horizontalTravel;
         }
       }
+      // The framing window stands in for the whole camera frame.
+      const CameraWindow window =
+          framingWindow(snapshot.cameraFraming, cameraFrame->width, cameraFrame->height);
       const double sourceCenterX =
-          static_cast<double>(cameraFrame->width) * 0.5;
+          window.x + static_cast<double>(window.width) * 0.5;
       const double sourceCenterY =
-          static_cast<double>(cameraFrame->height) * 0.5;
+          window.y + static_cast<double>(window.height) * 0.5;
       const double kx =
-          (static_cast<double>(plan.width) / cameraFrame->width) * scale;
+          (static_cast<double>(plan.width) / window.width) * scale;
       const double ky =
-          (static_cast<double>(plan.height) / cameraFrame->height) * scale;
+          (static_cast<double>(plan.height) / window.height) * scale;
       const double targetCenterX =
           static_cast<double>(plan.width) * 0.5 + offsetX;
       const double targetBottomY = static_cast<double>(plan.height) - 0.5;
@@ -973,14 +980,16 @@ GpuComposePlan buildGpuPlan(const Options &options,
       plan.camera.biasY = static_cast<float>(
           sourceCenterY - 0.5 - targetCenterY / ky);
       plan.camera.mirrorConst =
-          static_cast<float>(cameraFrame->width) - 1.0f;
+          static_cast<float>(window.x * 2u + window.width) - 1.0f;
     } else {
       plan.camera = layerMapping(cameraFrame, fullFrame,
-                                 snapshot.cameraRender.mirror, false);
+                                 snapshot.cameraRender.mirror, false,
+                                 snapshot.cameraFraming);
     }
   } else if (snapshot.cameraRender.enabled) {
     plan.camera = layerMapping(cameraFrame, fullFrame,
-                               snapshot.cameraRender.mirror, false);
+                               snapshot.cameraRender.mirror, false,
+                               snapshot.cameraFraming);
   }
   plan.backGraphics = backGraphicsFrame;
   plan.backMapping = layerMapping(backGraphicsFrame, fullFrame, false, false);
@@ -996,25 +1005,14 @@ void renderProgramFrameCpu(const Options &options,
                            const VideoFrame *backGraphicsFrame,
                            const VideoFrame *frontGraphicsFrame,
                            uint64_t frameIndex,
-                           std::vector<uint8_t> &output) {
-  fillBackground(output, options.width, options.height, snapshot.backgroundMode, frameIndex);
+                           const std::vector<Rect> &regions,
+                           RgbaFrameRef output) {
+  fillBackground(output, options.width, options.height, snapshot.backgroundMode, frameIndex, regions);
   if (const auto backgroundImage = getBackgroundImage(snapshot.backgroundImagePath)) {
     // Cover-fit the uploaded company background under all other layers.
-    const SourceRect source = coverSourceRect(
-        backgroundImage->width, backgroundImage->height,
-        static_cast<int>(options.width), static_cast<int>(options.height));
-    for (uint32_t y = 0; y < options.height; ++y) {
-      const uint32_t sy = std::min(backgroundImage->height - 1u,
-          source.y + static_cast<uint32_t>((static_cast<uint64_t>(y) * source.height) / options.height));
-      for (uint32_t x = 0; x < options.width; ++x) {
-        const uint32_t sx = std::min(backgroundImage->width - 1u,
-            source.x + static_cast<uint32_t>((static_cast<uint64_t>(x) * source.width) / options.width));
-        const size_t srcOffset = (static_cast<size_t>(sy) * backgroundImage->width + sx) * 4u;
-        blendPixel(output, options.width, options.height, static_cast<int>(x), static_cast<int>(y),
-                   backgroundImage->rgba[srcOffset + 0], backgroundImage->rgba[srcOffset + 1],
-                   backgroundImage->rgba[srcOffset + 2], backgroundImage->rgba[srcOffset + 3]);
-      }
-    }
+    const auto fitted = getCoverFittedBackground(backgroundImage, options.width, options.height);
+    drawRgbaCover(output, options.width, options.height, fitted->rgba.data(), fitted->width, fitted->height,
+                  true, regions);
   }
 
   const bool keyedCameraFrame = snapshot.keyerEnabled &&
@@ -1026,7 +1024,7 @@ void renderProgramFrameCpu(const Options &options,
 
   // Back graphics are treated as a background/backplate layer.
   // They must never cover PiP, camera/key, normal graphics or cornerbug.
-  drawGraphicsFrame(output, options.width, options.height, backGraphicsFrame);
+  drawGraphicsFrame(output, options.width, options.height, backGraphicsFrame, regions);
 
   if (keyedCameraFrame) {
     // Keyer ON with a usable mask:
@@ -1042,7 +1040,9 @@ void renderProgramFrameCpu(const Options &options,
           cameraRect(options.width, options.height, snapshot.speakerLayout),
           cameraFrame,
           cameraMask,
-          snapshot.cameraRender.mirror);
+          snapshot.cameraRender.mirror,
+          snapshot.cameraFraming,
+          regions);
     }
   } else {
     // Keyer OFF or keyer fallback/passthrough:
@@ -1055,7 +1055,9 @@ void renderProgramFrameCpu(const Options &options,
           cameraRect(options.width, options.height, snapshot.speakerLayout),
           cameraFrame,
           cameraMask,
-          snapshot.cameraRender.mirror);
+          snapshot.cameraRender.mirror,
+          snapshot.cameraFraming,
+          regions);
     }
     if (mediaLayerIsPip) {
       drawMediaLayer(output, options.width, options.height, snapshot.mediaLayer);
@@ -1068,10 +1070,216 @@ void renderProgramFrameCpu(const Options &options,
   }
 
   drawGraphics(output, options.width, options.height, snapshot.graphics);
-  drawGraphicsFrame(output, options.width, options.height, frontGraphicsFrame);
+  drawGraphicsFrame(output, options.width, options.height, frontGraphicsFrame, regions);
   drawCornerbug(output, options.width, options.height, snapshot.cornerbug);
 }
 
+// BROADIFY_MEETING_INCREMENTAL_COMPOSITOR=0 recomposes every CPU frame in
+// full instead of carrying undamaged tiles over.
+bool incrementalCompositingEnabled() {
+  static const bool enabled = [] {
+    const char *value = std::getenv("BROADIFY_MEETING_INCREMENTAL_COMPOSITOR");
+    return value == nullptr || std::strcmp(value, "0") != 0;
+  }();
+  return enabled;
+}
+
+// Every input of the CPU frame that TileDamageTracker does not follow per
+// tile (it tracks the camera, its mask and the FrameBus graphics layers).
+uint64_t cpuSceneKey(const CompositorSnapshot &snapshot, bool keyedCameraFrame, uint64_t frameIndex) {
+  uint64_t key = std::hash<std::string>{}(snapshot.backgroundMode);
+  for (const uint64_t value : {
+           static_cast<uint64_t>(std::hash<std::string>{}(snapshot.backgroundImagePath)),
+           static_cast<uint64_t>(keyedCameraFrame),
+           static_cast<uint64_t>(snapshot.conferenceMode),
+           snapshot.mediaLayer.fields.revision(),
+           static_cast<uint64_t>(std::hash<std::string>{}(snapshot.mediaLayer.renderedPagePath)),
+           static_cast<uint64_t>(std::hash<std::string>{}(snapshot.mediaLayer.renderStatus)),
+           snapshot.graphics.fields.revision(),
+           static_cast<uint64_t>(std::hash<std::string>{}(snapshot.graphics.source)),
+           snapshot.cornerbug.fields.revision(),
+           // The gradient background moves every frame.
+           snapshot.backgroundMode == "gradient" ? frameIndex : 0u}) {
+    key = key * 1099511628211u + value;
+  }
+  return key;
+}
+
+std::vector<Rect> tileRegions(const std::vector<TileRect> &runs) {
+  std::vector<Rect> regions;
+  regions.reserve(runs.size());
+  for (const TileRect &run : runs) {
+    regions.push_back({run.x, run.y, run.width, run.height});
+  }
+  return regions;
+}
+
+void copyRegions(uint8_t *destination, const uint8_t *source, uint32_t width, const std::vector<Rect> &regions) {
+  for (const Rect &region : regions) {
+    for (int y = region.y; y < region.y + region.height; ++y) {
+      const size_t offset = (static_cast<size_t>(y) * width + static_cast<size_t>(region.x)) * 4u;
+      std::memcpy(destination + offset, source + offset, static_cast<size_t>(region.width) * 4u);
+    }
+  }
+}
+
+// CPU frames are recomposed tile by tile: only the tiles TileDamageTracker
+// reports damaged are drawn, the rest is copied from the previous CPU frame.
+// The cache keeps that frame because `output` is usually a different FrameBus
+// slot each time. Media, generated graphics and the cornerbug cannot be
+// clipped and are drawn whole (they are small), but whatever they touch
+// outside the damaged tiles is overwritten by the carried-over copy.
+void renderProgramFrameCpuIncremental(const Options &options,
+                                      const CompositorSnapshot &snapshot,
+                                      const VideoFrame *cameraFrame,
+                                      const AlphaMask *cameraMask,
+                                      const VideoFrame *backGraphicsFrame,
+                                      const VideoFrame *frontGraphicsFrame,
+                                      uint64_t frameIndex,
+                                      RgbaFrameRef output,
+                                      CompositorTileCache &cache) {
+  TileDamageTracker &damage = cache.damage;
+  std::vector<uint8_t> &previous = cache.previous;
+
+  TileCameraLayer camera;
+  if (snapshot.cameraRender.enabled && cameraFrame != nullptr) {
+    const Rect rect = cameraRect(options.width, options.height, snapshot.speakerLayout);
+    const SourceRect source = framedSourceRect(cameraFrame->width, cameraFrame->height, snapshot.cameraFraming,
+                                               rect.width, rect.height);
+    camera.frame = cameraFrame;
+    camera.mask = cameraMask;
+    camera.rect = {rect.x, rect.y, rect.width, rect.height};
+    camera.sourceX = source.x;
+    camera.sourceY = source.y;
+    camera.sourceWidth = source.width;
+    camera.sourceHeight = source.height;
+    camera.mirror = snapshot.cameraRender.mirror;
+  }
+  const bool keyedCameraFrame = snapshot.keyerEnabled &&
+      cameraMask != nullptr && !cameraMask->alpha.empty();
+  if (previous.size() != output.size()) {
+    damage.invalidate();
+  }
+  damage.update(options.width, options.height, cpuSceneKey(snapshot, keyedCameraFrame, frameIndex),
+                camera, backGraphicsFrame, frontGraphicsFrame);
+
+  const size_t damaged = damage.damagedTileCount();
+  if (damage.fullDamage()) {
+    renderProgramFrameCpu(options, snapshot, cameraFrame, cameraMask, backGraphicsFrame,
+                          frontGraphicsFrame, frameIndex, wholeFrame(options.width, options.height), output);
+    previous.assign(output.data(), output.data() + output.size());
+  } else if (damaged == 0u) {
+    std::memcpy(output.data(), previous.data(), previous.size());
+  } else {
+    const std::vector<Rect> regions = tileRegions(damage.runs(true));
+    renderProgramFrameCpu(options, snapshot, cameraFrame, cameraMask, backGraphicsFrame,
+                          frontGraphicsFrame, frameIndex, regions, output);
+    copyRegions(previous.data(), output.data(), options.width, regions);
+    copyRegions(output.data(), previous.data(), options.width, tileRegions(damage.runs(false)));
+  }
+  cache.totalTiles = static_cast<uint32_t>(damage.tileCount());
+  cache.recomposedTiles = static_cast<uint32_t>(damaged);
+}
+
+// BROADIFY_MEETING_CAMERA_PASSTHROUGH=0 composes camera-only programs like
+// every other scene instead of copying the camera into the output.
+bool cameraPassthroughEnabled() {
+  static const bool enabled = [] {
+    const char *value = std::getenv("BROADIFY_MEETING_CAMERA_PASSTHROUGH");
+    return value == nullptr || std::strcmp(value, "0") != 0;
+  }();
+  return enabled;
+}
+
+// The part of `cameraFrame` that is the whole program, pixel for pixel, as
+// long as the frame is opaque: the camera is the only layer, unkeyed, covers
+// the frame (no speaker layout, or one that works out to the full frame) and
+// its framed crop is already at output size. Every other layer would be fully
+// covered by the camera or is absent, so compositing reduces to copying those
+// rows. False for any other scene.
+bool cameraPassthroughSource(const Options &options,
+                             const CompositorSnapshot &snapshot,
+                             const VideoFrame *cameraFrame,
+                             const AlphaMask *cameraMask,
+                             const VideoFrame *backGraphicsFrame,
+                             const VideoFrame *frontGraphicsFrame,
+                             SourceRect &source) {
+  if (!snapshot.cameraRender.enabled || cameraFrame == nullptr || cameraFrame->width == 0u ||
+      cameraFrame->height == 0u ||
+      cameraFrame->rgba.size() < static_cast<size_t>(cameraFrame->width) * cameraFrame->height * 4u) {
+    return false;
+  }
+  if ((cameraMask != nullptr && !cameraMask->alpha.empty()) || snapshot.mediaLayer.enabled ||
+      snapshot.graphics.enabled || snapshot.cornerbug.enabled ||
+      (backGraphicsFrame != nullptr && !backGraphicsFrame->rgba.empty()) ||
+      (frontGraphicsFrame != nullptr && !frontGraphicsFrame->rgba.empty())) {
+    return false;
+  }
+  const Rect rect = cameraRect(options.width, options.height, snapshot.speakerLayout);
+  if (rect.x != 0 || rect.y != 0 || rect.width != static_cast<int>(options.width) ||
+      rect.height != static_cast<int>(options.height)) {
+    return false;
+  }
+  source = framedSourceRect(cameraFrame->width, cameraFrame->height, snapshot.cameraFraming,
+                            rect.width, rect.height);
+  return source.width == options.width && source.height == options.height;
+}
+
+// True when none of `count` RGBA pixels is translucent.
+bool opaqueRow(const uint8_t *rgba, uint32_t count) {
+  uint8_t alpha = 255u;
+  for (uint32_t x = 0; x < count; ++x) {
+    alpha &= rgba[x * 4u + 3u];
+  }
+  return alpha == 255u;
+}
+
+// drawCamera at 1:1 without a mask: blending opaque camera pixels over the
+// background leaves exactly the camera rows (drawCamera writes alpha 255,
+// which they already carry). Rows are checked and copied in bands of
+// kStreamingCopyMinBytes, so the copy still streams and reads the rows the
+// check just pulled into cache. Returns false, with `output` partly written,
+// at the first translucent pixel; the caller then composes the frame.
+bool copyCameraPassthrough(const VideoFrame &cameraFrame, const SourceRect &source, bool mirror,
+                           RgbaFrameRef output) {
+  const size_t sourceStride = static_cast<size_t>(cameraFrame.width) * 4u;
+  const size_t rowBytes = static_cast<size_t>(source.width) * 4u;
+  const uint8_t *sourceRows = cameraFrame.rgba.data() + source.y * sourceStride + source.x * 4u;
+  if (mirror) {
+    for (uint32_t y = 0; y < source.height; ++y) {
+      const uint32_t *srcPixels = reinterpret_cast<const uint32_t *>(sourceRows + y * sourceStride);
+      uint32_t *dstPixels = reinterpret_cast<uint32_t *>(output.data() + y * rowBytes);
+      for (uint32_t x = 0, last = source.width - 1u; x < source.width; ++x) {
+        dstPixels[x] = srcPixels[last - x];
+      }
+      if (!opaqueRow(output.data() + y * rowBytes, source.width)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  const uint32_t bandRows =
+      std::max<uint32_t>(1u, static_cast<uint32_t>(kStreamingCopyMinBytes / rowBytes));
+  for (uint32_t bandY = 0; bandY < source.height; bandY += bandRows) {
+    const uint32_t rows = std::min(bandRows, source.height - bandY);
+    const uint8_t *src = sourceRows + bandY * sourceStride;
+    uint8_t *dst = output.data() + bandY * rowBytes;
+    for (uint32_t y = 0; y < rows; ++y) {
+      if (!opaqueRow(src + y * sourceStride, source.width)) {
+        return false;
+      }
+    }
+    if (rowBytes == sourceStride) {
+      copyFrameBytes(dst, src, rows * rowBytes, FrameCopyTarget::Handoff);
+      continue;
+    }
+    for (uint32_t y = 0; y < rows; ++y) {
+      std::memcpy(dst + y * rowBytes, src + y * sourceStride, rowBytes);
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 CompositorSnapshot copyCompositorSnapshot(const MeetingState &state) {
@@ -1086,13 +1294,38 @@ CompositorSnapshot copyCompositorSnapshot(const MeetingState &state) {
   snapshot.mediaLayer = state.mediaLayer;
   snapshot.graphics = state.graphics;
   snapshot.cameraRender = state.cameraRender;
+  snapshot.cameraFraming =
+      manualCameraFraming(state.cameraRender.zoom, state.cameraRender.panX, state.cameraRender.panY);
   return snapshot;
 }
 
+double cameraDisplayScale(const Options &options, const CompositorSnapshot &snapshot,
+                          uint32_t cameraWidth, uint32_t cameraHeight, bool keyed) {
+  if (!snapshot.cameraRender.enabled || cameraWidth == 0u || cameraHeight == 0u ||
+      options.width == 0u || options.height == 0u) {
+    return 1.0;
+  }
+  // CPU: cover-fit into cameraRect (speaker layout applied keyed or not).
+  const Rect rect = cameraRect(options.width, options.height, snapshot.speakerLayout);
+  const SourceRect source =
+      framedSourceRect(cameraWidth, cameraHeight, snapshot.cameraFraming, rect.width, rect.height);
+  const double cpuScale = std::max(static_cast<double>(rect.width) / std::max(1u, source.width),
+                                   static_cast<double>(rect.height) / std::max(1u, source.height));
+  // GPU: cover-fit of the framing window over the whole output, scaled by
+  // the speaker layout when keyed (buildGpuPlan).
+  const CameraWindow window = framingWindow(snapshot.cameraFraming, cameraWidth, cameraHeight);
+  double gpuScale = std::max(static_cast<double>(options.width) / window.width,
+                             static_cast<double>(options.height) / window.height);
+  if (keyed && snapshot.speakerLayout.enabled) {
+    gpuScale *= std::clamp(snapshot.speakerLayout.scale, 0.4, 1.8);
+  }
+  return std::min(1.0, std::max(cpuScale, gpuScale));
+}
+
 // Draws a second live camera as a picture-in-picture inset in the bottom-right
 // corner of the finished program frame. Runs on the CPU over the final RGBA
 // output, so it works after either the GPU or CPU main compositing path.
-void drawCameraPipInset(std::vector<uint8_t> &output, uint32_t width,
+void drawCameraPipInset(RgbaFrameRef output, uint32_t width,
                         uint32_t height, const VideoFrame &pip) {
   if (pip.rgba.empty() || pip.width == 0u || pip.height == 0u) {
     return;
@@ -1117,19 +1350,16 @@ void drawCameraPipInset(std::vector<uint8_t> &output, uint32_t width,
                  static_cast<int>(y), 235, 238, 242, 255);
     }
   }
-  // Nearest-neighbour downscale of the PiP camera into the inset.
+  // Filtered downscale straight into the inset rect of the output, then
+  // force it opaque like the rest of the program frame.
+  uint8_t *inset = output.data() + (static_cast<size_t>(y0) * width + x0) * 4u;
+  resampleImage({pip.rgba.data(), pip.width, pip.height, static_cast<size_t>(pip.width) * 4u, 4u},
+                {inset, insetW, insetH, static_cast<size_t>(width) * 4u, 4u},
+                ResampleFilter::kArea);
   for (uint32_t y = 0; y < insetH; ++y) {
-    const uint32_t sy = std::min(
-        pip.height - 1u,
-        static_cast<uint32_t>((static_cast<uint64_t>(y) * pip.height) / insetH));
+    uint8_t *row = inset + static_cast<size_t>(y) * width * 4u;
     for (uint32_t x = 0; x < insetW; ++x) {
-      const uint32_t sx = std::min(
-          pip.width - 1u,
-          static_cast<uint32_t>((static_cast<uint64_t>(x) * pip.width) / insetW));
-      const size_t s = (static_cast<size_t>(sy) * pip.width + sx) * 4u;
-      blendPixel(output, width, height, static_cast<int>(x0 + x),
-                 static_cast<int>(y0 + y), pip.rgba[s + 0], pip.rgba[s + 1],
-                 pip.rgba[s + 2], 255);
+      row[x * 4u + 3u] = 255u;
     }
   }
 }
@@ -1140,7 +1370,7 @@ void drawCameraPipInset(std::vector<uint8_t> &output, uint32_t width,
 // then re-drawn on top so they stay above the content, matching how they sit
 // above the camera. No-op for meeting, where content is a backplate behind the
 // keyed presenter.
-void drawConferenceContentOverlay(std::vector<uint8_t> &output,
+void drawConferenceContentOverlay(RgbaFrameRef output,
                                   const Options &options,
                                   const CompositorSnapshot &snapshot,
                                   const VideoFrame *frontGraphicsFrame) {
@@ -1152,7 +1382,8 @@ void drawConferenceContentOverlay(std::vector<uint8_t> &output,
   // they stay above it, the same way they sit above the camera. drawGraphicsFrame
   // is bounds-checked and a no-op when the frame is null/empty.
   if (frontGraphicsFrame != nullptr && !frontGraphicsFrame->rgba.empty()) {
-    drawGraphicsFrame(output, options.width, options.height, frontGraphicsFrame);
+    drawGraphicsFrame(output, options.width, options.height, frontGraphicsFrame,
+                      wholeFrame(options.width, options.height));
   }
 }
 
@@ -1163,7 +1394,30 @@ std::string renderProgramFrame(const Options &options,
                                const VideoFrame *backGraphicsFrame,
                                const VideoFrame *frontGraphicsFrame,
                                uint64_t frameIndex,
-                               std::vector<uint8_t> &output) {
+                               RgbaFrameRef output,
+                               CompositorTileCache *tileCache) {
+  if (tileCache != nullptr) {
+    tileCache->totalTiles = 0u;
+    tileCache->recomposedTiles = 0u;
+  }
+  if (output.empty() ||
+      output.size() != static_cast<size_t>(options.width) * options.height * 4u) {
+    return "none";
+  }
+  // Plain camera output (the common unkeyed, overlay-free program) skips
+  // compositing altogether, on any backend. A translucent camera frame falls
+  // through and is composed over the background like any other scene.
+  SourceRect passthrough;
+  if (cameraPassthroughEnabled() &&
+      cameraPassthroughSource(options, snapshot, cameraFrame, cameraMask, backGraphicsFrame,
+                              frontGraphicsFrame, passthrough) &&
+      copyCameraPassthrough(*cameraFrame, passthrough, snapshot.cameraRender.mirror, output)) {
+    if (tileCache != nullptr) {
+      // The carried-over CPU frame is stale once a frame bypasses it.
+      tileCache->damage.invalidate();
+    }
+    return "passthrough";
+  }
   // Bake the content layer into the back-graphics layer so the GPU compositor
   // can render content scenes on the GPU. Only the content's own rect plus one
   // back-buffer copy stay on the CPU; the heavy full-frame multi-layer blend
@@ -1184,7 +1438,7 @@ std::string renderProgramFrame(const Options &options,
     // the cache key must also track the background path — otherwise switching
     // (or clearing) the background would not rebuild the baked frame.
     const uint64_t key =
-        (std::hash<std::string>{}(snapshot.mediaLayer.rawJson) * 1099511628211u +
+        (snapshot.mediaLayer.fields.revision() * 1099511628211u +
          backTs) *
             1099511628211u +
         std::hash<std::string>{}(snapshot.backgroundImagePath);
@@ -1202,36 +1456,15 @@ std::string renderProgramFrame(const Options &options,
       // otherwise be lost, leaving the area around the content black.
       if (const auto backgroundImage =
               getBackgroundImage(snapshot.backgroundImagePath)) {
-        const SourceRect source = coverSourceRect(
-            backgroundImage->width, backgroundImage->height,
-            static_cast<int>(options.width),
-            static_cast<int>(options.height));
-        for (uint32_t y = 0; y < options.height; ++y) {
-          const uint32_t sy = std::min(
-              backgroundImage->height - 1u,
-              source.y + static_cast<uint32_t>(
-                             (static_cast<uint64_t>(y) * source.height) /
-                             options.height));
-          for (uint32_t x = 0; x < options.width; ++x) {
-            const uint32_t sx = std::min(
-                backgroundImage->width - 1u,
-                source.x + static_cast<uint32_t>(
-                               (static_cast<uint64_t>(x) * source.width) /
-                               options.width));
-            const size_t srcOffset =
-                (static_cast<size_t>(sy) * backgroundImage->width + sx) * 4u;
-            blendPixel(cachedBack.rgba, options.width, options.height,
-                       static_cast<int>(x), static_cast<int>(y),
-                       backgroundImage->rgba[srcOffset + 0],
-                       backgroundImage->rgba[srcOffset + 1],
-                       backgroundImage->rgba[srcOffset + 2],
-                       backgroundImage->rgba[srcOffset + 3]);
-          }
-        }
+        drawRgbaCover(cachedBack.rgba, options.width, options.height,
+                      backgroundImage->rgba.data(), backgroundImage->width,
+                      backgroundImage->height, true,
+                      wholeFrame(options.width, options.height));
       }
       if (backGraphicsFrame != nullptr && !backGraphicsFrame->rgba.empty()) {
         drawGraphicsFrame(cachedBack.rgba, options.width, options.height,
-                          backGraphicsFrame);
+                          backGraphicsFrame,
+                          wholeFrame(options.width, options.height));
       }
       drawMediaLayer(cachedBack.rgba, options.width, options.height,
                      snapshot.mediaLayer);
@@ -1268,9 +1501,14 @@ std::string renderProgramFrame(const Options &options,
     }
 #endif
   }
-  renderProgramFrameCpu(options, snapshot, cameraFrame, cameraMask,
-                        backGraphicsFrame, frontGraphicsFrame, frameIndex,
-                        output);
+  if (tileCache != nullptr && incrementalCompositingEnabled()) {
+    renderProgramFrameCpuIncremental(options, snapshot, cameraFrame, cameraMask,
+                                     backGraphicsFrame, frontGraphicsFrame, frameIndex,
+                                     output, *tileCache);
+  } else {
+    renderProgramFrameCpu(options, snapshot, cameraFrame, cameraMask, backGraphicsFrame,
+                          frontGraphicsFrame, frameIndex, wholeFrame(options.width, options.height), output);
+  }
   return "cpu";
 }
 
@@ -1335,12 +1573,14 @@ GpuCompositorSelfTestResult runGpuCompositorSelfTest() {
     }
   }
 
-  std::vector<uint8_t> cpuOutput;
+  const size_t frameBytes = static_cast<size_t>(options.width) * options.height * 4u;
+  std::vector<uint8_t> cpuOutput(frameBytes, 0u);
   renderProgramFrameCpu(options, snapshot, &camera, &mask, &backGraphics,
-                        &frontGraphics, 11u, cpuOutput);
+                        &frontGraphics, 11u, wholeFrame(options.width, options.height),
+                        cpuOutput);
   const GpuComposePlan plan = buildGpuPlan(
       options, snapshot, &camera, &mask, &backGraphics, &frontGraphics, 11u);
-  std::vector<uint8_t> gpuOutput;
+  std::vector<uint8_t> gpuOutput(frameBytes, 0u);
   GpuCompositorSelfTestResult result;
 #if defined(__APPLE__)
   result.backend = "metal";
@@ -1376,10 +1616,10 @@ GpuCompositorSelfTestResult runGpuCompositorSelfTest() {
   CompositorSnapshot layeredSnapshot = snapshot;
   layeredSnapshot.cornerbug.enabled = true;
   layeredSnapshot.graphics.enabled = true;
-  std::vector<uint8_t> layeredOutput;
+  std::vector<uint8_t> layeredOutput(frameBytes, 0u);
   const std::string integratedBackend = renderProgramFrame(
       options, layeredSnapshot, &camera, &mask, &backGraphics, &frontGraphics,
-      12u, layeredOutput);
+      12u, layeredOutput, nullptr);
   result.passed = maxDelta <= 2 && integratedBackend == result.backend;
   return result;
 }
@@ -2,6 +2,9 @@
 
 #include "capture/camera_source.h"
 #include "common/options.h"
+#include "compose/camera_framing.h"
+#include "compose/rgba_frame_ref.h"
+#include "compose/tile_damage.h"
 #include "keyer/keyer.h"
 #include "state/meeting_state.h"
 
@@ -20,6 +23,9 @@ struct CompositorSnapshot {
   MediaLayerState mediaLayer;
   GraphicsState graphics;
   CameraRenderState cameraRender;
+  // Effective pan/zoom of the program camera: the manual one from
+  // cameraRender, or the auto-framing the program loop puts in.
+  CameraFraming cameraFraming;
 };
 
 struct GpuCompositorSelfTestResult {
@@ -35,13 +41,39 @@ struct GpuCompositorSelfTestResult {
   std::string backend = "cpu";
 };
 
+// State for incremental CPU composition, owned by the render loop: the last
+// CPU frame and the inputs each of its tiles was composed from. After every
+// render, `recomposedTiles` of `totalTiles` were drawn and the others carried
+// over; both are 0 for GPU frames and with incremental composition off.
+struct CompositorTileCache {
+  TileDamageTracker damage;
+  std::vector<uint8_t> previous;
+  uint32_t totalTiles = 0;
+  uint32_t recomposedTiles = 0;
+};
+
 CompositorSnapshot copyCompositorSnapshot(const MeetingState &state);
 
+// Output pixels per camera pixel at which the current layout shows a
+// cameraWidth x cameraHeight camera (the larger of the CPU and GPU
+// placements, so neither path is undersampled), capped at 1. `keyed` selects
+// the keyed placement: the GPU path only applies the speaker-layout scale to
+// a keyed camera. Refinement and camera resampling run at this size.
+double cameraDisplayScale(const Options &options, const CompositorSnapshot &snapshot,
+                          uint32_t cameraWidth, uint32_t cameraHeight, bool keyed);
+
 // Conference: overlay a second live camera as a picture-in-picture inset on a
 // finished program frame (bottom-right). No-op when the PiP frame is empty.
-void drawCameraPipInset(std::vector<uint8_t> &output, uint32_t width,
+void drawCameraPipInset(RgbaFrameRef output, uint32_t width,
                         uint32_t height, const VideoFrame &pip);
 
+// Renders the program frame in place into `output`, which must hold exactly
+// options.width * options.height * 4 bytes (e.g. an acquired FrameBus slot).
+// Returns the backend that produced it ("cpu", "metal", "d3d11", or
+// "passthrough" when the program is just the camera at output size and was
+// copied straight in), or "none" when `output` does not match the geometry. With a `tileCache`, CPU frames
+// recompose only the tiles whose inputs changed since the previous call with
+// that cache; without one (probes, self-tests) every pixel is recomposed.
 std::string renderProgramFrame(const Options &options,
                                const CompositorSnapshot &snapshot,
                                const VideoFrame *cameraFrame,
@@ -49,7 +81,8 @@ std::string renderProgramFrame(const Options &options,
                                const VideoFrame *backGraphicsFrame,
                                const VideoFrame *frontGraphicsFrame,
                                uint64_t frameIndex,
-                               std::vector<uint8_t> &output);
+                               RgbaFrameRef output,
+                               CompositorTileCache *tileCache);
 
 GpuCompositorSelfTestResult runGpuCompositorSelfTest();
 
@@ -1,5 +1,6 @@
 #include "compose/d3d11_compositor.h"
 #include "compose/gpu_compositor_uniforms.h"
+#include "util/frame_copy.h"
 
 // D3D11 port of the Metal GPU compositor (metal_compositor.mm): one compute
 // dispatch composites the background mode, graphics, and camera into an RGBA
@@ -420,7 +421,7 @@ bool d3d11CompositorHardwareAccelerated() {
 }
 
 bool renderProgramFrameD3D11(const GpuComposePlan &plan,
-                             std::vector<uint8_t> &output) {
+                             RgbaFrameRef output) {
   if (!initializeContext() || plan.width == 0u || plan.height == 0u) {
     return false;
   }
@@ -429,6 +430,9 @@ bool renderProgramFrameD3D11(const GpuComposePlan &plan,
     logCompositorEvent("output_alloc_failed", "");
     return false;
   }
+  if (output.size() != ctx.outputBufferSize) {
+    return false;
+  }
 
   GpuComposeUniforms uniforms{};
   uniforms.width = plan.width;
@@ -521,8 +525,8 @@ bool renderProgramFrameD3D11(const GpuComposePlan &plan,
     logCompositorEvent("readback_failed", hresultDetail(hr));
     return false;
   }
-  output.resize(ctx.outputBufferSize);
-  std::memcpy(output.data(), mapped.pData, ctx.outputBufferSize);
+  copyFrameBytes(output.data(), static_cast<const uint8_t *>(mapped.pData), ctx.outputBufferSize,
+                 FrameCopyTarget::Handoff);
   ctx.context->Unmap(ctx.stagingBuffer.Get(), 0);
   return true;
 }
@@ -568,7 +572,7 @@ RWTexture2D<float2> outRG : register(u0);
 RWByteAddressBuffer outBytes : register(u1);
 
 // Pass 1: I = guide luma, p = mask, both bilinear-resampled onto the work grid
-// (sampler at (x+0.5)/work matches the CPU resamplePlane coordinates).
+// (sampler at (x+0.5)/work matches the CPU resampleImage pixel centres).
 [numthreads(8, 8, 1)]
 void buildIp(uint3 gid : SV_DispatchThreadID) {
   if (gid.x >= workW || gid.y >= workH) return;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "compose/gpu_compositor_types.h"
+#include "compose/rgba_frame_ref.h"
 #include "keyer/keyer.h"
 
 namespace broadify::meeting {
@@ -18,11 +19,12 @@ bool d3d11CompositorSelfTestAvailable();
 bool d3d11CompositorHardwareAccelerated();
 
 // Composites the shared GPU compose plan (background + graphics + keyed
-// camera) on the GPU into `output` (RGBA, width*height*4).
+// camera) on the GPU into `output`, which must already hold width*height*4
+// bytes.
 // Returns false on any failure; callers must then render through the CPU
 // compositor instead.
 bool renderProgramFrameD3D11(const GpuComposePlan &plan,
-                             std::vector<uint8_t> &output);
+                             RgbaFrameRef output);
 
 // True when the D3D11 guided mask refine is available. It is enabled by
 // default; BROADIFY_MEETING_GPU_GUIDED=0 forces the portable CPU fallback.
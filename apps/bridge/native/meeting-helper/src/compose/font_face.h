@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+// One rasterized glyph: an 8-bit coverage bitmap placed relative to the pen
+// position on the baseline (`left` to the right, `top` rows above it).
+struct GlyphBitmap {
+  int32_t left = 0;
+  int32_t top = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  float advance = 0.0f;
+  std::vector<uint8_t> coverage;
+};
+
+struct FontMetrics {
+  float ascent = 0.0f;
+  float descent = 0.0f;  // positive, below the baseline
+  float lineHeight = 0.0f;
+};
+
+// A font at one pixel size, backed by the platform rasterizer (CoreText on
+// macOS, GDI on Windows, FreeType elsewhere). Not thread-safe; the glyph
+// atlas that owns faces serialises access.
+class FontFace {
+ public:
+  virtual ~FontFace() = default;
+
+  virtual FontMetrics metrics() const = 0;
+  // False when the face has no glyph for `codepoint`. Blank glyphs (space)
+  // succeed with an empty bitmap and their advance.
+  virtual bool rasterize(uint32_t codepoint, GlyphBitmap &glyph) = 0;
+};
+
+// Opens `family` (a family name, or a font file path where the backend reads
+// files; empty means the platform's default sans-serif) at `pixelSize` px
+// (em height). Null when the font cannot be opened or text rendering is
+// unavailable on this build.
+std::unique_ptr<FontFace> openFontFace(const std::string &family, bool bold, uint32_t pixelSize);
+
+// Whether this build can rasterize text at all.
+bool fontRenderingAvailable();
+
+}  // namespace broadify::meeting
@@ -0,0 +1,123 @@
+#include "compose/font_face.h"
+
+#if defined(__APPLE__)
+
+#include <ApplicationServices/ApplicationServices.h>
+
+#include <cmath>
+
+namespace broadify::meeting {
+namespace {
+
+class CoreTextFontFace final : public FontFace {
+ public:
+  explicit CoreTextFontFace(CTFontRef font) : font_(font) {}
+
+  ~CoreTextFontFace() override {
+    CFRelease(font_);
+  }
+
+  FontMetrics metrics() const override {
+    FontMetrics metrics;
+    metrics.ascent = static_cast<float>(CTFontGetAscent(font_));
+    metrics.descent = static_cast<float>(CTFontGetDescent(font_));
+    metrics.lineHeight = metrics.ascent + metrics.descent + static_cast<float>(CTFontGetLeading(font_));
+    return metrics;
+  }
+
+  bool rasterize(uint32_t codepoint, GlyphBitmap &glyph) override {
+    UniChar units[2];
+    CFIndex unitCount = 1;
+    if (codepoint >= 0x10000u) {
+      units[0] = static_cast<UniChar>(0xd800u + ((codepoint - 0x10000u) >> 10u));
+      units[1] = static_cast<UniChar>(0xdc00u + ((codepoint - 0x10000u) & 0x3ffu));
+      unitCount = 2;
+    } else {
+      units[0] = static_cast<UniChar>(codepoint);
+    }
+    CGGlyph glyphs[2] = {0, 0};
+    if (!CTFontGetGlyphsForCharacters(font_, units, glyphs, unitCount) || glyphs[0] == 0) {
+      return false;
+    }
+
+    CGSize advance = CGSizeZero;
+    CTFontGetAdvancesForGlyphs(font_, kCTFontOrientationHorizontal, glyphs, &advance, 1);
+    const CGRect bounds = CTFontGetBoundingRectsForGlyphs(font_, kCTFontOrientationHorizontal, glyphs, nullptr, 1);
+    glyph.advance = static_cast<float>(advance.width);
+    glyph.coverage.clear();
+    glyph.width = 0u;
+    glyph.height = 0u;
+    if (CGRectIsEmpty(bounds)) {
+      return true;
+    }
+
+    // One pixel of padding for antialiasing that spills past the outline.
+    const int left = static_cast<int>(std::floor(bounds.origin.x)) - 1;
+    const int bottom = static_cast<int>(std::floor(bounds.origin.y)) - 1;
+    const int right = static_cast<int>(std::ceil(bounds.origin.x + bounds.size.width)) + 1;
+    const int top = static_cast<int>(std::ceil(bounds.origin.y + bounds.size.height)) + 1;
+    glyph.left = left;
+    glyph.top = top;
+    glyph.width = static_cast<uint32_t>(right - left);
+    glyph.height = static_cast<uint32_t>(top - bottom);
+    glyph.coverage.assign(static_cast<size_t>(glyph.width) * glyph.height, 0u);
+
+    // Bitmap memory is top-down while CoreGraphics draws bottom-up, so the
+    // first row of `coverage` is the glyph's top edge as required.
+    CGColorSpaceRef gray = CGColorSpaceCreateDeviceGray();
+    CGContextRef context = CGBitmapContextCreate(glyph.coverage.data(), glyph.width, glyph.height, 8,
+                                                 glyph.width, gray, kCGImageAlphaNone);
+    CGColorSpaceRelease(gray);
+    if (context == nullptr) {
+      return false;
+    }
+    CGContextSetGrayFillColor(context, 1.0, 1.0);
+    CGContextSetShouldAntialias(context, true);
+    CGContextSetShouldSmoothFonts(context, false);
+    const CGPoint position = CGPointMake(static_cast<CGFloat>(-left), static_cast<CGFloat>(-bottom));
+    CTFontDrawGlyphs(font_, glyphs, &position, 1, context);
+    CGContextRelease(context);
+    return true;
+  }
+
+ private:
+  CTFontRef font_;
+};
+
+}  // namespace
+
+std::unique_ptr<FontFace> openFontFace(const std::string &family, bool bold, uint32_t pixelSize) {
+  if (pixelSize == 0u) {
+    return nullptr;
+  }
+  CTFontRef font = nullptr;
+  if (family.empty()) {
+    font = CTFontCreateUIFontForLanguage(kCTFontUIFontSystem, static_cast<CGFloat>(pixelSize), nullptr);
+  } else {
+    CFStringRef name = CFStringCreateWithCString(kCFAllocatorDefault, family.c_str(), kCFStringEncodingUTF8);
+    if (name == nullptr) {
+      return nullptr;
+    }
+    font = CTFontCreateWithName(name, static_cast<CGFloat>(pixelSize), nullptr);
+    CFRelease(name);
+  }
+  if (font == nullptr) {
+    return nullptr;
+  }
+  if (bold) {
+    CTFontRef boldFont = CTFontCreateCopyWithSymbolicTraits(font, 0.0, nullptr, kCTFontBoldTrait, kCTFontBoldTrait);
+    if (boldFont != nullptr) {
+      CFRelease(font);
+      font = boldFont;
+    }
+  }
+  return std::make_unique<CoreTextFontFace>(font);
+}
+
+bool fontRenderingAvailable() {
+  return true;
+}
+
+}  // namespace broadify::meeting
+
+#endif
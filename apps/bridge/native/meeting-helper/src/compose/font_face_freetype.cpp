@@ -0,0 +1,181 @@
+#include "compose/font_face.h"
+
+#if BROADIFY_ENABLE_FREETYPE
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#if BROADIFY_ENABLE_FONTCONFIG
+#include <fontconfig/fontconfig.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace broadify::meeting {
+namespace {
+
+// FT_Library is shared; creating and destroying faces must not race.
+std::mutex &freetypeMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+FT_Library freetypeLibrary() {
+  static FT_Library library = []() -> FT_Library {
+    FT_Library created = nullptr;
+    return FT_Init_FreeType(&created) == 0 ? created : nullptr;
+  }();
+  return library;
+}
+
+bool fileExists(const std::string &path) {
+  return std::ifstream(path, std::ios::binary).good();
+}
+
+// Family name (or file path) to a font file and face index: fontconfig when
+// the build has it, otherwise the usual DejaVu install locations.
+std::string resolveFontPath(const std::string &family, bool bold, int &faceIndex) {
+  faceIndex = 0;
+  if (family.find('/') != std::string::npos) {
+    return family;
+  }
+
+#if BROADIFY_ENABLE_FONTCONFIG
+  std::string matched;
+  if (FcInit()) {
+    FcPattern *pattern = FcNameParse(reinterpret_cast<const FcChar8 *>(family.empty() ? "sans-serif" : family.c_str()));
+    if (pattern != nullptr) {
+      FcPatternAddInteger(pattern, FC_WEIGHT, bold ? FC_WEIGHT_BOLD : FC_WEIGHT_REGULAR);
+      FcConfigSubstitute(nullptr, pattern, FcMatchPattern);
+      FcDefaultSubstitute(pattern);
+      FcResult result = FcResultNoMatch;
+      FcPattern *match = FcFontMatch(nullptr, pattern, &result);
+      FcChar8 *file = nullptr;
+      if (match != nullptr && FcPatternGetString(match, FC_FILE, 0, &file) == FcResultMatch) {
+        matched = reinterpret_cast<const char *>(file);
+        FcPatternGetInteger(match, FC_INDEX, 0, &faceIndex);
+      }
+      if (match != nullptr) {
+        FcPatternDestroy(match);
+      }
+      FcPatternDestroy(pattern);
+    }
+  }
+  if (!matched.empty()) {
+    return matched;
+  }
+#endif
+
+  static const char *const kFontDirs[] = {
+      "/usr/share/fonts/truetype/dejavu/",
+      "/usr/share/fonts/TTF/",
+      "/usr/share/fonts/dejavu/",
+      "/usr/local/share/fonts/",
+  };
+  const std::string fileName = family.empty() ? (bold ? "DejaVuSans-Bold" : "DejaVuSans") : family;
+  for (const char *dir : kFontDirs) {
+    for (const char *extension : {".ttf", ".otf"}) {
+      const std::string path = std::string(dir) + fileName + extension;
+      if (fileExists(path)) {
+        return path;
+      }
+    }
+  }
+  return "";
+}
+
+class FreeTypeFontFace final : public FontFace {
+ public:
+  explicit FreeTypeFontFace(FT_Face face) : face_(face) {}
+
+  ~FreeTypeFontFace() override {
+    std::lock_guard<std::mutex> lock(freetypeMutex());
+    FT_Done_Face(face_);
+  }
+
+  FontMetrics metrics() const override {
+    const FT_Size_Metrics &size = face_->size->metrics;
+    FontMetrics metrics;
+    metrics.ascent = static_cast<float>(size.ascender) / 64.0f;
+    metrics.descent = static_cast<float>(-size.descender) / 64.0f;
+    metrics.lineHeight = static_cast<float>(size.height) / 64.0f;
+    return metrics;
+  }
+
+  bool rasterize(uint32_t codepoint, GlyphBitmap &glyph) override {
+    const FT_UInt index = FT_Get_Char_Index(face_, codepoint);
+    if (index == 0u || FT_Load_Glyph(face_, index, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT) != 0) {
+      return false;
+    }
+    const FT_GlyphSlot slot = face_->glyph;
+    const FT_Bitmap &bitmap = slot->bitmap;
+    if (bitmap.rows > 0u && bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+      return false;
+    }
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.width = bitmap.width;
+    glyph.height = bitmap.rows;
+    glyph.advance = static_cast<float>(slot->advance.x) / 64.0f;
+    glyph.coverage.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+    for (uint32_t y = 0; y < bitmap.rows; ++y) {
+      const int row = bitmap.pitch >= 0 ? static_cast<int>(y) : static_cast<int>(bitmap.rows - 1u - y);
+      std::memcpy(glyph.coverage.data() + static_cast<size_t>(y) * bitmap.width,
+                  bitmap.buffer + static_cast<ptrdiff_t>(row) * std::abs(bitmap.pitch), bitmap.width);
+    }
+    return true;
+  }
+
+ private:
+  FT_Face face_;
+};
+
+}  // namespace
+
+std::unique_ptr<FontFace> openFontFace(const std::string &family, bool bold, uint32_t pixelSize) {
+  if (pixelSize == 0u) {
+    return nullptr;
+  }
+  int faceIndex = 0;
+  const std::string path = resolveFontPath(family, bold, faceIndex);
+  if (path.empty()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(freetypeMutex());
+  FT_Library library = freetypeLibrary();
+  FT_Face face = nullptr;
+  if (library == nullptr || FT_New_Face(library, path.c_str(), faceIndex, &face) != 0) {
+    return nullptr;
+  }
+  if (FT_Set_Pixel_Sizes(face, 0, pixelSize) != 0) {
+    FT_Done_Face(face);
+    return nullptr;
+  }
+  return std::make_unique<FreeTypeFontFace>(face);
+}
+
+bool fontRenderingAvailable() {
+  return freetypeLibrary() != nullptr;
+}
+
+}  // namespace broadify::meeting
+
+#else
+
+namespace broadify::meeting {
+
+std::unique_ptr<FontFace> openFontFace(const std::string &, bool, uint32_t) {
+  return nullptr;
+}
+
+bool fontRenderingAvailable() {
+  return false;
+}
+
+}  // namespace broadify::meeting
+
+#endif
@@ -0,0 +1,129 @@
+#include "compose/font_face.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+#include <algorithm>
+
+namespace broadify::meeting {
+namespace {
+
+std::wstring widen(const std::string &value) {
+  if (value.empty()) {
+    return {};
+  }
+  const int length = MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(std::max(length, 0)), L'\0');
+  if (length > 0) {
+    MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), wide.data(), length);
+  }
+  return wide;
+}
+
+// Each face keeps its own memory DC with the font selected, so glyphs are
+// rasterized without touching any window or shared DC.
+class GdiFontFace final : public FontFace {
+ public:
+  GdiFontFace(HDC dc, HFONT font) : dc_(dc), font_(font) {
+    previous_ = SelectObject(dc_, font_);
+    GetTextMetricsW(dc_, &textMetrics_);
+  }
+
+  ~GdiFontFace() override {
+    SelectObject(dc_, previous_);
+    DeleteObject(font_);
+    DeleteDC(dc_);
+  }
+
+  FontMetrics metrics() const override {
+    FontMetrics metrics;
+    metrics.ascent = static_cast<float>(textMetrics_.tmAscent);
+    metrics.descent = static_cast<float>(textMetrics_.tmDescent);
+    metrics.lineHeight = static_cast<float>(textMetrics_.tmHeight + textMetrics_.tmExternalLeading);
+    return metrics;
+  }
+
+  bool rasterize(uint32_t codepoint, GlyphBitmap &glyph) override {
+    // GDI glyph lookup is UTF-16 code unit based; astral characters need
+    // Uniscribe and are reported missing.
+    if (codepoint >= 0x10000u) {
+      return false;
+    }
+    const wchar_t character = static_cast<wchar_t>(codepoint);
+    WORD index = 0xffffu;
+    if (GetGlyphIndicesW(dc_, &character, 1, &index, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR || index == 0xffffu) {
+      return false;
+    }
+
+    const MAT2 identity = {{0, 1}, {0, 0}, {0, 0}, {0, 1}};
+    GLYPHMETRICS glyphMetrics{};
+    const UINT format = GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX;
+    const DWORD size = GetGlyphOutlineW(dc_, index, format, &glyphMetrics, 0, nullptr, &identity);
+    if (size == GDI_ERROR) {
+      return false;
+    }
+    glyph.advance = static_cast<float>(glyphMetrics.gmCellIncX);
+    glyph.coverage.clear();
+    glyph.width = 0u;
+    glyph.height = 0u;
+    if (size == 0u) {
+      return true;
+    }
+
+    std::vector<uint8_t> levels(size);
+    if (GetGlyphOutlineW(dc_, index, format, &glyphMetrics, size, levels.data(), &identity) == GDI_ERROR) {
+      return false;
+    }
+    glyph.left = glyphMetrics.gmptGlyphOrigin.x;
+    glyph.top = glyphMetrics.gmptGlyphOrigin.y;
+    glyph.width = glyphMetrics.gmBlackBoxX;
+    glyph.height = glyphMetrics.gmBlackBoxY;
+    glyph.coverage.resize(static_cast<size_t>(glyph.width) * glyph.height);
+    // GGO_GRAY8 rows are DWORD aligned and hold 65 levels (0..64).
+    const size_t pitch = (static_cast<size_t>(glyph.width) + 3u) & ~static_cast<size_t>(3u);
+    for (uint32_t y = 0; y < glyph.height; ++y) {
+      for (uint32_t x = 0; x < glyph.width; ++x) {
+        const uint32_t level = std::min<uint32_t>(levels[y * pitch + x], 64u);
+        glyph.coverage[static_cast<size_t>(y) * glyph.width + x] = static_cast<uint8_t>((level * 255u + 32u) / 64u);
+      }
+    }
+    return true;
+  }
+
+ private:
+  HDC dc_;
+  HFONT font_;
+  HGDIOBJ previous_ = nullptr;
+  TEXTMETRICW textMetrics_{};
+};
+
+}  // namespace
+
+std::unique_ptr<FontFace> openFontFace(const std::string &family, bool bold, uint32_t pixelSize) {
+  if (pixelSize == 0u) {
+    return nullptr;
+  }
+  const std::wstring face = family.empty() ? std::wstring(L"Segoe UI") : widen(family);
+  // A negative height asks for the em size rather than the cell height.
+  HFONT font = CreateFontW(-static_cast<int>(pixelSize), 0, 0, 0, bold ? FW_BOLD : FW_NORMAL, FALSE, FALSE, FALSE,
+                           DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY,
+                           DEFAULT_PITCH | FF_SWISS, face.c_str());
+  if (font == nullptr) {
+    return nullptr;
+  }
+  HDC dc = CreateCompatibleDC(nullptr);
+  if (dc == nullptr) {
+    DeleteObject(font);
+    return nullptr;
+  }
+  return std::make_unique<GdiFontFace>(dc, font);
+}
+
+bool fontRenderingAvailable() {
+  return true;
+}
+
+}  // namespace broadify::meeting
+
+#endif
@@ -0,0 +1,242 @@
+#include "compose/glyph_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace broadify::meeting {
+namespace {
+
+uint64_t glyphKey(int faceId, uint32_t codepoint) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(faceId)) << 32u) | codepoint;
+}
+
+// Next code point of `text` at `pos` (advanced past it); malformed
+// sequences decode to U+FFFD one byte at a time.
+uint32_t nextCodepoint(const std::string &text, size_t &pos) {
+  const auto byteAt = [&text](size_t index) { return static_cast<uint8_t>(text[index]); };
+  const uint8_t lead = byteAt(pos);
+  size_t length = 1u;
+  uint32_t codepoint = lead;
+  if (lead >= 0xf0u && lead < 0xf8u) {
+    length = 4u;
+    codepoint = lead & 0x07u;
+  } else if (lead >= 0xe0u) {
+    length = lead < 0xf0u ? 3u : 0u;
+    codepoint = lead & 0x0fu;
+  } else if (lead >= 0xc2u) {
+    length = 2u;
+    codepoint = lead & 0x1fu;
+  } else if (lead >= 0x80u) {
+    length = 0u;
+  }
+  if (length == 0u || pos + length > text.size()) {
+    ++pos;
+    return 0xfffdu;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    const uint8_t continuation = byteAt(pos + i);
+    if ((continuation & 0xc0u) != 0x80u) {
+      ++pos;
+      return 0xfffdu;
+    }
+    codepoint = (codepoint << 6u) | (continuation & 0x3fu);
+  }
+  pos += length;
+  return codepoint;
+}
+
+}  // namespace
+
+GlyphAtlas::GlyphAtlas(size_t maxPages) : maxPages_(std::max<size_t>(maxPages, 1u)) {}
+
+int GlyphAtlas::face(const std::string &family, bool bold, uint32_t pixelSize) {
+  for (size_t i = 0; i < faces_.size(); ++i) {
+    const Face &face = faces_[i];
+    if (face.pixelSize == pixelSize && face.bold == bold && face.family == family) {
+      return face.font ? static_cast<int>(i) : -1;
+    }
+  }
+  // Failed opens are remembered too, so a missing font is not searched for
+  // on every update.
+  Face face;
+  face.family = family;
+  face.bold = bold;
+  face.pixelSize = pixelSize;
+  face.font = openFontFace(family, bold, pixelSize);
+  if (face.font) {
+    face.metrics = face.font->metrics();
+  }
+  const bool opened = face.font != nullptr;
+  faces_.push_back(std::move(face));
+  return opened ? static_cast<int>(faces_.size() - 1u) : -1;
+}
+
+FontMetrics GlyphAtlas::metrics(int faceId) const {
+  if (faceId < 0 || static_cast<size_t>(faceId) >= faces_.size()) {
+    return {};
+  }
+  return faces_[static_cast<size_t>(faceId)].metrics;
+}
+
+const AtlasGlyph *GlyphAtlas::glyph(int faceId, uint32_t codepoint) {
+  if (faceId < 0 || static_cast<size_t>(faceId) >= faces_.size() || !faces_[static_cast<size_t>(faceId)].font) {
+    return nullptr;
+  }
+  const uint64_t key = glyphKey(faceId, codepoint);
+  const auto found = glyphs_.find(key);
+  if (found != glyphs_.end()) {
+    return &found->second;
+  }
+  if (missing_.count(key) != 0u) {
+    return nullptr;
+  }
+
+  GlyphBitmap bitmap;
+  ++rasterizedGlyphs_;
+  if (!faces_[static_cast<size_t>(faceId)].font->rasterize(codepoint, bitmap)) {
+    missing_.insert(key);
+    return nullptr;
+  }
+  AtlasGlyph glyph;
+  glyph.width = bitmap.width;
+  glyph.height = bitmap.height;
+  glyph.left = bitmap.left;
+  glyph.top = bitmap.top;
+  glyph.advance = bitmap.advance;
+  if (glyph.width > 0u && glyph.height > 0u) {
+    if (!allocate(glyph.width, glyph.height, glyph.page, glyph.x, glyph.y)) {
+      missing_.insert(key);
+      return nullptr;
+    }
+    uint8_t *pixels = pages_[glyph.page].get();
+    for (uint32_t row = 0; row < glyph.height; ++row) {
+      std::memcpy(pixels + static_cast<size_t>(glyph.y + row) * kPageSize + glyph.x,
+                  bitmap.coverage.data() + static_cast<size_t>(row) * glyph.width, glyph.width);
+    }
+  }
+  return &glyphs_.emplace(key, glyph).first->second;
+}
+
+bool GlyphAtlas::allocate(uint32_t width, uint32_t height, uint32_t &page, uint32_t &x, uint32_t &y) {
+  if (width > kPageSize || height > kPageSize) {
+    return false;
+  }
+  if (!pages_.empty() && shelfX_ + width > kPageSize) {
+    shelfY_ += shelfHeight_;
+    shelfX_ = 0u;
+    shelfHeight_ = 0u;
+  }
+  if (pages_.empty() || shelfY_ + height > kPageSize) {
+    // Pages start out clear so partially used rows never leak stale coverage.
+    pages_.emplace_back(new uint8_t[static_cast<size_t>(kPageSize) * kPageSize]());
+    shelfX_ = 0u;
+    shelfY_ = 0u;
+    shelfHeight_ = 0u;
+  }
+  page = static_cast<uint32_t>(pages_.size() - 1u);
+  x = shelfX_;
+  y = shelfY_;
+  shelfX_ += width;
+  shelfHeight_ = std::max(shelfHeight_, height);
+  return true;
+}
+
+TextLayout GlyphAtlas::layoutLine(int faceId, const std::string &utf8, int originX, int baselineY, int maxWidth) {
+  TextLayout layout;
+  struct Entry {
+    uint32_t codepoint;
+    const AtlasGlyph *glyph;
+    float pen;
+  };
+  const auto resolve = [this, faceId](uint32_t codepoint, uint32_t &resolved) -> const AtlasGlyph * {
+    for (const uint32_t candidate : {codepoint, 0xfffdu, static_cast<uint32_t>('?')}) {
+      if (const AtlasGlyph *found = glyph(faceId, candidate)) {
+        resolved = candidate;
+        return found;
+      }
+    }
+    return nullptr;
+  };
+
+  std::vector<Entry> entries;
+  float pen = 0.0f;
+  for (size_t pos = 0; pos < utf8.size();) {
+    const uint32_t codepoint = nextCodepoint(utf8, pos);
+    if (codepoint < 0x20u) {
+      continue;
+    }
+    uint32_t resolved = 0;
+    if (const AtlasGlyph *found = resolve(codepoint, resolved)) {
+      entries.push_back({resolved, found, pen});
+      pen += found->advance;
+    }
+  }
+
+  if (maxWidth > 0 && pen > static_cast<float>(maxWidth)) {
+    // Keep the longest prefix that still fits with the ellipsis after it.
+    std::vector<Entry> ellipsis;
+    float ellipsisWidth = 0.0f;
+    if (const AtlasGlyph *single = glyph(faceId, 0x2026u)) {
+      ellipsis.push_back({0x2026u, single, 0.0f});
+      ellipsisWidth = single->advance;
+    } else if (const AtlasGlyph *dot = glyph(faceId, '.')) {
+      for (int i = 0; i < 3; ++i) {
+        ellipsis.push_back({'.', dot, ellipsisWidth});
+        ellipsisWidth += dot->advance;
+      }
+    }
+    size_t kept = entries.size();
+    while (kept > 0u && entries[kept - 1u].pen + ellipsisWidth > static_cast<float>(maxWidth)) {
+      --kept;
+    }
+    while (kept > 0u && entries[kept - 1u].codepoint == ' ') {
+      --kept;
+    }
+    pen = kept < entries.size() ? entries[kept].pen : pen;
+    entries.resize(kept);
+    for (Entry &entry : ellipsis) {
+      entry.pen += pen;
+      entries.push_back(entry);
+    }
+    pen += ellipsisWidth;
+  }
+
+  layout.advance = pen;
+  bool empty = true;
+  for (const Entry &entry : entries) {
+    const AtlasGlyph &found = *entry.glyph;
+    PositionedGlyph positioned;
+    positioned.faceId = faceId;
+    positioned.codepoint = entry.codepoint;
+    positioned.x = originX + static_cast<int>(std::lround(entry.pen)) + found.left;
+    positioned.y = baselineY - found.top;
+    if (found.width == 0u || found.height == 0u) {
+      continue;
+    }
+    const int right = positioned.x + static_cast<int>(found.width);
+    const int bottom = positioned.y + static_cast<int>(found.height);
+    layout.minX = empty ? positioned.x : std::min(layout.minX, positioned.x);
+    layout.minY = empty ? positioned.y : std::min(layout.minY, positioned.y);
+    layout.maxX = empty ? right : std::max(layout.maxX, right);
+    layout.maxY = empty ? bottom : std::max(layout.maxY, bottom);
+    empty = false;
+    layout.glyphs.push_back(positioned);
+  }
+  return layout;
+}
+
+bool GlyphAtlas::trim() {
+  if (pages_.size() <= maxPages_) {
+    return false;
+  }
+  glyphs_.clear();
+  missing_.clear();
+  pages_.clear();
+  shelfX_ = 0u;
+  shelfY_ = 0u;
+  shelfHeight_ = 0u;
+  return true;
+}
+
+}  // namespace broadify::meeting
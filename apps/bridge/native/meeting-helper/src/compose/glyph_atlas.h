@@ -0,0 +1,105 @@
+#pragma once
+
+#include "compose/font_face.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Where one rasterized glyph lives in the atlas, plus its placement relative
+// to the pen position on the baseline (see GlyphBitmap).
+struct AtlasGlyph {
+  uint32_t page = 0;
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int32_t left = 0;
+  int32_t top = 0;
+  float advance = 0.0f;
+};
+
+// One glyph of a laid-out line: the bitmap's top-left corner in target
+// pixels. Glyphs are resolved again at draw time, so layouts survive trim().
+struct PositionedGlyph {
+  int faceId = -1;
+  uint32_t codepoint = 0;
+  int x = 0;
+  int y = 0;
+};
+
+struct TextLayout {
+  std::vector<PositionedGlyph> glyphs;
+  // Ink bounds of all glyphs, in target pixels; empty when nothing is drawn.
+  int minX = 0;
+  int minY = 0;
+  int maxX = 0;
+  int maxY = 0;
+  float advance = 0.0f;
+};
+
+// Cache of rasterized glyphs packed into 8-bit coverage pages. A glyph is
+// rasterized the first time a (face, codepoint) pair is asked for and then
+// only copied from the atlas, so re-rendering changed text costs just the
+// glyphs that were never drawn before. Faces are opened once per
+// (family, weight, pixel size) and kept for the atlas lifetime. Not
+// thread-safe.
+class GlyphAtlas {
+ public:
+  static constexpr uint32_t kPageSize = 1024u;
+
+  explicit GlyphAtlas(size_t maxPages = 4u);
+
+  // Face handle for glyph()/metrics(), or -1 when the font cannot be opened.
+  int face(const std::string &family, bool bold, uint32_t pixelSize);
+  FontMetrics metrics(int faceId) const;
+
+  // Null when the face has no such glyph. The pointer stays valid until
+  // trim() drops the pages.
+  const AtlasGlyph *glyph(int faceId, uint32_t codepoint);
+  const uint8_t *page(uint32_t index) const { return pages_[index].get(); }
+
+  // Lays out one line of UTF-8 text with its pen starting at
+  // (originX, baselineY). Missing glyphs fall back to U+FFFD or '?'. A
+  // positive maxWidth truncates the line with an ellipsis.
+  TextLayout layoutLine(int faceId, const std::string &utf8, int originX, int baselineY, int maxWidth = 0);
+
+  // Drops every cached glyph once the atlas has grown past its page budget.
+  // Call between draws only. Returns true when it did.
+  bool trim();
+
+  size_t glyphCount() const { return glyphs_.size(); }
+  size_t pageCount() const { return pages_.size(); }
+  uint64_t rasterizedGlyphs() const { return rasterizedGlyphs_; }
+
+ private:
+  struct Face {
+    std::string family;
+    bool bold = false;
+    uint32_t pixelSize = 0;
+    std::unique_ptr<FontFace> font;
+    FontMetrics metrics;
+  };
+
+  bool allocate(uint32_t width, uint32_t height, uint32_t &page, uint32_t &x, uint32_t &y);
+
+  size_t maxPages_;
+  std::vector<Face> faces_;
+  std::unordered_map<uint64_t, AtlasGlyph> glyphs_;
+  // Codepoints a face has no glyph for, so misses are not re-rasterized.
+  std::unordered_set<uint64_t> missing_;
+  std::vector<std::unique_ptr<uint8_t[]>> pages_;
+  // Shelf packer state of the last page.
+  uint32_t shelfX_ = 0;
+  uint32_t shelfY_ = 0;
+  uint32_t shelfHeight_ = 0;
+  uint64_t rasterizedGlyphs_ = 0;
+};
+
+}  // namespace broadify::meeting
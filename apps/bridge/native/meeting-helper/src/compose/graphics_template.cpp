@@ -0,0 +1,575 @@
+#include "compose/graphics_template.h"
+
+#include "compose/image_decode.h"
+#include "util/image_resample.h"
+#include "util/json_utils.h"
+#include "util/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+namespace broadify::meeting {
+namespace {
+
+struct Color {
+  uint8_t r = 255;
+  uint8_t g = 255;
+  uint8_t b = 255;
+  uint8_t a = 255;
+};
+
+// "#RGB", "#RRGGBB" or "#RRGGBBAA"; anything else keeps `fallback`.
+Color parseColor(const std::string &raw, Color fallback) {
+  const std::string value = parseStringValue(raw);
+  if (value.empty() || value[0] != '#') {
+    return fallback;
+  }
+  const auto nibble = [](char ch) -> int {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+  };
+  std::string digits = value.substr(1);
+  if (digits.size() == 3u) {
+    digits = {digits[0], digits[0], digits[1], digits[1], digits[2], digits[2]};
+  }
+  if (digits.size() != 6u && digits.size() != 8u) {
+    return fallback;
+  }
+  uint8_t channels[4] = {0, 0, 0, 255};
+  for (size_t i = 0; i < digits.size() / 2u; ++i) {
+    const int high = nibble(digits[i * 2u]);
+    const int low = nibble(digits[i * 2u + 1u]);
+    if (high < 0 || low < 0) {
+      return fallback;
+    }
+    channels[i] = static_cast<uint8_t>(high * 16 + low);
+  }
+  return {channels[0], channels[1], channels[2], channels[3]};
+}
+
+void setColor(GraphicsElement &element, Color color) {
+  element.r = color.r;
+  element.g = color.g;
+  element.b = color.b;
+  element.a = color.a;
+}
+
+GraphicsElement makeRect(double x, double y, double width, double height, Color color, double radius = 0.0) {
+  GraphicsElement element;
+  element.type = GraphicsElementType::kRect;
+  element.x = x;
+  element.y = y;
+  element.width = width;
+  element.height = height;
+  element.radius = radius;
+  setColor(element, color);
+  return element;
+}
+
+GraphicsElement makeText(std::string text, double x, double y, double size, Color color, const std::string &font,
+                         bool bold, TextAlign align, double maxWidth) {
+  GraphicsElement element;
+  element.type = GraphicsElementType::kText;
+  element.x = x;
+  element.y = y;
+  element.text = std::move(text);
+  element.textSize = static_cast<uint32_t>(std::clamp(std::lround(size), 4l, 512l));
+  element.font = font;
+  element.bold = bold;
+  element.align = align;
+  element.maxWidth = std::max(0, static_cast<int>(std::lround(maxWidth)));
+  setColor(element, color);
+  return element;
+}
+
+template <typename Raw>
+double number(const Raw &raw, const char *key, double fallback) {
+  return parseDoubleValue(raw(key), fallback);
+}
+
+template <typename Raw>
+std::string text(const Raw &raw, const char *key) {
+  return unescapeJsonString(parseStringValue(raw(key)));
+}
+
+template <typename Raw>
+void appendLowerThird(const Raw &raw, double width, double height, std::vector<GraphicsElement> &elements) {
+  const double x = width * std::clamp(number(raw, "x", 0.08), 0.0, 1.0);
+  const double y = height * std::clamp(number(raw, "y", 0.76), 0.0, 1.0);
+  const double w = width * std::clamp(number(raw, "width", 0.48), 0.05, 1.0);
+  const double h = height * std::clamp(number(raw, "height", 0.10), 0.03, 0.5);
+  const std::string font = text(raw, "font");
+  const std::string title = text(raw, "title");
+  const std::string subtitle = text(raw, "subtitle");
+
+  elements.push_back(makeRect(x, y, w, h, parseColor(raw("background_color"), {255, 255, 255, 225})));
+  elements.push_back(makeRect(x, y, w, std::max(2.0, std::round(h * 0.05)),
+                              parseColor(raw("accent_color"), {255, 132, 28, 255})));
+  const double pad = h * 0.25;
+  const Color titleColor = parseColor(raw("title_color"), {20, 24, 31, 255});
+  if (subtitle.empty()) {
+    elements.push_back(makeText(title, x + pad, y + h * 0.26, h * 0.44, titleColor, font, true, TextAlign::kLeft,
+                                w - 2.0 * pad));
+    return;
+  }
+  elements.push_back(makeText(title, x + pad, y + h * 0.14, h * 0.36, titleColor, font, true, TextAlign::kLeft,
+                              w - 2.0 * pad));
+  elements.push_back(makeText(subtitle, x + pad, y + h * 0.58, h * 0.24,
+                              parseColor(raw("subtitle_color"), {74, 85, 99, 255}), font, false, TextAlign::kLeft,
+                              w - 2.0 * pad));
+}
+
+template <typename Raw>
+void appendBug(const Raw &raw, double width, double height, std::vector<GraphicsElement> &elements) {
+  const double size = std::min(width, height) * std::clamp(number(raw, "size", 0.12), 0.04, 0.35);
+  const double centerX = width * std::clamp(number(raw, "x", 0.9), 0.0, 1.0);
+  const double centerY = height * std::clamp(number(raw, "y", 0.1), 0.0, 1.0);
+  elements.push_back(makeRect(centerX - size / 2.0, centerY - size / 2.0, size, size,
+                              parseColor(raw("background_color"), {16, 24, 32, 204}), size * 0.18));
+  const std::string dataUrl = parseStringValue(raw("image_data_url"));
+  if (!dataUrl.empty()) {
+    GraphicsElement image;
+    image.type = GraphicsElementType::kImage;
+    image.x = centerX - size * 0.38;
+    image.y = centerY - size * 0.38;
+    image.width = size * 0.76;
+    image.height = size * 0.76;
+    image.imageDataUrl = dataUrl;
+    elements.push_back(std::move(image));
+    return;
+  }
+  const double textSize = size * 0.3;
+  elements.push_back(makeText(text(raw, "text"), centerX, centerY - textSize * 0.58, textSize,
+                              parseColor(raw("text_color"), {255, 255, 255, 255}), text(raw, "font"), true,
+                              TextAlign::kCenter, size * 0.86));
+}
+
+void appendCustomElement(const std::string &object, double width, double height,
+                         std::vector<GraphicsElement> &elements) {
+  std::vector<std::pair<std::string, std::string>> members;
+  if (!splitObjectMembers(object, members)) {
+    return;
+  }
+  static const std::string kAbsent;
+  const auto raw = [&members](const std::string &key) -> const std::string & {
+    for (const auto &member : members) {
+      if (member.first == key) {
+        return member.second;
+      }
+    }
+    return kAbsent;
+  };
+  const std::string type = parseStringValue(raw("type"));
+  const double x = width * number(raw, "x", 0.0);
+  const double y = height * number(raw, "y", 0.0);
+  const double w = width * std::max(0.0, number(raw, "width", 0.0));
+  const double h = height * std::max(0.0, number(raw, "height", 0.0));
+  if (type == "rect") {
+    elements.push_back(makeRect(x, y, w, h, parseColor(raw("color"), {255, 255, 255, 255}),
+                                height * std::max(0.0, number(raw, "radius", 0.0))));
+  } else if (type == "text") {
+    const std::string align = parseStringValue(raw("align"));
+    elements.push_back(makeText(text(raw, "text"), x, y, height * number(raw, "size", 0.05),
+                                parseColor(raw("color"), {255, 255, 255, 255}), text(raw, "font"),
+                                parseBoolValue(raw("bold"), false),
+                                align == "center" ? TextAlign::kCenter
+                                                  : (align == "right" ? TextAlign::kRight : TextAlign::kLeft),
+                                width * std::max(0.0, number(raw, "max_width", 0.0))));
+  } else if (type == "image") {
+    GraphicsElement image;
+    image.type = GraphicsElementType::kImage;
+    image.x = x;
+    image.y = y;
+    image.width = w;
+    image.height = h;
+    image.imageDataUrl = parseStringValue(raw("image_data_url"));
+    elements.push_back(std::move(image));
+  }
+}
+
+// x * y / 255 rounded to nearest, exact for 8-bit operands.
+inline uint32_t mul255(uint32_t x, uint32_t y) {
+  const uint32_t t = x * y + 128u;
+  return (t + (t >> 8u)) >> 8u;
+}
+
+// Premultiplied source-over into the layer.
+inline void overPixel(uint8_t *dst, uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+  const uint32_t inverse = 255u - a;
+  dst[0] = static_cast<uint8_t>(r + mul255(dst[0], inverse));
+  dst[1] = static_cast<uint8_t>(g + mul255(dst[1], inverse));
+  dst[2] = static_cast<uint8_t>(b + mul255(dst[2], inverse));
+  dst[3] = static_cast<uint8_t>(a + mul255(dst[3], inverse));
+}
+
+// Premultiplied layer over an opaque frame row: dst = src + dst * (1 - srcA).
+void blendPremultipliedRow(uint8_t *dst, const uint8_t *src, size_t count) {
+  size_t i = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c255 = _mm_set1_epi16(255);
+  const __m128i c128 = _mm_set1_epi16(128);
+  const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000u));
+  const auto scale = [&](__m128i d, __m128i s) {
+    const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(c255, alpha)), c128);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  };
+  for (; i + 4u <= count; i += 4u) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4u));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i * 4u));
+    const __m128i lo = scale(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+    const __m128i hi = scale(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+    const __m128i out = _mm_or_si128(_mm_adds_epu8(s, _mm_packus_epi16(lo, hi)), opaque);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4u), out);
+  }
+#elif defined(BROADIFY_SIMD_NEON)
+  for (; i + 16u <= count; i += 16u) {
+    const uint8x16x4_t s = vld4q_u8(src + i * 4u);
+    uint8x16x4_t d = vld4q_u8(dst + i * 4u);
+    const uint8x16_t inverse = vmvnq_u8(s.val[3]);
+    for (int c = 0; c < 3; ++c) {
+      const uint16x8_t lo = vmull_u8(vget_low_u8(d.val[c]), vget_low_u8(inverse));
+      const uint16x8_t hi = vmull_u8(vget_high_u8(d.val[c]), vget_high_u8(inverse));
+      const uint8x16_t scaled = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+      d.val[c] = vqaddq_u8(s.val[c], scaled);
+    }
+    d.val[3] = vdupq_n_u8(255u);
+    vst4q_u8(dst + i * 4u, d);
+  }
+#endif
+  for (; i < count; ++i) {
+    const uint8_t *s = src + i * 4u;
+    uint8_t *d = dst + i * 4u;
+    const uint32_t inverse = 255u - s[3];
+    d[0] = static_cast<uint8_t>(s[0] + mul255(d[0], inverse));
+    d[1] = static_cast<uint8_t>(s[1] + mul255(d[1], inverse));
+    d[2] = static_cast<uint8_t>(s[2] + mul255(d[2], inverse));
+    d[3] = 255u;
+  }
+}
+
+}  // namespace
+
+bool GraphicsElement::operator==(const GraphicsElement &other) const {
+  return std::tie(type, x, y, width, height, radius, r, g, b, a, text, textSize, font, bold, align, maxWidth,
+                  imageDataUrl) ==
+         std::tie(other.type, other.x, other.y, other.width, other.height, other.radius, other.r, other.g, other.b,
+                  other.a, other.text, other.textSize, other.font, other.bold, other.align, other.maxWidth,
+                  other.imageDataUrl);
+}
+
+std::vector<GraphicsElement> buildGraphicsElements(const GraphicsState &graphics, uint32_t width, uint32_t height) {
+  std::vector<GraphicsElement> elements;
+  const ProgramFields &fields = graphics.fields;
+  const auto raw = [&fields](const std::string &key) -> const std::string & { return fields.raw(key); };
+  const double frameWidth = static_cast<double>(width);
+  const double frameHeight = static_cast<double>(height);
+  if (graphics.templateName == "lower_third") {
+    appendLowerThird(raw, frameWidth, frameHeight, elements);
+  } else if (graphics.templateName == "bug") {
+    appendBug(raw, frameWidth, frameHeight, elements);
+  }
+  std::vector<std::string> custom;
+  if (fields.has("elements") && splitArrayElements(fields.raw("elements"), custom)) {
+    for (const std::string &object : custom) {
+      appendCustomElement(object, frameWidth, frameHeight, elements);
+    }
+  }
+  return elements;
+}
+
+void GraphicsTemplateRenderer::update(const GraphicsState &graphics, uint32_t width, uint32_t height) {
+  if (width != width_ || height != height_) {
+    width_ = width;
+    height_ = height;
+    layer_.assign(static_cast<size_t>(width) * height * 4u, 0u);
+    placed_.clear();
+    spans_.clear();
+    drawn_ = false;
+  }
+  if (drawn_ && graphics.fields.revision() == revision_) {
+    return;
+  }
+
+  atlas_.trim();
+  std::vector<Placed> next;
+  for (const GraphicsElement &element : buildGraphicsElements(graphics, width, height)) {
+    next.push_back(place(element));
+  }
+
+  // Element i is compared with the previously drawn element i: a title edit
+  // damages the old and new title boxes only, everything else stays.
+  std::vector<PixelRect> damage;
+  for (size_t i = 0; i < std::max(placed_.size(), next.size()); ++i) {
+    Placed *before = i < placed_.size() ? &placed_[i] : nullptr;
+    Placed *after = i < next.size() ? &next[i] : nullptr;
+    if (before != nullptr && after != nullptr && before->element == after->element) {
+      after->scaled = std::move(before->scaled);
+      continue;
+    }
+    for (const Placed *changed : {before, after}) {
+      if (changed != nullptr && !changed->bounds.empty()) {
+        damage.push_back(changed->bounds);
+      }
+    }
+  }
+  // Merge overlapping regions so no pixel is repainted twice.
+  for (bool merged = true; merged;) {
+    merged = false;
+    for (size_t i = 0; i < damage.size() && !merged; ++i) {
+      for (size_t j = i + 1u; j < damage.size(); ++j) {
+        const PixelRect &a = damage[i];
+        const PixelRect &b = damage[j];
+        if (a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1) {
+          damage[i] = {std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+          damage.erase(damage.begin() + static_cast<std::ptrdiff_t>(j));
+          merged = true;
+          break;
+        }
+      }
+    }
+  }
+
+  placed_ = std::move(next);
+  uint64_t repainted = 0;
+  for (const PixelRect &region : damage) {
+    repaint(region);
+    repainted += static_cast<uint64_t>(region.x1 - region.x0) * static_cast<uint64_t>(region.y1 - region.y0);
+  }
+  for (auto it = images_.begin(); it != images_.end();) {
+    const bool used = std::any_of(placed_.begin(), placed_.end(), [&it](const Placed &placed) {
+      return placed.element.imageDataUrl == it->first;
+    });
+    it = used ? std::next(it) : images_.erase(it);
+  }
+  rebuildSpans();
+
+  revision_ = graphics.fields.revision();
+  drawn_ = true;
+  ++stats_.updates;
+  stats_.repaintedPixels = repainted;
+  stats_.elements = placed_.size();
+}
+
+GraphicsTemplateRenderer::Placed GraphicsTemplateRenderer::place(const GraphicsElement &element) {
+  Placed placed;
+  placed.element = element;
+  const auto clipped = [this](double x0, double y0, double x1, double y1) {
+    PixelRect rect;
+    rect.x0 = std::clamp(static_cast<int>(std::floor(x0)), 0, static_cast<int>(width_));
+    rect.y0 = std::clamp(static_cast<int>(std::floor(y0)), 0, static_cast<int>(height_));
+    rect.x1 = std::clamp(static_cast<int>(std::ceil(x1)), 0, static_cast<int>(width_));
+    rect.y1 = std::clamp(static_cast<int>(std::ceil(y1)), 0, static_cast<int>(height_));
+    return rect;
+  };
+
+  switch (element.type) {
+    case GraphicsElementType::kRect:
+      if (element.a > 0u) {
+        placed.bounds = clipped(element.x, element.y, element.x + element.width, element.y + element.height);
+      }
+      break;
+    case GraphicsElementType::kText: {
+      const int faceId = atlas_.face(element.font, element.bold, element.textSize);
+      if (faceId < 0 || element.text.empty() || element.a == 0u) {
+        break;
+      }
+      const int baseline = static_cast<int>(std::lround(element.y + atlas_.metrics(faceId).ascent));
+      placed.layout = atlas_.layoutLine(faceId, element.text, static_cast<int>(std::lround(element.x)), baseline,
+                                        element.maxWidth);
+      const int shift = element.align == TextAlign::kLeft
+          ? 0
+          : -static_cast<int>(std::lround(placed.layout.advance / (element.align == TextAlign::kCenter ? 2.0f : 1.0f)));
+      for (PositionedGlyph &glyph : placed.layout.glyphs) {
+        glyph.x += shift;
+      }
+      if (!placed.layout.glyphs.empty()) {
+        placed.bounds = clipped(placed.layout.minX + shift, placed.layout.minY, placed.layout.maxX + shift,
+                                placed.layout.maxY);
+      }
+      break;
+    }
+    case GraphicsElementType::kImage: {
+      if (element.imageDataUrl.empty()) {
+        break;
+      }
+      auto found = images_.find(element.imageDataUrl);
+      if (found == images_.end()) {
+        found = images_.emplace(element.imageDataUrl, decodeImageBytes(decodeDataUrlBytes(element.imageDataUrl))).first;
+      }
+      placed.image = found->second;
+      if (!placed.image || placed.image->width == 0u || placed.image->height == 0u) {
+        break;
+      }
+      // Contain-fit, centred in the element box.
+      const double scale = std::min(element.width / placed.image->width, element.height / placed.image->height);
+      const double drawWidth = std::round(placed.image->width * scale);
+      const double drawHeight = std::round(placed.image->height * scale);
+      const double left = std::round(element.x + (element.width - drawWidth) / 2.0);
+      const double top = std::round(element.y + (element.height - drawHeight) / 2.0);
+      placed.imageBox = {static_cast<int>(left), static_cast<int>(top), static_cast<int>(left + drawWidth),
+                         static_cast<int>(top + drawHeight)};
+      placed.bounds = clipped(left, top, left + drawWidth, top + drawHeight);
+      break;
+    }
+  }
+  return placed;
+}
+
+void GraphicsTemplateRenderer::repaint(const PixelRect &clip) {
+  for (int y = clip.y0; y < clip.y1; ++y) {
+    std::memset(layer_.data() + (static_cast<size_t>(y) * width_ + static_cast<size_t>(clip.x0)) * 4u, 0,
+                static_cast<size_t>(clip.x1 - clip.x0) * 4u);
+  }
+  for (Placed &placed : placed_) {
+    const PixelRect &bounds = placed.bounds;
+    const PixelRect region{std::max(bounds.x0, clip.x0), std::max(bounds.y0, clip.y0), std::min(bounds.x1, clip.x1),
+                           std::min(bounds.y1, clip.y1)};
+    if (!region.empty()) {
+      paint(placed, region);
+    }
+  }
+}
+
+void GraphicsTemplateRenderer::paint(Placed &placed, const PixelRect &clip) {
+  const GraphicsElement &element = placed.element;
+  const auto pixel = [this](int x, int y) { return layer_.data() + (static_cast<size_t>(y) * width_ + x) * 4u; };
+
+  if (element.type == GraphicsElementType::kRect) {
+    // Coverage from the rounded box's signed distance at the pixel centre:
+    // integer-aligned square corners give a hard fill.
+    const double halfWidth = element.width / 2.0;
+    const double halfHeight = element.height / 2.0;
+    const double radius = std::clamp(element.radius, 0.0, std::min(halfWidth, halfHeight));
+    const double centerX = element.x + halfWidth;
+    const double centerY = element.y + halfHeight;
+    for (int y = clip.y0; y < clip.y1; ++y) {
+      const double qy = std::abs(y + 0.5 - centerY) - (halfHeight - radius);
+      for (int x = clip.x0; x < clip.x1; ++x) {
+        const double qx = std::abs(x + 0.5 - centerX) - (halfWidth - radius);
+        const double distance = std::hypot(std::max(qx, 0.0), std::max(qy, 0.0)) + std::min(std::max(qx, qy), 0.0) - radius;
+        const double coverage = std::clamp(0.5 - distance, 0.0, 1.0);
+        if (coverage <= 0.0) {
+          continue;
+        }
+        const uint32_t alpha = static_cast<uint32_t>(std::lround(element.a * coverage));
+        overPixel(pixel(x, y), mul255(element.r, alpha), mul255(element.g, alpha), mul255(element.b, alpha), alpha);
+      }
+    }
+    return;
+  }
+
+  if (element.type == GraphicsElementType::kText) {
+    for (const PositionedGlyph &positioned : placed.layout.glyphs) {
+      const AtlasGlyph *glyph = atlas_.glyph(positioned.faceId, positioned.codepoint);
+      if (glyph == nullptr) {
+        continue;
+      }
+      const int x0 = std::max(clip.x0, positioned.x);
+      const int y0 = std::max(clip.y0, positioned.y);
+      const int x1 = std::min(clip.x1, positioned.x + static_cast<int>(glyph->width));
+      const int y1 = std::min(clip.y1, positioned.y + static_cast<int>(glyph->height));
+      const uint8_t *page = atlas_.page(glyph->page);
+      for (int y = y0; y < y1; ++y) {
+        const uint8_t *coverage = page + static_cast<size_t>(glyph->y + (y - positioned.y)) * GlyphAtlas::kPageSize +
+                                  glyph->x + (x0 - positioned.x);
+        for (int x = x0; x < x1; ++x) {
+          const uint32_t value = coverage[x - x0];
+          if (value == 0u) {
+            continue;
+          }
+          const uint32_t alpha = mul255(element.a, value);
+          overPixel(pixel(x, y), mul255(element.r, alpha), mul255(element.g, alpha), mul255(element.b, alpha), alpha);
+        }
+      }
+    }
+    return;
+  }
+
+  if (element.type == GraphicsElementType::kImage && placed.image) {
+    // Decoded images are premultiplied already. Only the on-frame part of
+    // the fitted box is scaled, from the matching source window, so an image
+    // hanging off the frame keeps its scale instead of being squeezed into
+    // the clipped bounds. The result is kept until the element changes.
+    const PixelRect &box = placed.imageBox;
+    const PixelRect &visible = placed.bounds;
+    const uint32_t visibleWidth = static_cast<uint32_t>(visible.x1 - visible.x0);
+    const uint32_t visibleHeight = static_cast<uint32_t>(visible.y1 - visible.y0);
+    if (placed.scaled.empty()) {
+      const RgbaImage &image = *placed.image;
+      const double sourcePerPixelX = static_cast<double>(image.width) / (box.x1 - box.x0);
+      const double sourcePerPixelY = static_cast<double>(image.height) / (box.y1 - box.y0);
+      placed.scaled.resize(static_cast<size_t>(visibleWidth) * visibleHeight * 4u);
+      resampleImage({image.rgba.data(), image.width, image.height, static_cast<size_t>(image.width) * 4u, 4u},
+                    {(visible.x0 - box.x0) * sourcePerPixelX, (visible.y0 - box.y0) * sourcePerPixelY,
+                     visibleWidth * sourcePerPixelX, visibleHeight * sourcePerPixelY},
+                    {placed.scaled.data(), visibleWidth, visibleHeight, static_cast<size_t>(visibleWidth) * 4u, 4u},
+                    ResampleFilter::kBilinear);
+    }
+    for (int y = clip.y0; y < clip.y1; ++y) {
+      const uint8_t *src = placed.scaled.data() +
+                           (static_cast<size_t>(y - visible.y0) * visibleWidth + (clip.x0 - visible.x0)) * 4u;
+      for (int x = clip.x0; x < clip.x1; ++x, src += 4) {
+        if (src[3] != 0u) {
+          overPixel(pixel(x, y), src[0], src[1], src[2], src[3]);
+        }
+      }
+    }
+  }
+}
+
+void GraphicsTemplateRenderer::rebuildSpans() {
+  spans_.clear();
+  if (placed_.empty()) {
+    return;
+  }
+  int top = static_cast<int>(height_);
+  int bottom = 0;
+  for (const Placed &placed : placed_) {
+    if (!placed.bounds.empty()) {
+      top = std::min(top, placed.bounds.y0);
+      bottom = std::max(bottom, placed.bounds.y1);
+    }
+  }
+  std::vector<std::pair<int, int>> intervals;
+  for (int y = top; y < bottom; ++y) {
+    intervals.clear();
+    for (const Placed &placed : placed_) {
+      if (!placed.bounds.empty() && placed.bounds.y0 <= y && y < placed.bounds.y1) {
+        intervals.emplace_back(placed.bounds.x0, placed.bounds.x1);
+      }
+    }
+    std::sort(intervals.begin(), intervals.end());
+    for (const auto &interval : intervals) {
+      if (!spans_.empty() && spans_.back().y == y && interval.first <= spans_.back().x1) {
+        spans_.back().x1 = std::max(spans_.back().x1, interval.second);
+      } else {
+        spans_.push_back({y, interval.first, interval.second});
+      }
+    }
+  }
+}
+
+void GraphicsTemplateRenderer::draw(RgbaFrameRef frame) const {
+  if (frame.size() < layer_.size()) {
+    return;
+  }
+  for (const Span &span : spans_) {
+    const size_t offset = (static_cast<size_t>(span.y) * width_ + static_cast<size_t>(span.x0)) * 4u;
+    blendPremultipliedRow(frame.data() + offset, layer_.data() + offset, static_cast<size_t>(span.x1 - span.x0));
+  }
+}
+
+GraphicsTemplateRenderer::Stats GraphicsTemplateRenderer::stats() const {
+  Stats stats = stats_;
+  stats.rasterizedGlyphs = atlas_.rasterizedGlyphs();
+  return stats;
+}
+
+}  // namespace broadify::meeting
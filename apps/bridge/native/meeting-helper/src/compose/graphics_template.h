@@ -0,0 +1,141 @@
+#pragma once
+
+#include "compose/glyph_atlas.h"
+#include "compose/rgba_frame_ref.h"
+#include "compose/rgba_image.h"
+#include "state/meeting_state.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Native broadcast graphics for the `graphics` program section when its
+// `source` is "native": the Electron offscreen renderer is not involved.
+//
+//   template "lower_third": title, subtitle, x, y, width, height,
+//                           background_color, accent_color, title_color,
+//                           subtitle_color, font
+//   template "bug":         text or image_data_url, x, y (centre), size,
+//                           background_color, text_color, font
+//   elements (any template, drawn on top): array of
+//     {"type":"rect",  x, y, width, height, color, radius}
+//     {"type":"text",  text, x, y, size, color, font, bold, align, max_width}
+//     {"type":"image", image_data_url, x, y, width, height}
+//
+// Positions and sizes are fractions of the frame (text `size` and `radius`
+// of its height); colours are "#RRGGBB" or "#RRGGBBAA". Text `y` is the top
+// of the line and `x` its left edge, centre or right edge by `align`.
+
+enum class GraphicsElementType {
+  kRect,
+  kText,
+  kImage,
+};
+
+enum class TextAlign {
+  kLeft,
+  kCenter,
+  kRight,
+};
+
+// One resolved element in frame pixels.
+struct GraphicsElement {
+  GraphicsElementType type = GraphicsElementType::kRect;
+  double x = 0.0;
+  double y = 0.0;
+  double width = 0.0;
+  double height = 0.0;
+  double radius = 0.0;
+  uint8_t r = 255;
+  uint8_t g = 255;
+  uint8_t b = 255;
+  uint8_t a = 255;
+  std::string text;
+  uint32_t textSize = 0;
+  std::string font;
+  bool bold = false;
+  TextAlign align = TextAlign::kLeft;
+  int maxWidth = 0;
+  std::string imageDataUrl;
+
+  bool operator==(const GraphicsElement &other) const;
+  bool operator!=(const GraphicsElement &other) const { return !(*this == other); }
+};
+
+// Expands the section's template and element list for a width x height
+// frame, in paint order.
+std::vector<GraphicsElement> buildGraphicsElements(const GraphicsState &graphics, uint32_t width, uint32_t height);
+
+// Keeps the native graphics as one cached premultiplied RGBA layer. An update
+// diffs the new element list against the drawn one and repaints only the
+// regions of elements that changed (with whatever else overlaps them); glyphs
+// come from a persistent atlas. Drawing a frame blends just the rows and
+// spans the elements cover. Not thread-safe.
+class GraphicsTemplateRenderer {
+ public:
+  struct Stats {
+    uint64_t updates = 0;
+    // Pixels cleared and repainted by the last update that changed anything.
+    uint64_t repaintedPixels = 0;
+    uint64_t rasterizedGlyphs = 0;
+    size_t elements = 0;
+  };
+
+  // Brings the layer up to date with `graphics`. Cheap when the section
+  // revision and frame size are unchanged.
+  void update(const GraphicsState &graphics, uint32_t width, uint32_t height);
+
+  // Blends the layer over `frame` (same size as the last update).
+  void draw(RgbaFrameRef frame) const;
+
+  Stats stats() const;
+
+ private:
+  struct PixelRect {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+  };
+
+  struct Placed {
+    GraphicsElement element;
+    PixelRect bounds;
+    TextLayout layout;
+    std::shared_ptr<const RgbaImage> image;
+    // Images: the fitted box before clipping, and the visible part of the
+    // image scaled to `bounds`, filled on first paint.
+    PixelRect imageBox;
+    std::vector<uint8_t> scaled;
+  };
+
+  struct Span {
+    int y = 0;
+    int x0 = 0;
+    int x1 = 0;
+  };
+
+  Placed place(const GraphicsElement &element);
+  void repaint(const PixelRect &clip);
+  void paint(Placed &placed, const PixelRect &clip);
+  void rebuildSpans();
+
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  bool drawn_ = false;
+  uint64_t revision_ = 0;
+  std::vector<uint8_t> layer_;
+  std::vector<Placed> placed_;
+  std::vector<Span> spans_;
+  GlyphAtlas atlas_;
+  std::unordered_map<std::string, std::shared_ptr<const RgbaImage>> images_;
+  Stats stats_;
+};
+
+}  // namespace broadify::meeting
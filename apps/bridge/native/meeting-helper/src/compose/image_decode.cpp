@@ -0,0 +1,125 @@
+#include "compose/image_decode.h"
+
+#include <cctype>
+
+#if defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreGraphics/CoreGraphics.h>
+#include <ImageIO/ImageIO.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+std::vector<uint8_t> decodeBase64(const std::string &value) {
+  std::vector<int> table(256, -1);
+  for (int i = 0; i < 26; ++i) {
+    table[static_cast<size_t>('A' + i)] = i;
+    table[static_cast<size_t>('a' + i)] = i + 26;
+  }
+  for (int i = 0; i < 10; ++i) {
+    table[static_cast<size_t>('0' + i)] = i + 52;
+  }
+  table[static_cast<size_t>('+')] = 62;
+  table[static_cast<size_t>('/')] = 63;
+
+  std::vector<uint8_t> decoded;
+  int accumulator = 0;
+  int bits = -8;
+  for (unsigned char ch : value) {
+    if (ch == '=') {
+      break;
+    }
+    if (std::isspace(ch)) {
+      continue;
+    }
+    const int part = table[ch];
+    if (part < 0) {
+      return {};
+    }
+    accumulator = (accumulator << 6) + part;
+    bits += 6;
+    if (bits >= 0) {
+      decoded.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xff));
+      bits -= 8;
+    }
+  }
+  return decoded;
+}
+
+}  // namespace
+
+std::vector<uint8_t> decodeDataUrlBytes(const std::string &dataUrl) {
+  const size_t comma = dataUrl.find(',');
+  if (comma == std::string::npos) {
+    return {};
+  }
+  const std::string metadata = dataUrl.substr(0, comma);
+  if (metadata.find(";base64") == std::string::npos) {
+    return {};
+  }
+  return decodeBase64(dataUrl.substr(comma + 1));
+}
+
+#if defined(__APPLE__)
+std::shared_ptr<const RgbaImage> decodeImageBytes(const std::vector<uint8_t> &bytes) {
+  if (bytes.empty()) {
+    return nullptr;
+  }
+
+  CFDataRef data = CFDataCreate(kCFAllocatorDefault, bytes.data(), static_cast<CFIndex>(bytes.size()));
+  if (!data) {
+    return nullptr;
+  }
+
+  CGImageSourceRef source = CGImageSourceCreateWithData(data, nullptr);
+  CFRelease(data);
+  if (!source) {
+    return nullptr;
+  }
+
+  CGImageRef image = CGImageSourceCreateImageAtIndex(source, 0, nullptr);
+  CFRelease(source);
+  if (!image) {
+    return nullptr;
+  }
+
+  const size_t width = CGImageGetWidth(image);
+  const size_t height = CGImageGetHeight(image);
+  if (width == 0 || height == 0 || width > 4096 || height > 4096) {
+    CGImageRelease(image);
+    return nullptr;
+  }
+
+  auto decoded = std::make_shared<RgbaImage>();
+  decoded->width = static_cast<uint32_t>(width);
+  decoded->height = static_cast<uint32_t>(height);
+  decoded->rgba.assign(width * height * 4u, 0);
+
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(decoded->rgba.data(),
+                                               width,
+                                               height,
+                                               8,
+                                               width * 4u,
+                                               colorSpace,
+                                               kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+  CGColorSpaceRelease(colorSpace);
+  if (!context) {
+    CGImageRelease(image);
+    return nullptr;
+  }
+
+  CGContextClearRect(context, CGRectMake(0, 0, static_cast<CGFloat>(width), static_cast<CGFloat>(height)));
+  CGContextDrawImage(context, CGRectMake(0, 0, static_cast<CGFloat>(width), static_cast<CGFloat>(height)), image);
+  CGContextRelease(context);
+  CGImageRelease(image);
+  return decoded;
+}
+#else
+std::shared_ptr<const RgbaImage> decodeImageBytes(const std::vector<uint8_t> &) {
+  return nullptr;
+}
+#endif
+
+}  // namespace broadify::meeting
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "compose/rgba_image.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Payload of a base64 `data:` URL, or empty when it is not one.
+std::vector<uint8_t> decodeDataUrlBytes(const std::string &dataUrl);
+
+// Decodes PNG/JPEG bytes to premultiplied RGBA8 (ImageIO on macOS). Returns
+// null when the bytes do not decode, the image exceeds 4096 px a side, or
+// the platform has no decoder.
+std::shared_ptr<const RgbaImage> decodeImageBytes(const std::vector<uint8_t> &bytes);
+
+}  // namespace broadify::meeting
@@ -1,8 +1,7 @@
 #pragma once
 
 #include "compose/gpu_compositor_types.h"
-
-#include <vector>
+#include "compose/rgba_frame_ref.h"
 
 namespace broadify::meeting {
 
@@ -11,8 +10,8 @@ namespace broadify::meeting {
 bool metalCompositorAvailable();
 
 // Composites background + back graphics + camera layer + front graphics on
-// the GPU into `output` (RGBA, width*height*4). Returns false on any failure;
+// the GPU into `output`, which must already hold width*height*4 bytes. Returns false on any failure;
 // callers must then render through the CPU compositor instead.
-bool renderProgramFrameMetal(const GpuComposePlan &plan, std::vector<uint8_t> &output);
+bool renderProgramFrameMetal(const GpuComposePlan &plan, RgbaFrameRef output);
 
 }  // namespace broadify::meeting
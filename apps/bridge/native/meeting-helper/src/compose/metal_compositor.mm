@@ -1,6 +1,7 @@
 #include "compose/metal_compositor.h"
 #include "compose/metal_device.h"
 #include "compose/gpu_compositor_uniforms.h"
+#include "util/frame_copy.h"
 
 #import <Foundation/Foundation.h>
 #import <Metal/Metal.h>
@@ -303,7 +304,7 @@ bool metalCompositorAvailable() {
   return initializeContext();
 }
 
-bool renderProgramFrameMetal(const GpuComposePlan &plan, std::vector<uint8_t> &output) {
+bool renderProgramFrameMetal(const GpuComposePlan &plan, RgbaFrameRef output) {
   if (!initializeContext() || plan.width == 0u || plan.height == 0u) {
     return false;
   }
@@ -445,8 +446,11 @@ bool renderProgramFrameMetal(const GpuComposePlan &plan, std::vector<uint8_t> &o
       return false;
     }
 
-    output.resize(byteCount);
-    std::memcpy(output.data(), ctx.outputBuffer.contents, byteCount);
+    if (output.size() != byteCount) {
+      return false;
+    }
+    copyFrameBytes(output.data(), static_cast<const uint8_t *>(ctx.outputBuffer.contents), byteCount,
+                   FrameCopyTarget::Handoff);
     return true;
   }
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Non-owning view of a tightly packed RGBA8 frame (width * height * 4 bytes).
+// The compositor draws through it so the program frame can live in memory the
+// caller owns, such as the FrameBus slot about to be published, instead of a
+// private vector that has to be copied out afterwards. Converts implicitly
+// from a vector so scratch buffers keep working unchanged; the view does not
+// track later reallocations of that vector.
+class RgbaFrameRef {
+ public:
+  RgbaFrameRef() = default;
+  RgbaFrameRef(uint8_t *data, size_t size) : data_(data), size_(size) {}
+  RgbaFrameRef(std::vector<uint8_t> &frame)  // NOLINT(google-explicit-constructor)
+      : data_(frame.data()), size_(frame.size()) {}
+
+  uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return data_ == nullptr || size_ == 0u; }
+  uint8_t &operator[](size_t index) const { return data_[index]; }
+
+ private:
+  uint8_t *data_ = nullptr;
+  size_t size_ = 0u;
+};
+
+}  // namespace broadify::meeting
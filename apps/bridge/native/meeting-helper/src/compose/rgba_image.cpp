@@ -0,0 +1,172 @@
+#include "compose/rgba_image.h"
+
+#include "util/simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Mip chain for image assets. Slides and bugs are decoded at full resolution
+// (a 4K page for a 600 px panel), and bilinear sampling straight from that
+// reads scattered rows and skips most texels, which both thrashes the cache
+// and aliases. Sampling a level near the on-screen size touches a compact
+// working set and every output pixel integrates its whole footprint.
+
+namespace broadify::meeting {
+
+void downsampleRgbaBox(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight,
+                       uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight) {
+  const size_t srcStride = static_cast<size_t>(srcWidth) * 4u;
+  for (uint32_t y = 0; y < dstHeight; ++y) {
+    const uint8_t *row0 = src + static_cast<size_t>(std::min(2u * y, srcHeight - 1u)) * srcStride;
+    const uint8_t *row1 = src + static_cast<size_t>(std::min(2u * y + 1u, srcHeight - 1u)) * srcStride;
+    uint8_t *out = dst + static_cast<size_t>(y) * dstWidth * 4u;
+    uint32_t x = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+    // Two source pixels (8 channels, 16 bit) summed over both rows, folded
+    // into one output pixel in the low 64 bits.
+    const auto foldPair = [](__m128i sum) { return _mm_add_epi16(sum, _mm_srli_si128(sum, 8)); };
+    for (; 2u * x + 8u <= srcWidth; x += 4u) {
+      const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8u));
+      const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8u + 16u));
+      const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 8u));
+      const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 8u + 16u));
+      const __m128i p0 = foldPair(_mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero)));
+      const __m128i p1 = foldPair(_mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero)));
+      const __m128i p2 = foldPair(_mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero)));
+      const __m128i p3 = foldPair(_mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero)));
+      const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(p0, p1), round), 2);
+      const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(p2, p3), round), 2);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x * 4u), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(BROADIFY_SIMD_NEON)
+    for (; 2u * x + 8u <= srcWidth; x += 4u) {
+      const uint8x16_t top0 = vld1q_u8(row0 + x * 8u);
+      const uint8x16_t top1 = vld1q_u8(row0 + x * 8u + 16u);
+      const uint8x16_t bottom0 = vld1q_u8(row1 + x * 8u);
+      const uint8x16_t bottom1 = vld1q_u8(row1 + x * 8u + 16u);
+      const auto foldPair = [](uint16x8_t sum) { return vadd_u16(vget_low_u16(sum), vget_high_u16(sum)); };
+      const uint16x8_t lo = vcombine_u16(foldPair(vaddl_u8(vget_low_u8(top0), vget_low_u8(bottom0))),
+                                         foldPair(vaddl_u8(vget_high_u8(top0), vget_high_u8(bottom0))));
+      const uint16x8_t hi = vcombine_u16(foldPair(vaddl_u8(vget_low_u8(top1), vget_low_u8(bottom1))),
+                                         foldPair(vaddl_u8(vget_high_u8(top1), vget_high_u8(bottom1))));
+      vst1q_u8(out + x * 4u, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+#endif
+    for (; x < dstWidth; ++x) {
+      const size_t left = static_cast<size_t>(std::min(2u * x, srcWidth - 1u)) * 4u;
+      const size_t right = static_cast<size_t>(std::min(2u * x + 1u, srcWidth - 1u)) * 4u;
+      for (size_t channel = 0; channel < 4u; ++channel) {
+        out[x * 4u + channel] = static_cast<uint8_t>(
+            (row0[left + channel] + row0[right + channel] + row1[left + channel] + row1[right + channel] + 2u) >> 2u);
+      }
+    }
+  }
+}
+
+void RgbaImage::buildMips() const {
+  if (width == 0u || height == 0u || rgba.size() < static_cast<size_t>(width) * height * 4u) {
+    return;
+  }
+  uint32_t sourceWidth = width;
+  uint32_t sourceHeight = height;
+  const uint8_t *source = rgba.data();
+  while (sourceWidth > 1u || sourceHeight > 1u) {
+    MipLevel next;
+    next.width = std::max(1u, sourceWidth / 2u);
+    next.height = std::max(1u, sourceHeight / 2u);
+    next.rgba.resize(static_cast<size_t>(next.width) * next.height * 4u);
+    downsampleRgbaBox(source, sourceWidth, sourceHeight, next.rgba.data(), next.width, next.height);
+    mips_.push_back(std::move(next));
+    sourceWidth = mips_.back().width;
+    sourceHeight = mips_.back().height;
+    source = mips_.back().rgba.data();
+  }
+}
+
+uint32_t RgbaImage::levelCount() const {
+  std::call_once(mipsBuilt_, [this]() { buildMips(); });
+  return 1u + static_cast<uint32_t>(mips_.size());
+}
+
+ImageLevel RgbaImage::level(uint32_t index) const {
+  if (index == 0u) {
+    return {width, height, rgba.data()};
+  }
+  const uint32_t clamped = std::min(index, levelCount() - 1u);
+  if (clamped == 0u) {
+    return {width, height, rgba.data()};
+  }
+  const MipLevel &mip = mips_[clamped - 1u];
+  return {mip.width, mip.height, mip.rgba.data()};
+}
+
+double mipLodForFootprint(double texelsPerPixel) {
+  return texelsPerPixel > 1.0 ? std::log2(texelsPerPixel) : 0.0;
+}
+
+void sampleLevelBilinear(const ImageLevel &level, double sourceX, double sourceY, uint8_t sample[4]) {
+  const double floorX = std::floor(sourceX);
+  const double floorY = std::floor(sourceY);
+  const uint32_t x0 = static_cast<uint32_t>(std::clamp(static_cast<int>(floorX), 0, static_cast<int>(level.width) - 1));
+  const uint32_t x1 = std::min(x0 + 1u, level.width - 1u);
+  const double xWeight = std::clamp(sourceX - floorX, 0.0, 1.0);
+  const uint32_t y0 = static_cast<uint32_t>(std::clamp(static_cast<int>(floorY), 0, static_cast<int>(level.height) - 1));
+  const uint32_t y1 = std::min(y0 + 1u, level.height - 1u);
+  const double yWeight = std::clamp(sourceY - floorY, 0.0, 1.0);
+  const uint8_t *topLeft = level.rgba + (static_cast<size_t>(y0) * level.width + x0) * 4u;
+  const uint8_t *topRight = level.rgba + (static_cast<size_t>(y0) * level.width + x1) * 4u;
+  const uint8_t *bottomLeft = level.rgba + (static_cast<size_t>(y1) * level.width + x0) * 4u;
+  const uint8_t *bottomRight = level.rgba + (static_cast<size_t>(y1) * level.width + x1) * 4u;
+  for (size_t channel = 0; channel < 4u; ++channel) {
+    const double top = topLeft[channel] * (1.0 - xWeight) + topRight[channel] * xWeight;
+    const double bottom = bottomLeft[channel] * (1.0 - xWeight) + bottomRight[channel] * xWeight;
+    sample[channel] = static_cast<uint8_t>(std::clamp(
+        static_cast<int>(std::lround(top * (1.0 - yWeight) + bottom * yWeight)), 0, 255));
+  }
+}
+
+namespace {
+
+void sampleAtLevel(const RgbaImage &image, uint32_t index, double sourceX, double sourceY, uint8_t sample[4]) {
+  const ImageLevel level = image.level(index);
+  if (index == 0u) {
+    sampleLevelBilinear(level, sourceX, sourceY, sample);
+    return;
+  }
+  // Texel centres shift with the level: map through the continuous edge
+  // coordinate (centre + 0.5) and back.
+  const double levelX = (sourceX + 0.5) * level.width / image.width - 0.5;
+  const double levelY = (sourceY + 0.5) * level.height / image.height - 0.5;
+  sampleLevelBilinear(level, levelX, levelY, sample);
+}
+
+}  // namespace
+
+void sampleImageMip(const RgbaImage &image, double sourceX, double sourceY,
+                    double lod, MipFilter filter, uint8_t sample[4]) {
+  if (!(lod > 0.0)) {
+    sampleAtLevel(image, 0u, sourceX, sourceY, sample);
+    return;
+  }
+  const uint32_t lastLevel = image.levelCount() - 1u;
+  const double baseLod = std::floor(lod);
+  if (baseLod >= lastLevel) {
+    sampleAtLevel(image, lastLevel, sourceX, sourceY, sample);
+    return;
+  }
+  const uint32_t fineLevel = static_cast<uint32_t>(baseLod);
+  sampleAtLevel(image, fineLevel, sourceX, sourceY, sample);
+  const double blend = lod - baseLod;
+  if (filter == MipFilter::kNearestLevel || blend < 1.0 / 512.0) {
+    return;
+  }
+  uint8_t coarse[4];
+  sampleAtLevel(image, fineLevel + 1u, sourceX, sourceY, coarse);
+  for (size_t channel = 0; channel < 4u; ++channel) {
+    sample[channel] = static_cast<uint8_t>(std::lround(sample[channel] * (1.0 - blend) + coarse[channel] * blend));
+  }
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Read-only view of one level of an RgbaImage.
+struct ImageLevel {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  const uint8_t *rgba = nullptr;
+};
+
+// A decoded image asset (premultiplied RGBA8, tightly packed) with a mip
+// chain built on first use. Level 0 is the image itself; each further level
+// halves both sides (rounding down, at least 1 px) with a 2x2 box filter, down
+// to 1x1. The chain costs a third of the base image and is built once per
+// asset, then shared read-only by every render thread.
+struct RgbaImage {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<uint8_t> rgba;
+
+  uint32_t levelCount() const;
+  // `index` is clamped to the chain.
+  ImageLevel level(uint32_t index) const;
+
+ private:
+  struct MipLevel {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+  };
+
+  void buildMips() const;
+
+  mutable std::once_flag mipsBuilt_;
+  mutable std::vector<MipLevel> mips_;
+};
+
+// How the compositor picks and filters levels when minifying an image.
+enum class MipFilter {
+  // Bilinear from the sharpest level that is minified at most 2x.
+  kNearestLevel,
+  // Bilinear from the two levels around the footprint, blended (trilinear).
+  kTrilinear,
+};
+
+// Level of detail for a footprint of `texelsPerPixel` base-image texels per
+// output pixel: 0 when magnifying, log2 of the footprint otherwise.
+double mipLodForFootprint(double texelsPerPixel);
+
+// Samples `image` at base-level texel coordinates (integer coordinates hit
+// texel centres) with the given level of detail. Writes premultiplied RGBA.
+void sampleImageMip(const RgbaImage &image, double sourceX, double sourceY,
+                    double lod, MipFilter filter, uint8_t sample[4]);
+
+// Bilinear sample of one level at that level's texel coordinates.
+void sampleLevelBilinear(const ImageLevel &level, double sourceX, double sourceY, uint8_t sample[4]);
+
+// 2x2 box downscale (sizes as for the mip chain); SSE2/NEON where available,
+// bit-exact with the scalar path. Exposed for tests.
+void downsampleRgbaBox(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight,
+                       uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight);
+
+}  // namespace broadify::meeting
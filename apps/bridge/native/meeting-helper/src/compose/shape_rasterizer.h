@@ -0,0 +1,45 @@
+#pragma once
+
+#include "compose/rgba_frame_ref.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broadify::meeting {
+
+// One filled (optionally rounded) rectangle of a panel, in unrotated frame
+// pixels. The panel rotation is applied around a shared pivot, so bevels and
+// highlights stay attached to the body they decorate. offsetX/offsetY are
+// added after rotation (screen space), which keeps drop shadows falling the
+// same direction whatever the panel tilt.
+struct RasterShape {
+  double x = 0.0;
+  double y = 0.0;
+  double width = 0.0;
+  double height = 0.0;
+  double cornerRadius = 0.0;
+  double offsetX = 0.0;
+  double offsetY = 0.0;
+  uint8_t r = 255;
+  uint8_t g = 255;
+  uint8_t b = 255;
+  uint8_t a = 255;
+};
+
+// Blends a constant colour over `count` RGBA8 pixels with the compositor's
+// straight-alpha rule ((src * a + dst * (255 - a)) / 255, result opaque).
+// Vectorised with SSE2/NEON where available; bit-exact with the scalar path.
+void blendSpanRgba(uint8_t *pixels, size_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+// Rasterizes `shapes` in paint order into an RGBA8 frame with analytic
+// anti-aliased edges. Every covered row is visited once for the whole batch:
+// per shape the row splits into fully covered interior spans (blended with
+// blendSpanRgba) and a few edge pixels whose coverage comes from the shape's
+// signed distance. Integer-aligned, unrotated rectangles produce exactly the
+// same pixels as a hard fill.
+void rasterizeShapes(RgbaFrameRef frame, uint32_t width, uint32_t height,
+                     const std::vector<RasterShape> &shapes,
+                     double pivotX, double pivotY, double rotationDeg);
+
+}  // namespace broadify::meeting
@@ -0,0 +1,260 @@
+#include "compose/tile_damage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace broadify::meeting {
+namespace {
+
+constexpr uint64_t kHashSeed = 1469598103934665603ull;
+constexpr uint64_t kHashPrime = 1099511628211ull;
+
+// Word-at-a-time FNV-style chain. Every step is a bijection of the running
+// hash, so two equally long inputs that differ in a single place can never
+// collide; that is the common case for a tile that changed.
+uint64_t hashBytes(uint64_t hash, const uint8_t *bytes, size_t size) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kHashPrime;
+    hash ^= hash >> 32u;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kHashPrime;
+  }
+  return hash;
+}
+
+uint64_t mixKey(uint64_t key, uint64_t value) {
+  return (key ^ value) * kHashPrime;
+}
+
+// The column/row of the cover crop drawCamera samples for output offset
+// `offset` into a rect `extent` pixels long.
+uint32_t sampledSource(uint32_t sourceStart, uint32_t sourceExtent, int offset, int extent, uint32_t frameExtent) {
+  return std::min(frameExtent - 1u,
+                  sourceStart + static_cast<uint32_t>((static_cast<uint64_t>(offset) * sourceExtent) /
+                                                      static_cast<uint32_t>(extent)));
+}
+
+// First mask sample drawCamera's bilinear lookup reads for camera pixel `s`.
+uint32_t maskSample(uint32_t s, uint32_t frameExtent, uint32_t maskExtent) {
+  if (frameExtent <= 1u) {
+    return 0u;
+  }
+  return static_cast<uint32_t>(std::floor(static_cast<double>(s) * static_cast<double>(maskExtent - 1u) /
+                                          static_cast<double>(frameExtent - 1u)));
+}
+
+}  // namespace
+
+void TileDamageTracker::update(uint32_t width, uint32_t height, uint64_t sceneKey,
+                               const TileCameraLayer &camera, const VideoFrame *backGraphics,
+                               const VideoFrame *frontGraphics) {
+  if (width != width_ || height != height_) {
+    width_ = width;
+    height_ = height;
+    columns_ = (width + kTileSize - 1u) / kTileSize;
+    rows_ = (height + kTileSize - 1u) / kTileSize;
+    const size_t count = static_cast<size_t>(columns_) * rows_;
+    damaged_.assign(count, 0u);
+    cameraHashes_.assign(count, 0u);
+    maskHashes_.assign(count, 0u);
+    back_ = GraphicsTiles();
+    front_ = GraphicsTiles();
+    valid_ = false;
+  }
+  full_ = !valid_ || sceneKey != sceneKey_;
+  sceneKey_ = sceneKey;
+  valid_ = true;
+  std::fill(damaged_.begin(), damaged_.end(), full_ ? 1u : 0u);
+
+  updateCamera(camera);
+  updateGraphics(back_, backGraphics);
+  updateGraphics(front_, frontGraphics);
+}
+
+void TileDamageTracker::invalidate() {
+  valid_ = false;
+}
+
+size_t TileDamageTracker::damagedTileCount() const {
+  return static_cast<size_t>(std::count(damaged_.begin(), damaged_.end(), 1u));
+}
+
+std::vector<TileRect> TileDamageTracker::runs(bool damaged) const {
+  std::vector<TileRect> result;
+  for (uint32_t row = 0; row < rows_; ++row) {
+    const uint8_t *flags = damaged_.data() + static_cast<size_t>(row) * columns_;
+    uint32_t column = 0;
+    while (column < columns_) {
+      if ((flags[column] != 0u) != damaged) {
+        ++column;
+        continue;
+      }
+      const uint32_t first = column;
+      while (column < columns_ && (flags[column] != 0u) == damaged) {
+        ++column;
+      }
+      const TileRect start = tileRect(first, row);
+      const TileRect end = tileRect(column - 1u, row);
+      result.push_back({start.x, start.y, end.x + end.width - start.x, start.height});
+    }
+  }
+  return result;
+}
+
+void TileDamageTracker::updateCamera(const TileCameraLayer &camera) {
+  const VideoFrame *frame = camera.frame;
+  if (frame != nullptr && (frame->rgba.empty() || frame->width == 0u || frame->height == 0u ||
+                           camera.rect.width <= 0 || camera.rect.height <= 0)) {
+    frame = nullptr;
+  }
+  const AlphaMask *mask = camera.mask;
+  if (frame == nullptr || mask == nullptr || mask->alpha.empty() || mask->width == 0u || mask->height == 0u) {
+    mask = nullptr;
+  }
+
+  uint64_t key = kHashSeed;
+  for (const uint64_t value : {
+           static_cast<uint64_t>(frame != nullptr), static_cast<uint64_t>(mask != nullptr),
+           static_cast<uint64_t>(frame != nullptr ? frame->width : 0u),
+           static_cast<uint64_t>(frame != nullptr ? frame->height : 0u),
+           static_cast<uint64_t>(mask != nullptr ? mask->width : 0u),
+           static_cast<uint64_t>(mask != nullptr ? mask->height : 0u),
+           static_cast<uint64_t>(static_cast<uint32_t>(camera.rect.x)),
+           static_cast<uint64_t>(static_cast<uint32_t>(camera.rect.y)),
+           static_cast<uint64_t>(static_cast<uint32_t>(camera.rect.width)),
+           static_cast<uint64_t>(static_cast<uint32_t>(camera.rect.height)),
+           static_cast<uint64_t>(camera.sourceX), static_cast<uint64_t>(camera.sourceY),
+           static_cast<uint64_t>(camera.sourceWidth), static_cast<uint64_t>(camera.sourceHeight),
+           static_cast<uint64_t>(camera.mirror)}) {
+    key = mixKey(key, value);
+  }
+  if (key != cameraKey_) {
+    cameraKey_ = key;
+    full_ = true;
+    std::fill(damaged_.begin(), damaged_.end(), 1u);
+  }
+
+  const TileRect &rect = camera.rect;
+  for (uint32_t row = 0; row < rows_; ++row) {
+    for (uint32_t column = 0; column < columns_; ++column) {
+      const size_t index = static_cast<size_t>(row) * columns_ + column;
+      const TileRect tile = tileRect(column, row);
+      const int x0 = std::max(tile.x, rect.x);
+      const int y0 = std::max(tile.y, rect.y);
+      const int x1 = std::min(tile.x + tile.width, rect.x + rect.width);
+      const int y1 = std::min(tile.y + tile.height, rect.y + rect.height);
+      uint64_t cameraHash = 0u;
+      uint64_t maskHash = 0u;
+      if (frame != nullptr && x0 < x1 && y0 < y1) {
+        uint32_t sx0 = sampledSource(camera.sourceX, camera.sourceWidth, x0 - rect.x, rect.width, frame->width);
+        uint32_t sx1 = sampledSource(camera.sourceX, camera.sourceWidth, x1 - 1 - rect.x, rect.width, frame->width);
+        if (camera.mirror) {
+          const uint32_t mirrorEnd = camera.sourceX * 2u + camera.sourceWidth - 1u;
+          const uint32_t left = mirrorEnd - sx1;
+          sx1 = mirrorEnd - sx0;
+          sx0 = left;
+        }
+        const uint32_t sy0 = sampledSource(camera.sourceY, camera.sourceHeight, y0 - rect.y, rect.height, frame->height);
+        const uint32_t sy1 = sampledSource(camera.sourceY, camera.sourceHeight, y1 - 1 - rect.y, rect.height, frame->height);
+
+        bool visible = true;
+        if (mask != nullptr) {
+          visible = false;
+          maskHash = kHashSeed;
+          const uint32_t mx0 = maskSample(sx0, frame->width, mask->width);
+          const uint32_t mx1 = std::min(maskSample(sx1, frame->width, mask->width) + 1u, mask->width - 1u);
+          const uint32_t my0 = maskSample(sy0, frame->height, mask->height);
+          const uint32_t my1 = std::min(maskSample(sy1, frame->height, mask->height) + 1u, mask->height - 1u);
+          for (uint32_t my = my0; my <= my1; ++my) {
+            const uint8_t *samples = mask->alpha.data() + static_cast<size_t>(my) * mask->width + mx0;
+            const size_t count = static_cast<size_t>(mx1 - mx0) + 1u;
+            maskHash = hashBytes(maskHash, samples, count);
+            visible = visible || std::any_of(samples, samples + count, [](uint8_t alpha) { return alpha != 0u; });
+          }
+        }
+        // Fully transparent samples leave the layers below untouched, so the
+        // camera pixels under them cannot damage the tile.
+        if (visible) {
+          cameraHash = kHashSeed;
+          for (uint32_t sy = sy0; sy <= sy1; ++sy) {
+            cameraHash = hashBytes(cameraHash,
+                                   frame->rgba.data() + (static_cast<size_t>(sy) * frame->width + sx0) * 4u,
+                                   (static_cast<size_t>(sx1 - sx0) + 1u) * 4u);
+          }
+        }
+      }
+      if (cameraHash != cameraHashes_[index] || maskHash != maskHashes_[index]) {
+        damaged_[index] = 1u;
+      }
+      cameraHashes_[index] = cameraHash;
+      maskHashes_[index] = maskHash;
+    }
+  }
+}
+
+// Graphics layers change only when the FrameBus delivers a new frame, so the
+// tiles are re-hashed only when the timestamp moves. Frame-sized layers are
+// compared tile by tile; any other size is cover-scaled across the whole
+// output, and a new frame damages everything.
+void TileDamageTracker::updateGraphics(GraphicsTiles &tiles, const VideoFrame *frame) {
+  if (frame == nullptr || frame->rgba.empty() || frame->width == 0u || frame->height == 0u) {
+    if (tiles.present) {
+      full_ = true;
+      std::fill(damaged_.begin(), damaged_.end(), 1u);
+    }
+    tiles = GraphicsTiles();
+    return;
+  }
+  if (tiles.present && tiles.timestampNs == frame->timestampNs && tiles.width == frame->width &&
+      tiles.height == frame->height) {
+    return;
+  }
+
+  const bool frameSized = frame->width == width_ && frame->height == height_ &&
+      frame->rgba.size() >= static_cast<size_t>(width_) * height_ * 4u;
+  const bool comparable = frameSized && tiles.present && tiles.hashes.size() == damaged_.size();
+  tiles.present = true;
+  tiles.width = frame->width;
+  tiles.height = frame->height;
+  tiles.timestampNs = frame->timestampNs;
+  if (!comparable) {
+    full_ = true;
+    std::fill(damaged_.begin(), damaged_.end(), 1u);
+  }
+  if (!frameSized) {
+    tiles.hashes.clear();
+    return;
+  }
+
+  tiles.hashes.resize(damaged_.size());
+  for (uint32_t row = 0; row < rows_; ++row) {
+    for (uint32_t column = 0; column < columns_; ++column) {
+      const size_t index = static_cast<size_t>(row) * columns_ + column;
+      const TileRect tile = tileRect(column, row);
+      uint64_t hash = kHashSeed;
+      for (int y = tile.y; y < tile.y + tile.height; ++y) {
+        hash = hashBytes(hash,
+                         frame->rgba.data() + (static_cast<size_t>(y) * width_ + static_cast<uint32_t>(tile.x)) * 4u,
+                         static_cast<size_t>(tile.width) * 4u);
+      }
+      if (hash != tiles.hashes[index]) {
+        damaged_[index] = 1u;
+      }
+      tiles.hashes[index] = hash;
+    }
+  }
+}
+
+TileRect TileDamageTracker::tileRect(uint32_t column, uint32_t row) const {
+  const uint32_t x = column * kTileSize;
+  const uint32_t y = row * kTileSize;
+  return {static_cast<int>(x), static_cast<int>(y), static_cast<int>(std::min(kTileSize, width_ - x)),
+          static_cast<int>(std::min(kTileSize, height_ - y))};
+}
+
+}  // namespace broadify::meeting
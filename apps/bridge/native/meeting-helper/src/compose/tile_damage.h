@@ -0,0 +1,92 @@
+#pragma once
+
+#include "capture/camera_source.h"
+#include "keyer/keyer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broadify::meeting {
+
+struct TileRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// The camera layer as the CPU compositor samples it: `frame` cover-cropped to
+// the source rect and scaled into `rect`, optionally mirrored, with `mask`
+// (any size, sampled bilinearly) as its alpha when one is applied.
+struct TileCameraLayer {
+  const VideoFrame *frame = nullptr;
+  const AlphaMask *mask = nullptr;
+  TileRect rect;
+  uint32_t sourceX = 0;
+  uint32_t sourceY = 0;
+  uint32_t sourceWidth = 0;
+  uint32_t sourceHeight = 0;
+  bool mirror = false;
+};
+
+// Damage tracking for incremental CPU composition. The output is split into
+// kTileSize tiles, and each tile remembers hashes of the inputs it was last
+// composed from: the camera pixels and mask samples it reads, and its tile of
+// each frame-sized graphics layer. Everything else that feeds the frame
+// (layer revisions, background, layout) is folded into a scene key by the
+// caller; a new key, camera geometry or output size damages every tile.
+//
+// Camera pixels only count where they are visible: a tile whose mask samples
+// are all zero stays undamaged however the camera changes, which is what
+// keeps a keyed talking head over a static background cheap.
+class TileDamageTracker {
+ public:
+  static constexpr uint32_t kTileSize = 32u;
+
+  // Compares this frame's inputs with the ones recorded by the previous
+  // update, marks the tiles that differ and records the new inputs. The
+  // caller must then recompose exactly the damaged tiles.
+  void update(uint32_t width, uint32_t height, uint64_t sceneKey,
+              const TileCameraLayer &camera, const VideoFrame *backGraphics,
+              const VideoFrame *frontGraphics);
+  // Damages every tile on the next update, e.g. when the caller dropped the
+  // frame the undamaged tiles are carried over from.
+  void invalidate();
+
+  bool fullDamage() const { return full_; }
+  size_t tileCount() const { return damaged_.size(); }
+  size_t damagedTileCount() const;
+  // Damaged (or undamaged) tiles of the last update, merged into horizontal
+  // runs within each tile row and clipped to the output.
+  std::vector<TileRect> runs(bool damaged) const;
+
+ private:
+  struct GraphicsTiles {
+    bool present = false;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t timestampNs = 0;
+    std::vector<uint64_t> hashes;
+  };
+
+  void updateCamera(const TileCameraLayer &camera);
+  void updateGraphics(GraphicsTiles &tiles, const VideoFrame *frame);
+  TileRect tileRect(uint32_t column, uint32_t row) const;
+
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  uint32_t columns_ = 0;
+  uint32_t rows_ = 0;
+  bool valid_ = false;
+  bool full_ = true;
+  uint64_t sceneKey_ = 0;
+  uint64_t cameraKey_ = 0;
+  std::vector<uint8_t> damaged_;
+  std::vector<uint64_t> cameraHashes_;
+  std::vector<uint64_t> maskHashes_;
+  GraphicsTiles back_;
+  GraphicsTiles front_;
+};
+
+}  // namespace broadify::meeting
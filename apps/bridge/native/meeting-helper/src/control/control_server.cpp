@@ -1,8 +1,13 @@
 #include "control/control_server.h"
 
+#include "compose/font_face.h"
+#include "pipeline/capacity_benchmark.h"
+#include "preview/camera_mosaic.h"
 #include "preview/preview_frame_store.h"
 #include "recorder/meeting_recorder.h"
+#include "state/program_update.h"
 #include "util/json_utils.h"
+#include "util/thread_roles.h"
 
 #include <algorithm>
 #include <cctype>
@@ -34,27 +39,25 @@ void configureSocketForShutdownChecks(int socketHandle) {
 }
 #endif
 
-std::string programSectionJson(const MeetingState &state, const std::string &section) {
-  if (section == "speaker_layout") {
-    return state.speakerLayout.rawJson;
-  }
-  if (section == "cornerbug") {
-    return state.cornerbug.rawJson;
-  }
-  if (section == "media_layer") {
-    return state.mediaLayer.rawJson;
-  }
-  if (section == "graphics") {
-    return state.graphics.rawJson;
-  }
-  if (section == "camera") {
-    return state.cameraRender.rawJson;
-  }
-  return "{\"enabled\":false}";
-}
-
-bool isProgramSection(const std::string &section) {
-  return section == "speaker_layout" || section == "cornerbug" || section == "media_layer" || section == "graphics" || section == "camera";
+// Bounds for output.framebus.configure. Dimensions stay even for the 4:2:0
+// encoders downstream (recorder, virtual camera).
+constexpr int kMinOutputDimension = 64;
+constexpr int kMaxOutputWidth = 3840;
+constexpr int kMaxOutputHeight = 2160;
+constexpr int kMaxOutputFps = 60;
+constexpr int kMaxFramebusSlots = 8;
+constexpr size_t kMaxProgramBatchUpdates = 16;
+constexpr int kMaxCapacityIterations = 60;
+constexpr int kDefaultProfileRuns = 20;
+constexpr int kMaxProfileRuns = 200;
+
+std::string outputConfigJson(const OutputConfig &config) {
+  std::ostringstream out;
+  out << "\"width\":" << config.width
+      << ",\"height\":" << config.height
+      << ",\"fps\":" << config.fps
+      << ",\"slot_count\":" << config.slotCount;
+  return out.str();
 }
 
 std::string metricNumber(double value) {
@@ -76,8 +79,34 @@ std::string normalizedPerformanceMode(const std::string &performanceMode) {
   return "high_quality";
 }
 
-bool isSupportedKeyerModel(const std::string &model) {
-  return model == "modnet" || model == "vision_person_segmentation";
+// "#RRGGBB" into the chroma key colour; anything else is rejected.
+bool parseChromaKeyColor(const std::string &value, ChromaKeySettings &settings) {
+  if (value.size() != 7u || value[0] != '#') {
+    return false;
+  }
+  uint8_t channels[3] = {0, 0, 0};
+  for (size_t i = 0; i < 3u; ++i) {
+    const std::string digits = value.substr(1u + i * 2u, 2u);
+    if (!std::isxdigit(static_cast<unsigned char>(digits[0])) ||
+        !std::isxdigit(static_cast<unsigned char>(digits[1]))) {
+      return false;
+    }
+    channels[i] = static_cast<uint8_t>(std::strtoul(digits.c_str(), nullptr, 16));
+  }
+  settings.keyRed = channels[0];
+  settings.keyGreen = channels[1];
+  settings.keyBlue = channels[2];
+  return true;
+}
+
+std::string chromaKeyColorHex(const ChromaKeySettings &settings) {
+  static const char *kDigits = "0123456789ABCDEF";
+  std::string hex = "#";
+  for (const uint8_t channel : {settings.keyRed, settings.keyGreen, settings.keyBlue}) {
+    hex += kDigits[channel >> 4];
+    hex += kDigits[channel & 0x0Fu];
+  }
+  return hex;
 }
 
 uint32_t clampedPixelRadius(int value, uint32_t maxValue) {
@@ -94,12 +123,6 @@ KeyerDegradationSettings normalizedDegradationSettings(KeyerDegradationSettings
   return settings;
 }
 
-void markProgramDirty(MeetingState &state, bool graphicsDirty = false) {
-  state.programDirty = true;
-  state.graphicsDirty = state.graphicsDirty || graphicsDirty;
-  ++state.programRevision;
-}
-
 std::string keyerMetricsJson(const KeyerMetrics &metrics) {
   std::ostringstream result;
   result << "{\"camera_copy_ms\":" << metricNumber(metrics.cameraCopyMs)
@@ -126,68 +149,30 @@ std::string keyerMetricsJson(const KeyerMetrics &metrics) {
          << ",\"dropped_frames_per_sec\":" << metricNumber(metrics.droppedFramesPerSec)
          << ",\"mask_width\":" << metrics.maskWidth
          << ",\"mask_height\":" << metrics.maskHeight
+         << ",\"camera_display_width\":" << metrics.cameraDisplayWidth
+         << ",\"camera_display_height\":" << metrics.cameraDisplayHeight
          << ",\"dropped_frames\":" << metrics.droppedFrames
          << ",\"skipped_frames\":" << metrics.skippedFrames << "}";
   return result.str();
 }
 
-void updateProgramSection(MeetingState &state, const std::string &section, const std::string &values) {
-  const std::string safeValues = values.empty() ? "{\"enabled\":false}" : values;
-  if (section == "speaker_layout") {
-    state.speakerLayout.enabled = extractBoolField(safeValues, "enabled", state.speakerLayout.enabled);
-    state.cameraRender.enabled = extractBoolField(safeValues, "camera_enabled", state.cameraRender.enabled);
-    const std::string layout = extractStringField(safeValues, "layout");
-    if (!layout.empty()) {
-      state.speakerLayout.layout = layout;
-    }
-    state.speakerLayout.scale = extractDoubleField(safeValues, "scale", state.speakerLayout.scale);
-    state.speakerLayout.rawJson = safeValues;
-    return;
-  }
-  if (section == "cornerbug") {
-    state.cornerbug.enabled = extractBoolField(safeValues, "enabled", state.cornerbug.enabled);
-    state.cornerbug.x = extractDoubleField(safeValues, "x", state.cornerbug.x);
-    state.cornerbug.y = extractDoubleField(safeValues, "y", state.cornerbug.y);
-    state.cornerbug.size = extractDoubleField(safeValues, "size", state.cornerbug.size);
-    state.cornerbug.rawJson = safeValues;
-    return;
-  }
-  if (section == "media_layer") {
-    state.mediaLayer.enabled = extractBoolField(safeValues, "enabled", state.mediaLayer.enabled);
-    const std::string mode = extractStringField(safeValues, "mode");
-    if (!mode.empty()) {
-      state.mediaLayer.mode = mode;
-    }
-    state.mediaLayer.assetId = extractStringField(safeValues, "asset_id");
-    state.mediaLayer.renderedPagePath = extractStringField(safeValues, "rendered_page_path");
-    state.mediaLayer.renderStatus = extractStringField(safeValues, "render_status");
-    state.mediaLayer.page = extractIntField(safeValues, "page", state.mediaLayer.page);
-    state.mediaLayer.pageCount = extractIntField(safeValues, "page_count", state.mediaLayer.pageCount);
-    state.mediaLayer.x = extractDoubleField(safeValues, "x", state.mediaLayer.x);
-    state.mediaLayer.y = extractDoubleField(safeValues, "y", state.mediaLayer.y);
-    state.mediaLayer.width = extractDoubleField(safeValues, "width", state.mediaLayer.width);
-    state.mediaLayer.height = extractDoubleField(safeValues, "height", state.mediaLayer.height);
-    state.mediaLayer.rotation = extractDoubleField(safeValues, "rotation", state.mediaLayer.rotation);
-    state.mediaLayer.rotationX = extractDoubleField(safeValues, "rotationX", state.mediaLayer.rotationX);
-    state.mediaLayer.rotationY = extractDoubleField(safeValues, "rotationY", state.mediaLayer.rotationY);
-    state.mediaLayer.rawJson = safeValues;
-    return;
-  }
-  if (section == "graphics") {
-    state.graphics.enabled = extractBoolField(safeValues, "enabled", state.graphics.enabled);
-    state.graphics.graphicId = extractStringField(safeValues, "graphic_id");
-    state.graphics.templateName = extractStringField(safeValues, "template");
-    state.graphics.source = extractStringField(safeValues, "source");
-    state.graphics.handoffTarget = extractStringField(safeValues, "handoff_target");
-    state.graphics.rawJson = safeValues;
-    return;
-  }
-  if (section == "camera") {
-    state.cameraRender.enabled = extractBoolField(safeValues, "enabled", state.cameraRender.enabled);
-    state.cameraRender.mirror = extractBoolField(safeValues, "mirror", state.cameraRender.mirror);
-    state.cameraRender.rawJson = std::string("{\"enabled\":") + (state.cameraRender.enabled ? "true" : "false") +
-        ",\"mirror\":" + (state.cameraRender.mirror ? "true" : "false") + "}";
+std::string keyerProfileJson(const KeyerProfileReport &report) {
+  std::ostringstream result;
+  result << "\"profile\":{\"state\":\"" << jsonEscape(report.state) << "\",\"revision\":" << report.revision
+         << ",\"runs\":" << report.runsRequested << ",\"runs_completed\":" << report.runsCompleted
+         << ",\"reason\":" << (report.reason.empty() ? "null" : "\"" + jsonEscape(report.reason) + "\"")
+         << ",\"summary\":" << (report.summaryJson.empty() ? "null" : report.summaryJson) << "}";
+  return result.str();
+}
+
+std::string changedKeysJson(const std::vector<std::string> &changed) {
+  std::ostringstream result;
+  result << "[";
+  for (size_t i = 0; i < changed.size(); ++i) {
+    result << (i ? "," : "") << "\"" << jsonEscape(changed[i]) << "\"";
   }
+  result << "]";
+  return result.str();
 }
 
 std::string recordingStatusJson(MeetingRecorder &recorder) {
@@ -207,6 +192,7 @@ std::string handleRpc(const std::string &line,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
+                      CapacityBenchmark &capacity,
                       const Options &options,
                       std::atomic<bool> &running) {
   const std::string id = extractStringField(line, "id");
@@ -246,8 +232,11 @@ std::string handleRpc(const std::string &line,
            << "\"framebus_running\":" << (state.framebusRunning ? "true" : "false") << ","
            << "\"program_dirty\":" << (state.programDirty ? "true" : "false") << ","
            << "\"graphics_dirty\":" << (state.graphicsDirty ? "true" : "false") << ","
+           << "\"native_graphics_text\":" << (fontRenderingAvailable() ? "true" : "false") << ","
            << "\"rendered_frames\":" << state.renderedFrames << ","
            << "\"reused_frames\":" << state.reusedFrames << ","
+           << "\"composed_tiles\":" << state.composedTiles << ","
+           << "\"recomposed_tiles\":" << state.recomposedTiles << ","
            << "\"published_preview_frames\":" << state.publishedPreviewFrames << ","
            << "\"written_framebus_frames\":" << state.writtenFramebusFrames << ","
            << "\"camera_permission_status\":\"" << jsonEscape(camera.cameraPermissionStatus()) << "\","
@@ -403,6 +392,22 @@ std::string handleRpc(const std::string &line,
     return okResponse(id, result.str());
   }
 
+  // Conference operator mosaic: where each open camera sits in the mosaic
+  // MJPEG atlas, with its current audio level.
+  if (method == "camera.mosaic") {
+    const MosaicLayout layout = computeMosaicLayout(camera.activeCameraSet());
+    int clients = 0;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      clients = state.mosaicClientCount;
+    }
+    std::ostringstream result;
+    result << "{\"ok\":true,\"port\":" << options.mosaicPort
+           << ",\"clients\":" << clients
+           << ",\"layout\":" << mosaicLayoutJson(layout, camera.cameraAudioLevels()) << "}";
+    return okResponse(id, result.str());
+  }
+
   // Conference auto-director on/off (+ optional speech threshold). The pipeline
   // loop reads these flags and cuts the program to the loudest camera.
   if (method == "camera.auto_director") {
@@ -437,7 +442,15 @@ std::string handleRpc(const std::string &line,
            << ",\"edge_stabilization_enabled\":" << (state.edgeStabilizationEnabled ? "true" : "false")
            << ",\"edge_stabilization_strength\":" << state.edgeStabilizationStrength
            << ",\"fresh_mask_age_ms\":" << state.degradationSettings.freshMaskAgeMs
-           << ",\"max_mask_age_ms\":" << state.degradationSettings.maxMaskAgeMs << "},"
+           << ",\"max_mask_age_ms\":" << state.degradationSettings.maxMaskAgeMs
+           << ",\"chroma_key_color\":\"" << chromaKeyColorHex(state.chromaKey)
+           << "\",\"chroma_tolerance\":" << state.chromaKey.tolerance
+           << ",\"chroma_softness\":" << state.chromaKey.softness
+           << ",\"chroma_spill_suppression\":" << state.chromaKey.spillSuppression
+           << ",\"clean_plate_threshold\":" << state.cleanPlate.threshold
+           << ",\"clean_plate_softness\":" << state.cleanPlate.softness
+           << ",\"clean_plate_adaptive\":" << (state.cleanPlate.adaptivePlate ? "true" : "false")
+           << ",\"clean_plate_revision\":" << state.cleanPlate.plateRevision << "},"
            << "\"status\":{\"active_keyer\":\"" << jsonEscape(state.activeKeyer)
            << "\",\"fallback_active\":" << (state.fallbackActive ? "true" : "false")
            << ",\"fallback_reason\":" << (state.fallbackReason.empty() ? "null" : "\"" + jsonEscape(state.fallbackReason) + "\"")
@@ -471,6 +484,11 @@ std::string handleRpc(const std::string &line,
     if (!requestedModel.empty() && !isSupportedKeyerModel(requestedModel)) {
       return errorResponse(id, "invalid_keyer_model", "Unsupported keyer model");
     }
+    const std::string chromaKeyColor = extractStringField(line, "chroma_key_color");
+    ChromaKeySettings chromaColor;
+    if (!chromaKeyColor.empty() && !parseChromaKeyColor(chromaKeyColor, chromaColor)) {
+      return errorResponse(id, "invalid_chroma_key_color", "chroma_key_color must be #RRGGBB");
+    }
     {
       std::lock_guard<std::mutex> lock(state.mutex);
       state.keyerEnabled = extractBoolField(line, "enabled", state.keyerEnabled);
@@ -508,22 +526,64 @@ std::string handleRpc(const std::string &line,
       degradation.freshMaskAgeMs = extractDoubleField(line, "fresh_mask_age_ms", degradation.freshMaskAgeMs);
       degradation.maxMaskAgeMs = extractDoubleField(line, "max_mask_age_ms", degradation.maxMaskAgeMs);
       state.degradationSettings = normalizedDegradationSettings(degradation);
-      state.activeKeyer = "passthrough";
-      state.fallbackActive = true;
-      state.fallbackReason = state.keyerEnabled ? state.requestedKeyerModel + "_pending" : "keyer_disabled";
-      state.keyerBackend = "passthrough";
-      state.degradationStage = "fresh";
-      state.staleMaskActive = false;
-      state.keyerPipelineMode = state.keyerEnabled ? "async_live_snap" : "passthrough";
-      state.provider.clear();
-      state.modelPath.clear();
-      state.modelHashOk = false;
-      state.inferenceMs = -1.0;
-      state.keyerMetrics = KeyerMetrics{};
-      ++state.keyerRevision;
-      markProgramDirty(state);
+      ChromaKeySettings &chroma = state.chromaKey;
+      if (!chromaKeyColor.empty()) {
+        chroma.keyRed = chromaColor.keyRed;
+        chroma.keyGreen = chromaColor.keyGreen;
+        chroma.keyBlue = chromaColor.keyBlue;
+      }
+      chroma.tolerance = clampedDouble(extractDoubleField(line, "chroma_tolerance", chroma.tolerance), 0.0, 1.0);
+      chroma.softness = clampedDouble(extractDoubleField(line, "chroma_softness", chroma.softness), 0.0, 1.0);
+      chroma.spillSuppression =
+          clampedDouble(extractDoubleField(line, "chroma_spill_suppression", chroma.spillSuppression), 0.0, 1.0);
+      CleanPlateSettings &cleanPlate = state.cleanPlate;
+      cleanPlate.threshold =
+          clampedDouble(extractDoubleField(line, "clean_plate_threshold", cleanPlate.threshold), 0.0, 1.0);
+      cleanPlate.softness =
+          clampedDouble(extractDoubleField(line, "clean_plate_softness", cleanPlate.softness), 0.0, 1.0);
+      cleanPlate.adaptivePlate = extractBoolField(line, "clean_plate_adaptive", cleanPlate.adaptivePlate);
+      markKeyerReconfigured(state);
+    }
+    return handleRpc("{\"id\":\"" + id + "\",\"method\":\"keyer.get\"}", state, camera, previewFrames, recorder, capacity, options, running);
+  }
+
+  // The next frame the clean_plate keyer sees becomes its plate; the room
+  // should be empty. Works before the model is selected.
+  if (method == "keyer.capture_plate") {
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      ++state.cleanPlate.plateRevision;
     }
-    return handleRpc("{\"id\":\"" + id + "\",\"method\":\"keyer.get\"}", state, camera, previewFrames, recorder, options, running);
+    return handleRpc("{\"id\":\"" + id + "\",\"method\":\"keyer.get\"}", state, camera, previewFrames, recorder, capacity, options, running);
+  }
+
+  if (method == "keyer.profile") {
+    // {"start":true} profiles the next `runs` MODNet inferences in ONNX
+    // Runtime; every call returns the request state and the latest summary,
+    // so the bridge polls until the state is "complete" or "failed".
+    std::lock_guard<std::mutex> lock(state.mutex);
+    bool started = false;
+    if (extractBoolField(line, "start", false)) {
+      const int runs = extractIntField(line, "runs", kDefaultProfileRuns);
+      if (runs < 1 || runs > kMaxProfileRuns) {
+        return errorResponse(id, "invalid_runs", "runs must be between 1 and " + std::to_string(kMaxProfileRuns) + ".");
+      }
+      if (!state.keyerEnabled || state.requestedKeyerModel != "modnet" ||
+          state.keyerPipelineMode == "fused_coreml") {
+        return errorResponse(id, "keyer_profile_unavailable",
+                             "Profiling needs the modnet keyer running on ONNX Runtime.");
+      }
+      KeyerProfileRequest &request = state.keyerProfileRequest;
+      ++request.revision;
+      request.runs = static_cast<uint32_t>(runs);
+      state.keyerProfile = KeyerProfileReport{};
+      state.keyerProfile.revision = request.revision;
+      state.keyerProfile.state = "pending";
+      state.keyerProfile.runsRequested = request.runs;
+      started = true;
+    }
+    return okResponse(id, "{\"ok\":true,\"started\":" + std::string(started ? "true" : "false") + "," +
+                              keyerProfileJson(state.keyerProfile) + "}");
   }
 
   if (method == "keyer.reset") {
@@ -545,6 +605,11 @@ std::string handleRpc(const std::string &line,
     state.edgeStabilizationEnabled = true;
     state.edgeStabilizationStrength = 0.35;
     state.degradationSettings = KeyerDegradationSettings{};
+    state.chromaKey = ChromaKeySettings{};
+    // Settings go back to defaults; a captured plate stays valid.
+    const uint64_t plateRevision = state.cleanPlate.plateRevision;
+    state.cleanPlate = CleanPlateSettings{};
+    state.cleanPlate.plateRevision = plateRevision;
     state.degradationStage = "fresh";
     state.staleMaskActive = false;
     state.keyerPipelineMode = "passthrough";
@@ -567,25 +632,65 @@ std::string handleRpc(const std::string &line,
     return okResponse(id, programSectionJson(state, section));
   }
 
+  // Either {"values":{...}} replacing the section or {"patch":{...}} naming
+  // only the members to change (null removes one). Members that did not
+  // change keep their revision and do not trigger a re-render.
   if (method == "program.update") {
-    const std::string section = extractStringField(line, "section");
-    const std::string values = extractObjectField(line, "values");
-    if (!isProgramSection(section)) {
-      return errorResponse(id, "invalid_program_section", "Unknown program section: " + section);
+    std::vector<ProgramSectionUpdate> updates(1);
+    const std::string error = parseProgramSectionUpdate(line, updates.front());
+    if (!error.empty()) {
+      return errorResponse(id, isProgramSection(updates.front().section) ? "invalid_program_values" : "invalid_program_section",
+                           error);
     }
-    {
-      std::lock_guard<std::mutex> lock(state.mutex);
-      updateProgramSection(state, section, values);
-      markProgramDirty(state, section == "graphics");
+    const uint64_t revision = applyProgramUpdates(state, updates);
+    std::ostringstream result;
+    result << "{\"ok\":true,\"section\":\"" << jsonEscape(updates.front().section)
+           << "\",\"changed\":" << changedKeysJson(updates.front().changed)
+           << ",\"field_revision\":" << revision << "}";
+    return okResponse(id, result.str());
+  }
+
+  // {"updates":[{"section":...,"values"|"patch":{...}}, ...]}: several
+  // sections change as one transaction. Every entry is validated first (an
+  // invalid one rejects the whole batch), then all are applied with one field
+  // revision and one re-render, so a scene change never shows half-applied.
+  if (method == "program.update_batch") {
+    std::vector<std::string> entries;
+    const std::string array = extractArrayField(line, "updates");
+    if (array.empty() || !splitArrayElements(array, entries) || entries.empty()) {
+      return errorResponse(id, "invalid_program_batch", "program.update_batch needs a non-empty updates array.");
+    }
+    if (entries.size() > kMaxProgramBatchUpdates) {
+      return errorResponse(id, "invalid_program_batch", "program.update_batch accepts at most 16 updates.");
+    }
+    std::vector<ProgramSectionUpdate> updates(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const std::string error = parseProgramSectionUpdate(entries[i], updates[i]);
+      if (!error.empty()) {
+        return errorResponse(id, isProgramSection(updates[i].section) ? "invalid_program_values" : "invalid_program_section",
+                             "updates[" + std::to_string(i) + "]: " + error);
+      }
+    }
+    const uint64_t revision = applyProgramUpdates(state, updates);
+    std::ostringstream result;
+    result << "{\"ok\":true,\"updates\":[";
+    for (size_t i = 0; i < updates.size(); ++i) {
+      result << (i ? "," : "") << "{\"section\":\"" << jsonEscape(updates[i].section)
+             << "\",\"changed\":" << changedKeysJson(updates[i].changed) << "}";
     }
-    return okResponse(id, "{\"ok\":true,\"section\":\"" + jsonEscape(section) + "\"}");
+    result << "],\"field_revision\":" << revision << "}";
+    return okResponse(id, result.str());
   }
 
   if (method == "output.framebus.status") {
     std::lock_guard<std::mutex> lock(state.mutex);
     std::ostringstream result;
     result << "{\"enabled\":true,\"running\":" << (state.framebusRunning ? "true" : "false")
-           << ",\"name\":\"" << jsonEscape(options.framebusName) << "\",\"last_error\":null}";
+           << ",\"name\":\"" << jsonEscape(options.framebusName) << "\""
+           << "," << outputConfigJson(state.output)
+           << ",\"config_revision\":" << state.appliedOutputConfigRevision
+           << ",\"config_pending\":" << (state.outputConfigRevision != state.appliedOutputConfigRevision ? "true" : "false")
+           << ",\"last_error\":" << (state.framebusLastError.empty() ? "null" : "\"" + jsonEscape(state.framebusLastError) + "\"") << "}";
     return okResponse(id, result.str());
   }
 
@@ -607,7 +712,41 @@ std::string handleRpc(const std::string &line,
   }
 
   if (method == "output.framebus.configure") {
-    return okResponse(id, "{\"ok\":true}");
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const OutputConfig &base = state.requestedOutput;
+    const int width = extractIntField(line, "width", static_cast<int>(base.width));
+    const int height = extractIntField(line, "height", static_cast<int>(base.height));
+    const int fps = extractIntField(line, "fps", static_cast<int>(base.fps));
+    const int slotCount = extractIntField(line, "slot_count", static_cast<int>(base.slotCount));
+    if (width < kMinOutputDimension || width > kMaxOutputWidth || width % 2 != 0 ||
+        height < kMinOutputDimension || height > kMaxOutputHeight || height % 2 != 0) {
+      return errorResponse(id, "invalid_output_size",
+                           "Output size must be even and between " + std::to_string(kMinOutputDimension) +
+                           " and " + std::to_string(kMaxOutputWidth) + "x" + std::to_string(kMaxOutputHeight) + ".");
+    }
+    if (fps < 1 || fps > kMaxOutputFps) {
+      return errorResponse(id, "invalid_output_fps", "fps must be between 1 and " + std::to_string(kMaxOutputFps) + ".");
+    }
+    if (slotCount < 2 || slotCount > kMaxFramebusSlots) {
+      return errorResponse(id, "invalid_slot_count", "slot_count must be between 2 and " + std::to_string(kMaxFramebusSlots) + ".");
+    }
+    OutputConfig requested;
+    requested.width = static_cast<uint32_t>(width);
+    requested.height = static_cast<uint32_t>(height);
+    requested.fps = static_cast<uint32_t>(fps);
+    requested.slotCount = static_cast<uint32_t>(slotCount);
+    const bool changed = requested.width != base.width || requested.height != base.height ||
+        requested.fps != base.fps || requested.slotCount != base.slotCount;
+    if (changed) {
+      // Applied by the pipeline at the next frame boundary.
+      state.requestedOutput = requested;
+      ++state.outputConfigRevision;
+    }
+    std::ostringstream result;
+    result << "{\"ok\":true," << outputConfigJson(requested)
+           << ",\"config_revision\":" << state.outputConfigRevision
+           << ",\"pending\":" << (state.outputConfigRevision != state.appliedOutputConfigRevision ? "true" : "false") << "}";
+    return okResponse(id, result.str());
   }
 
   if (method == "recording.microphones") {
@@ -634,8 +773,13 @@ std::string handleRpc(const std::string &line,
       return errorResponse(id, "invalid_request",
                            "recording.start requires file_path.");
     }
-    const bool started = recorder.start(filePath, micDeviceId, options.width,
-                                        options.height, options.fps);
+    OutputConfig output;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      output = state.output;
+    }
+    const bool started = recorder.start(filePath, micDeviceId, output.width,
+                                        output.height, output.fps);
     if (!started) {
       return errorResponse(id, "recording_start_failed",
                            recorder.status().lastError);
@@ -652,6 +796,54 @@ std::string handleRpc(const std::string &line,
     return okResponse(id, recordingStatusJson(recorder));
   }
 
+  if (method == "diagnostics.capacity") {
+    // {"start":true} launches a run in the background; every call returns
+    // the run state and the latest report, so the bridge polls until
+    // "running" turns false.
+    bool started = false;
+    if (extractBoolField(line, "start", false)) {
+      CapacityRequest request;
+      bool programLive = false;
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        request.width = state.output.width;
+        request.height = state.output.height;
+        request.fps = state.output.fps;
+        programLive = state.pipelineMode != "idle";
+      }
+      const int width = extractIntField(line, "width", static_cast<int>(request.width));
+      const int height = extractIntField(line, "height", static_cast<int>(request.height));
+      const int fps = extractIntField(line, "fps", static_cast<int>(request.fps));
+      const int iterations = extractIntField(line, "iterations", static_cast<int>(request.iterations));
+      if (width < kMinOutputDimension || width > kMaxOutputWidth || width % 2 != 0 ||
+          height < kMinOutputDimension || height > kMaxOutputHeight || height % 2 != 0) {
+        return errorResponse(id, "invalid_output_size",
+                             "Output size must be even and between " + std::to_string(kMinOutputDimension) +
+                             " and " + std::to_string(kMaxOutputWidth) + "x" + std::to_string(kMaxOutputHeight) + ".");
+      }
+      if (fps < 1 || fps > kMaxOutputFps) {
+        return errorResponse(id, "invalid_output_fps", "fps must be between 1 and " + std::to_string(kMaxOutputFps) + ".");
+      }
+      if (iterations < 1 || iterations > kMaxCapacityIterations) {
+        return errorResponse(id, "invalid_iterations",
+                             "iterations must be between 1 and " + std::to_string(kMaxCapacityIterations) + ".");
+      }
+      request.width = static_cast<uint32_t>(width);
+      request.height = static_cast<uint32_t>(height);
+      request.fps = static_cast<uint32_t>(fps);
+      request.iterations = static_cast<uint32_t>(iterations);
+      started = capacity.start(request, programLive);
+    }
+    return okResponse(id, "{\"ok\":true,\"started\":" + std::string(started ? "true" : "false") + "," +
+                              capacity.statusJson() + "}");
+  }
+
+  if (method == "diagnostics.threads") {
+    // CPU per thread role since the previous sample (the metrics loop also
+    // samples every two seconds), for machine sizing and runaway threads.
+    return okResponse(id, "{\"ok\":true," + threadRoleSampleJson(sampleThreadRoles()) + "}");
+  }
+
   return errorResponse(id, "unknown_method", "Unknown meeting-helper method: " + method);
 }
 
@@ -663,9 +855,11 @@ void runControlServer(const std::string &pipeName,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
+                      CapacityBenchmark &capacity,
                       const Options &options,
                       std::atomic<bool> &running,
                       const std::function<void()> &onListening) {
+  ScopedThreadRole role("control");
   if (onListening) {
     onListening();
   }
@@ -687,7 +881,7 @@ void runControlServer(const std::string &pipeName,
         size_t pos = pending.find('\n');
         if (pos != std::string::npos) {
           const std::string line = pending.substr(0, pos);
-          const std::string response = handleRpc(line, state, camera, previewFrames, recorder, options, running);
+          const std::string response = handleRpc(line, state, camera, previewFrames, recorder, capacity, options, running);
           DWORD written = 0;
           WriteFile(pipe, response.c_str(), (DWORD)response.size(), &written, NULL);
           break;
@@ -704,9 +898,11 @@ void runControlServer(const std::string &socketPath,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
+                      CapacityBenchmark &capacity,
                       const Options &options,
                       std::atomic<bool> &running,
                       const std::function<void()> &onListening) {
+  ScopedThreadRole role("control");
   unlink(socketPath.c_str());
   int serverFd = static_cast<int>(socket(AF_UNIX, SOCK_STREAM, 0));
   if (serverFd < 0) {
@@ -741,7 +937,7 @@ void runControlServer(const std::string &socketPath,
       const size_t pos = pending.find('\n');
       if (pos != std::string::npos) {
         const std::string line = pending.substr(0, pos);
-        const std::string response = handleRpc(line, state, camera, previewFrames, recorder, options, running);
+        const std::string response = handleRpc(line, state, camera, previewFrames, recorder, capacity, options, running);
         (void)write(client, response.c_str(), response.size());
         break;
       }
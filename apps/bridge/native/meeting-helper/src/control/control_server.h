@@ -10,6 +10,7 @@
 
 namespace broadify::meeting {
 
+class CapacityBenchmark;
 class PreviewFrameStore;
 class MeetingRecorder;
 
@@ -18,6 +19,7 @@ void runControlServer(const std::string &socketPath,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
+                      CapacityBenchmark &capacity,
                       const Options &options,
                       std::atomic<bool> &running,
                       const std::function<void()> &onListening = {});
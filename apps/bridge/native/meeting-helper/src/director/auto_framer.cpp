@@ -0,0 +1,89 @@
+#include "director/auto_framer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace broadify::meeting {
+namespace {
+
+constexpr uint8_t kSubjectAlpha = 128u;
+// Samples per axis the bounding box scan reads at most; the box only steers
+// a smoothed framing, so a coarse grid is plenty.
+constexpr uint32_t kBoundsSamples = 256u;
+// A longer gap between observations (camera stall) is not glided through in
+// one step.
+constexpr double kMaxStepSeconds = 0.25;
+
+CameraFraming framingFor(const SubjectBounds &bounds) {
+  const double height = std::max(bounds.bottom - bounds.top, 1e-3);
+  CameraFraming framing;
+  framing.zoom = std::clamp(AutoFramer::kSubjectFill / height, 1.0, AutoFramer::kMaxZoom);
+  const double windowHeight = 1.0 / framing.zoom;
+  framing.centerX = (bounds.left + bounds.right) * 0.5;
+  framing.centerY = bounds.top - AutoFramer::kHeadroom * windowHeight + windowHeight * 0.5;
+  return clampCameraFraming(framing);
+}
+
+}  // namespace
+
+bool subjectBounds(const AlphaMask &mask, SubjectBounds &bounds) {
+  if (mask.width == 0u || mask.height == 0u ||
+      mask.alpha.size() < static_cast<size_t>(mask.width) * mask.height) {
+    return false;
+  }
+  const uint32_t stepX = std::max(1u, mask.width / kBoundsSamples);
+  const uint32_t stepY = std::max(1u, mask.height / kBoundsSamples);
+  uint32_t minX = mask.width;
+  uint32_t minY = mask.height;
+  uint32_t maxX = 0u;
+  uint32_t maxY = 0u;
+  for (uint32_t y = 0; y < mask.height; y += stepY) {
+    const uint8_t *row = mask.alpha.data() + static_cast<size_t>(y) * mask.width;
+    for (uint32_t x = 0; x < mask.width; x += stepX) {
+      if (row[x] >= kSubjectAlpha) {
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+      }
+    }
+  }
+  if (minX > maxX || minY > maxY) {
+    return false;
+  }
+  bounds.left = static_cast<double>(minX) / mask.width;
+  bounds.top = static_cast<double>(minY) / mask.height;
+  bounds.right = static_cast<double>(std::min(mask.width, maxX + stepX)) / mask.width;
+  bounds.bottom = static_cast<double>(std::min(mask.height, maxY + stepY)) / mask.height;
+  return true;
+}
+
+void AutoFramer::observe(const AlphaMask *mask, std::chrono::steady_clock::time_point now) {
+  SubjectBounds bounds;
+  if (mask != nullptr && subjectBounds(*mask, bounds)) {
+    const CameraFraming wanted = framingFor(bounds);
+    if (std::abs(wanted.centerX - target_.centerX) > kCenterDeadband ||
+        std::abs(wanted.centerY - target_.centerY) > kCenterDeadband ||
+        std::abs(wanted.zoom / target_.zoom - 1.0) > kZoomDeadband) {
+      target_ = wanted;
+    }
+  }
+
+  const double seconds = lastObserved_ == std::chrono::steady_clock::time_point{}
+      ? 0.0
+      : std::min(kMaxStepSeconds, std::chrono::duration<double>(now - lastObserved_).count());
+  lastObserved_ = now;
+  const double blend = 1.0 - std::exp(-seconds / std::chrono::duration<double>(kSmoothing).count());
+  current_.zoom += (target_.zoom - current_.zoom) * blend;
+  current_.centerX += (target_.centerX - current_.centerX) * blend;
+  current_.centerY += (target_.centerY - current_.centerY) * blend;
+  current_ = clampCameraFraming(current_);
+}
+
+void AutoFramer::reset(const CameraFraming &framing) {
+  current_ = clampCameraFraming(framing);
+  target_ = current_;
+  lastObserved_ = std::chrono::steady_clock::time_point{};
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "compose/camera_framing.h"
+#include "keyer/keyer.h"
+
+#include <chrono>
+
+namespace broadify::meeting {
+
+// The keyed subject's bounding box, as fractions of the frame.
+struct SubjectBounds {
+  double left = 0.0;
+  double top = 0.0;
+  double right = 1.0;
+  double bottom = 1.0;
+};
+
+// Bounding box of the mask samples above half alpha. False when there are
+// none.
+bool subjectBounds(const AlphaMask &mask, SubjectBounds &bounds);
+
+// Auto-framing: steers the digital pan/zoom so the keyed subject fills the
+// picture with a little headroom, from the matte's bounding box. Like
+// AutoDirector it is deliberately calm: the target only moves once the
+// subject has clearly left it, and the framing glides there instead of
+// jumping, so breathing and gestures do not make the picture pump.
+//
+// Not thread-safe: drive it from a single loop (the frame pipeline).
+class AutoFramer {
+ public:
+  // Never zooms in further than this, so the keyer keeps a usable input.
+  static constexpr double kMaxZoom = 2.5;
+  // Share of the window height the subject should fill, and the room left
+  // above it.
+  static constexpr double kSubjectFill = 0.8;
+  static constexpr double kHeadroom = 0.08;
+  // The target only moves once the new one is this far off: centres as a
+  // share of the frame, zoom relative.
+  static constexpr double kCenterDeadband = 0.05;
+  static constexpr double kZoomDeadband = 0.12;
+  // Time constant of the glide toward the target.
+  static constexpr std::chrono::milliseconds kSmoothing{700};
+
+  const CameraFraming &framing() const { return current_; }
+
+  // Moves the target to frame the subject of `mask` (nullptr or an empty
+  // matte keep the current target) and glides the framing toward it.
+  void observe(const AlphaMask *mask, std::chrono::steady_clock::time_point now);
+
+  // Jumps to `framing` and makes it the target, e.g. the manual framing while
+  // auto-framing is off, so switching it on starts from what is on air.
+  void reset(const CameraFraming &framing);
+
+ private:
+  CameraFraming current_;
+  CameraFraming target_;
+  std::chrono::steady_clock::time_point lastObserved_{};
+};
+
+}  // namespace broadify::meeting
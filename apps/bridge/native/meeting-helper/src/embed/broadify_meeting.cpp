@@ -0,0 +1,333 @@
+#include "broadify_meeting.h"
+
+#include "embed/meeting_engine.h"
+#include "state/program_update.h"
+#include "util/json_utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using broadify::meeting::MeetingEngine;
+using broadify::meeting::MeetingEngineMetrics;
+using broadify::meeting::Options;
+using broadify::meeting::ProgramFields;
+using broadify::meeting::ProgramSectionUpdate;
+
+struct broadify_meeting {
+  std::atomic<bool> running{true};
+  std::unique_ptr<MeetingEngine> engine;
+  std::mutex lifecycleMutex;
+  bool started = false;
+  bool stopped = false;
+};
+
+namespace {
+
+std::string jsonNumber(double value) {
+  std::ostringstream out;
+  out.precision(17);
+  out << value;
+  return out.str();
+}
+
+std::string jsonString(const char *value) {
+  return "\"" + broadify::meeting::jsonEscape(value) + "\"";
+}
+
+const char *jsonBool(int value) {
+  return value != 0 ? "true" : "false";
+}
+
+int applySectionPatch(broadify_meeting_t *meeting, const std::string &section,
+                      ProgramFields::Members members) {
+  std::vector<ProgramSectionUpdate> updates(1);
+  updates.front().section = section;
+  updates.front().members = std::move(members);
+  updates.front().patch = true;
+  broadify::meeting::applyProgramUpdates(meeting->engine->state(), updates);
+  return 0;
+}
+
+void copyMetrics(const MeetingEngineMetrics &source, broadify_meeting_metrics_t &metrics) {
+  metrics.camera_running = source.cameraRunning ? 1 : 0;
+  metrics.keyer_enabled = source.keyerEnabled ? 1 : 0;
+  metrics.program_fps = source.programFps;
+  metrics.program_frame_ms = source.programFrameMs;
+  metrics.keyer_fps = source.keyerFps;
+  metrics.keyer_processing_ms = source.keyerProcessingMs;
+  metrics.mask_age_ms = source.maskAgeMs;
+  metrics.rendered_frames = source.renderedFrames;
+  metrics.reused_frames = source.reusedFrames;
+  metrics.composed_tiles = source.composedTiles;
+  metrics.recomposed_tiles = source.recomposedTiles;
+  metrics.written_framebus_frames = source.writtenFramebusFrames;
+  metrics.dropped_frames = source.droppedFrames;
+}
+
+// Runs the body of an entry point that reports failure as -1. Nothing may
+// unwind into the C host, so exceptions (allocation, thread creation) are
+// failures too.
+template <typename Body>
+int guarded(const Body &body) {
+  try {
+    return body();
+  } catch (...) {
+    return -1;
+  }
+}
+
+// The same for entry points without a result: an exception is swallowed.
+template <typename Body>
+void guardedVoid(const Body &body) {
+  try {
+    body();
+  } catch (...) {
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t broadify_meeting_api_version(void) {
+  return BROADIFY_MEETING_API_VERSION;
+}
+
+broadify_meeting_t *broadify_meeting_create(const broadify_meeting_config_t *config) {
+  try {
+    Options options;
+    if (config != nullptr) {
+      if (config->framebus_output != 0 &&
+          (config->framebus_name == nullptr || config->framebus_name[0] == '\0')) {
+        return nullptr;
+      }
+      options.width = config->width != 0u ? config->width : options.width;
+      options.height = config->height != 0u ? config->height : options.height;
+      options.fps = config->fps != 0u ? config->fps : options.fps;
+      if (config->framebus_name != nullptr && config->framebus_name[0] != '\0') {
+        options.framebusName = config->framebus_name;
+      }
+      if (config->models_dir != nullptr) {
+        options.modelsDir = config->models_dir;
+      }
+    }
+    if (options.width % 2u != 0u || options.height % 2u != 0u) {
+      return nullptr;
+    }
+    std::unique_ptr<broadify_meeting_t> meeting(new broadify_meeting_t());
+    meeting->engine = std::make_unique<MeetingEngine>(options, meeting->running);
+    broadify::meeting::MeetingState &state = meeting->engine->state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.framebusRunning = config != nullptr && config->framebus_output != 0;
+    state.vcamRawRunning = state.framebusRunning;
+    return meeting.release();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void broadify_meeting_destroy(broadify_meeting_t *meeting) {
+  if (meeting == nullptr) {
+    return;
+  }
+  broadify_meeting_stop(meeting);
+  delete meeting;
+}
+
+int broadify_meeting_start(broadify_meeting_t *meeting) {
+  return guarded([&] {
+    if (meeting == nullptr) {
+      return -1;
+    }
+    std::lock_guard<std::mutex> lock(meeting->lifecycleMutex);
+    if (meeting->stopped) {
+      return -1;
+    }
+    if (!meeting->started) {
+      meeting->engine->start();
+      meeting->started = true;
+    }
+    return 0;
+  });
+}
+
+void broadify_meeting_stop(broadify_meeting_t *meeting) {
+  guardedVoid([&] {
+    if (meeting == nullptr) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(meeting->lifecycleMutex);
+    if (!meeting->stopped) {
+      meeting->engine->stop();
+      meeting->stopped = true;
+    }
+  });
+}
+
+int broadify_meeting_camera_start(broadify_meeting_t *meeting, int camera_index) {
+  return guarded([&] {
+    if (meeting == nullptr || camera_index < 0) {
+      return -1;
+    }
+    return meeting->engine->startCamera(camera_index) ? 0 : -1;
+  });
+}
+
+void broadify_meeting_camera_stop(broadify_meeting_t *meeting) {
+  guardedVoid([&] {
+    if (meeting != nullptr) {
+      meeting->engine->stopCamera();
+    }
+  });
+}
+
+int broadify_meeting_set_keyer(broadify_meeting_t *meeting, int enabled, const char *model) {
+  return guarded([&] {
+    if (meeting == nullptr || (model != nullptr && !broadify::meeting::isSupportedKeyerModel(model))) {
+      return -1;
+    }
+    broadify::meeting::MeetingState &state = meeting->engine->state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.keyerEnabled = enabled != 0;
+    if (model != nullptr) {
+      state.requestedKeyerModel = model;
+    }
+    broadify::meeting::markKeyerReconfigured(state);
+    return 0;
+  });
+}
+
+int broadify_meeting_set_background(broadify_meeting_t *meeting, const char *mode, const char *image_path) {
+  return guarded([&] {
+    if (meeting == nullptr || mode == nullptr || !broadify::meeting::isSupportedBackgroundMode(mode)) {
+      return -1;
+    }
+    broadify::meeting::MeetingState &state = meeting->engine->state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.backgroundMode = mode;
+    state.backgroundImagePath = image_path != nullptr ? image_path : "";
+    broadify::meeting::markProgramDirty(state);
+    return 0;
+  });
+}
+
+int broadify_meeting_set_speaker_layout(broadify_meeting_t *meeting, int enabled, const char *layout, double scale) {
+  return guarded([&] {
+    if (meeting == nullptr || !std::isfinite(scale)) {
+      return -1;
+    }
+    ProgramFields::Members members = {{"enabled", jsonBool(enabled)}, {"scale", jsonNumber(scale)}};
+    if (layout != nullptr && layout[0] != '\0') {
+      members.emplace_back("layout", jsonString(layout));
+    }
+    return applySectionPatch(meeting, "speaker_layout", std::move(members));
+  });
+}
+
+int broadify_meeting_set_camera(broadify_meeting_t *meeting, int enabled, int mirror) {
+  return guarded([&] {
+    if (meeting == nullptr) {
+      return -1;
+    }
+    return applySectionPatch(meeting, "camera", {{"enabled", jsonBool(enabled)}, {"mirror", jsonBool(mirror)}});
+  });
+}
+
+int broadify_meeting_set_cornerbug(broadify_meeting_t *meeting, int enabled, double x, double y, double size) {
+  return guarded([&] {
+    if (meeting == nullptr || !std::isfinite(x) || !std::isfinite(y) || !std::isfinite(size)) {
+      return -1;
+    }
+    return applySectionPatch(meeting, "cornerbug",
+                             {{"enabled", jsonBool(enabled)},
+                              {"x", jsonNumber(x)},
+                              {"y", jsonNumber(y)},
+                              {"size", jsonNumber(size)}});
+  });
+}
+
+int broadify_meeting_update_program(broadify_meeting_t *meeting, const char *section, const char *members_json,
+                                    int patch, uint64_t *field_revision) {
+  return guarded([&] {
+    if (meeting == nullptr || section == nullptr || members_json == nullptr ||
+        !broadify::meeting::isProgramSection(section)) {
+      return -1;
+    }
+    std::vector<ProgramSectionUpdate> updates(1);
+    updates.front().section = section;
+    updates.front().patch = patch != 0;
+    if (!broadify::meeting::splitObjectMembers(members_json, updates.front().members)) {
+      return -1;
+    }
+    const uint64_t revision = broadify::meeting::applyProgramUpdates(meeting->engine->state(), updates);
+    if (field_revision != nullptr) {
+      *field_revision = revision;
+    }
+    return 0;
+  });
+}
+
+int broadify_meeting_set_frame_callback(broadify_meeting_t *meeting, broadify_meeting_frame_callback callback,
+                                        void *user_data) {
+  return guarded([&] {
+    if (meeting == nullptr) {
+      return -1;
+    }
+    if (callback == nullptr) {
+      meeting->engine->setProgramFrameCallback({});
+      return 0;
+    }
+    meeting->engine->setProgramFrameCallback(
+        [callback, user_data](const uint8_t *rgba, uint32_t width, uint32_t height, uint64_t timestampNs) {
+          broadify_meeting_frame_t frame;
+          frame.rgba = rgba;
+          frame.size = static_cast<size_t>(width) * height * 4u;
+          frame.width = width;
+          frame.height = height;
+          frame.timestamp_ns = timestampNs;
+          callback(&frame, user_data);
+        });
+    return 0;
+  });
+}
+
+int broadify_meeting_set_metrics_callback(broadify_meeting_t *meeting, broadify_meeting_metrics_callback callback,
+                                          void *user_data, uint32_t interval_ms) {
+  return guarded([&] {
+    if (meeting == nullptr) {
+      return -1;
+    }
+    const std::chrono::milliseconds interval(interval_ms != 0u ? interval_ms : 1000u);
+    if (callback == nullptr) {
+      meeting->engine->setMetricsCallback({}, interval);
+      return 0;
+    }
+    meeting->engine->setMetricsCallback(
+        [callback, user_data](const MeetingEngineMetrics &source) {
+          broadify_meeting_metrics_t metrics;
+          copyMetrics(source, metrics);
+          callback(&metrics, user_data);
+        },
+        interval);
+    return 0;
+  });
+}
+
+int broadify_meeting_get_metrics(broadify_meeting_t *meeting, broadify_meeting_metrics_t *metrics) {
+  return guarded([&] {
+    if (meeting == nullptr || metrics == nullptr) {
+      return -1;
+    }
+    copyMetrics(meeting->engine->metrics(), *metrics);
+    return 0;
+  });
+}
+
+}  // extern "C"
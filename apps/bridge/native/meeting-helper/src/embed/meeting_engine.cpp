@@ -0,0 +1,158 @@
+#include "embed/meeting_engine.h"
+
+#include "state/program_update.h"
+#include "util/thread_roles.h"
+
+#include <utility>
+
+namespace broadify::meeting {
+
+MeetingEngine::MeetingEngine(const Options &options, std::atomic<bool> &running)
+    : options_(options),
+      running_(running),
+      camera_(createCameraSource()),
+      capacity_(options) {
+  state_.output.width = options.width;
+  state_.output.height = options.height;
+  state_.output.fps = options.fps == 0 ? 30u : options.fps;
+  state_.requestedOutput = state_.output;
+}
+
+MeetingEngine::~MeetingEngine() {
+  stop();
+}
+
+void MeetingEngine::start() {
+  if (frames_.joinable()) {
+    return;
+  }
+  frames_ = std::thread(
+      runFramePipeline, std::cref(options_), std::ref(state_), std::ref(*camera_), std::ref(previewFrames_),
+      std::ref(recorder_), std::ref(capacity_), std::ref(running_),
+      ProgramFrameSink([this](const uint8_t *rgba, uint32_t width, uint32_t height, uint64_t timestampNs) {
+        deliverProgramFrame(rgba, width, height, timestampNs);
+      }));
+  std::lock_guard<std::mutex> lock(metricsMutex_);
+  started_ = true;
+  if (metricsCallback_ && !metricsThread_.joinable()) {
+    metricsThread_ = std::thread(&MeetingEngine::runMetrics, this);
+  }
+}
+
+void MeetingEngine::stop() {
+  running_.store(false);
+  camera_->stop();
+  previewFrames_.clear();
+  {
+    std::lock_guard<std::mutex> lock(state_.mutex);
+    state_.framebusRunning = false;
+    state_.vcamRawRunning = false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    metricsWake_.notify_all();
+  }
+  // The frame pipeline checks `running` and releases the FrameBus shared
+  // memory on its way out - wait for it.
+  if (frames_.joinable()) {
+    frames_.join();
+  }
+  std::thread metricsThread;
+  {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    metricsThread.swap(metricsThread_);
+  }
+  if (metricsThread.joinable()) {
+    metricsThread.join();
+  }
+}
+
+bool MeetingEngine::startCamera(int cameraIndex) {
+  const bool started = camera_->start(cameraIndex, options_.width, options_.height, options_.fps);
+  std::lock_guard<std::mutex> lock(state_.mutex);
+  state_.cameraRunning = started;
+  state_.activeCameraIndex = started ? camera_->activeCameraIndex() : -1;
+  markProgramDirty(state_);
+  return started;
+}
+
+void MeetingEngine::stopCamera() {
+  camera_->stop();
+  previewFrames_.clear();
+  std::lock_guard<std::mutex> lock(state_.mutex);
+  state_.cameraRunning = false;
+  state_.activeCameraIndex = -1;
+  markProgramDirty(state_);
+}
+
+void MeetingEngine::setProgramFrameCallback(ProgramFrameSink callback) {
+  const bool active = static_cast<bool>(callback);
+  {
+    std::lock_guard<std::mutex> lock(frameCallbackMutex_);
+    frameCallback_ = std::move(callback);
+  }
+  std::lock_guard<std::mutex> lock(state_.mutex);
+  state_.embedFrameClientCount = active ? 1 : 0;
+  // A new consumer gets a frame right away instead of at the next change.
+  markProgramDirty(state_);
+}
+
+void MeetingEngine::setMetricsCallback(MetricsCallback callback, std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(metricsMutex_);
+  metricsCallback_ = std::move(callback);
+  metricsInterval_ = interval.count() > 0 ? interval : std::chrono::milliseconds(1000);
+  metricsWake_.notify_all();
+  // The thread only exists once someone listens; the helper never does.
+  if (metricsCallback_ && started_ && running_.load() && !metricsThread_.joinable()) {
+    metricsThread_ = std::thread(&MeetingEngine::runMetrics, this);
+  }
+}
+
+MeetingEngineMetrics MeetingEngine::metrics() const {
+  MeetingEngineMetrics metrics;
+  std::lock_guard<std::mutex> lock(state_.mutex);
+  metrics.cameraRunning = state_.cameraRunning;
+  metrics.keyerEnabled = state_.keyerEnabled;
+  metrics.pipelineMode = state_.pipelineMode;
+  metrics.compositorBackend = state_.compositorBackend;
+  metrics.activeKeyer = state_.activeKeyer;
+  metrics.programFps = state_.keyerMetrics.programFps;
+  metrics.programFrameMs = state_.keyerMetrics.programFrameMs;
+  metrics.keyerFps = state_.keyerMetrics.keyerFps;
+  metrics.keyerProcessingMs = state_.keyerMetrics.keyerProcessingMs;
+  metrics.maskAgeMs = state_.keyerMetrics.maskAgeMs;
+  metrics.renderedFrames = state_.renderedFrames;
+  metrics.reusedFrames = state_.reusedFrames;
+  metrics.composedTiles = state_.composedTiles;
+  metrics.recomposedTiles = state_.recomposedTiles;
+  metrics.writtenFramebusFrames = state_.writtenFramebusFrames;
+  metrics.droppedFrames = state_.keyerMetrics.droppedFrames;
+  return metrics;
+}
+
+void MeetingEngine::deliverProgramFrame(const uint8_t *rgba, uint32_t width, uint32_t height,
+                                        uint64_t timestampNs) {
+  std::lock_guard<std::mutex> lock(frameCallbackMutex_);
+  if (frameCallback_) {
+    frameCallback_(rgba, width, height, timestampNs);
+  }
+}
+
+void MeetingEngine::runMetrics() {
+  ScopedThreadRole role("metrics");
+  std::unique_lock<std::mutex> lock(metricsMutex_);
+  auto nextAt = std::chrono::steady_clock::now() + metricsInterval_;
+  while (running_.load()) {
+    if (metricsWake_.wait_until(lock, nextAt) != std::cv_status::timeout) {
+      // Stopped, or the callback or its interval changed.
+      nextAt = std::chrono::steady_clock::now() + metricsInterval_;
+      continue;
+    }
+    nextAt += metricsInterval_;
+    if (metricsCallback_ && running_.load()) {
+      metricsCallback_(metrics());
+    }
+  }
+}
+
+}  // namespace broadify::meeting
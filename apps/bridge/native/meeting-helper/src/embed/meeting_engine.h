@@ -0,0 +1,115 @@
+#pragma once
+
+#include "capture/camera_source.h"
+#include "common/options.h"
+#include "pipeline/capacity_benchmark.h"
+#include "pipeline/frame_pipeline.h"
+#include "preview/preview_frame_store.h"
+#include "recorder/meeting_recorder.h"
+#include "state/meeting_state.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace broadify::meeting {
+
+// Typed snapshot of the counters state.get reports, for in-process hosts.
+struct MeetingEngineMetrics {
+  bool cameraRunning = false;
+  bool keyerEnabled = false;
+  std::string pipelineMode;
+  std::string compositorBackend;
+  std::string activeKeyer;
+  double programFps = -1.0;
+  double programFrameMs = -1.0;
+  double keyerFps = -1.0;
+  double keyerProcessingMs = -1.0;
+  double maskAgeMs = -1.0;
+  uint64_t renderedFrames = 0;
+  uint64_t reusedFrames = 0;
+  uint64_t composedTiles = 0;
+  uint64_t recomposedTiles = 0;
+  uint64_t writtenFramebusFrames = 0;
+  uint64_t droppedFrames = 0;
+};
+
+// The meeting pipeline as a component: state, camera, keyer, compositor and
+// the FrameBus output, driven by the frame pipeline thread. The helper
+// process wraps it with its IPC servers (control socket, MJPEG, raw frames);
+// the C API in broadify_meeting.h wraps it for hosts that embed the pipeline
+// and talk to it directly.
+//
+// `running` (initially true) is shared with whatever else the owner runs
+// around the engine (servers, signal handlers); the engine winds down once it
+// is cleared, and stop() clears it.
+class MeetingEngine {
+ public:
+  using MetricsCallback = std::function<void(const MeetingEngineMetrics &metrics)>;
+
+  MeetingEngine(const Options &options, std::atomic<bool> &running);
+  ~MeetingEngine();
+
+  MeetingEngine(const MeetingEngine &) = delete;
+  MeetingEngine &operator=(const MeetingEngine &) = delete;
+
+  // Starts the frame pipeline (and the metrics thread). No-op when started.
+  void start();
+  // Stops the camera and the pipeline and waits for the pipeline to release
+  // the FrameBus. Safe to call more than once.
+  void stop();
+
+  const Options &options() const { return options_; }
+  MeetingState &state() { return state_; }
+  CameraSource &camera() { return *camera_; }
+  PreviewFrameStore &previewFrames() { return previewFrames_; }
+  MeetingRecorder &recorder() { return recorder_; }
+  CapacityBenchmark &capacity() { return capacity_; }
+  std::atomic<bool> &running() { return running_; }
+
+  // Same transitions as camera.start / camera.stop.
+  bool startCamera(int cameraIndex);
+  void stopCamera();
+
+  // Installs (or, with an empty function, removes) the program frame
+  // callback; see ProgramFrameSink. Once this returns, a removed callback is
+  // no longer running and will not be called again, so it must not be
+  // called from inside the callback.
+  void setProgramFrameCallback(ProgramFrameSink callback);
+  // Calls `callback` every `interval` on the engine's metrics thread while
+  // the engine runs; an empty function removes it.
+  void setMetricsCallback(MetricsCallback callback, std::chrono::milliseconds interval);
+  MeetingEngineMetrics metrics() const;
+
+ private:
+  void deliverProgramFrame(const uint8_t *rgba, uint32_t width, uint32_t height, uint64_t timestampNs);
+  void runMetrics();
+
+  const Options options_;
+  std::atomic<bool> &running_;
+  MeetingState state_;
+  std::unique_ptr<CameraSource> camera_;
+  PreviewFrameStore previewFrames_;
+  MeetingRecorder recorder_;
+  CapacityBenchmark capacity_;
+
+  std::mutex frameCallbackMutex_;
+  ProgramFrameSink frameCallback_;
+
+  mutable std::mutex metricsMutex_;
+  std::condition_variable metricsWake_;
+  MetricsCallback metricsCallback_;
+  std::chrono::milliseconds metricsInterval_{1000};
+  bool started_ = false;
+
+  std::thread frames_;
+  std::thread metricsThread_;
+};
+
+}  // namespace broadify::meeting
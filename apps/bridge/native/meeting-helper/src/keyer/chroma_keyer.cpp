@@ -0,0 +1,346 @@
+#include "keyer/chroma_keyer.h"
+
+#include "util/simd.h"
+#include "util/worker_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace broadify::meeting {
+namespace {
+
+// Full-range BT.601 chroma, as camera RGBA is full range.
+constexpr float kCbR = -0.168736f;
+constexpr float kCbG = -0.331264f;
+constexpr float kCbB = 0.5f;
+constexpr float kCrR = 0.5f;
+constexpr float kCrG = -0.418688f;
+constexpr float kCrB = -0.081312f;
+// Tolerance and softness are fractions of the largest Cb or Cr excursion.
+constexpr float kChromaRange = 128.0f;
+constexpr float kMinSoftness = 1.0f;
+// Frames smaller than this are not worth waking workers for.
+constexpr uint64_t kBandedMinPixels = 256u * 256u;
+constexpr uint32_t kMinBandRows = 32;
+
+struct KeyParams {
+  float keyCb = 0.0f;
+  float keyCr = 0.0f;
+  float inner = 0.0f;  // chroma distance that is still fully keyed
+  float scale = 0.0f;  // alpha per unit of distance past `inner`
+};
+
+// Spill is the chroma component along the key hue. Both the projection and
+// its removal are linear in RGB, so they fold into per-channel weights; luma
+// is preserved.
+struct SpillParams {
+  float projR = 0.0f;
+  float projG = 0.0f;
+  float projB = 0.0f;
+  float gainR = 0.0f;
+  float gainG = 0.0f;
+  float gainB = 0.0f;
+  float strength = 0.0f;
+};
+
+KeyParams keyParams(const ChromaKeySettings &settings) {
+  const float r = settings.keyRed;
+  const float g = settings.keyGreen;
+  const float b = settings.keyBlue;
+  KeyParams params;
+  params.keyCb = r * kCbR + g * kCbG + b * kCbB;
+  params.keyCr = r * kCrR + g * kCrG + b * kCrB;
+  params.inner = static_cast<float>(std::clamp(settings.tolerance, 0.0, 2.0)) * kChromaRange;
+  const float softness =
+      std::max(static_cast<float>(std::clamp(settings.softness, 0.0, 2.0)) * kChromaRange, kMinSoftness);
+  params.scale = 255.0f / softness;
+  return params;
+}
+
+SpillParams spillParams(const ChromaKeySettings &settings) {
+  const KeyParams key = keyParams(settings);
+  const float length = std::sqrt(key.keyCb * key.keyCb + key.keyCr * key.keyCr);
+  SpillParams params;
+  if (length < 1.0f) {
+    return params;  // grey key colour has no hue to remove
+  }
+  const float dirCb = key.keyCb / length;
+  const float dirCr = key.keyCr / length;
+  params.projR = kCbR * dirCb + kCrR * dirCr;
+  params.projG = kCbG * dirCb + kCrG * dirCr;
+  params.projB = kCbB * dirCb + kCrB * dirCr;
+  params.gainR = -1.402f * dirCr;
+  params.gainG = 0.344136f * dirCb + 0.714136f * dirCr;
+  params.gainB = -1.772f * dirCb;
+  params.strength = static_cast<float>(std::clamp(settings.spillSuppression, 0.0, 1.0));
+  return params;
+}
+
+inline uint8_t alphaScalar(float r, float g, float b, const KeyParams &p) {
+  const float dx = r * kCbR + g * kCbG + b * kCbB - p.keyCb;
+  const float dy = r * kCrR + g * kCrG + b * kCrB - p.keyCr;
+  const float distance = std::sqrt(dx * dx + dy * dy);
+  return static_cast<uint8_t>(std::clamp((distance - p.inner) * p.scale, 0.0f, 255.0f) + 0.5f);
+}
+
+inline void spillScalar(uint8_t *px, const SpillParams &p) {
+  const float r = px[0];
+  const float g = px[1];
+  const float b = px[2];
+  const float removed = std::max(r * p.projR + g * p.projG + b * p.projB, 0.0f) * p.strength;
+  px[0] = static_cast<uint8_t>(std::clamp(r + removed * p.gainR, 0.0f, 255.0f) + 0.5f);
+  px[1] = static_cast<uint8_t>(std::clamp(g + removed * p.gainG, 0.0f, 255.0f) + 0.5f);
+  px[2] = static_cast<uint8_t>(std::clamp(b + removed * p.gainB, 0.0f, 255.0f) + 0.5f);
+}
+
+#if defined(BROADIFY_SIMD_SSE2)
+inline void channelsSse2(__m128i px, __m128 &r, __m128 &g, __m128 &b) {
+  const __m128i byteMask = _mm_set1_epi32(0xFF);
+  r = _mm_cvtepi32_ps(_mm_and_si128(px, byteMask));
+  g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), byteMask));
+  b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), byteMask));
+}
+
+// Four RGBA pixels -> four int32 alphas.
+inline __m128i alphaFourSse2(__m128i px, const KeyParams &p) {
+  __m128 r;
+  __m128 g;
+  __m128 b;
+  channelsSse2(px, r, g, b);
+  const __m128 dx = _mm_sub_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(kCbR)), _mm_mul_ps(g, _mm_set1_ps(kCbG))),
+                 _mm_mul_ps(b, _mm_set1_ps(kCbB))),
+      _mm_set1_ps(p.keyCb));
+  const __m128 dy = _mm_sub_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(kCrR)), _mm_mul_ps(g, _mm_set1_ps(kCrG))),
+                 _mm_mul_ps(b, _mm_set1_ps(kCrB))),
+      _mm_set1_ps(p.keyCr));
+  const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+  const __m128 alpha = _mm_min_ps(
+      _mm_max_ps(_mm_mul_ps(_mm_sub_ps(distance, _mm_set1_ps(p.inner)), _mm_set1_ps(p.scale)), _mm_setzero_ps()),
+      _mm_set1_ps(255.0f));
+  return _mm_cvttps_epi32(_mm_add_ps(alpha, _mm_set1_ps(0.5f)));
+}
+
+inline __m128i spillFourSse2(__m128i px, const SpillParams &p) {
+  __m128 r;
+  __m128 g;
+  __m128 b;
+  channelsSse2(px, r, g, b);
+  const __m128 projection =
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(p.projR)), _mm_mul_ps(g, _mm_set1_ps(p.projG))),
+                 _mm_mul_ps(b, _mm_set1_ps(p.projB)));
+  const __m128 removed = _mm_mul_ps(_mm_max_ps(projection, _mm_setzero_ps()), _mm_set1_ps(p.strength));
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 max = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const auto channel = [&](__m128 value, float gain) {
+    const __m128 adjusted = _mm_add_ps(value, _mm_mul_ps(removed, _mm_set1_ps(gain)));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(adjusted, zero), max), half));
+  };
+  const __m128i alpha = _mm_and_si128(px, _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+  return _mm_or_si128(_mm_or_si128(channel(r, p.gainR), _mm_slli_epi32(channel(g, p.gainG), 8)),
+                      _mm_or_si128(_mm_slli_epi32(channel(b, p.gainB), 16), alpha));
+}
+#endif
+
+#if defined(BROADIFY_SIMD_NEON)
+inline void widenNeon(uint8x16_t value, float32x4_t out[4]) {
+  const uint16x8_t lo = vmovl_u8(vget_low_u8(value));
+  const uint16x8_t hi = vmovl_u8(vget_high_u8(value));
+  out[0] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo)));
+  out[1] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo)));
+  out[2] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi)));
+  out[3] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi)));
+}
+
+// Inputs must already be clamped to [0, 255].
+inline uint8x16_t narrowNeon(const float32x4_t in[4]) {
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const uint16x8_t lo = vcombine_u16(vmovn_u32(vcvtq_u32_f32(vaddq_f32(in[0], half))),
+                                     vmovn_u32(vcvtq_u32_f32(vaddq_f32(in[1], half))));
+  const uint16x8_t hi = vcombine_u16(vmovn_u32(vcvtq_u32_f32(vaddq_f32(in[2], half))),
+                                     vmovn_u32(vcvtq_u32_f32(vaddq_f32(in[3], half))));
+  return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+inline float32x4_t clampByteNeon(float32x4_t value) {
+  return vminq_f32(vmaxq_f32(value, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+}
+
+// sqrt(x) as x * rsqrt(x) with one Newton step; ARMv7 NEON has no vsqrtq.
+inline float32x4_t sqrtNeon(float32x4_t value) {
+  const float32x4_t safe = vmaxq_f32(value, vdupq_n_f32(1e-6f));
+  float32x4_t estimate = vrsqrteq_f32(safe);
+  estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(safe, estimate), estimate));
+  return vmulq_f32(safe, estimate);
+}
+#endif
+
+template <typename Body>
+void runInBands(uint32_t width, uint32_t height, const Body &body) {
+  WorkerPool &pool = sharedWorkerPool();
+  const uint32_t bands = static_cast<uint64_t>(width) * height < kBandedMinPixels
+      ? 1u
+      : std::clamp(height / kMinBandRows, 1u, static_cast<uint32_t>(pool.workerCount()) + 1u);
+  if (bands <= 1u) {
+    body(0u, height);
+    return;
+  }
+  pool.parallelFor(bands, [&](uint32_t band) {
+    body(static_cast<uint32_t>(static_cast<uint64_t>(height) * band / bands),
+         static_cast<uint32_t>(static_cast<uint64_t>(height) * (band + 1u) / bands));
+  });
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+void chromaKeyAlpha(const uint8_t *rgba, uint8_t *alpha, size_t pixels,
+                    const ChromaKeySettings &settings) {
+  const KeyParams params = keyParams(settings);
+  size_t i = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+  for (; i + 8u <= pixels; i += 8u) {
+    const __m128i lo = alphaFourSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4u)), params);
+    const __m128i hi =
+        alphaFourSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4u + 16u)), params);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(alpha + i),
+                     _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128()));
+  }
+#elif defined(BROADIFY_SIMD_NEON)
+  const float32x4_t keyCb = vdupq_n_f32(params.keyCb);
+  const float32x4_t keyCr = vdupq_n_f32(params.keyCr);
+  const float32x4_t inner = vdupq_n_f32(params.inner);
+  const float32x4_t scale = vdupq_n_f32(params.scale);
+  for (; i + 16u <= pixels; i += 16u) {
+    const uint8x16x4_t px = vld4q_u8(rgba + i * 4u);
+    float32x4_t r[4];
+    float32x4_t g[4];
+    float32x4_t b[4];
+    widenNeon(px.val[0], r);
+    widenNeon(px.val[1], g);
+    widenNeon(px.val[2], b);
+    float32x4_t out[4];
+    for (int q = 0; q < 4; ++q) {
+      float32x4_t dx = vmulq_n_f32(r[q], kCbR);
+      dx = vmlaq_n_f32(dx, g[q], kCbG);
+      dx = vsubq_f32(vmlaq_n_f32(dx, b[q], kCbB), keyCb);
+      float32x4_t dy = vmulq_n_f32(r[q], kCrR);
+      dy = vmlaq_n_f32(dy, g[q], kCrG);
+      dy = vsubq_f32(vmlaq_n_f32(dy, b[q], kCrB), keyCr);
+      const float32x4_t distance = sqrtNeon(vmlaq_f32(vmulq_f32(dx, dx), dy, dy));
+      out[q] = clampByteNeon(vmulq_f32(vsubq_f32(distance, inner), scale));
+    }
+    vst1q_u8(alpha + i, narrowNeon(out));
+  }
+#endif
+  for (; i < pixels; ++i) {
+    const uint8_t *px = rgba + i * 4u;
+    alpha[i] = alphaScalar(px[0], px[1], px[2], params);
+  }
+}
+
+void suppressChromaSpill(uint8_t *rgba, size_t pixels, const ChromaKeySettings &settings) {
+  const SpillParams params = spillParams(settings);
+  if (params.strength <= 0.0f) {
+    return;
+  }
+  size_t i = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+  for (; i + 4u <= pixels; i += 4u) {
+    __m128i *px = reinterpret_cast<__m128i *>(rgba + i * 4u);
+    _mm_storeu_si128(px, spillFourSse2(_mm_loadu_si128(px), params));
+  }
+#elif defined(BROADIFY_SIMD_NEON)
+  for (; i + 16u <= pixels; i += 16u) {
+    uint8x16x4_t px = vld4q_u8(rgba + i * 4u);
+    float32x4_t r[4];
+    float32x4_t g[4];
+    float32x4_t b[4];
+    widenNeon(px.val[0], r);
+    widenNeon(px.val[1], g);
+    widenNeon(px.val[2], b);
+    for (int q = 0; q < 4; ++q) {
+      float32x4_t projection = vmulq_n_f32(r[q], params.projR);
+      projection = vmlaq_n_f32(projection, g[q], params.projG);
+      projection = vmlaq_n_f32(projection, b[q], params.projB);
+      const float32x4_t removed = vmulq_n_f32(vmaxq_f32(projection, vdupq_n_f32(0.0f)), params.strength);
+      r[q] = clampByteNeon(vmlaq_n_f32(r[q], removed, params.gainR));
+      g[q] = clampByteNeon(vmlaq_n_f32(g[q], removed, params.gainG));
+      b[q] = clampByteNeon(vmlaq_n_f32(b[q], removed, params.gainB));
+    }
+    px.val[0] = narrowNeon(r);
+    px.val[1] = narrowNeon(g);
+    px.val[2] = narrowNeon(b);
+    vst4q_u8(rgba + i * 4u, px);
+  }
+#endif
+  for (; i < pixels; ++i) {
+    spillScalar(rgba + i * 4u, params);
+  }
+}
+
+void suppressChromaSpill(VideoFrame &frame, const ChromaKeySettings &settings) {
+  const size_t rowBytes = static_cast<size_t>(frame.width) * 4u;
+  if (settings.spillSuppression <= 0.0 || frame.rgba.size() < rowBytes * frame.height) {
+    return;
+  }
+  runInBands(frame.width, frame.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+    suppressChromaSpill(frame.rgba.data() + rowBegin * rowBytes,
+                        static_cast<size_t>(rowEnd - rowBegin) * frame.width, settings);
+  });
+}
+
+const char *chromaKeyerSimdPath() {
+#if defined(BROADIFY_SIMD_SSE2)
+  return "sse2";
+#elif defined(BROADIFY_SIMD_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+KeyerResult ChromaKeyer::apply(const VideoFrame &input, const KeyerSettings &settings) {
+  KeyerResult result;
+  KeyerStatus &status = result.status;
+  status.backend = "chroma_key";
+  status.provider = chromaKeyerSimdPath();
+  status.qualityMode = settings.qualityMode;
+  const size_t pixels = static_cast<size_t>(input.width) * input.height;
+  if (pixels == 0u || input.rgba.size() < pixels * 4u) {
+    status.activeKeyer = "passthrough";
+    status.fallbackActive = true;
+    status.fallbackReason = "invalid_frame";
+    return result;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  AlphaMask &mask = result.mask;
+  mask.width = input.width;
+  mask.height = input.height;
+  mask.timestampNs = input.timestampNs;
+  mask.alpha.resize(pixels);
+  runInBands(input.width, input.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+    const size_t first = static_cast<size_t>(rowBegin) * input.width;
+    chromaKeyAlpha(input.rgba.data() + first * 4u, mask.alpha.data() + first,
+                   static_cast<size_t>(rowEnd - rowBegin) * input.width, settings.chroma);
+  });
+  const auto end = std::chrono::steady_clock::now();
+
+  status.activeKeyer = "chroma_key";
+  status.fallbackActive = false;
+  status.fallbackReason.clear();
+  status.inferenceMs = elapsedMs(start, end);
+  status.metrics.maskApplyMs = status.inferenceMs;
+  status.metrics.maskWidth = mask.width;
+  status.metrics.maskHeight = mask.height;
+  return result;
+}
+
+}  // namespace broadify::meeting
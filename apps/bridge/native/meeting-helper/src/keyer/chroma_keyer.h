@@ -0,0 +1,33 @@
+#pragma once
+
+#include "keyer/keyer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace broadify::meeting {
+
+// Colour-difference keyer for green/blue screen studios. Produces a
+// full-resolution mask from the chroma distance of every pixel to the key
+// colour in one SIMD pass (SSE2 / NEON, scalar elsewhere), split into row
+// bands on the shared worker pool. No model, no downscale, no warm-up.
+class ChromaKeyer : public Keyer {
+ public:
+  KeyerResult apply(const VideoFrame &input, const KeyerSettings &settings) override;
+};
+
+// Kernels over `pixels` consecutive RGBA8 pixels. chromaKeyAlpha writes one
+// alpha byte per pixel; suppressChromaSpill pulls the key hue out of the
+// colour in place and leaves the alpha byte untouched. Spill suppression is
+// not idempotent below strength 1, so apply it once per camera frame.
+void chromaKeyAlpha(const uint8_t *rgba, uint8_t *alpha, size_t pixels,
+                    const ChromaKeySettings &settings);
+void suppressChromaSpill(uint8_t *rgba, size_t pixels, const ChromaKeySettings &settings);
+
+// Banded whole-frame spill suppression for the program path.
+void suppressChromaSpill(VideoFrame &frame, const ChromaKeySettings &settings);
+
+// "sse2", "neon" or "scalar"; reported as the keyer provider.
+const char *chromaKeyerSimdPath();
+
+}  // namespace broadify::meeting
@@ -0,0 +1,263 @@
+#include "keyer/clean_plate_keyer.h"
+
+#include "util/image_resample.h"
+#include "util/simd.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace broadify::meeting {
+namespace {
+
+// Keying runs on an area-downscaled plane no larger than this; the area
+// filter also averages away most sensor noise.
+constexpr uint32_t kWorkMaxWidth = 480;
+constexpr uint32_t kWorkMaxHeight = 270;
+// The global offset is the 10th percentile of the frame's distance above
+// the median background noise: a room is never 90% presenter, so a rise
+// there means exposure or white balance moved. Capped so a close-up cannot
+// key itself out.
+constexpr uint32_t kGlobalPercentile = 10;
+constexpr uint16_t kMaxGlobalOffset = 96;
+
+uint16_t rampScale(uint16_t softness) {
+  // Largest scale with softness * scale <= 0xFFFF, so the ramp tops out at
+  // exactly 255 in 16-bit lanes.
+  return static_cast<uint16_t>((255u * 256u + softness - 1u) / softness);
+}
+
+inline void differencePixel(const uint8_t *px, uint8_t *plate, uint8_t *noise, uint8_t *alpha,
+                            uint8_t *difference, uint16_t low, uint16_t softness, uint16_t scale,
+                            bool updatePlate) {
+  const int distance = std::abs(px[0] - plate[0]) + std::abs(px[1] - plate[1]) + std::abs(px[2] - plate[2]);
+  const int threshold = std::min(low + 2 * *noise, 0xFFFF);
+  const int over = std::clamp(distance - threshold, 0, static_cast<int>(softness));
+  const uint8_t value = static_cast<uint8_t>(((over * scale) & 0xFFFF) >> 8);
+  const uint8_t clamped = static_cast<uint8_t>(std::min(distance, 255));
+  *alpha = value;
+  *difference = clamped;
+  if (updatePlate && value == 0u) {
+    for (int c = 0; c < 4; ++c) {
+      plate[c] = static_cast<uint8_t>(plate[c] + (px[c] > plate[c]) - (px[c] < plate[c]));
+    }
+    *noise = static_cast<uint8_t>(*noise + (clamped > *noise) - (clamped < *noise));
+  }
+}
+
+#if defined(BROADIFY_SIMD_SSE2)
+inline __m128i absDiffU8(__m128i a, __m128i b) {
+  return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+// Per-pixel R + G + B of four RGBA pixels, as int32 lanes.
+inline __m128i sumRgb(__m128i value) {
+  const __m128i byteMask = _mm_set1_epi32(0xFF);
+  return _mm_add_epi32(_mm_add_epi32(_mm_and_si128(value, byteMask),
+                                     _mm_and_si128(_mm_srli_epi32(value, 8), byteMask)),
+                       _mm_and_si128(_mm_srli_epi32(value, 16), byteMask));
+}
+
+// Moves `plate` one level towards `frame` in every byte where `mask` is set.
+inline __m128i stepTowards(__m128i plate, __m128i frame, __m128i mask) {
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i up = _mm_and_si128(_mm_min_epu8(_mm_subs_epu8(frame, plate), one), mask);
+  const __m128i down = _mm_and_si128(_mm_min_epu8(_mm_subs_epu8(plate, frame), one), mask);
+  return _mm_subs_epu8(_mm_adds_epu8(plate, up), down);
+}
+#endif
+
+#if defined(BROADIFY_SIMD_NEON)
+inline uint8x8_t stepTowardsNeon(uint8x8_t plate, uint8x8_t frame, uint8x8_t mask) {
+  const uint8x8_t one = vdup_n_u8(1);
+  const uint8x8_t up = vand_u8(vmin_u8(vqsub_u8(frame, plate), one), mask);
+  const uint8x8_t down = vand_u8(vmin_u8(vqsub_u8(plate, frame), one), mask);
+  return vqsub_u8(vqadd_u8(plate, up), down);
+}
+#endif
+
+double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+uint32_t percentile(const std::array<uint32_t, 256> &histogram, size_t count, uint32_t percent) {
+  const size_t target = count * percent / 100u;
+  size_t seen = 0;
+  for (uint32_t value = 0; value < histogram.size(); ++value) {
+    seen += histogram[value];
+    if (seen > target) {
+      return value;
+    }
+  }
+  return 255u;
+}
+
+}  // namespace
+
+void cleanPlateDifferenceRow(const uint8_t *rgba, uint8_t *plate, uint8_t *noise,
+                             uint8_t *alpha, uint8_t *difference, size_t pixels,
+                             uint16_t low, uint16_t softness, bool updatePlate) {
+  softness = std::max<uint16_t>(softness, 1u);
+  const uint16_t scale = rampScale(softness);
+  size_t i = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lowV = _mm_set1_epi16(static_cast<short>(low));
+  const __m128i softV = _mm_set1_epi16(static_cast<short>(softness));
+  const __m128i scaleV = _mm_set1_epi16(static_cast<short>(scale));
+  const __m128i max8 = _mm_set1_epi16(255);
+  for (; i + 8u <= pixels; i += 8u) {
+    const __m128i f0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4u));
+    const __m128i f1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4u + 16u));
+    __m128i *plateAt = reinterpret_cast<__m128i *>(plate + i * 4u);
+    const __m128i p0 = _mm_loadu_si128(plateAt);
+    const __m128i p1 = _mm_loadu_si128(plateAt + 1);
+    const __m128i distance = _mm_packs_epi32(sumRgb(absDiffU8(f0, p0)), sumRgb(absDiffU8(f1, p1)));
+    __m128i noise16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(noise + i)), zero);
+    const __m128i threshold = _mm_adds_epu16(lowV, _mm_slli_epi16(noise16, 1));
+    const __m128i over = _mm_min_epi16(_mm_subs_epu16(distance, threshold), softV);
+    const __m128i value = _mm_srli_epi16(_mm_mullo_epi16(over, scaleV), 8);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(alpha + i), _mm_packus_epi16(value, value));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(difference + i), _mm_packus_epi16(distance, distance));
+    if (!updatePlate) {
+      continue;
+    }
+    const __m128i background = _mm_cmpeq_epi16(value, zero);
+    _mm_storeu_si128(plateAt, stepTowards(p0, f0, _mm_unpacklo_epi16(background, background)));
+    _mm_storeu_si128(plateAt + 1, stepTowards(p1, f1, _mm_unpackhi_epi16(background, background)));
+    // Compare results are -1, so subtracting steps up and adding steps down.
+    const __m128i clamped = _mm_min_epi16(distance, max8);
+    noise16 = _mm_sub_epi16(noise16, _mm_and_si128(_mm_cmpgt_epi16(clamped, noise16), background));
+    noise16 = _mm_add_epi16(noise16, _mm_and_si128(_mm_cmplt_epi16(clamped, noise16), background));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(noise + i), _mm_packus_epi16(noise16, noise16));
+  }
+#elif defined(BROADIFY_SIMD_NEON)
+  const uint16x8_t lowV = vdupq_n_u16(low);
+  const uint16x8_t softV = vdupq_n_u16(softness);
+  const uint16x8_t scaleV = vdupq_n_u16(scale);
+  for (; i + 8u <= pixels; i += 8u) {
+    const uint8x8x4_t frame = vld4_u8(rgba + i * 4u);
+    uint8x8x4_t platePx = vld4_u8(plate + i * 4u);
+    const uint16x8_t distance = vaddw_u8(vaddl_u8(vabd_u8(frame.val[0], platePx.val[0]),
+                                                  vabd_u8(frame.val[1], platePx.val[1])),
+                                         vabd_u8(frame.val[2], platePx.val[2]));
+    uint8x8_t noise8 = vld1_u8(noise + i);
+    const uint16x8_t threshold = vqaddq_u16(lowV, vshll_n_u8(noise8, 1));
+    const uint16x8_t over = vminq_u16(vqsubq_u16(distance, threshold), softV);
+    const uint16x8_t value = vshrq_n_u16(vmulq_u16(over, scaleV), 8);
+    const uint8x8_t value8 = vmovn_u16(value);
+    const uint8x8_t clamped = vqmovn_u16(distance);
+    vst1_u8(alpha + i, value8);
+    vst1_u8(difference + i, clamped);
+    if (!updatePlate) {
+      continue;
+    }
+    const uint8x8_t background = vceq_u8(value8, vdup_n_u8(0));
+    for (int c = 0; c < 4; ++c) {
+      platePx.val[c] = stepTowardsNeon(platePx.val[c], frame.val[c], background);
+    }
+    vst4_u8(plate + i * 4u, platePx);
+    noise8 = stepTowardsNeon(noise8, clamped, background);
+    vst1_u8(noise + i, noise8);
+  }
+#endif
+  for (; i < pixels; ++i) {
+    differencePixel(rgba + i * 4u, plate + i * 4u, noise + i, alpha + i, difference + i, low, softness,
+                    scale, updatePlate);
+  }
+}
+
+KeyerResult CleanPlateKeyer::apply(const VideoFrame &input, const KeyerSettings &settings) {
+  KeyerResult result;
+  KeyerStatus &status = result.status;
+  status.backend = "clean_plate";
+#if defined(BROADIFY_SIMD_SSE2)
+  status.provider = "sse2";
+#elif defined(BROADIFY_SIMD_NEON)
+  status.provider = "neon";
+#else
+  status.provider = "scalar";
+#endif
+  status.qualityMode = settings.qualityMode;
+  const size_t sourcePixels = static_cast<size_t>(input.width) * input.height;
+  if (sourcePixels == 0u || input.rgba.size() < sourcePixels * 4u) {
+    status.activeKeyer = "passthrough";
+    status.fallbackActive = true;
+    status.fallbackReason = "invalid_frame";
+    return result;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  if (input.width != sourceWidth_ || input.height != sourceHeight_) {
+    const double factor = std::max({1.0, static_cast<double>(input.width) / kWorkMaxWidth,
+                                    static_cast<double>(input.height) / kWorkMaxHeight});
+    sourceWidth_ = input.width;
+    sourceHeight_ = input.height;
+    workWidth_ = std::max(1u, static_cast<uint32_t>(std::lround(input.width / factor)));
+    workHeight_ = std::max(1u, static_cast<uint32_t>(std::lround(input.height / factor)));
+    const size_t workPixels = static_cast<size_t>(workWidth_) * workHeight_;
+    work_.assign(workPixels * 4u, 0u);
+    plate_.assign(workPixels * 4u, 0u);
+    noise_.assign(workPixels, 0u);
+    difference_.assign(workPixels, 0u);
+    hasPlate_ = false;  // a plate of another geometry is meaningless
+  }
+  const size_t workPixels = static_cast<size_t>(workWidth_) * workHeight_;
+  resampleImage({input.rgba.data(), input.width, input.height, static_cast<size_t>(input.width) * 4u, 4u},
+                {work_.data(), workWidth_, workHeight_, static_cast<size_t>(workWidth_) * 4u, 4u},
+                ResampleFilter::kArea);
+
+  if (settings.cleanPlate.plateRevision != plateRevision_ && settings.cleanPlate.plateRevision != 0u) {
+    plate_ = work_;
+    std::fill(noise_.begin(), noise_.end(), 0u);
+    globalOffset_ = 0u;
+    hasPlate_ = true;
+  }
+  plateRevision_ = settings.cleanPlate.plateRevision;
+  if (!hasPlate_) {
+    status.activeKeyer = "passthrough";
+    status.fallbackActive = true;
+    status.fallbackReason = "clean_plate_missing";
+    return result;
+  }
+
+  const uint16_t low = static_cast<uint16_t>(
+      std::lround(std::clamp(settings.cleanPlate.threshold, 0.0, 1.0) * 255.0) + globalOffset_);
+  const uint16_t softness = static_cast<uint16_t>(
+      std::max(1L, std::lround(std::clamp(settings.cleanPlate.softness, 0.0, 1.0) * 255.0)));
+  const auto keyStart = std::chrono::steady_clock::now();
+  AlphaMask &mask = result.mask;
+  mask.width = workWidth_;
+  mask.height = workHeight_;
+  mask.timestampNs = input.timestampNs;
+  mask.alpha.resize(workPixels);
+  cleanPlateDifferenceRow(work_.data(), plate_.data(), noise_.data(), mask.alpha.data(), difference_.data(),
+                          workPixels, low, softness, settings.cleanPlate.adaptivePlate);
+  const auto keyEnd = std::chrono::steady_clock::now();
+
+  std::array<uint32_t, 256> distances{};
+  std::array<uint32_t, 256> noise{};
+  for (size_t i = 0; i < workPixels; ++i) {
+    ++distances[difference_[i]];
+    ++noise[noise_[i]];
+  }
+  const uint32_t floor = percentile(distances, workPixels, kGlobalPercentile);
+  const uint32_t typicalNoise = percentile(noise, workPixels, 50u);
+  globalOffset_ = static_cast<uint16_t>(std::min<uint32_t>(floor > typicalNoise ? floor - typicalNoise : 0u,
+                                                           kMaxGlobalOffset));
+  const auto end = std::chrono::steady_clock::now();
+
+  status.activeKeyer = "clean_plate";
+  status.fallbackActive = false;
+  status.fallbackReason.clear();
+  status.inferenceMs = elapsedMs(start, end);
+  status.metrics.tensorMs = elapsedMs(start, keyStart);
+  status.metrics.maskApplyMs = elapsedMs(keyStart, keyEnd);
+  status.metrics.maskWidth = mask.width;
+  status.metrics.maskHeight = mask.height;
+  return result;
+}
+
+}  // namespace broadify::meeting
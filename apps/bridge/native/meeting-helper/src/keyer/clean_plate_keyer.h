@@ -0,0 +1,52 @@
+#pragma once
+
+#include "keyer/keyer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Difference keyer for locked-off cameras. On request the next frame becomes
+// the clean plate; afterwards every frame is area-downscaled to a small work
+// plane and keyed by its summed RGB distance to the plate. Thresholds adapt
+// per pixel (a running median of background noise) and per frame (an offset
+// that follows global exposure shifts), and the plate follows slow light
+// drift in confidently-background pixels. The low-resolution mask feeds the
+// usual postprocess and refine chain, which restores edges at camera
+// resolution.
+class CleanPlateKeyer : public Keyer {
+ public:
+  // Plate requests up to `plateRevision` are treated as already served, so a
+  // keyer recreated for another camera waits for a fresh request.
+  explicit CleanPlateKeyer(uint64_t plateRevision = 0) : plateRevision_(plateRevision) {}
+
+  KeyerResult apply(const VideoFrame &input, const KeyerSettings &settings) override;
+
+ private:
+  uint32_t workWidth_ = 0;
+  uint32_t workHeight_ = 0;
+  uint32_t sourceWidth_ = 0;
+  uint32_t sourceHeight_ = 0;
+  uint64_t plateRevision_ = 0;
+  bool hasPlate_ = false;
+  uint16_t globalOffset_ = 0;
+  std::vector<uint8_t> work_;
+  std::vector<uint8_t> plate_;
+  std::vector<uint8_t> noise_;
+  std::vector<uint8_t> difference_;
+};
+
+// One run of `pixels` RGBA8 pixels against the plate. A pixel is
+// transparent while its summed |RGB - plate| stays below
+// `low + 2 * noise`, then ramps to opaque over `softness` (>= 1).
+// `difference` receives the distance clamped to 255. With `updatePlate`,
+// fully transparent pixels move the plate one level towards the frame and
+// their `noise` one level towards their distance, so both track a running
+// median of the background.
+void cleanPlateDifferenceRow(const uint8_t *rgba, uint8_t *plate, uint8_t *noise,
+                             uint8_t *alpha, uint8_t *difference, size_t pixels,
+                             uint16_t low, uint16_t softness, bool updatePlate);
+
+}  // namespace broadify::meeting
@@ -33,6 +33,9 @@ struct KeyerMetrics {
   double droppedFramesPerSec = -1.0;
   uint32_t maskWidth = 0;
   uint32_t maskHeight = 0;
+  // Size the program composites the camera at (cameraDisplayScale).
+  uint32_t cameraDisplayWidth = 0;
+  uint32_t cameraDisplayHeight = 0;
   uint64_t droppedFrames = 0;
   uint64_t skippedFrames = 0;
 };
@@ -62,9 +65,54 @@ struct AlphaMask {
   std::vector<uint8_t> alpha;
 };
 
+// On-demand ONNX Runtime operator profile (keyer.profile). A new `revision`
+// profiles the next `runs` MODNet inferences.
+struct KeyerProfileRequest {
+  uint64_t revision = 0;
+  uint32_t runs = 0;
+};
+
+// Progress of the request with the same revision: "pending" until the
+// keyer picks it up, then "running", "complete" or "failed" (see `reason`).
+// `summaryJson` is the aggregated per-operator report once complete.
+struct KeyerProfileReport {
+  uint64_t revision = 0;
+  std::string state = "idle";
+  uint32_t runsRequested = 0;
+  uint32_t runsCompleted = 0;
+  std::string reason;
+  std::string summaryJson;
+};
+
 struct KeyerResult {
   AlphaMask mask;
   KeyerStatus status;
+  KeyerProfileReport profile;  // revision 0 when no profile is in flight
+};
+
+// Green/blue screen keying (model "chroma_key"). Tolerance and softness are
+// CbCr distances as a fraction of the largest chroma excursion (128): pixels
+// whose chroma lies within `tolerance` of the key colour are transparent, and
+// alpha ramps to opaque over the next `softness`. `spillSuppression` removes
+// that share of the key hue from the foreground.
+struct ChromaKeySettings {
+  uint8_t keyRed = 0;
+  uint8_t keyGreen = 177;
+  uint8_t keyBlue = 64;
+  double tolerance = 0.3;
+  double softness = 0.2;
+  double spillSuppression = 0.5;
+};
+
+// Locked-off camera keying against a captured empty-room plate (model
+// "clean_plate"). Threshold and softness are fractions of 255 in summed RGB
+// difference; each pixel adds its own measured noise on top. A new
+// `plateRevision` captures the next frame as the plate.
+struct CleanPlateSettings {
+  double threshold = 0.1;
+  double softness = 0.1;
+  bool adaptivePlate = true;  // let background pixels follow slow light drift
+  uint64_t plateRevision = 0;
 };
 
 struct KeyerSettings {
@@ -80,6 +128,9 @@ struct KeyerSettings {
   bool edgeStabilizationEnabled = true;
   double edgeStabilizationStrength = 0.35;
   KeyerDegradationSettings degradation;
+  ChromaKeySettings chroma;
+  CleanPlateSettings cleanPlate;
+  KeyerProfileRequest profile;
 };
 
 class Keyer {
@@ -1,5 +1,7 @@
 #include "keyer/keyer_chain.h"
 
+#include "keyer/chroma_keyer.h"
+#include "keyer/clean_plate_keyer.h"
 #include "keyer/modnet_keyer.h"
 #if defined(__APPLE__)
 #include "keyer/coreml_keyer.h"
@@ -10,7 +12,9 @@ namespace broadify::meeting {
 
 KeyerChain::KeyerChain(const Options &options)
     : options_{options.modelsDir, options.keyerSelfTest},
-      modnet_(std::make_unique<ModnetKeyer>(options_))
+      modnet_(std::make_unique<ModnetKeyer>(options_)),
+      chroma_(std::make_unique<ChromaKeyer>()),
+      cleanPlate_(std::make_unique<CleanPlateKeyer>())
 #if defined(__APPLE__)
       ,
       coreml_(std::make_unique<CoreMLKeyer>(options.modelsDir)),
@@ -50,6 +54,9 @@ KeyerResult KeyerChain::process(const VideoFrame &input, const MeetingState &sta
     settings.edgeStabilizationEnabled = state.edgeStabilizationEnabled;
     settings.edgeStabilizationStrength = state.edgeStabilizationStrength;
     settings.degradation = state.degradationSettings;
+    settings.chroma = state.chromaKey;
+    settings.cleanPlate = state.cleanPlate;
+    settings.profile = state.keyerProfileRequest;
   }
 
   std::lock_guard<std::mutex> lock(mutex_);
@@ -59,9 +66,22 @@ KeyerResult KeyerChain::process(const VideoFrame &input, const MeetingState &sta
     vision_ = std::make_unique<VisionKeyer>();
   }
 #endif
+  if (lastCameraIndex_ >= 0 && cameraIndex != lastCameraIndex_) {
+    cleanPlate_ = std::make_unique<CleanPlateKeyer>(settings.cleanPlate.plateRevision);
+  }
   lastEnabled_ = enabled;
   lastRequestedModel_ = requestedModel;
   lastCameraIndex_ = cameraIndex;
+  if (settings.profile.revision == profileSettled_) {
+    settings.profile = KeyerProfileRequest{};
+  }
+  KeyerResult result = dispatch(input, settings, enabled, requestedModel);
+  settleProfile(settings.profile, result);
+  return result;
+}
+
+KeyerResult KeyerChain::dispatch(const VideoFrame &input, KeyerSettings &settings, bool enabled,
+                                 const std::string &requestedModel) {
   if (!enabled) {
     KeyerResult result;
     status_.activeKeyer = "passthrough";
@@ -98,6 +118,18 @@ KeyerResult KeyerChain::process(const VideoFrame &input, const MeetingState &sta
     return result;
   }
 
+  if (requestedModel == "chroma_key") {
+    KeyerResult result = chroma_->apply(input, settings);
+    status_ = result.status;
+    return result;
+  }
+
+  if (requestedModel == "clean_plate") {
+    KeyerResult result = cleanPlate_->apply(input, settings);
+    status_ = result.status;
+    return result;
+  }
+
 #if defined(__APPLE__)
   if (requestedModel == "vision_person_segmentation") {
     if (settings.performanceMode == "performance") {
@@ -122,6 +154,24 @@ KeyerResult KeyerChain::process(const VideoFrame &input, const MeetingState &sta
   }
 }
 
+void KeyerChain::settleProfile(const KeyerProfileRequest &request, KeyerResult &result) {
+  if (request.revision == 0u) {
+    return;
+  }
+  if (result.profile.revision != request.revision) {
+    // Served by a keyer without an ORT session (CoreML, Vision, chroma,
+    // clean plate, or keying disabled).
+    result.profile = KeyerProfileReport{};
+    result.profile.revision = request.revision;
+    result.profile.state = "failed";
+    result.profile.runsRequested = request.runs;
+    result.profile.reason = result.status.fallbackActive ? result.status.fallbackReason : "ort_session_inactive";
+  }
+  if (result.profile.state == "complete" || result.profile.state == "failed") {
+    profileSettled_ = request.revision;
+  }
+}
+
 KeyerStatus KeyerChain::status() const {
   std::lock_guard<std::mutex> lock(mutex_);
   return status_;
@@ -140,6 +190,8 @@ void updateMeetingKeyerStatus(MeetingState &state, const KeyerStatus &status) {
   state.modelHashOk = status.modelHashOk;
   KeyerMetrics mergedMetrics = status.metrics;
   mergedMetrics.cameraCopyMs = state.keyerMetrics.cameraCopyMs;
+  mergedMetrics.cameraDisplayWidth = state.keyerMetrics.cameraDisplayWidth;
+  mergedMetrics.cameraDisplayHeight = state.keyerMetrics.cameraDisplayHeight;
   mergedMetrics.maskAgeMs = state.keyerMetrics.maskAgeMs;
   mergedMetrics.maskAgeAvgMs = state.keyerMetrics.maskAgeAvgMs;
   mergedMetrics.keyerPublishToProgramMs = state.keyerMetrics.keyerPublishToProgramMs;
@@ -150,4 +202,11 @@ void updateMeetingKeyerStatus(MeetingState &state, const KeyerStatus &status) {
   state.keyerMetrics = mergedMetrics;
 }
 
+void updateMeetingKeyerProfile(MeetingState &state, const KeyerProfileReport &report) {
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (report.revision == state.keyerProfileRequest.revision) {
+    state.keyerProfile = report;
+  }
+}
+
 }  // namespace broadify::meeting
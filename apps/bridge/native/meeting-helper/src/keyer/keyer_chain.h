@@ -21,9 +21,16 @@ class KeyerChain {
   KeyerStatus status() const;
 
  private:
+  KeyerResult dispatch(const VideoFrame &input, KeyerSettings &settings, bool enabled,
+                       const std::string &requestedModel);
+  void settleProfile(const KeyerProfileRequest &request, KeyerResult &result);
+
   mutable std::mutex mutex_;
   ModnetKeyerOptions options_;
   std::unique_ptr<Keyer> modnet_;
+  std::unique_ptr<Keyer> chroma_;
+  // Holds the captured plate; recreated when the camera changes.
+  std::unique_ptr<Keyer> cleanPlate_;
 #if defined(__APPLE__)
   std::unique_ptr<Keyer> coreml_;
   // Apple Vision person segmentation is macOS-only and must never ship on
@@ -33,9 +40,14 @@ class KeyerChain {
   bool lastEnabled_ = false;
   std::string lastRequestedModel_;
   int lastCameraIndex_ = -1;
+  // Last keyer.profile revision that completed or failed; it is no longer
+  // passed to the keyers.
+  uint64_t profileSettled_ = 0;
   KeyerStatus status_;
 };
 
 void updateMeetingKeyerStatus(MeetingState &state, const KeyerStatus &status);
+// Stores `report` unless a newer keyer.profile request superseded it.
+void updateMeetingKeyerProfile(MeetingState &state, const KeyerProfileReport &report);
 
 }  // namespace broadify::meeting
@@ -1,7 +1,11 @@
 #include "keyer/modnet_keyer.h"
 
 #include "keyer/model_manifest.h"
+#include "keyer/onnx_rgba_input.h"
+#include "keyer/ort_profile.h"
+#include "util/image_resample.h"
 #include "util/sha256.h"
+#include "util/thread_roles.h"
 
 #include <algorithm>
 #include <array>
@@ -9,10 +13,14 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <sstream>
 #include <thread>
 #include <utility>
 
@@ -35,8 +43,8 @@ constexpr uint32_t kMaxCpuInferenceThreads = 4;
 // MODNet normalizes input as (value/255 - 0.5)/0.5 -> range [-1,1] (mean/std
 // 0.5 per channel), NOT ImageNet mean/std. Using ImageNet stats here silently
 // degrades the matte. Channel order is RGB (our frames are already RGBA), NCHW.
-constexpr float kMean[3] = {0.5f, 0.5f, 0.5f};
-constexpr float kStd[3] = {0.5f, 0.5f, 0.5f};
+constexpr std::array<float, 3> kMean = {0.5f, 0.5f, 0.5f};
+constexpr std::array<float, 3> kStd = {0.5f, 0.5f, 0.5f};
 
 double elapsedMs(std::chrono::steady_clock::time_point start,
                  std::chrono::steady_clock::time_point end) {
@@ -88,6 +96,65 @@ int inferenceThreadCount() {
   return static_cast<int>(std::clamp(detectedThreads, 2u, kMaxCpuInferenceThreads));
 }
 
+#if BROADIFY_ENABLE_MODNET
+// BROADIFY_MEETING_KEYER_FLOAT_INPUT=1 keeps the model's float NCHW input
+// and the CPU normalization loop (A/B comparison, suspected graph issues).
+bool rgbaInputEnabled() {
+  const char *value = std::getenv("BROADIFY_MEETING_KEYER_FLOAT_INPUT");
+  return value == nullptr || value[0] != '1';
+}
+
+// The model with the RGBA8 input stage prepended (see onnx_rgba_input.h),
+// or nullptr when the graph has no input the stage fits. Rewritten once per
+// process per model hash: session rebuilds, profiling sessions and engine
+// restarts reuse the bytes. The rewrite is only ever built from bytes whose
+// hash matches `sha256`, and it stays in memory, so nothing unverified is
+// loaded from disk later.
+std::shared_ptr<const std::string> rgbaInputModel(const std::string &path, const std::string &sha256) {
+  static std::mutex mutex;
+  static std::map<std::string, std::shared_ptr<const std::string>> cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto cached = cache.find(sha256);
+  if (cached != cache.end()) {
+    return cached->second;
+  }
+  std::string source;
+  {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    source = contents.str();
+  }
+  if (sha256Hex(source) != sha256) {
+    // Replaced since the manifest check; take the float path this time.
+    return nullptr;
+  }
+  std::string rewritten;
+  std::shared_ptr<const std::string> model;
+  if (prependRgbaInputStage(source, kMean, kStd, rewritten)) {
+    model = std::make_shared<const std::string>(std::move(rewritten));
+  }
+  cache.emplace(sha256, model);
+  return model;
+}
+
+// ORT intra-op pool threads are created through these hooks so their CPU
+// time is accounted to the "keyer_ort" role instead of "unregistered".
+OrtCustomThreadHandle createOrtThread(void *, OrtThreadWorkerFn work, void *param) {
+  auto *thread = new std::thread([work, param]() {
+    ScopedThreadRole role("keyer_ort");
+    work(param);
+  });
+  return reinterpret_cast<OrtCustomThreadHandle>(thread);
+}
+
+void joinOrtThread(OrtCustomThreadHandle handle) {
+  auto *thread = const_cast<std::thread *>(reinterpret_cast<const std::thread *>(handle));
+  thread->join();
+  delete thread;
+}
+#endif
+
 #if BROADIFY_ENABLE_MODNET && defined(_WIN32)
 std::wstring utf8ToWidePath(const std::string &path) {
   if (path.empty()) {
@@ -124,7 +191,36 @@ class ModnetKeyer::Impl {
     status_.fallbackReason = "not_loaded";
   }
 
+#if BROADIFY_ENABLE_MODNET
+  ~Impl() {
+    discardProfileSession();
+  }
+#endif
+
   KeyerResult apply(const VideoFrame &input, const KeyerSettings &settings) {
+    KeyerResult result = run(input, settings);
+    const KeyerProfileRequest &request = settings.profile;
+    if (request.revision != 0u) {
+      if (request.revision != profile_.revision) {
+        // The request never reached an ORT session (model not loaded,
+        // ONNX Runtime disabled): settle it with the reason.
+        profile_ = KeyerProfileReport{};
+        profile_.revision = request.revision;
+        profile_.state = "failed";
+        profile_.runsRequested = request.runs;
+        profile_.reason = status_.fallbackActive ? status_.fallbackReason : "profile_not_started";
+      }
+      result.profile = profile_;
+    }
+    return result;
+  }
+
+  KeyerStatus status() const {
+    return status_;
+  }
+
+ private:
+  KeyerResult run(const VideoFrame &input, const KeyerSettings &settings) {
     KeyerResult result;
 #if defined(__APPLE__)
     // Choose the CoreML input size from the performance mode BEFORE the session
@@ -184,14 +280,12 @@ class ModnetKeyer::Impl {
     const auto tensorStart = std::chrono::steady_clock::now();
     makeInputTensor(input, tensor_);
     const auto tensorEnd = std::chrono::steady_clock::now();
-    std::array<int64_t, 4> inputShape = {1, 3, static_cast<int64_t>(inputHeight_), static_cast<int64_t>(inputWidth_)};
-    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, tensor_.data(), tensor_.size(), inputShape.data(), inputShape.size());
+    Ort::Value inputTensor = inputValue(scaledInput_, tensor_, inputWidth_, inputHeight_);
 
     try {
+      Ort::Session &session = profiledSession(settings.profile);
       const auto runStart = std::chrono::steady_clock::now();
-      auto outputs = session_->Run(
+      auto outputs = session.Run(
           Ort::RunOptions{nullptr},
           inputNames_.data(),
           &inputTensor,
@@ -199,6 +293,9 @@ class ModnetKeyer::Impl {
           outputNames_.data(),
           1);
       const auto runEnd = std::chrono::steady_clock::now();
+      if (profileSession_ != nullptr && ++profile_.runsCompleted >= profile_.runsRequested) {
+        finishProfile();
+      }
       if (outputs.empty() || !outputs[0].IsTensor()) {
         setFallback("invalid_output");
         result.status = status_;
@@ -241,11 +338,6 @@ class ModnetKeyer::Impl {
 #endif
   }
 
-  KeyerStatus status() const {
-    return status_;
-  }
-
- private:
   bool ensureLoaded() {
     if (loaded_) {
       return true;
@@ -280,7 +372,19 @@ class ModnetKeyer::Impl {
     try {
       env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "broadify-meeting-helper");
       modelPath_ = modelPath;
-      session_ = createSession();
+      modelBytes_ = rgbaInputEnabled() ? rgbaInputModel(modelPath, actualHash) : nullptr;
+      try {
+        session_ = createSession();
+      } catch (...) {
+        if (modelBytes_ == nullptr) {
+          throw;
+        }
+        // The execution provider rejected the rewritten graph: load the
+        // original model and normalize on the CPU.
+        std::cout << "{\"type\":\"keyer_rgba_input_unavailable\"}" << std::endl;
+        modelBytes_.reset();
+        session_ = createSession();
+      }
       if (!session_) {
         setFallback("model_path_invalid");
         return false;
@@ -292,16 +396,22 @@ class ModnetKeyer::Impl {
       outputName_ = outputNameAllocated.get();
       inputNames_[0] = inputName_.c_str();
       outputNames_[0] = outputName_.c_str();
-      const auto inputInfo = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo();
+      // The TypeInfo owns the shape info; keep it alive while reading.
+      const Ort::TypeInfo inputTypeInfo = session_->GetInputTypeInfo(0);
+      const auto inputInfo = inputTypeInfo.GetTensorTypeAndShapeInfo();
       const std::vector<int64_t> inputShape = inputInfo.GetShape();
+      byteInput_ = inputInfo.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
       if (inputShape.size() >= 4u) {
         // A dynamic model (dims reported as <= 0) lets us pick the input
         // resolution per frame from the performance mode; a static model is
-        // pinned to its declared size.
-        modelDynamic_ = inputShape[2] <= 0 || inputShape[3] <= 0;
+        // pinned to its declared size. The RGBA8 input is NHWC, the float
+        // input NCHW.
+        const int64_t height = byteInput_ ? inputShape[1] : inputShape[2];
+        const int64_t width = byteInput_ ? inputShape[2] : inputShape[3];
+        modelDynamic_ = height <= 0 || width <= 0;
 #if !defined(__APPLE__)
-        inputHeight_ = dimensionOrFallback(inputShape[2]);
-        inputWidth_ = dimensionOrFallback(inputShape[3]);
+        inputHeight_ = dimensionOrFallback(height);
+        inputWidth_ = dimensionOrFallback(width);
 #else
         // macOS keeps the size chosen in apply() (frozen into the CoreML
         // free-dimension override); don't overwrite it with the model's dims.
@@ -315,18 +425,7 @@ class ModnetKeyer::Impl {
       // the kernels now. Non-fatal: on failure the first real frame just pays it.
       if (inputWidth_ > 0u && inputHeight_ > 0u) {
         try {
-          std::vector<float> warmupTensor(
-              static_cast<size_t>(3u) * inputWidth_ * inputHeight_, 0.0f);
-          std::array<int64_t, 4> warmupShape = {
-              1, 3, static_cast<int64_t>(inputHeight_),
-              static_cast<int64_t>(inputWidth_)};
-          Ort::MemoryInfo memoryInfo =
-              Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-          Ort::Value warmupInput = Ort::Value::CreateTensor<float>(
-              memoryInfo, warmupTensor.data(), warmupTensor.size(),
-              warmupShape.data(), warmupShape.size());
-          session_->Run(Ort::RunOptions{nullptr}, inputNames_.data(),
-                        &warmupInput, 1, outputNames_.data(), 1);
+          runWarmup(*session_, inputWidth_, inputHeight_);
           sessionRunSize_ = inputWidth_;
         } catch (...) {
           // Warmup is best-effort; ignore failures.
@@ -349,12 +448,27 @@ class ModnetKeyer::Impl {
   }
 
 #if BROADIFY_ENABLE_MODNET
-  // Creates an ORT session for modelPath_ with the platform execution
-  // provider (sets status_.provider). Returns nullptr if the model path
-  // cannot be represented for the platform API; ORT errors throw.
-  std::unique_ptr<Ort::Session> createSession() {
+  // Creates an ORT session for modelBytes_ (the RGBA8-input rewrite) or,
+  // without it, modelPath_, with the platform execution provider (sets
+  // status_.provider). A non-empty `profilePrefix` enables
+  // ORT profiling into `<prefix>_<timestamp>.json`. Returns nullptr if a
+  // path cannot be represented for the platform API; ORT errors throw.
+  std::unique_ptr<Ort::Session> createSession(const std::string &profilePrefix = std::string()) {
     Ort::SessionOptions sessionOptions;
+    if (!profilePrefix.empty()) {
+#if defined(_WIN32)
+      const std::wstring widePrefix = utf8ToWidePath(profilePrefix);
+      if (widePrefix.empty()) {
+        return nullptr;
+      }
+      sessionOptions.EnableProfiling(widePrefix.c_str());
+#else
+      sessionOptions.EnableProfiling(profilePrefix.c_str());
+#endif
+    }
     sessionOptions.SetIntraOpNumThreads(inferenceThreadCount());
+    sessionOptions.SetCustomCreateThreadFn(createOrtThread);
+    sessionOptions.SetCustomJoinThreadFn(joinOrtThread);
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 #if defined(__APPLE__)
     status_.provider = "cpu";
@@ -440,6 +554,9 @@ class ModnetKeyer::Impl {
 #else
     status_.provider = "cpu";
 #endif
+    if (modelBytes_ != nullptr) {
+      return std::make_unique<Ort::Session>(*env_, modelBytes_->data(), modelBytes_->size(), sessionOptions);
+    }
 #if defined(_WIN32)
     const std::wstring ortModelPath = utf8ToWidePath(modelPath_);
     if (ortModelPath.empty()) {
@@ -461,13 +578,7 @@ class ModnetKeyer::Impl {
       if (!newSession) {
         return false;
       }
-      std::vector<float> warmupTensor(static_cast<size_t>(3u) * size * size, 0.0f);
-      std::array<int64_t, 4> warmupShape = {1, 3, static_cast<int64_t>(size), static_cast<int64_t>(size)};
-      Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-      Ort::Value warmupInput = Ort::Value::CreateTensor<float>(
-          memoryInfo, warmupTensor.data(), warmupTensor.size(), warmupShape.data(), warmupShape.size());
-      newSession->Run(
-          Ort::RunOptions{nullptr}, inputNames_.data(), &warmupInput, 1, outputNames_.data(), 1);
+      runWarmup(*newSession, size, size);
       session_ = std::move(newSession);
       sessionRunSize_ = size;
       std::cout << "{\"type\":\"keyer_session_rebuild\",\"input_size\":" << size
@@ -480,24 +591,164 @@ class ModnetKeyer::Impl {
       return false;
     }
   }
+
+  // One zero-input Run at `width` x `height`, which makes the execution
+  // provider compile its kernels for that shape. ORT errors throw.
+  void runWarmup(Ort::Session &session, uint32_t width, uint32_t height) {
+    const size_t pixels = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> warmupPixels(byteInput_ ? pixels * 4u : 0u, 0u);
+    std::vector<float> warmupTensor(byteInput_ ? 0u : pixels * 3u, 0.0f);
+    Ort::Value warmupInput = inputValue(warmupPixels, warmupTensor, width, height);
+    session.Run(Ort::RunOptions{nullptr}, inputNames_.data(), &warmupInput, 1, outputNames_.data(), 1);
+  }
+
+  // Wraps the model input without copying: the RGBA8 pixels as NHWC uint8
+  // when the session takes them directly, the normalized planes as NCHW
+  // float otherwise.
+  Ort::Value inputValue(std::vector<uint8_t> &pixels, std::vector<float> &planes, uint32_t width,
+                        uint32_t height) const {
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    if (byteInput_) {
+      const std::array<int64_t, 4> shape = {1, static_cast<int64_t>(height), static_cast<int64_t>(width), 4};
+      return Ort::Value::CreateTensor<uint8_t>(memoryInfo, pixels.data(), pixels.size(), shape.data(), shape.size());
+    }
+    const std::array<int64_t, 4> shape = {1, 3, static_cast<int64_t>(height), static_cast<int64_t>(width)};
+    return Ort::Value::CreateTensor<float>(memoryInfo, planes.data(), planes.size(), shape.data(), shape.size());
+  }
+
+  // keyer.profile: ORT cannot switch profiling on or off for a live session,
+  // so a second session with profiling enabled serves the requested runs and
+  // is dropped afterwards. The live session never carries profiling
+  // overhead, and nothing needs a restart.
+  Ort::Session &profiledSession(const KeyerProfileRequest &request) {
+    if (profileSession_ != nullptr &&
+        (request.revision != profile_.revision || inputWidth_ != profileInputWidth_ ||
+         inputHeight_ != profileInputHeight_)) {
+      // Superseded, cancelled, or the input size moved under a session that
+      // was compiled for the old one.
+      discardProfileSession();
+      if (request.revision == profile_.revision) {
+        profile_.state = "failed";
+        profile_.reason = "input_size_changed";
+      }
+    }
+    if (request.revision != 0u && request.revision != profile_.revision) {
+      startProfile(request);
+    }
+    return profileSession_ != nullptr ? *profileSession_ : *session_;
+  }
+
+  void startProfile(const KeyerProfileRequest &request) {
+    profile_ = KeyerProfileReport{};
+    profile_.revision = request.revision;
+    profile_.runsRequested = std::max(1u, request.runs);
+    profile_.state = "failed";
+    try {
+      std::error_code error;
+      const std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+      if (error) {
+        profile_.reason = "profile_directory_unavailable";
+        return;
+      }
+      const std::string prefix =
+          (directory / ("broadify-keyer-profile-" + std::to_string(request.revision))).u8string();
+      std::unique_ptr<Ort::Session> session = createSession(prefix);
+      if (!session) {
+        profile_.reason = "model_path_invalid";
+        return;
+      }
+      // The warmup Run pays the shape compile before any counted run; the
+      // summary skips it.
+      runWarmup(*session, inputWidth_, inputHeight_);
+      profileSession_ = std::move(session);
+      profileInputWidth_ = inputWidth_;
+      profileInputHeight_ = inputHeight_;
+      profile_.state = "running";
+    } catch (...) {
+      profile_.reason = "profile_session_failed";
+    }
+  }
+
+  // Ends profiling, drops the session and folds the trace file into the
+  // report. Parsing runs once on the keyer thread after the last run.
+  void finishProfile() {
+    const std::string path = endProfileSession();
+    std::string trace;
+    {
+      std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+      std::ostringstream contents;
+      contents << file.rdbuf();
+      trace = contents.str();
+    }
+    removeProfileFile(path);
+    profile_.summaryJson = summarizeOrtProfile(trace, 1u);
+    profile_.state = profile_.summaryJson.empty() ? "failed" : "complete";
+    if (profile_.summaryJson.empty()) {
+      profile_.reason = "profile_parse_failed";
+    }
+    std::cout << "{\"type\":\"keyer_profile\",\"revision\":" << profile_.revision << ",\"state\":\""
+              << profile_.state << "\",\"runs\":" << profile_.runsCompleted << "}" << std::endl;
+  }
+
+  void discardProfileSession() {
+    removeProfileFile(endProfileSession());
+  }
+
+  // Returns the trace path, or an empty string when no session was active.
+  std::string endProfileSession() {
+    if (profileSession_ == nullptr) {
+      return std::string();
+    }
+    std::string path;
+    try {
+      Ort::AllocatorWithDefaultOptions allocator;
+      Ort::AllocatedStringPtr written = profileSession_->EndProfilingAllocated(allocator);
+      path = written.get();
+    } catch (...) {
+      path.clear();
+    }
+    profileSession_.reset();
+    return path;
+  }
+
+  static void removeProfileFile(const std::string &path) {
+    if (!path.empty()) {
+      std::error_code error;
+      std::filesystem::remove(std::filesystem::u8path(path), error);
+    }
+  }
 #endif
 
+  // Area-downscales the camera frame to the model input, then normalizes
+  // through a per-channel table into planar NCHW. With the RGBA8 input
+  // stage the graph does the normalization and the downscale is all.
   void makeInputTensor(const VideoFrame &input, std::vector<float> &tensor) const {
-    tensor.resize(static_cast<size_t>(3u) * inputWidth_ * inputHeight_);
-    const size_t channelSize = static_cast<size_t>(inputWidth_) * inputHeight_;
-    for (uint32_t y = 0; y < inputHeight_; ++y) {
-      const uint32_t sy = static_cast<uint32_t>((static_cast<uint64_t>(y) * input.height) / inputHeight_);
-      for (uint32_t x = 0; x < inputWidth_; ++x) {
-        const uint32_t sx = static_cast<uint32_t>((static_cast<uint64_t>(x) * input.width) / inputWidth_);
-        const size_t srcOffset = (static_cast<size_t>(sy) * input.width + sx) * 4u;
-        const size_t dstOffset = static_cast<size_t>(y) * inputWidth_ + x;
-        const float r = static_cast<float>(input.rgba[srcOffset + 0u]) / 255.0f;
-        const float g = static_cast<float>(input.rgba[srcOffset + 1u]) / 255.0f;
-        const float b = static_cast<float>(input.rgba[srcOffset + 2u]) / 255.0f;
-        tensor[dstOffset] = (r - kMean[0]) / kStd[0];
-        tensor[channelSize + dstOffset] = (g - kMean[1]) / kStd[1];
-        tensor[channelSize * 2u + dstOffset] = (b - kMean[2]) / kStd[2];
+    static const auto normalized = []() {
+      std::array<std::array<float, 256>, 3> table{};
+      for (size_t channel = 0; channel < 3u; ++channel) {
+        for (size_t value = 0; value < 256u; ++value) {
+          table[channel][value] = (static_cast<float>(value) / 255.0f - kMean[channel]) / kStd[channel];
+        }
       }
+      return table;
+    }();
+    const size_t channelSize = static_cast<size_t>(inputWidth_) * inputHeight_;
+    scaledInput_.resize(channelSize * 4u);
+    resampleImage({input.rgba.data(), input.width, input.height, static_cast<size_t>(input.width) * 4u, 4u},
+                  {scaledInput_.data(), inputWidth_, inputHeight_, static_cast<size_t>(inputWidth_) * 4u, 4u},
+                  ResampleFilter::kArea);
+    if (byteInput_) {
+      return;
+    }
+    tensor.resize(channelSize * 3u);
+    float *red = tensor.data();
+    float *green = red + channelSize;
+    float *blue = green + channelSize;
+    const uint8_t *pixel = scaledInput_.data();
+    for (size_t i = 0; i < channelSize; ++i, pixel += 4) {
+      red[i] = normalized[0][pixel[0]];
+      green[i] = normalized[1][pixel[1]];
+      blue[i] = normalized[2][pixel[2]];
     }
   }
 
@@ -534,14 +785,22 @@ class ModnetKeyer::Impl {
   uint32_t inputWidth_ = kFallbackInputSize;
   uint32_t inputHeight_ = kFallbackInputSize;
   bool modelDynamic_ = false;
+  // The session takes RGBA8 NHWC (rgbaInputModel) instead of float NCHW.
+  bool byteInput_ = false;
   // Shape the current session has run with (0 = no Run yet) and the last
   // size a rebuild failed for (retried only after the requested size changes).
   uint32_t sessionRunSize_ = 0u;
   uint32_t failedRebuildSize_ = 0u;
   std::string modelPath_;
+  mutable std::vector<uint8_t> scaledInput_;
+  KeyerProfileReport profile_;
 #if BROADIFY_ENABLE_MODNET
   std::unique_ptr<Ort::Env> env_;
   std::unique_ptr<Ort::Session> session_;
+  std::unique_ptr<Ort::Session> profileSession_;
+  std::shared_ptr<const std::string> modelBytes_;
+  uint32_t profileInputWidth_ = 0u;
+  uint32_t profileInputHeight_ = 0u;
   std::string inputName_;
   std::string outputName_;
   std::array<const char *, 1> inputNames_ = {nullptr};
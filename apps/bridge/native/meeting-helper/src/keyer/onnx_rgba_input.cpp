@@ -0,0 +1,404 @@
+#include "keyer/onnx_rgba_input.h"
+
+#include <cstdint>
+#include <set>
+#include <string_view>
+#include <vector>
+
+namespace broadify::meeting {
+namespace {
+
+// Field numbers from onnx.proto3.
+constexpr uint32_t kModelOpsetImport = 8;
+constexpr uint32_t kModelGraph = 7;
+constexpr uint32_t kOpsetDomain = 1;
+constexpr uint32_t kOpsetVersion = 2;
+constexpr uint32_t kGraphNode = 1;
+constexpr uint32_t kGraphInitializer = 5;
+constexpr uint32_t kGraphInput = 11;
+constexpr uint32_t kNodeInput = 1;
+constexpr uint32_t kNodeOutput = 2;
+constexpr uint32_t kNodeName = 3;
+constexpr uint32_t kNodeOpType = 4;
+constexpr uint32_t kNodeAttribute = 5;
+constexpr uint32_t kAttributeName = 1;
+constexpr uint32_t kAttributeInt = 3;
+constexpr uint32_t kAttributeTensor = 5;
+constexpr uint32_t kAttributeInts = 8;
+constexpr uint32_t kAttributeType = 20;
+constexpr uint32_t kTensorDims = 1;
+constexpr uint32_t kTensorDataType = 2;
+constexpr uint32_t kTensorName = 8;
+constexpr uint32_t kTensorRawData = 9;
+constexpr uint32_t kValueInfoName = 1;
+constexpr uint32_t kValueInfoType = 2;
+constexpr uint32_t kTypeTensor = 1;
+constexpr uint32_t kTypeTensorElemType = 1;
+constexpr uint32_t kTypeTensorShape = 2;
+constexpr uint32_t kShapeDim = 1;
+constexpr uint32_t kDimValue = 1;
+
+// AttributeProto.AttributeType and TensorProto.DataType values.
+constexpr uint64_t kAttributeTypeInt = 2;
+constexpr uint64_t kAttributeTypeTensor = 4;
+constexpr uint64_t kAttributeTypeInts = 7;
+constexpr uint64_t kFloat = 1;
+constexpr uint64_t kUint8 = 2;
+constexpr uint64_t kInt64 = 7;
+
+// Cast takes an integer `to` since opset 6.
+constexpr uint64_t kMinOpset = 6;
+
+constexpr uint32_t kWireVarint = 0;
+constexpr uint32_t kWireFixed64 = 1;
+constexpr uint32_t kWireLengthDelimited = 2;
+constexpr uint32_t kWireFixed32 = 5;
+
+struct Field {
+  uint32_t number = 0;
+  uint32_t wireType = 0;
+  uint64_t varint = 0;
+  std::string_view payload;  // length-delimited content
+  std::string_view raw;      // tag and value, for verbatim copies
+};
+
+bool readVarint(std::string_view data, size_t &pos, uint64_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+    const auto byte = static_cast<uint8_t>(data[pos++]);
+    value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+    if ((byte & 0x80u) == 0u) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool nextField(std::string_view data, size_t &pos, Field &field) {
+  const size_t start = pos;
+  uint64_t tag = 0;
+  if (!readVarint(data, pos, tag)) {
+    return false;
+  }
+  field.number = static_cast<uint32_t>(tag >> 3u);
+  field.wireType = static_cast<uint32_t>(tag & 7u);
+  field.payload = std::string_view();
+  switch (field.wireType) {
+    case kWireVarint:
+      if (!readVarint(data, pos, field.varint)) {
+        return false;
+      }
+      break;
+    case kWireFixed64:
+    case kWireFixed32: {
+      const size_t size = field.wireType == kWireFixed64 ? 8u : 4u;
+      if (data.size() - pos < size) {
+        return false;
+      }
+      pos += size;
+      break;
+    }
+    case kWireLengthDelimited: {
+      uint64_t length = 0;
+      if (!readVarint(data, pos, length) || length > data.size() - pos) {
+        return false;
+      }
+      field.payload = data.substr(pos, static_cast<size_t>(length));
+      pos += static_cast<size_t>(length);
+      break;
+    }
+    default:
+      return false;  // groups are not used by ONNX
+  }
+  field.raw = data.substr(start, pos - start);
+  return field.number != 0u;
+}
+
+// Visits every field of `message`; false when it is malformed or `visit`
+// returns false.
+template <typename Visit>
+bool forEachField(std::string_view message, Visit &&visit) {
+  size_t pos = 0;
+  Field field;
+  while (pos < message.size()) {
+    if (!nextField(message, pos, field) || !visit(field)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void writeVarint(std::string &out, uint64_t value) {
+  while (value >= 0x80u) {
+    out.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+    value >>= 7u;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void writeVarintField(std::string &out, uint32_t number, uint64_t value) {
+  writeVarint(out, static_cast<uint64_t>(number) << 3u | kWireVarint);
+  writeVarint(out, value);
+}
+
+void writeBytesField(std::string &out, uint32_t number, std::string_view bytes) {
+  writeVarint(out, static_cast<uint64_t>(number) << 3u | kWireLengthDelimited);
+  writeVarint(out, bytes.size());
+  out.append(bytes.data(), bytes.size());
+}
+
+template <typename T>
+std::string tensorProto(uint64_t dataType, const std::vector<int64_t> &dims, const std::vector<T> &values) {
+  std::string tensor;
+  for (const int64_t dim : dims) {
+    writeVarintField(tensor, kTensorDims, static_cast<uint64_t>(dim));
+  }
+  writeVarintField(tensor, kTensorDataType, dataType);
+  // raw_data is little-endian, like every platform the helper ships on.
+  writeBytesField(tensor, kTensorRawData,
+                  std::string_view(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T)));
+  return tensor;
+}
+
+std::string intAttribute(std::string_view name, int64_t value) {
+  std::string attribute;
+  writeBytesField(attribute, kAttributeName, name);
+  writeVarintField(attribute, kAttributeInt, static_cast<uint64_t>(value));
+  writeVarintField(attribute, kAttributeType, kAttributeTypeInt);
+  return attribute;
+}
+
+std::string intsAttribute(std::string_view name, const std::vector<int64_t> &values) {
+  std::string attribute;
+  writeBytesField(attribute, kAttributeName, name);
+  for (const int64_t value : values) {
+    writeVarintField(attribute, kAttributeInts, static_cast<uint64_t>(value));
+  }
+  writeVarintField(attribute, kAttributeType, kAttributeTypeInts);
+  return attribute;
+}
+
+std::string tensorAttribute(std::string_view name, const std::string &tensor) {
+  std::string attribute;
+  writeBytesField(attribute, kAttributeName, name);
+  writeBytesField(attribute, kAttributeTensor, tensor);
+  writeVarintField(attribute, kAttributeType, kAttributeTypeTensor);
+  return attribute;
+}
+
+void writeNode(std::string &graph, std::string_view opType, const std::vector<std::string> &inputs,
+               const std::string &output, const std::vector<std::string> &attributes) {
+  std::string node;
+  for (const std::string &input : inputs) {
+    writeBytesField(node, kNodeInput, input);
+  }
+  writeBytesField(node, kNodeOutput, output);
+  writeBytesField(node, kNodeName, "rgba8_stage/" + output);
+  writeBytesField(node, kNodeOpType, opType);
+  for (const std::string &attribute : attributes) {
+    writeBytesField(node, kNodeAttribute, attribute);
+  }
+  writeBytesField(graph, kGraphNode, node);
+}
+
+std::string stringPayload(const Field &field) {
+  return std::string(field.payload.data(), field.payload.size());
+}
+
+// Element type and raw Dimension messages of a tensor ValueInfoProto.
+bool parseTensorInput(std::string_view valueInfo, std::string &name, uint64_t &elemType,
+                      std::vector<std::string_view> &dims) {
+  std::string_view type;
+  if (!forEachField(valueInfo, [&](const Field &field) {
+        if (field.number == kValueInfoName && field.wireType == kWireLengthDelimited) {
+          name = stringPayload(field);
+        } else if (field.number == kValueInfoType && field.wireType == kWireLengthDelimited) {
+          type = field.payload;
+        }
+        return true;
+      })) {
+    return false;
+  }
+  std::string_view tensorType;
+  std::string_view shape;
+  return forEachField(type, [&](const Field &field) {
+           if (field.number == kTypeTensor && field.wireType == kWireLengthDelimited) {
+             tensorType = field.payload;
+           }
+           return true;
+         }) &&
+         forEachField(tensorType, [&](const Field &field) {
+           if (field.number == kTypeTensorElemType && field.wireType == kWireVarint) {
+             elemType = field.varint;
+           } else if (field.number == kTypeTensorShape && field.wireType == kWireLengthDelimited) {
+             shape = field.payload;
+           }
+           return true;
+         }) &&
+         forEachField(shape, [&](const Field &field) {
+           if (field.number == kShapeDim && field.wireType == kWireLengthDelimited) {
+             dims.push_back(field.payload);
+           }
+           return true;
+         });
+}
+
+bool isDimValue(std::string_view dim, uint64_t expected) {
+  bool matches = false;
+  forEachField(dim, [&](const Field &field) {
+    matches = field.number == kDimValue && field.wireType == kWireVarint && field.varint == expected;
+    return true;
+  });
+  return matches;
+}
+
+std::string tensorValueInfo(const std::string &name, uint64_t elemType, const std::vector<std::string> &dims) {
+  std::string shape;
+  for (const std::string &dim : dims) {
+    writeBytesField(shape, kShapeDim, dim);
+  }
+  std::string tensorType;
+  writeVarintField(tensorType, kTypeTensorElemType, elemType);
+  writeBytesField(tensorType, kTypeTensorShape, shape);
+  std::string type;
+  writeBytesField(type, kTypeTensor, tensorType);
+  std::string valueInfo;
+  writeBytesField(valueInfo, kValueInfoName, name);
+  writeBytesField(valueInfo, kValueInfoType, type);
+  return valueInfo;
+}
+
+bool rewriteGraph(std::string_view graph, const std::array<float, 3> &mean, const std::array<float, 3> &stddev,
+                  std::string &out) {
+  std::set<std::string> initializers;
+  if (!forEachField(graph, [&](const Field &field) {
+        if (field.number == kGraphInitializer && field.wireType == kWireLengthDelimited) {
+          forEachField(field.payload, [&](const Field &member) {
+            if (member.number == kTensorName && member.wireType == kWireLengthDelimited) {
+              initializers.insert(stringPayload(member));
+            }
+            return true;
+          });
+        }
+        return true;
+      })) {
+    return false;
+  }
+
+  // Older IR versions list initializers as inputs too; the image is the
+  // first input that is not one (ORT's input 0).
+  const char *imageRaw = nullptr;
+  std::string imageName;
+  std::vector<std::string_view> imageDims;
+  bool rejected = false;
+  forEachField(graph, [&](const Field &field) {
+    if (imageRaw != nullptr || field.number != kGraphInput || field.wireType != kWireLengthDelimited) {
+      return true;
+    }
+    std::string name;
+    uint64_t elemType = 0;
+    std::vector<std::string_view> dims;
+    if (!parseTensorInput(field.payload, name, elemType, dims)) {
+      rejected = true;
+      return false;
+    }
+    if (initializers.count(name) != 0u) {
+      return true;
+    }
+    imageRaw = field.raw.data();
+    imageName = name;
+    imageDims = dims;
+    rejected = elemType != kFloat || dims.size() != 4u || !isDimValue(dims[1], 3u);
+    return true;
+  });
+  if (rejected || imageRaw == nullptr || imageName.empty()) {
+    return false;
+  }
+
+  const std::string prefix = imageName + "_rgba8";
+  const std::string gathered = prefix + "_rgb";
+  const std::string planar = prefix + "_nchw";
+  const std::string widened = prefix + "_float";
+  const std::string scaled = prefix + "_scaled";
+  std::vector<float> scale(3);
+  std::vector<float> bias(3);
+  for (size_t c = 0; c < 3u; ++c) {
+    scale[c] = 1.0f / (255.0f * stddev[c]);
+    bias[c] = -mean[c] / stddev[c];
+  }
+  writeNode(out, "Constant", {}, prefix + "_channels",
+            {tensorAttribute("value", tensorProto<int64_t>(kInt64, {3}, {0, 1, 2}))});
+  writeNode(out, "Constant", {}, prefix + "_scale",
+            {tensorAttribute("value", tensorProto<float>(kFloat, {1, 3, 1, 1}, scale))});
+  writeNode(out, "Constant", {}, prefix + "_bias",
+            {tensorAttribute("value", tensorProto<float>(kFloat, {1, 3, 1, 1}, bias))});
+  // Drop alpha and transpose while still 8-bit, so the widening Cast and the
+  // normalization touch the smallest tensors.
+  writeNode(out, "Gather", {prefix, prefix + "_channels"}, gathered, {intAttribute("axis", 3)});
+  writeNode(out, "Transpose", {gathered}, planar, {intsAttribute("perm", {0, 3, 1, 2})});
+  writeNode(out, "Cast", {planar}, widened, {intAttribute("to", static_cast<int64_t>(kFloat))});
+  writeNode(out, "Mul", {widened, prefix + "_scale"}, scaled, {});
+  writeNode(out, "Add", {scaled, prefix + "_bias"}, imageName, {});
+
+  std::string four;
+  writeVarintField(four, kDimValue, 4u);
+  const std::vector<std::string> dims = {std::string(imageDims[0]), std::string(imageDims[2]),
+                                         std::string(imageDims[3]), four};
+  return forEachField(graph, [&](const Field &field) {
+    if (field.raw.data() == imageRaw) {
+      writeBytesField(out, kGraphInput, tensorValueInfo(prefix, kUint8, dims));
+    } else {
+      out.append(field.raw.data(), field.raw.size());
+    }
+    return true;
+  });
+}
+
+}  // namespace
+
+bool prependRgbaInputStage(const std::string &model, const std::array<float, 3> &mean,
+                           const std::array<float, 3> &stddev, std::string &rewritten) {
+  rewritten.clear();
+  std::string_view graph;
+  size_t graphs = 0;
+  uint64_t opset = 0;
+  if (!forEachField(model, [&](const Field &field) {
+        if (field.number == kModelGraph && field.wireType == kWireLengthDelimited) {
+          graph = field.payload;
+          ++graphs;
+        } else if (field.number == kModelOpsetImport && field.wireType == kWireLengthDelimited) {
+          std::string domain;
+          uint64_t version = 0;
+          forEachField(field.payload, [&](const Field &member) {
+            if (member.number == kOpsetDomain && member.wireType == kWireLengthDelimited) {
+              domain = stringPayload(member);
+            } else if (member.number == kOpsetVersion && member.wireType == kWireVarint) {
+              version = member.varint;
+            }
+            return true;
+          });
+          if (domain.empty() || domain == "ai.onnx") {
+            opset = version;
+          }
+        }
+        return true;
+      })) {
+    return false;
+  }
+  std::string newGraph;
+  if (graphs != 1u || opset < kMinOpset || !rewriteGraph(graph, mean, stddev, newGraph)) {
+    return false;
+  }
+  rewritten.reserve(model.size() + 1024u);
+  forEachField(model, [&](const Field &field) {
+    if (field.number == kModelGraph) {
+      writeBytesField(rewritten, kModelGraph, newGraph);
+    } else {
+      rewritten.append(field.raw.data(), field.raw.size());
+    }
+    return true;
+  });
+  return true;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+namespace broadify::meeting {
+
+// Rewrites a serialized ONNX model whose first (non-initializer) graph input
+// is a float NCHW RGB image so that it takes the RGBA8 NHWC image instead:
+// Gather (drop alpha), Transpose, Cast and the per-channel
+// (value / 255 - mean) / stddev normalization are prepended as graph nodes, and
+// the old input name becomes their output. Batch, height and width dims are
+// carried over, names included. The protobuf is edited at the wire level,
+// so every other field is copied byte for byte. Returns false when the
+// model does not have that input (wrong rank, channels or element type) or
+// is not a well-formed ModelProto.
+bool prependRgbaInputStage(const std::string &model, const std::array<float, 3> &mean,
+                           const std::array<float, 3> &stddev, std::string &rewritten);
+
+}  // namespace broadify::meeting
@@ -0,0 +1,195 @@
+#include "keyer/ort_profile.h"
+
+#include "util/json_utils.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace broadify::meeting {
+namespace {
+
+constexpr const char *kKernelSuffix = "_kernel_time";
+constexpr size_t kMaxOperators = 24;
+constexpr size_t kMaxNodes = 10;
+
+struct TraceEvent {
+  std::string category;
+  std::string name;
+  double ts = 0.0;
+  double durUs = 0.0;
+  std::string args;
+};
+
+struct NodeStats {
+  std::string op;
+  std::string provider;
+  double totalUs = 0.0;
+  double outputBytes = 0.0;
+  double parameterBytes = 0.0;
+};
+
+struct OperatorStats {
+  uint32_t nodes = 0;
+  double totalUs = 0.0;
+  double outputBytes = 0.0;
+  double parameterBytes = 0.0;
+};
+
+struct ProviderStats {
+  uint32_t nodes = 0;
+  double totalUs = 0.0;
+};
+
+// ORT writes sizes as quoted numbers; accept bare numbers as well.
+double parseNumber(const std::string &raw) {
+  const std::string text = !raw.empty() && raw.front() == '"' ? parseStringValue(raw) : raw;
+  return parseDoubleValue(text, 0.0);
+}
+
+bool parseEvent(const std::string &raw, TraceEvent &event) {
+  std::vector<std::pair<std::string, std::string>> members;
+  if (!splitObjectMembers(raw, members)) {
+    return false;
+  }
+  for (const auto &[key, value] : members) {
+    if (key == "cat") {
+      event.category = parseStringValue(value);
+    } else if (key == "name") {
+      event.name = parseStringValue(value);
+    } else if (key == "ts") {
+      event.ts = parseDoubleValue(value, 0.0);
+    } else if (key == "dur") {
+      event.durUs = parseDoubleValue(value, 0.0);
+    } else if (key == "args") {
+      event.args = value;
+    }
+  }
+  return true;
+}
+
+double ms(double us) {
+  return us / 1000.0;
+}
+
+}  // namespace
+
+std::string summarizeOrtProfile(const std::string &trace, uint32_t skipRuns) {
+  std::vector<std::string> elements;
+  if (!splitArrayElements(trace, elements)) {
+    return "";
+  }
+  std::vector<TraceEvent> events;
+  events.reserve(elements.size());
+  std::vector<std::pair<double, double>> runs;  // (ts, dur) of every model_run
+  for (const std::string &raw : elements) {
+    TraceEvent event;
+    if (!parseEvent(raw, event)) {
+      return "";
+    }
+    if (event.category == "Session" && event.name == "model_run") {
+      runs.emplace_back(event.ts, event.durUs);
+    } else if (event.category == "Node") {
+      events.push_back(std::move(event));
+    }
+  }
+  std::sort(runs.begin(), runs.end());
+  if (runs.size() <= skipRuns) {
+    return "";
+  }
+  const double countedFrom = runs[skipRuns].first;
+  const size_t counted = runs.size() - skipRuns;
+  double runTotalUs = 0.0;
+  double runMaxUs = 0.0;
+  for (size_t i = skipRuns; i < runs.size(); ++i) {
+    runTotalUs += runs[i].second;
+    runMaxUs = std::max(runMaxUs, runs[i].second);
+  }
+
+  const size_t suffixLength = std::char_traits<char>::length(kKernelSuffix);
+  std::map<std::string, NodeStats> nodes;
+  for (const TraceEvent &event : events) {
+    if (event.ts < countedFrom || event.name.size() <= suffixLength ||
+        event.name.compare(event.name.size() - suffixLength, suffixLength, kKernelSuffix) != 0) {
+      continue;  // warmup, or fence_before/fence_after bookkeeping
+    }
+    NodeStats &node = nodes[event.name.substr(0, event.name.size() - suffixLength)];
+    if (node.op.empty()) {
+      std::vector<std::pair<std::string, std::string>> args;
+      splitObjectMembers(event.args, args);
+      for (const auto &[key, value] : args) {
+        if (key == "op_name") {
+          node.op = parseStringValue(value);
+        } else if (key == "provider") {
+          node.provider = parseStringValue(value);
+        } else if (key == "output_size") {
+          node.outputBytes = parseNumber(value);
+        } else if (key == "parameter_size") {
+          node.parameterBytes = parseNumber(value);
+        }
+      }
+      if (node.op.empty()) {
+        node.op = "unknown";
+      }
+    }
+    node.totalUs += event.durUs;
+  }
+
+  double kernelTotalUs = 0.0;
+  std::map<std::string, OperatorStats> operators;
+  std::map<std::string, ProviderStats> providers;
+  for (const auto &[name, node] : nodes) {
+    kernelTotalUs += node.totalUs;
+    OperatorStats &op = operators[node.op + '\n' + node.provider];
+    ++op.nodes;
+    op.totalUs += node.totalUs;
+    op.outputBytes += node.outputBytes;
+    op.parameterBytes += node.parameterBytes;
+    ProviderStats &provider = providers[node.provider];
+    ++provider.nodes;
+    provider.totalUs += node.totalUs;
+  }
+  const auto percent = [kernelTotalUs](double us) { return kernelTotalUs > 0.0 ? us * 100.0 / kernelTotalUs : 0.0; };
+  const auto perRun = [counted](double us) { return ms(us) / static_cast<double>(counted); };
+
+  std::vector<std::pair<std::string, OperatorStats>> byOperator(operators.begin(), operators.end());
+  std::sort(byOperator.begin(), byOperator.end(),
+            [](const auto &a, const auto &b) { return a.second.totalUs > b.second.totalUs; });
+  std::vector<std::pair<std::string, NodeStats>> byNode(nodes.begin(), nodes.end());
+  std::sort(byNode.begin(), byNode.end(),
+            [](const auto &a, const auto &b) { return a.second.totalUs > b.second.totalUs; });
+
+  std::ostringstream out;
+  out << "{\"runs\":" << counted << ",\"run_ms_avg\":" << perRun(runTotalUs) << ",\"run_ms_max\":" << ms(runMaxUs)
+      << ",\"kernel_ms_per_run\":" << perRun(kernelTotalUs) << ",\"nodes\":" << nodes.size() << ",\"providers\":[";
+  bool first = true;
+  for (const auto &[name, provider] : providers) {
+    out << (first ? "" : ",") << "{\"provider\":\"" << jsonEscape(name) << "\",\"nodes\":" << provider.nodes
+        << ",\"ms_per_run\":" << perRun(provider.totalUs) << ",\"percent\":" << percent(provider.totalUs) << "}";
+    first = false;
+  }
+  out << "],\"operators\":[";
+  for (size_t i = 0; i < byOperator.size() && i < kMaxOperators; ++i) {
+    const std::string &key = byOperator[i].first;
+    const OperatorStats &op = byOperator[i].second;
+    const size_t split = key.find('\n');
+    out << (i == 0u ? "" : ",") << "{\"op\":\"" << jsonEscape(key.substr(0, split)) << "\",\"provider\":\""
+        << jsonEscape(key.substr(split + 1u)) << "\",\"nodes\":" << op.nodes
+        << ",\"ms_per_run\":" << perRun(op.totalUs) << ",\"percent\":" << percent(op.totalUs)
+        << ",\"output_bytes\":" << static_cast<uint64_t>(op.outputBytes)
+        << ",\"parameter_bytes\":" << static_cast<uint64_t>(op.parameterBytes) << "}";
+  }
+  out << "],\"top_nodes\":[";
+  for (size_t i = 0; i < byNode.size() && i < kMaxNodes; ++i) {
+    const NodeStats &node = byNode[i].second;
+    out << (i == 0u ? "" : ",") << "{\"node\":\"" << jsonEscape(byNode[i].first) << "\",\"op\":\""
+        << jsonEscape(node.op) << "\",\"ms_per_run\":" << perRun(node.totalUs)
+        << ",\"percent\":" << percent(node.totalUs) << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+}  // namespace broadify::meeting
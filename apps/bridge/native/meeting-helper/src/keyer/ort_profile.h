@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace broadify::meeting {
+
+// Aggregates an ONNX Runtime profile trace (the Chrome trace JSON written by
+// a session with profiling enabled) into a compact JSON object: run latency,
+// kernel time per execution provider, per operator type (with activation
+// and parameter bytes) and the slowest nodes. The first `skipRuns` model
+// runs are warmup and do not count. Returns an empty string when the trace
+// is malformed or holds no counted run.
+std::string summarizeOrtProfile(const std::string &trace, uint32_t skipRuns);
+
+}  // namespace broadify::meeting
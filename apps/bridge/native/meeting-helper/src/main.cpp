@@ -1,15 +1,13 @@
-#include "capture/camera_source.h"
 #include "common/options.h"
 #include "compose/compositor.h"
 #include "control/control_server.h"
+#include "embed/meeting_engine.h"
 #include "keyer/keyer_chain.h"
-#include "pipeline/frame_pipeline.h"
-#include "preview/preview_frame_store.h"
 #include "preview/mjpeg_server.h"
 #include "preview/raw_frame_server.h"
-#include "recorder/meeting_recorder.h"
 #include "state/meeting_state.h"
 #include "util/json_utils.h"
+#include "util/thread_roles.h"
 
 #if defined(__APPLE__)
 #include "macos/macos_app.h"
@@ -24,7 +22,6 @@
 #include <cstring>
 #include <future>
 #include <iostream>
-#include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
@@ -165,20 +162,21 @@ int main(int argc, char **argv) {
 
   // stdout is piped to the bridge; ensure lifecycle events flush promptly.
   setvbuf(stdout, nullptr, _IOLBF, 0);
+  ScopedThreadRole mainRole("main");
 
 #if defined(__APPLE__)
   initializeMacosApplication();
 #endif
 
-  MeetingState state;
-  std::unique_ptr<CameraSource> camera = createCameraSource();
-  PreviewFrameStore previewFrames;
-  MeetingRecorder recorder;
+  // The helper is the engine plus its IPC front ends: the control socket, the
+  // MJPEG/mosaic previews, the raw frame server and the stdout events.
+  MeetingEngine engine(options, g_running);
 
 #if defined(_WIN32)
   if (options.parentPid > 0) {
     const DWORD bridgePid = static_cast<DWORD>(options.parentPid);
     std::thread([bridgePid]() {
+      ScopedThreadRole role("watchdog");
       HANDLE handle = OpenProcess(SYNCHRONIZE, FALSE, bridgePid);
       if (handle == nullptr) {
         return;
@@ -196,6 +194,7 @@ int main(int argc, char **argv) {
   const pid_t bridgePid = static_cast<pid_t>(options.parentPid);
   const pid_t initialParentPid = getppid();
   std::thread([bridgePid, initialParentPid]() {
+    ScopedThreadRole role("watchdog");
     while (g_running.load()) {
       const bool bridgeGone = bridgePid > 0
           ? (kill(bridgePid, 0) != 0 && errno == ESRCH)
@@ -211,17 +210,19 @@ int main(int argc, char **argv) {
 
   std::promise<void> controlListening;
   std::future<void> controlListeningFuture = controlListening.get_future();
-  std::thread frames(runFramePipeline, std::cref(options), std::ref(state), std::ref(*camera), std::ref(previewFrames), std::ref(recorder), std::ref(g_running));
-  std::thread preview(runMjpegServer, options.previewPort, std::ref(previewFrames), std::ref(state), std::ref(g_running));
-  std::thread vcamRaw(runRawFrameServer, options.vcamFramePort, std::ref(previewFrames), std::ref(state), std::ref(g_running));
+  engine.start();
+  std::thread preview(runMjpegServer, options.previewPort, std::ref(engine.previewFrames()), std::ref(engine.state()), std::ref(g_running));
+  std::thread vcamRaw(runRawFrameServer, options.vcamFramePort, std::ref(engine.previewFrames()), std::ref(engine.state()), std::ref(g_running));
+  std::thread mosaic(runMosaicMjpegServer, options.mosaicPort, std::ref(engine.camera()), std::ref(engine.state()), std::ref(g_running));
   std::thread control(
       runControlServer,
       options.controlSocket,
-      std::ref(state),
-      std::ref(*camera),
-      std::ref(previewFrames),
-      std::ref(recorder),
-      std::cref(options),
+      std::ref(engine.state()),
+      std::ref(engine.camera()),
+      std::ref(engine.previewFrames()),
+      std::ref(engine.recorder()),
+      std::ref(engine.capacity()),
+      std::cref(engine.options()),
       std::ref(g_running),
       [&controlListening]() { controlListening.set_value(); });
 
@@ -231,6 +232,7 @@ int main(int argc, char **argv) {
   ready << "{\"type\":\"ready\",\"framebus\":\"" << jsonEscape(options.framebusName)
         << "\",\"preview_port\":" << options.previewPort
         << ",\"vcam_frame_port\":" << options.vcamFramePort
+        << ",\"mosaic_port\":" << options.mosaicPort
         << ",\"control_socket\":\"" << jsonEscape(options.controlSocket) << "\"}";
   printEvent(ready.str());
 
@@ -242,27 +244,18 @@ int main(int argc, char **argv) {
     std::this_thread::sleep_for(std::chrono::seconds(2));
     std::ostringstream metrics;
     metrics << "{\"type\":\"metrics\",\"fps\":" << options.fps
-            << ",\"keyer\":\"passthrough\",\"inference_ms\":null,\"drops\":0,\"tick\":" << tick++ << "}";
+            << ",\"keyer\":\"passthrough\",\"inference_ms\":null,\"drops\":0,\"tick\":" << tick++
+            << ",\"threads\":{" << threadRoleSampleJson(sampleThreadRoles()) << "}}";
     printEvent(metrics.str());
   }
 #endif
 
-  camera->stop();
-  previewFrames.clear();
-  {
-    std::lock_guard<std::mutex> lock(state.mutex);
-    state.framebusRunning = false;
-    state.vcamRawRunning = false;
-  }
-  // The frame pipeline checks g_running and releases the FrameBus shared
-  // memory on its way out - wait for it.
-  if (frames.joinable()) {
-    frames.join();
-  }
-  // The preview/vcam/control servers block in accept() and never observe
+  engine.stop();
+  // The preview/mosaic/vcam/control servers block in accept() and never observe
   // g_running; joining them would hang forever (the historical reason this
   // helper survived every shutdown). Their sockets are closed by the OS.
   preview.detach();
+  mosaic.detach();
   vcamRaw.detach();
   control.detach();
   printEvent("{\"type\":\"shutdown\"}");
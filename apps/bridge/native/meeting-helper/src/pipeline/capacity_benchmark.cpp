@@ -0,0 +1,540 @@
+#include "pipeline/capacity_benchmark.h"
+
+#include "framebus_writer.h"
+#include "keyer/modnet_keyer.h"
+#if defined(__APPLE__)
+#include "keyer/coreml_keyer.h"
+#endif
+#include "pipeline/frame_pipeline.h"
+#include "preview/mjpeg_server.h"
+#include "util/json_utils.h"
+#include "util/thread_roles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+namespace broadify::meeting {
+namespace {
+
+// Wall-clock cap per stage; slow stages report fewer samples instead of
+// stretching the run.
+constexpr double kStageBudgetMs = 1500.0;
+// Upper bound for the program thread to work through the probe queue. A
+// program with no idle time left leaves probes unrun, which the report
+// states instead of blocking.
+constexpr auto kProbeTimeout = std::chrono::seconds(20);
+constexpr uint32_t kProbeMaskSize = 320u;
+constexpr float kPreviewJpegQuality = 0.95f;
+
+double elapsedMs(std::chrono::steady_clock::time_point start,
+                 std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string msNumber(double value) {
+  return value >= 0.0 ? std::to_string(value) : "null";
+}
+
+double medianMs(std::vector<double> samples) {
+  if (samples.empty()) {
+    return -1.0;
+  }
+  const size_t middle = samples.size() / 2u;
+  std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+  return samples[middle];
+}
+
+double maxMs(const std::vector<double> &samples) {
+  return samples.empty() ? -1.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double fpsForMs(double ms) {
+  return ms > 0.0 ? 1000.0 / ms : -1.0;
+}
+
+// Times `fn` up to `iterations` times within the stage budget. Beside a live
+// program every sample is followed by an equal pause, so the run never holds
+// a shared core for more than half the time.
+template <typename Fn>
+void sampleStage(std::vector<double> &samples,
+                 uint32_t iterations,
+                 bool programLive,
+                 const std::atomic<bool> &stopping,
+                 Fn &&fn) {
+  double spentMs = 0.0;
+  for (uint32_t index = 0; index < iterations && !stopping.load(); ++index) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const double ms = elapsedMs(start, std::chrono::steady_clock::now());
+    samples.push_back(ms);
+    spentMs += ms;
+    if (spentMs >= kStageBudgetMs) {
+      break;
+    }
+    if (programLive) {
+      std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+    }
+  }
+}
+
+// Camera-like test card: gradient background with a bright, soft-edged
+// "subject" so keyers and the guided filter see real edges.
+VideoFrame syntheticCameraFrame(uint32_t width, uint32_t height) {
+  VideoFrame frame;
+  frame.width = width;
+  frame.height = height;
+  frame.timestampNs = nowNs();
+  frame.rgba.resize(static_cast<size_t>(width) * height * 4u);
+  const double centerX = width * 0.5;
+  const double centerY = height * 0.55;
+  const double radiusX = width * 0.18;
+  const double radiusY = height * 0.4;
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      const double dx = (x - centerX) / radiusX;
+      const double dy = (y - centerY) / radiusY;
+      const bool subject = dx * dx + dy * dy < 1.0;
+      uint8_t *pixel = frame.rgba.data() + (static_cast<size_t>(y) * width + x) * 4u;
+      pixel[0] = subject ? 214u : static_cast<uint8_t>((x * 96u) / width);
+      pixel[1] = subject ? 176u : static_cast<uint8_t>((y * 128u) / height);
+      pixel[2] = subject ? 150u : 72u;
+      pixel[3] = 255u;
+    }
+  }
+  return frame;
+}
+
+// Graphics overlay with a semi-transparent lower third (back) or an opaque
+// corner box (front), so both layers really blend.
+VideoFrame syntheticGraphicsFrame(uint32_t width, uint32_t height, bool front) {
+  VideoFrame frame;
+  frame.width = width;
+  frame.height = height;
+  frame.timestampNs = nowNs();
+  frame.rgba.assign(static_cast<size_t>(width) * height * 4u, 0u);
+  const uint32_t top = front ? height / 20u : (height * 3u) / 4u;
+  const uint32_t bottom = front ? height / 6u : (height * 9u) / 10u;
+  const uint32_t left = front ? (width * 3u) / 4u : width / 12u;
+  const uint32_t right = front ? (width * 19u) / 20u : (width * 2u) / 3u;
+  for (uint32_t y = top; y < bottom; ++y) {
+    for (uint32_t x = left; x < right; ++x) {
+      uint8_t *pixel = frame.rgba.data() + (static_cast<size_t>(y) * width + x) * 4u;
+      pixel[0] = 20u;
+      pixel[1] = 60u;
+      pixel[2] = 140u;
+      pixel[3] = front ? 255u : 200u;
+    }
+  }
+  return frame;
+}
+
+AlphaMask syntheticMask(uint32_t width, uint32_t height) {
+  AlphaMask mask;
+  mask.width = width;
+  mask.height = height;
+  mask.timestampNs = nowNs();
+  mask.alpha.resize(static_cast<size_t>(width) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      const double dx = (x - width * 0.5) / (width * 0.3);
+      const double dy = (y - height * 0.55) / (height * 0.4);
+      const double distance = std::sqrt(dx * dx + dy * dy);
+      const double alpha = std::clamp((1.1 - distance) * 5.0, 0.0, 1.0);
+      mask.alpha[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(alpha * 255.0 + 0.5);
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+
+CapacityBenchmark::CapacityBenchmark(const Options &options) : options_(options) {}
+
+CapacityBenchmark::~CapacityBenchmark() {
+  stopping_.store(true);
+  probesDone_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool CapacityBenchmark::start(const CapacityRequest &request, bool programLive) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return false;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  running_ = true;
+  thread_ = std::thread(&CapacityBenchmark::run, this, request, programLive);
+  return true;
+}
+
+std::string CapacityBenchmark::statusJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream out;
+  out << "\"running\":" << (running_ ? "true" : "false")
+      << ",\"runs\":" << runs_
+      << ",\"report\":" << (report_.empty() ? "null" : report_);
+  return out.str();
+}
+
+bool CapacityBenchmark::runProgramProbe(std::chrono::steady_clock::duration slack) {
+  Probe probe;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (probes_.empty() ||
+        probeEstimateMs_ > std::chrono::duration<double, std::milli>(slack).count()) {
+      return false;
+    }
+    probe = probes_.front();
+    probes_.pop_front();
+    probeActive_ = true;
+  }
+
+  // The run inputs stay untouched while probes are queued; only the program
+  // thread reads them until the queue drains.
+  ProbeScene &scene = scenes_[probe.scene];
+  camera_.timestampNs = nowNs();
+  backGraphics_.timestampNs = camera_.timestampNs;
+  frontGraphics_.timestampNs = camera_.timestampNs;
+  AlphaMask mask;
+  double refineMs = -1.0;
+  if (scene.keyed) {
+    mask = probeMask_;
+    const auto refineStart = std::chrono::steady_clock::now();
+    refineKeyerMask(mask, camera_);
+    refineMs = elapsedMs(refineStart, std::chrono::steady_clock::now());
+  }
+  const auto composeStart = std::chrono::steady_clock::now();
+  const std::string backend = renderProgramFrame(
+      probeOptions_,
+      scene.snapshot,
+      &camera_,
+      scene.keyed ? &mask : nullptr,
+      scene.graphics ? &backGraphics_ : nullptr,
+      scene.graphics ? &frontGraphics_ : nullptr,
+      probeFrameIndex_++,
+      probeTarget_,
+      nullptr);
+  if (scene.pip) {
+    drawCameraPipInset(probeTarget_, probeOptions_.width, probeOptions_.height, pipCamera_);
+  }
+  const double composeMs = elapsedMs(composeStart, std::chrono::steady_clock::now());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  probeActive_ = false;
+  probeEstimateMs_ = std::max(0.0, refineMs) + composeMs;
+  if (!probe.warmup) {
+    if (refineMs >= 0.0) {
+      scene.refine.ms.push_back(refineMs);
+    }
+    scene.composite.ms.push_back(composeMs);
+    scene.composite.detail = backend;
+  }
+  if (probes_.empty()) {
+    probesDone_.notify_all();
+  }
+  return true;
+}
+
+void CapacityBenchmark::run(CapacityRequest request, bool programLive) {
+  ScopedThreadRole role("capacity");
+  const auto start = std::chrono::steady_clock::now();
+  camera_ = syntheticCameraFrame(request.width, request.height);
+  pipCamera_ = syntheticCameraFrame(request.width / 2u, request.height / 2u);
+  backGraphics_ = syntheticGraphicsFrame(request.width, request.height, false);
+  frontGraphics_ = syntheticGraphicsFrame(request.width, request.height, true);
+
+  runKeyerStages(request, programLive);
+  runEncodeStages(request, programLive);
+  runProgramProbes(request);
+
+  const double durationMs = elapsedMs(start, std::chrono::steady_clock::now());
+  std::string report = capacityReportJson(request, samples(), programLive, durationMs);
+  camera_ = VideoFrame{};
+  pipCamera_ = VideoFrame{};
+  backGraphics_ = VideoFrame{};
+  frontGraphics_ = VideoFrame{};
+  probeTarget_ = std::vector<uint8_t>{};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  report_ = std::move(report);
+  ++runs_;
+  running_ = false;
+  std::cout << "{\"type\":\"meeting_capacity\",\"event\":\"completed\",\"runs\":" << runs_
+            << ",\"duration_ms\":" << durationMs << "}" << std::endl;
+}
+
+void CapacityBenchmark::runKeyerStages(const CapacityRequest &request, bool programLive) {
+  keyers_.clear();
+  const std::pair<const char *, uint32_t> modes[] = {
+      {"high_quality", 512u}, {"balanced", 320u}, {"performance", 256u}};
+  for (const auto &[mode, nominalSize] : modes) {
+    KeyerStage stage;
+    stage.keyer = "modnet";
+    stage.mode = mode;
+    stage.inputSize = nominalSize;
+    keyers_.push_back(std::move(stage));
+  }
+#if defined(__APPLE__)
+  {
+    KeyerStage stage;
+    stage.keyer = "coreml";
+    stage.mode = "high_quality";
+    keyers_.push_back(std::move(stage));
+  }
+#endif
+
+  for (KeyerStage &stage : keyers_) {
+    if (stopping_.load()) {
+      return;
+    }
+    // A private keyer per input size: the live keyer chain is never touched,
+    // and sizes that freeze at session creation get their own session.
+    std::unique_ptr<Keyer> keyer;
+#if defined(__APPLE__)
+    if (stage.keyer == "coreml") {
+      keyer = std::make_unique<CoreMLKeyer>(options_.modelsDir);
+    }
+#endif
+    if (keyer == nullptr) {
+      keyer = std::make_unique<ModnetKeyer>(ModnetKeyerOptions{options_.modelsDir, false});
+    }
+    KeyerSettings settings;
+    settings.performanceMode = stage.mode;
+    // The first call loads the model and builds the session; it is not a
+    // steady-state sample.
+    const KeyerResult warmup = keyer->apply(camera_, settings);
+    if (warmup.mask.alpha.empty() || warmup.status.fallbackActive) {
+      stage.inference.available = false;
+      stage.inference.detail = warmup.status.fallbackReason;
+    } else {
+      stage.provider = warmup.status.provider;
+      stage.inputSize = warmup.mask.width;
+      sampleStage(stage.inference.ms, request.iterations, programLive, stopping_, [&]() { keyer->apply(camera_, settings); });
+    }
+
+    const uint32_t maskSize = stage.inputSize > 0u ? stage.inputSize : kProbeMaskSize;
+    const AlphaMask source = syntheticMask(maskSize, maskSize);
+    AlphaMask mask;
+    KeyerMetrics metrics;
+    sampleStage(stage.postprocess.ms, request.iterations, programLive, stopping_, [&]() {
+      mask = source;
+      postprocessKeyerMask(mask, source, settings, 33.0, metrics);
+    });
+  }
+}
+
+void CapacityBenchmark::runEncodeStages(const CapacityRequest &request, bool programLive) {
+  previewEncode_ = StageSamples{};
+  previewEncode_.available = previewJpegEncoderAvailable();
+  if (previewEncode_.available) {
+    sampleStage(previewEncode_.ms, request.iterations, programLive, stopping_, [&]() {
+      encodePreviewJpeg(camera_.width, camera_.height, camera_.rgba, kPreviewJpegQuality);
+    });
+  } else {
+    previewEncode_.detail = "no_platform_encoder";
+  }
+
+  // A private segment: readers of the program FrameBus never see it.
+  framebusWrite_ = StageSamples{};
+  const std::string name = options_.framebusName + "-capacity";
+  framebus_writer_t *writer =
+      framebus_writer_open(name.c_str(), request.width, request.height, request.fps, 3u);
+  if (writer == nullptr) {
+    framebusWrite_.available = false;
+    framebusWrite_.detail = "framebus_open_failed";
+    return;
+  }
+  sampleStage(framebusWrite_.ms, request.iterations, programLive, stopping_, [&]() {
+    framebus_writer_write_rgba(writer, camera_.rgba.data(), camera_.rgba.size(), nowNs());
+  });
+  framebus_writer_close(writer);
+}
+
+void CapacityBenchmark::runProgramProbes(const CapacityRequest &request) {
+  std::vector<ProbeScene> scenes(4);
+  scenes[0].name = "camera";
+  scenes[1].name = "keyed";
+  scenes[1].snapshot.keyerEnabled = true;
+  scenes[1].keyed = true;
+  scenes[2].name = "keyed_graphics";
+  scenes[2].snapshot.keyerEnabled = true;
+  scenes[2].keyed = true;
+  scenes[2].graphics = true;
+  scenes[3].name = "conference_pip";
+  scenes[3].snapshot.conferenceMode = true;
+  scenes[3].pip = true;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  scenes_ = std::move(scenes);
+  probeMask_ = syntheticMask(kProbeMaskSize, kProbeMaskSize);
+  probeOptions_ = options_;
+  probeOptions_.width = request.width;
+  probeOptions_.height = request.height;
+  probeOptions_.fps = request.fps;
+  probeTarget_.assign(static_cast<size_t>(request.width) * request.height * 4u, 0u);
+  probeEstimateMs_ = 0.0;
+  probes_.clear();
+  // Interleave the scenes so a program that runs out of idle time still
+  // leaves samples for each of them.
+  for (size_t scene = 0; scene < scenes_.size(); ++scene) {
+    probes_.push_back(Probe{scene, true});
+  }
+  for (uint32_t index = 0; index < request.iterations; ++index) {
+    for (size_t scene = 0; scene < scenes_.size(); ++scene) {
+      probes_.push_back(Probe{scene, false});
+    }
+  }
+  const bool drained = probesDone_.wait_for(lock, kProbeTimeout, [&]() {
+    return stopping_.load() || (probes_.empty() && !probeActive_);
+  });
+  if (!drained) {
+    probes_.clear();
+    probesDone_.wait(lock, [&]() { return !probeActive_; });
+  }
+  for (ProbeScene &scene : scenes_) {
+    if (scene.composite.ms.empty()) {
+      scene.composite.available = false;
+      scene.composite.detail = "program_thread_busy";
+    }
+    if (scene.keyed && scene.refine.ms.empty()) {
+      scene.refine.available = false;
+    }
+  }
+}
+
+CapacitySamples CapacityBenchmark::samples() const {
+  CapacitySamples samples;
+  samples.keyers = keyers_;
+  samples.scenes.reserve(scenes_.size());
+  for (const ProbeScene &scene : scenes_) {
+    CapacitySceneSamples sceneSamples;
+    sceneSamples.name = scene.name;
+    sceneSamples.keyed = scene.keyed;
+    sceneSamples.refine = scene.refine;
+    sceneSamples.composite = scene.composite;
+    samples.scenes.push_back(std::move(sceneSamples));
+  }
+  samples.previewEncode = previewEncode_;
+  samples.framebusWrite = framebusWrite_;
+  return samples;
+}
+
+std::string capacityReportJson(const CapacityRequest &request,
+                               const CapacitySamples &samples,
+                               bool programLive,
+                               double durationMs) {
+  const std::vector<CapacityKeyerSamples> &keyers = samples.keyers;
+  const std::vector<CapacitySceneSamples> &scenes = samples.scenes;
+  const auto stageJson = [](const CapacityStageSamples &stage) {
+    std::ostringstream out;
+    out << "\"available\":" << (stage.available ? "true" : "false")
+        << ",\"samples\":" << stage.ms.size()
+        << ",\"median_ms\":" << msNumber(medianMs(stage.ms))
+        << ",\"max_ms\":" << msNumber(maxMs(stage.ms));
+    if (!stage.detail.empty()) {
+      out << ",\"detail\":\"" << jsonEscape(stage.detail) << "\"";
+    }
+    return out.str();
+  };
+
+  std::vector<double> refineSamples;
+  for (const CapacitySceneSamples &scene : scenes) {
+    refineSamples.insert(refineSamples.end(), scene.refine.ms.begin(), scene.refine.ms.end());
+  }
+  CapacityStageSamples refine;
+  refine.ms = refineSamples;
+  refine.available = !refineSamples.empty();
+  const double framebusMs = std::max(0.0, medianMs(samples.framebusWrite.ms));
+
+  std::ostringstream out;
+  out << "{\"width\":" << request.width
+      << ",\"height\":" << request.height
+      << ",\"target_fps\":" << request.fps
+      << ",\"iterations\":" << request.iterations
+      << ",\"program_live\":" << (programLive ? "true" : "false")
+      << ",\"duration_ms\":" << durationMs
+      << ",\"stages\":{\"keyer\":[";
+  for (size_t index = 0; index < keyers.size(); ++index) {
+    const CapacityKeyerSamples &stage = keyers[index];
+    out << (index > 0 ? "," : "")
+        << "{\"keyer\":\"" << stage.keyer
+        << "\",\"mode\":\"" << stage.mode
+        << "\",\"input_size\":" << stage.inputSize
+        << ",\"provider\":\"" << jsonEscape(stage.provider)
+        << "\"," << stageJson(stage.inference) << "}";
+  }
+  out << "],\"postprocess\":[";
+  for (size_t index = 0; index < keyers.size(); ++index) {
+    out << (index > 0 ? "," : "")
+        << "{\"mask_size\":" << (keyers[index].inputSize > 0u ? keyers[index].inputSize : kProbeMaskSize)
+        << "," << stageJson(keyers[index].postprocess) << "}";
+  }
+  out << "],\"guided_refine\":{\"mask_size\":" << kProbeMaskSize << "," << stageJson(refine)
+      << "},\"composite\":[";
+  for (size_t index = 0; index < scenes.size(); ++index) {
+    out << (index > 0 ? "," : "")
+        << "{\"scene\":\"" << scenes[index].name << "\"," << stageJson(scenes[index].composite) << "}";
+  }
+  out << "],\"preview_encode\":{" << stageJson(samples.previewEncode)
+      << ",\"max_fps\":" << msNumber(fpsForMs(medianMs(samples.previewEncode.ms)))
+      << "},\"framebus_write\":{" << stageJson(samples.framebusWrite) << "}}";
+
+  // Program thread per frame: refine + composite + FrameBus publish. The
+  // keyer runs beside it on its own thread, so it bounds the mask rate, not
+  // the program rate.
+  out << ",\"configurations\":[";
+  bool first = true;
+  const auto writeConfiguration = [&](const CapacitySceneSamples &scene, const CapacityKeyerSamples *keyer) {
+    const double composeMs = medianMs(scene.composite.ms);
+    const double refineMs = scene.keyed ? medianMs(scene.refine.ms) : 0.0;
+    const bool available = composeMs >= 0.0 && refineMs >= 0.0 &&
+        (keyer == nullptr || keyer->inference.available);
+    out << (first ? "" : ",") << "{\"scene\":\"" << scene.name << "\"";
+    first = false;
+    if (keyer != nullptr) {
+      out << ",\"keyer\":\"" << keyer->keyer << "\",\"keyer_mode\":\"" << keyer->mode
+          << "\",\"keyer_input_size\":" << keyer->inputSize;
+    }
+    out << ",\"available\":" << (available ? "true" : "false");
+    if (!available) {
+      out << "}";
+      return;
+    }
+    const double programMs = composeMs + refineMs + framebusMs;
+    const double maxFps = fpsForMs(programMs);
+    bool meetsTarget = maxFps >= static_cast<double>(request.fps);
+    out << ",\"program_ms\":" << msNumber(programMs) << ",\"max_fps\":" << msNumber(maxFps);
+    if (keyer != nullptr) {
+      const double maskMs = medianMs(keyer->inference.ms) +
+          std::max(0.0, medianMs(keyer->postprocess.ms));
+      const double maskFps = fpsForMs(maskMs);
+      const uint32_t keyerTargetFps = std::min(request.fps, targetKeyerFps(keyer->mode));
+      meetsTarget = meetsTarget && maskFps >= static_cast<double>(keyerTargetFps);
+      out << ",\"mask_ms\":" << msNumber(maskMs)
+          << ",\"mask_fps\":" << msNumber(maskFps)
+          << ",\"mask_target_fps\":" << keyerTargetFps;
+    }
+    out << ",\"meets_target\":" << (meetsTarget ? "true" : "false") << "}";
+  };
+  for (const CapacitySceneSamples &scene : scenes) {
+    if (!scene.keyed) {
+      writeConfiguration(scene, nullptr);
+      continue;
+    }
+    for (const CapacityKeyerSamples &keyer : keyers) {
+      writeConfiguration(scene, &keyer);
+    }
+  }
+  out << "]}";
+  return out.str();
+}
+
+}  // namespace broadify::meeting
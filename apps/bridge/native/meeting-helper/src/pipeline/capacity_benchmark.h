@@ -0,0 +1,154 @@
+#pragma once
+
+#include "capture/camera_source.h"
+#include "common/options.h"
+#include "compose/compositor.h"
+#include "keyer/keyer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Output geometry a diagnostics.capacity run predicts for. Zero fields fall
+// back to the live output config.
+struct CapacityRequest {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t fps = 0;
+  uint32_t iterations = 8;
+};
+
+// Timings of one benchmark stage. A stage that could not run is reported as
+// unavailable, with `detail` saying why.
+struct CapacityStageSamples {
+  std::vector<double> ms;
+  std::string detail;
+  bool available = true;
+};
+
+struct CapacityKeyerSamples {
+  std::string keyer;
+  std::string mode;  // performance mode that selects this input size
+  uint32_t inputSize = 0;
+  std::string provider;
+  CapacityStageSamples inference;
+  CapacityStageSamples postprocess;
+};
+
+struct CapacitySceneSamples {
+  std::string name;
+  bool keyed = false;
+  CapacityStageSamples refine;
+  CapacityStageSamples composite;
+};
+
+// Everything one run measured; the input of the report.
+struct CapacitySamples {
+  std::vector<CapacityKeyerSamples> keyers;
+  std::vector<CapacitySceneSamples> scenes;
+  CapacityStageSamples previewEncode;
+  CapacityStageSamples framebusWrite;
+};
+
+// The diagnostics.capacity report for `samples`: per-stage medians and, per
+// scene/keyer configuration, the predicted program and mask rates against
+// the request's target.
+std::string capacityReportJson(const CapacityRequest &request,
+                               const CapacitySamples &samples,
+                               bool programLive,
+                               double durationMs);
+
+// On-box capacity benchmark behind diagnostics.capacity. A run times short,
+// isolated samples of the real stage implementations on synthetic frames and
+// predicts the highest sustainable frame rate for each scene/keyer
+// configuration at the requested geometry.
+//
+// Stages with private state (keyer inference on its own keyer instance, mask
+// postprocess, preview JPEG encode, FrameBus write to a private segment) run
+// on the benchmark's own thread. Guided refine and compositing share the GPU
+// context with the program loop, which is their only permitted caller: the
+// frame pipeline runs those samples itself through runProgramProbe(), one
+// per frame and only inside the frame's idle time, so the program keeps its
+// cadence while a run is in progress.
+class CapacityBenchmark {
+ public:
+  explicit CapacityBenchmark(const Options &options);
+  ~CapacityBenchmark();
+
+  CapacityBenchmark(const CapacityBenchmark &) = delete;
+  CapacityBenchmark &operator=(const CapacityBenchmark &) = delete;
+
+  // Control thread. Starts a run in the background; returns false when one
+  // is already in progress. `programLive` marks the results as measured
+  // alongside an active program, which also halves the benchmark's duty
+  // cycle on the shared cores.
+  bool start(const CapacityRequest &request, bool programLive);
+  // Control thread: "running", "runs" and the latest report (or null) as
+  // JSON object members, without the surrounding braces.
+  std::string statusJson() const;
+
+  // Program thread. Runs at most one pending probe when it is expected to
+  // fit in `slack`; returns true when it ran one.
+  bool runProgramProbe(std::chrono::steady_clock::duration slack);
+
+ private:
+  using StageSamples = CapacityStageSamples;
+  using KeyerStage = CapacityKeyerSamples;
+  struct ProbeScene {
+    std::string name;
+    CompositorSnapshot snapshot;
+    bool keyed = false;
+    bool graphics = false;
+    bool pip = false;
+    StageSamples refine;
+    StageSamples composite;
+  };
+  struct Probe {
+    size_t scene = 0;
+    bool warmup = false;
+  };
+
+  void run(CapacityRequest request, bool programLive);
+  void runKeyerStages(const CapacityRequest &request, bool programLive);
+  void runEncodeStages(const CapacityRequest &request, bool programLive);
+  void runProgramProbes(const CapacityRequest &request);
+  CapacitySamples samples() const;
+
+  Options options_;
+  std::thread thread_;
+  std::atomic<bool> stopping_{false};
+  mutable std::mutex mutex_;
+  std::condition_variable probesDone_;
+  bool running_ = false;
+  uint64_t runs_ = 0;
+  std::string report_;
+
+  // Run inputs, owned by the benchmark thread while a run is active; the
+  // probe fields below are shared with the program thread under mutex_.
+  VideoFrame camera_;
+  VideoFrame pipCamera_;
+  VideoFrame backGraphics_;
+  VideoFrame frontGraphics_;
+  AlphaMask probeMask_;
+  Options probeOptions_;
+  std::vector<uint8_t> probeTarget_;
+  std::vector<ProbeScene> scenes_;
+  std::deque<Probe> probes_;
+  bool probeActive_ = false;
+  double probeEstimateMs_ = 0.0;
+  uint64_t probeFrameIndex_ = 0;
+
+  std::vector<KeyerStage> keyers_;
+  StageSamples previewEncode_;
+  StageSamples framebusWrite_;
+};
+
+}  // namespace broadify::meeting
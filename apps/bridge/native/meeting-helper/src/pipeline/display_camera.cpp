@@ -0,0 +1,68 @@
+#include "pipeline/display_camera.h"
+
+#include "keyer/chroma_keyer.h"
+#include "util/image_resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace broadify::meeting {
+
+double quantizedDisplayScale(double scale) {
+  const double stepped = std::ceil(std::clamp(scale, 0.0, 1.0) * kDisplayScaleSteps) / kDisplayScaleSteps;
+  return stepped > kFullSizeDisplayScale ? 1.0 : std::max(stepped, 1.0 / kDisplayScaleSteps);
+}
+
+uint32_t scaledDimension(uint32_t size, double scale) {
+  return std::max(1u, static_cast<uint32_t>(std::lround(size * scale)));
+}
+
+void shrinkMaskToDisplay(AlphaMask &mask, uint32_t cameraWidth, double displayScale) {
+  if (mask.alpha.empty() || cameraWidth == 0u || displayScale >= 1.0) {
+    return;
+  }
+  const uint32_t displayWidth = scaledDimension(cameraWidth, displayScale);
+  if (mask.width <= displayWidth) {
+    return;
+  }
+  const double maskScale = static_cast<double>(displayWidth) / mask.width;
+  AlphaMask shrunk;
+  shrunk.width = displayWidth;
+  shrunk.height = scaledDimension(mask.height, maskScale);
+  shrunk.timestampNs = mask.timestampNs;
+  shrunk.alpha.resize(static_cast<size_t>(shrunk.width) * shrunk.height);
+  resampleImage({mask.alpha.data(), mask.width, mask.height, mask.width, 1u},
+                {shrunk.alpha.data(), shrunk.width, shrunk.height, shrunk.width, 1u},
+                ResampleFilter::kArea);
+  mask = std::move(shrunk);
+}
+
+const VideoFrame &DisplayCameraFrame::update(VideoFrame &camera, double displayScale, const ChromaKeySettings *spill) {
+  const double scale = quantizedDisplayScale(displayScale);
+  if (scale >= 1.0) {
+    if (spill != nullptr && spillSuppressedNs_ != camera.timestampNs) {
+      suppressChromaSpill(camera, *spill);
+      spillSuppressedNs_ = camera.timestampNs;
+    }
+    return camera;
+  }
+  const uint32_t width = scaledDimension(camera.width, scale);
+  const uint32_t height = scaledDimension(camera.height, scale);
+  if (scaled_.width != width || scaled_.height != height || scaled_.timestampNs != camera.timestampNs) {
+    scaled_.width = width;
+    scaled_.height = height;
+    scaled_.timestampNs = camera.timestampNs;
+    scaled_.rgba.resize(static_cast<size_t>(width) * height * 4u);
+    resampleImage({camera.rgba.data(), camera.width, camera.height, static_cast<size_t>(camera.width) * 4u, 4u},
+                  {scaled_.rgba.data(), width, height, static_cast<size_t>(width) * 4u, 4u},
+                  ResampleFilter::kArea);
+    // The source is still raw unless the full-size path already cleaned it.
+    if (spill != nullptr && spillSuppressedNs_ != camera.timestampNs) {
+      suppressChromaSpill(scaled_, *spill);
+    }
+  }
+  return scaled_;
+}
+
+}  // namespace broadify::meeting
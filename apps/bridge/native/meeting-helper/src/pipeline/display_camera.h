@@ -0,0 +1,50 @@
+#pragma once
+
+#include "capture/camera_source.h"
+#include "keyer/keyer.h"
+
+#include <cstdint>
+
+namespace broadify::meeting {
+
+// Display scales are rounded up to sixteenths, so an animating layout
+// resizes the display copies in steps instead of every frame. Above
+// kFullSizeDisplayScale the downscale would cost more than it saves.
+constexpr double kDisplayScaleSteps = 16.0;
+constexpr double kFullSizeDisplayScale = 0.75;
+
+// `scale` (clamped to 0..1) rounded up to the next sixteenth, at least one
+// step; 1.0 above kFullSizeDisplayScale.
+double quantizedDisplayScale(double scale);
+
+// `size` * `scale`, rounded, at least 1.
+uint32_t scaledDimension(uint32_t size, double scale);
+
+// Area-downscales a mask that is larger than its on-screen size, so the
+// postprocess chain (close, erode, dilate, feather) runs on the pixels that
+// are shown. Masks at or below that size are left alone.
+void shrinkMaskToDisplay(AlphaMask &mask, uint32_t cameraWidth, double displayScale);
+
+// The program's view of the camera at the size the layout shows it. A
+// camera shown near full size is used as is; a smaller one (speaker layout
+// scaled down) is area-downscaled once per camera frame or size step, and
+// guided refine, spill suppression and the compositor then all work on
+// the smaller copy. The keyer keeps the full frame.
+class DisplayCameraFrame {
+ public:
+  // `spill` (nullptr = off) is removed exactly once from the pixels
+  // returned for each camera frame.
+  const VideoFrame &update(VideoFrame &camera, double displayScale, const ChromaKeySettings *spill);
+
+  void clear() {
+    scaled_ = VideoFrame{};
+    spillSuppressedNs_ = 0u;
+  }
+
+ private:
+  VideoFrame scaled_;
+  // Camera frame whose own pixels were spill-suppressed in place.
+  uint64_t spillSuppressedNs_ = 0u;
+};
+
+}  // namespace broadify::meeting
@@ -5,21 +5,28 @@
 #include "compose/d3d11_compositor.h"
 #endif
 #include "director/auto_director.h"
+#include "director/auto_framer.h"
 #include "framebus_reader.h"
 #include "framebus_writer.h"
+#include "keyer/chroma_keyer.h"
 #include "keyer/keyer_chain.h"
 #if defined(__APPLE__)
 #include "keyer/coreml_keyer.h"
 #endif
+#include "pipeline/capacity_benchmark.h"
+#include "pipeline/display_camera.h"
 #include "pipeline/guided_mask_refine.h"
 #include "recorder/meeting_recorder.h"
+#include "util/frame_copy.h"
 #include "util/json_utils.h"
+#include "util/thread_roles.h"
 
 #include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <condition_variable>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <iostream>
 #include <memory>
@@ -32,7 +39,6 @@
 namespace broadify::meeting {
 namespace {
 
-constexpr uint32_t kSlotCount = 3;
 constexpr uint32_t kMaxAlphaDilateRadiusPx = 8;
 constexpr uint32_t kMaxAlphaFeatherRadiusPx = 3;
 constexpr uint32_t kMaskCloseRadiusPx = 2;
@@ -82,6 +88,7 @@ struct PipelineRuntimeState {
   bool framebusRunning = false;
   int previewClients = 0;
   int vcamClients = 0;
+  int embedClients = 0;
   bool programDirty = false;
   bool graphicsDirty = false;
   uint64_t programRevision = 0;
@@ -89,21 +96,9 @@ struct PipelineRuntimeState {
   std::string mode = "idle";
 };
 
-uint32_t targetKeyerFps(const std::string &performanceMode) {
-  if (performanceMode == "quality") {
-    return 25u;
-  }
-  if (performanceMode == "balanced") {
-    return 20u;
-  }
-  if (performanceMode == "performance") {
-    return 15u;
-  }
-  return 30u;
-}
-
 bool hasActiveOutputConsumer(const PipelineRuntimeState &runtime) {
-  return runtime.framebusRunning || runtime.previewClients > 0 || runtime.vcamClients > 0;
+  return runtime.framebusRunning || runtime.previewClients > 0 || runtime.vcamClients > 0 ||
+      runtime.embedClients > 0;
 }
 
 bool isGraphicsOutputActive(const CompositorSnapshot &snapshot) {
@@ -228,6 +223,45 @@ void refineLiveMask(AlphaMask &mask, const VideoFrame &guideFrame) {
   mask.timestampNs = guideFrame.timestampNs;
 }
 
+// Copies `window` of `frame` into `crop`, reusing its storage.
+void copyCameraWindow(const VideoFrame &frame, const CameraWindow &window, VideoFrame &crop) {
+  crop.width = window.width;
+  crop.height = window.height;
+  crop.timestampNs = frame.timestampNs;
+  crop.rgba.resize(static_cast<size_t>(window.width) * window.height * 4u);
+  const size_t rowBytes = static_cast<size_t>(window.width) * 4u;
+  for (uint32_t y = 0; y < window.height; ++y) {
+    std::memcpy(crop.rgba.data() + y * rowBytes,
+                frame.rgba.data() + (static_cast<size_t>(window.y + y) * frame.width + window.x) * 4u, rowBytes);
+  }
+}
+
+// Puts a mask keyed from `window` of a frameWidth x frameHeight camera back
+// into whole-frame coordinates at the same density, transparent outside the
+// window, so every consumer keeps mapping masks onto the whole frame.
+void expandMaskToFrame(AlphaMask &mask, const CameraWindow &window, uint32_t frameWidth, uint32_t frameHeight) {
+  if (mask.alpha.empty() || window.width == 0u || window.height == 0u ||
+      (window.width == frameWidth && window.height == frameHeight)) {
+    return;
+  }
+  AlphaMask expanded;
+  expanded.width = std::max(mask.width, static_cast<uint32_t>(std::lround(
+                                            static_cast<double>(mask.width) * frameWidth / window.width)));
+  expanded.height = std::max(mask.height, static_cast<uint32_t>(std::lround(
+                                              static_cast<double>(mask.height) * frameHeight / window.height)));
+  expanded.timestampNs = mask.timestampNs;
+  expanded.alpha.assign(static_cast<size_t>(expanded.width) * expanded.height, 0u);
+  const uint32_t offsetX = std::min(expanded.width - mask.width, static_cast<uint32_t>(std::lround(
+                                        static_cast<double>(window.x) * expanded.width / frameWidth)));
+  const uint32_t offsetY = std::min(expanded.height - mask.height, static_cast<uint32_t>(std::lround(
+                                        static_cast<double>(window.y) * expanded.height / frameHeight)));
+  for (uint32_t y = 0; y < mask.height; ++y) {
+    std::memcpy(expanded.alpha.data() + static_cast<size_t>(offsetY + y) * expanded.width + offsetX,
+                mask.alpha.data() + static_cast<size_t>(y) * mask.width, mask.width);
+  }
+  mask = std::move(expanded);
+}
+
 bool hasDegenerateForegroundCoverage(const AlphaMask &mask) {
   if (mask.alpha.empty()) {
     return false;
@@ -580,7 +614,9 @@ class AsyncKeyerWorker {
     stop();
   }
 
-  void submit(const VideoFrame &frame) {
+  // Queues `window` of `frame` for keying; the published mask still covers
+  // the whole frame, transparent outside the window.
+  void submit(const VideoFrame &frame, const CameraWindow &window) {
     uint32_t targetFps = 30u;
     {
       std::lock_guard<std::mutex> stateLock(state_.mutex);
@@ -597,7 +633,14 @@ class AsyncKeyerWorker {
     if (hasPendingFrame_) {
       ++droppedFrames_;
     }
-    pendingFrame_ = frame;
+    if (window.width == frame.width && window.height == frame.height) {
+      pendingFrame_ = frame;
+    } else {
+      copyCameraWindow(frame, window, pendingFrame_);
+    }
+    pendingWindow_ = window;
+    pendingFrameWidth_ = frame.width;
+    pendingFrameHeight_ = frame.height;
     pendingGeneration_ = generation_;
     hasPendingFrame_ = true;
     lastSubmittedAt_ = now;
@@ -609,6 +652,13 @@ class AsyncKeyerWorker {
     return latestPair_;
   }
 
+  // On-screen scale of the keyed camera (cameraDisplayScale); masks larger
+  // than that are shrunk before postprocessing.
+  void setDisplayScale(double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    displayScale_ = quantizedDisplayScale(scale);
+  }
+
   void clear() {
     std::lock_guard<std::mutex> lock(mutex_);
     ++generation_;
@@ -649,8 +699,12 @@ class AsyncKeyerWorker {
 
  private:
   void run() {
+    ScopedThreadRole role("keyer");
     while (running_.load()) {
       VideoFrame frame;
+      CameraWindow window;
+      uint32_t frameWidth = 0u;
+      uint32_t frameHeight = 0u;
       uint64_t generation = 0;
       {
         std::unique_lock<std::mutex> lock(mutex_);
@@ -661,18 +715,26 @@ class AsyncKeyerWorker {
           return;
         }
         frame = std::move(pendingFrame_);
+        window = pendingWindow_;
+        frameWidth = pendingFrameWidth_;
+        frameHeight = pendingFrameHeight_;
         generation = pendingGeneration_;
         hasPendingFrame_ = false;
       }
 
       const uint64_t keyerStartNs = nowNs();
       KeyerResult keyed = keyerChain_.process(frame, state_);
+      if (keyed.profile.revision != 0u) {
+        updateMeetingKeyerProfile(state_, keyed.profile);
+      }
       AlphaMask previousMask;
+      double displayScale = 1.0;
       {
         std::lock_guard<std::mutex> lock(mutex_);
         if (latestPair_ != nullptr) {
           previousMask = latestPair_->mask;
         }
+        displayScale = displayScale_;
       }
       if (hasDegenerateForegroundCoverage(keyed.mask)) {
         keyed.mask = AlphaMask{};
@@ -694,13 +756,9 @@ class AsyncKeyerWorker {
         settings.degradation = state_.degradationSettings;
         maskAgeMs = state_.keyerMetrics.maskAgeMs;
       }
-      if (settings.temporalBlendEnabled) {
-        const auto temporalStart = std::chrono::steady_clock::now();
-        blendAlphaTemporal(keyed.mask, previousMask, maskAgeMs);
-        keyed.status.metrics.maskTemporalMs = elapsedMs(
-            temporalStart, std::chrono::steady_clock::now());
-      }
-      postprocessAlpha(keyed.mask, previousMask, settings, maskAgeMs, keyed.status.metrics);
+      expandMaskToFrame(keyed.mask, window, frameWidth, frameHeight);
+      shrinkMaskToDisplay(keyed.mask, frameWidth, displayScale);
+      postprocessKeyerMask(keyed.mask, previousMask, settings, maskAgeMs, keyed.status.metrics);
       bool shouldPublish = false;
       {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -758,6 +816,9 @@ class AsyncKeyerWorker {
   std::condition_variable cv_;
   std::thread thread_;
   VideoFrame pendingFrame_;
+  CameraWindow pendingWindow_;
+  uint32_t pendingFrameWidth_ = 0;
+  uint32_t pendingFrameHeight_ = 0;
   std::shared_ptr<const PairedKeyerFrame> latestPair_;
   uint64_t generation_ = 0;
   uint64_t pendingGeneration_ = 0;
@@ -768,6 +829,7 @@ class AsyncKeyerWorker {
   std::chrono::steady_clock::time_point lastDropRateSample_{};
   uint64_t lastDropRateTotal_ = 0u;
   double droppedFramesPerSec_ = -1.0;
+  double displayScale_ = 1.0;
   bool hasPendingFrame_ = false;
   bool stopping_ = false;
 };
@@ -780,16 +842,26 @@ class GraphicsFrameBusReader {
     close();
   }
 
-  bool copyLatest(VideoFrame &frame, bool enabled) {
+  // The latest graphics frame, or nullptr before the first one (and while
+  // graphics output is off). It is the reader's own buffer, handed out
+  // without a copy: it stays valid and unchanged until the next call.
+  const VideoFrame *latest(bool enabled) {
     if (!enabled) {
       close();
       hasLatestFrame_ = false;
       latestFrame_ = VideoFrame{};
-      return false;
+      return nullptr;
     }
+    readNewFrame();
+    return hasLatestFrame_ ? &latestFrame_ : nullptr;
+  }
+
+ private:
+  // Copies a newer FrameBus frame (if any) into latestFrame_.
+  void readNewFrame() {
     ensureOpen();
     if (reader_ == nullptr) {
-      return hasLatestFrame_;
+      return;
     }
 
     uint32_t width = 0;
@@ -798,7 +870,7 @@ class GraphicsFrameBusReader {
     if (framebus_reader_get_info(reader_, &width, &height, &fps) != 0 || width == 0u || height == 0u) {
       logReaderEvent("info_failed", width, height, fps, 0, 0);
       close();
-      return hasLatestFrame_;
+      return;
     }
 
     const size_t requiredSize = static_cast<size_t>(width) * height * 4u;
@@ -809,7 +881,13 @@ class GraphicsFrameBusReader {
     if (result == -1) {
       logReaderEvent("copy_failed", width, height, fps, 0, 0);
       close();
-      return hasLatestFrame_;
+      return;
+    }
+    if (result == -3) {
+      // Writer replaced the segment (new geometry); reopen on the next tick.
+      logReaderEvent("retired", width, height, fps, 0, 0);
+      close();
+      return;
     }
     if (result == 1) {
       uint64_t nonTransparentPixels = 0;
@@ -827,20 +905,15 @@ class GraphicsFrameBusReader {
       latestFrame_.width = width;
       latestFrame_.height = height;
       latestFrame_.timestampNs = nowNs();
-      latestFrame_.rgba = scratch_;
+      // Swap rather than copy: scratch_ keeps the previous buffer for the next read.
+      latestFrame_.rgba.swap(scratch_);
       hasLatestFrame_ = true;
       if (shouldSampleAlpha) {
         logReaderEvent("frame_read", width, height, fps, nonTransparentPixels, maxAlpha);
       }
     }
-
-    if (hasLatestFrame_) {
-      frame = latestFrame_;
-    }
-    return hasLatestFrame_;
   }
 
- private:
   void ensureOpen() {
     if (reader_ != nullptr) {
       return;
@@ -895,33 +968,114 @@ class GraphicsFrameBusReader {
   std::vector<uint8_t> scratch_;
 };
 
+// Swaps the program FrameBus segment to `requested` between two frames.
+// Closing first marks the old segment retired, so readers drop it and reopen
+// the name; the writer always maps a fresh segment, so the retired one stays
+// as readers last saw it. If the new geometry cannot be mapped, the previous
+// one is restored in another fresh segment and `error` says why. Returns
+// nullptr only when neither works.
+framebus_writer_t *reopenProgramFrameBus(const std::string &name,
+                                         framebus_writer_t *writer,
+                                         const OutputConfig &requested,
+                                         OutputConfig &current,
+                                         std::string &error) {
+  framebus_writer_close(writer);
+  framebus_writer_t *replacement = framebus_writer_open(
+      name.c_str(), requested.width, requested.height, requested.fps, requested.slotCount);
+  if (replacement != nullptr) {
+    current = requested;
+    error.clear();
+    return replacement;
+  }
+  error = "Could not create FrameBus segment for " + std::to_string(requested.width) + "x" +
+      std::to_string(requested.height) + "@" + std::to_string(requested.fps) + " with " +
+      std::to_string(requested.slotCount) + " slots.";
+  return framebus_writer_open(
+      name.c_str(), current.width, current.height, current.fps, current.slotCount);
+}
+
+std::chrono::steady_clock::duration frameIntervalForFps(uint32_t fps) {
+  const uint32_t targetFps = fps == 0 ? 30u : fps;
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / static_cast<double>(targetFps)));
+}
+
 }  // namespace
 
+uint32_t targetKeyerFps(const std::string &performanceMode) {
+  if (performanceMode == "quality") {
+    return 25u;
+  }
+  if (performanceMode == "balanced") {
+    return 20u;
+  }
+  if (performanceMode == "performance") {
+    return 15u;
+  }
+  return 30u;
+}
+
+void postprocessKeyerMask(AlphaMask &mask,
+                          const AlphaMask &previousMask,
+                          const KeyerSettings &settings,
+                          double maskAgeMs,
+                          KeyerMetrics &metrics) {
+  if (settings.temporalBlendEnabled) {
+    const auto temporalStart = std::chrono::steady_clock::now();
+    blendAlphaTemporal(mask, previousMask, maskAgeMs);
+    metrics.maskTemporalMs = elapsedMs(temporalStart, std::chrono::steady_clock::now());
+  }
+  postprocessAlpha(mask, previousMask, settings, maskAgeMs, metrics);
+}
+
+void refineKeyerMask(AlphaMask &mask, const VideoFrame &guideFrame) {
+  refineLiveMask(mask, guideFrame);
+}
+
 void runFramePipeline(const Options &options,
                       MeetingState &state,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
-                      std::atomic<bool> &running) {
-  framebus_writer_t *writer = framebus_writer_open(
-      options.framebusName.c_str(), options.width, options.height, options.fps, kSlotCount);
-  if (writer == nullptr) {
-    std::cout << "{\"type\":\"error\",\"code\":\"framebus_open_failed\",\"message\":\"Could not create FrameBus segment.\"}" << std::endl;
-    return;
+                      CapacityBenchmark &capacity,
+                      std::atomic<bool> &running,
+                      const ProgramFrameSink &frameSink) {
+  ScopedThreadRole role("pipeline");
+  OutputConfig outputConfig;
+  uint64_t appliedOutputConfigRevision = 0u;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    outputConfig = state.output;
+    appliedOutputConfigRevision = state.appliedOutputConfigRevision;
   }
-
-  const uint32_t targetFps = options.fps == 0 ? 30u : options.fps;
-  const auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-      std::chrono::duration<double>(1.0 / static_cast<double>(targetFps)));
+  // The segment is created the first time FrameBus output runs, so an engine
+  // that never publishes never touches a segment another process may own.
+  framebus_writer_t *writer = nullptr;
+
+  // Compositor geometry follows the live output config, not the launch flags.
+  Options outputOptions = options;
+  outputOptions.width = outputConfig.width;
+  outputOptions.height = outputConfig.height;
+  outputOptions.fps = outputConfig.fps;
+  auto frameInterval = frameIntervalForFps(outputConfig.fps);
   auto nextFrameAt = std::chrono::steady_clock::now();
   uint64_t frameIndex = 0;
+  // The program frame is rendered straight into the FrameBus slot it will be
+  // published from; programFrame only backs it while the FrameBus is stopped.
+  // programImage always points at the latest complete frame, wherever it is.
   std::vector<uint8_t> programFrame;
+  RgbaFrameRef programImage;
+  bool programImageUncommitted = false;
+  // CPU composition carries undamaged tiles over from the last CPU frame.
+  CompositorTileCache compositorTiles;
   VideoFrame latestCameraFrame;
   uint64_t lastCameraTimestampNs = 0u;
+  DisplayCameraFrame displayCamera;
   VideoFrame latestPipFrame;
   uint64_t lastPipCameraTimestampNs = 0u;
   // Conference auto-director: persists dwell/hold hysteresis across frames.
   AutoDirector autoDirector;
+  AutoFramer autoFramer;
   uint64_t lastProgramRevision = 0u;
   uint64_t lastUsedKeyerPublishedNs = 0u;
   uint64_t lastBackGraphicsTimestampNs = 0u;
@@ -948,6 +1102,52 @@ void runFramePipeline(const Options &options,
   int fusedCollapseHoldFrames = 0;
 #endif
   while (running.load()) {
+    OutputConfig requestedOutput;
+    uint64_t outputConfigRevision = 0u;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      requestedOutput = state.requestedOutput;
+      outputConfigRevision = state.outputConfigRevision;
+    }
+    if (outputConfigRevision != appliedOutputConfigRevision) {
+      std::string error;
+      if (writer != nullptr) {
+        writer = reopenProgramFrameBus(options.framebusName, writer, requestedOutput, outputConfig, error);
+        if (writer == nullptr) {
+          std::cout << "{\"type\":\"error\",\"code\":\"framebus_open_failed\",\"message\":\"Could not recreate FrameBus segment.\"}" << std::endl;
+          return;
+        }
+      } else {
+        outputConfig = requestedOutput;
+      }
+      appliedOutputConfigRevision = outputConfigRevision;
+      outputOptions.width = outputConfig.width;
+      outputOptions.height = outputConfig.height;
+      outputOptions.fps = outputConfig.fps;
+      frameInterval = frameIntervalForFps(outputConfig.fps);
+      nextFrameAt = std::chrono::steady_clock::now();
+      programFrame.clear();
+      programImage = RgbaFrameRef();
+      programImageUncommitted = false;
+      previewFrames.clear();
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.output = outputConfig;
+        state.appliedOutputConfigRevision = appliedOutputConfigRevision;
+        state.framebusLastError = error;
+        state.programDirty = true;
+      }
+      std::cout << "{\"type\":\"meeting_framebus\",\"event\":\""
+                << (error.empty() ? "reconfigured" : "reconfigure_failed")
+                << "\",\"name\":\"" << options.framebusName
+                << "\",\"width\":" << outputConfig.width
+                << ",\"height\":" << outputConfig.height
+                << ",\"fps\":" << outputConfig.fps
+                << ",\"slot_count\":" << outputConfig.slotCount
+                << ",\"revision\":" << appliedOutputConfigRevision
+                << "}" << std::endl;
+    }
+
     PipelineRuntimeState runtime;
     {
       std::lock_guard<std::mutex> lock(state.mutex);
@@ -962,11 +1162,21 @@ void runFramePipeline(const Options &options,
       runtime.framebusRunning = state.framebusRunning;
       runtime.previewClients = state.previewClientCount;
       runtime.vcamClients = state.vcamClientCount;
+      runtime.embedClients = state.embedFrameClientCount;
       runtime.programDirty = state.programDirty;
       runtime.graphicsDirty = state.graphicsDirty;
       runtime.programRevision = state.programRevision;
       runtime.keyerRevision = state.keyerRevision;
     }
+    if (runtime.framebusRunning && writer == nullptr) {
+      writer = framebus_writer_open(
+          options.framebusName.c_str(), outputConfig.width, outputConfig.height, outputConfig.fps,
+          outputConfig.slotCount);
+      if (writer == nullptr) {
+        std::cout << "{\"type\":\"error\",\"code\":\"framebus_open_failed\",\"message\":\"Could not create FrameBus segment.\"}" << std::endl;
+        return;
+      }
+    }
 
     // Conference native auto-director ("Auto-Regie"): follow the loudest open
     // camera's own microphone. Runs before the camera read so a cut takes
@@ -1002,15 +1212,25 @@ void runFramePipeline(const Options &options,
 #endif
     }
 
-    const CompositorSnapshot snapshot = copyCompositorSnapshot(state);
+    CompositorSnapshot snapshot = copyCompositorSnapshot(state);
+    // Auto-framing replaces the manual pan/zoom with the framer's, which the
+    // keyed matte of this frame steers for the next one. Off, the framer
+    // tracks the manual framing so switching it on starts from what is on air.
+    if (snapshot.cameraRender.autoFraming) {
+      snapshot.cameraFraming = autoFramer.framing();
+    } else {
+      autoFramer.reset(snapshot.cameraFraming);
+    }
     runtime.mode = determinePipelineMode(runtime, snapshot);
     {
       std::lock_guard<std::mutex> lock(state.mutex);
       state.pipelineMode = runtime.mode;
     }
 
-    if (runtime.mode == "idle" && !runtime.programDirty && programFrame.empty()) {
-      std::this_thread::sleep_for(kIdleSleep);
+    if (runtime.mode == "idle" && !runtime.programDirty && programImage.empty()) {
+      if (!capacity.runProgramProbe(kIdleSleep)) {
+        std::this_thread::sleep_for(kIdleSleep);
+      }
       nextFrameAt = std::chrono::steady_clock::now();
       continue;
     }
@@ -1021,7 +1241,7 @@ void runFramePipeline(const Options &options,
     const bool staticHeartbeatDue =
         lastStaticHeartbeatAt == std::chrono::steady_clock::time_point{} ||
         programStart - lastStaticHeartbeatAt >= kStaticHeartbeatInterval;
-    bool shouldRenderProgram = runtime.programDirty || runtime.programRevision != lastProgramRevision || programFrame.empty();
+    bool shouldRenderProgram = runtime.programDirty || runtime.programRevision != lastProgramRevision || programImage.empty();
     bool shouldPublishPreview = false;
     bool shouldWriteFramebus = false;
 
@@ -1042,6 +1262,7 @@ void runFramePipeline(const Options &options,
       } else if (!runtime.cameraRunning) {
         latestCameraFrame = VideoFrame{};
         lastCameraTimestampNs = 0u;
+        displayCamera.clear();
       }
       // Conference PiP: read a second open camera's newest frame (distinct from
       // the program camera) so it can be overlaid onto the finished frame.
@@ -1081,12 +1302,38 @@ void runFramePipeline(const Options &options,
         keyerSettings.edgeStabilizationEnabled = state.edgeStabilizationEnabled;
         keyerSettings.edgeStabilizationStrength = state.edgeStabilizationStrength;
         keyerSettings.degradation = state.degradationSettings;
+        keyerSettings.chroma = state.chromaKey;
       }
       const bool fusedCoreMlRequested = gpuPipelineEnabled() &&
           requestedKeyerModel == "modnet" && fusedCoreMlAvailable;
       if (hasNewCameraFrame && keyerEnabled && !fusedCoreMlRequested) {
-        keyerWorker.submit(latestCameraFrame);
+        // Only the framed part (plus a margin) is keyed. The clean plate is
+        // captured from whole frames, so that keyer always gets one.
+        keyerWorker.submit(latestCameraFrame,
+                           requestedKeyerModel == "clean_plate"
+                               ? CameraWindow{0u, 0u, latestCameraFrame.width, latestCameraFrame.height}
+                               : keyerInputWindow(snapshot.cameraFraming, latestCameraFrame.width,
+                                                  latestCameraFrame.height));
       }
+      // The worker keys the original colours; the program's display copy
+      // loses its green spill once per camera frame, after the submit.
+      const ChromaKeySettings *spill =
+          keyerEnabled && requestedKeyerModel == "chroma_key" ? &keyerSettings.chroma : nullptr;
+      // Keyed cameras follow the speaker layout's scale, so refinement and
+      // compositing run at the keyed placement's on-screen size.
+      const double keyedDisplayScale = hasCameraFrame
+          ? cameraDisplayScale(outputOptions, snapshot, latestCameraFrame.width, latestCameraFrame.height, true)
+          : 1.0;
+      if (hasCameraFrame && keyerEnabled) {
+        keyerWorker.setDisplayScale(keyedDisplayScale);
+      }
+      const VideoFrame *keyedCamera = nullptr;
+      const auto keyedCameraFrame = [&]() -> const VideoFrame & {
+        if (keyedCamera == nullptr) {
+          keyedCamera = &displayCamera.update(latestCameraFrame, keyedDisplayScale, spill);
+        }
+        return *keyedCamera;
+      };
       if (hasCameraFrame) {
         frameForCompositor = &latestCameraFrame;
         if (snapshot.keyerEnabled) {
@@ -1100,7 +1347,7 @@ void runFramePipeline(const Options &options,
             const bool pairIsUsable = maskAgeMs <= std::max(0.0, keyerSettings.degradation.maxMaskAgeMs);
             if (pairIsUsable) {
               liveMask = latestPair->mask;
-              refineLiveMask(liveMask, latestCameraFrame);
+              refineLiveMask(liveMask, keyedCameraFrame());
               maskForCompositor = &liveMask;
               selectedPair = latestPair;
             }
@@ -1164,13 +1411,9 @@ void runFramePipeline(const Options &options,
           state.keyerMetrics.maskAgeAvgMs = -1.0;
         }
       }
-      VideoFrame backGraphicsFrame;
-      VideoFrame frontGraphicsFrame;
       const bool graphicsOutputActive = isGraphicsOutputActive(snapshot);
-      const VideoFrame *backGraphicsFrameForCompositor =
-          backGraphicsReader.copyLatest(backGraphicsFrame, graphicsOutputActive) ? &backGraphicsFrame : nullptr;
-      const VideoFrame *frontGraphicsFrameForCompositor =
-          frontGraphicsReader.copyLatest(frontGraphicsFrame, graphicsOutputActive) ? &frontGraphicsFrame : nullptr;
+      const VideoFrame *backGraphicsFrameForCompositor = backGraphicsReader.latest(graphicsOutputActive);
+      const VideoFrame *frontGraphicsFrameForCompositor = frontGraphicsReader.latest(graphicsOutputActive);
       const bool hasNewBackGraphicsFrame = backGraphicsFrameForCompositor != nullptr &&
           backGraphicsFrameForCompositor->timestampNs != 0u &&
           backGraphicsFrameForCompositor->timestampNs != lastBackGraphicsTimestampNs;
@@ -1195,7 +1438,7 @@ void runFramePipeline(const Options &options,
           const bool pairIsUsable = maskAgeMs <= std::max(0.0, keyerSettings.degradation.maxMaskAgeMs);
           if (pairIsUsable) {
             liveMask = latestPair->mask;
-            refineLiveMask(liveMask, latestCameraFrame);
+            refineLiveMask(liveMask, keyedCameraFrame());
             maskForCompositor = &liveMask;
             selectedPair = latestPair;
           } else {
@@ -1260,7 +1503,6 @@ void runFramePipeline(const Options &options,
                              fused.status.metrics);
           }
           previousFusedMask = fusedMask;
-          frameForCompositor = &latestCameraFrame;
           maskForCompositor = &fusedMask;
           selectedPair.reset();
           shouldRenderProgram = true;
@@ -1295,6 +1537,22 @@ void runFramePipeline(const Options &options,
       }
 #endif
 
+      if (snapshot.cameraRender.autoFraming) {
+        autoFramer.observe(maskForCompositor, programStart);
+      }
+
+      // A keyed camera is composited from the display copy the mask was
+      // refined against; an unkeyed one (keyer off or no usable mask) at its
+      // own placement's size.
+      if (frameForCompositor != nullptr) {
+        frameForCompositor = maskForCompositor != nullptr
+            ? &keyedCameraFrame()
+            : &displayCamera.update(
+                  latestCameraFrame,
+                  cameraDisplayScale(outputOptions, snapshot, latestCameraFrame.width, latestCameraFrame.height, false),
+                  spill);
+      }
+
       const bool hasNewUsableKeyerPair = selectedPair != nullptr &&
           selectedPair->publishedAtNs > lastUsedKeyerPublishedNs;
       shouldRenderProgram = shouldRenderProgram ||
@@ -1304,33 +1562,57 @@ void runFramePipeline(const Options &options,
           hasNewUsableKeyerPair ||
           ((runtime.mode == "live" || runtime.mode == "keyer_live") && graphicsOutputActive);
       if (runtime.mode == "idle" && !outputConsumerActive && !shouldRenderProgram) {
-        std::this_thread::sleep_for(kIdleSleep);
+        if (!capacity.runProgramProbe(kIdleSleep)) {
+          std::this_thread::sleep_for(kIdleSleep);
+        }
         nextFrameAt = std::chrono::steady_clock::now();
         continue;
       }
       if (runtime.mode == "static_output" && !shouldRenderProgram && !staticHeartbeatDue) {
-        std::this_thread::sleep_for(kStaticPollInterval);
+        // Nothing is rendered before the next heartbeat, so a probe may use
+        // all of the time until then.
+        if (!capacity.runProgramProbe(lastStaticHeartbeatAt + kStaticHeartbeatInterval - programStart)) {
+          std::this_thread::sleep_for(kStaticPollInterval);
+        }
         nextFrameAt = std::chrono::steady_clock::now();
         continue;
       }
 
+      const uint64_t frameTimestampNs = hasCameraFrame ? latestCameraFrame.timestampNs : nowNs();
       if (shouldRenderProgram) {
+        const size_t frameBytes =
+            static_cast<size_t>(outputOptions.width) * outputOptions.height * 4u;
+        RgbaFrameRef target;
+        if (runtime.framebusRunning) {
+          size_t slotSize = 0u;
+          uint8_t *slot = framebus_writer_acquire(writer, &slotSize);
+          if (slot != nullptr && slotSize == frameBytes) {
+            target = RgbaFrameRef(slot, slotSize);
+          }
+        }
+        if (target.empty()) {
+          programFrame.resize(frameBytes);
+          target = programFrame;
+        }
         const std::string compositorBackend = renderProgramFrame(
-            options,
+            outputOptions,
             snapshot,
             frameForCompositor,
             maskForCompositor,
             backGraphicsFrameForCompositor,
             frontGraphicsFrameForCompositor,
             frameIndex++,
-            programFrame);
+            target,
+            &compositorTiles);
         // Conference PiP overlay: drawn on the CPU over the finished RGBA frame,
         // after either compositing path. Guarded, so meeting mode (no PiP) is
         // untouched.
         if (pipActive && !latestPipFrame.rgba.empty()) {
-          drawCameraPipInset(programFrame, options.width, options.height,
+          drawCameraPipInset(target, outputOptions.width, outputOptions.height,
                              latestPipFrame);
         }
+        programImage = target;
+        programImageUncommitted = target.data() != programFrame.data();
         if (selectedPair != nullptr) {
           lastUsedKeyerPublishedNs = selectedPair->publishedAtNs;
         }
@@ -1340,39 +1622,58 @@ void runFramePipeline(const Options &options,
           state.programDirty = false;
           state.graphicsDirty = false;
           state.compositorBackend = compositorBackend;
+          state.composedTiles += compositorTiles.totalTiles;
+          state.recomposedTiles += compositorTiles.recomposedTiles;
           ++state.renderedFrames;
         }
+        // Embedded hosts get the frame in place, ahead of every IPC consumer.
+        if (runtime.embedClients > 0 && frameSink) {
+          frameSink(programImage.data(), outputOptions.width, outputOptions.height, frameTimestampNs);
+        }
       } else {
         std::lock_guard<std::mutex> lock(state.mutex);
         ++state.reusedFrames;
       }
 
-      // Tap the composited program frame for recording. No-op unless a
-      // recording is active; runs every tick so the file keeps a steady
-      // timeline (and holds the last image) even during static periods.
-      if (!programFrame.empty()) {
-        recorder.appendVideoFrame(programFrame.data(), options.width,
-                                  options.height);
-      }
-
-      shouldWriteFramebus = runtime.framebusRunning && !programFrame.empty() &&
+      shouldWriteFramebus = runtime.framebusRunning && !programImage.empty() &&
           (shouldRenderProgram || runtime.mode == "live" || runtime.mode == "keyer_live" || staticHeartbeatDue);
       if (shouldWriteFramebus) {
-        framebus_writer_write_rgba(
-            writer,
-            programFrame.data(),
-            programFrame.size(),
-            hasCameraFrame ? latestCameraFrame.timestampNs : nowNs());
-        {
+        bool framebusFrameCommitted = false;
+        if (programImageUncommitted) {
+          framebusFrameCommitted = framebus_writer_commit(writer, frameTimestampNs) == 0;
+          programImageUncommitted = false;
+        } else {
+          // Re-publishing an unchanged frame still needs a fresh slot; this is
+          // the only path that copies the program frame into shared memory.
+          // The new slot becomes programImage, which the recorder reads below
+          // and the next heartbeat copies from, so this is a Local copy.
+          size_t slotSize = 0u;
+          uint8_t *slot = framebus_writer_acquire(writer, &slotSize);
+          if (slot != nullptr && slotSize == programImage.size()) {
+            copyFrameBytes(slot, programImage.data(), slotSize, FrameCopyTarget::Local);
+            framebusFrameCommitted = framebus_writer_commit(writer, frameTimestampNs) == 0;
+            programImage = RgbaFrameRef(slot, slotSize);
+          }
+        }
+        if (framebusFrameCommitted) {
           std::lock_guard<std::mutex> lock(state.mutex);
           ++state.writtenFramebusFrames;
         }
         lastStaticHeartbeatAt = programStart;
       }
 
-      shouldPublishPreview = previewConsumerActive && shouldRenderProgram && !programFrame.empty();
+      // Tap the composited program frame for recording. No-op unless a
+      // recording is active; runs every tick so the file keeps a steady
+      // timeline (and holds the last image) even during static periods. Both
+      // the recorder and the preview read the published slot in place.
+      if (!programImage.empty()) {
+        recorder.appendVideoFrame(programImage.data(), outputOptions.width,
+                                  outputOptions.height);
+      }
+
+      shouldPublishPreview = previewConsumerActive && shouldRenderProgram && !programImage.empty();
       if (shouldPublishPreview) {
-        previewFrames.publish(options.width, options.height, programFrame.data(), programFrame.size());
+        previewFrames.publish(outputOptions.width, outputOptions.height, programImage.data(), programImage.size());
         std::lock_guard<std::mutex> lock(state.mutex);
         ++state.publishedPreviewFrames;
       }
@@ -1384,10 +1685,16 @@ void runFramePipeline(const Options &options,
         std::lock_guard<std::mutex> lock(state.mutex);
         state.keyerMetrics.programFrameMs = elapsedMs(programStart, programEnd);
         state.keyerMetrics.cameraCopyMs = elapsedMs(cameraCopyStart, cameraCopyEnd);
+        state.keyerMetrics.cameraDisplayWidth = frameForCompositor != nullptr ? frameForCompositor->width : 0u;
+        state.keyerMetrics.cameraDisplayHeight = frameForCompositor != nullptr ? frameForCompositor->height : 0u;
         state.keyerMetrics.programFps = programRate.value(programEnd);
         state.keyerMetrics.programFrameIntervalMs = programFrameIntervalMs;
       }
     }
+    // A pending capacity probe uses the idle rest of this frame, if it fits.
+    if (nextFrameAt > std::chrono::steady_clock::now()) {
+      capacity.runProgramProbe(nextFrameAt - std::chrono::steady_clock::now());
+    }
     const auto now = std::chrono::steady_clock::now();
     if (nextFrameAt > now) {
       std::this_thread::sleep_until(nextFrameAt);
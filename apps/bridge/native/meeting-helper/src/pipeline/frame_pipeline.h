@@ -2,20 +2,50 @@
 
 #include "capture/camera_source.h"
 #include "common/options.h"
+#include "keyer/keyer.h"
 #include "preview/preview_frame_store.h"
 #include "state/meeting_state.h"
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
 
 namespace broadify::meeting {
 
+class CapacityBenchmark;
 class MeetingRecorder;
 
+// Receives every newly rendered program frame on the pipeline thread, before
+// it is published to the FrameBus, while state.embedFrameClientCount is
+// non-zero. `rgba` (width * height * 4 bytes, tightly packed) is the frame in
+// place, usually the FrameBus slot itself, and is only valid during the call.
+using ProgramFrameSink =
+    std::function<void(const uint8_t *rgba, uint32_t width, uint32_t height, uint64_t timestampNs)>;
+
 void runFramePipeline(const Options &options,
                       MeetingState &state,
                       CameraSource &camera,
                       PreviewFrameStore &previewFrames,
                       MeetingRecorder &recorder,
-                      std::atomic<bool> &running);
+                      CapacityBenchmark &capacity,
+                      std::atomic<bool> &running,
+                      const ProgramFrameSink &frameSink);
+
+// Stage entry points shared with the capacity benchmark, so it times exactly
+// what the live pipeline runs.
+
+// Mask rate the async keyer is throttled to for a performance mode.
+uint32_t targetKeyerFps(const std::string &performanceMode);
+// Temporal blend (when enabled) and edge postprocess of a fresh keyer mask,
+// as the keyer worker applies them after inference.
+void postprocessKeyerMask(AlphaMask &mask,
+                          const AlphaMask &previousMask,
+                          const KeyerSettings &settings,
+                          double maskAgeMs,
+                          KeyerMetrics &metrics);
+// Guided edge refinement of a mask against its camera frame; program thread
+// only (the D3D11 path shares the compositor's device context).
+void refineKeyerMask(AlphaMask &mask, const VideoFrame &guideFrame);
 
 }  // namespace broadify::meeting
@@ -1,5 +1,7 @@
 #include "pipeline/guided_mask_refine.h"
 
+#include "util/image_resample.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -48,35 +50,6 @@ float guidedEpsilon() {
   return e;
 }
 
-// Bilinear-ish downscale of a planar float image into (dstW x dstH).
-std::vector<float> resamplePlane(const std::vector<float> &src, int srcW,
-                                 int srcH, int dstW, int dstH) {
-  std::vector<float> dst(static_cast<size_t>(dstW) * dstH, 0.0f);
-  if (srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0) return dst;
-  const float sx = static_cast<float>(srcW) / dstW;
-  const float sy = static_cast<float>(srcH) / dstH;
-  for (int y = 0; y < dstH; ++y) {
-    const float fy = std::min(srcH - 1.0f, (y + 0.5f) * sy - 0.5f);
-    const int y0 = std::max(0, static_cast<int>(std::floor(fy)));
-    const int y1 = std::min(srcH - 1, y0 + 1);
-    const float wy = fy - y0;
-    for (int x = 0; x < dstW; ++x) {
-      const float fx = std::min(srcW - 1.0f, (x + 0.5f) * sx - 0.5f);
-      const int x0 = std::max(0, static_cast<int>(std::floor(fx)));
-      const int x1 = std::min(srcW - 1, x0 + 1);
-      const float wx = fx - x0;
-      const float a = src[(size_t)y0 * srcW + x0];
-      const float b = src[(size_t)y0 * srcW + x1];
-      const float c = src[(size_t)y1 * srcW + x0];
-      const float d = src[(size_t)y1 * srcW + x1];
-      dst[(size_t)y * dstW + x] =
-          a * (1 - wx) * (1 - wy) + b * wx * (1 - wy) +
-          c * (1 - wx) * wy + d * wx * wy;
-    }
-  }
-  return dst;
-}
-
 // Separable box blur (radius r) with border-correct averaging (divides by the
 // actual in-bounds sample count), via per-line prefix sums. O(W*H).
 void boxBlur(std::vector<float> &img, int W, int H, int r) {
@@ -126,27 +99,32 @@ void guidedRefineMask(AlphaMask &mask, const VideoFrame &guideFrame) {
     workH = std::max(1, static_cast<int>(guideFrame.height * scale + 0.5));
   }
 
-  // Guide luma (0..1) at full res, then resampled to the working grid.
-  const int gW = static_cast<int>(guideFrame.width);
-  const int gH = static_cast<int>(guideFrame.height);
-  std::vector<float> lumaFull(static_cast<size_t>(gW) * gH);
-  for (size_t i = 0, n = lumaFull.size(); i < n; ++i) {
-    const uint8_t *px = &guideFrame.rgba[i * 4];
-    lumaFull[i] = (0.299f * px[0] + 0.587f * px[1] + 0.114f * px[2]) / 255.0f;
+  // Guide area-averaged down to the working grid first, so luma is only
+  // computed for the pixels the filter actually uses.
+  const size_t n = static_cast<size_t>(workW) * workH;
+  std::vector<uint8_t> guideWork(n * 4u);
+  resampleImage({guideFrame.rgba.data(), guideFrame.width, guideFrame.height,
+                 static_cast<size_t>(guideFrame.width) * 4u, 4u},
+                {guideWork.data(), static_cast<uint32_t>(workW), static_cast<uint32_t>(workH),
+                 static_cast<size_t>(workW) * 4u, 4u},
+                ResampleFilter::kArea);
+  std::vector<float> I(n);
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t *px = &guideWork[i * 4];
+    I[i] = (0.299f * px[0] + 0.587f * px[1] + 0.114f * px[2]) / 255.0f;
   }
-  std::vector<float> I = resamplePlane(lumaFull, gW, gH, workW, workH);
 
-  // Mask (0..1) resampled to the same working grid.
-  std::vector<float> maskFull(mask.alpha.size());
-  for (size_t i = 0, n = maskFull.size(); i < n; ++i)
-    maskFull[i] = mask.alpha[i] / 255.0f;
-  std::vector<float> p = resamplePlane(maskFull, static_cast<int>(mask.width),
-                                       static_cast<int>(mask.height), workW,
-                                       workH);
+  // Mask (0..1) resampled to the same working grid (usually an upscale).
+  std::vector<uint8_t> maskWork(n);
+  resampleImage({mask.alpha.data(), mask.width, mask.height, mask.width, 1u},
+                {maskWork.data(), static_cast<uint32_t>(workW), static_cast<uint32_t>(workH),
+                 static_cast<size_t>(workW), 1u},
+                ResampleFilter::kBilinear);
+  std::vector<float> p(n);
+  for (size_t i = 0; i < n; ++i) p[i] = maskWork[i] / 255.0f;
 
   const int r = guidedRadius();
   const float eps = guidedEpsilon();
-  const size_t n = static_cast<size_t>(workW) * workH;
 
   std::vector<float> meanI = I, meanP = p;
   boxBlur(meanI, workW, workH, r);
@@ -0,0 +1,176 @@
+#include "preview/camera_mosaic.h"
+
+#include "util/image_resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace broadify::meeting {
+namespace {
+
+constexpr uint8_t kEmptyTileShade = 24;
+constexpr uint8_t kMeterTrackShade = 40;
+
+void fillRegion(uint8_t *dst, size_t stride, uint32_t width, uint32_t height,
+                uint8_t r, uint8_t g, uint8_t b) {
+  for (uint32_t y = 0; y < height; ++y) {
+    uint8_t *row = dst + static_cast<size_t>(y) * stride;
+    for (uint32_t x = 0; x < width; ++x) {
+      row[x * 4u + 0u] = r;
+      row[x * 4u + 1u] = g;
+      row[x * 4u + 2u] = b;
+      row[x * 4u + 3u] = 255;
+    }
+  }
+}
+
+// Letterboxes an RGBA8 frame into a tile-sized region of `dst`, keeping the
+// aspect ratio. The area filter averages each tile pixel's whole source
+// footprint, so fine detail (text, patterned shirts) does not alias.
+void drawThumbnail(const VideoFrame &frame, uint8_t *dst, size_t dstStride,
+                   uint32_t dstWidth, uint32_t dstHeight) {
+  fillRegion(dst, dstStride, dstWidth, dstHeight, 0, 0, 0);
+  const double scale = std::min(static_cast<double>(dstWidth) / frame.width,
+                                static_cast<double>(dstHeight) / frame.height);
+  const uint32_t fitWidth = std::clamp<uint32_t>(
+      static_cast<uint32_t>(std::lround(frame.width * scale)), 1u, dstWidth);
+  const uint32_t fitHeight = std::clamp<uint32_t>(
+      static_cast<uint32_t>(std::lround(frame.height * scale)), 1u, dstHeight);
+  const uint32_t offsetX = (dstWidth - fitWidth) / 2u;
+  const uint32_t offsetY = (dstHeight - fitHeight) / 2u;
+
+  ConstImagePlane src;
+  src.data = frame.rgba.data();
+  src.width = frame.width;
+  src.height = frame.height;
+  src.stride = static_cast<size_t>(frame.width) * 4u;
+  ImagePlane out;
+  out.data = dst + static_cast<size_t>(offsetY) * dstStride + static_cast<size_t>(offsetX) * 4u;
+  out.width = fitWidth;
+  out.height = fitHeight;
+  out.stride = dstStride;
+  resampleImage(src, out, ResampleFilter::kArea);
+}
+
+}  // namespace
+
+MosaicLayout computeMosaicLayout(const std::vector<int> &cameraIndices,
+                                 uint32_t tileWidth,
+                                 uint32_t tileHeight) {
+  MosaicLayout layout;
+  const uint32_t count = static_cast<uint32_t>(cameraIndices.size());
+  if (count == 0u || tileWidth == 0u || tileHeight == 0u) {
+    return layout;
+  }
+  layout.columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+  layout.rows = (count + layout.columns - 1u) / layout.columns;
+  layout.width = layout.columns * tileWidth;
+  layout.height = layout.rows * tileHeight;
+  layout.tiles.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    MosaicTile tile;
+    tile.cameraIndex = cameraIndices[i];
+    tile.x = (i % layout.columns) * tileWidth;
+    tile.y = (i / layout.columns) * tileHeight;
+    tile.width = tileWidth;
+    tile.height = tileHeight;
+    layout.tiles.push_back(tile);
+  }
+  return layout;
+}
+
+CameraMosaic::CameraMosaic(uint32_t tileWidth, uint32_t tileHeight)
+    : tileWidth_(std::max<uint32_t>(tileWidth, 1u)),
+      tileHeight_(std::max<uint32_t>(tileHeight, kMosaicMeterHeight + 1u)) {}
+
+void CameraMosaic::resetLayout(const std::vector<int> &cameraIndices) {
+  cameraIndices_ = cameraIndices;
+  layout_ = computeMosaicLayout(cameraIndices_, tileWidth_, tileHeight_);
+  atlas_.assign(static_cast<size_t>(layout_.width) * layout_.height * 4u, 0u);
+  tileStates_.clear();
+  for (const MosaicTile &tile : layout_.tiles) {
+    TileState tileState;
+    tileState.meterPixels = std::numeric_limits<uint32_t>::max();
+    tileStates_[tile.cameraIndex] = tileState;
+    clearTile(tile);
+  }
+}
+
+void CameraMosaic::clearTile(const MosaicTile &tile) {
+  const size_t stride = static_cast<size_t>(layout_.width) * 4u;
+  uint8_t *origin = atlas_.data() + static_cast<size_t>(tile.y) * stride + static_cast<size_t>(tile.x) * 4u;
+  fillRegion(origin, stride, tile.width, tile.height - kMosaicMeterHeight,
+             kEmptyTileShade, kEmptyTileShade, kEmptyTileShade);
+}
+
+void CameraMosaic::drawMeter(const MosaicTile &tile, uint32_t meterPixels) {
+  const size_t stride = static_cast<size_t>(layout_.width) * 4u;
+  uint8_t *origin = atlas_.data() +
+      static_cast<size_t>(tile.y + tile.height - kMosaicMeterHeight) * stride +
+      static_cast<size_t>(tile.x) * 4u;
+  const uint32_t lit = std::min(meterPixels, tile.width);
+  fillRegion(origin, stride, lit, kMosaicMeterHeight, 48, 209, 88);
+  fillRegion(origin + static_cast<size_t>(lit) * 4u, stride, tile.width - lit, kMosaicMeterHeight,
+             kMeterTrackShade, kMeterTrackShade, kMeterTrackShade);
+}
+
+bool CameraMosaic::update(CameraSource &camera) {
+  bool changed = false;
+  const std::vector<int> cameraIndices = camera.activeCameraSet();
+  if (cameraIndices != cameraIndices_) {
+    resetLayout(cameraIndices);
+    changed = true;
+  }
+  if (layout_.tiles.empty()) {
+    return changed;
+  }
+
+  const std::map<int, float> levels = camera.cameraAudioLevels();
+  const size_t stride = static_cast<size_t>(layout_.width) * 4u;
+  for (const MosaicTile &tile : layout_.tiles) {
+    TileState &tileState = tileStates_[tile.cameraIndex];
+    // Downscale straight from the camera's own frame instead of copying it.
+    uint8_t *origin = atlas_.data() + static_cast<size_t>(tile.y) * stride + static_cast<size_t>(tile.x) * 4u;
+    camera.readLatestFrameFrom(tile.cameraIndex, tileState.lastTimestampNs, [&](const VideoFrame &frame) {
+      if (frame.width == 0u || frame.height == 0u ||
+          frame.rgba.size() != static_cast<size_t>(frame.width) * frame.height * 4u) {
+        return;
+      }
+      drawThumbnail(frame, origin, stride, tile.width, tile.height - kMosaicMeterHeight);
+      tileState.lastTimestampNs = frame.timestampNs;
+      changed = true;
+    });
+
+    const auto level = levels.find(tile.cameraIndex);
+    const float clamped = level == levels.end() ? 0.0f : std::clamp(level->second, 0.0f, 1.0f);
+    const uint32_t meterPixels = static_cast<uint32_t>(std::lround(clamped * static_cast<float>(tile.width)));
+    if (meterPixels != tileState.meterPixels) {
+      drawMeter(tile, meterPixels);
+      tileState.meterPixels = meterPixels;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+std::string mosaicLayoutJson(const MosaicLayout &layout,
+                             const std::map<int, float> &audioLevels) {
+  std::ostringstream out;
+  out << "{\"width\":" << layout.width << ",\"height\":" << layout.height
+      << ",\"columns\":" << layout.columns << ",\"rows\":" << layout.rows
+      << ",\"meter_height\":" << kMosaicMeterHeight << ",\"tiles\":[";
+  for (size_t i = 0; i < layout.tiles.size(); ++i) {
+    const MosaicTile &tile = layout.tiles[i];
+    const auto level = audioLevels.find(tile.cameraIndex);
+    out << (i ? "," : "") << "{\"camera_index\":" << tile.cameraIndex
+        << ",\"x\":" << tile.x << ",\"y\":" << tile.y
+        << ",\"width\":" << tile.width << ",\"height\":" << tile.height
+        << ",\"audio_level\":" << (level == audioLevels.end() ? 0.0f : level->second) << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "capture/camera_source.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+constexpr uint32_t kMosaicTileWidth = 320;
+constexpr uint32_t kMosaicTileHeight = 180;
+
+// Placement of one open camera inside the mosaic atlas, in atlas pixels.
+struct MosaicTile {
+  int cameraIndex = -1;
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+struct MosaicLayout {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t columns = 0;
+  uint32_t rows = 0;
+  std::vector<MosaicTile> tiles;
+};
+
+// Near-square grid of fixed-size tiles, one per camera, in the given order.
+// Shared by the mosaic renderer and the control RPC so both agree on where a
+// camera sits without talking to each other.
+MosaicLayout computeMosaicLayout(const std::vector<int> &cameraIndices,
+                                 uint32_t tileWidth = kMosaicTileWidth,
+                                 uint32_t tileHeight = kMosaicTileHeight);
+
+// Height of the audio meter strip along the bottom of every tile. The
+// thumbnail is letterboxed into the rest of the tile.
+constexpr uint32_t kMosaicMeterHeight = 6;
+
+// Thumbnail atlas of every open camera. A tile is re-rendered only when its
+// camera delivered a new frame or its audio meter moved, so an idle camera
+// costs nothing and the atlas sequence advances only on visible changes.
+class CameraMosaic {
+ public:
+  explicit CameraMosaic(uint32_t tileWidth = kMosaicTileWidth,
+                        uint32_t tileHeight = kMosaicTileHeight);
+
+  // Polls the open camera set; returns true when the atlas changed.
+  bool update(CameraSource &camera);
+
+  uint32_t width() const { return layout_.width; }
+  uint32_t height() const { return layout_.height; }
+  const MosaicLayout &layout() const { return layout_; }
+  const std::vector<uint8_t> &rgba() const { return atlas_; }
+
+ private:
+  struct TileState {
+    uint64_t lastTimestampNs = 0;
+    uint32_t meterPixels = 0;
+  };
+
+  void resetLayout(const std::vector<int> &cameraIndices);
+  void clearTile(const MosaicTile &tile);
+  void drawMeter(const MosaicTile &tile, uint32_t meterPixels);
+
+  uint32_t tileWidth_;
+  uint32_t tileHeight_;
+  std::vector<int> cameraIndices_;
+  MosaicLayout layout_;
+  std::vector<uint8_t> atlas_;
+  std::map<int, TileState> tileStates_;
+};
+
+// {"width":..,"height":..,"columns":..,"rows":..,"meter_height":..,"tiles":[
+//   {"camera_index":..,"x":..,"y":..,"width":..,"height":..,"audio_level":..}]}
+std::string mosaicLayoutJson(const MosaicLayout &layout,
+                             const std::map<int, float> &audioLevels);
+
+}  // namespace broadify::meeting
@@ -1,22 +1,21 @@
 #include "preview/mjpeg_server.h"
 
+#include "capture/camera_source.h"
+#include "preview/camera_mosaic.h"
 #include "preview/preview_frame_store.h"
 #include "state/meeting_state.h"
+#include "util/jpeg_encode.h"
+#include "util/thread_roles.h"
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
-#if defined(__APPLE__)
-#include <CoreFoundation/CoreFoundation.h>
-#include <CoreGraphics/CoreGraphics.h>
-#include <ImageIO/ImageIO.h>
-#endif
-
 #if defined(_WIN32)
 #include <winsock2.h>
 #include <windows.h>
@@ -42,88 +41,14 @@ const unsigned char kTinyJpeg[] = {
     0xff,0xda,0x00,0x08,0x01,0x01,0x00,0x00,0x3f,0x00,0x2a,0xff,0xd9
 };
 
-#if defined(__APPLE__)
-void releaseData(void *, const void *, size_t) {}
-
-std::vector<uint8_t> encodeJpeg(const PreviewFrame &frame) {
-  if (frame.rgba.empty() || frame.width == 0u || frame.height == 0u) {
-    return std::vector<uint8_t>(std::begin(kTinyJpeg), std::end(kTinyJpeg));
-  }
-
-  CGDataProviderRef provider = CGDataProviderCreateWithData(
-      nullptr, frame.rgba.data(), frame.rgba.size(), releaseData);
-  if (provider == nullptr) {
-    return std::vector<uint8_t>(std::begin(kTinyJpeg), std::end(kTinyJpeg));
-  }
-
-  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
-  CGImageRef image = CGImageCreate(
-      frame.width,
-      frame.height,
-      8,
-      32,
-      static_cast<size_t>(frame.width) * 4u,
-      colorSpace,
-      kCGImageAlphaLast | kCGBitmapByteOrder32Big,
-      provider,
-      nullptr,
-      false,
-      kCGRenderingIntentDefault);
-
-  CFMutableDataRef data = CFDataCreateMutable(kCFAllocatorDefault, 0);
-  CGImageDestinationRef destination = data == nullptr
-      ? nullptr
-      : CGImageDestinationCreateWithData(data, CFSTR("public.jpeg"), 1, nullptr);
-  if (destination != nullptr && image != nullptr) {
-    const float qualityValue = 0.95f;
-    CFNumberRef quality = CFNumberCreate(kCFAllocatorDefault, kCFNumberFloatType, &qualityValue);
-    const void *keys[] = {kCGImageDestinationLossyCompressionQuality};
-    const void *values[] = {quality};
-    CFDictionaryRef properties = CFDictionaryCreate(
-        kCFAllocatorDefault, keys, values, 1, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
-    CGImageDestinationAddImage(destination, image, properties);
-    CGImageDestinationFinalize(destination);
-    if (properties != nullptr) {
-      CFRelease(properties);
-    }
-    if (quality != nullptr) {
-      CFRelease(quality);
-    }
-  }
-
+std::vector<uint8_t> encodeJpeg(uint32_t width, uint32_t height, const std::vector<uint8_t> &rgba, float quality) {
   std::vector<uint8_t> jpeg;
-  if (data != nullptr) {
-    const UInt8 *bytes = CFDataGetBytePtr(data);
-    const CFIndex length = CFDataGetLength(data);
-    if (bytes != nullptr && length > 0) {
-      jpeg.assign(bytes, bytes + length);
-    }
-  }
-
-  if (destination != nullptr) {
-    CFRelease(destination);
-  }
-  if (data != nullptr) {
-    CFRelease(data);
-  }
-  if (image != nullptr) {
-    CGImageRelease(image);
-  }
-  if (colorSpace != nullptr) {
-    CGColorSpaceRelease(colorSpace);
-  }
-  CGDataProviderRelease(provider);
-
-  if (jpeg.empty()) {
+  if (rgba.size() < static_cast<size_t>(width) * height * 4u ||
+      !encodeJpegRgba(rgba.data(), width, height, static_cast<size_t>(width) * 4u, quality, jpeg)) {
     return std::vector<uint8_t>(std::begin(kTinyJpeg), std::end(kTinyJpeg));
   }
   return jpeg;
 }
-#else
-std::vector<uint8_t> encodeJpeg(const PreviewFrame &) {
-  return std::vector<uint8_t>(std::begin(kTinyJpeg), std::end(kTinyJpeg));
-}
-#endif
 
 void closeSocketHandle(int socketHandle) {
 #if defined(_WIN32)
@@ -202,19 +127,36 @@ class PreviewClientCounter {
   MeetingState &state_;
 };
 
-}  // namespace
+class MosaicClientCounter {
+ public:
+  explicit MosaicClientCounter(MeetingState &state) : state_(state) {
+    std::lock_guard<std::mutex> lock(state_.mutex);
+    ++state_.mosaicClientCount;
+  }
 
-void runMjpegServer(uint16_t port,
-                    PreviewFrameStore &previewFrames,
-                    MeetingState &state,
-                    std::atomic<bool> &running) {
+  ~MosaicClientCounter() {
+    std::lock_guard<std::mutex> lock(state_.mutex);
+    state_.mosaicClientCount = std::max(0, state_.mosaicClientCount - 1);
+  }
+
+ private:
+  MeetingState &state_;
+};
+
+// Accepts one loopback client at a time, sends the multipart header and hands
+// the socket to `serveClient` until it returns.
+void runMjpegListener(uint16_t port,
+                      std::atomic<bool> &running,
+                      const char *socketFailedEvent,
+                      const char *bindFailedEvent,
+                      const std::function<void(int)> &serveClient) {
 #if defined(_WIN32)
   WSADATA wsa;
   WSAStartup(MAKEWORD(2, 2), &wsa);
 #endif
   int serverFd = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
   if (serverFd < 0) {
-    std::cout << "{\"type\":\"error\",\"code\":\"preview_socket_failed\",\"message\":\"Could not create preview socket.\"}" << std::endl;
+    std::cout << socketFailedEvent << std::endl;
     return;
   }
   int opt = 1;
@@ -225,7 +167,7 @@ void runMjpegServer(uint16_t port,
   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
   addr.sin_port = htons(port);
   if (bind(serverFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(serverFd, 8) != 0) {
-    std::cout << "{\"type\":\"error\",\"code\":\"preview_bind_failed\",\"message\":\"Could not bind preview port.\"}" << std::endl;
+    std::cout << bindFailedEvent << std::endl;
     closeSocketHandle(serverFd);
     return;
   }
@@ -247,29 +189,8 @@ void runMjpegServer(uint16_t port,
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
         "Cache-Control: no-store\r\n\r\n";
-    if (!sendString(client, header)) {
-      closeSocketHandle(client);
-      continue;
-    }
-
-    PreviewClientCounter clientCounter(state);
-    std::vector<uint8_t> lastValidJpeg(std::begin(kTinyJpeg), std::end(kTinyJpeg));
-    uint64_t lastSequence = 0u;
-    while (running.load()) {
-      PreviewFrame frame;
-      if (previewFrames.copyLatestIfNew(lastSequence, frame)) {
-        lastSequence = frame.sequence;
-        lastValidJpeg = encodeJpeg(frame);
-      }
-      std::ostringstream part;
-      part << "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " << lastValidJpeg.size() << "\r\n\r\n";
-      const std::string partHeader = part.str();
-      if (!sendString(client, partHeader) ||
-          !sendAll(client, reinterpret_cast<const char *>(lastValidJpeg.data()), lastValidJpeg.size()) ||
-          !sendAll(client, "\r\n", 2)) {
-        break;
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(33));
+    if (sendString(client, header)) {
+      serveClient(client);
     }
     closeSocketHandle(client);
   }
@@ -279,4 +200,81 @@ void runMjpegServer(uint16_t port,
 #endif
 }
 
+bool sendJpegPart(int client, const std::vector<uint8_t> &jpeg) {
+  std::ostringstream part;
+  part << "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " << jpeg.size() << "\r\n\r\n";
+  const std::string partHeader = part.str();
+  return sendString(client, partHeader) &&
+         sendAll(client, reinterpret_cast<const char *>(jpeg.data()), jpeg.size()) &&
+         sendAll(client, "\r\n", 2);
+}
+
+}  // namespace
+
+std::vector<uint8_t> encodePreviewJpeg(uint32_t width,
+                                       uint32_t height,
+                                       const std::vector<uint8_t> &rgba,
+                                       float quality) {
+  return encodeJpeg(width, height, rgba, quality);
+}
+
+bool previewJpegEncoderAvailable() {
+  return jpegEncoderAvailable();
+}
+
+void runMjpegServer(uint16_t port,
+                    PreviewFrameStore &previewFrames,
+                    MeetingState &state,
+                    std::atomic<bool> &running) {
+  ScopedThreadRole role("mjpeg");
+  runMjpegListener(
+      port, running,
+      "{\"type\":\"error\",\"code\":\"preview_socket_failed\",\"message\":\"Could not create preview socket.\"}",
+      "{\"type\":\"error\",\"code\":\"preview_bind_failed\",\"message\":\"Could not bind preview port.\"}",
+      [&](int client) {
+        PreviewClientCounter clientCounter(state);
+        std::vector<uint8_t> lastValidJpeg(std::begin(kTinyJpeg), std::end(kTinyJpeg));
+        uint64_t lastSequence = 0u;
+        while (running.load()) {
+          PreviewFrame frame;
+          if (previewFrames.copyLatestIfNew(lastSequence, frame)) {
+            lastSequence = frame.sequence;
+            lastValidJpeg = encodeJpeg(frame.width, frame.height, frame.rgba, 0.95f);
+          }
+          if (!sendJpegPart(client, lastValidJpeg)) {
+            break;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(33));
+        }
+      });
+}
+
+void runMosaicMjpegServer(uint16_t port,
+                          CameraSource &camera,
+                          MeetingState &state,
+                          std::atomic<bool> &running) {
+  ScopedThreadRole role("mosaic_mjpeg");
+  runMjpegListener(
+      port, running,
+      "{\"type\":\"error\",\"code\":\"mosaic_socket_failed\",\"message\":\"Could not create mosaic preview socket.\"}",
+      "{\"type\":\"error\",\"code\":\"mosaic_bind_failed\",\"message\":\"Could not bind mosaic preview port.\"}",
+      [&](int client) {
+        // The atlas lives only while a client watches: no client, no
+        // downscaling and no encoding. Tiles are refreshed per camera on new
+        // frames and the atlas is re-encoded only when something changed.
+        MosaicClientCounter clientCounter(state);
+        CameraMosaic mosaic;
+        std::vector<uint8_t> lastValidJpeg(std::begin(kTinyJpeg), std::end(kTinyJpeg));
+        while (running.load()) {
+          if (mosaic.update(camera)) {
+            lastValidJpeg = encodeJpeg(mosaic.width(), mosaic.height(), mosaic.rgba(), 0.7f);
+          }
+          if (!sendJpegPart(client, lastValidJpeg)) {
+            break;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(66));
+        }
+      });
+}
+
 }  // namespace broadify::meeting
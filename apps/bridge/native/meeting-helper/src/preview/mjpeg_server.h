@@ -2,15 +2,33 @@
 
 #include <atomic>
 #include <cstdint>
+#include <vector>
 
 namespace broadify::meeting {
 
+class CameraSource;
 class PreviewFrameStore;
 struct MeetingState;
 
+// The preview stream's JPEG encoder. Platforms without one stream a fixed
+// placeholder frame instead; previewJpegEncoderAvailable() tells them apart.
+std::vector<uint8_t> encodePreviewJpeg(uint32_t width,
+                                       uint32_t height,
+                                       const std::vector<uint8_t> &rgba,
+                                       float quality);
+bool previewJpegEncoderAvailable();
+
 void runMjpegServer(uint16_t port,
                     PreviewFrameStore &previewFrames,
                     MeetingState &state,
                     std::atomic<bool> &running);
 
+// Conference operator view: every open camera as a thumbnail in one
+// low-resolution MJPEG atlas, with a per-camera audio meter under each tile.
+// Tile placement is reported by the camera.mosaic RPC.
+void runMosaicMjpegServer(uint16_t port,
+                          CameraSource &camera,
+                          MeetingState &state,
+                          std::atomic<bool> &running);
+
 }  // namespace broadify::meeting
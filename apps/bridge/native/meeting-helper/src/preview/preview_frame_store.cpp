@@ -1,5 +1,7 @@
 #include "preview/preview_frame_store.h"
 
+#include "util/frame_copy.h"
+
 namespace broadify::meeting {
 
 void PreviewFrameStore::publish(uint32_t width, uint32_t height, const uint8_t *rgba, size_t rgbaSize) {
@@ -9,7 +11,9 @@ void PreviewFrameStore::publish(uint32_t width, uint32_t height, const uint8_t *
   std::lock_guard<std::mutex> lock(mutex_);
   frame_.width = width;
   frame_.height = height;
-  frame_.rgba.assign(rgba, rgba + rgbaSize);
+  // Read by the MJPEG and raw frame servers, never by the publisher again.
+  frame_.rgba.resize(rgbaSize);
+  copyFrameBytes(frame_.rgba.data(), rgba, rgbaSize, FrameCopyTarget::Handoff);
   ++frame_.sequence;
 }
 
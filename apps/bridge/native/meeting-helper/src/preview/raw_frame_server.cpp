@@ -1,5 +1,7 @@
 #include "preview/raw_frame_server.h"
 
+#include "util/thread_roles.h"
+
 #include <algorithm>
 #include <chrono>
 #include <iostream>
@@ -194,6 +196,7 @@ void runRawFrameServer(uint16_t port,
                        PreviewFrameStore &previewFrames,
                        MeetingState &state,
                        std::atomic<bool> &running) {
+  ScopedThreadRole role("vcam_raw");
 #if defined(_WIN32)
   WSADATA wsa;
   WSAStartup(MAKEWORD(2, 2), &wsa);
@@ -0,0 +1,398 @@
+#include "recorder/frame_recorder.h"
+
+#include "util/jpeg_encode.h"
+#include "util/thread_roles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+constexpr uint32_t kMaxEncoderThreads = 8;
+
+std::FILE *openOutputFile(const std::string &path) {
+#if defined(_WIN32)
+  const int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (length <= 0) {
+    return nullptr;
+  }
+  std::wstring widePath(static_cast<size_t>(length), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), length);
+  return _wfopen(widePath.c_str(), L"wb");
+#else
+  return std::fopen(path.c_str(), "wb");
+#endif
+}
+
+bool seekFile(std::FILE *file, uint64_t offset, int origin) {
+#if defined(_WIN32)
+  return _fseeki64(file, static_cast<__int64>(offset), origin) == 0;
+#else
+  return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+}  // namespace
+
+// Double-buffered sequential file output: the muxer fills fixed-size chunks
+// and a writer thread hands each full chunk to the OS in one unbuffered
+// write. Once every chunk is queued, append() waits for the writer.
+class FrameRecorder::ChunkWriter : public MkvSink {
+ public:
+  ChunkWriter(size_t chunkBytes, uint32_t chunks) : chunkBytes_(std::max<size_t>(chunkBytes, 64u << 10)) {
+    current_.reserve(chunkBytes_);
+    for (uint32_t i = 1; i < std::max(chunks, 2u); ++i) {
+      std::vector<uint8_t> chunk;
+      chunk.reserve(chunkBytes_);
+      free_.push_back(std::move(chunk));
+    }
+  }
+
+  ~ChunkWriter() override { close(); }
+
+  bool open(const std::string &path, std::string &error) {
+    file_ = openOutputFile(path);
+    if (file_ == nullptr) {
+      error = "Could not open " + path + " for writing.";
+      return false;
+    }
+    // Chunks already are the I/O size; stdio buffering would only add a copy.
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    thread_ = std::thread(&ChunkWriter::writeLoop, this);
+    return true;
+  }
+
+  void append(const uint8_t *data, size_t size) override {
+    position_ += size;
+    while (size > 0u) {
+      const size_t take = std::min(size, chunkBytes_ - current_.size());
+      current_.insert(current_.end(), data, data + take);
+      data += take;
+      size -= take;
+      if (current_.size() == chunkBytes_) {
+        submitCurrent();
+      }
+    }
+  }
+
+  uint64_t position() const override { return position_; }
+
+  bool patch(uint64_t offset, const uint8_t *data, size_t size) override {
+    drain();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr || !error_.empty()) {
+      return false;
+    }
+    const bool ok = seekFile(file_, offset, SEEK_SET) && std::fwrite(data, 1, size, file_) == size &&
+                    seekFile(file_, 0, SEEK_END);
+    if (!ok) {
+      error_ = "Could not finalize the recording file.";
+    }
+    return ok;
+  }
+
+  // Writes everything appended so far, stops the writer and closes the file.
+  void close() {
+    if (file_ == nullptr) {
+      return;
+    }
+    drain();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    if (std::fclose(file_) != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (error_.empty()) {
+        error_ = "Could not close the recording file.";
+      }
+    }
+    file_ = nullptr;
+  }
+
+  void fillStats(FrameRecorderStats &stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.bytesWritten = bytesWritten_;
+    stats.writeSeconds = writeSeconds_;
+    stats.maxWriteMs = maxWriteMs_;
+    stats.writerWaitMs = waitMs_;
+    if (stats.error.empty()) {
+      stats.error = error_;
+    }
+  }
+
+ private:
+  void submitCurrent() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+      const auto waitStart = std::chrono::steady_clock::now();
+      idle_.wait(lock, [this]() { return !free_.empty(); });
+      waitMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+    full_.push_back(std::move(current_));
+    current_ = std::move(free_.back());
+    free_.pop_back();
+    current_.clear();
+    lock.unlock();
+    wake_.notify_one();
+  }
+
+  void drain() {
+    if (!current_.empty()) {
+      submitCurrent();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return full_.empty() && !writing_; });
+  }
+
+  void writeLoop() {
+    ScopedThreadRole role("recorder_write");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this]() { return stopping_ || !full_.empty(); });
+      if (full_.empty()) {
+        return;
+      }
+      std::vector<uint8_t> chunk = std::move(full_.front());
+      full_.pop_front();
+      writing_ = true;
+      const bool failed = !error_.empty();
+      lock.unlock();
+
+      // After a failed write the remaining chunks are discarded: the
+      // recording is already broken and the muxer must not stall on it.
+      const auto start = std::chrono::steady_clock::now();
+      const bool ok = failed || std::fwrite(chunk.data(), 1, chunk.size(), file_) == chunk.size();
+      const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+      lock.lock();
+      if (!failed) {
+        if (ok) {
+          bytesWritten_ += chunk.size();
+        } else {
+          error_ = "Write to the recording file failed (disk full or removed?).";
+        }
+        writeSeconds_ += ms / 1000.0;
+        maxWriteMs_ = std::max(maxWriteMs_, ms);
+      }
+      chunk.clear();
+      free_.push_back(std::move(chunk));
+      writing_ = false;
+      idle_.notify_all();
+    }
+  }
+
+  const size_t chunkBytes_;
+  std::FILE *file_ = nullptr;
+  std::thread thread_;
+  // Muxer side (one muxing thread at a time).
+  std::vector<uint8_t> current_;
+  uint64_t position_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::vector<std::vector<uint8_t>> free_;
+  std::deque<std::vector<uint8_t>> full_;
+  bool writing_ = false;
+  bool stopping_ = false;
+  uint64_t bytesWritten_ = 0;
+  double writeSeconds_ = 0.0;
+  double maxWriteMs_ = 0.0;
+  double waitMs_ = 0.0;
+  std::string error_;
+};
+
+FrameRecorder::FrameRecorder(const FrameRecorderOptions &options) : options_(options) {
+  options_.bufferedFrames = std::max(options_.bufferedFrames, 2u);
+  options_.encoderThreads = std::clamp(options_.encoderThreads, 1u, kMaxEncoderThreads);
+  if (options_.codec == RecorderCodec::kMjpeg && !jpegEncoderAvailable()) {
+    options_.codec = RecorderCodec::kRaw;
+  }
+}
+
+FrameRecorder::~FrameRecorder() {
+  finish(lastTimestampMs_);
+}
+
+bool FrameRecorder::open(const std::string &path, std::string &error) {
+  if (writer_ || options_.width == 0u || options_.height == 0u) {
+    error = "Recorder is already open or has no frame size.";
+    return false;
+  }
+  // Every buffer is allocated up front: the pool size is the memory bound.
+  const size_t frameBytes = static_cast<size_t>(options_.width) * options_.height * 4u;
+  slots_.resize(options_.bufferedFrames);
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    slots_[i].rgba.resize(frameBytes);
+    free_.push_back(slots_.size() - 1u - i);
+  }
+
+  auto writer = std::make_unique<ChunkWriter>(options_.writeChunkBytes, options_.writeChunks);
+  if (!writer->open(path, error)) {
+    return false;
+  }
+  writer_ = std::move(writer);
+  mkv_ = std::make_unique<MkvWriter>(*writer_);
+  MkvVideoTrack track;
+  track.width = options_.width;
+  track.height = options_.height;
+  track.fps = options_.fps;
+  if (options_.codec == RecorderCodec::kMjpeg) {
+    track.codecId = "V_MJPEG";
+  } else {
+    track.codecId = "V_UNCOMPRESSED";
+    track.colourSpace = "RGBA";
+  }
+  mkv_->begin(track);
+  for (uint32_t i = 0; i < options_.encoderThreads; ++i) {
+    encoders_.emplace_back(&FrameRecorder::encodeLoop, this);
+  }
+  return true;
+}
+
+FrameRecorder::PushResult FrameRecorder::push(int64_t timestampMs,
+                                              const std::function<bool(uint8_t *, size_t)> &fill) {
+  size_t index = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!writer_ || stopping_) {
+      return PushResult::kSkipped;
+    }
+    if (free_.empty()) {
+      ++droppedBufferFull_;
+      return PushResult::kDropped;
+    }
+    index = free_.back();
+    free_.pop_back();
+  }
+
+  // The slot is owned by this thread until it is queued.
+  Slot &slot = slots_[index];
+  const bool filled = fill(slot.rgba.data(), static_cast<size_t>(options_.width) * 4u);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!filled) {
+    free_.push_back(index);
+    return PushResult::kSkipped;
+  }
+  slot.timestampMs = std::max(timestampMs, lastTimestampMs_);
+  lastTimestampMs_ = slot.timestampMs;
+  slot.ready = false;
+  slot.ok = false;
+  order_.push_back(index);
+  encodeQueue_.push_back(index);
+  ++framesQueued_;
+  wake_.notify_one();
+  return PushResult::kQueued;
+}
+
+void FrameRecorder::encodeLoop() {
+  ScopedThreadRole role("recorder_encode");
+  while (true) {
+    size_t index = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this]() { return stopping_ || !encodeQueue_.empty(); });
+      if (encodeQueue_.empty()) {
+        return;
+      }
+      index = encodeQueue_.front();
+      encodeQueue_.pop_front();
+    }
+
+    Slot &slot = slots_[index];
+    const bool ok = options_.codec == RecorderCodec::kRaw ||
+                    encodeJpegRgba(slot.rgba.data(), options_.width, options_.height,
+                                   static_cast<size_t>(options_.width) * 4u, options_.jpegQuality, slot.encoded);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slot.ok = ok;
+      slot.ready = true;
+    }
+    muxReady();
+  }
+}
+
+// Muxes the encoded frames at the head of the capture order. Encoders finish
+// out of order; whichever holds muxMutex_ writes every frame that is ready,
+// so the file stays in capture order without a dedicated mux thread.
+void FrameRecorder::muxReady() {
+  std::lock_guard<std::mutex> muxLock(muxMutex_);
+  while (true) {
+    size_t index = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (order_.empty() || !slots_[order_.front()].ready) {
+        return;
+      }
+      index = order_.front();
+      order_.pop_front();
+    }
+
+    Slot &slot = slots_[index];
+    if (slot.ok) {
+      const std::vector<uint8_t> &data = options_.codec == RecorderCodec::kRaw ? slot.rgba : slot.encoded;
+      mkv_->addFrame(slot.timestampMs, data.data(), data.size());
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (slot.ok) {
+      ++framesWritten_;
+    } else {
+      ++encodeFailures_;
+    }
+    slot.ready = false;
+    free_.push_back(index);
+  }
+}
+
+bool FrameRecorder::finish(int64_t durationMs) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!writer_ || finished_) {
+      return writer_ != nullptr;
+    }
+    stopping_ = true;
+    finished_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &encoder : encoders_) {
+    encoder.join();
+  }
+  encoders_.clear();
+  muxReady();
+  mkv_->finish(std::max(durationMs, lastTimestampMs_));
+  writer_->close();
+  return stats().error.empty();
+}
+
+FrameRecorderStats FrameRecorder::stats() const {
+  FrameRecorderStats stats;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.framesQueued = framesQueued_;
+    stats.framesWritten = framesWritten_;
+    stats.droppedBufferFull = droppedBufferFull_;
+    stats.encodeFailures = encodeFailures_;
+    stats.bufferedFrames = static_cast<uint32_t>(slots_.size() - free_.size());
+  }
+  if (writer_) {
+    writer_->fillStats(stats);
+  }
+  return stats;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "recorder/mkv_writer.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace broadify::meeting {
+
+enum class RecorderCodec {
+  kMjpeg,  // per-frame JPEG; needs jpegEncoderAvailable()
+  kRaw,    // uncompressed RGBA, no encode cost, ~width*height*4 bytes a frame
+};
+
+struct FrameRecorderOptions {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t fps = 30;
+  RecorderCodec codec = RecorderCodec::kMjpeg;
+  float jpegQuality = 0.9f;
+  // Captured frames waiting for encode or disk. When all are taken the
+  // next frame is dropped, so a stall never grows memory.
+  uint32_t bufferedFrames = 8;
+  uint32_t encoderThreads = 2;
+  // Muxed bytes go to disk in writes of this size; `writeChunks` of them
+  // absorb disk latency before encoders wait on the writer.
+  size_t writeChunkBytes = 8u << 20;
+  uint32_t writeChunks = 4;
+};
+
+struct FrameRecorderStats {
+  uint64_t framesQueued = 0;
+  uint64_t framesWritten = 0;
+  uint64_t droppedBufferFull = 0;
+  uint64_t encodeFailures = 0;
+  uint64_t bytesWritten = 0;
+  double writeSeconds = 0.0;  // inside write calls
+  double maxWriteMs = 0.0;
+  double writerWaitMs = 0.0;  // muxing blocked on a free write chunk
+  uint32_t bufferedFrames = 0;
+  std::string error;
+};
+
+// Recording core of framebus-recorder: a bounded pool of frame buffers
+// filled by the capture thread, encoder threads that compress frames in
+// parallel and mux them in capture order into a Matroska file, and a writer
+// thread that issues large sequential writes. Disk stalls back up into the
+// write chunks, then the frame pool, and finally show up as dropped frames;
+// the capture thread never blocks on encode or I/O.
+class FrameRecorder {
+ public:
+  explicit FrameRecorder(const FrameRecorderOptions &options);
+  ~FrameRecorder();
+
+  FrameRecorder(const FrameRecorder &) = delete;
+  FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+  bool open(const std::string &path, std::string &error);
+
+  enum class PushResult { kQueued, kDropped, kSkipped };
+  // Capture thread. Hands `fill` a free RGBA frame buffer (rows width * 4
+  // bytes apart) to copy the frame into. kDropped: no free buffer, counted
+  // in droppedBufferFull. kSkipped: `fill` returned false; not counted.
+  PushResult push(int64_t timestampMs, const std::function<bool(uint8_t *rgba, size_t stride)> &fill);
+
+  // Drains queued frames, writes the index and closes the file. Returns
+  // false when any write failed.
+  bool finish(int64_t durationMs);
+
+  FrameRecorderStats stats() const;
+  // Effective options: limits clamped, and MJPEG replaced by raw where the
+  // platform has no JPEG encoder.
+  const FrameRecorderOptions &options() const { return options_; }
+
+ private:
+  struct Slot {
+    std::vector<uint8_t> rgba;
+    std::vector<uint8_t> encoded;
+    int64_t timestampMs = 0;
+    bool ready = false;  // encoded (or failed) and waiting to be muxed
+    bool ok = false;
+  };
+  class ChunkWriter;
+
+  void encodeLoop();
+  void muxReady();
+
+  FrameRecorderOptions options_;
+  std::vector<Slot> slots_;
+  std::unique_ptr<ChunkWriter> writer_;
+  std::unique_ptr<MkvWriter> mkv_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<size_t> free_;
+  std::deque<size_t> encodeQueue_;
+  std::deque<size_t> order_;  // queued slots in capture order
+  bool stopping_ = false;
+  bool finished_ = false;
+  uint64_t framesQueued_ = 0;
+  uint64_t droppedBufferFull_ = 0;
+  uint64_t encodeFailures_ = 0;
+  uint64_t framesWritten_ = 0;
+  int64_t lastTimestampMs_ = 0;
+  std::vector<std::thread> encoders_;
+  // Serializes muxing; held by one encoder at a time.
+  std::mutex muxMutex_;
+};
+
+}  // namespace broadify::meeting
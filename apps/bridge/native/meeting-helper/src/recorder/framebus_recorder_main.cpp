@@ -0,0 +1,377 @@
+// framebus-recorder: records any FrameBus segment to a Matroska file in its
+// own process, so encode and disk stalls never touch the producer's program
+// pipeline. Events go to stdout as JSON lines, like meeting-helper's.
+//
+//   framebus-recorder --framebus-name NAME --output FILE.mkv
+//                     [--codec mjpeg|raw] [--quality 0.9]
+//                     [--buffer-frames 8] [--encoder-threads 2]
+//                     [--write-chunk-mb 8] [--cpus 2,3]
+//                     [--duration-seconds N] [--wait-seconds 10]
+//                     [--parent-pid PID]
+
+#include "framebus_reader.h"
+#include "recorder/frame_recorder.h"
+#include "util/jpeg_encode.h"
+#include "util/json_utils.h"
+#include "util/thread_roles.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+std::atomic<bool> g_running{true};
+
+void signalHandler(int) {
+  g_running.store(false);
+}
+
+void printEvent(const std::string &json) {
+  std::cout << json << std::endl;
+}
+
+struct RecorderArgs {
+  std::string framebusName;
+  std::string output;
+  FrameRecorderOptions recorder;
+  std::vector<uint32_t> cpus;
+  uint32_t durationSeconds = 0;  // 0 = until stopped
+  uint32_t waitSeconds = 10;
+  int parentPid = 0;
+};
+
+uint32_t parseU32(const char *value, uint32_t fallback) {
+  if (value == nullptr) {
+    return fallback;
+  }
+  char *end = nullptr;
+  const unsigned long parsed = std::strtoul(value, &end, 10);
+  if (end == value || parsed > 0xFFFFFFFFul) {
+    return fallback;
+  }
+  return static_cast<uint32_t>(parsed);
+}
+
+std::vector<uint32_t> parseCpuList(const std::string &value) {
+  std::vector<uint32_t> cpus;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      cpus.push_back(parseU32(item.c_str(), 0u));
+    }
+  }
+  return cpus;
+}
+
+bool parseArgs(int argc, char **argv, RecorderArgs &args) {
+  args.recorder.codec = jpegEncoderAvailable() ? RecorderCodec::kMjpeg : RecorderCodec::kRaw;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      return false;
+    }
+    ++i;
+    if (arg == "--framebus-name") {
+      args.framebusName = value;
+    } else if (arg == "--output") {
+      args.output = value;
+    } else if (arg == "--codec") {
+      if (std::strcmp(value, "mjpeg") == 0) {
+        args.recorder.codec = RecorderCodec::kMjpeg;
+      } else if (std::strcmp(value, "raw") == 0) {
+        args.recorder.codec = RecorderCodec::kRaw;
+      } else {
+        return false;
+      }
+    } else if (arg == "--quality") {
+      args.recorder.jpegQuality = std::clamp(static_cast<float>(std::atof(value)), 0.1f, 1.0f);
+    } else if (arg == "--buffer-frames") {
+      args.recorder.bufferedFrames = parseU32(value, args.recorder.bufferedFrames);
+    } else if (arg == "--encoder-threads") {
+      args.recorder.encoderThreads = parseU32(value, args.recorder.encoderThreads);
+    } else if (arg == "--write-chunk-mb") {
+      args.recorder.writeChunkBytes = static_cast<size_t>(std::clamp(parseU32(value, 8u), 1u, 256u)) << 20;
+    } else if (arg == "--cpus") {
+      args.cpus = parseCpuList(value);
+    } else if (arg == "--duration-seconds") {
+      args.durationSeconds = parseU32(value, 0u);
+    } else if (arg == "--wait-seconds") {
+      args.waitSeconds = parseU32(value, args.waitSeconds);
+    } else if (arg == "--parent-pid") {
+      args.parentPid = static_cast<int>(parseU32(value, 0u));
+    } else {
+      return false;
+    }
+  }
+  return !args.framebusName.empty() && !args.output.empty();
+}
+
+// Pins the whole process to `cpus`. Called before any thread starts, so
+// every recorder thread inherits the mask. macOS has no affinity API.
+bool applyCpuAffinity(const std::vector<uint32_t> &cpus, std::string &error) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (uint32_t cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      error = "CPU index out of range.";
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    error = std::string("sched_setaffinity failed: ") + std::strerror(errno);
+    return false;
+  }
+  return true;
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for (uint32_t cpu : cpus) {
+    if (cpu >= sizeof(DWORD_PTR) * 8u) {
+      error = "CPU index out of range.";
+      return false;
+    }
+    mask |= DWORD_PTR{1} << cpu;
+  }
+  if (!SetProcessAffinityMask(GetCurrentProcess(), mask)) {
+    error = "SetProcessAffinityMask failed.";
+    return false;
+  }
+  return true;
+#else
+  (void)cpus;
+  error = "CPU affinity is not supported on this platform.";
+  return false;
+#endif
+}
+
+bool parentGone(int parentPid) {
+  if (parentPid <= 0) {
+    return false;
+  }
+#if defined(_WIN32)
+  HANDLE handle = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(parentPid));
+  if (handle == nullptr) {
+    return true;
+  }
+  const bool exited = WaitForSingleObject(handle, 0) == WAIT_OBJECT_0;
+  CloseHandle(handle);
+  return exited;
+#else
+  return kill(static_cast<pid_t>(parentPid), 0) != 0 && errno == ESRCH;
+#endif
+}
+
+const char *codecName(RecorderCodec codec) {
+  return codec == RecorderCodec::kMjpeg ? "mjpeg" : "raw";
+}
+
+// Counters kept by the capture loop next to the recorder's own.
+struct CaptureCounters {
+  uint64_t missed = 0;  // producer frames replaced before the loop saw them
+  uint64_t torn = 0;    // copies overrun by the writer; retried
+};
+
+void appendStats(std::ostringstream &out, const FrameRecorderStats &stats, const CaptureCounters &capture) {
+  out << "\"frames_written\":" << stats.framesWritten
+      << ",\"frames_queued\":" << stats.framesQueued
+      << ",\"dropped\":{\"buffer_full\":" << stats.droppedBufferFull
+      << ",\"missed\":" << capture.missed
+      << ",\"encode_failed\":" << stats.encodeFailures
+      << "},\"torn_retries\":" << capture.torn
+      << ",\"buffered_frames\":" << stats.bufferedFrames
+      << ",\"bytes_written\":" << stats.bytesWritten
+      << ",\"write_seconds\":" << stats.writeSeconds
+      << ",\"max_write_ms\":" << stats.maxWriteMs
+      << ",\"writer_wait_ms\":" << stats.writerWaitMs;
+  if (!stats.error.empty()) {
+    out << ",\"error\":\"" << jsonEscape(stats.error) << "\"";
+  }
+}
+
+}  // namespace
+}  // namespace broadify::meeting
+
+int main(int argc, char **argv) {
+  using namespace broadify::meeting;
+
+  std::signal(SIGINT, signalHandler);
+  std::signal(SIGTERM, signalHandler);
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  RecorderArgs args;
+  if (!parseArgs(argc, argv, args)) {
+    std::cerr << "usage: framebus-recorder --framebus-name NAME --output FILE.mkv [--codec mjpeg|raw] "
+                 "[--quality 0.9] [--buffer-frames 8] [--encoder-threads 2] [--write-chunk-mb 8] "
+                 "[--cpus 2,3] [--duration-seconds N] [--wait-seconds 10] [--parent-pid PID]"
+              << std::endl;
+    return 2;
+  }
+  if (!args.cpus.empty()) {
+    std::string error;
+    if (!applyCpuAffinity(args.cpus, error)) {
+      printEvent("{\"type\":\"warning\",\"code\":\"affinity_failed\",\"message\":\"" + jsonEscape(error) + "\"}");
+    }
+  }
+  ScopedThreadRole role("recorder_capture");
+
+  framebus_reader_t *reader = nullptr;
+  const auto waitUntil = std::chrono::steady_clock::now() + std::chrono::seconds(args.waitSeconds);
+  while (g_running.load() && reader == nullptr) {
+    reader = framebus_reader_open(args.framebusName.c_str());
+    if (reader == nullptr) {
+      if (std::chrono::steady_clock::now() >= waitUntil) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+  if (reader == nullptr) {
+    printEvent("{\"type\":\"error\",\"code\":\"framebus_unavailable\",\"message\":\"FrameBus segment " +
+               jsonEscape(args.framebusName) + " could not be opened.\"}");
+    return 3;
+  }
+  uint32_t fps = 0;
+  framebus_reader_get_info(reader, &args.recorder.width, &args.recorder.height, &fps);
+  args.recorder.fps = fps == 0u ? 30u : fps;
+
+  FrameRecorder recorder(args.recorder);
+  std::string openError;
+  if (!recorder.open(args.output, openError)) {
+    printEvent("{\"type\":\"error\",\"code\":\"output_open_failed\",\"message\":\"" + jsonEscape(openError) + "\"}");
+    framebus_reader_close(reader);
+    return 4;
+  }
+
+  std::ostringstream ready;
+  ready << "{\"type\":\"ready\",\"framebus\":\"" << jsonEscape(args.framebusName)
+        << "\",\"output\":\"" << jsonEscape(args.output)
+        << "\",\"width\":" << args.recorder.width
+        << ",\"height\":" << args.recorder.height
+        << ",\"fps\":" << args.recorder.fps
+        << ",\"codec\":\"" << codecName(recorder.options().codec)
+        << "\",\"buffer_frames\":" << recorder.options().bufferedFrames
+        << ",\"encoder_threads\":" << recorder.options().encoderThreads
+        << ",\"write_chunk_bytes\":" << recorder.options().writeChunkBytes << "}";
+  printEvent(ready.str());
+
+  // The loop only polls the sequence counter between frames; copying is the
+  // only per-frame work on this thread.
+  const auto pollInterval = std::chrono::microseconds(
+      std::clamp<int64_t>(250000 / static_cast<int64_t>(args.recorder.fps), 500, 4000));
+  CaptureCounters capture;
+  uint64_t cursor = framebus_reader_seq(reader);
+  bool started = false;
+  std::chrono::steady_clock::time_point firstFrameAt;
+  auto lastMetricsAt = std::chrono::steady_clock::now();
+  auto lastWatchdogAt = lastMetricsAt;
+  uint64_t lastBytes = 0;
+  uint64_t metricsTick = 0;
+  std::string reason = "stopped";
+
+  while (g_running.load()) {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t seq = framebus_reader_seq(reader);
+    if (seq != cursor && seq != 0u) {
+      if (!started) {
+        started = true;
+        firstFrameAt = now;
+      }
+      const int64_t timestampMs =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - firstFrameAt).count();
+      const uint64_t previous = cursor;
+      int copyResult = 0;
+      const FrameRecorder::PushResult result = recorder.push(timestampMs, [&](uint8_t *rgba, size_t stride) {
+        copyResult = framebus_reader_copy_latest_rgba(reader, rgba, stride, &cursor);
+        return copyResult == 1;
+      });
+      if (result == FrameRecorder::PushResult::kDropped) {
+        cursor = seq;
+      }
+      if (result != FrameRecorder::PushResult::kSkipped && previous != 0u && cursor > previous + 1u) {
+        capture.missed += cursor - previous - 1u;
+      }
+      if (copyResult == -2) {
+        ++capture.torn;
+      } else if (copyResult == -3) {
+        reason = "source_retired";
+        break;
+      }
+    } else {
+      std::this_thread::sleep_for(pollInterval);
+    }
+
+    if (now - lastMetricsAt >= std::chrono::seconds(2)) {
+      const FrameRecorderStats stats = recorder.stats();
+      const double seconds = std::chrono::duration<double>(now - lastMetricsAt).count();
+      std::ostringstream metrics;
+      metrics << "{\"type\":\"metrics\",\"tick\":" << metricsTick++ << ",";
+      appendStats(metrics, stats, capture);
+      metrics << ",\"write_mbps\":" << static_cast<double>(stats.bytesWritten - lastBytes) / seconds / 1e6
+              << ",\"threads\":{" << threadRoleSampleJson(sampleThreadRoles()) << "}}";
+      printEvent(metrics.str());
+      lastBytes = stats.bytesWritten;
+      lastMetricsAt = now;
+      if (!stats.error.empty()) {
+        reason = "write_failed";
+        break;
+      }
+    }
+    if (args.durationSeconds > 0u && started &&
+        now - firstFrameAt >= std::chrono::seconds(args.durationSeconds)) {
+      reason = "duration_reached";
+      break;
+    }
+    if (now - lastWatchdogAt >= std::chrono::seconds(2)) {
+      lastWatchdogAt = now;
+      if (parentGone(args.parentPid)) {
+        reason = "parent_exited";
+        break;
+      }
+    }
+  }
+
+  const int64_t durationMs = started
+      ? std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - firstFrameAt).count()
+      : 0;
+  const bool ok = recorder.finish(durationMs);
+  framebus_reader_close(reader);
+
+  const FrameRecorderStats stats = recorder.stats();
+  std::ostringstream stopped;
+  stopped << "{\"type\":\"stopped\",\"reason\":\"" << reason << "\",\"duration_ms\":" << durationMs << ",";
+  appendStats(stopped, stats, capture);
+  // write_mbps averages over the recording; disk_mbps over time spent in
+  // write calls, i.e. what the disk sustained while it was busy.
+  stopped << ",\"write_mbps\":"
+          << (durationMs > 0 ? static_cast<double>(stats.bytesWritten) / static_cast<double>(durationMs) / 1e3 : 0.0)
+          << ",\"disk_mbps\":"
+          << (stats.writeSeconds > 0.0 ? static_cast<double>(stats.bytesWritten) / stats.writeSeconds / 1e6 : 0.0)
+          << "}";
+  printEvent(stopped.str());
+  return ok ? 0 : 5;
+}
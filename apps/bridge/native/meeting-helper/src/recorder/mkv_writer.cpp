@@ -0,0 +1,290 @@
+#include "recorder/mkv_writer.h"
+
+#include <cstring>
+
+namespace broadify::meeting {
+namespace {
+
+// Element IDs (Matroska / EBML specification), marker bits included.
+constexpr uint32_t kEbml = 0x1A45DFA3u;
+constexpr uint32_t kEbmlVersion = 0x4286u;
+constexpr uint32_t kEbmlReadVersion = 0x42F7u;
+constexpr uint32_t kEbmlMaxIdLength = 0x42F2u;
+constexpr uint32_t kEbmlMaxSizeLength = 0x42F3u;
+constexpr uint32_t kDocType = 0x4282u;
+constexpr uint32_t kDocTypeVersion = 0x4287u;
+constexpr uint32_t kDocTypeReadVersion = 0x4285u;
+constexpr uint32_t kSegment = 0x18538067u;
+constexpr uint32_t kSeekHead = 0x114D9B74u;
+constexpr uint32_t kSeek = 0x4DBBu;
+constexpr uint32_t kSeekId = 0x53ABu;
+constexpr uint32_t kSeekPosition = 0x53ACu;
+constexpr uint32_t kVoid = 0xECu;
+constexpr uint32_t kInfo = 0x1549A966u;
+constexpr uint32_t kTimestampScale = 0x2AD7B1u;
+constexpr uint32_t kMuxingApp = 0x4D80u;
+constexpr uint32_t kWritingApp = 0x5741u;
+constexpr uint32_t kDuration = 0x4489u;
+constexpr uint32_t kTracks = 0x1654AE6Bu;
+constexpr uint32_t kTrackEntry = 0xAEu;
+constexpr uint32_t kTrackNumber = 0xD7u;
+constexpr uint32_t kTrackUid = 0x73C5u;
+constexpr uint32_t kTrackType = 0x83u;
+constexpr uint32_t kFlagLacing = 0x9Cu;
+constexpr uint32_t kCodecId = 0x86u;
+constexpr uint32_t kDefaultDuration = 0x23E383u;
+constexpr uint32_t kVideo = 0xE0u;
+constexpr uint32_t kPixelWidth = 0xB0u;
+constexpr uint32_t kPixelHeight = 0xBAu;
+constexpr uint32_t kColourSpace = 0x2EB524u;
+constexpr uint32_t kCluster = 0x1F43B675u;
+constexpr uint32_t kTimestamp = 0xE7u;
+constexpr uint32_t kSimpleBlock = 0xA3u;
+constexpr uint32_t kCues = 0x1C53BB6Bu;
+constexpr uint32_t kCuePoint = 0xBBu;
+constexpr uint32_t kCueTime = 0xB3u;
+constexpr uint32_t kCueTrackPositions = 0xB7u;
+constexpr uint32_t kCueTrack = 0xF7u;
+constexpr uint32_t kCueClusterPosition = 0xF1u;
+
+constexpr const char *kAppName = "broadify framebus-recorder";
+// Bytes reserved after the segment start for the seek head written by
+// finish(); three Seek entries need well under half of it.
+constexpr size_t kSeekHeadReserve = 96u;
+// Clusters start at least this often; cues point at cluster starts, so it is
+// also the seek granularity.
+constexpr int64_t kClusterMs = 1000;
+
+class EbmlBuffer {
+ public:
+  std::vector<uint8_t> bytes;
+
+  void id(uint32_t value) {
+    bool started = false;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      const uint8_t byte = static_cast<uint8_t>(value >> shift);
+      if (byte != 0u || started || shift == 0) {
+        bytes.push_back(byte);
+        started = true;
+      }
+    }
+  }
+
+  void size(uint64_t value) {
+    size_t length = 1;
+    while (length < 8u && value >= (uint64_t{1} << (7u * length)) - 1u) {
+      ++length;
+    }
+    sizeWithLength(value, length);
+  }
+
+  // Eight-byte size field, patchable in place.
+  void size8(uint64_t value) { sizeWithLength(value, 8u); }
+
+  void unknownSize() {
+    bytes.push_back(0x01u);
+    bytes.insert(bytes.end(), 7u, 0xFFu);
+  }
+
+  void uinteger(uint32_t elementId, uint64_t value) {
+    size_t length = 1;
+    while (length < 8u && (value >> (8u * length)) != 0u) {
+      ++length;
+    }
+    id(elementId);
+    size(length);
+    for (size_t i = length; i-- > 0;) {
+      bytes.push_back(static_cast<uint8_t>(value >> (8u * i)));
+    }
+  }
+
+  void floating(uint32_t elementId, double value) {
+    id(elementId);
+    size(8u);
+    appendDouble(value);
+  }
+
+  void string(uint32_t elementId, const std::string &value) {
+    binary(elementId, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+  }
+
+  void binary(uint32_t elementId, const uint8_t *data, size_t length) {
+    id(elementId);
+    size(length);
+    bytes.insert(bytes.end(), data, data + length);
+  }
+
+  void master(uint32_t elementId, const EbmlBuffer &child) {
+    id(elementId);
+    size(child.bytes.size());
+    bytes.insert(bytes.end(), child.bytes.begin(), child.bytes.end());
+  }
+
+  // A Void element of exactly `total` bytes (at least 2).
+  void voidElement(size_t total) {
+    id(kVoid);
+    if (total - 2u < 127u) {
+      size(total - 2u);
+      bytes.insert(bytes.end(), total - 2u, 0u);
+    } else {
+      size8(total - 9u);
+      bytes.insert(bytes.end(), total - 9u, 0u);
+    }
+  }
+
+  void appendDouble(double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      bytes.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+  }
+
+ private:
+  void sizeWithLength(uint64_t value, size_t length) {
+    const uint64_t marked = value | (uint64_t{1} << (7u * length));
+    for (size_t i = length; i-- > 0;) {
+      bytes.push_back(static_cast<uint8_t>(marked >> (8u * i)));
+    }
+  }
+};
+
+std::vector<uint8_t> idBytes(uint32_t value) {
+  EbmlBuffer buffer;
+  buffer.id(value);
+  return buffer.bytes;
+}
+
+}  // namespace
+
+MkvWriter::MkvWriter(MkvSink &sink) : sink_(sink) {}
+
+void MkvWriter::begin(const MkvVideoTrack &track) {
+  EbmlBuffer header;
+  EbmlBuffer ebml;
+  ebml.uinteger(kEbmlVersion, 1);
+  ebml.uinteger(kEbmlReadVersion, 1);
+  ebml.uinteger(kEbmlMaxIdLength, 4);
+  ebml.uinteger(kEbmlMaxSizeLength, 8);
+  ebml.string(kDocType, "matroska");
+  ebml.uinteger(kDocTypeVersion, 4);
+  ebml.uinteger(kDocTypeReadVersion, 2);
+  header.master(kEbml, ebml);
+  header.id(kSegment);
+  segmentSizeOffset_ = sink_.position() + header.bytes.size();
+  header.unknownSize();
+  segmentDataOffset_ = sink_.position() + header.bytes.size();
+
+  seekHeadOffset_ = segmentDataOffset_;
+  header.voidElement(kSeekHeadReserve);
+
+  EbmlBuffer info;
+  info.uinteger(kTimestampScale, 1000000);  // timestamps in milliseconds
+  info.string(kMuxingApp, kAppName);
+  info.string(kWritingApp, kAppName);
+  info.floating(kDuration, 0.0);
+  infoOffset_ = sink_.position() + header.bytes.size();
+  header.master(kInfo, info);
+  durationOffset_ = sink_.position() + header.bytes.size() - 8u;
+
+  EbmlBuffer video;
+  video.uinteger(kPixelWidth, track.width);
+  video.uinteger(kPixelHeight, track.height);
+  if (track.colourSpace.size() == 4u) {
+    video.binary(kColourSpace, reinterpret_cast<const uint8_t *>(track.colourSpace.data()), 4u);
+  }
+  EbmlBuffer entry;
+  entry.uinteger(kTrackNumber, 1);
+  entry.uinteger(kTrackUid, 1);
+  entry.uinteger(kTrackType, 1);  // video
+  entry.uinteger(kFlagLacing, 0);
+  entry.string(kCodecId, track.codecId);
+  if (track.fps > 0u) {
+    entry.uinteger(kDefaultDuration, 1000000000ull / track.fps);
+  }
+  entry.master(kVideo, video);
+  EbmlBuffer tracks;
+  tracks.master(kTrackEntry, entry);
+  tracksOffset_ = sink_.position() + header.bytes.size();
+  header.master(kTracks, tracks);
+
+  sink_.append(header.bytes.data(), header.bytes.size());
+}
+
+void MkvWriter::startCluster(int64_t timestampMs) {
+  cues_.push_back({timestampMs, sink_.position() - segmentDataOffset_});
+  EbmlBuffer cluster;
+  cluster.id(kCluster);
+  cluster.unknownSize();
+  cluster.uinteger(kTimestamp, static_cast<uint64_t>(timestampMs));
+  sink_.append(cluster.bytes.data(), cluster.bytes.size());
+  clusterOpen_ = true;
+  clusterTimestampMs_ = timestampMs;
+}
+
+void MkvWriter::addFrame(int64_t timestampMs, const uint8_t *data, size_t size) {
+  if (timestampMs < 0) {
+    timestampMs = 0;
+  }
+  if (!clusterOpen_ || timestampMs < clusterTimestampMs_ || timestampMs - clusterTimestampMs_ >= kClusterMs) {
+    startCluster(timestampMs);
+  }
+  const int16_t relative = static_cast<int16_t>(timestampMs - clusterTimestampMs_);
+  EbmlBuffer block;
+  block.id(kSimpleBlock);
+  block.size(size + 4u);
+  block.bytes.push_back(0x81u);  // track 1
+  block.bytes.push_back(static_cast<uint8_t>(static_cast<uint16_t>(relative) >> 8));
+  block.bytes.push_back(static_cast<uint8_t>(relative));
+  block.bytes.push_back(0x80u);  // keyframe
+  sink_.append(block.bytes.data(), block.bytes.size());
+  sink_.append(data, size);
+  ++frames_;
+}
+
+void MkvWriter::finish(int64_t durationMs) {
+  const uint64_t cuesOffset = sink_.position();
+  EbmlBuffer cuePoints;
+  for (const CuePoint &cue : cues_) {
+    EbmlBuffer positions;
+    positions.uinteger(kCueTrack, 1);
+    positions.uinteger(kCueClusterPosition, cue.clusterPosition);
+    EbmlBuffer point;
+    point.uinteger(kCueTime, static_cast<uint64_t>(cue.timestampMs));
+    point.master(kCueTrackPositions, positions);
+    cuePoints.master(kCuePoint, point);
+  }
+  EbmlBuffer cues;
+  if (!cues_.empty()) {
+    cues.master(kCues, cuePoints);
+    sink_.append(cues.bytes.data(), cues.bytes.size());
+  }
+
+  EbmlBuffer segmentSize;
+  segmentSize.size8(sink_.position() - segmentDataOffset_);
+  sink_.patch(segmentSizeOffset_, segmentSize.bytes.data(), segmentSize.bytes.size());
+
+  EbmlBuffer duration;
+  duration.appendDouble(static_cast<double>(durationMs < 0 ? 0 : durationMs));
+  sink_.patch(durationOffset_, duration.bytes.data(), duration.bytes.size());
+
+  EbmlBuffer seeks;
+  const auto addSeek = [&](uint32_t elementId, uint64_t offset) {
+    const std::vector<uint8_t> id = idBytes(elementId);
+    EbmlBuffer seek;
+    seek.binary(kSeekId, id.data(), id.size());
+    seek.uinteger(kSeekPosition, offset - segmentDataOffset_);
+    seeks.master(kSeek, seek);
+  };
+  addSeek(kInfo, infoOffset_);
+  addSeek(kTracks, tracksOffset_);
+  if (!cues_.empty()) {
+    addSeek(kCues, cuesOffset);
+  }
+  EbmlBuffer seekHead;
+  seekHead.master(kSeekHead, seeks);
+  seekHead.voidElement(kSeekHeadReserve - seekHead.bytes.size());
+  sink_.patch(seekHeadOffset_, seekHead.bytes.data(), seekHead.bytes.size());
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Ordered byte output of the muxer. patch() rewrites bytes that were already
+// appended; the muxer only calls it from finish().
+class MkvSink {
+ public:
+  virtual ~MkvSink() = default;
+  virtual void append(const uint8_t *data, size_t size) = 0;
+  virtual uint64_t position() const = 0;
+  virtual bool patch(uint64_t offset, const uint8_t *data, size_t size) = 0;
+};
+
+struct MkvVideoTrack {
+  std::string codecId;      // "V_MJPEG" or "V_UNCOMPRESSED"
+  std::string colourSpace;  // FourCC for V_UNCOMPRESSED ("RGBA"), else empty
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t fps = 0;
+};
+
+// Streaming Matroska muxer for one video track of intra-only frames (every
+// block is a keyframe). Segment and clusters are written with unknown size,
+// so a file cut short by a crash or power loss still plays up to its last
+// complete block; finish() appends cues and patches the segment size,
+// duration and seek head so finished files are seekable.
+class MkvWriter {
+ public:
+  explicit MkvWriter(MkvSink &sink);
+
+  void begin(const MkvVideoTrack &track);
+  // Timestamps in milliseconds from the start of the recording, increasing.
+  void addFrame(int64_t timestampMs, const uint8_t *data, size_t size);
+  void finish(int64_t durationMs);
+
+  uint64_t frames() const { return frames_; }
+
+ private:
+  struct CuePoint {
+    int64_t timestampMs = 0;
+    uint64_t clusterPosition = 0;  // relative to the segment data
+  };
+
+  void startCluster(int64_t timestampMs);
+
+  MkvSink &sink_;
+  uint64_t segmentSizeOffset_ = 0;
+  uint64_t segmentDataOffset_ = 0;
+  uint64_t seekHeadOffset_ = 0;
+  uint64_t infoOffset_ = 0;
+  uint64_t tracksOffset_ = 0;
+  uint64_t durationOffset_ = 0;
+  bool clusterOpen_ = false;
+  int64_t clusterTimestampMs_ = 0;
+  std::vector<CuePoint> cues_;
+  uint64_t frames_ = 0;
+};
+
+}  // namespace broadify::meeting
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "keyer/keyer.h"
+#include "state/program_fields.h"
 
 #include <mutex>
 #include <string>
@@ -11,7 +12,7 @@ struct SpeakerLayoutState {
   bool enabled = false;
   std::string layout = "right";
   double scale = 1.0;
-  std::string rawJson = "{\"enabled\":false,\"layout\":\"right\",\"scale\":1}";
+  ProgramFields fields{"{\"enabled\":false,\"layout\":\"right\",\"scale\":1}"};
 };
 
 struct CornerbugState {
@@ -19,7 +20,7 @@ struct CornerbugState {
   double x = 0.84;
   double y = 0.08;
   double size = 0.12;
-  std::string rawJson = "{\"enabled\":false,\"x\":0.84,\"y\":0.08,\"size\":0.12}";
+  ProgramFields fields{"{\"enabled\":false,\"x\":0.84,\"y\":0.08,\"size\":0.12}"};
 };
 
 struct MediaLayerState {
@@ -37,7 +38,7 @@ struct MediaLayerState {
   double rotation = 0.0;
   double rotationX = 0.0;
   double rotationY = 0.0;
-  std::string rawJson = "{\"enabled\":false,\"mode\":\"pip\",\"x\":0.58,\"y\":0.12,\"width\":0.34,\"height\":0.28,\"rotation\":0}";
+  ProgramFields fields{"{\"enabled\":false,\"mode\":\"pip\",\"x\":0.58,\"y\":0.12,\"width\":0.34,\"height\":0.28,\"rotation\":0}"};
 };
 
 struct GraphicsState {
@@ -46,13 +47,29 @@ struct GraphicsState {
   std::string templateName;
   std::string source;
   std::string handoffTarget;
-  std::string rawJson = "{\"enabled\":false}";
+  ProgramFields fields{"{\"enabled\":false}"};
 };
 
+// Program camera flags plus its digital pan/zoom: `zoom` (1..4) and
+// `panX`/`panY` (-1..1 of the travel the zoom leaves) unless `autoFraming`
+// follows the keyed subject instead.
 struct CameraRenderState {
   bool enabled = true;
   bool mirror = true;
-  std::string rawJson = "{\"enabled\":true,\"mirror\":true}";
+  double zoom = 1.0;
+  double panX = 0.0;
+  double panY = 0.0;
+  bool autoFraming = false;
+  ProgramFields fields{
+      "{\"enabled\":true,\"mirror\":true,\"zoom\":1,\"pan_x\":0,\"pan_y\":0,\"auto_framing\":false}"};
+};
+
+// Program output geometry shared by the compositor, preview and FrameBus.
+struct OutputConfig {
+  uint32_t width = 1920;
+  uint32_t height = 1080;
+  uint32_t fps = 30;
+  uint32_t slotCount = 3;
 };
 
 struct MeetingState {
@@ -75,6 +92,10 @@ struct MeetingState {
   bool vcamRawRunning = true;
   int previewClientCount = 0;
   int vcamClientCount = 0;
+  int mosaicClientCount = 0;
+  // In-process frame callbacks registered through the embedding API; they
+  // count as an output consumer like a preview or virtual-camera client.
+  int embedFrameClientCount = 0;
   bool graphicsDirty = true;
   bool programDirty = true;
   std::string pipelineMode = "idle";
@@ -84,8 +105,20 @@ struct MeetingState {
   uint64_t keyerRevision = 1;
   uint64_t renderedFrames = 0;
   uint64_t reusedFrames = 0;
+  // Output tiles of CPU-composited frames, and how many of them were
+  // recomposed instead of carried over from the previous frame.
+  uint64_t composedTiles = 0;
+  uint64_t recomposedTiles = 0;
   uint64_t publishedPreviewFrames = 0;
   uint64_t writtenFramebusFrames = 0;
+  // Live output reconfiguration: output.framebus.configure stores the request
+  // and bumps outputConfigRevision; the pipeline swaps the FrameBus segment at
+  // the next frame boundary and publishes the applied geometry in `output`.
+  OutputConfig output;
+  OutputConfig requestedOutput;
+  uint64_t outputConfigRevision = 0;
+  uint64_t appliedOutputConfigRevision = 0;
+  std::string framebusLastError;
   std::string backgroundMode = "transparent";
   // Absolute file path of an uploaded company background image; empty = none.
   std::string backgroundImagePath;
@@ -104,6 +137,10 @@ struct MeetingState {
   bool edgeStabilizationEnabled = true;
   double edgeStabilizationStrength = 0.35;
   KeyerDegradationSettings degradationSettings;
+  ChromaKeySettings chromaKey;
+  CleanPlateSettings cleanPlate;
+  KeyerProfileRequest keyerProfileRequest;
+  KeyerProfileReport keyerProfile;
   std::string degradationStage = "fresh";
   bool staleMaskActive = false;
   std::string provider;
@@ -117,6 +154,9 @@ struct MeetingState {
   MediaLayerState mediaLayer;
   GraphicsState graphics;
   CameraRenderState cameraRender;
+  // Clock for ProgramFields revisions: every program.update that changes a
+  // member stamps it with the next value.
+  uint64_t programFieldRevision = 0;
 };
 
 }  // namespace broadify::meeting
@@ -0,0 +1,127 @@
+#include "state/program_fields.h"
+
+#include "util/json_utils.h"
+
+#include <algorithm>
+
+namespace broadify::meeting {
+namespace {
+
+const std::string kEmpty;
+
+}  // namespace
+
+ProgramFields::ProgramFields(const std::string &json) {
+  Members members;
+  if (splitObjectMembers(json, members)) {
+    replace(members, 0u);
+  }
+}
+
+const ProgramFields::Field *ProgramFields::find(const std::string &key) const {
+  for (const Field &field : fields_) {
+    if (field.key == key) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
+
+bool ProgramFields::set(const std::string &key, const std::string *value, uint64_t revision) {
+  auto it = std::find_if(fields_.begin(), fields_.end(),
+                         [&key](const Field &field) { return field.key == key; });
+  if (it == fields_.end()) {
+    if (value == nullptr) {
+      return false;
+    }
+    fields_.push_back(Field{key, std::make_shared<const std::string>(*value), revision});
+    revision_ = std::max(revision_, revision);
+    return true;
+  }
+  if (value == nullptr) {
+    if (!it->value) {
+      return false;
+    }
+    it->value.reset();
+  } else {
+    // Comparing first keeps an unchanged blob (re-sent by a full update)
+    // at its old revision, so nothing keyed on it is invalidated.
+    if (it->value && *it->value == *value) {
+      return false;
+    }
+    it->value = std::make_shared<const std::string>(*value);
+  }
+  it->revision = revision;
+  revision_ = std::max(revision_, revision);
+  return true;
+}
+
+std::vector<std::string> ProgramFields::replace(const Members &members, uint64_t revision) {
+  std::vector<std::string> changed;
+  for (const Field &field : fields_) {
+    if (!field.value) {
+      continue;
+    }
+    const bool kept = std::any_of(members.begin(), members.end(),
+                                  [&field](const auto &member) { return member.first == field.key; });
+    if (!kept) {
+      changed.push_back(field.key);
+    }
+  }
+  for (const std::string &key : changed) {
+    set(key, nullptr, revision);
+  }
+  for (const auto &member : members) {
+    if (set(member.first, member.second == "null" ? nullptr : &member.second, revision)) {
+      changed.push_back(member.first);
+    }
+  }
+  return changed;
+}
+
+std::vector<std::string> ProgramFields::patch(const Members &members, uint64_t revision) {
+  std::vector<std::string> changed;
+  for (const auto &member : members) {
+    if (set(member.first, member.second == "null" ? nullptr : &member.second, revision)) {
+      changed.push_back(member.first);
+    }
+  }
+  return changed;
+}
+
+bool ProgramFields::has(const std::string &key) const {
+  const Field *field = find(key);
+  return field != nullptr && field->value != nullptr;
+}
+
+const std::string &ProgramFields::raw(const std::string &key) const {
+  const Field *field = find(key);
+  return field != nullptr && field->value ? *field->value : kEmpty;
+}
+
+uint64_t ProgramFields::revision(const std::string &key) const {
+  const Field *field = find(key);
+  return field != nullptr ? field->revision : 0u;
+}
+
+std::string ProgramFields::toJson() const {
+  std::string out = "{";
+  bool first = true;
+  for (const Field &field : fields_) {
+    if (!field.value) {
+      continue;
+    }
+    if (!first) {
+      out += ",";
+    }
+    first = false;
+    out += "\"";
+    out += field.key;
+    out += "\":";
+    out += *field.value;
+  }
+  out += "}";
+  return out;
+}
+
+}  // namespace broadify::meeting
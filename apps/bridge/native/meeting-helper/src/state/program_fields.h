@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace broadify::meeting {
+
+// The top-level members of one program section as last sent by the UI, each
+// with the revision at which its value last changed. Values are kept as raw
+// JSON text behind shared pointers, so the per-frame compositor snapshot
+// shares large blobs (embedded images) instead of copying them, and a cache
+// keyed on one member survives edits of its neighbours.
+class ProgramFields {
+ public:
+  using Members = std::vector<std::pair<std::string, std::string>>;
+
+  ProgramFields() = default;
+  // Seeds the section from a JSON object at revision 0.
+  explicit ProgramFields(const std::string &json);
+
+  // Replaces the whole section: members absent from `members` are removed.
+  // Returns the keys whose value changed (added, modified or removed).
+  std::vector<std::string> replace(const Members &members, uint64_t revision);
+  // Applies `members` on top of the stored ones; a JSON null removes the
+  // member. Returns the keys whose value changed.
+  std::vector<std::string> patch(const Members &members, uint64_t revision);
+
+  bool has(const std::string &key) const;
+  // Raw JSON text of a member, or an empty string when absent.
+  const std::string &raw(const std::string &key) const;
+  // Revision of the last change to `key` (0 = never changed).
+  uint64_t revision(const std::string &key) const;
+  // Highest revision of any member: changes whenever the section does.
+  uint64_t revision() const { return revision_; }
+
+  std::string toJson() const;
+
+ private:
+  struct Field {
+    std::string key;
+    std::shared_ptr<const std::string> value;  // null once removed
+    uint64_t revision = 0;
+  };
+
+  const Field *find(const std::string &key) const;
+  bool set(const std::string &key, const std::string *value, uint64_t revision);
+
+  std::vector<Field> fields_;
+  uint64_t revision_ = 0;
+};
+
+}  // namespace broadify::meeting
@@ -0,0 +1,291 @@
+#include "state/program_update.h"
+
+#include "compose/camera_framing.h"
+#include "util/json_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+
+namespace broadify::meeting {
+namespace {
+
+ProgramFields *programSectionFields(MeetingState &state, const std::string &section) {
+  if (section == "speaker_layout") {
+    return &state.speakerLayout.fields;
+  }
+  if (section == "cornerbug") {
+    return &state.cornerbug.fields;
+  }
+  if (section == "media_layer") {
+    return &state.mediaLayer.fields;
+  }
+  if (section == "graphics") {
+    return &state.graphics.fields;
+  }
+  if (section == "camera") {
+    return &state.cameraRender.fields;
+  }
+  return nullptr;
+}
+
+// Mirrors one changed member into the typed section state the compositor
+// reads. `raw` is null when the member was removed; strings then reset while
+// numbers and flags keep their last value, as with a full section update.
+void applyProgramMember(MeetingState &state, const std::string &section,
+                        const std::string &key, const std::string *raw) {
+  const std::string empty;
+  const std::string &value = raw != nullptr ? *raw : empty;
+  if (section == "speaker_layout") {
+    SpeakerLayoutState &layout = state.speakerLayout;
+    if (key == "enabled") {
+      layout.enabled = parseBoolValue(value, layout.enabled);
+    } else if (key == "camera_enabled") {
+      state.cameraRender.enabled = parseBoolValue(value, state.cameraRender.enabled);
+    } else if (key == "layout") {
+      const std::string name = parseStringValue(value);
+      if (!name.empty()) {
+        layout.layout = name;
+      }
+    } else if (key == "scale") {
+      layout.scale = parseDoubleValue(value, layout.scale);
+    }
+    return;
+  }
+  if (section == "cornerbug") {
+    CornerbugState &cornerbug = state.cornerbug;
+    if (key == "enabled") {
+      cornerbug.enabled = parseBoolValue(value, cornerbug.enabled);
+    } else if (key == "x") {
+      cornerbug.x = parseDoubleValue(value, cornerbug.x);
+    } else if (key == "y") {
+      cornerbug.y = parseDoubleValue(value, cornerbug.y);
+    } else if (key == "size") {
+      cornerbug.size = parseDoubleValue(value, cornerbug.size);
+    }
+    return;
+  }
+  if (section == "media_layer") {
+    MediaLayerState &media = state.mediaLayer;
+    if (key == "enabled") {
+      media.enabled = parseBoolValue(value, media.enabled);
+    } else if (key == "mode") {
+      const std::string mode = parseStringValue(value);
+      if (!mode.empty()) {
+        media.mode = mode;
+      }
+    } else if (key == "asset_id") {
+      media.assetId = parseStringValue(value);
+    } else if (key == "rendered_page_path") {
+      media.renderedPagePath = parseStringValue(value);
+    } else if (key == "render_status") {
+      media.renderStatus = parseStringValue(value);
+    } else if (key == "page") {
+      media.page = parseIntValue(value, media.page);
+    } else if (key == "page_count") {
+      media.pageCount = parseIntValue(value, media.pageCount);
+    } else if (key == "x") {
+      media.x = parseDoubleValue(value, media.x);
+    } else if (key == "y") {
+      media.y = parseDoubleValue(value, media.y);
+    } else if (key == "width") {
+      media.width = parseDoubleValue(value, media.width);
+    } else if (key == "height") {
+      media.height = parseDoubleValue(value, media.height);
+    } else if (key == "rotation") {
+      media.rotation = parseDoubleValue(value, media.rotation);
+    } else if (key == "rotationX") {
+      media.rotationX = parseDoubleValue(value, media.rotationX);
+    } else if (key == "rotationY") {
+      media.rotationY = parseDoubleValue(value, media.rotationY);
+    }
+    return;
+  }
+  if (section == "graphics") {
+    GraphicsState &graphics = state.graphics;
+    if (key == "enabled") {
+      graphics.enabled = parseBoolValue(value, graphics.enabled);
+    } else if (key == "graphic_id") {
+      graphics.graphicId = parseStringValue(value);
+    } else if (key == "template") {
+      graphics.templateName = parseStringValue(value);
+    } else if (key == "source") {
+      graphics.source = parseStringValue(value);
+    } else if (key == "handoff_target") {
+      graphics.handoffTarget = parseStringValue(value);
+    }
+    return;
+  }
+  if (section == "camera") {
+    if (key == "enabled") {
+      state.cameraRender.enabled = parseBoolValue(value, state.cameraRender.enabled);
+    } else if (key == "mirror") {
+      state.cameraRender.mirror = parseBoolValue(value, state.cameraRender.mirror);
+    } else if (key == "zoom") {
+      const double zoom = parseDoubleValue(value, state.cameraRender.zoom);
+      state.cameraRender.zoom = std::isfinite(zoom) ? std::clamp(zoom, 1.0, kMaxCameraZoom) : 1.0;
+    } else if (key == "pan_x") {
+      const double pan = parseDoubleValue(value, state.cameraRender.panX);
+      state.cameraRender.panX = std::isfinite(pan) ? std::clamp(pan, -1.0, 1.0) : 0.0;
+    } else if (key == "pan_y") {
+      const double pan = parseDoubleValue(value, state.cameraRender.panY);
+      state.cameraRender.panY = std::isfinite(pan) ? std::clamp(pan, -1.0, 1.0) : 0.0;
+    } else if (key == "auto_framing") {
+      state.cameraRender.autoFraming = parseBoolValue(value, state.cameraRender.autoFraming);
+    }
+  }
+}
+
+bool isCameraSectionMember(const std::string &key) {
+  return key == "enabled" || key == "mirror" || key == "zoom" || key == "pan_x" || key == "pan_y" ||
+      key == "auto_framing";
+}
+
+// The camera section in canonical form: every member, clamped.
+std::string cameraSectionJson(const CameraRenderState &camera) {
+  std::ostringstream out;
+  out << "{\"enabled\":" << (camera.enabled ? "true" : "false") << ",\"mirror\":" << (camera.mirror ? "true" : "false")
+      << ",\"zoom\":" << camera.zoom << ",\"pan_x\":" << camera.panX << ",\"pan_y\":" << camera.panY
+      << ",\"auto_framing\":" << (camera.autoFraming ? "true" : "false") << "}";
+  return out.str();
+}
+
+// Applies a program.update to one section. A full update (`values`) replaces
+// the section; a patch only touches the members it names. Either way only the
+// members whose value actually changed are re-parsed and re-stamped (with
+// `revision`), so a slider tick never re-reads an embedded image. Returns the
+// changed keys; the caller advances programFieldRevision when any changed.
+std::vector<std::string> updateProgramSection(MeetingState &state, const std::string &section,
+                                              const ProgramFields::Members &members, bool patch,
+                                              uint64_t revision) {
+  ProgramFields *fields = programSectionFields(state, section);
+  if (fields == nullptr) {
+    return {};
+  }
+  ProgramFields::Members accepted;
+  if (section == "camera") {
+    // The camera section only carries the render flags and the framing.
+    for (const auto &member : members) {
+      if (isCameraSectionMember(member.first)) {
+        accepted.push_back(member);
+      }
+    }
+  }
+  const ProgramFields::Members &applied = section == "camera" ? accepted : members;
+  std::vector<std::string> changed = patch
+      ? fields->patch(applied, revision)
+      : fields->replace(applied, revision);
+  for (const std::string &key : changed) {
+    applyProgramMember(state, section, key, fields->has(key) ? &fields->raw(key) : nullptr);
+  }
+  if (section == "speaker_layout" && fields->has("camera_enabled") &&
+      std::find(changed.begin(), changed.end(), "camera_enabled") == changed.end() &&
+      std::any_of(applied.begin(), applied.end(),
+                  [](const auto &member) { return member.first == "camera_enabled"; })) {
+    // The camera flag is shared with the camera section, so an explicit
+    // camera_enabled is applied again even when this section already held
+    // that value: it wins over a camera.enabled set in between.
+    const bool cameraEnabled = state.cameraRender.enabled;
+    applyProgramMember(state, section, "camera_enabled", &fields->raw("camera_enabled"));
+    if (state.cameraRender.enabled != cameraEnabled) {
+      changed.push_back("camera_enabled");
+    }
+  }
+  if (section == "speaker_layout" && std::find(changed.begin(), changed.end(), "camera_enabled") != changed.end()) {
+    // Keep program.get's camera section in step with the shared flag.
+    ProgramFields::Members flags;
+    splitObjectMembers(cameraSectionJson(state.cameraRender), flags);
+    state.cameraRender.fields.replace(flags, revision);
+  }
+  if (section == "camera") {
+    // Keep program.get reporting every member in its canonical form.
+    ProgramFields::Members flags;
+    splitObjectMembers(cameraSectionJson(state.cameraRender), flags);
+    fields->replace(flags, changed.empty() ? state.programFieldRevision : revision);
+  }
+  return changed;
+}
+
+}  // namespace
+
+bool isProgramSection(const std::string &section) {
+  return section == "speaker_layout" || section == "cornerbug" || section == "media_layer" || section == "graphics" || section == "camera";
+}
+
+std::string programSectionJson(MeetingState &state, const std::string &section) {
+  const ProgramFields *fields = programSectionFields(state, section);
+  return fields != nullptr ? fields->toJson() : "{\"enabled\":false}";
+}
+
+bool isSupportedKeyerModel(const std::string &model) {
+  return model == "modnet" || model == "vision_person_segmentation" || model == "chroma_key" ||
+      model == "clean_plate";
+}
+
+bool isSupportedBackgroundMode(const std::string &mode) {
+  return mode == "transparent" || mode == "gradient" || mode == "solid_light" || mode == "checkerboard";
+}
+
+void markProgramDirty(MeetingState &state, bool graphicsDirty) {
+  state.programDirty = true;
+  state.graphicsDirty = state.graphicsDirty || graphicsDirty;
+  ++state.programRevision;
+}
+
+void markKeyerReconfigured(MeetingState &state) {
+  state.activeKeyer = "passthrough";
+  state.fallbackActive = true;
+  state.fallbackReason = state.keyerEnabled ? state.requestedKeyerModel + "_pending" : "keyer_disabled";
+  state.keyerBackend = "passthrough";
+  state.degradationStage = "fresh";
+  state.staleMaskActive = false;
+  state.keyerPipelineMode = state.keyerEnabled ? "async_live_snap" : "passthrough";
+  state.provider.clear();
+  state.modelPath.clear();
+  state.modelHashOk = false;
+  state.inferenceMs = -1.0;
+  state.keyerMetrics = KeyerMetrics{};
+  ++state.keyerRevision;
+  markProgramDirty(state);
+}
+
+std::string parseProgramSectionUpdate(const std::string &body, ProgramSectionUpdate &update) {
+  update.section = extractStringField(body, "section");
+  if (!isProgramSection(update.section)) {
+    return "Unknown program section: " + update.section;
+  }
+  const std::string patch = extractObjectField(body, "patch");
+  const std::string values = patch.empty() ? extractObjectField(body, "values") : patch;
+  update.patch = !patch.empty();
+  update.members.clear();
+  if (!values.empty() && !splitObjectMembers(values, update.members)) {
+    return "program.update values must be a JSON object.";
+  }
+  if (values.empty() && patch.empty()) {
+    // Historical behaviour: a missing values object disables the section.
+    update.members.emplace_back("enabled", "false");
+  }
+  return {};
+}
+
+uint64_t applyProgramUpdates(MeetingState &state, std::vector<ProgramSectionUpdate> &updates) {
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const uint64_t revision = state.programFieldRevision + 1u;
+  bool anyChanged = false;
+  bool graphicsChanged = false;
+  for (ProgramSectionUpdate &update : updates) {
+    update.changed = updateProgramSection(state, update.section, update.members, update.patch, revision);
+    if (!update.changed.empty()) {
+      anyChanged = true;
+      graphicsChanged = graphicsChanged || update.section == "graphics";
+    }
+  }
+  if (anyChanged) {
+    state.programFieldRevision = revision;
+    markProgramDirty(state, graphicsChanged);
+  }
+  return state.programFieldRevision;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "state/meeting_state.h"
+#include "state/program_fields.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Program and keyer state transitions shared by the control server and the
+// embedding API, so both front ends mutate MeetingState identically. Unless
+// noted, the caller holds state.mutex.
+
+bool isProgramSection(const std::string &section);
+// The section as program.get reports it.
+std::string programSectionJson(MeetingState &state, const std::string &section);
+
+bool isSupportedKeyerModel(const std::string &model);
+// The generated backgrounds the compositor draws.
+bool isSupportedBackgroundMode(const std::string &mode);
+
+void markProgramDirty(MeetingState &state, bool graphicsDirty = false);
+
+// Drops the active keyer status after a configuration change: the pipeline
+// restarts the keyer from passthrough with the new settings on its next
+// frame.
+void markKeyerReconfigured(MeetingState &state);
+
+// One entry of program.update or program.update_batch, validated before
+// anything is applied.
+struct ProgramSectionUpdate {
+  std::string section;
+  ProgramFields::Members members;
+  bool patch = false;
+  std::vector<std::string> changed;
+};
+
+// Parses {"section":..., "values"|"patch":{...}}. Returns an error message,
+// empty on success.
+std::string parseProgramSectionUpdate(const std::string &body, ProgramSectionUpdate &update);
+
+// Applies all updates under one lock acquisition with a single field
+// revision, then marks the program dirty once. The frame pipeline snapshots
+// program state under the same mutex at each frame boundary, so it renders
+// either none or all of the updates, never an intermediate state. Takes
+// state.mutex itself; returns the resulting field revision.
+uint64_t applyProgramUpdates(MeetingState &state, std::vector<ProgramSectionUpdate> &updates);
+
+}  // namespace broadify::meeting
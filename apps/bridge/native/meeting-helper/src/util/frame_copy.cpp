@@ -0,0 +1,94 @@
+#include "util/frame_copy.h"
+
+#include "util/simd.h"
+#include "util/worker_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(BROADIFY_SIMD_NEON) && defined(__clang__)
+// GCC has no portable non-temporal store for NEON; clang lowers this builtin
+// to STNP.
+#define BROADIFY_COPY_NEON 1
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+// Bands of a parallel copy start on cache-line boundaries so no line is
+// written from two cores.
+constexpr size_t kCacheLine = 64;
+
+bool streamingCopyEnabled() {
+  static const bool enabled = [] {
+    const char *value = std::getenv("BROADIFY_MEETING_STREAMING_COPY");
+    return value == nullptr || std::strcmp(value, "0") != 0;
+  }();
+  return enabled;
+}
+
+// Copies with non-temporal stores and fences them, so the bytes are visible
+// to whoever takes the frame over once this returns.
+void streamCopy(uint8_t *dst, const uint8_t *src, size_t size) {
+#if defined(BROADIFY_SIMD_SSE2)
+  const size_t head = std::min(size, (16u - (reinterpret_cast<uintptr_t>(dst) & 15u)) & 15u);
+  std::memcpy(dst, src, head);
+  size_t offset = head;
+  for (; offset + 64u <= size; offset += 64u) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset + 16u));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset + 32u));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset + 48u));
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst + offset), a);
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst + offset + 16u), b);
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst + offset + 32u), c);
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst + offset + 48u), d);
+  }
+  for (; offset + 16u <= size; offset += 16u) {
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst + offset),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset)));
+  }
+  std::memcpy(dst + offset, src + offset, size - offset);
+  _mm_sfence();
+#elif defined(BROADIFY_COPY_NEON)
+  const size_t head = std::min(size, (16u - (reinterpret_cast<uintptr_t>(dst) & 15u)) & 15u);
+  std::memcpy(dst, src, head);
+  size_t offset = head;
+  for (; offset + 16u <= size; offset += 16u) {
+    __builtin_nontemporal_store(vld1q_u8(src + offset), reinterpret_cast<uint8x16_t *>(dst + offset));
+  }
+  std::memcpy(dst + offset, src + offset, size - offset);
+  __asm__ __volatile__("dmb ishst" ::: "memory");
+#else
+  std::memcpy(dst, src, size);
+#endif
+}
+
+}  // namespace
+
+void copyFrameBytes(uint8_t *dst, const uint8_t *src, size_t size, FrameCopyTarget target) {
+  const size_t streamingMin =
+      target == FrameCopyTarget::Handoff ? kStreamingCopyMinBytes : kLocalStreamingCopyMinBytes;
+  if (size < streamingMin || !streamingCopyEnabled()) {
+    std::memcpy(dst, src, size);
+    return;
+  }
+  WorkerPool &pool = sharedWorkerPool();
+  if (size < kParallelCopyMinBytes || pool.workerCount() == 0u) {
+    streamCopy(dst, src, size);
+    return;
+  }
+  // One band per worker plus the calling thread, which takes part in
+  // parallelFor. A single core rarely saturates the memory bus with
+  // streaming stores; a few do.
+  const uint32_t bands = static_cast<uint32_t>(pool.workerCount()) + 1u;
+  const size_t bandBytes = ((size / bands) + kCacheLine - 1u) & ~(kCacheLine - 1u);
+  pool.parallelFor(bands, [&](uint32_t band) {
+    const size_t begin = std::min(size, band * bandBytes);
+    const size_t end = band + 1u == bands ? size : std::min(size, begin + bandBytes);
+    streamCopy(dst + begin, src + begin, end - begin);
+  });
+}
+
+}  // namespace broadify::meeting
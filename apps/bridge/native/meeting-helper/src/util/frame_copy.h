@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace broadify::meeting {
+
+// Where the destination of a frame copy is read next.
+enum class FrameCopyTarget {
+  // Read again shortly by the calling thread (a re-published FrameBus slot
+  // the recorder and the next heartbeat read): the copy should leave it in
+  // cache.
+  Local,
+  // Handed to another thread or process (a FrameBus slot, the preview
+  // store): nothing on this core reads it again.
+  Handoff,
+};
+
+// Copies up to this size always go through memcpy.
+constexpr size_t kStreamingCopyMinBytes = 256u * 1024u;
+// Local copies this large (beyond a 1080p RGBA frame) would not fit the
+// last-level cache next to the compute working set either, so they stream too.
+constexpr size_t kLocalStreamingCopyMinBytes = 12u * 1024u * 1024u;
+// Streaming copies this large (a 4K RGBA frame) are split across the shared
+// worker pool.
+constexpr size_t kParallelCopyMinBytes = 16u * 1024u * 1024u;
+
+// Copies a frame-sized block, choosing the method from size and target. A
+// large Handoff copy (or a Local one too large to stay cached anyway) uses
+// non-temporal stores, so the frame goes to memory without evicting the
+// keyer's and compositor's working set, and at kParallelCopyMinBytes it is
+// split into bands across sharedWorkerPool(). Everything else is a memcpy.
+// Set BROADIFY_MEETING_STREAMING_COPY=0 to use memcpy for every copy.
+void copyFrameBytes(uint8_t *dst, const uint8_t *src, size_t size, FrameCopyTarget target);
+
+}  // namespace broadify::meeting
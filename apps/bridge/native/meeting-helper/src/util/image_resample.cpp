@@ -0,0 +1,464 @@
+#include "util/image_resample.h"
+
+#include "util/simd.h"
+#include "util/worker_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace broadify::meeting {
+namespace {
+
+// Weights are Q14 so a tap pair fits _mm_madd_epi16 (255 * 16384 * 2 < 2^31)
+// even for Lanczos lobes.
+constexpr int kWeightBits = 14;
+constexpr int32_t kWeightOne = 1 << kWeightBits;
+constexpr int32_t kWeightRound = 1 << (kWeightBits - 1);
+// Outputs smaller than this are not worth waking workers for.
+constexpr uint64_t kBandedMinPixels = 256u * 256u;
+constexpr uint32_t kMinBandRows = 32;
+
+constexpr double kPi = 3.14159265358979323846;
+
+double sinc(double x) {
+  if (x == 0.0) {
+    return 1.0;
+  }
+  x *= kPi;
+  return std::sin(x) / x;
+}
+
+double filterSupport(ResampleFilter filter) {
+  switch (filter) {
+    case ResampleFilter::kArea:
+      return 0.5;
+    case ResampleFilter::kBicubic:
+      return 2.0;
+    case ResampleFilter::kLanczos3:
+      return 3.0;
+    default:
+      return 1.0;
+  }
+}
+
+double filterWeight(ResampleFilter filter, double x) {
+  x = std::abs(x);
+  switch (filter) {
+    case ResampleFilter::kArea:
+      return x < 0.5 ? 1.0 : (x == 0.5 ? 0.5 : 0.0);
+    case ResampleFilter::kBicubic: {
+      constexpr double a = -0.5;
+      if (x < 1.0) {
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+      }
+      return x < 2.0 ? (((x - 5.0) * x + 8.0) * x - 4.0) * a : 0.0;
+    }
+    case ResampleFilter::kLanczos3:
+      return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+    default:
+      return x < 1.0 ? 1.0 - x : 0.0;
+  }
+}
+
+// One axis of a plan: output i reads source samples start[i] ..
+// start[i] + count[i] - 1 with Q14 weights weights[i * taps + k].
+struct AxisTable {
+  uint32_t taps = 0;
+  std::vector<int32_t> start;
+  std::vector<int32_t> count;
+  std::vector<int16_t> weights;
+  // Scale exactly 1 at an integer offset: output i is source i + shift.
+  bool identity = false;
+  int32_t shift = 0;
+  // Source samples any output touches: [spanBegin, spanEnd).
+  int32_t spanBegin = 0;
+  int32_t spanEnd = 0;
+};
+
+AxisTable buildAxisTaps(uint32_t srcSize, double regionStart, double regionSize,
+                        uint32_t dstSize, ResampleFilter filter) {
+  AxisTable axis;
+  axis.start.resize(dstSize);
+  axis.count.resize(dstSize);
+  const double scale = regionSize / dstSize;
+  const double whole = std::floor(regionStart);
+  if (scale == 1.0 && regionStart == whole && whole >= 0.0 && whole + dstSize <= srcSize) {
+    axis.identity = true;
+    axis.shift = static_cast<int32_t>(whole);
+  }
+
+  if (filter == ResampleFilter::kNearest) {
+    axis.taps = 1;
+    axis.weights.assign(dstSize, static_cast<int16_t>(kWeightOne));
+    for (uint32_t i = 0; i < dstSize; ++i) {
+      const double center = regionStart + (i + 0.5) * scale;
+      axis.start[i] = std::clamp(static_cast<int32_t>(std::floor(center)), 0, static_cast<int32_t>(srcSize) - 1);
+      axis.count[i] = 1;
+    }
+    return axis;
+  }
+
+  if (filter == ResampleFilter::kArea && scale < 1.0) {
+    filter = ResampleFilter::kBilinear;
+  }
+  const double filterScale = std::max(scale, 1.0);
+  const double support = filterSupport(filter) * filterScale;
+  axis.taps = static_cast<uint32_t>(std::ceil(support)) * 2u + 1u;
+  axis.weights.assign(static_cast<size_t>(dstSize) * axis.taps, 0);
+  std::vector<double> weights(axis.taps);
+  for (uint32_t i = 0; i < dstSize; ++i) {
+    const double center = regionStart + (i + 0.5) * scale;
+    const int32_t first = std::max(0, static_cast<int32_t>(std::floor(center - support + 0.5)));
+    const int32_t last = std::min(static_cast<int32_t>(srcSize), static_cast<int32_t>(std::floor(center + support + 0.5)));
+    int32_t count = std::min<int32_t>(std::max(0, last - first), static_cast<int32_t>(axis.taps));
+    double total = 0.0;
+    for (int32_t k = 0; k < count; ++k) {
+      weights[k] = filterWeight(filter, (first + k - center + 0.5) / filterScale);
+      total += weights[k];
+    }
+    int16_t *fixed = axis.weights.data() + static_cast<size_t>(i) * axis.taps;
+    if (count == 0 || total == 0.0) {
+      // Footprint fell outside the source: replicate the nearest edge.
+      axis.start[i] = std::clamp(static_cast<int32_t>(std::floor(center)), 0, static_cast<int32_t>(srcSize) - 1);
+      axis.count[i] = 1;
+      fixed[0] = static_cast<int16_t>(kWeightOne);
+      continue;
+    }
+    // Round to Q14 and put the residue on the largest tap so flat areas
+    // come out exactly unchanged.
+    int32_t fixedTotal = 0;
+    int32_t largest = 0;
+    for (int32_t k = 0; k < count; ++k) {
+      fixed[k] = static_cast<int16_t>(std::lround(weights[k] / total * kWeightOne));
+      fixedTotal += fixed[k];
+      if (std::abs(fixed[k]) > std::abs(fixed[largest])) {
+        largest = k;
+      }
+    }
+    fixed[largest] = static_cast<int16_t>(fixed[largest] + kWeightOne - fixedTotal);
+    axis.start[i] = first;
+    axis.count[i] = count;
+  }
+  return axis;
+}
+
+AxisTable buildAxis(uint32_t srcSize, double regionStart, double regionSize,
+                    uint32_t dstSize, ResampleFilter filter) {
+  AxisTable axis = buildAxisTaps(srcSize, regionStart, regionSize, dstSize, filter);
+  axis.spanBegin = static_cast<int32_t>(srcSize);
+  for (uint32_t i = 0; i < dstSize; ++i) {
+    axis.spanBegin = std::min(axis.spanBegin, axis.start[i]);
+    axis.spanEnd = std::max(axis.spanEnd, axis.start[i] + axis.count[i]);
+  }
+  return axis;
+}
+
+struct PlanKey {
+  uint32_t srcWidth = 0;
+  uint32_t srcHeight = 0;
+  uint32_t dstWidth = 0;
+  uint32_t dstHeight = 0;
+  ResampleRegion region;
+  ResampleFilter filter = ResampleFilter::kBilinear;
+
+  bool operator==(const PlanKey &other) const {
+    return srcWidth == other.srcWidth && srcHeight == other.srcHeight &&
+           dstWidth == other.dstWidth && dstHeight == other.dstHeight &&
+           region.x == other.region.x && region.y == other.region.y &&
+           region.width == other.region.width && region.height == other.region.height &&
+           filter == other.filter;
+  }
+};
+
+struct ResamplePlan {
+  PlanKey key;
+  AxisTable horizontal;
+  AxisTable vertical;
+};
+
+// The same few geometries repeat every frame per call site; a small
+// per-thread cache makes table construction a one-off.
+std::shared_ptr<const ResamplePlan> planFor(const PlanKey &key) {
+  thread_local std::array<std::shared_ptr<const ResamplePlan>, 6> cache;
+  thread_local size_t nextSlot = 0;
+  for (const auto &plan : cache) {
+    if (plan && plan->key == key) {
+      return plan;
+    }
+  }
+  auto plan = std::make_shared<ResamplePlan>();
+  plan->key = key;
+  plan->horizontal = buildAxis(key.srcWidth, key.region.x, key.region.width, key.dstWidth, key.filter);
+  plan->vertical = buildAxis(key.srcHeight, key.region.y, key.region.height, key.dstHeight, key.filter);
+  cache[nextSlot] = plan;
+  nextSlot = (nextSlot + 1u) % cache.size();
+  return plan;
+}
+
+// Two Q14 weights as the (low, high) int16 lanes of one madd operand.
+inline int32_t weightPairBits(int16_t low, int16_t high) {
+  return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint16_t>(low)) |
+                              (static_cast<uint32_t>(static_cast<uint16_t>(high)) << 16));
+}
+
+inline uint8_t clampQ14(int32_t accumulator) {
+  return static_cast<uint8_t>(std::clamp(accumulator >> kWeightBits, 0, 255));
+}
+
+// Horizontal pass over one row into `out` (dstWidth * channels bytes).
+void resampleRow(const uint8_t *in, uint8_t *out, const AxisTable &axis,
+                 uint32_t dstWidth, uint32_t channels) {
+  if (axis.identity) {
+    std::memcpy(out, in + static_cast<size_t>(axis.shift) * channels, static_cast<size_t>(dstWidth) * channels);
+    return;
+  }
+  if (channels == 1u) {
+    for (uint32_t x = 0; x < dstWidth; ++x) {
+      const uint8_t *taps = in + axis.start[x];
+      const int16_t *weights = axis.weights.data() + static_cast<size_t>(x) * axis.taps;
+      int32_t accumulator = kWeightRound;
+      for (int32_t k = 0; k < axis.count[x]; ++k) {
+        accumulator += taps[k] * weights[k];
+      }
+      out[x] = clampQ14(accumulator);
+    }
+    return;
+  }
+  for (uint32_t x = 0; x < dstWidth; ++x) {
+    const uint8_t *taps = in + static_cast<size_t>(axis.start[x]) * 4u;
+    const int16_t *weights = axis.weights.data() + static_cast<size_t>(x) * axis.taps;
+    const int32_t count = axis.count[x];
+#if defined(BROADIFY_SIMD_SSE2)
+    // Two neighbouring pixels per madd: lanes (a_c, b_c) * (w_a, w_b).
+    const __m128i zero = _mm_setzero_si128();
+    __m128i accumulator = _mm_set1_epi32(kWeightRound);
+    int32_t k = 0;
+    for (; k + 1 < count; k += 2) {
+      const __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(taps + k * 4)), zero);
+      const __m128i lanes = _mm_unpacklo_epi16(pair, _mm_srli_si128(pair, 8));
+      const __m128i weightPair = _mm_set1_epi32(weightPairBits(weights[k], weights[k + 1]));
+      accumulator = _mm_add_epi32(accumulator, _mm_madd_epi16(lanes, weightPair));
+    }
+    if (k < count) {
+      int32_t single = 0;
+      std::memcpy(&single, taps + k * 4, 4);
+      const __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(single), zero), zero);
+      accumulator = _mm_add_epi32(accumulator, _mm_madd_epi16(lanes, _mm_set1_epi32(weightPairBits(weights[k], 0))));
+    }
+    const __m128i narrowed = _mm_packs_epi32(_mm_srai_epi32(accumulator, kWeightBits), zero);
+    const int32_t pixel = _mm_cvtsi128_si32(_mm_packus_epi16(narrowed, zero));
+    std::memcpy(out + static_cast<size_t>(x) * 4u, &pixel, 4);
+#elif defined(BROADIFY_SIMD_NEON)
+    int32x4_t accumulator = vdupq_n_s32(kWeightRound);
+    for (int32_t k = 0; k < count; ++k) {
+      uint32_t packed = 0;
+      std::memcpy(&packed, taps + k * 4, 4);
+      const int16x4_t pixel = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)))));
+      accumulator = vmlal_n_s16(accumulator, pixel, weights[k]);
+    }
+    const uint8x8_t narrowed = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(accumulator, kWeightBits)), vdup_n_s16(0)));
+    vst1_lane_u32(reinterpret_cast<uint32_t *>(out + static_cast<size_t>(x) * 4u), vreinterpret_u32_u8(narrowed), 0);
+#else
+    for (uint32_t channel = 0; channel < 4u; ++channel) {
+      int32_t accumulator = kWeightRound;
+      for (int32_t k = 0; k < count; ++k) {
+        accumulator += taps[k * 4 + channel] * weights[k];
+      }
+      out[static_cast<size_t>(x) * 4u + channel] = clampQ14(accumulator);
+    }
+#endif
+  }
+}
+
+// Vertical pass: one output row from `count` input rows. Channel-agnostic,
+// sixteen bytes per step.
+void blendRows(const uint8_t *const *rows, const int16_t *weights, int32_t count,
+               uint8_t *out, size_t bytes) {
+  size_t i = 0;
+#if defined(BROADIFY_SIMD_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16u <= bytes; i += 16u) {
+    __m128i sums[4];
+    for (__m128i &sum : sums) {
+      sum = _mm_set1_epi32(kWeightRound);
+    }
+    for (int32_t k = 0; k < count; k += 2) {
+      const bool paired = k + 1 < count;
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + i));
+      const __m128i b = paired ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + i)) : zero;
+      const __m128i weightPair = _mm_set1_epi32(weightPairBits(weights[k], paired ? weights[k + 1] : 0));
+      // Byte lanes of a and b interleaved as int16 (a_j, b_j) pairs.
+      const __m128i lowHalf = _mm_unpacklo_epi8(a, zero);
+      const __m128i lowHalfB = _mm_unpacklo_epi8(b, zero);
+      const __m128i highHalf = _mm_unpackhi_epi8(a, zero);
+      const __m128i highHalfB = _mm_unpackhi_epi8(b, zero);
+      sums[0] = _mm_add_epi32(sums[0], _mm_madd_epi16(_mm_unpacklo_epi16(lowHalf, lowHalfB), weightPair));
+      sums[1] = _mm_add_epi32(sums[1], _mm_madd_epi16(_mm_unpackhi_epi16(lowHalf, lowHalfB), weightPair));
+      sums[2] = _mm_add_epi32(sums[2], _mm_madd_epi16(_mm_unpacklo_epi16(highHalf, highHalfB), weightPair));
+      sums[3] = _mm_add_epi32(sums[3], _mm_madd_epi16(_mm_unpackhi_epi16(highHalf, highHalfB), weightPair));
+    }
+    const __m128i low = _mm_packs_epi32(_mm_srai_epi32(sums[0], kWeightBits), _mm_srai_epi32(sums[1], kWeightBits));
+    const __m128i high = _mm_packs_epi32(_mm_srai_epi32(sums[2], kWeightBits), _mm_srai_epi32(sums[3], kWeightBits));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+  }
+#elif defined(BROADIFY_SIMD_NEON)
+  for (; i + 8u <= bytes; i += 8u) {
+    int32x4_t low = vdupq_n_s32(kWeightRound);
+    int32x4_t high = low;
+    for (int32_t k = 0; k < count; ++k) {
+      const int16x8_t row = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + i)));
+      low = vmlal_n_s16(low, vget_low_s16(row), weights[k]);
+      high = vmlal_n_s16(high, vget_high_s16(row), weights[k]);
+    }
+    vst1_u8(out + i, vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(low, kWeightBits)),
+                                              vqmovn_s32(vshrq_n_s32(high, kWeightBits)))));
+  }
+#endif
+  for (; i < bytes; ++i) {
+    int32_t accumulator = kWeightRound;
+    for (int32_t k = 0; k < count; ++k) {
+      accumulator += rows[k][i] * weights[k];
+    }
+    out[i] = clampQ14(accumulator);
+  }
+}
+
+void resampleNearestBand(const ConstImagePlane &src, const ImagePlane &dst,
+                         const ResamplePlan &plan, uint32_t rowBegin, uint32_t rowEnd) {
+  const std::vector<int32_t> &columns = plan.horizontal.start;
+  for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+    const uint8_t *in = src.data + static_cast<size_t>(plan.vertical.start[y]) * src.stride;
+    uint8_t *out = dst.data + static_cast<size_t>(y) * dst.stride;
+    if (plan.horizontal.identity) {
+      std::memcpy(out, in + static_cast<size_t>(plan.horizontal.shift) * src.channels,
+                  static_cast<size_t>(dst.width) * dst.channels);
+    } else if (src.channels == 4u) {
+      for (uint32_t x = 0; x < dst.width; ++x) {
+        std::memcpy(out + static_cast<size_t>(x) * 4u, in + static_cast<size_t>(columns[x]) * 4u, 4);
+      }
+    } else {
+      for (uint32_t x = 0; x < dst.width; ++x) {
+        out[x] = in[columns[x]];
+      }
+    }
+  }
+}
+
+void resampleBand(const ConstImagePlane &src, const ImagePlane &dst,
+                  const ResamplePlan &plan, uint32_t rowBegin, uint32_t rowEnd) {
+  const AxisTable &vertical = plan.vertical;
+  const size_t rowBytes = static_cast<size_t>(dst.width) * dst.channels;
+  if (vertical.identity) {
+    for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+      resampleRow(src.data + static_cast<size_t>(y + vertical.shift) * src.stride,
+                  dst.data + static_cast<size_t>(y) * dst.stride, plan.horizontal, dst.width, dst.channels);
+    }
+    return;
+  }
+
+  std::vector<const uint8_t *> rows(vertical.taps);
+  const auto verticalTaps = [&](uint32_t y, const auto &rowPointer) {
+    const int32_t count = vertical.count[y];
+    for (int32_t k = 0; k < count; ++k) {
+      rows[k] = rowPointer(vertical.start[y] + k);
+    }
+    return count;
+  };
+
+  if (!plan.horizontal.identity && plan.key.region.height > dst.height) {
+    // Vertical downscale: blend the source rows first (over the columns the
+    // horizontal taps read) so the costlier horizontal pass runs once per
+    // output row instead of once per source row.
+    const AxisTable &horizontal = plan.horizontal;
+    const size_t spanOffset = static_cast<size_t>(horizontal.spanBegin) * src.channels;
+    const size_t spanBytes = static_cast<size_t>(horizontal.spanEnd - horizontal.spanBegin) * src.channels;
+    thread_local std::vector<uint8_t> blendedRow;
+    blendedRow.resize(static_cast<size_t>(src.width) * src.channels);
+    for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+      const int32_t count = verticalTaps(y, [&](int32_t row) {
+        return src.data + static_cast<size_t>(row) * src.stride + spanOffset;
+      });
+      blendRows(rows.data(), vertical.weights.data() + static_cast<size_t>(y) * vertical.taps, count,
+                blendedRow.data() + spanOffset, spanBytes);
+      resampleRow(blendedRow.data(), dst.data + static_cast<size_t>(y) * dst.stride, horizontal, dst.width, dst.channels);
+    }
+    return;
+  }
+
+  // Otherwise horizontally resample just the source rows this band's taps
+  // touch, then blend those.
+  int32_t firstRow = vertical.start[rowBegin];
+  int32_t endRow = firstRow;
+  for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+    firstRow = std::min(firstRow, vertical.start[y]);
+    endRow = std::max(endRow, vertical.start[y] + vertical.count[y]);
+  }
+  thread_local std::vector<uint8_t> scaledRows;
+  const bool direct = plan.horizontal.identity;
+  if (!direct) {
+    scaledRows.resize(static_cast<size_t>(endRow - firstRow) * rowBytes);
+    for (int32_t row = firstRow; row < endRow; ++row) {
+      resampleRow(src.data + static_cast<size_t>(row) * src.stride,
+                  scaledRows.data() + static_cast<size_t>(row - firstRow) * rowBytes,
+                  plan.horizontal, dst.width, dst.channels);
+    }
+  }
+  for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+    const int32_t count = verticalTaps(y, [&](int32_t row) -> const uint8_t * {
+      return direct ? src.data + static_cast<size_t>(row) * src.stride +
+                          static_cast<size_t>(plan.horizontal.shift) * src.channels
+                    : scaledRows.data() + static_cast<size_t>(row - firstRow) * rowBytes;
+    });
+    blendRows(rows.data(), vertical.weights.data() + static_cast<size_t>(y) * vertical.taps, count,
+              dst.data + static_cast<size_t>(y) * dst.stride, rowBytes);
+  }
+}
+
+}  // namespace
+
+bool resampleImage(const ConstImagePlane &src, const ResampleRegion &region,
+                   const ImagePlane &dst, ResampleFilter filter) {
+  if (src.data == nullptr || dst.data == nullptr || src.width == 0u || src.height == 0u ||
+      dst.width == 0u || dst.height == 0u || src.channels != dst.channels ||
+      (src.channels != 1u && src.channels != 4u)) {
+    return false;
+  }
+  PlanKey key;
+  key.srcWidth = src.width;
+  key.srcHeight = src.height;
+  key.dstWidth = dst.width;
+  key.dstHeight = dst.height;
+  key.filter = filter;
+  key.region = region;
+  if (region.width <= 0.0 || region.height <= 0.0) {
+    key.region = {0.0, 0.0, static_cast<double>(src.width), static_cast<double>(src.height)};
+  }
+  const std::shared_ptr<const ResamplePlan> plan = planFor(key);
+
+  const auto runBand = [&](uint32_t rowBegin, uint32_t rowEnd) {
+    if (filter == ResampleFilter::kNearest) {
+      resampleNearestBand(src, dst, *plan, rowBegin, rowEnd);
+    } else {
+      resampleBand(src, dst, *plan, rowBegin, rowEnd);
+    }
+  };
+  WorkerPool &pool = sharedWorkerPool();
+  const uint32_t bands = static_cast<uint64_t>(dst.width) * dst.height < kBandedMinPixels
+      ? 1u
+      : std::clamp(dst.height / kMinBandRows, 1u, static_cast<uint32_t>(pool.workerCount()) + 1u);
+  if (bands <= 1u) {
+    runBand(0u, dst.height);
+    return true;
+  }
+  pool.parallelFor(bands, [&](uint32_t band) {
+    runBand(static_cast<uint32_t>(static_cast<uint64_t>(dst.height) * band / bands),
+            static_cast<uint32_t>(static_cast<uint64_t>(dst.height) * (band + 1u) / bands));
+  });
+  return true;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace broadify::meeting {
+
+// Shared 8-bit image resampler for every scale operation of the helper
+// (cover-fit layers, PiP insets, keyer tensors, guided-filter grids, fitted
+// images). Separable horizontal and vertical passes (vertical first when
+// shrinking rows, so the wider pass runs on fewer rows), driven by fixed-point filter
+// tables that are computed once per geometry and cached per thread. Inner
+// loops are SSE2/NEON with scalar tails; large outputs are split into row
+// bands on sharedWorkerPool().
+
+enum class ResampleFilter {
+  kNearest,
+  // Triangle filter; widens with the scale factor when downscaling, so it
+  // never skips source pixels.
+  kBilinear,
+  // Box average over each output pixel's footprint (bilinear when upscaling).
+  kArea,
+  // Catmull-Rom (a = -0.5).
+  kBicubic,
+  kLanczos3,
+};
+
+// 1 (grey/alpha) or 4 (RGBA) interleaved channels; `stride` in bytes.
+struct ConstImagePlane {
+  const uint8_t *data = nullptr;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  size_t stride = 0;
+  uint32_t channels = 4;
+};
+
+struct ImagePlane {
+  uint8_t *data = nullptr;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  size_t stride = 0;
+  uint32_t channels = 4;
+};
+
+// Source window in source pixels (edges, not centres); fractional offsets
+// are honoured. A zero-sized region means the whole source.
+struct ResampleRegion {
+  double x = 0.0;
+  double y = 0.0;
+  double width = 0.0;
+  double height = 0.0;
+};
+
+// Scales `region` of `src` onto all of `dst`. Channel counts must match.
+// Returns false (dst untouched) on empty or mismatched planes.
+bool resampleImage(const ConstImagePlane &src, const ResampleRegion &region,
+                   const ImagePlane &dst, ResampleFilter filter);
+
+inline bool resampleImage(const ConstImagePlane &src, const ImagePlane &dst,
+                          ResampleFilter filter) {
+  return resampleImage(src, ResampleRegion{}, dst, filter);
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,179 @@
+#include "util/jpeg_encode.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreGraphics/CoreGraphics.h>
+#include <ImageIO/ImageIO.h>
+#elif BROADIFY_ENABLE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+#if defined(__APPLE__)
+void releaseData(void *, const void *, size_t) {}
+#elif BROADIFY_ENABLE_LIBJPEG
+struct JpegErrorManager {
+  jpeg_error_mgr base;
+  jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info) {
+  longjmp(reinterpret_cast<JpegErrorManager *>(info->err)->jump, 1);
+}
+
+void jpegSilence(j_common_ptr, int) {}
+#endif
+
+}  // namespace
+
+#if defined(__APPLE__)
+bool encodeJpegRgba(const uint8_t *rgba,
+                    uint32_t width,
+                    uint32_t height,
+                    size_t stride,
+                    float quality,
+                    std::vector<uint8_t> &out) {
+  out.clear();
+  if (rgba == nullptr || width == 0u || height == 0u || stride < static_cast<size_t>(width) * 4u) {
+    return false;
+  }
+
+  CGDataProviderRef provider = CGDataProviderCreateWithData(
+      nullptr, rgba, stride * height, releaseData);
+  if (provider == nullptr) {
+    return false;
+  }
+
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGImageRef image = CGImageCreate(
+      width,
+      height,
+      8,
+      32,
+      stride,
+      colorSpace,
+      kCGImageAlphaLast | kCGBitmapByteOrder32Big,
+      provider,
+      nullptr,
+      false,
+      kCGRenderingIntentDefault);
+
+  CFMutableDataRef data = CFDataCreateMutable(kCFAllocatorDefault, 0);
+  CGImageDestinationRef destination = data == nullptr
+      ? nullptr
+      : CGImageDestinationCreateWithData(data, CFSTR("public.jpeg"), 1, nullptr);
+  if (destination != nullptr && image != nullptr) {
+    float qualityValue = std::clamp(quality, 0.0f, 1.0f);
+    CFNumberRef qualityNumber = CFNumberCreate(kCFAllocatorDefault, kCFNumberFloatType, &qualityValue);
+    const void *keys[] = {kCGImageDestinationLossyCompressionQuality};
+    const void *values[] = {qualityNumber};
+    CFDictionaryRef properties = CFDictionaryCreate(
+        kCFAllocatorDefault, keys, values, 1, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    CGImageDestinationAddImage(destination, image, properties);
+    CGImageDestinationFinalize(destination);
+    if (properties != nullptr) {
+      CFRelease(properties);
+    }
+    if (qualityNumber != nullptr) {
+      CFRelease(qualityNumber);
+    }
+  }
+
+  if (data != nullptr) {
+    const UInt8 *bytes = CFDataGetBytePtr(data);
+    const CFIndex length = CFDataGetLength(data);
+    if (bytes != nullptr && length > 0) {
+      out.assign(bytes, bytes + length);
+    }
+  }
+
+  if (destination != nullptr) {
+    CFRelease(destination);
+  }
+  if (data != nullptr) {
+    CFRelease(data);
+  }
+  if (image != nullptr) {
+    CGImageRelease(image);
+  }
+  if (colorSpace != nullptr) {
+    CGColorSpaceRelease(colorSpace);
+  }
+  CGDataProviderRelease(provider);
+  return !out.empty();
+}
+
+bool jpegEncoderAvailable() {
+  return true;
+}
+#elif BROADIFY_ENABLE_LIBJPEG
+bool encodeJpegRgba(const uint8_t *rgba,
+                    uint32_t width,
+                    uint32_t height,
+                    size_t stride,
+                    float quality,
+                    std::vector<uint8_t> &out) {
+  out.clear();
+  if (rgba == nullptr || width == 0u || height == 0u || stride < static_cast<size_t>(width) * 4u) {
+    return false;
+  }
+
+  jpeg_compress_struct encoder;
+  JpegErrorManager errors;
+  // Owned by libjpeg's memory destination; released after every exit path.
+  unsigned char *buffer = nullptr;
+  unsigned long size = 0;
+  encoder.err = jpeg_std_error(&errors.base);
+  errors.base.error_exit = jpegErrorExit;
+  errors.base.emit_message = jpegSilence;
+  if (setjmp(errors.jump)) {
+    jpeg_destroy_compress(&encoder);
+    std::free(buffer);
+    out.clear();
+    return false;
+  }
+  jpeg_create_compress(&encoder);
+  jpeg_mem_dest(&encoder, &buffer, &size);
+  encoder.image_width = width;
+  encoder.image_height = height;
+  encoder.input_components = 4;
+  encoder.in_color_space = JCS_EXT_RGBA;
+  jpeg_set_defaults(&encoder);
+  jpeg_set_quality(&encoder, static_cast<int>(std::clamp(quality, 0.0f, 1.0f) * 100.0f + 0.5f), TRUE);
+  encoder.dct_method = JDCT_IFAST;
+  jpeg_start_compress(&encoder, TRUE);
+  while (encoder.next_scanline < encoder.image_height) {
+    JSAMPROW row = const_cast<uint8_t *>(rgba + static_cast<size_t>(encoder.next_scanline) * stride);
+    jpeg_write_scanlines(&encoder, &row, 1);
+  }
+  jpeg_finish_compress(&encoder);
+  jpeg_destroy_compress(&encoder);
+  if (buffer != nullptr && size > 0u) {
+    out.assign(buffer, buffer + size);
+  }
+  std::free(buffer);
+  return !out.empty();
+}
+
+bool jpegEncoderAvailable() {
+  return true;
+}
+#else
+bool encodeJpegRgba(const uint8_t *, uint32_t, uint32_t, size_t, float, std::vector<uint8_t> &out) {
+  out.clear();
+  return false;
+}
+
+bool jpegEncoderAvailable() {
+  return false;
+}
+#endif
+
+}  // namespace broadify::meeting
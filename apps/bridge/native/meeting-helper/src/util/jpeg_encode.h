@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Baseline JPEG encode of RGBA8 rows `stride` bytes apart (alpha dropped),
+// quality in 0..1. ImageIO on macOS, libjpeg(-turbo) where the build enables
+// BROADIFY_ENABLE_LIBJPEG. Returns false, leaving `out` empty, on failure or
+// when the platform has no encoder.
+bool encodeJpegRgba(const uint8_t *rgba,
+                    uint32_t width,
+                    uint32_t height,
+                    size_t stride,
+                    float quality,
+                    std::vector<uint8_t> &out);
+bool jpegEncoderAvailable();
+
+}  // namespace broadify::meeting
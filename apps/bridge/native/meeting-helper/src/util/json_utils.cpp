@@ -24,6 +24,107 @@ size_t findValueStart(const std::string &body, const std::string &field) {
   return pos;
 }
 
+bool isJsonSpace(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+size_t skipSpace(const std::string &body, size_t pos) {
+  while (pos < body.size() && isJsonSpace(body[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+// Index one past the end of the string literal opening at `pos`, or npos.
+size_t skipString(const std::string &body, size_t pos) {
+  for (size_t i = pos + 1; i < body.size(); ++i) {
+    if (body[i] == '\\') {
+      ++i;
+      continue;
+    }
+    if (body[i] == '"') {
+      return i + 1;
+    }
+  }
+  return std::string::npos;
+}
+
+// Index one past the end of the value starting at `pos`, or npos.
+size_t skipValue(const std::string &body, size_t pos) {
+  if (pos >= body.size()) {
+    return std::string::npos;
+  }
+  if (body[pos] == '"') {
+    return skipString(body, pos);
+  }
+  if (body[pos] == '{' || body[pos] == '[') {
+    int depth = 0;
+    for (size_t i = pos; i < body.size(); ++i) {
+      const char ch = body[i];
+      if (ch == '"') {
+        i = skipString(body, i);
+        if (i == std::string::npos) {
+          return std::string::npos;
+        }
+        --i;
+      } else if (ch == '{' || ch == '[') {
+        ++depth;
+      } else if (ch == '}' || ch == ']') {
+        if (--depth == 0) {
+          return i + 1;
+        }
+      }
+    }
+    return std::string::npos;
+  }
+  size_t end = pos;
+  while (end < body.size() && body[end] != ',' && body[end] != '}' && body[end] != ']' && !isJsonSpace(body[end])) {
+    ++end;
+  }
+  return end == pos ? std::string::npos : end;
+}
+
+// Raw text of the `open`...`close` value of `field`, brackets included.
+std::string extractBracketedField(const std::string &body, const std::string &field, char open, char close) {
+  const size_t start = findValueStart(body, field);
+  if (start == std::string::npos || start >= body.size() || body[start] != open) {
+    return "";
+  }
+
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+  for (size_t pos = start; pos < body.size(); ++pos) {
+    const char ch = body[pos];
+    if (escaped) {
+      escaped = false;
+      continue;
+    }
+    if (ch == '\\') {
+      escaped = inString;
+      continue;
+    }
+    if (ch == '"') {
+      inString = !inString;
+      continue;
+    }
+    if (inString) {
+      continue;
+    }
+    if (ch == open) {
+      ++depth;
+      continue;
+    }
+    if (ch == close) {
+      --depth;
+      if (depth == 0) {
+        return body.substr(start, pos - start + 1);
+      }
+    }
+  }
+  return "";
+}
+
 }  // namespace
 
 uint64_t nowNs() {
@@ -127,43 +228,201 @@ double extractDoubleField(const std::string &body, const std::string &field, dou
 }
 
 std::string extractObjectField(const std::string &body, const std::string &field) {
-  const size_t start = findValueStart(body, field);
-  if (start == std::string::npos || start >= body.size() || body[start] != '{') {
-    return "";
-  }
+  return extractBracketedField(body, field, '{', '}');
+}
 
-  int depth = 0;
-  bool inString = false;
-  bool escaped = false;
-  for (size_t pos = start; pos < body.size(); ++pos) {
-    const char ch = body[pos];
-    if (escaped) {
-      escaped = false;
-      continue;
+std::string extractArrayField(const std::string &body, const std::string &field) {
+  return extractBracketedField(body, field, '[', ']');
+}
+
+bool splitObjectMembers(const std::string &object, std::vector<std::pair<std::string, std::string>> &members) {
+  members.clear();
+  size_t pos = skipSpace(object, 0);
+  if (pos >= object.size() || object[pos] != '{') {
+    return false;
+  }
+  pos = skipSpace(object, pos + 1);
+  if (pos < object.size() && object[pos] == '}') {
+    return skipSpace(object, pos + 1) == object.size();
+  }
+  while (pos < object.size()) {
+    if (object[pos] != '"') {
+      return false;
     }
-    if (ch == '\\') {
-      escaped = inString;
-      continue;
+    const size_t keyEnd = skipString(object, pos);
+    if (keyEnd == std::string::npos) {
+      return false;
     }
-    if (ch == '"') {
-      inString = !inString;
+    std::string key = object.substr(pos + 1, keyEnd - pos - 2);
+    pos = skipSpace(object, keyEnd);
+    if (pos >= object.size() || object[pos] != ':') {
+      return false;
+    }
+    pos = skipSpace(object, pos + 1);
+    const size_t valueEnd = skipValue(object, pos);
+    if (valueEnd == std::string::npos) {
+      return false;
+    }
+    members.emplace_back(std::move(key), object.substr(pos, valueEnd - pos));
+    pos = skipSpace(object, valueEnd);
+    if (pos < object.size() && object[pos] == ',') {
+      pos = skipSpace(object, pos + 1);
       continue;
     }
-    if (inString) {
+    if (pos < object.size() && object[pos] == '}') {
+      return skipSpace(object, pos + 1) == object.size();
+    }
+    return false;
+  }
+  return false;
+}
+
+bool splitArrayElements(const std::string &array, std::vector<std::string> &elements) {
+  elements.clear();
+  size_t pos = skipSpace(array, 0);
+  if (pos >= array.size() || array[pos] != '[') {
+    return false;
+  }
+  pos = skipSpace(array, pos + 1);
+  if (pos < array.size() && array[pos] == ']') {
+    return skipSpace(array, pos + 1) == array.size();
+  }
+  while (pos < array.size()) {
+    const size_t valueEnd = skipValue(array, pos);
+    if (valueEnd == std::string::npos) {
+      return false;
+    }
+    elements.push_back(array.substr(pos, valueEnd - pos));
+    pos = skipSpace(array, valueEnd);
+    if (pos < array.size() && array[pos] == ',') {
+      pos = skipSpace(array, pos + 1);
       continue;
     }
-    if (ch == '{') {
-      ++depth;
+    if (pos < array.size() && array[pos] == ']') {
+      return skipSpace(array, pos + 1) == array.size();
+    }
+    return false;
+  }
+  return false;
+}
+
+bool parseBoolValue(const std::string &raw, bool fallback) {
+  if (raw == "true") {
+    return true;
+  }
+  if (raw == "false") {
+    return false;
+  }
+  return fallback;
+}
+
+int parseIntValue(const std::string &raw, int fallback) {
+  char *end = nullptr;
+  const long parsed = std::strtol(raw.c_str(), &end, 10);
+  return end == raw.c_str() ? fallback : static_cast<int>(parsed);
+}
+
+double parseDoubleValue(const std::string &raw, double fallback) {
+  char *end = nullptr;
+  const double parsed = std::strtod(raw.c_str(), &end);
+  return end == raw.c_str() ? fallback : parsed;
+}
+
+std::string parseStringValue(const std::string &raw) {
+  if (raw.size() < 2u || raw.front() != '"' || raw.back() != '"') {
+    return "";
+  }
+  return raw.substr(1, raw.size() - 2u);
+}
+
+std::string unescapeJsonString(const std::string &value) {
+  const auto hexQuad = [&value](size_t pos, uint32_t &unit) {
+    if (pos + 4u > value.size()) {
+      return false;
+    }
+    unit = 0;
+    for (size_t i = pos; i < pos + 4u; ++i) {
+      const char ch = value[i];
+      unit <<= 4u;
+      if (ch >= '0' && ch <= '9') {
+        unit |= static_cast<uint32_t>(ch - '0');
+      } else if (ch >= 'a' && ch <= 'f') {
+        unit |= static_cast<uint32_t>(ch - 'a' + 10);
+      } else if (ch >= 'A' && ch <= 'F') {
+        unit |= static_cast<uint32_t>(ch - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  };
+  const auto appendUtf8 = [](std::string &out, uint32_t codepoint) {
+    if (codepoint < 0x80u) {
+      out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800u) {
+      out += static_cast<char>(0xc0u | (codepoint >> 6u));
+      out += static_cast<char>(0x80u | (codepoint & 0x3fu));
+    } else if (codepoint < 0x10000u) {
+      out += static_cast<char>(0xe0u | (codepoint >> 12u));
+      out += static_cast<char>(0x80u | ((codepoint >> 6u) & 0x3fu));
+      out += static_cast<char>(0x80u | (codepoint & 0x3fu));
+    } else {
+      out += static_cast<char>(0xf0u | (codepoint >> 18u));
+      out += static_cast<char>(0x80u | ((codepoint >> 12u) & 0x3fu));
+      out += static_cast<char>(0x80u | ((codepoint >> 6u) & 0x3fu));
+      out += static_cast<char>(0x80u | (codepoint & 0x3fu));
+    }
+  };
+
+  std::string out;
+  out.reserve(value.size());
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] != '\\' || i + 1u >= value.size()) {
+      out += value[i];
       continue;
     }
-    if (ch == '}') {
-      --depth;
-      if (depth == 0) {
-        return body.substr(start, pos - start + 1);
+    const char escape = value[++i];
+    switch (escape) {
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'u': {
+        uint32_t unit = 0;
+        if (!hexQuad(i + 1u, unit)) {
+          out += "\\u";
+          break;
+        }
+        i += 4u;
+        uint32_t low = 0;
+        if (unit >= 0xd800u && unit < 0xdc00u && i + 6u < value.size() && value[i + 1u] == '\\' &&
+            value[i + 2u] == 'u' && hexQuad(i + 3u, low) && low >= 0xdc00u && low < 0xe000u) {
+          unit = 0x10000u + ((unit - 0xd800u) << 10u) + (low - 0xdc00u);
+          i += 6u;
+        } else if (unit >= 0xd800u && unit < 0xe000u) {
+          unit = 0xfffdu;
+        }
+        appendUtf8(out, unit);
+        break;
       }
+      default:
+        // \" \\ \/ and anything unknown: the character itself.
+        out += escape;
+        break;
     }
   }
-  return "";
+  return out;
 }
 
 std::string okResponse(const std::string &id, const std::string &result) {
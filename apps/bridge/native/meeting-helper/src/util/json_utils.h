@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace broadify::meeting {
 
@@ -11,6 +13,25 @@ bool extractBoolField(const std::string &body, const std::string &field, bool fa
 int extractIntField(const std::string &body, const std::string &field, int fallback);
 double extractDoubleField(const std::string &body, const std::string &field, double fallback);
 std::string extractObjectField(const std::string &body, const std::string &field);
+// Raw text of an array-valued field, brackets included; empty when absent.
+std::string extractArrayField(const std::string &body, const std::string &field);
+// Splits a JSON object into its top-level members as (key, raw value text)
+// pairs, in document order. Nested objects, arrays and strings are skipped
+// over, not parsed. Returns false when `object` is not a well-formed object.
+bool splitObjectMembers(const std::string &object, std::vector<std::pair<std::string, std::string>> &members);
+// Same for a JSON array: its top-level elements as raw value text.
+bool splitArrayElements(const std::string &array, std::vector<std::string> &elements);
+// Typed reads of one raw member value as produced by splitObjectMembers.
+// Strings are returned without the quotes and, like extractStringField,
+// without unescaping.
+bool parseBoolValue(const std::string &raw, bool fallback);
+int parseIntValue(const std::string &raw, int fallback);
+double parseDoubleValue(const std::string &raw, double fallback);
+std::string parseStringValue(const std::string &raw);
+// Decodes the escapes of a string value (as returned by parseStringValue)
+// to UTF-8, including \uXXXX surrogate pairs. For text that is displayed,
+// not for keys or paths compared verbatim.
+std::string unescapeJsonString(const std::string &value);
 std::string okResponse(const std::string &id, const std::string &result);
 std::string errorResponse(const std::string &id, const std::string &code, const std::string &message);
 uint64_t nowNs();
@@ -21,6 +21,11 @@ constexpr std::array<uint32_t, 64> kRoundConstants = {
     0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u,
 };
 
+constexpr std::array<uint32_t, 8> kInitialState = {
+    0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+    0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u,
+};
+
 uint32_t rotateRight(uint32_t value, uint32_t count) {
   return (value >> count) | (value << (32u - count));
 }
@@ -84,6 +89,23 @@ std::string digestToHex(const std::array<uint32_t, 8> &state) {
   return out.str();
 }
 
+// Pads the trailing partial block with the message length and returns the
+// digest.
+std::string finish(std::vector<uint8_t> &pending, uint64_t totalBytes, std::array<uint32_t, 8> &state) {
+  pending.push_back(0x80u);
+  while ((pending.size() % 64u) != 56u) {
+    pending.push_back(0u);
+  }
+  const uint64_t totalBits = totalBytes * 8u;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    pending.push_back(static_cast<uint8_t>((totalBits >> static_cast<uint32_t>(shift)) & 0xffu));
+  }
+  for (size_t offset = 0; offset < pending.size(); offset += 64u) {
+    processBlock(pending.data() + offset, state);
+  }
+  return digestToHex(state);
+}
+
 }  // namespace
 
 std::string sha256FileHex(const std::string &path) {
@@ -92,10 +114,7 @@ std::string sha256FileHex(const std::string &path) {
     return "";
   }
 
-  std::array<uint32_t, 8> state = {
-      0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
-      0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u,
-  };
+  std::array<uint32_t, 8> state = kInitialState;
   std::vector<uint8_t> pending;
   pending.reserve(128);
   uint64_t totalBytes = 0;
@@ -112,19 +131,18 @@ std::string sha256FileHex(const std::string &path) {
   }
   std::fclose(file);
 
-  pending.push_back(0x80u);
-  while ((pending.size() % 64u) != 56u) {
-    pending.push_back(0u);
-  }
-  const uint64_t totalBits = totalBytes * 8u;
-  for (int shift = 56; shift >= 0; shift -= 8) {
-    pending.push_back(static_cast<uint8_t>((totalBits >> static_cast<uint32_t>(shift)) & 0xffu));
-  }
-  for (size_t offset = 0; offset < pending.size(); offset += 64u) {
-    processBlock(pending.data() + offset, state);
-  }
+  return finish(pending, totalBytes, state);
+}
 
-  return digestToHex(state);
+std::string sha256Hex(const std::string &bytes) {
+  std::array<uint32_t, 8> state = kInitialState;
+  const auto *data = reinterpret_cast<const uint8_t *>(bytes.data());
+  const size_t fullBlocks = bytes.size() / 64u * 64u;
+  for (size_t offset = 0; offset < fullBlocks; offset += 64u) {
+    processBlock(data + offset, state);
+  }
+  std::vector<uint8_t> pending(data + fullBlocks, data + bytes.size());
+  return finish(pending, static_cast<uint64_t>(bytes.size()), state);
 }
 
 }  // namespace broadify::meeting
@@ -5,5 +5,6 @@
 namespace broadify::meeting {
 
 std::string sha256FileHex(const std::string &path);
+std::string sha256Hex(const std::string &bytes);
 
 }  // namespace broadify::meeting
@@ -0,0 +1,15 @@
+#pragma once
+
+// Compile-time SIMD selection shared by every vectorised kernel of the
+// helper. Exactly one of BROADIFY_SIMD_SSE2 / BROADIFY_SIMD_NEON is defined
+// when the target guarantees that instruction set (SSE2 is baseline on x64;
+// NEON on arm64), with its intrinsics header included. Kernels keep a scalar
+// path for the remainder and for targets with neither.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BROADIFY_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BROADIFY_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
@@ -0,0 +1,365 @@
+#include "util/thread_roles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#else
+#include <fstream>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace broadify::meeting {
+namespace {
+
+constexpr const char *kUnregisteredRole = "unregistered";
+
+struct CpuCounters {
+  uint64_t cpuNs = 0;
+  int64_t voluntarySwitches = -1;
+  int64_t involuntarySwitches = -1;
+
+  void add(const CpuCounters &other) {
+    cpuNs += other.cpuNs;
+    if (other.voluntarySwitches >= 0) {
+      voluntarySwitches = std::max<int64_t>(voluntarySwitches, 0) + other.voluntarySwitches;
+    }
+    if (other.involuntarySwitches >= 0) {
+      involuntarySwitches = std::max<int64_t>(involuntarySwitches, 0) + other.involuntarySwitches;
+    }
+  }
+};
+
+// Handle that lets another thread read a registered thread's CPU clock.
+#if defined(_WIN32)
+struct NativeThread {
+  HANDLE handle = nullptr;
+};
+
+uint64_t fileTimeNs(const FILETIME &time) {
+  ULARGE_INTEGER value;
+  value.LowPart = time.dwLowDateTime;
+  value.HighPart = time.dwHighDateTime;
+  return value.QuadPart * 100ull;
+}
+
+NativeThread openCurrentThread() {
+  NativeThread thread;
+  DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &thread.handle,
+                  THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0);
+  return thread;
+}
+
+void closeThread(NativeThread &thread) {
+  if (thread.handle != nullptr) {
+    CloseHandle(thread.handle);
+    thread.handle = nullptr;
+  }
+}
+
+CpuCounters readThread(const NativeThread &thread) {
+  CpuCounters counters;
+  FILETIME created, exited, kernel, user;
+  if (thread.handle != nullptr && GetThreadTimes(thread.handle, &created, &exited, &kernel, &user)) {
+    counters.cpuNs = fileTimeNs(kernel) + fileTimeNs(user);
+  }
+  return counters;
+}
+
+CpuCounters readProcess() {
+  CpuCounters counters;
+  FILETIME created, exited, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+    counters.cpuNs = fileTimeNs(kernel) + fileTimeNs(user);
+  }
+  return counters;
+}
+
+void setOsThreadName(const std::string &name) {
+  // SetThreadDescription exists from Windows 10 1607; resolve it at runtime.
+  using SetThreadDescriptionFn = HRESULT(WINAPI *)(HANDLE, PCWSTR);
+  static const auto setDescription = reinterpret_cast<SetThreadDescriptionFn>(
+      reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+  if (setDescription != nullptr) {
+    const std::wstring wide(name.begin(), name.end());
+    setDescription(GetCurrentThread(), wide.c_str());
+  }
+}
+#elif defined(__APPLE__)
+struct NativeThread {
+  mach_port_t port = MACH_PORT_NULL;
+};
+
+uint64_t timeValueNs(const time_value_t &time) {
+  return static_cast<uint64_t>(time.seconds) * 1000000000ull + static_cast<uint64_t>(time.microseconds) * 1000ull;
+}
+
+NativeThread openCurrentThread() {
+  NativeThread thread;
+  thread.port = mach_thread_self();
+  return thread;
+}
+
+void closeThread(NativeThread &thread) {
+  if (thread.port != MACH_PORT_NULL) {
+    mach_port_deallocate(mach_task_self(), thread.port);
+    thread.port = MACH_PORT_NULL;
+  }
+}
+
+CpuCounters readThread(const NativeThread &thread) {
+  CpuCounters counters;
+  thread_basic_info_data_t info{};
+  mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+  if (thread.port != MACH_PORT_NULL &&
+      thread_info(thread.port, THREAD_BASIC_INFO, reinterpret_cast<thread_info_t>(&info), &count) == KERN_SUCCESS) {
+    counters.cpuNs = timeValueNs(info.user_time) + timeValueNs(info.system_time);
+  }
+  return counters;
+}
+
+CpuCounters readProcess() {
+  CpuCounters counters;
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    counters.cpuNs = (static_cast<uint64_t>(usage.ru_utime.tv_sec) + static_cast<uint64_t>(usage.ru_stime.tv_sec)) *
+                         1000000000ull +
+                     (static_cast<uint64_t>(usage.ru_utime.tv_usec) + static_cast<uint64_t>(usage.ru_stime.tv_usec)) *
+                         1000ull;
+  }
+  return counters;
+}
+
+void setOsThreadName(const std::string &name) {
+  pthread_setname_np(name.c_str());
+}
+#else
+struct NativeThread {
+  clockid_t clock = CLOCK_THREAD_CPUTIME_ID;
+  bool hasClock = false;
+  pid_t tid = 0;
+};
+
+NativeThread openCurrentThread() {
+  NativeThread thread;
+  thread.hasClock = pthread_getcpuclockid(pthread_self(), &thread.clock) == 0;
+  thread.tid = static_cast<pid_t>(syscall(SYS_gettid));
+  return thread;
+}
+
+void closeThread(NativeThread &thread) {
+  thread.hasClock = false;
+}
+
+// voluntary_ctxt_switches / nonvoluntary_ctxt_switches from a
+// /proc/.../status file; both stay -1 when the file is unreadable.
+void readContextSwitches(const std::string &path, CpuCounters &counters) {
+  std::ifstream status(path);
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("voluntary_ctxt_switches:", 0) == 0) {
+      counters.voluntarySwitches = std::strtoll(line.c_str() + 24, nullptr, 10);
+    } else if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+      counters.involuntarySwitches = std::strtoll(line.c_str() + 27, nullptr, 10);
+    }
+  }
+}
+
+CpuCounters readThread(const NativeThread &thread) {
+  CpuCounters counters;
+  timespec now{};
+  if (thread.hasClock && clock_gettime(thread.clock, &now) == 0) {
+    counters.cpuNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+  }
+  readContextSwitches("/proc/self/task/" + std::to_string(thread.tid) + "/status", counters);
+  return counters;
+}
+
+// RUSAGE_SELF sums every thread the process ever had, exited ones included.
+CpuCounters readProcess() {
+  CpuCounters counters;
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    counters.cpuNs = (static_cast<uint64_t>(usage.ru_utime.tv_sec) + static_cast<uint64_t>(usage.ru_stime.tv_sec)) *
+                         1000000000ull +
+                     (static_cast<uint64_t>(usage.ru_utime.tv_usec) + static_cast<uint64_t>(usage.ru_stime.tv_usec)) *
+                         1000ull;
+    counters.voluntarySwitches = usage.ru_nvcsw;
+    counters.involuntarySwitches = usage.ru_nivcsw;
+  }
+  return counters;
+}
+
+void setOsThreadName(const std::string &name) {
+  pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
+#endif
+
+struct ThreadEntry {
+  std::string role;
+  NativeThread native;
+};
+
+struct Registry {
+  std::mutex mutex;
+  uint64_t nextId = 1;
+  std::map<uint64_t, ThreadEntry> threads;
+  // Final counters of threads that have exited, per role.
+  std::map<std::string, CpuCounters> retired;
+
+  // Sampler baseline: cumulative counters per role at the previous sample.
+  // The first sample measures from the registry's creation, which is the
+  // main thread's registration at startup.
+  std::chrono::steady_clock::time_point lastAt = std::chrono::steady_clock::now();
+  std::map<std::string, CpuCounters> lastTotals;
+  CpuCounters lastProcess;
+  bool hasSample = false;
+  ThreadRoleSample last;
+};
+
+// Leaked on purpose: detached threads may unregister during static
+// destruction.
+Registry &registry() {
+  static Registry *instance = new Registry();
+  return *instance;
+}
+
+int64_t switchDelta(int64_t now, int64_t before) {
+  if (now < 0) {
+    return -1;
+  }
+  return std::max<int64_t>(now - std::max<int64_t>(before, 0), 0);
+}
+
+double rounded(double value, double scale) {
+  return std::round(value * scale) / scale;
+}
+
+}  // namespace
+
+ScopedThreadRole::ScopedThreadRole(const char *role) {
+  const std::string name = role == nullptr ? std::string("unnamed") : std::string(role);
+  setOsThreadName(name);
+  Registry &state = registry();
+  ThreadEntry entry;
+  entry.role = name;
+  entry.native = openCurrentThread();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  id_ = state.nextId++;
+  state.threads.emplace(id_, std::move(entry));
+}
+
+ScopedThreadRole::~ScopedThreadRole() {
+  Registry &state = registry();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = state.threads.find(id_);
+  if (it == state.threads.end()) {
+    return;
+  }
+  state.retired[it->second.role].add(readThread(it->second.native));
+  closeThread(it->second.native);
+  state.threads.erase(it);
+}
+
+ThreadRoleSample sampleThreadRoles(uint32_t minWindowMs) {
+  Registry &state = registry();
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.hasSample && now - state.lastAt < std::chrono::milliseconds(minWindowMs)) {
+    return state.last;
+  }
+
+  std::map<std::string, CpuCounters> totals = state.retired;
+  std::map<std::string, uint32_t> liveThreads;
+  for (const auto &[id, entry] : state.threads) {
+    totals[entry.role].add(readThread(entry.native));
+    liveThreads[entry.role] += 1;
+  }
+  const CpuCounters process = readProcess();
+  CpuCounters registered;
+  for (const auto &[role, counters] : totals) {
+    registered.add(counters);
+  }
+  // Whatever the process spent outside registered threads. Switch counts
+  // only exist where both sides have them.
+  CpuCounters unregistered;
+  unregistered.cpuNs = process.cpuNs > registered.cpuNs ? process.cpuNs - registered.cpuNs : 0;
+  if (process.voluntarySwitches >= 0 && registered.voluntarySwitches >= 0) {
+    unregistered.voluntarySwitches = std::max<int64_t>(process.voluntarySwitches - registered.voluntarySwitches, 0);
+    unregistered.involuntarySwitches =
+        std::max<int64_t>(process.involuntarySwitches - registered.involuntarySwitches, 0);
+  }
+  totals[kUnregisteredRole] = unregistered;
+
+  const double windowNs = std::max(std::chrono::duration<double, std::nano>(now - state.lastAt).count(), 1.0);
+  ThreadRoleSample sample;
+  sample.windowMs = rounded(windowNs / 1e6, 10.0);
+  sample.processCpuPercent = rounded(
+      static_cast<double>(process.cpuNs > state.lastProcess.cpuNs ? process.cpuNs - state.lastProcess.cpuNs : 0) /
+          windowNs * 100.0,
+      10.0);
+  const auto appendRole = [&](const std::string &role, const CpuCounters &counters) {
+    const CpuCounters &before = state.lastTotals[role];
+    ThreadRoleUsage usage;
+    usage.role = role;
+    usage.threads = liveThreads[role];
+    usage.cpuPercent = rounded(
+        static_cast<double>(counters.cpuNs > before.cpuNs ? counters.cpuNs - before.cpuNs : 0) / windowNs * 100.0,
+        10.0);
+    usage.cpuSeconds = rounded(static_cast<double>(counters.cpuNs) / 1e9, 1000.0);
+    usage.voluntarySwitches = switchDelta(counters.voluntarySwitches, before.voluntarySwitches);
+    usage.involuntarySwitches = switchDelta(counters.involuntarySwitches, before.involuntarySwitches);
+    sample.roles.push_back(std::move(usage));
+  };
+  for (const auto &[role, counters] : totals) {
+    if (role != kUnregisteredRole) {
+      appendRole(role, counters);
+    }
+  }
+  appendRole(kUnregisteredRole, unregistered);
+
+  state.lastAt = now;
+  state.lastTotals = std::move(totals);
+  state.lastProcess = process;
+  state.hasSample = true;
+  state.last = sample;
+  return sample;
+}
+
+std::string threadRoleSampleJson(const ThreadRoleSample &sample) {
+  const auto count = [](int64_t value) {
+    return value < 0 ? std::string("null") : std::to_string(value);
+  };
+  std::ostringstream out;
+  out << "\"window_ms\":" << sample.windowMs
+      << ",\"process_cpu_percent\":" << sample.processCpuPercent
+      << ",\"roles\":[";
+  for (size_t i = 0; i < sample.roles.size(); ++i) {
+    const ThreadRoleUsage &usage = sample.roles[i];
+    out << (i == 0 ? "" : ",")
+        << "{\"role\":\"" << usage.role
+        << "\",\"threads\":" << usage.threads
+        << ",\"cpu_percent\":" << usage.cpuPercent
+        << ",\"cpu_seconds\":" << usage.cpuSeconds
+        << ",\"voluntary_switches\":" << count(usage.voluntarySwitches)
+        << ",\"involuntary_switches\":" << count(usage.involuntarySwitches) << "}";
+  }
+  out << "]";
+  return out.str();
+}
+
+}  // namespace broadify::meeting
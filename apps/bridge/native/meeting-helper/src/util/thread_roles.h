@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Registers the calling thread under a pipeline role ("pipeline", "keyer",
+// "mjpeg", ...; snake_case literals, emitted into JSON unescaped) for the
+// lifetime of the object and applies the role as the OS thread name
+// (truncated to 15 characters on Linux). CPU time of a thread that exits
+// stays accounted to its role.
+class ScopedThreadRole {
+ public:
+  explicit ScopedThreadRole(const char *role);
+  ~ScopedThreadRole();
+
+  ScopedThreadRole(const ScopedThreadRole &) = delete;
+  ScopedThreadRole &operator=(const ScopedThreadRole &) = delete;
+
+ private:
+  uint64_t id_ = 0;
+};
+
+// CPU usage of one role over the sample window. Percentages are of one core,
+// so a role saturating three cores reports 300. Context switch counts are -1
+// where the platform has no per-thread counters (macOS, Windows).
+struct ThreadRoleUsage {
+  std::string role;
+  uint32_t threads = 0;
+  double cpuPercent = 0.0;
+  double cpuSeconds = 0.0;  // since process start, exited threads included
+  int64_t voluntarySwitches = -1;
+  int64_t involuntarySwitches = -1;
+};
+
+struct ThreadRoleSample {
+  double windowMs = 0.0;
+  double processCpuPercent = 0.0;
+  // Registered roles sorted by name, then "unregistered": process CPU not
+  // covered by a registered thread (runtime and OS-owned threads such as
+  // dispatch queues, plus threads that predate their registration).
+  std::vector<ThreadRoleUsage> roles;
+};
+
+// Deltas since the previous sample. Callers share one sampler: a call less
+// than `minWindowMs` after the previous sample returns that sample again, so
+// the metrics loop and the control RPC do not shorten each other's window.
+ThreadRoleSample sampleThreadRoles(uint32_t minWindowMs = 1000);
+
+// JSON object members ("window_ms", "process_cpu_percent", "roles"),
+// without the surrounding braces.
+std::string threadRoleSampleJson(const ThreadRoleSample &sample);
+
+}  // namespace broadify::meeting
@@ -0,0 +1,116 @@
+#include "util/worker_pool.h"
+
+#include "util/thread_roles.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace broadify::meeting {
+
+WorkerPool::WorkerPool(unsigned workerCount) {
+  for (unsigned i = 0; i < workerCount; ++i) {
+    workers_.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkerPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+void WorkerPool::parallelFor(uint32_t count, const std::function<void(uint32_t)> &body) {
+  if (count <= 1u || workers_.empty()) {
+    for (uint32_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  // Indices are claimed from a shared counter by the caller and by helper
+  // tasks alike. A helper that starts after every index is claimed returns
+  // without touching `body`, so the state outlives the call only as a
+  // shared_ptr.
+  struct Job {
+    const std::function<void(uint32_t)> *body = nullptr;
+    uint32_t count = 0;
+    std::atomic<uint32_t> next{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    uint32_t finished = 0;
+  };
+  auto job = std::make_shared<Job>();
+  job->body = &body;
+  job->count = count;
+  const auto drain = [](Job &state) {
+    uint32_t ran = 0;
+    for (uint32_t i = state.next.fetch_add(1u); i < state.count; i = state.next.fetch_add(1u)) {
+      (*state.body)(i);
+      ++ran;
+    }
+    if (ran > 0u) {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.finished += ran;
+      if (state.finished == state.count) {
+        state.done.notify_all();
+      }
+    }
+  };
+
+  const uint32_t helpers = std::min<uint32_t>(count - 1u, static_cast<uint32_t>(workers_.size()));
+  for (uint32_t i = 0; i < helpers; ++i) {
+    post([job, drain]() { drain(*job); });
+  }
+  drain(*job);
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->done.wait(lock, [&job]() { return job->finished == job->count; });
+}
+
+void WorkerPool::waitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return tasks_.empty() && busy_ == 0u; });
+}
+
+void WorkerPool::workerLoop() {
+  ScopedThreadRole role("worker_pool");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;
+    }
+    std::function<void()> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    ++busy_;
+    lock.unlock();
+    task();
+    lock.lock();
+    --busy_;
+    if (tasks_.empty() && busy_ == 0u) {
+      idle_.notify_all();
+    }
+  }
+}
+
+WorkerPool &sharedWorkerPool() {
+  // Never destroyed: detached threads may still render while statics are
+  // torn down at exit.
+  static WorkerPool *pool = new WorkerPool(std::clamp(std::thread::hardware_concurrency() / 2u, 1u, 4u));
+  return *pool;
+}
+
+}  // namespace broadify::meeting
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace broadify::meeting {
+
+// Fixed set of worker threads for CPU-bound frame work (format conversion,
+// decode, resampling bands). Tasks are plain closures run in FIFO order.
+class WorkerPool {
+ public:
+  explicit WorkerPool(unsigned workerCount);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  size_t workerCount() const { return workers_.size(); }
+
+  void post(std::function<void()> task);
+
+  // Runs body(0..count-1) and returns when all have finished. The calling
+  // thread takes part and never waits on an index nobody has started, so
+  // parallelFor is safe to call from inside a pool task.
+  void parallelFor(uint32_t count, const std::function<void(uint32_t)> &body);
+
+  // Blocks until the queue is empty and no task is running.
+  void waitIdle();
+
+ private:
+  void workerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> workers_;
+  uint32_t busy_ = 0;
+  bool stopping_ = false;
+};
+
+// Process-wide pool for render-path helpers (half the cores, at most four).
+WorkerPool &sharedWorkerPool();
+
+}  // namespace broadify::meeting
@@ -0,0 +1,167 @@
+#include "compose/camera_framing.h"
+#include "director/auto_framer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using broadify::meeting::AlphaMask;
+using broadify::meeting::AutoFramer;
+using broadify::meeting::CameraFraming;
+using broadify::meeting::CameraWindow;
+using broadify::meeting::SubjectBounds;
+using broadify::meeting::framingWindow;
+using broadify::meeting::keyerInputWindow;
+using broadify::meeting::manualCameraFraming;
+using broadify::meeting::subjectBounds;
+
+namespace {
+
+constexpr uint32_t kWidth = 1920u;
+constexpr uint32_t kHeight = 1080u;
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+bool contains(const CameraWindow &outer, const CameraWindow &inner) {
+  return outer.x <= inner.x && outer.y <= inner.y && outer.x + outer.width >= inner.x + inner.width &&
+      outer.y + outer.height >= inner.y + inner.height;
+}
+
+bool isWholeFrame(const CameraWindow &window) {
+  return window.x == 0u && window.y == 0u && window.width == kWidth && window.height == kHeight;
+}
+
+// An opaque box over a transparent mask, in fractions of the mask.
+AlphaMask boxMask(uint32_t width, uint32_t height, double left, double top, double right, double bottom) {
+  AlphaMask mask;
+  mask.width = width;
+  mask.height = height;
+  mask.alpha.assign(static_cast<size_t>(width) * height, 0u);
+  for (uint32_t y = static_cast<uint32_t>(top * height); y < static_cast<uint32_t>(bottom * height); ++y) {
+    for (uint32_t x = static_cast<uint32_t>(left * width); x < static_cast<uint32_t>(right * width); ++x) {
+      mask.alpha[static_cast<size_t>(y) * width + x] = 255u;
+    }
+  }
+  return mask;
+}
+
+bool testWindows() {
+  // No zoom shows (and keys) the whole frame, whatever the pan.
+  if (!isWholeFrame(framingWindow(manualCameraFraming(1.0, 0.7, -0.4), kWidth, kHeight)) ||
+      !isWholeFrame(keyerInputWindow(CameraFraming{}, kWidth, kHeight))) {
+    return fail("zoom 1 must show the whole frame");
+  }
+
+  const CameraWindow centred = framingWindow(manualCameraFraming(2.0, 0.0, 0.0), kWidth, kHeight);
+  if (centred.x != 480u || centred.y != 270u || centred.width != 960u || centred.height != 540u) {
+    return fail("zoom 2 must show the centred half of the frame");
+  }
+  // Full pan reaches the frame edge and never beyond.
+  const CameraWindow corner = framingWindow(manualCameraFraming(2.0, 1.0, -1.0), kWidth, kHeight);
+  if (corner.x != 960u || corner.y != 0u || corner.width != 960u) {
+    return fail("full pan must reach the frame edge");
+  }
+  CameraFraming outside;
+  outside.zoom = 3.0;
+  outside.centerX = -2.0;
+  outside.centerY = 5.0;
+  const CameraWindow clamped = framingWindow(outside, kWidth, kHeight);
+  if (clamped.x != 0u || clamped.y + clamped.height != kHeight) {
+    return fail("a centre outside the frame must be clamped");
+  }
+  // Zoom is bounded on both ends.
+  if (framingWindow(manualCameraFraming(50.0, 0.0, 0.0), kWidth, kHeight).width != 480u ||
+      !isWholeFrame(framingWindow(manualCameraFraming(0.2, 0.0, 0.0), kWidth, kHeight))) {
+    return fail("zoom must stay within 1..4");
+  }
+
+  // The keyer input covers the window with a margin, on even pixels, and
+  // does not move while the window drifts a little.
+  for (const double pan : {-1.0, -0.3, 0.0, 0.45, 1.0}) {
+    const CameraFraming framing = manualCameraFraming(2.5, pan, pan * 0.5);
+    const CameraWindow window = framingWindow(framing, kWidth, kHeight);
+    const CameraWindow input = keyerInputWindow(framing, kWidth, kHeight);
+    if (!contains(input, window) || input.x % 2u != 0u || input.width % 2u != 0u ||
+        input.width >= kWidth || input.x + input.width > kWidth || input.y + input.height > kHeight) {
+      return fail("keyer input must cover the framed window within the frame");
+    }
+  }
+  const CameraWindow before = keyerInputWindow(manualCameraFraming(2.0, 0.1, 0.0), kWidth, kHeight);
+  const CameraWindow after = keyerInputWindow(manualCameraFraming(2.0, 0.11, 0.0), kWidth, kHeight);
+  if (before.x != after.x || before.width != after.width) {
+    return fail("a small drift must keep the keyer input");
+  }
+  return true;
+}
+
+bool testAutoFramer() {
+  SubjectBounds bounds;
+  if (subjectBounds(boxMask(64u, 36u, 0.0, 0.0, 0.0, 0.0), bounds)) {
+    return fail("an empty matte has no subject");
+  }
+  // A small presenter standing left of centre.
+  const AlphaMask subject = boxMask(512u, 288u, 0.25, 0.3, 0.45, 0.75);
+  if (!subjectBounds(subject, bounds) || std::abs(bounds.left - 0.25) > 0.01 || std::abs(bounds.top - 0.3) > 0.01 ||
+      std::abs(bounds.right - 0.45) > 0.01 || std::abs(bounds.bottom - 0.75) > 0.01) {
+    return fail("subject bounds must follow the matte");
+  }
+
+  AutoFramer framer;
+  framer.reset(CameraFraming{});
+  auto now = std::chrono::steady_clock::now();
+  framer.observe(&subject, now);
+  if (framer.framing().zoom != 1.0) {
+    return fail("the first observation must not jump");
+  }
+  double previousZoom = 1.0;
+  for (int frame = 0; frame < 150; ++frame) {
+    now += std::chrono::milliseconds(33);
+    framer.observe(&subject, now);
+    if (framer.framing().zoom + 1e-9 < previousZoom) {
+      return fail("the glide toward the subject must be monotonic");
+    }
+    previousZoom = framer.framing().zoom;
+  }
+  const CameraFraming settled = framer.framing();
+  const CameraWindow window = framingWindow(settled, kWidth, kHeight);
+  const CameraWindow person{static_cast<uint32_t>(0.25 * kWidth), static_cast<uint32_t>(0.3 * kHeight),
+                            static_cast<uint32_t>(0.2 * kWidth), static_cast<uint32_t>(0.45 * kHeight)};
+  if (settled.zoom < 1.6 || settled.zoom > AutoFramer::kMaxZoom || !contains(window, person) ||
+      std::abs(settled.centerX - 0.35) > 0.02) {
+    return fail("auto-framing must zoom onto the subject and keep it in the picture");
+  }
+
+  // Small movements stay inside the deadband; losing the matte holds.
+  const AlphaMask nudged = boxMask(512u, 288u, 0.26, 0.3, 0.46, 0.75);
+  for (int frame = 0; frame < 60; ++frame) {
+    now += std::chrono::milliseconds(33);
+    framer.observe(frame % 2 == 0 ? &nudged : nullptr, now);
+  }
+  if (std::abs(framer.framing().centerX - settled.centerX) > 0.005 ||
+      std::abs(framer.framing().zoom - settled.zoom) > 0.01) {
+    return fail("a small move or a lost matte must not reframe");
+  }
+
+  // Resetting takes over the given framing at once.
+  framer.reset(manualCameraFraming(1.5, 0.5, 0.0));
+  if (std::abs(framer.framing().zoom - 1.5) > 1e-9) {
+    return fail("reset must adopt the framing");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!testWindows() || !testAutoFramer()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "camera framing ok" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+#include "preview/camera_mosaic.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using broadify::meeting::CameraInfo;
+using broadify::meeting::CameraMosaic;
+using broadify::meeting::CameraSource;
+using broadify::meeting::MosaicLayout;
+using broadify::meeting::MosaicTile;
+using broadify::meeting::VideoFrame;
+using broadify::meeting::computeMosaicLayout;
+using broadify::meeting::kMosaicMeterHeight;
+
+namespace {
+
+// Multi-camera source whose frames and levels the test drives directly.
+class FakeCameraSource final : public CameraSource {
+ public:
+  std::vector<CameraInfo> listCameras() override { return {}; }
+  bool selectCamera(int) override { return true; }
+  bool start(int, uint32_t, uint32_t, uint32_t) override { return true; }
+  void stop() override {}
+  bool isRunning() const override { return true; }
+  int activeCameraIndex() const override { return openSet.empty() ? -1 : openSet.front(); }
+  bool copyLatestFrame(VideoFrame &frame) override {
+    return copyLatestFrameFrom(activeCameraIndex(), 0u, frame);
+  }
+  std::string lastError() const override { return ""; }
+  std::string cameraPermissionStatus() const override { return "authorized"; }
+  std::string requestCameraPermission() override { return "authorized"; }
+
+  std::vector<int> activeCameraSet() const override { return openSet; }
+  bool copyLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs, VideoFrame &frame) override {
+    const auto found = frames.find(cameraIndex);
+    if (found == frames.end() || found->second.timestampNs == lastTimestampNs) {
+      return false;
+    }
+    ++copies;
+    frame = found->second;
+    return true;
+  }
+  bool readLatestFrameFrom(int cameraIndex, uint64_t lastTimestampNs,
+                           const std::function<void(const VideoFrame &)> &read) override {
+    const auto found = frames.find(cameraIndex);
+    if (found == frames.end() || found->second.timestampNs == lastTimestampNs) {
+      return false;
+    }
+    ++reads;
+    read(found->second);
+    return true;
+  }
+  std::map<int, float> cameraAudioLevels() const override { return levels; }
+
+  void deliver(int cameraIndex, uint8_t r, uint8_t g, uint8_t b) {
+    VideoFrame &frame = frames[cameraIndex];
+    frame.width = 1280u;
+    frame.height = 720u;
+    frame.timestampNs += 1000u;
+    frame.rgba.resize(static_cast<size_t>(frame.width) * frame.height * 4u);
+    for (size_t i = 0; i < frame.rgba.size(); i += 4u) {
+      frame.rgba[i + 0u] = r;
+      frame.rgba[i + 1u] = g;
+      frame.rgba[i + 2u] = b;
+      frame.rgba[i + 3u] = 255u;
+    }
+  }
+
+  // One-pixel black/white columns: a point-sampling scaler lands on a single
+  // column phase and shows solid black or white instead of grey.
+  void deliverStripes(int cameraIndex) {
+    deliver(cameraIndex, 0u, 0u, 0u);
+    VideoFrame &frame = frames[cameraIndex];
+    for (size_t i = 4u; i < frame.rgba.size(); i += 8u) {
+      frame.rgba[i + 0u] = 255u;
+      frame.rgba[i + 1u] = 255u;
+      frame.rgba[i + 2u] = 255u;
+    }
+  }
+
+  std::vector<int> openSet;
+  std::map<int, VideoFrame> frames;
+  std::map<int, float> levels;
+  int copies = 0;
+  int reads = 0;
+};
+
+const uint8_t *tilePixel(const CameraMosaic &mosaic, const MosaicTile &tile, uint32_t x, uint32_t y) {
+  return mosaic.rgba().data() +
+      (static_cast<size_t>(tile.y + y) * mosaic.width() + tile.x + x) * 4u;
+}
+
+bool expectColor(const uint8_t *pixel, uint8_t r, uint8_t g, uint8_t b, const char *what) {
+  if (pixel[0] != r || pixel[1] != g || pixel[2] != b || pixel[3] != 255u) {
+    std::cerr << what << ": got " << int(pixel[0]) << "," << int(pixel[1]) << "," << int(pixel[2])
+              << " expected " << int(r) << "," << int(g) << "," << int(b) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  // Eight cameras pack into a 3x3 grid of fixed tiles, in open-set order.
+  const MosaicLayout eight = computeMosaicLayout({0, 1, 2, 3, 4, 5, 6, 7}, 320u, 180u);
+  if (eight.columns != 3u || eight.rows != 3u || eight.width != 960u || eight.height != 540u ||
+      eight.tiles.size() != 8u || eight.tiles[4].x != 320u || eight.tiles[4].y != 180u) {
+    std::cerr << "unexpected eight-camera layout" << std::endl;
+    return 1;
+  }
+
+  FakeCameraSource camera;
+  camera.openSet = {2, 5};
+  camera.deliver(2, 200u, 40u, 10u);
+  camera.deliver(5, 10u, 90u, 250u);
+  camera.levels[5] = 0.5f;
+
+  CameraMosaic mosaic(64u, 36u + kMosaicMeterHeight);
+  if (!mosaic.update(camera) || mosaic.width() != 128u || mosaic.height() != 36u + kMosaicMeterHeight) {
+    std::cerr << "first update must build the atlas" << std::endl;
+    return 2;
+  }
+  const MosaicTile &first = mosaic.layout().tiles[0];
+  const MosaicTile &second = mosaic.layout().tiles[1];
+  if (!expectColor(tilePixel(mosaic, first, 10u, 10u), 200u, 40u, 10u, "camera 2 thumbnail") ||
+      !expectColor(tilePixel(mosaic, second, 40u, 30u), 10u, 90u, 250u, "camera 5 thumbnail")) {
+    return 3;
+  }
+
+  // Audio meters: camera 2 silent, camera 5 lit across half the tile width.
+  const uint32_t meterRow = first.height - 1u;
+  if (tilePixel(mosaic, first, 0u, meterRow)[1] == 209u ||
+      tilePixel(mosaic, second, 20u, meterRow)[1] != 209u ||
+      tilePixel(mosaic, second, 40u, meterRow)[1] == 209u) {
+    std::cerr << "audio meter does not track the camera levels" << std::endl;
+    return 4;
+  }
+
+  // Thumbnails are read from the cameras' own frames, never copied.
+  if (camera.copies != 0) {
+    std::cerr << "the mosaic must not copy camera frames" << std::endl;
+    return 9;
+  }
+
+  // Nothing new: no frame reads, no atlas change (so no re-encode).
+  const int readsBefore = camera.reads;
+  if (mosaic.update(camera) || camera.reads != readsBefore) {
+    std::cerr << "idle update must not touch the atlas" << std::endl;
+    return 5;
+  }
+
+  // A new frame from one camera refreshes only that tile.
+  camera.deliver(5, 0u, 255u, 0u);
+  if (!mosaic.update(camera) || camera.reads != readsBefore + 1 ||
+      !expectColor(tilePixel(mosaic, first, 10u, 10u), 200u, 40u, 10u, "untouched tile") ||
+      !expectColor(tilePixel(mosaic, second, 10u, 10u), 0u, 255u, 0u, "refreshed tile")) {
+    return 6;
+  }
+
+  // A level change alone still redraws the meter.
+  camera.levels[2] = 1.0f;
+  if (!mosaic.update(camera) || tilePixel(mosaic, first, 60u, meterRow)[1] != 209u) {
+    std::cerr << "meter change must update the atlas" << std::endl;
+    return 7;
+  }
+
+  // Closing a camera re-packs the grid.
+  camera.openSet = {5};
+  if (!mosaic.update(camera) || mosaic.width() != 64u ||
+      !expectColor(tilePixel(mosaic, mosaic.layout().tiles[0], 10u, 10u), 0u, 255u, 0u, "re-packed tile")) {
+    return 8;
+  }
+
+  // Fine detail averages out instead of aliasing.
+  camera.deliverStripes(5);
+  if (!mosaic.update(camera)) {
+    std::cerr << "striped frame must update the atlas" << std::endl;
+    return 10;
+  }
+  for (const uint32_t x : {5u, 20u, 33u, 58u}) {
+    const uint8_t *pixel = tilePixel(mosaic, mosaic.layout().tiles[0], x, 18u);
+    if (pixel[0] < 120u || pixel[0] > 135u || pixel[3] != 255u) {
+      std::cerr << "striped thumbnail aliased to " << int(pixel[0]) << " at x=" << x << std::endl;
+      return 10;
+    }
+  }
+
+  std::cout << "camera mosaic test passed" << std::endl;
+  return 0;
+}
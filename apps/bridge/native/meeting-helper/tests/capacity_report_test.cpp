@@ -0,0 +1,160 @@
+#include "pipeline/capacity_benchmark.h"
+#include "util/json_utils.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::CapacityKeyerSamples;
+using broadify::meeting::CapacityRequest;
+using broadify::meeting::CapacitySamples;
+using broadify::meeting::CapacitySceneSamples;
+using broadify::meeting::CapacityStageSamples;
+using broadify::meeting::capacityReportJson;
+using broadify::meeting::extractArrayField;
+using broadify::meeting::extractBoolField;
+using broadify::meeting::extractDoubleField;
+using broadify::meeting::extractIntField;
+using broadify::meeting::extractObjectField;
+using broadify::meeting::extractStringField;
+using broadify::meeting::splitArrayElements;
+
+namespace {
+
+CapacityStageSamples stage(std::vector<double> ms) {
+  CapacityStageSamples samples;
+  samples.ms = std::move(ms);
+  return samples;
+}
+
+CapacitySceneSamples scene(const std::string &name, bool keyed, std::vector<double> compositeMs,
+                           std::vector<double> refineMs = {}) {
+  CapacitySceneSamples samples;
+  samples.name = name;
+  samples.keyed = keyed;
+  samples.composite = stage(std::move(compositeMs));
+  samples.refine = stage(std::move(refineMs));
+  return samples;
+}
+
+CapacityKeyerSamples keyer(const std::string &mode, std::vector<double> inferenceMs,
+                           std::vector<double> postprocessMs) {
+  CapacityKeyerSamples samples;
+  samples.keyer = "modnet";
+  samples.mode = mode;
+  samples.inputSize = 256u;
+  samples.provider = "cpu";
+  samples.inference = stage(std::move(inferenceMs));
+  samples.postprocess = stage(std::move(postprocessMs));
+  return samples;
+}
+
+bool near(double value, double expected) {
+  return std::abs(value - expected) < 1e-6;
+}
+
+}  // namespace
+
+int main() {
+  CapacityRequest request;
+  request.width = 1920u;
+  request.height = 1080u;
+  request.fps = 60u;
+
+  CapacitySamples samples;
+  // A fast keyer that holds 25 fps and a slow one that only manages 10.
+  samples.keyers.push_back(keyer("quality", {30.0, 35.0, 32.0}, {4.0, 4.0, 4.0}));
+  samples.keyers.push_back(keyer("performance", {90.0, 95.0, 92.0}, {8.0, 8.0, 8.0}));
+  samples.scenes.push_back(scene("passthrough", false, {1.0, 3.0, 2.0}));
+  samples.scenes.push_back(scene("keyed", true, {6.0, 4.0, 5.0}, {2.0, 3.0, 1.0}));
+  samples.scenes.push_back(scene("keyed_graphics", true, {30.0, 30.0, 30.0}, {2.0, 2.0, 2.0}));
+  CapacitySceneSamples busy = scene("keyed_pip", true, {});
+  busy.composite.available = false;
+  busy.composite.detail = "program_thread_busy";
+  busy.refine.available = false;
+  samples.scenes.push_back(busy);
+  samples.previewEncode = stage({5.0, 5.0, 5.0});
+  samples.framebusWrite = stage({1.0, 1.0, 1.0});
+
+  const std::string report = capacityReportJson(request, samples, true, 1234.0);
+  std::vector<std::string> configurations;
+  if (!splitArrayElements(extractArrayField(report, "configurations"), configurations) ||
+      configurations.size() != 7u) {
+    std::cerr << "expected one configuration per plain scene and per keyer of each keyed scene: " << report
+              << std::endl;
+    return 1;
+  }
+
+  // Program ms is the composite, refine and FrameBus write medians; an
+  // unkeyed scene has no refine.
+  const std::string &plain = configurations[0];
+  if (!near(extractDoubleField(plain, "program_ms", -1.0), 3.0) ||
+      !near(extractDoubleField(plain, "max_fps", -1.0), 1000.0 / 3.0) ||
+      !extractBoolField(plain, "meets_target", false) || plain.find("mask_ms") != std::string::npos) {
+    std::cerr << "unkeyed configuration: " << plain << std::endl;
+    return 2;
+  }
+  const std::string &keyedFast = configurations[1];
+  if (extractStringField(keyedFast, "scene") != "keyed" ||
+      !near(extractDoubleField(keyedFast, "program_ms", -1.0), 5.0 + 2.0 + 1.0)) {
+    std::cerr << "keyed program ms is not composite + refine + FrameBus write: " << keyedFast << std::endl;
+    return 3;
+  }
+
+  // The mask targets min(request fps, the mode's keyer rate) and must be met
+  // on top of the program rate.
+  if (extractIntField(keyedFast, "mask_target_fps", 0) != 25 ||
+      !near(extractDoubleField(keyedFast, "mask_ms", -1.0), 36.0) ||
+      !extractBoolField(keyedFast, "meets_target", false)) {
+    std::cerr << "fast keyer configuration: " << keyedFast << std::endl;
+    return 4;
+  }
+  const std::string &keyedSlow = configurations[2];
+  if (extractIntField(keyedSlow, "mask_target_fps", 0) != 15 ||
+      !near(extractDoubleField(keyedSlow, "mask_fps", -1.0), 10.0) ||
+      extractBoolField(keyedSlow, "meets_target", true)) {
+    std::cerr << "slow keyer must miss its mask target: " << keyedSlow << std::endl;
+    return 5;
+  }
+  // A 33 ms program misses 60 fps even with a keyer that keeps up.
+  const std::string &slowProgram = configurations[3];
+  if (!near(extractDoubleField(slowProgram, "program_ms", -1.0), 33.0) ||
+      extractBoolField(slowProgram, "meets_target", true)) {
+    std::cerr << "slow program must miss the target: " << slowProgram << std::endl;
+    return 6;
+  }
+  CapacityRequest lowRate = request;
+  lowRate.fps = 12u;
+  std::vector<std::string> lowRateConfigurations;
+  splitArrayElements(extractArrayField(capacityReportJson(lowRate, samples, true, 1234.0), "configurations"),
+                     lowRateConfigurations);
+  if (lowRateConfigurations.size() != 7u ||
+      extractIntField(lowRateConfigurations[2], "mask_target_fps", 0) != 12 ||
+      extractBoolField(lowRateConfigurations[2], "meets_target", true)) {
+    std::cerr << "mask target must not exceed the requested rate" << std::endl;
+    return 7;
+  }
+
+  // Scenes the program thread had no time for are reported, not predicted.
+  for (size_t index = 5u; index < 7u; ++index) {
+    const std::string &configuration = configurations[index];
+    if (extractStringField(configuration, "scene") != "keyed_pip" ||
+        extractBoolField(configuration, "available", true) ||
+        configuration.find("program_ms") != std::string::npos) {
+      std::cerr << "busy scene must be unavailable: " << configuration << std::endl;
+      return 8;
+    }
+  }
+  std::vector<std::string> composites;
+  splitArrayElements(extractArrayField(extractObjectField(report, "stages"), "composite"), composites);
+  if (composites.size() != 4u || extractBoolField(composites[3], "available", true) ||
+      extractStringField(composites[3], "detail") != "program_thread_busy" ||
+      extractIntField(composites[3], "samples", -1) != 0) {
+    std::cerr << "busy composite stage not reported" << std::endl;
+    return 9;
+  }
+
+  std::cout << "capacity report test passed" << std::endl;
+  return 0;
+}
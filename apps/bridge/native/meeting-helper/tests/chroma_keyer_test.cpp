@@ -0,0 +1,186 @@
+#include "keyer/chroma_keyer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using broadify::meeting::ChromaKeyer;
+using broadify::meeting::ChromaKeySettings;
+using broadify::meeting::KeyerResult;
+using broadify::meeting::KeyerSettings;
+using broadify::meeting::VideoFrame;
+using broadify::meeting::chromaKeyAlpha;
+using broadify::meeting::suppressChromaSpill;
+
+namespace {
+
+// Straight from the definition: BT.601 chroma distance to the key colour,
+// tolerance and softness in units of 128.
+int referenceAlpha(const uint8_t *px, const ChromaKeySettings &settings) {
+  const auto cb = [](double r, double g, double b) { return -0.168736 * r - 0.331264 * g + 0.5 * b; };
+  const auto cr = [](double r, double g, double b) { return 0.5 * r - 0.418688 * g - 0.081312 * b; };
+  const double dx = cb(px[0], px[1], px[2]) - cb(settings.keyRed, settings.keyGreen, settings.keyBlue);
+  const double dy = cr(px[0], px[1], px[2]) - cr(settings.keyRed, settings.keyGreen, settings.keyBlue);
+  const double distance = std::sqrt(dx * dx + dy * dy);
+  const double alpha = (distance - settings.tolerance * 128.0) * 255.0 / (settings.softness * 128.0);
+  return static_cast<int>(std::lround(std::clamp(alpha, 0.0, 255.0)));
+}
+
+std::vector<uint8_t> pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+  return {r, g, b, a};
+}
+
+uint8_t keyOne(const std::vector<uint8_t> &px, const ChromaKeySettings &settings) {
+  uint8_t alpha = 0;
+  chromaKeyAlpha(px.data(), &alpha, 1u, settings);
+  return alpha;
+}
+
+double luma(const uint8_t *px) {
+  return 0.299 * px[0] + 0.587 * px[1] + 0.114 * px[2];
+}
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+bool checkClassification() {
+  const ChromaKeySettings settings;
+  if (keyOne(pixel(0, 177, 64), settings) != 0u || keyOne(pixel(40, 160, 70), settings) != 0u) {
+    return fail("green screen pixels must be keyed out");
+  }
+  if (keyOne(pixel(210, 160, 130), settings) != 255u || keyOne(pixel(200, 200, 200), settings) != 255u ||
+      keyOne(pixel(20, 20, 30), settings) != 255u) {
+    return fail("skin, grey and dark pixels must stay opaque");
+  }
+  // Blue screen: the same pixel flips once the key colour changes.
+  ChromaKeySettings blue;
+  blue.keyRed = 20;
+  blue.keyGreen = 60;
+  blue.keyBlue = 200;
+  if (keyOne(pixel(25, 70, 190), blue) != 0u || keyOne(pixel(25, 70, 190), settings) != 255u) {
+    return fail("key colour is not honoured");
+  }
+  return true;
+}
+
+bool checkMatchesReference() {
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> byte(0, 255);
+  // Odd length exercises the vector body and the scalar tail.
+  std::vector<uint8_t> rgba(1037u * 4u);
+  for (uint8_t &value : rgba) {
+    value = static_cast<uint8_t>(byte(random));
+  }
+  for (const double softness : {0.05, 0.2, 0.6}) {
+    ChromaKeySettings settings;
+    settings.softness = softness;
+    settings.tolerance = 0.25;
+    std::vector<uint8_t> alpha(1037u);
+    chromaKeyAlpha(rgba.data(), alpha.data(), alpha.size(), settings);
+    for (size_t i = 0; i < alpha.size(); ++i) {
+      if (std::abs(static_cast<int>(alpha[i]) - referenceAlpha(&rgba[i * 4u], settings)) > 1) {
+        return fail("alpha differs from reference at pixel " + std::to_string(i));
+      }
+    }
+  }
+  return true;
+}
+
+bool checkSpill() {
+  ChromaKeySettings settings;
+  settings.spillSuppression = 1.0;
+  // Green-tinted skin, neutral grey and a magenta pixel (opposite hue) in a
+  // run long enough for the vector path.
+  std::vector<uint8_t> rgba;
+  for (int i = 0; i < 9; ++i) {
+    for (const auto &px : {pixel(150, 190, 120, 77), pixel(128, 128, 128, 9), pixel(200, 40, 180, 200)}) {
+      rgba.insert(rgba.end(), px.begin(), px.end());
+    }
+  }
+  const std::vector<uint8_t> original = rgba;
+  suppressChromaSpill(rgba.data(), rgba.size() / 4u, settings);
+  for (size_t i = 0; i < rgba.size(); i += 12u) {
+    const uint8_t *tinted = &rgba[i];
+    if (tinted[1] >= original[i + 1] || tinted[0] <= original[i] || tinted[3] != 77u ||
+        std::abs(luma(tinted) - luma(&original[i])) > 1.5) {
+      return fail("green spill was not removed at constant luma");
+    }
+    if (!std::equal(rgba.begin() + static_cast<std::ptrdiff_t>(i + 4u),
+                    rgba.begin() + static_cast<std::ptrdiff_t>(i + 12u),
+                    original.begin() + static_cast<std::ptrdiff_t>(i + 4u))) {
+      return fail("pixels without key hue must be untouched");
+    }
+  }
+  // Full strength leaves nothing to remove on a second pass.
+  std::vector<uint8_t> again = rgba;
+  suppressChromaSpill(again.data(), again.size() / 4u, settings);
+  for (size_t i = 0; i < again.size(); ++i) {
+    if (std::abs(static_cast<int>(again[i]) - static_cast<int>(rgba[i])) > 1) {
+      return fail("full-strength spill suppression is not stable");
+    }
+  }
+  settings.spillSuppression = 0.0;
+  std::vector<uint8_t> untouched = original;
+  suppressChromaSpill(untouched.data(), untouched.size() / 4u, settings);
+  if (untouched != original) {
+    return fail("zero spill suppression changed the frame");
+  }
+  return true;
+}
+
+bool checkKeyerFrame() {
+  // Large enough to be split into row bands: left half green screen, right
+  // half foreground.
+  VideoFrame frame;
+  frame.width = 640;
+  frame.height = 360;
+  frame.timestampNs = 42;
+  frame.rgba.resize(static_cast<size_t>(frame.width) * frame.height * 4u);
+  for (uint32_t y = 0; y < frame.height; ++y) {
+    for (uint32_t x = 0; x < frame.width; ++x) {
+      uint8_t *px = &frame.rgba[(static_cast<size_t>(y) * frame.width + x) * 4u];
+      const bool screen = x < frame.width / 2u;
+      px[0] = screen ? 10 : 220;
+      px[1] = screen ? 170 : 170;
+      px[2] = screen ? 60 : 140;
+      px[3] = 255;
+    }
+  }
+  ChromaKeyer keyer;
+  const KeyerResult result = keyer.apply(frame, KeyerSettings{});
+  if (result.status.activeKeyer != "chroma_key" || result.status.fallbackActive ||
+      result.mask.width != frame.width || result.mask.height != frame.height ||
+      result.mask.timestampNs != frame.timestampNs || result.status.inferenceMs < 0.0) {
+    return fail("chroma keyer status or mask geometry is wrong");
+  }
+  for (uint32_t y = 0; y < frame.height; ++y) {
+    for (uint32_t x = 0; x < frame.width; ++x) {
+      const uint8_t expected = x < frame.width / 2u ? 0u : 255u;
+      if (result.mask.alpha[static_cast<size_t>(y) * frame.width + x] != expected) {
+        return fail("mask wrong at " + std::to_string(x) + "," + std::to_string(y));
+      }
+    }
+  }
+  VideoFrame empty;
+  if (!keyer.apply(empty, KeyerSettings{}).status.fallbackActive) {
+    return fail("an empty frame must fall back");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkClassification() || !checkMatchesReference() || !checkSpill() || !checkKeyerFrame()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "chroma keyer ok (" << broadify::meeting::chromaKeyerSimdPath() << ")" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#include "keyer/clean_plate_keyer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using broadify::meeting::CleanPlateKeyer;
+using broadify::meeting::KeyerResult;
+using broadify::meeting::KeyerSettings;
+using broadify::meeting::VideoFrame;
+using broadify::meeting::cleanPlateDifferenceRow;
+
+namespace {
+
+constexpr uint32_t kWidth = 640;
+constexpr uint32_t kHeight = 360;
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+// Straight from the definition in clean_plate_keyer.h.
+void referenceRow(const uint8_t *rgba, uint8_t *plate, uint8_t *noise, uint8_t *alpha, uint8_t *difference,
+                  size_t pixels, uint16_t low, uint16_t softness, bool updatePlate) {
+  for (size_t i = 0; i < pixels; ++i) {
+    const uint8_t *px = rgba + i * 4u;
+    uint8_t *ref = plate + i * 4u;
+    int distance = 0;
+    for (int c = 0; c < 3; ++c) {
+      distance += std::abs(px[c] - ref[c]);
+    }
+    const int threshold = std::min<int>(low + 2 * noise[i], 0xFFFF);
+    const int over = std::clamp(distance - threshold, 0, static_cast<int>(softness));
+    alpha[i] = static_cast<uint8_t>(over * 255 / softness);
+    difference[i] = static_cast<uint8_t>(std::min(distance, 255));
+    if (!updatePlate || alpha[i] != 0u) {
+      continue;
+    }
+    for (int c = 0; c < 4; ++c) {
+      ref[c] = static_cast<uint8_t>(ref[c] + (px[c] > ref[c]) - (px[c] < ref[c]));
+    }
+    noise[i] = static_cast<uint8_t>(noise[i] + (difference[i] > noise[i]) - (difference[i] < noise[i]));
+  }
+}
+
+bool checkMatchesReference() {
+  std::mt19937 rng(117);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<int> small(0, 40);
+  for (size_t pixels = 1; pixels <= 67; pixels += 3) {
+    for (const uint16_t low : {uint16_t{0}, uint16_t{26}, uint16_t{300}, uint16_t{0xFFF0}}) {
+      for (const uint16_t softness : {uint16_t{1}, uint16_t{7}, uint16_t{26}, uint16_t{255}}) {
+        std::vector<uint8_t> rgba(pixels * 4u);
+        std::vector<uint8_t> plate(pixels * 4u);
+        std::vector<uint8_t> noise(pixels);
+        for (size_t i = 0; i < rgba.size(); ++i) {
+          plate[i] = static_cast<uint8_t>(byte(rng));
+          // Mostly near the plate so both branches of the update run.
+          rgba[i] = static_cast<uint8_t>(i % 5u == 0u ? byte(rng) : std::clamp(plate[i] + small(rng) - 20, 0, 255));
+        }
+        for (uint8_t &value : noise) {
+          value = static_cast<uint8_t>(byte(rng));
+        }
+        for (const bool update : {false, true}) {
+          std::vector<uint8_t> plateA = plate;
+          std::vector<uint8_t> plateB = plate;
+          std::vector<uint8_t> noiseA = noise;
+          std::vector<uint8_t> noiseB = noise;
+          std::vector<uint8_t> alphaA(pixels), alphaB(pixels), diffA(pixels), diffB(pixels);
+          cleanPlateDifferenceRow(rgba.data(), plateA.data(), noiseA.data(), alphaA.data(), diffA.data(), pixels,
+                                  low, softness, update);
+          referenceRow(rgba.data(), plateB.data(), noiseB.data(), alphaB.data(), diffB.data(), pixels, low,
+                       softness, update);
+          if (alphaA != alphaB || diffA != diffB || plateA != plateB || noiseA != noiseB) {
+            return fail("difference row mismatch at pixels=" + std::to_string(pixels) +
+                        " low=" + std::to_string(low) + " softness=" + std::to_string(softness) +
+                        " update=" + std::to_string(update));
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Gradient wall with a fine texture, optionally brightened and with a
+// saturated square in the middle third.
+VideoFrame room(uint64_t timestampNs, int brightness, bool presenter) {
+  VideoFrame frame;
+  frame.width = kWidth;
+  frame.height = kHeight;
+  frame.timestampNs = timestampNs;
+  frame.rgba.resize(static_cast<size_t>(kWidth) * kHeight * 4u);
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      uint8_t *px = frame.rgba.data() + (static_cast<size_t>(y) * kWidth + x) * 4u;
+      const bool inside = presenter && x >= kWidth / 3u && x < 2u * kWidth / 3u && y >= kHeight / 3u &&
+                          y < 2u * kHeight / 3u;
+      const int texture = static_cast<int>((x * 7u + y * 13u) % 9u);
+      const int base[3] = {60 + static_cast<int>(x / 8u) + texture, 80 + static_cast<int>(y / 6u), 110 - texture};
+      for (int c = 0; c < 3; ++c) {
+        px[c] = static_cast<uint8_t>(std::clamp((inside ? (c == 0 ? 240 : 20) : base[c]) + brightness, 0, 255));
+      }
+      px[3] = 255;
+    }
+  }
+  return frame;
+}
+
+uint8_t maskAt(const KeyerResult &result, double fx, double fy) {
+  const auto x = static_cast<size_t>(fx * (result.mask.width - 1u));
+  const auto y = static_cast<size_t>(fy * (result.mask.height - 1u));
+  return result.mask.alpha[y * result.mask.width + x];
+}
+
+bool keyedCorrectly(const KeyerResult &result) {
+  for (const double corner : {0.05, 0.95}) {
+    if (maskAt(result, corner, 0.1) != 0u || maskAt(result, corner, 0.9) != 0u) {
+      return false;
+    }
+  }
+  return maskAt(result, 0.5, 0.5) == 255u;
+}
+
+bool checkKeyer() {
+  CleanPlateKeyer keyer;
+  KeyerSettings settings;
+  uint64_t timestamp = 1;
+  KeyerResult result = keyer.apply(room(timestamp++, 0, true), settings);
+  if (!result.status.fallbackActive || result.status.fallbackReason != "clean_plate_missing") {
+    return fail("keyer must fall back until a plate is captured");
+  }
+
+  settings.cleanPlate.plateRevision = 1;
+  result = keyer.apply(room(timestamp++, 0, false), settings);
+  if (result.status.fallbackActive || result.status.activeKeyer != "clean_plate" || result.mask.width != 480u ||
+      result.mask.height != 270u || result.status.inferenceMs < 0.0) {
+    return fail("plate capture must key on the work plane");
+  }
+  if (std::any_of(result.mask.alpha.begin(), result.mask.alpha.end(), [](uint8_t value) { return value != 0u; })) {
+    return fail("the plate frame must key out completely");
+  }
+  result = keyer.apply(room(timestamp++, 0, true), settings);
+  if (!keyedCorrectly(result)) {
+    return fail("presenter must be opaque over a transparent room");
+  }
+
+  // Auto exposure brightens the whole room; the global offset absorbs it
+  // within a couple of frames while the presenter stays opaque.
+  for (int frame = 0; frame < 3; ++frame) {
+    result = keyer.apply(room(timestamp++, 25, true), settings);
+  }
+  if (!keyedCorrectly(result)) {
+    return fail("keyer must recover from a global brightness shift");
+  }
+
+  // An unchanged revision must not recapture the presenter into the plate.
+  result = keyer.apply(room(timestamp++, 0, true), settings);
+  if (maskAt(result, 0.5, 0.5) != 255u) {
+    return fail("an unchanged plate revision must not recapture");
+  }
+
+  // A keyer recreated for another camera ignores requests it has not seen.
+  CleanPlateKeyer switched(settings.cleanPlate.plateRevision);
+  if (switched.apply(room(timestamp++, 0, false), settings).status.fallbackReason != "clean_plate_missing") {
+    return fail("a recreated keyer must wait for a new plate request");
+  }
+
+  VideoFrame empty;
+  if (!keyer.apply(empty, settings).status.fallbackActive) {
+    return fail("an empty frame must fall back");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkMatchesReference() || !checkKeyer()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "clean plate keyer ok" << std::endl;
+  return EXIT_SUCCESS;
+}
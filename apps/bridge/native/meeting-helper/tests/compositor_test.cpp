@@ -0,0 +1,350 @@
+#include "compose/compositor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::AlphaMask;
+using broadify::meeting::CompositorSnapshot;
+using broadify::meeting::CompositorTileCache;
+using broadify::meeting::Options;
+using broadify::meeting::renderProgramFrame;
+using broadify::meeting::RgbaFrameRef;
+using broadify::meeting::VideoFrame;
+
+namespace {
+
+constexpr uint32_t kWidth = 64u;
+constexpr uint32_t kHeight = 36u;
+// Large enough for TileDamageTracker to split into 8 x 5 tiles.
+constexpr uint32_t kSceneWidth = 256u;
+constexpr uint32_t kSceneHeight = 144u;
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+Options outputOptions(uint32_t width = kWidth, uint32_t height = kHeight) {
+  Options options;
+  options.width = width;
+  options.height = height;
+  return options;
+}
+
+// A camera-only program: no keyer, media, graphics or cornerbug.
+CompositorSnapshot cameraOnlySnapshot(bool mirror) {
+  CompositorSnapshot snapshot;
+  snapshot.backgroundMode = "solid_light";
+  snapshot.cameraRender.mirror = mirror;
+  return snapshot;
+}
+
+VideoFrame makeCamera(uint32_t width, uint32_t height, uint8_t alpha) {
+  VideoFrame frame;
+  frame.width = width;
+  frame.height = height;
+  frame.timestampNs = 1u;
+  frame.rgba.resize(static_cast<size_t>(width) * height * 4u);
+  for (size_t i = 0; i < frame.rgba.size(); i += 4u) {
+    frame.rgba[i + 0u] = static_cast<uint8_t>((i * 7u + 3u) & 0xffu);
+    frame.rgba[i + 1u] = static_cast<uint8_t>((i * 13u + 5u) & 0xffu);
+    frame.rgba[i + 2u] = static_cast<uint8_t>((i * 29u + 11u) & 0xffu);
+    frame.rgba[i + 3u] = alpha;
+  }
+  return frame;
+}
+
+// The same program through the full CPU compositor: a fully transparent
+// front graphics frame blends to nothing but rules out the passthrough.
+std::vector<uint8_t> composedReference(const CompositorSnapshot &snapshot, const VideoFrame &camera,
+                                       std::string &backend) {
+  VideoFrame clearGraphics;
+  clearGraphics.width = kWidth;
+  clearGraphics.height = kHeight;
+  clearGraphics.timestampNs = 1u;
+  clearGraphics.rgba.assign(static_cast<size_t>(kWidth) * kHeight * 4u, 0u);
+  std::vector<uint8_t> output(static_cast<size_t>(kWidth) * kHeight * 4u, 0u);
+  backend = renderProgramFrame(outputOptions(), snapshot, &camera, nullptr, nullptr, &clearGraphics, 0u,
+                               RgbaFrameRef(output), nullptr);
+  return output;
+}
+
+// renderProgramFrame on `camera` reports `expectedBackend` and matches the
+// full CPU composition byte for byte.
+bool matchesComposed(const std::string &label, const CompositorSnapshot &snapshot, const VideoFrame &camera,
+                     const std::string &expectedBackend) {
+  std::string referenceBackend;
+  const std::vector<uint8_t> reference = composedReference(snapshot, camera, referenceBackend);
+  if (referenceBackend != "cpu") {
+    // A GPU reference may round differently; the comparison needs the CPU one.
+    std::cout << label << ": skipped, reference rendered on " << referenceBackend << std::endl;
+    return true;
+  }
+  std::vector<uint8_t> output(reference.size(), 0u);
+  const std::string backend = renderProgramFrame(outputOptions(), snapshot, &camera, nullptr, nullptr, nullptr, 0u,
+                                                 RgbaFrameRef(output), nullptr);
+  if (backend != expectedBackend) {
+    return fail(label + ": expected backend " + expectedBackend + ", got " + backend);
+  }
+  for (size_t i = 0; i < output.size(); ++i) {
+    if (output[i] != reference[i]) {
+      const size_t pixel = i / 4u;
+      return fail(label + ": pixel " + std::to_string(pixel % kWidth) + "," + std::to_string(pixel / kWidth) +
+                  " channel " + std::to_string(i % 4u) + " is " + std::to_string(output[i]) + ", composed " +
+                  std::to_string(reference[i]));
+    }
+  }
+  return true;
+}
+
+bool checkPassthroughMatchesComposed() {
+  const VideoFrame camera = makeCamera(kWidth, kHeight, 255u);
+  if (!matchesComposed("unmirrored", cameraOnlySnapshot(false), camera, "passthrough") ||
+      !matchesComposed("mirrored", cameraOnlySnapshot(true), camera, "passthrough")) {
+    return false;
+  }
+
+  // A larger camera zoomed and panned to an output-size crop.
+  const VideoFrame wide = makeCamera(kWidth * 2u, kHeight * 2u, 255u);
+  for (const bool mirror : {false, true}) {
+    CompositorSnapshot zoomed = cameraOnlySnapshot(mirror);
+    zoomed.cameraFraming.zoom = 2.0;
+    zoomed.cameraFraming.centerX = 0.3;
+    zoomed.cameraFraming.centerY = 0.6;
+    if (!matchesComposed(mirror ? "zoomed mirrored" : "zoomed", zoomed, wide, "passthrough")) {
+      return false;
+    }
+  }
+
+  // A centred speaker layout at the largest scale fills a 16:9 frame.
+  CompositorSnapshot speaker = cameraOnlySnapshot(true);
+  speaker.speakerLayout.enabled = true;
+  speaker.speakerLayout.layout = "center";
+  speaker.speakerLayout.scale = 1.5;
+  if (!matchesComposed("full-frame speaker layout", speaker, camera, "passthrough")) {
+    return false;
+  }
+
+  // Translucent camera pixels blend over the background, so such a frame is
+  // composed, not copied.
+  VideoFrame translucent = camera;
+  translucent.rgba[(static_cast<size_t>(kHeight - 1u) * kWidth + 5u) * 4u + 3u] = 128u;
+  for (const bool mirror : {false, true}) {
+    if (!matchesComposed(mirror ? "translucent mirrored" : "translucent", cameraOnlySnapshot(mirror), translucent,
+                         "cpu")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fills `width` x `height` pixels at (x, y) of `frame` with `rgba`.
+void fillRect(VideoFrame &frame, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+              const uint8_t (&rgba)[4]) {
+  for (uint32_t row = y; row < y + height; ++row) {
+    for (uint32_t column = x; column < x + width; ++column) {
+      std::copy(rgba, rgba + 4, frame.rgba.data() + (static_cast<size_t>(row) * frame.width + column) * 4u);
+    }
+  }
+}
+
+// Everything a program frame is rendered from, changed step by step.
+struct SceneInputs {
+  CompositorSnapshot snapshot;
+  VideoFrame camera;
+  AlphaMask mask;
+  VideoFrame back;
+  VideoFrame front;
+};
+
+SceneInputs keyedScene() {
+  SceneInputs scene;
+  scene.snapshot.keyerEnabled = true;
+  scene.snapshot.backgroundMode = "solid_light";
+  scene.snapshot.speakerLayout.enabled = true;
+  scene.snapshot.speakerLayout.layout = "right";
+  scene.snapshot.speakerLayout.scale = 0.5;
+  scene.camera = makeCamera(320u, 180u, 255u);
+  scene.mask.width = 160u;
+  scene.mask.height = 90u;
+  scene.mask.timestampNs = 1u;
+  scene.mask.alpha.resize(static_cast<size_t>(scene.mask.width) * scene.mask.height);
+  for (size_t i = 0; i < scene.mask.alpha.size(); ++i) {
+    scene.mask.alpha[i] = static_cast<uint8_t>(i % scene.mask.width < 40u ? 0u : (i * 5u) & 0xffu);
+  }
+  for (VideoFrame *graphics : {&scene.back, &scene.front}) {
+    graphics->width = kSceneWidth;
+    graphics->height = kSceneHeight;
+    graphics->timestampNs = 1u;
+    graphics->rgba.assign(static_cast<size_t>(kSceneWidth) * kSceneHeight * 4u, 0u);
+  }
+  fillRect(scene.back, 8u, 8u, 100u, 60u, {20u, 60u, 160u, 255u});
+  fillRect(scene.front, 16u, 100u, 120u, 30u, {200u, 40u, 40u, 180u});
+  return scene;
+}
+
+// Renders `scene` once with `cache` and once from scratch. The two must
+// match byte for byte; returns the number of tiles the cached render drew,
+// or -1 on a mismatch.
+int renderAgainstFull(const std::string &label, const SceneInputs &scene, uint64_t frameIndex,
+                      CompositorTileCache &cache, std::string &backend) {
+  const Options options = outputOptions(kSceneWidth, kSceneHeight);
+  std::vector<uint8_t> incremental(static_cast<size_t>(kSceneWidth) * kSceneHeight * 4u, 0u);
+  std::vector<uint8_t> full(incremental.size(), 0u);
+  backend = renderProgramFrame(options, scene.snapshot, &scene.camera, &scene.mask, &scene.back, &scene.front,
+                               frameIndex, RgbaFrameRef(incremental), &cache);
+  const std::string fullBackend = renderProgramFrame(options, scene.snapshot, &scene.camera, &scene.mask,
+                                                     &scene.back, &scene.front, frameIndex, RgbaFrameRef(full),
+                                                     nullptr);
+  if (backend != fullBackend) {
+    fail(label + ": backends differ, " + backend + " and " + fullBackend);
+    return -1;
+  }
+  for (size_t i = 0; i < full.size(); ++i) {
+    if (incremental[i] != full[i]) {
+      const size_t pixel = i / 4u;
+      fail(label + ": pixel " + std::to_string(pixel % kSceneWidth) + "," + std::to_string(pixel / kSceneWidth) +
+           " channel " + std::to_string(i % 4u) + " is " + std::to_string(incremental[i]) + ", full render " +
+           std::to_string(full[i]));
+      return -1;
+    }
+  }
+  return static_cast<int>(cache.recomposedTiles);
+}
+
+bool checkIncrementalMatchesFull() {
+  SceneInputs scene = keyedScene();
+  CompositorTileCache cache;
+  std::string backend;
+  uint64_t frameIndex = 0u;
+  if (renderAgainstFull("first frame", scene, frameIndex, cache, backend) < 0) {
+    return false;
+  }
+  if (backend != "cpu") {
+    std::cout << "incremental: skipped, rendered on " << backend << std::endl;
+    return true;
+  }
+  const int totalTiles = static_cast<int>(cache.totalTiles);
+
+  // Each step must match a full render; the local ones redraw only part of
+  // the frame, unchanged inputs redraw nothing.
+  struct Step {
+    std::string label;
+    bool partial;
+  };
+  const auto check = [&](const Step &step) {
+    const int drawn = renderAgainstFull(step.label, scene, ++frameIndex, cache, backend);
+    if (drawn < 0) {
+      return false;
+    }
+    if (step.partial && (drawn == 0 || drawn >= totalTiles)) {
+      return fail(step.label + ": recomposed " + std::to_string(drawn) + " of " + std::to_string(totalTiles) +
+                  " tiles");
+    }
+    return true;
+  };
+
+  if (!check({"unchanged", false}) || cache.recomposedTiles != 0u) {
+    return fail("unchanged inputs recomposed " + std::to_string(cache.recomposedTiles) + " tiles");
+  }
+
+  fillRect(scene.camera, 250u, 120u, 24u, 20u, {255u, 255u, 0u, 255u});
+  scene.camera.timestampNs = 2u;
+  if (!check({"camera pixels", true})) {
+    return false;
+  }
+
+  std::fill(scene.mask.alpha.begin() + 60 * scene.mask.width, scene.mask.alpha.begin() + 64 * scene.mask.width, 255u);
+  scene.mask.timestampNs = 2u;
+  if (!check({"camera mask", true})) {
+    return false;
+  }
+
+  fillRect(scene.front, 16u, 100u, 60u, 30u, {0u, 0u, 0u, 0u});
+  scene.front.timestampNs = 2u;
+  if (!check({"front graphics", true})) {
+    return false;
+  }
+
+  fillRect(scene.back, 8u, 8u, 100u, 20u, {240u, 200u, 10u, 128u});
+  scene.back.timestampNs = 2u;
+  if (!check({"back graphics", true})) {
+    return false;
+  }
+
+  // Moving or resizing the camera rect redraws the frame.
+  scene.snapshot.speakerLayout.layout = "left";
+  if (!check({"layout side", false})) {
+    return false;
+  }
+  scene.snapshot.speakerLayout.scale = 0.75;
+  if (!check({"layout scale", false})) {
+    return false;
+  }
+  scene.snapshot.cameraRender.mirror = true;
+  if (!check({"mirror", false})) {
+    return false;
+  }
+
+  // Back to small edits on the new layout.
+  fillRect(scene.camera, 200u, 60u, 24u, 20u, {0u, 255u, 255u, 255u});
+  scene.camera.timestampNs = 3u;
+  return check({"camera pixels after relayout", true});
+}
+
+// A graphics frame at half the output size is scaled up; its translucent
+// edge must blend toward the graphic's own colour, never toward the black of
+// the transparent pixels around it.
+bool checkScaledGraphicsEdges() {
+  VideoFrame graphics;
+  graphics.width = kWidth / 2u;
+  graphics.height = kHeight / 2u;
+  graphics.timestampNs = 1u;
+  graphics.rgba.assign(static_cast<size_t>(graphics.width) * graphics.height * 4u, 0u);
+  fillRect(graphics, 12u, 5u, 8u, 8u, {255u, 255u, 255u, 255u});
+
+  CompositorSnapshot snapshot = cameraOnlySnapshot(false);
+  snapshot.cameraRender.enabled = false;
+  for (const bool front : {false, true}) {
+    std::vector<uint8_t> output(static_cast<size_t>(kWidth) * kHeight * 4u, 0u);
+    const std::string backend =
+        renderProgramFrame(outputOptions(), snapshot, nullptr, nullptr, front ? nullptr : &graphics,
+                           front ? &graphics : nullptr, 0u, RgbaFrameRef(output), nullptr);
+    if (backend != "cpu") {
+      std::cout << "scaled graphics: skipped, rendered on " << backend << std::endl;
+      return true;
+    }
+    // solid_light background; white over it can only get lighter.
+    const uint8_t background[3] = {232u, 236u, 229u};
+    bool blendedEdge = false;
+    for (size_t i = 0; i < output.size(); i += 4u) {
+      for (size_t c = 0; c < 3u; ++c) {
+        if (output[i + c] < background[c]) {
+          const size_t pixel = i / 4u;
+          return fail(std::string(front ? "front" : "back") + " graphics: dark fringe at " +
+                      std::to_string(pixel % kWidth) + "," + std::to_string(pixel / kWidth));
+        }
+      }
+      blendedEdge = blendedEdge || (output[i] > background[0] && output[i] < 255u);
+    }
+    const uint8_t *centre = output.data() + (static_cast<size_t>(18u) * kWidth + 32u) * 4u;
+    if (centre[0] != 255u || centre[1] != 255u || centre[2] != 255u || !blendedEdge) {
+      return fail(std::string(front ? "front" : "back") + " graphics: scaled block not drawn");
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkPassthroughMatchesComposed() || !checkIncrementalMatchesFull() || !checkScaledGraphicsEdges()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "compositor ok" << std::endl;
+  return EXIT_SUCCESS;
+}
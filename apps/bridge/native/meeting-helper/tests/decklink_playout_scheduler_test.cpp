@@ -0,0 +1,169 @@
+#include "playout_scheduler.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using broadify::decklink::ConvertedFrame;
+using broadify::decklink::PlayoutCompletion;
+using broadify::decklink::PlayoutFormat;
+using broadify::decklink::PlayoutScheduler;
+using broadify::decklink::PlayoutSink;
+using broadify::decklink::PlayoutStats;
+
+constexpr uint32_t kArgb = 0x32;  // stand-ins for BMDPixelFormat FourCCs
+constexpr uint32_t kBgra = 0x42475241;
+
+struct Scheduled {
+  uint64_t seq;
+  int64_t streamTime;
+  const uint8_t* pixels;
+  const void* deviceFrame;
+};
+
+class MockSink : public PlayoutSink {
+public:
+  MockSink(uint32_t pixelFormat, bool legalRange, int64_t duration) : duration_(duration) {
+    format_.pixelFormat = pixelFormat;
+    format_.legalRange = legalRange;
+  }
+
+  PlayoutFormat format() const override { return format_; }
+  int64_t frameDuration() const override { return duration_; }
+  bool schedule(const ConvertedFrame& frame, int64_t streamTime) override {
+    if (failNext) {
+      failNext = false;
+      return false;
+    }
+    scheduled.push_back({frame.seq, streamTime, frame.pixels.data(), frame.deviceFrame.get()});
+    return true;
+  }
+  bool start() override {
+    ++starts;
+    return true;
+  }
+
+  std::vector<Scheduled> scheduled;
+  int starts = 0;
+  bool failNext = false;
+
+private:
+  PlayoutFormat format_;
+  int64_t duration_ = 0;
+};
+
+bool check(bool condition, const char *message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+  }
+  return condition;
+}
+
+}  // namespace
+
+int main() {
+  constexpr int kWidth = 8;
+  constexpr int kHeight = 2;
+  int conversions = 0;
+  int allocations = 0;
+  bool failConversion = false;
+  PlayoutScheduler scheduler(
+      kWidth, kHeight, 3, 4,
+      [&](const uint8_t* rgba, int width, int height, const PlayoutFormat& format, ConvertedFrame& out) {
+        if (failConversion) {
+          return false;
+        }
+        ++conversions;
+        if (out.pixels.capacity() == 0) {
+          ++allocations;
+        }
+        out.rowBytes = width * 4;
+        out.pixels.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+        out.pixels[0] = static_cast<uint8_t>(format.pixelFormat);
+        // Like the DeckLink converter: a new device frame per conversion.
+        out.deviceFrame = std::make_shared<uint64_t>(out.seq);
+        return true;
+      });
+
+  // Fill and program share ARGB/legal; the confidence output wants full-range BGRA.
+  MockSink fill(kArgb, true, 1001);
+  MockSink program(kArgb, true, 1001);
+  MockSink confidence(kBgra, false, 1000);
+  const size_t fillIndex = scheduler.addOutput(&fill);
+  const size_t programIndex = scheduler.addOutput(&program);
+  const size_t confidenceIndex = scheduler.addOutput(&confidence);
+
+  bool ok = true;
+  ok &= check(scheduler.outputCount() == 3 && scheduler.formatCount() == 2, "formats were not deduplicated");
+
+  std::vector<uint8_t> source(static_cast<size_t>(kWidth) * kHeight * 4, 7u);
+  uint64_t seq = 0;
+  for (int i = 0; i < 2; ++i) {
+    ok &= check(scheduler.submit(source.data(), ++seq), "submit failed");
+  }
+  ok &= check(fill.starts == 0 && fill.scheduled.size() == 2, "started before preroll completed");
+  ok &= check(scheduler.submit(source.data(), ++seq), "submit failed");
+  ok &= check(fill.starts == 1 && program.starts == 1 && confidence.starts == 1, "preroll did not start every output");
+  ok &= check(conversions == 6, "frames were converted more than once per format");
+  ok &= check(fill.scheduled[2].streamTime == 2002 && confidence.scheduled[2].streamTime == 2000,
+              "stream time is not tracked per output");
+  ok &= check(fill.scheduled[0].pixels == program.scheduled[0].pixels &&
+                  fill.scheduled[0].pixels != confidence.scheduled[0].pixels,
+              "outputs with the same format do not share the converted frame");
+  ok &= check(fill.scheduled[0].deviceFrame == program.scheduled[0].deviceFrame &&
+                  fill.scheduled[0].deviceFrame != fill.scheduled[1].deviceFrame,
+              "outputs with the same format do not share the device frame");
+
+  // Running outputs are fed from their completion callbacks only.
+  ok &= check(scheduler.submit(source.data(), ++seq) && fill.scheduled.size() == 3, "running output scheduled early");
+  scheduler.onCompleted(fillIndex, PlayoutCompletion::kCompleted);
+  ok &= check(fill.scheduled.size() == 4 && fill.scheduled[3].seq == 4u && program.scheduled.size() == 3,
+              "completion did not schedule the next queued frame");
+
+  // Underrun repeats the last frame on that output only.
+  scheduler.onCompleted(fillIndex, PlayoutCompletion::kLate);
+  ok &= check(fill.scheduled.size() == 5 && fill.scheduled[4].seq == 4u, "underrun did not repeat the last frame");
+  PlayoutStats fillStats = scheduler.stats(fillIndex);
+  ok &= check(fillStats.repeated == 1 && fillStats.late == 1 && fillStats.completed == 2, "fill stats are wrong");
+
+  // A slow output drops its oldest queued frames; the others are unaffected.
+  for (int i = 0; i < 5; ++i) {
+    scheduler.submit(source.data(), ++seq);
+  }
+  const PlayoutStats programStats = scheduler.stats(programIndex);
+  ok &= check(programStats.superseded == 2 && programStats.scheduled == 3, "queue overflow not accounted per output");
+  scheduler.onCompleted(programIndex, PlayoutCompletion::kDropped);
+  ok &= check(program.scheduled.back().seq == 6u && scheduler.stats(programIndex).dropped == 1,
+              "program did not resume from its oldest retained frame");
+
+  // A failed schedule is counted and the next completion carries on.
+  confidence.failNext = true;
+  scheduler.onCompleted(confidenceIndex, PlayoutCompletion::kCompleted);
+  scheduler.onCompleted(confidenceIndex, PlayoutCompletion::kCompleted);
+  ok &= check(scheduler.stats(confidenceIndex).scheduleFailures == 1 && confidence.scheduled.back().seq == 7u,
+              "schedule failure was not isolated");
+
+  failConversion = true;
+  const size_t before = fill.scheduled.size();
+  ok &= check(!scheduler.submit(source.data(), ++seq), "failed conversion was accepted");
+  scheduler.onCompleted(fillIndex, PlayoutCompletion::kCompleted);
+  ok &= check(fill.scheduled.size() == before + 1 && fill.scheduled.back().seq != seq,
+              "failed conversion reached an output");
+  failConversion = false;
+
+  // Converted buffers are recycled once every output released them.
+  const int allocationsBefore = allocations;
+  for (int i = 0; i < 40; ++i) {
+    scheduler.submit(source.data(), ++seq);
+    scheduler.onCompleted(fillIndex, PlayoutCompletion::kCompleted);
+    scheduler.onCompleted(programIndex, PlayoutCompletion::kCompleted);
+    scheduler.onCompleted(confidenceIndex, PlayoutCompletion::kCompleted);
+  }
+  ok &= check(allocations == allocationsBefore, "steady-state playout allocated new frame buffers");
+  ok &= check(scheduler.conversions() == static_cast<uint64_t>(conversions), "conversion count mismatch");
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include "pipeline/display_camera.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+using broadify::meeting::AlphaMask;
+using broadify::meeting::DisplayCameraFrame;
+using broadify::meeting::VideoFrame;
+using broadify::meeting::quantizedDisplayScale;
+using broadify::meeting::shrinkMaskToDisplay;
+
+namespace {
+
+constexpr uint32_t kCameraWidth = 1280u;
+constexpr uint32_t kCameraHeight = 720u;
+// The subject edge, as a fraction of the frame width.
+constexpr double kEdge = 0.5;
+
+bool near(double value, double expected) {
+  return std::abs(value - expected) < 1e-9;
+}
+
+// Dark subject left of kEdge, bright background right of it.
+VideoFrame makeCamera() {
+  VideoFrame camera;
+  camera.width = kCameraWidth;
+  camera.height = kCameraHeight;
+  camera.timestampNs = 7u;
+  camera.rgba.resize(static_cast<size_t>(kCameraWidth) * kCameraHeight * 4u);
+  for (uint32_t y = 0; y < kCameraHeight; ++y) {
+    for (uint32_t x = 0; x < kCameraWidth; ++x) {
+      uint8_t *pixel = camera.rgba.data() + (static_cast<size_t>(y) * kCameraWidth + x) * 4u;
+      const uint8_t luma = x < kCameraWidth * kEdge ? 16u : 240u;
+      pixel[0] = luma;
+      pixel[1] = luma;
+      pixel[2] = luma;
+      pixel[3] = 255u;
+    }
+  }
+  return camera;
+}
+
+// Keyer-resolution mask of the same subject.
+AlphaMask makeMask(uint32_t width, uint32_t height) {
+  AlphaMask mask;
+  mask.width = width;
+  mask.height = height;
+  mask.timestampNs = 7u;
+  mask.alpha.resize(static_cast<size_t>(width) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      mask.alpha[static_cast<size_t>(y) * width + x] = x < width * kEdge ? 255u : 0u;
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+
+int main() {
+  // Scales round up to sixteenths, never below one step.
+  if (!near(quantizedDisplayScale(0.3), 5.0 / 16.0) || !near(quantizedDisplayScale(0.5), 0.5) ||
+      !near(quantizedDisplayScale(0.51), 9.0 / 16.0) || !near(quantizedDisplayScale(0.0), 1.0 / 16.0) ||
+      !near(quantizedDisplayScale(-1.0), 1.0 / 16.0)) {
+    std::cerr << "display scale not quantized to sixteenths" << std::endl;
+    return 1;
+  }
+  // Up to 0.75 a step is kept; anything that rounds above it is full size.
+  if (!near(quantizedDisplayScale(0.75), 0.75) || !near(quantizedDisplayScale(0.7501), 1.0) ||
+      !near(quantizedDisplayScale(0.76), 1.0) || !near(quantizedDisplayScale(2.0), 1.0)) {
+    std::cerr << "display scale cutoff above 0.75 not applied" << std::endl;
+    return 2;
+  }
+
+  // Near full size the camera is used as is and the mask is left alone.
+  VideoFrame camera = makeCamera();
+  DisplayCameraFrame display;
+  if (&display.update(camera, 0.8, nullptr) != &camera) {
+    std::cerr << "near-full-size camera was copied" << std::endl;
+    return 3;
+  }
+  AlphaMask fullSize = makeMask(kCameraWidth / 2u, kCameraHeight / 2u);
+  shrinkMaskToDisplay(fullSize, kCameraWidth, quantizedDisplayScale(0.8));
+  if (fullSize.width != kCameraWidth / 2u || fullSize.height != kCameraHeight / 2u) {
+    std::cerr << "mask shrunk at full display size" << std::endl;
+    return 4;
+  }
+
+  // Shrunk masks and the display frame cover the same pixels at every step:
+  // a mask larger than the display frame comes out at its size, a smaller
+  // one keeps its own, and the subject edge lands in the same place.
+  for (const double requested : {0.1, 0.3, 0.5, 0.7}) {
+    const double scale = quantizedDisplayScale(requested);
+    const VideoFrame &frame = display.update(camera, scale, nullptr);
+    const uint32_t frameEdge = static_cast<uint32_t>(frame.width * kEdge);
+    const size_t frameRow = static_cast<size_t>(frame.height / 2u) * frame.width;
+    if (frame.rgba[(frameRow + frameEdge - 1u) * 4u] != 16u || frame.rgba[(frameRow + frameEdge) * 4u] != 240u) {
+      std::cerr << "scale " << scale << ": display frame edge moved" << std::endl;
+      return 5;
+    }
+    for (const uint32_t maskDivisor : {1u, 2u}) {
+      AlphaMask mask = makeMask(kCameraWidth / maskDivisor, kCameraHeight / maskDivisor);
+      const uint32_t keyerWidth = mask.width;
+      shrinkMaskToDisplay(mask, kCameraWidth, scale);
+      const uint32_t expectedWidth = std::min(keyerWidth, frame.width);
+      if (mask.width != expectedWidth || static_cast<uint64_t>(mask.height) * frame.width !=
+                                             static_cast<uint64_t>(frame.height) * mask.width ||
+          mask.timestampNs != camera.timestampNs) {
+        std::cerr << "scale " << scale << ": mask " << mask.width << "x" << mask.height << " for a "
+                  << frame.width << "x" << frame.height << " display frame" << std::endl;
+        return 6;
+      }
+      const uint32_t maskEdge = static_cast<uint32_t>(mask.width * kEdge);
+      const size_t maskRow = static_cast<size_t>(mask.height / 2u) * mask.width;
+      if (mask.alpha[maskRow + maskEdge - 1u] != 255u || mask.alpha[maskRow + maskEdge] != 0u) {
+        std::cerr << "scale " << scale << ": mask edge diverges from the display frame" << std::endl;
+        return 7;
+      }
+    }
+  }
+
+  // A mask already at or below the display size is not touched.
+  AlphaMask small = makeMask(64u, 36u);
+  shrinkMaskToDisplay(small, kCameraWidth, 0.25);
+  if (small.width != 64u || small.height != 36u) {
+    std::cerr << "small mask resized" << std::endl;
+    return 8;
+  }
+
+  std::cout << "display camera test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,175 @@
+/* Compiled as C so the public header stays consumable from C hosts. */
+#include "broadify_meeting.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+#define WIDTH 320u
+#define HEIGHT 180u
+#define FRAMEBUS_NAME "broadify-meeting-embed-test"
+
+typedef struct frame_probe {
+  atomic_uint frames;
+  atomic_uint bad_frames;
+  atomic_uint corner_pixel;
+} frame_probe_t;
+
+static void sleep_ms(unsigned ms) {
+#if defined(_WIN32)
+  Sleep(ms);
+#else
+  struct timespec delay;
+  delay.tv_sec = ms / 1000u;
+  delay.tv_nsec = (long)(ms % 1000u) * 1000000L;
+  nanosleep(&delay, NULL);
+#endif
+}
+
+static void on_frame(const broadify_meeting_frame_t *frame, void *user_data) {
+  frame_probe_t *probe = (frame_probe_t *)user_data;
+  if (frame->rgba == NULL || frame->width != WIDTH || frame->height != HEIGHT ||
+      frame->size != (size_t)WIDTH * HEIGHT * 4u) {
+    atomic_fetch_add(&probe->bad_frames, 1u);
+    return;
+  }
+  unsigned pixel = 0u;
+  memcpy(&pixel, frame->rgba, sizeof(pixel));
+  atomic_store(&probe->corner_pixel, pixel);
+  atomic_fetch_add(&probe->frames, 1u);
+}
+
+static void on_metrics(const broadify_meeting_metrics_t *metrics, void *user_data) {
+  atomic_uint *calls = (atomic_uint *)user_data;
+  if (metrics->rendered_frames > 0u) {
+    atomic_fetch_add(calls, 1u);
+  }
+}
+
+/* Waits up to two seconds for `counter` to exceed `value`. */
+static int wait_beyond(atomic_uint *counter, unsigned value) {
+  for (int i = 0; i < 200; ++i) {
+    if (atomic_load(counter) > value) {
+      return 1;
+    }
+    sleep_ms(10u);
+  }
+  return 0;
+}
+
+static int fail(const char *message) {
+  fprintf(stderr, "%s\n", message);
+  return EXIT_FAILURE;
+}
+
+int main(void) {
+  if (broadify_meeting_api_version() != BROADIFY_MEETING_API_VERSION) {
+    return fail("api version mismatch");
+  }
+  broadify_meeting_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.width = WIDTH;
+  config.height = HEIGHT;
+  config.fps = 30u;
+  /* FrameBus output needs a name of its own: the default belongs to the
+   * standalone helper. */
+  config.framebus_output = 1;
+  if (broadify_meeting_create(&config) != NULL) {
+    return fail("framebus output without a name must be rejected");
+  }
+  config.framebus_output = 0;
+  config.framebus_name = FRAMEBUS_NAME;
+  broadify_meeting_t *meeting = broadify_meeting_create(&config);
+  if (meeting == NULL) {
+    return fail("create failed");
+  }
+
+  frame_probe_t probe;
+  atomic_init(&probe.frames, 0u);
+  atomic_init(&probe.bad_frames, 0u);
+  atomic_init(&probe.corner_pixel, 0u);
+  atomic_uint metrics_calls;
+  atomic_init(&metrics_calls, 0u);
+  if (broadify_meeting_set_frame_callback(meeting, on_frame, &probe) != 0 ||
+      broadify_meeting_set_metrics_callback(meeting, on_metrics, &metrics_calls, 50u) != 0 ||
+      broadify_meeting_start(meeting) != 0) {
+    return fail("start failed");
+  }
+
+  /* Without a camera the frame callback alone keeps the program rendering. */
+  if (!wait_beyond(&probe.frames, 0u)) {
+    return fail("no program frame was delivered");
+  }
+
+#if !defined(_WIN32)
+  /* With FrameBus output off the engine never creates its segment. */
+  const int segment = shm_open("/" FRAMEBUS_NAME, O_RDONLY, 0);
+  if (segment >= 0) {
+    return fail("framebus segment created while output is off");
+  }
+#endif
+
+  /* A typed update reaches the next frame: an opaque background replaces the
+   * transparent default. */
+  if (broadify_meeting_set_background(meeting, "solid_light", NULL) != 0) {
+    return fail("set_background failed");
+  }
+  const unsigned char expected[4] = {232u, 236u, 229u, 255u};
+  int updated = 0;
+  for (int i = 0; i < 200 && !updated; ++i) {
+    const unsigned pixel = atomic_load(&probe.corner_pixel);
+    updated = memcmp(&pixel, expected, sizeof(expected)) == 0;
+    sleep_ms(10u);
+  }
+  if (!updated) {
+    return fail("background update did not reach the delivered frame");
+  }
+
+  uint64_t revision = 0u;
+  if (broadify_meeting_set_cornerbug(meeting, 1, 0.9, 0.1, 0.1) != 0 ||
+      broadify_meeting_update_program(meeting, "camera", "{\"enabled\":true,\"mirror\":true}", 1, &revision) != 0 ||
+      revision == 0u) {
+    return fail("program update failed");
+  }
+  if (broadify_meeting_update_program(meeting, "nonsense", "{}", 0, NULL) != -1 ||
+      broadify_meeting_update_program(meeting, "camera", "[1]", 0, NULL) != -1 ||
+      broadify_meeting_set_keyer(meeting, 1, "nonsense") != -1 ||
+      broadify_meeting_set_background(meeting, "nonsense", NULL) != -1 ||
+      broadify_meeting_set_background(meeting, "", NULL) != -1) {
+    return fail("invalid updates must be rejected");
+  }
+
+  if (!wait_beyond(&metrics_calls, 0u)) {
+    return fail("no metrics were delivered");
+  }
+  broadify_meeting_metrics_t metrics;
+  if (broadify_meeting_get_metrics(meeting, &metrics) != 0 || metrics.rendered_frames == 0u ||
+      metrics.camera_running != 0) {
+    return fail("metrics do not reflect the rendered frames");
+  }
+
+  /* Once removed, the callback is never called again. */
+  broadify_meeting_set_frame_callback(meeting, NULL, NULL);
+  const unsigned frames = atomic_load(&probe.frames);
+  sleep_ms(100u);
+  if (atomic_load(&probe.frames) != frames || atomic_load(&probe.bad_frames) != 0u) {
+    return fail("frames after the callback was removed");
+  }
+
+  broadify_meeting_stop(meeting);
+  if (broadify_meeting_start(meeting) != -1) {
+    return fail("a stopped engine must not restart");
+  }
+  broadify_meeting_destroy(meeting);
+  printf("embed api ok\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,284 @@
+#include "recorder/frame_recorder.h"
+#include "util/jpeg_encode.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using broadify::meeting::FrameRecorder;
+using broadify::meeting::FrameRecorderOptions;
+using broadify::meeting::FrameRecorderStats;
+using broadify::meeting::RecorderCodec;
+using broadify::meeting::jpegEncoderAvailable;
+
+namespace {
+
+constexpr uint32_t kWidth = 64;
+constexpr uint32_t kHeight = 36;
+constexpr uint32_t kFrames = 40;
+
+constexpr uint32_t kSegment = 0x18538067u;
+constexpr uint32_t kCluster = 0x1F43B675u;
+constexpr uint32_t kCues = 0x1C53BB6Bu;
+constexpr uint32_t kTimestamp = 0xE7u;
+constexpr uint32_t kSimpleBlock = 0xA3u;
+constexpr uint64_t kUnknownSize = ~uint64_t{0};
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+struct Reader {
+  const std::vector<uint8_t> &bytes;
+  size_t pos = 0;
+
+  bool readId(uint32_t &id) {
+    if (pos >= bytes.size()) {
+      return false;
+    }
+    size_t length = 1;
+    while (length <= 4u && (bytes[pos] & (0x80u >> (length - 1u))) == 0u) {
+      ++length;
+    }
+    if (length > 4u || pos + length > bytes.size()) {
+      return false;
+    }
+    id = 0;
+    for (size_t i = 0; i < length; ++i) {
+      id = (id << 8) | bytes[pos + i];
+    }
+    pos += length;
+    return true;
+  }
+
+  bool readSize(uint64_t &size) {
+    if (pos >= bytes.size()) {
+      return false;
+    }
+    size_t length = 1;
+    while (length <= 8u && (bytes[pos] & (0x80u >> (length - 1u))) == 0u) {
+      ++length;
+    }
+    if (length > 8u || pos + length > bytes.size()) {
+      return false;
+    }
+    uint64_t value = bytes[pos] & ((0x80u >> (length - 1u)) - 1u);
+    bool allOnes = value == ((0x80u >> (length - 1u)) - 1u);
+    for (size_t i = 1; i < length; ++i) {
+      value = (value << 8) | bytes[pos + i];
+      allOnes = allOnes && bytes[pos + i] == 0xFFu;
+    }
+    pos += length;
+    size = allOnes ? kUnknownSize : value;
+    return true;
+  }
+};
+
+struct ParsedFile {
+  uint64_t segmentSize = 0;
+  size_t segmentDataOffset = 0;
+  std::vector<int64_t> timestamps;
+  std::vector<std::vector<uint8_t>> payloads;
+  bool hasCues = false;
+};
+
+// Walks EBML header, Segment, top-level elements and unknown-size clusters
+// the way a player would.
+bool parseMkv(const std::vector<uint8_t> &bytes, ParsedFile &parsed) {
+  Reader reader{bytes};
+  uint32_t id = 0;
+  uint64_t size = 0;
+  if (!reader.readId(id) || id != 0x1A45DFA3u || !reader.readSize(size)) {
+    return fail("missing EBML header");
+  }
+  reader.pos += size;
+  if (!reader.readId(id) || id != kSegment || !reader.readSize(size) || size == kUnknownSize) {
+    return fail("missing finalized Segment");
+  }
+  parsed.segmentSize = size;
+  parsed.segmentDataOffset = reader.pos;
+  const size_t end = reader.pos + size;
+  if (end != bytes.size()) {
+    return fail("Segment size does not match the file");
+  }
+  int64_t clusterTimestamp = -1;
+  while (reader.pos < end) {
+    if (!reader.readId(id) || !reader.readSize(size)) {
+      return fail("truncated element");
+    }
+    if (id == kCluster) {
+      if (size != kUnknownSize) {
+        return fail("clusters are expected to be streamed with unknown size");
+      }
+      clusterTimestamp = -1;
+      continue;  // children follow inline
+    }
+    if (id == kTimestamp) {
+      int64_t value = 0;
+      for (uint64_t i = 0; i < size; ++i) {
+        value = (value << 8) | bytes[reader.pos + i];
+      }
+      clusterTimestamp = value;
+    } else if (id == kSimpleBlock) {
+      if (clusterTimestamp < 0 || size < 4u || bytes[reader.pos] != 0x81u || (bytes[reader.pos + 3] & 0x80u) == 0u) {
+        return fail("malformed SimpleBlock");
+      }
+      const int16_t relative = static_cast<int16_t>((bytes[reader.pos + 1] << 8) | bytes[reader.pos + 2]);
+      parsed.timestamps.push_back(clusterTimestamp + relative);
+      parsed.payloads.emplace_back(bytes.begin() + static_cast<std::ptrdiff_t>(reader.pos + 4u),
+                                   bytes.begin() + static_cast<std::ptrdiff_t>(reader.pos + size));
+    } else if (id == kCues) {
+      parsed.hasCues = true;
+    }
+    reader.pos += size;
+  }
+  return true;
+}
+
+std::vector<uint8_t> readFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+uint8_t framePixel(uint32_t frame, size_t index) {
+  return static_cast<uint8_t>((frame * 7u + index * 13u) & 0xFFu);
+}
+
+bool recordAndVerify(RecorderCodec codec, const std::string &path) {
+  FrameRecorderOptions options;
+  options.width = kWidth;
+  options.height = kHeight;
+  options.fps = 30;
+  options.codec = codec;
+  options.bufferedFrames = 4;
+  options.encoderThreads = 3;
+  // Small chunks so the recording spans several writes and a partial one.
+  options.writeChunkBytes = 64u << 10;
+  options.writeChunks = 2;
+  FrameRecorder recorder(options);
+  std::string error;
+  if (!recorder.open(path, error)) {
+    return fail("open failed: " + error);
+  }
+
+  uint32_t queued = 0;
+  for (uint32_t frame = 0; frame < kFrames; ++frame) {
+    // The capture thread never blocks: retry a dropped frame like the next
+    // FrameBus frame would arrive.
+    while (true) {
+      const FrameRecorder::PushResult result =
+          recorder.push(static_cast<int64_t>(frame) * 33, [frame](uint8_t *rgba, size_t stride) {
+            for (uint32_t y = 0; y < kHeight; ++y) {
+              for (size_t x = 0; x < kWidth * 4u; ++x) {
+                rgba[y * stride + x] = framePixel(frame, y * kWidth * 4u + x);
+              }
+            }
+            return true;
+          });
+      if (result == FrameRecorder::PushResult::kQueued) {
+        ++queued;
+        break;
+      }
+    }
+  }
+  // The encoder threads may still hold every buffer: wait for one like the
+  // frames above, so the failed copy is what decides the result.
+  bool copyAttempted = false;
+  FrameRecorder::PushResult failedCopy = FrameRecorder::PushResult::kDropped;
+  while (failedCopy == FrameRecorder::PushResult::kDropped) {
+    failedCopy = recorder.push(5000, [&copyAttempted](uint8_t *, size_t) {
+      copyAttempted = true;
+      return false;
+    });
+  }
+  if (failedCopy != FrameRecorder::PushResult::kSkipped || !copyAttempted) {
+    return fail("a frame whose copy failed must be skipped");
+  }
+  if (!recorder.finish(kFrames * 33)) {
+    return fail("finish reported an error: " + recorder.stats().error);
+  }
+
+  const FrameRecorderStats stats = recorder.stats();
+  const std::vector<uint8_t> bytes = readFile(path);
+  if (stats.framesWritten != queued || stats.encodeFailures != 0u || stats.bytesWritten != bytes.size()) {
+    return fail("stats disagree with the file");
+  }
+  ParsedFile parsed;
+  if (!parseMkv(bytes, parsed)) {
+    return false;
+  }
+  if (parsed.timestamps.size() != kFrames || !parsed.hasCues) {
+    return fail("expected " + std::to_string(kFrames) + " blocks and cues, found " +
+                std::to_string(parsed.timestamps.size()));
+  }
+  for (uint32_t frame = 0; frame < kFrames; ++frame) {
+    if (parsed.timestamps[frame] != static_cast<int64_t>(frame) * 33) {
+      return fail("frames out of capture order");
+    }
+    const std::vector<uint8_t> &payload = parsed.payloads[frame];
+    if (codec == RecorderCodec::kRaw) {
+      if (payload.size() != kWidth * kHeight * 4u || payload[5] != framePixel(frame, 5) ||
+          payload.back() != framePixel(frame, payload.size() - 1u)) {
+        return fail("raw frame payload mismatch");
+      }
+    } else if (payload.size() < 4u || payload[0] != 0xFFu || payload[1] != 0xD8u) {
+      return fail("MJPEG payload is not a JPEG");
+    }
+  }
+  return true;
+}
+
+// Per-process file names, so concurrent runs in one directory do not write
+// the same file.
+std::string recordingPath(const std::string &codec) {
+#if defined(_WIN32)
+  const int pid = _getpid();
+#else
+  const int pid = static_cast<int>(getpid());
+#endif
+  return "frame_recorder_test_" + codec + "_" + std::to_string(pid) + ".mkv";
+}
+
+}  // namespace
+
+int main() {
+  const std::string rawPath = recordingPath("raw");
+  if (!recordAndVerify(RecorderCodec::kRaw, rawPath)) {
+    return EXIT_FAILURE;
+  }
+  std::remove(rawPath.c_str());
+
+  if (jpegEncoderAvailable()) {
+    const std::string mjpegPath = recordingPath("mjpeg");
+    if (!recordAndVerify(RecorderCodec::kMjpeg, mjpegPath)) {
+      return EXIT_FAILURE;
+    }
+    std::remove(mjpegPath.c_str());
+  }
+
+  // Writing into a directory that does not exist fails at open.
+  FrameRecorderOptions options;
+  options.width = kWidth;
+  options.height = kHeight;
+  FrameRecorder recorder(options);
+  std::string error;
+  if (recorder.open("missing-directory/recording.mkv", error) || error.empty()) {
+    std::cerr << "open into a missing directory must fail" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "frame recorder ok" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#include "framebus_reader.h"
+#include "framebus_writer.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kWidth = 37u;  // odd width exercises the SIMD tails
+constexpr uint32_t kHeight = 11u;
+
+uint8_t sourceByte(uint32_t x, uint32_t y, uint32_t channel) {
+  return static_cast<uint8_t>(x * 7u + y * 13u + channel * 61u);
+}
+
+bool check(bool condition, const char *message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+  }
+  return condition;
+}
+
+}  // namespace
+
+int main() {
+  const std::string name = "bfy-meet-copy-test";
+  framebus_writer_t *writer = framebus_writer_open(name.c_str(), kWidth, kHeight, 30u, 3u);
+  if (writer == nullptr) {
+    std::cerr << "could not create FrameBus segment" << std::endl;
+    return 1;
+  }
+  framebus_reader_t *reader = framebus_reader_open(name.c_str());
+  if (reader == nullptr) {
+    framebus_writer_close(writer);
+    std::cerr << "could not open FrameBus segment" << std::endl;
+    return 1;
+  }
+
+  std::vector<uint8_t> frame(static_cast<size_t>(kWidth) * kHeight * 4u);
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      for (uint32_t c = 0; c < 4u; ++c) {
+        frame[(static_cast<size_t>(y) * kWidth + x) * 4u + c] = sourceByte(x, y, c);
+      }
+    }
+  }
+
+  bool ok = true;
+  // Destination byte i of each pixel is source channel kOrder[format][i].
+  const uint32_t kOrder[4][4] = {{0, 1, 2, 3}, {2, 1, 0, 3}, {3, 0, 1, 2}, {3, 2, 1, 0}};
+  const framebus_copy_rect_t crop{3u, 2u, 29u, 7u};
+  for (uint32_t format = 0; format < 4u; ++format) {
+    for (int useCrop = 0; useCrop < 2; ++useCrop) {
+      if (framebus_writer_write_rgba(writer, frame.data(), frame.size(), 1u) != 0) {
+        std::cerr << "write failed" << std::endl;
+        return 1;
+      }
+      const framebus_copy_rect_t rect = useCrop != 0 ? crop : framebus_copy_rect_t{0u, 0u, kWidth, kHeight};
+      // Padded destination stride; the padding must stay untouched.
+      const size_t stride = static_cast<size_t>(rect.width) * 4u + 12u;
+      std::vector<uint8_t> dst(stride * rect.height, 0xEEu);
+      uint64_t lastSeq = 0u;
+      const int result = framebus_reader_copy_latest_region(
+          reader, dst.data(), stride, static_cast<framebus_copy_format_t>(format), useCrop != 0 ? &rect : nullptr,
+          &lastSeq);
+      ok &= check(result == 1 && lastSeq > 0u, "region copy failed");
+      for (uint32_t y = 0; ok && y < rect.height; ++y) {
+        for (uint32_t x = 0; ok && x < rect.width; ++x) {
+          for (uint32_t c = 0; c < 4u; ++c) {
+            const uint8_t expected = sourceByte(rect.x + x, rect.y + y, kOrder[format][c]);
+            ok &= check(dst[y * stride + x * 4u + c] == expected, "swizzled pixel mismatch");
+          }
+        }
+        for (size_t pad = rect.width * 4u; ok && pad < stride; ++pad) {
+          ok &= check(dst[y * stride + pad] == 0xEEu, "row padding was overwritten");
+        }
+      }
+    }
+  }
+
+  std::vector<uint8_t> dst(static_cast<size_t>(kWidth) * kHeight * 4u);
+  uint64_t lastSeq = 0u;
+  const framebus_copy_rect_t outside{30u, 0u, 8u, 1u};
+  const framebus_copy_rect_t empty{0u, 0u, 0u, 4u};
+  ok &= check(framebus_reader_copy_latest_region(reader, dst.data(), kWidth * 4u, FRAMEBUS_COPY_RGBA8, &outside,
+                                                 &lastSeq) == -1,
+              "rect outside the frame was accepted");
+  ok &= check(framebus_reader_copy_latest_region(reader, dst.data(), kWidth * 4u, FRAMEBUS_COPY_RGBA8, &empty,
+                                                 &lastSeq) == -1,
+              "empty rect was accepted");
+  ok &= check(framebus_reader_copy_latest_region(reader, dst.data(), kWidth * 4u - 4u, FRAMEBUS_COPY_RGBA8, nullptr,
+                                                 &lastSeq) == -1,
+              "short destination stride was accepted");
+  ok &= check(framebus_reader_copy_latest_region(reader, dst.data(), kWidth * 4u, static_cast<framebus_copy_format_t>(9),
+                                                 nullptr, &lastSeq) == -1,
+              "unknown format was accepted");
+
+  // The legacy entry points are wrappers over the region copy.
+  ok &= check(framebus_reader_copy_latest_bgra(reader, dst.data(), kWidth * 4u, &lastSeq) == 1 &&
+                  dst[0] == sourceByte(0, 0, 2) && dst[2] == sourceByte(0, 0, 0),
+              "bgra wrapper did not swizzle");
+  ok &= check(framebus_reader_copy_latest_rgba(reader, dst.data(), kWidth * 4u, &lastSeq) == 0,
+              "unchanged seq copied again");
+
+  framebus_reader_close(reader);
+  framebus_writer_close(writer);
+  return ok ? 0 : 1;
+}
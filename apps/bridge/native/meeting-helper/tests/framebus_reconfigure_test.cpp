@@ -0,0 +1,208 @@
+#include "framebus.h"
+#include "framebus_reader.h"
+#include "framebus_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool writeFrame(framebus_writer_t *writer, uint32_t width, uint32_t height, uint8_t value) {
+  const std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4u, value);
+  return framebus_writer_write_rgba(writer, frame.data(), frame.size(), 1u) == 0;
+}
+
+// The header check the DeckLink and display helpers run on their own
+// mappings: any geometry field or the retired flag departing from what was
+// mapped means reopen.
+bool segmentCheckFollowsHeader() {
+  FrameBusHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = FRAMEBUS_MAGIC_LE;
+  header.width = 64u;
+  header.height = 36u;
+  header.frame_size = 64u * 36u * 4u;
+  header.slot_count = 3u;
+  header.slot_stride = header.frame_size;
+  const FrameBusSegmentGeometry opened = framebus_segment_geometry(&header);
+  if (framebus_segment_stale(&header, &opened)) {
+    std::cerr << "a live segment was reported stale" << std::endl;
+    return false;
+  }
+  header.seq = 42u;
+  if (framebus_segment_stale(&header, &opened)) {
+    std::cerr << "publishing a frame made the segment stale" << std::endl;
+    return false;
+  }
+  FrameBusHeader resized = header;
+  resized.width = 32u;
+  FrameBusHeader reslotted = header;
+  reslotted.slot_count = 4u;
+  FrameBusHeader retired = header;
+  retired.flags |= FRAMEBUS_FLAG_RETIRED;
+  if (!framebus_segment_stale(&resized, &opened) || !framebus_segment_stale(&reslotted, &opened) ||
+      !framebus_segment_stale(&retired, &opened)) {
+    std::cerr << "a retired or reconfigured segment was not reported stale" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Reopening the name while a reader still maps the segment, with nothing
+// about the geometry changing (an fps-only reconfigure): the old segment
+// must stay retired with its frames intact, never be re-initialised under
+// the reader, and a fresh reader must land on the new segment.
+bool reopenWhileReaderAttached(const std::string &name) {
+  framebus_writer_t *writer = framebus_writer_open(name.c_str(), 32u, 18u, 30u, 3u);
+  framebus_reader_t *attached = framebus_reader_open(name.c_str());
+  if (writer == nullptr || attached == nullptr || !writeFrame(writer, 32u, 18u, 5u) ||
+      !writeFrame(writer, 32u, 18u, 6u)) {
+    std::cerr << "could not set up the attached reader" << std::endl;
+    return false;
+  }
+  framebus_writer_close(writer);
+  writer = framebus_writer_open(name.c_str(), 32u, 18u, 60u, 3u);
+  if (writer == nullptr || !writeFrame(writer, 32u, 18u, 7u)) {
+    std::cerr << "could not reopen the segment under an attached reader" << std::endl;
+    return false;
+  }
+  std::vector<uint8_t> dst(32u * 18u * 4u, 0u);
+  uint64_t lastSeq = 0u;
+  if (framebus_reader_seq(attached) != 2u ||
+      framebus_reader_copy_latest_rgba(attached, dst.data(), 32u * 4u, &lastSeq) != -3) {
+    std::cerr << "segment under the attached reader was re-initialised (seq "
+              << framebus_reader_seq(attached) << ")" << std::endl;
+    return false;
+  }
+  framebus_reader_close(attached);
+
+  framebus_reader_t *reader = framebus_reader_open(name.c_str());
+  uint32_t fps = 0u;
+  lastSeq = 0u;
+  if (reader == nullptr || framebus_reader_get_info(reader, nullptr, nullptr, &fps) != 0 || fps != 60u ||
+      framebus_reader_copy_latest_rgba(reader, dst.data(), 32u * 4u, &lastSeq) != 1 || dst[0] != 7u) {
+    std::cerr << "reopened reader did not follow the replacement segment" << std::endl;
+    return false;
+  }
+  framebus_reader_close(reader);
+  framebus_writer_close(writer);
+  return true;
+}
+
+// Readers find a writer that had to move to a later generation name (what a
+// Windows writer does while the previous segment is still mapped), and prefer
+// generation 0 once it is live again.
+bool readerFindsLaterGeneration(const std::string &name) {
+  char generationName[128];
+  framebus_generation_name(name.c_str(), 2u, generationName, sizeof(generationName));
+  if (std::string(generationName) != name + ".2") {
+    std::cerr << "unexpected generation name " << generationName << std::endl;
+    return false;
+  }
+  framebus_writer_t *moved = framebus_writer_open(generationName, 32u, 18u, 24u, 3u);
+  framebus_reader_t *reader = framebus_reader_open(name.c_str());
+  uint32_t fps = 0u;
+  if (moved == nullptr || reader == nullptr || framebus_reader_get_info(reader, nullptr, nullptr, &fps) != 0 ||
+      fps != 24u) {
+    std::cerr << "reader did not find the segment under a later generation" << std::endl;
+    return false;
+  }
+  framebus_reader_close(reader);
+
+  framebus_writer_t *base = framebus_writer_open(name.c_str(), 32u, 18u, 50u, 3u);
+  reader = framebus_reader_open(name.c_str());
+  if (base == nullptr || reader == nullptr || framebus_reader_get_info(reader, nullptr, nullptr, &fps) != 0 ||
+      fps != 50u) {
+    std::cerr << "reader skipped a live generation 0" << std::endl;
+    return false;
+  }
+  framebus_reader_close(reader);
+  framebus_writer_close(base);
+  framebus_writer_close(moved);
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!segmentCheckFollowsHeader() || !reopenWhileReaderAttached("bfy-meet-reconfigure-attached-test") ||
+      !readerFindsLaterGeneration("bfy-meet-reconfigure-generation-test")) {
+    return 1;
+  }
+  const std::string name = "bfy-meet-reconfigure-test";
+  framebus_writer_t *writer = framebus_writer_open(name.c_str(), 64u, 36u, 30u, 3u);
+  if (writer == nullptr) {
+    std::cerr << "could not create FrameBus segment" << std::endl;
+    return 1;
+  }
+  framebus_reader_t *reader = framebus_reader_open(name.c_str());
+  if (reader == nullptr) {
+    framebus_writer_close(writer);
+    std::cerr << "could not open FrameBus segment" << std::endl;
+    return 1;
+  }
+
+  std::vector<uint8_t> dst(64u * 36u * 4u, 0u);
+  uint64_t lastSeq = 0u;
+  if (!writeFrame(writer, 64u, 36u, 17u) ||
+      framebus_reader_copy_latest_rgba(reader, dst.data(), 64u * 4u, &lastSeq) != 1 ||
+      dst[0] != 17u) {
+    std::cerr << "initial frame did not round-trip" << std::endl;
+    return 1;
+  }
+
+  // Reconfigure: the writer drops the segment and recreates it smaller. A
+  // reader still mapping the old segment must be told to reopen instead of
+  // silently holding the last frame.
+  framebus_writer_close(writer);
+  writer = framebus_writer_open(name.c_str(), 32u, 18u, 25u, 4u);
+  if (writer == nullptr) {
+    std::cerr << "could not recreate FrameBus segment" << std::endl;
+    return 1;
+  }
+  if (framebus_reader_copy_latest_rgba(reader, dst.data(), 64u * 4u, &lastSeq) != -3) {
+    std::cerr << "retired segment was not reported to the reader" << std::endl;
+    return 1;
+  }
+  framebus_reader_close(reader);
+
+  reader = framebus_reader_open(name.c_str());
+  uint32_t width = 0u;
+  uint32_t height = 0u;
+  uint32_t fps = 0u;
+  if (reader == nullptr || framebus_reader_get_info(reader, &width, &height, &fps) != 0 ||
+      width != 32u || height != 18u || fps != 25u) {
+    std::cerr << "reopened reader did not pick up the new geometry" << std::endl;
+    return 1;
+  }
+  lastSeq = 0u;
+  if (!writeFrame(writer, 32u, 18u, 99u) ||
+      framebus_reader_copy_latest_rgba(reader, dst.data(), 32u * 4u, &lastSeq) != 1 ||
+      dst[0] != 99u) {
+    std::cerr << "frame after reconfigure did not round-trip" << std::endl;
+    return 1;
+  }
+
+  // Zero-copy path: render into the acquired slot, then publish it.
+  size_t slotSize = 0u;
+  uint8_t *slot = framebus_writer_acquire(writer, &slotSize);
+  if (slot == nullptr || slotSize != 32u * 18u * 4u) {
+    std::cerr << "acquire returned an unexpected slot" << std::endl;
+    return 1;
+  }
+  std::fill(slot, slot + slotSize, static_cast<uint8_t>(123u));
+  if (framebus_writer_commit(writer, 2u) != 0 || framebus_writer_latest(writer) != slot ||
+      framebus_reader_copy_latest_rgba(reader, dst.data(), 32u * 4u, &lastSeq) != 1 ||
+      dst[0] != 123u) {
+    std::cerr << "committed slot did not reach the reader" << std::endl;
+    return 1;
+  }
+
+  framebus_reader_close(reader);
+  framebus_writer_close(writer);
+  return 0;
+}
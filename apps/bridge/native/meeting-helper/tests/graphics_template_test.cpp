@@ -0,0 +1,211 @@
+#include "compose/font_face.h"
+#include "compose/graphics_template.h"
+#include "util/json_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::GraphicsElementType;
+using broadify::meeting::GraphicsState;
+using broadify::meeting::GraphicsTemplateRenderer;
+using broadify::meeting::ProgramFields;
+using broadify::meeting::buildGraphicsElements;
+using broadify::meeting::fontRenderingAvailable;
+using broadify::meeting::splitObjectMembers;
+
+namespace {
+
+constexpr uint32_t kWidth = 640u;
+constexpr uint32_t kHeight = 360u;
+
+GraphicsState nativeGraphics(const std::string &templateName, const std::string &json) {
+  GraphicsState graphics;
+  graphics.enabled = true;
+  graphics.source = "native";
+  graphics.templateName = templateName;
+  graphics.fields = ProgramFields(json);
+  return graphics;
+}
+
+void patch(GraphicsState &graphics, const std::string &json, uint64_t revision) {
+  ProgramFields::Members members;
+  splitObjectMembers(json, members);
+  graphics.fields.patch(members, revision);
+}
+
+std::vector<uint8_t> solidFrame(uint8_t r, uint8_t g, uint8_t b) {
+  std::vector<uint8_t> frame(static_cast<size_t>(kWidth) * kHeight * 4u);
+  for (size_t i = 0; i < frame.size(); i += 4u) {
+    frame[i] = r;
+    frame[i + 1u] = g;
+    frame[i + 2u] = b;
+    frame[i + 3u] = 255u;
+  }
+  return frame;
+}
+
+bool near(double value, double expected) {
+  return std::abs(value - expected) < 1e-6;
+}
+
+const uint8_t *pixelAt(const std::vector<uint8_t> &frame, uint32_t x, uint32_t y) {
+  return frame.data() + (static_cast<size_t>(y) * kWidth + x) * 4u;
+}
+
+}  // namespace
+
+int main() {
+  const std::string lowerThird =
+      "{\"title\":\"Jane Doe\",\"subtitle\":\"Caf\\u00e9 host\",\"x\":0.1,\"y\":0.7,\"width\":0.5,\"height\":0.2,"
+      "\"background_color\":\"#102030\"}";
+
+  // The template expands to panel, accent bar, title and subtitle in frame
+  // pixels, with JSON escapes decoded.
+  GraphicsState graphics = nativeGraphics("lower_third", lowerThird);
+  const auto elements = buildGraphicsElements(graphics, kWidth, kHeight);
+  if (elements.size() != 4u || elements[0].type != GraphicsElementType::kRect || !near(elements[0].x, 64.0) ||
+      !near(elements[0].y, 252.0) || !near(elements[0].width, 320.0) || !near(elements[0].height, 72.0) ||
+      elements[3].type != GraphicsElementType::kText || elements[3].text != "Caf\xc3\xa9 host") {
+    std::cerr << "lower third expanded incorrectly" << std::endl;
+    return 1;
+  }
+
+  GraphicsTemplateRenderer renderer;
+  renderer.update(graphics, kWidth, kHeight);
+  std::vector<uint8_t> frame = solidFrame(0u, 0u, 0u);
+  renderer.draw(frame);
+  // Opaque panel away from the text, untouched frame outside it.
+  const uint8_t *panel = pixelAt(frame, 66u, 321u);
+  const uint8_t *outside = pixelAt(frame, 10u, 10u);
+  if (panel[0] != 0x10u || panel[1] != 0x20u || panel[2] != 0x30u || outside[0] != 0u || outside[3] != 255u) {
+    std::cerr << "panel not drawn as a hard opaque fill" << std::endl;
+    return 2;
+  }
+
+  const bool text = fontRenderingAvailable() && renderer.stats().rasterizedGlyphs > 0u;
+  if (text) {
+    // Title glyphs land inside the panel in the (default, dark) title colour.
+    bool inked = false;
+    for (uint32_t y = 252u; y < 324u && !inked; ++y) {
+      for (uint32_t x = 64u; x < 384u && !inked; ++x) {
+        const uint8_t *pixel = pixelAt(frame, x, y);
+        inked = pixel[0] != 0x10u || pixel[1] != 0x20u || pixel[2] != 0x30u;
+      }
+    }
+    if (!inked) {
+      std::cerr << "no text drawn into the lower third" << std::endl;
+      return 3;
+    }
+  } else {
+    std::cout << "no font backend; text checks skipped" << std::endl;
+  }
+
+  // Changing the title repaints only the title region, reusing cached glyphs
+  // when the text comes back.
+  patch(graphics, "{\"title\":\"Jane Smith\"}", 1u);
+  renderer.update(graphics, kWidth, kHeight);
+  const uint64_t titleRepaint = renderer.stats().repaintedPixels;
+  if (text && (titleRepaint == 0u || titleRepaint >= 320u * 72u)) {
+    std::cerr << "title edit repainted " << titleRepaint << " pixels" << std::endl;
+    return 4;
+  }
+  const uint64_t glyphsBefore = renderer.stats().rasterizedGlyphs;
+  patch(graphics, "{\"title\":\"Jane Doe\"}", 2u);
+  renderer.update(graphics, kWidth, kHeight);
+  if (renderer.stats().rasterizedGlyphs != glyphsBefore) {
+    std::cerr << "previously drawn glyphs were rasterized again" << std::endl;
+    return 5;
+  }
+
+  // An unchanged revision is a no-op, and the incrementally updated layer
+  // matches a from-scratch render of the same state.
+  const uint64_t updates = renderer.stats().updates;
+  renderer.update(graphics, kWidth, kHeight);
+  if (renderer.stats().updates != updates) {
+    return 6;
+  }
+  std::vector<uint8_t> incremental = solidFrame(40u, 90u, 200u);
+  renderer.draw(incremental);
+  GraphicsTemplateRenderer fresh;
+  fresh.update(nativeGraphics("lower_third", lowerThird), kWidth, kHeight);
+  std::vector<uint8_t> reference = solidFrame(40u, 90u, 200u);
+  fresh.draw(reference);
+  if (incremental != reference) {
+    std::cerr << "incremental repaint differs from a full render" << std::endl;
+    return 7;
+  }
+
+  // Custom translucent rect: premultiplied over an opaque frame, exact.
+  GraphicsState custom = nativeGraphics(
+      "", "{\"elements\":[{\"type\":\"rect\",\"x\":0.25,\"y\":0.25,\"width\":0.5,\"height\":0.5,"
+          "\"color\":\"#FF000050\"}]}");
+  GraphicsTemplateRenderer overlay;
+  overlay.update(custom, kWidth, kHeight);
+  std::vector<uint8_t> blue = solidFrame(0u, 0u, 255u);
+  overlay.draw(blue);
+  for (uint32_t x = 160u; x < 480u; ++x) {
+    const uint8_t *pixel = pixelAt(blue, x, 180u);
+    if (pixel[0] != 80u || pixel[1] != 0u || pixel[2] != 175u || pixel[3] != 255u) {
+      std::cerr << "translucent rect blended incorrectly at x=" << x << std::endl;
+      return 8;
+    }
+  }
+  if (pixelAt(blue, 159u, 180u)[0] != 0u || pixelAt(blue, 480u, 180u)[0] != 0u) {
+    std::cerr << "rect spilled outside its bounds" << std::endl;
+    return 9;
+  }
+
+  // Removing every element clears what was drawn.
+  ProgramFields::Members members;
+  splitObjectMembers("{\"elements\":[]}", members);
+  custom.fields.replace(members, 1u);
+  overlay.update(custom, kWidth, kHeight);
+  std::vector<uint8_t> cleared = solidFrame(0u, 0u, 255u);
+  overlay.draw(cleared);
+  if (cleared != solidFrame(0u, 0u, 255u) || overlay.stats().elements != 0u) {
+    std::cerr << "removed elements left pixels behind" << std::endl;
+    return 10;
+  }
+
+  // An image hanging off the left edge keeps its scale: its visible columns
+  // match the same 8 x 8 image drawn fully on-frame, 128 px further right.
+  const std::string png =
+      "data:image/png;base64,"
+      "iVBORw0KGgoAAAANSUhEUgAAAAgAAAAICAYAAADED76LAAAAs0lEQVR4nA3KoYECUQxF0S8QCMQIxAjEFwjkSAQiEomggIgtAIlMAYgtIZIy"
+      "IraQdHL3iePOGGMwxcQlJKWkZYypMHfY3OPzQMyFnEdqrvQ8KZiC7TFbcFsJm6RdKNtouyq4gh8wX3E/E76RfqP8TvtTIRRiwWLisRFhZDyocD"
+      "peCqmQRywveN6IfJD5Q+Wbzo9CKdSK1YbXnSgn603VL11fhVboE9ZXvJ9Ev8j+UP2l+49/LN2EAVVGb0oAAAAASUVORK5CYII=";
+  const auto imageAt = [&png](const std::string &x) {
+    return nativeGraphics("", "{\"elements\":[{\"type\":\"image\",\"x\":" + x +
+                                  ",\"y\":0.2,\"width\":0.2,\"height\":0.2,\"image_data_url\":\"" + png + "\"}]}");
+  };
+  GraphicsTemplateRenderer clippedImage;
+  clippedImage.update(imageAt("-0.1"), kWidth, kHeight);
+  std::vector<uint8_t> clippedFrame = solidFrame(0u, 0u, 0u);
+  clippedImage.draw(clippedFrame);
+  if (clippedFrame == solidFrame(0u, 0u, 0u)) {
+    std::cout << "no image decoder; image checks skipped" << std::endl;
+  } else {
+    GraphicsTemplateRenderer wholeImage;
+    wholeImage.update(imageAt("0.1"), kWidth, kHeight);
+    std::vector<uint8_t> wholeFrame = solidFrame(0u, 0u, 0u);
+    wholeImage.draw(wholeFrame);
+    // The fitted 72 x 72 box spans x = -36..36 and 92..164, y = 72..144.
+    for (uint32_t y = 72u; y < 144u; ++y) {
+      for (uint32_t x = 0u; x < 36u; ++x) {
+        const uint8_t *clippedPixel = pixelAt(clippedFrame, x, y);
+        const uint8_t *wholePixel = pixelAt(wholeFrame, x + 128u, y);
+        if (!std::equal(clippedPixel, clippedPixel + 4, wholePixel)) {
+          std::cerr << "off-frame image rescaled at " << x << "," << y << std::endl;
+          return 11;
+        }
+      }
+    }
+  }
+
+  std::cout << "graphics template test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,123 @@
+#include "util/image_resample.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using broadify::meeting::ConstImagePlane;
+using broadify::meeting::ImagePlane;
+using broadify::meeting::ResampleFilter;
+using broadify::meeting::ResampleRegion;
+using broadify::meeting::resampleImage;
+
+namespace {
+
+constexpr ResampleFilter kFilters[] = {
+    ResampleFilter::kNearest, ResampleFilter::kBilinear, ResampleFilter::kArea,
+    ResampleFilter::kBicubic, ResampleFilter::kLanczos3,
+};
+
+std::vector<uint8_t> resampled(const std::vector<uint8_t> &src, uint32_t srcWidth, uint32_t srcHeight,
+                               uint32_t channels, uint32_t dstWidth, uint32_t dstHeight,
+                               ResampleFilter filter, ResampleRegion region = {}) {
+  std::vector<uint8_t> dst(static_cast<size_t>(dstWidth) * dstHeight * channels, 0);
+  resampleImage({src.data(), srcWidth, srcHeight, static_cast<size_t>(srcWidth) * channels, channels}, region,
+                {dst.data(), dstWidth, dstHeight, static_cast<size_t>(dstWidth) * channels, channels}, filter);
+  return dst;
+}
+
+}  // namespace
+
+int main() {
+  // Flat colour survives every filter in both directions (weights sum to
+  // exactly one, Lanczos ringing included).
+  const std::vector<uint8_t> flat = [] {
+    std::vector<uint8_t> pixels(97u * 61u * 4u);
+    for (size_t i = 0; i < pixels.size(); i += 4u) {
+      pixels[i] = 200;
+      pixels[i + 1] = 17;
+      pixels[i + 2] = 90;
+      pixels[i + 3] = 255;
+    }
+    return pixels;
+  }();
+  for (const ResampleFilter filter : kFilters) {
+    for (const auto &size : {std::pair<uint32_t, uint32_t>{31u, 19u}, {250u, 130u}}) {
+      const std::vector<uint8_t> out = resampled(flat, 97u, 61u, 4u, size.first, size.second, filter);
+      for (size_t i = 0; i < out.size(); i += 4u) {
+        if (out[i] != 200u || out[i + 1] != 17u || out[i + 2] != 90u || out[i + 3] != 255u) {
+          std::cerr << "flat colour changed by filter " << static_cast<int>(filter) << std::endl;
+          return 1;
+        }
+      }
+    }
+  }
+
+  // Random content: the RGBA path (SIMD) and the single-channel path
+  // (scalar) agree when every channel carries the same plane. The output is
+  // large enough to be split into row bands.
+  std::mt19937 random(3);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<uint8_t> grey(160u * 90u);
+  for (uint8_t &value : grey) {
+    value = static_cast<uint8_t>(byte(random));
+  }
+  std::vector<uint8_t> rgba(grey.size() * 4u);
+  for (size_t i = 0; i < grey.size(); ++i) {
+    rgba[i * 4u] = rgba[i * 4u + 1u] = rgba[i * 4u + 2u] = rgba[i * 4u + 3u] = grey[i];
+  }
+  for (const ResampleFilter filter : kFilters) {
+    for (const auto &size : {std::pair<uint32_t, uint32_t>{640u, 360u}, {57u, 33u}}) {
+      const std::vector<uint8_t> single = resampled(grey, 160u, 90u, 1u, size.first, size.second, filter);
+      const std::vector<uint8_t> quad = resampled(rgba, 160u, 90u, 4u, size.first, size.second, filter);
+      for (size_t i = 0; i < single.size(); ++i) {
+        if (quad[i * 4u] != single[i] || quad[i * 4u + 3u] != single[i]) {
+          std::cerr << "RGBA and grey paths disagree for filter " << static_cast<int>(filter)
+                    << " at " << i << std::endl;
+          return 2;
+        }
+      }
+    }
+  }
+
+  // Exact 2x area downscale is the 2x2 mean (within the one step of rounding
+  // the two passes may add).
+  const std::vector<uint8_t> half = resampled(grey, 160u, 90u, 1u, 80u, 45u, ResampleFilter::kArea);
+  for (uint32_t y = 0; y < 45u; ++y) {
+    for (uint32_t x = 0; x < 80u; ++x) {
+      const int mean = (grey[(2u * y) * 160u + 2u * x] + grey[(2u * y) * 160u + 2u * x + 1u] +
+                        grey[(2u * y + 1u) * 160u + 2u * x] + grey[(2u * y + 1u) * 160u + 2u * x + 1u] + 2) / 4;
+      if (std::abs(half[y * 80u + x] - mean) > 1) {
+        std::cerr << "area downscale is not a box mean" << std::endl;
+        return 3;
+      }
+    }
+  }
+
+  // Scale 1 at an integer offset is a plain crop for every filter.
+  for (const ResampleFilter filter : kFilters) {
+    const std::vector<uint8_t> crop =
+        resampled(grey, 160u, 90u, 1u, 40u, 20u, filter, ResampleRegion{10.0, 5.0, 40.0, 20.0});
+    for (uint32_t y = 0; y < 20u; ++y) {
+      for (uint32_t x = 0; x < 40u; ++x) {
+        if (crop[y * 40u + x] != grey[(y + 5u) * 160u + x + 10u]) {
+          std::cerr << "integer crop is not exact for filter " << static_cast<int>(filter) << std::endl;
+          return 4;
+        }
+      }
+    }
+  }
+
+  // Mismatched channel counts are rejected without touching the output.
+  std::vector<uint8_t> untouched(4u, 7u);
+  if (resampleImage(ConstImagePlane{grey.data(), 160u, 90u, 160u, 1u},
+                    ImagePlane{untouched.data(), 1u, 1u, 4u, 4u}, ResampleFilter::kBilinear) ||
+      untouched[0] != 7u) {
+    return 5;
+  }
+
+  std::cout << "image resample test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,206 @@
+#include "keyer/onnx_rgba_input.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::prependRgbaInputStage;
+
+namespace {
+
+// output = Mul(input, w), opset 11. `w` is an initializer that is also
+// listed as graph input 0 (old exporters do this); `input` is float
+// [batch_size, 3, height, width].
+constexpr uint8_t kTinyModel[] = {
+    0x08, 0x03, 0x12, 0x01, 0x74, 0x3a, 0xb3, 0x01, 0x0a, 0x1e, 0x0a, 0x05,
+    0x69, 0x6e, 0x70, 0x75, 0x74, 0x0a, 0x01, 0x77, 0x12, 0x06, 0x6f, 0x75,
+    0x74, 0x70, 0x75, 0x74, 0x1a, 0x05, 0x73, 0x63, 0x61, 0x6c, 0x65, 0x22,
+    0x03, 0x4d, 0x75, 0x6c, 0x12, 0x04, 0x74, 0x69, 0x6e, 0x79, 0x2a, 0x0d,
+    0x08, 0x01, 0x10, 0x01, 0x42, 0x01, 0x77, 0x4a, 0x04, 0x00, 0x00, 0x00,
+    0x40, 0x5a, 0x0f, 0x0a, 0x01, 0x77, 0x12, 0x0a, 0x0a, 0x08, 0x08, 0x01,
+    0x12, 0x04, 0x0a, 0x02, 0x08, 0x01, 0x5a, 0x34, 0x0a, 0x05, 0x69, 0x6e,
+    0x70, 0x75, 0x74, 0x12, 0x2b, 0x0a, 0x29, 0x08, 0x01, 0x12, 0x25, 0x0a,
+    0x0c, 0x12, 0x0a, 0x62, 0x61, 0x74, 0x63, 0x68, 0x5f, 0x73, 0x69, 0x7a,
+    0x65, 0x0a, 0x02, 0x08, 0x03, 0x0a, 0x08, 0x12, 0x06, 0x68, 0x65, 0x69,
+    0x67, 0x68, 0x74, 0x0a, 0x07, 0x12, 0x05, 0x77, 0x69, 0x64, 0x74, 0x68,
+    0x62, 0x35, 0x0a, 0x06, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x12, 0x2b,
+    0x0a, 0x29, 0x08, 0x01, 0x12, 0x25, 0x0a, 0x0c, 0x12, 0x0a, 0x62, 0x61,
+    0x74, 0x63, 0x68, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x0a, 0x02, 0x08, 0x03,
+    0x0a, 0x08, 0x12, 0x06, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x0a, 0x07,
+    0x12, 0x05, 0x77, 0x69, 0x64, 0x74, 0x68, 0x42, 0x04, 0x0a, 0x00, 0x10,
+    0x0b,
+};
+
+constexpr std::array<float, 3> kMean = {0.25f, 0.5f, 0.75f};
+constexpr std::array<float, 3> kStd = {0.5f, 0.25f, 0.125f};
+
+// Just enough of a protobuf reader to walk the rewritten model: length-
+// delimited fields come back as their payload, varints as their value.
+struct Field {
+  uint32_t number = 0;
+  uint64_t value = 0;
+  std::string bytes;
+};
+
+bool readVarint(const std::string &data, size_t &offset, uint64_t &value) {
+  value = 0;
+  for (uint32_t shift = 0; shift < 64u && offset < data.size(); shift += 7u) {
+    const uint8_t byte = static_cast<uint8_t>(data[offset++]);
+    value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+    if ((byte & 0x80u) == 0u) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<Field> fields(const std::string &message) {
+  std::vector<Field> result;
+  size_t offset = 0;
+  while (offset < message.size()) {
+    uint64_t key = 0;
+    Field field;
+    if (!readVarint(message, offset, key)) {
+      break;
+    }
+    field.number = static_cast<uint32_t>(key >> 3u);
+    const uint32_t wireType = static_cast<uint32_t>(key & 7u);
+    if (wireType == 0u) {
+      readVarint(message, offset, field.value);
+    } else if (wireType == 2u) {
+      uint64_t length = 0;
+      readVarint(message, offset, length);
+      field.bytes = message.substr(offset, static_cast<size_t>(length));
+      offset += static_cast<size_t>(length);
+    } else if (wireType == 5u) {
+      offset += 4u;
+    } else if (wireType == 1u) {
+      offset += 8u;
+    } else {
+      break;
+    }
+    result.push_back(field);
+  }
+  return result;
+}
+
+std::vector<std::string> repeated(const std::string &message, uint32_t number) {
+  std::vector<std::string> values;
+  for (const Field &field : fields(message)) {
+    if (field.number == number) {
+      values.push_back(field.bytes);
+    }
+  }
+  return values;
+}
+
+std::string single(const std::string &message, uint32_t number) {
+  const std::vector<std::string> values = repeated(message, number);
+  return values.empty() ? std::string() : values.front();
+}
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+std::string tinyModel() {
+  return std::string(reinterpret_cast<const char *>(kTinyModel), sizeof(kTinyModel));
+}
+
+bool checkInput(const std::string &graph) {
+  const std::vector<std::string> inputs = repeated(graph, 11u);
+  if (inputs.size() != 2u || single(inputs[0], 1u) != "w" || single(inputs[1], 1u) != "input_rgba8") {
+    return fail("graph inputs must be w, input_rgba8");
+  }
+  const std::string tensorType = single(single(inputs[1], 2u), 1u);
+  uint64_t elementType = 0;
+  for (const Field &field : fields(tensorType)) {
+    if (field.number == 1u) {
+      elementType = field.value;
+    }
+  }
+  if (elementType != 2u) {
+    return fail("input_rgba8 must be uint8");
+  }
+  const std::vector<std::string> dims = repeated(single(tensorType, 2u), 1u);
+  if (dims.size() != 4u || single(dims[0], 2u) != "batch_size" || single(dims[1], 2u) != "height" ||
+      single(dims[2], 2u) != "width" || fields(dims[3]).empty() || fields(dims[3])[0].value != 4u) {
+    return fail("input_rgba8 must be [batch_size, height, width, 4]");
+  }
+  return true;
+}
+
+bool checkNodes(const std::string &graph) {
+  const std::vector<std::string> nodes = repeated(graph, 1u);
+  const std::vector<std::string> expected = {"Constant", "Constant", "Constant", "Gather", "Transpose",
+                                             "Cast",     "Mul",      "Add",      "Mul"};
+  if (nodes.size() != expected.size()) {
+    return fail("expected the eight stage nodes ahead of the model's Mul");
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (single(nodes[i], 4u) != expected[i]) {
+      return fail("node " + std::to_string(i) + " is " + single(nodes[i], 4u) + ", expected " + expected[i]);
+    }
+  }
+  if (single(nodes[7], 2u) != "input" || repeated(nodes[8], 1u) != std::vector<std::string>{"input", "w"}) {
+    return fail("the stage must feed the original input name");
+  }
+  // Constant scale: value attribute -> TensorProto raw_data, 1 / (255 std).
+  const std::string scale = single(single(single(nodes[1], 5u), 5u), 9u);
+  if (scale.size() != 3u * sizeof(float)) {
+    return fail("scale constant must hold three floats");
+  }
+  for (size_t channel = 0; channel < 3u; ++channel) {
+    float value = 0.0f;
+    std::memcpy(&value, scale.data() + channel * sizeof(float), sizeof(float));
+    if (std::fabs(value - 1.0f / (255.0f * kStd[channel])) > 1e-7f) {
+      return fail("scale constant is wrong for channel " + std::to_string(channel));
+    }
+  }
+  return true;
+}
+
+bool checkRewrite() {
+  std::string rewritten;
+  if (!prependRgbaInputStage(tinyModel(), kMean, kStd, rewritten)) {
+    return fail("the tiny model must rewrite");
+  }
+  const std::string graph = single(rewritten, 7u);
+  if (graph.empty() || !checkInput(graph) || !checkNodes(graph)) {
+    return false;
+  }
+  if (single(graph, 5u) != single(single(tinyModel(), 7u), 5u)) {
+    return fail("initializers must be copied unchanged");
+  }
+  std::string twice;
+  if (prependRgbaInputStage(rewritten, kMean, kStd, twice)) {
+    return fail("an RGBA8 input must not be rewritten again");
+  }
+  return true;
+}
+
+bool checkRejects() {
+  std::string rewritten;
+  if (prependRgbaInputStage(std::string(), kMean, kStd, rewritten) ||
+      prependRgbaInputStage("not a model", kMean, kStd, rewritten) ||
+      prependRgbaInputStage(tinyModel().substr(0, 40u), kMean, kStd, rewritten)) {
+    return fail("malformed models must be rejected");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkRewrite() || !checkRejects()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "onnx rgba input ok" << std::endl;
+  return EXIT_SUCCESS;
+}
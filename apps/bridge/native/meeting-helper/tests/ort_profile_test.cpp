@@ -0,0 +1,121 @@
+#include "keyer/ort_profile.h"
+
+#include "util/json_utils.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::extractArrayField;
+using broadify::meeting::extractDoubleField;
+using broadify::meeting::extractIntField;
+using broadify::meeting::extractStringField;
+using broadify::meeting::splitArrayElements;
+using broadify::meeting::summarizeOrtProfile;
+
+namespace {
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+bool near(double actual, double expected) {
+  return std::fabs(actual - expected) < 1e-6;
+}
+
+std::string sessionEvent(const std::string &name, int ts, int dur) {
+  return "{\"cat\":\"Session\",\"pid\":1,\"tid\":1,\"dur\":" + std::to_string(dur) + ",\"ts\":" +
+         std::to_string(ts) + ",\"ph\":\"X\",\"name\":\"" + name + "\",\"args\":{}}";
+}
+
+std::string nodeEvent(const std::string &node, const std::string &suffix, const std::string &op,
+                      const std::string &provider, int ts, int dur) {
+  return "{\"cat\":\"Node\",\"pid\":1,\"tid\":1,\"dur\":" + std::to_string(dur) + ",\"ts\":" + std::to_string(ts) +
+         ",\"ph\":\"X\",\"name\":\"" + node + suffix + "\",\"args\":{\"op_name\":\"" + op +
+         "\",\"provider\":\"" + provider +
+         "\",\"output_size\":\"4096\",\"parameter_size\":\"1728\",\"activation_size\":\"512\"}}";
+}
+
+// One warmup and two counted runs of a three-node graph, in the layout
+// ORT writes: one event per line, fences around every kernel.
+std::string sampleTrace() {
+  std::vector<std::string> events = {sessionEvent("session_initialization", 0, 900)};
+  const int starts[3] = {1000, 2000, 3000};
+  const int convUs[3] = {900, 300, 500};
+  for (int run = 0; run < 3; ++run) {
+    const int t = starts[run];
+    events.push_back(sessionEvent("model_run", t, 800));
+    events.push_back(nodeEvent("Conv_0", "_fence_before", "Conv", "CPUExecutionProvider", t + 1, 0));
+    events.push_back(nodeEvent("Conv_0", "_kernel_time", "Conv", "CPUExecutionProvider", t + 2, convUs[run]));
+    events.push_back(nodeEvent("Conv_0", "_fence_after", "Conv", "CPUExecutionProvider", t + 3, 0));
+    events.push_back(nodeEvent("Conv_1", "_kernel_time", "Conv", "CPUExecutionProvider", t + 4, 100));
+    events.push_back(nodeEvent("Resize_2", "_kernel_time", "Resize", "DmlExecutionProvider", t + 5, 200));
+  }
+  std::string trace = "[\n";
+  for (size_t i = 0; i < events.size(); ++i) {
+    trace += events[i] + (i + 1u < events.size() ? ",\n" : "\n");
+  }
+  return trace + "]\n";
+}
+
+bool checkSummary() {
+  const std::string summary = summarizeOrtProfile(sampleTrace(), 1u);
+  if (summary.empty()) {
+    return fail("a well-formed trace must summarize");
+  }
+  if (extractIntField(summary, "runs", 0) != 2 || extractIntField(summary, "nodes", 0) != 3 ||
+      !near(extractDoubleField(summary, "run_ms_avg", 0.0), 0.8) ||
+      !near(extractDoubleField(summary, "kernel_ms_per_run", 0.0), 0.7)) {
+    return fail("run totals are wrong: " + summary);
+  }
+  std::vector<std::string> operators;
+  if (!splitArrayElements(extractArrayField(summary, "operators"), operators) || operators.size() != 2u) {
+    return fail("expected two operator rows: " + summary);
+  }
+  // Conv: (300 + 500 + 2 * 100) us over two runs, two nodes, sorted first.
+  if (extractStringField(operators[0], "op") != "Conv" ||
+      extractStringField(operators[0], "provider") != "CPUExecutionProvider" ||
+      extractIntField(operators[0], "nodes", 0) != 2 || !near(extractDoubleField(operators[0], "ms_per_run", 0.0), 0.5) ||
+      std::lround(extractDoubleField(operators[0], "percent", 0.0)) != 71 ||
+      extractIntField(operators[0], "output_bytes", 0) != 8192 ||
+      extractIntField(operators[0], "parameter_bytes", 0) != 3456) {
+    return fail("Conv row is wrong: " + operators[0]);
+  }
+  if (extractStringField(operators[1], "op") != "Resize" ||
+      extractStringField(operators[1], "provider") != "DmlExecutionProvider") {
+    return fail("Resize row is wrong: " + operators[1]);
+  }
+  std::vector<std::string> nodes;
+  if (!splitArrayElements(extractArrayField(summary, "top_nodes"), nodes) || nodes.size() != 3u ||
+      extractStringField(nodes[0], "node") != "Conv_0" || !near(extractDoubleField(nodes[0], "ms_per_run", 0.0), 0.4)) {
+    return fail("top nodes are wrong: " + summary);
+  }
+  std::vector<std::string> providers;
+  if (!splitArrayElements(extractArrayField(summary, "providers"), providers) || providers.size() != 2u) {
+    return fail("expected two providers: " + summary);
+  }
+  return true;
+}
+
+bool checkRejects() {
+  if (!summarizeOrtProfile("", 0u).empty() || !summarizeOrtProfile("[{\"cat\":", 0u).empty()) {
+    return fail("malformed traces must not summarize");
+  }
+  if (!summarizeOrtProfile(sampleTrace(), 3u).empty()) {
+    return fail("a trace with only warmup runs must not summarize");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkSummary() || !checkRejects()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "ort profile ok" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+#include "state/program_fields.h"
+#include "state/program_update.h"
+#include "util/json_utils.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::MeetingState;
+using broadify::meeting::ProgramFields;
+using broadify::meeting::ProgramSectionUpdate;
+using broadify::meeting::applyProgramUpdates;
+using broadify::meeting::parseProgramSectionUpdate;
+using broadify::meeting::programSectionJson;
+using broadify::meeting::extractArrayField;
+using broadify::meeting::extractObjectField;
+using broadify::meeting::extractStringField;
+using broadify::meeting::parseDoubleValue;
+using broadify::meeting::parseStringValue;
+using broadify::meeting::splitArrayElements;
+using broadify::meeting::splitObjectMembers;
+
+namespace {
+
+// Parses and applies one program.update request body.
+std::vector<std::string> programUpdate(MeetingState &state, const std::string &body) {
+  std::vector<ProgramSectionUpdate> updates(1u);
+  if (!parseProgramSectionUpdate(body, updates[0]).empty()) {
+    return {"<rejected>"};
+  }
+  applyProgramUpdates(state, updates);
+  return updates[0].changed;
+}
+
+bool sameKeys(const std::vector<std::string> &actual, const std::vector<std::string> &expected) {
+  if (actual != expected) {
+    std::cerr << "changed keys:";
+    for (const std::string &key : actual) {
+      std::cerr << " " << key;
+    }
+    std::cerr << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  // Nested values, escaped quotes and braces inside strings stay one member.
+  ProgramFields::Members members;
+  const std::string section =
+      " {\"enabled\":true, \"x\" : 0.25,\"image_data_url\":\"data:a\\\"}{,\",\"style\":{\"a\":[1,{\"b\":2}]},\"tags\":[]} ";
+  if (!splitObjectMembers(section, members) || members.size() != 5u ||
+      members[1].first != "x" || parseDoubleValue(members[1].second, 0.0) != 0.25 ||
+      parseStringValue(members[2].second) != "data:a\\\"}{," ||
+      members[3].second != "{\"a\":[1,{\"b\":2}]}" || members[4].second != "[]") {
+    std::cerr << "splitObjectMembers mis-parsed the section" << std::endl;
+    return 1;
+  }
+  if (splitObjectMembers("{\"a\":1", members) || splitObjectMembers("[1]", members) ||
+      !splitObjectMembers("{}", members) || !members.empty()) {
+    std::cerr << "splitObjectMembers accepted a malformed object" << std::endl;
+    return 2;
+  }
+
+  ProgramFields fields("{\"enabled\":false,\"x\":0.84,\"y\":0.08}");
+  if (fields.revision() != 0u || fields.raw("x") != "0.84") {
+    std::cerr << "seeded fields must start at revision 0" << std::endl;
+    return 3;
+  }
+
+  // Full update: the image is new, x changed, y was dropped.
+  splitObjectMembers("{\"enabled\":true,\"x\":0.5,\"image_data_url\":\"data:image/png;base64,AAAA\"}", members);
+  if (!sameKeys(fields.replace(members, 1u), {"y", "enabled", "x", "image_data_url"}) ||
+      fields.has("y") || fields.revision("image_data_url") != 1u) {
+    return 4;
+  }
+
+  // Patch of the position only: the image keeps its revision.
+  splitObjectMembers("{\"x\":0.6,\"enabled\":true}", members);
+  if (!sameKeys(fields.patch(members, 2u), {"x"}) ||
+      fields.revision("x") != 2u || fields.revision("image_data_url") != 1u ||
+      fields.revision("enabled") != 1u || fields.revision() != 2u) {
+    return 5;
+  }
+
+  // Re-sending an identical blob in a full update changes nothing else.
+  splitObjectMembers("{\"enabled\":true,\"x\":0.7,\"image_data_url\":\"data:image/png;base64,AAAA\"}", members);
+  if (!sameKeys(fields.replace(members, 3u), {"x"}) || fields.revision("image_data_url") != 1u) {
+    return 6;
+  }
+
+  // null removes a member and stamps the removal.
+  splitObjectMembers("{\"image_data_url\":null}", members);
+  if (!sameKeys(fields.patch(members, 4u), {"image_data_url"}) ||
+      fields.has("image_data_url") || fields.revision("image_data_url") != 4u ||
+      fields.toJson() != "{\"enabled\":true,\"x\":0.7}") {
+    std::cerr << "unexpected section json " << fields.toJson() << std::endl;
+    return 7;
+  }
+
+  // program.update_batch: each element of the updates array is one section
+  // update; brackets inside strings do not end the array early.
+  const std::string batch =
+      "{\"method\":\"program.update_batch\",\"params\":{\"updates\":["
+      "{\"section\":\"graphics\",\"values\":{\"template\":\"lower_third\",\"title\":\"A [b] c\"}},"
+      "{\"section\":\"cornerbug\",\"patch\":{\"x\":0.5}}]}}";
+  std::vector<std::string> entries;
+  if (!splitArrayElements(extractArrayField(batch, "updates"), entries) || entries.size() != 2u ||
+      extractStringField(entries[0], "section") != "graphics" ||
+      extractObjectField(entries[0], "values") != "{\"template\":\"lower_third\",\"title\":\"A [b] c\"}" ||
+      extractStringField(entries[1], "section") != "cornerbug" ||
+      extractObjectField(entries[1], "patch") != "{\"x\":0.5}" ||
+      !extractArrayField(batch, "missing").empty()) {
+    std::cerr << "batch updates were not split" << std::endl;
+    return 8;
+  }
+
+  // speaker_layout.camera_enabled shares the camera flag with the camera
+  // section: re-sending it unchanged still turns the camera back on after
+  // camera.enabled switched it off, and program.get reports the result.
+  MeetingState state;
+  const std::string layoutWithCamera =
+      "{\"section\":\"speaker_layout\",\"values\":{\"enabled\":true,\"camera_enabled\":true}}";
+  programUpdate(state, layoutWithCamera);
+  programUpdate(state, "{\"section\":\"camera\",\"patch\":{\"enabled\":false}}");
+  if (state.cameraRender.enabled) {
+    std::cerr << "camera.enabled did not turn the camera off" << std::endl;
+    return 9;
+  }
+  const uint64_t programRevision = state.programRevision;
+  if (!sameKeys(programUpdate(state, layoutWithCamera), {"camera_enabled"}) || !state.cameraRender.enabled ||
+      state.programRevision == programRevision ||
+      programSectionJson(state, "camera").find("\"enabled\":true") == std::string::npos) {
+    std::cerr << "re-sent camera_enabled was not applied" << std::endl;
+    return 10;
+  }
+  // When the flag already matches, the update stays a no-op.
+  if (!sameKeys(programUpdate(state, "{\"section\":\"speaker_layout\",\"patch\":{\"camera_enabled\":true}}"),
+                {}) ||
+      !state.cameraRender.enabled) {
+    std::cerr << "unchanged camera_enabled reported a change" << std::endl;
+    return 11;
+  }
+
+  std::cout << "program fields test passed" << std::endl;
+  return 0;
+}
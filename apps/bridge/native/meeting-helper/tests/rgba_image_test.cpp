@@ -0,0 +1,108 @@
+#include "compose/rgba_image.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using broadify::meeting::ImageLevel;
+using broadify::meeting::MipFilter;
+using broadify::meeting::RgbaImage;
+using broadify::meeting::downsampleRgbaBox;
+using broadify::meeting::mipLodForFootprint;
+using broadify::meeting::sampleImageMip;
+
+namespace {
+
+void referenceDownsample(const std::vector<uint8_t> &src, uint32_t srcWidth, uint32_t srcHeight,
+                         std::vector<uint8_t> &dst, uint32_t dstWidth, uint32_t dstHeight) {
+  dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4u, 0);
+  for (uint32_t y = 0; y < dstHeight; ++y) {
+    const uint32_t y0 = std::min(2u * y, srcHeight - 1u);
+    const uint32_t y1 = std::min(2u * y + 1u, srcHeight - 1u);
+    for (uint32_t x = 0; x < dstWidth; ++x) {
+      const uint32_t x0 = std::min(2u * x, srcWidth - 1u);
+      const uint32_t x1 = std::min(2u * x + 1u, srcWidth - 1u);
+      for (uint32_t c = 0; c < 4u; ++c) {
+        const auto at = [&](uint32_t px, uint32_t py) { return src[(static_cast<size_t>(py) * srcWidth + px) * 4u + c]; };
+        dst[(static_cast<size_t>(y) * dstWidth + x) * 4u + c] =
+            static_cast<uint8_t>((at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2u) >> 2u);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  // Odd sizes cover the vector body, the scalar tail and the dropped last
+  // row/column of a floor-halved level.
+  std::mt19937 random(11);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (const auto &size : {std::pair<uint32_t, uint32_t>{37u, 9u}, {16u, 16u}, {1u, 5u}}) {
+    const uint32_t srcWidth = size.first;
+    const uint32_t srcHeight = size.second;
+    std::vector<uint8_t> src(static_cast<size_t>(srcWidth) * srcHeight * 4u);
+    for (uint8_t &value : src) {
+      value = static_cast<uint8_t>(byte(random));
+    }
+    const uint32_t dstWidth = std::max(1u, srcWidth / 2u);
+    const uint32_t dstHeight = std::max(1u, srcHeight / 2u);
+    std::vector<uint8_t> expected;
+    referenceDownsample(src, srcWidth, srcHeight, expected, dstWidth, dstHeight);
+    std::vector<uint8_t> actual(expected.size(), 0);
+    downsampleRgbaBox(src.data(), srcWidth, srcHeight, actual.data(), dstWidth, dstHeight);
+    if (actual != expected) {
+      std::cerr << "box downsample differs from the reference at " << srcWidth << "x" << srcHeight << std::endl;
+      return 1;
+    }
+  }
+
+  // 64x16 checkerboard of opaque white/black: the chain ends at 1x1 and
+  // every level past the first is a flat mid grey.
+  RgbaImage image;
+  image.width = 64;
+  image.height = 16;
+  image.rgba.resize(64u * 16u * 4u);
+  for (uint32_t y = 0; y < image.height; ++y) {
+    for (uint32_t x = 0; x < image.width; ++x) {
+      const uint8_t value = ((x + y) % 2u) == 0u ? 255u : 0u;
+      uint8_t *pixel = image.rgba.data() + (static_cast<size_t>(y) * image.width + x) * 4u;
+      pixel[0] = pixel[1] = pixel[2] = value;
+      pixel[3] = 255u;
+    }
+  }
+  if (image.levelCount() != 7u) {
+    std::cerr << "expected 7 levels, got " << image.levelCount() << std::endl;
+    return 2;
+  }
+  const ImageLevel last = image.level(100u);
+  const ImageLevel second = image.level(1u);
+  if (last.width != 1u || last.height != 1u || second.width != 32u || second.height != 8u ||
+      second.rgba[0] != 128u || last.rgba[0] != 128u || last.rgba[3] != 255u) {
+    std::cerr << "unexpected mip chain shape or contents" << std::endl;
+    return 3;
+  }
+
+  // Magnification keeps the full-resolution texel; 8x minification reads
+  // the averaged level instead of a single checker cell.
+  uint8_t sample[4];
+  sampleImageMip(image, 10.0, 4.0, mipLodForFootprint(0.5), MipFilter::kTrilinear, sample);
+  if (sample[0] != 255u) {
+    return 4;
+  }
+  sampleImageMip(image, 10.0, 4.0, mipLodForFootprint(8.0), MipFilter::kNearestLevel, sample);
+  if (sample[0] != 128u || sample[3] != 255u) {
+    return 5;
+  }
+  // Half way between level 0 (white at an even texel) and level 1 (grey).
+  sampleImageMip(image, 10.0, 4.0, 0.5, MipFilter::kTrilinear, sample);
+  if (sample[0] < 190u || sample[0] > 193u) {
+    std::cerr << "trilinear blend " << int(sample[0]) << std::endl;
+    return 6;
+  }
+
+  std::cout << "rgba image test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "compose/shape_rasterizer.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using broadify::meeting::RasterShape;
+using broadify::meeting::blendSpanRgba;
+using broadify::meeting::rasterizeShapes;
+
+namespace {
+
+uint8_t referenceBlend(uint8_t src, uint8_t dst, uint8_t alpha) {
+  return static_cast<uint8_t>((src * alpha + dst * (255 - alpha)) / 255);
+}
+
+}  // namespace
+
+int main() {
+  // The vectorised span blend must match the compositor's scalar formula,
+  // including the tail pixels that do not fill a whole vector.
+  std::vector<uint8_t> span(37u * 4u);
+  for (size_t i = 0; i < span.size(); ++i) {
+    span[i] = static_cast<uint8_t>((i * 53u + 7u) & 0xffu);
+  }
+  const std::vector<uint8_t> original = span;
+  blendSpanRgba(span.data(), 37u, 200u, 17u, 255u, 91u);
+  for (size_t i = 0; i < 37u; ++i) {
+    const uint8_t *pixel = span.data() + i * 4u;
+    const uint8_t *before = original.data() + i * 4u;
+    if (pixel[0] != referenceBlend(200u, before[0], 91u) ||
+        pixel[1] != referenceBlend(17u, before[1], 91u) ||
+        pixel[2] != referenceBlend(255u, before[2], 91u) ||
+        pixel[3] != 255u) {
+      std::cerr << "span blend differs from scalar reference at pixel " << i << std::endl;
+      return 1;
+    }
+  }
+
+  constexpr uint32_t width = 64u;
+  constexpr uint32_t height = 48u;
+  const auto pixelAt = [&](const std::vector<uint8_t> &frame, int x, int y) {
+    return frame[(static_cast<size_t>(y) * width + static_cast<size_t>(x)) * 4u];
+  };
+
+  // Integer-aligned rectangles stay hard-edged: exactly the covered pixels.
+  std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4u, 0u);
+  RasterShape box;
+  box.x = 10.0;
+  box.y = 8.0;
+  box.width = 20.0;
+  box.height = 12.0;
+  rasterizeShapes(frame, width, height, {box}, 20.0, 14.0, 0.0);
+  for (int y = 0; y < static_cast<int>(height); ++y) {
+    for (int x = 0; x < static_cast<int>(width); ++x) {
+      const bool inside = x >= 10 && x < 30 && y >= 8 && y < 20;
+      if (pixelAt(frame, x, y) != (inside ? 255u : 0u)) {
+        std::cerr << "axis-aligned fill mismatch at " << x << "," << y << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  // Rotated edges receive partial coverage while the interior stays solid.
+  frame.assign(frame.size(), 0u);
+  rasterizeShapes(frame, width, height, {box}, 20.0, 14.0, 30.0);
+  if (pixelAt(frame, 20, 14) != 255u) {
+    std::cerr << "rotated interior is not fully covered" << std::endl;
+    return 1;
+  }
+  int partial = 0;
+  for (int y = 0; y < static_cast<int>(height); ++y) {
+    for (int x = 0; x < static_cast<int>(width); ++x) {
+      const uint8_t value = pixelAt(frame, x, y);
+      if (value > 0u && value < 255u) {
+        ++partial;
+      }
+    }
+  }
+  if (partial < 20) {
+    std::cerr << "rotated edges are not anti-aliased" << std::endl;
+    return 1;
+  }
+  if (pixelAt(frame, 0, 0) != 0u || pixelAt(frame, 63, 47) != 0u) {
+    std::cerr << "rotated fill leaked outside its bounds" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "util/thread_roles.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using broadify::meeting::ScopedThreadRole;
+using broadify::meeting::ThreadRoleSample;
+using broadify::meeting::ThreadRoleUsage;
+using broadify::meeting::sampleThreadRoles;
+using broadify::meeting::threadRoleSampleJson;
+
+namespace {
+
+const ThreadRoleUsage *findRole(const ThreadRoleSample &sample, const std::string &role) {
+  for (const ThreadRoleUsage &usage : sample.roles) {
+    if (usage.role == role) {
+      return &usage;
+    }
+  }
+  return nullptr;
+}
+
+void spin(std::chrono::milliseconds duration) {
+  volatile uint64_t sink = 0;
+  const auto until = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < until) {
+    for (int i = 0; i < 10000; ++i) {
+      sink = sink + static_cast<uint64_t>(i);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  ScopedThreadRole mainRole("main");
+  sampleThreadRoles(0);
+
+  // One busy and one sleeping thread alive at sample time. The busy thread
+  // spins until the sampler has charged it kBusyCpuSeconds, so the checks
+  // compare accumulated CPU time and hold however loaded the machine is.
+  constexpr double kBusyCpuSeconds = 0.2;
+  std::atomic<bool> stop{false};
+  std::atomic<int> started{0};
+  std::thread busy([&]() {
+    ScopedThreadRole role("busy");
+    ++started;
+    while (!stop.load()) {
+      spin(std::chrono::milliseconds(1));
+    }
+  });
+  std::thread idle([&]() {
+    ScopedThreadRole role("idle");
+    ++started;
+    while (!stop.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  });
+  while (started.load() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const auto startedAt = std::chrono::steady_clock::now();
+  ThreadRoleSample live;
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    live = sampleThreadRoles(0);
+    const ThreadRoleUsage *usage = findRole(live, "busy");
+    if (usage == nullptr || usage->cpuSeconds >= kBusyCpuSeconds ||
+        std::chrono::steady_clock::now() - startedAt > std::chrono::seconds(30)) {
+      break;
+    }
+  }
+  const double elapsedSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+  stop.store(true);
+  busy.join();
+  idle.join();
+
+  const ThreadRoleUsage *busyUsage = findRole(live, "busy");
+  const ThreadRoleUsage *idleUsage = findRole(live, "idle");
+  if (busyUsage == nullptr || idleUsage == nullptr || findRole(live, "main") == nullptr ||
+      live.roles.empty() || live.roles.back().role != "unregistered") {
+    std::cerr << "missing roles: {" << threadRoleSampleJson(live) << "}" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // One thread runs on one core at most; the slack covers coarse OS clocks.
+  if (busyUsage->threads != 1u || busyUsage->cpuSeconds < kBusyCpuSeconds ||
+      busyUsage->cpuSeconds > elapsedSeconds + 0.05 || idleUsage->cpuSeconds > busyUsage->cpuSeconds / 4.0) {
+    std::cerr << "unexpected busy/idle split after " << elapsedSeconds << " s: {" << threadRoleSampleJson(live)
+              << "}" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // Thread and process clocks are read a moment apart, which over a short
+  // window is worth a few percent.
+  if (live.processCpuPercent + 10.0 < busyUsage->cpuPercent) {
+    std::cerr << "process CPU below a single role: {" << threadRoleSampleJson(live) << "}" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Exited threads keep their CPU time under the role, and stop adding to
+  // it; a repeat call inside the minimum window returns the cached sample.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const ThreadRoleSample after = sampleThreadRoles(0);
+  const ThreadRoleUsage *busyAfter = findRole(after, "busy");
+  if (busyAfter == nullptr || busyAfter->threads != 0u || busyAfter->cpuSeconds < busyUsage->cpuSeconds ||
+      busyAfter->cpuSeconds > busyUsage->cpuSeconds + 0.05) {
+    std::cerr << "retired thread not accounted: {" << threadRoleSampleJson(after) << "}" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const ThreadRoleSample cached = sampleThreadRoles(60000);
+  if (cached.windowMs != after.windowMs || cached.roles.size() != after.roles.size()) {
+    std::cerr << "sample within the minimum window was not reused" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string json = threadRoleSampleJson(after);
+  if (json.find("\"role\":\"busy\"") == std::string::npos || json.find("\"window_ms\":") != 0u) {
+    std::cerr << "unexpected JSON: " << json << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "thread roles ok: {" << threadRoleSampleJson(live) << "}" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+#include "compose/tile_damage.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using broadify::meeting::AlphaMask;
+using broadify::meeting::TileCameraLayer;
+using broadify::meeting::TileDamageTracker;
+using broadify::meeting::TileRect;
+using broadify::meeting::VideoFrame;
+
+namespace {
+
+// 4 x 3 tiles of 32 pixels.
+constexpr uint32_t kWidth = 128u;
+constexpr uint32_t kHeight = 96u;
+
+bool fail(const std::string &message) {
+  std::cerr << message << std::endl;
+  return false;
+}
+
+VideoFrame makeFrame(uint32_t width, uint32_t height, uint64_t timestampNs) {
+  VideoFrame frame;
+  frame.width = width;
+  frame.height = height;
+  frame.timestampNs = timestampNs;
+  frame.rgba.assign(static_cast<size_t>(width) * height * 4u, 0u);
+  for (size_t i = 0; i < frame.rgba.size(); ++i) {
+    frame.rgba[i] = static_cast<uint8_t>((i * 29u + 11u) & 0xffu);
+  }
+  return frame;
+}
+
+void touch(VideoFrame &frame, uint32_t x, uint32_t y) {
+  frame.rgba[(static_cast<size_t>(y) * frame.width + x) * 4u] ^= 0x40u;
+}
+
+TileCameraLayer fullFrameCamera(const VideoFrame *frame, const AlphaMask *mask, bool mirror) {
+  TileCameraLayer camera;
+  camera.frame = frame;
+  camera.mask = mask;
+  camera.rect = {0, 0, static_cast<int>(kWidth), static_cast<int>(kHeight)};
+  camera.sourceWidth = frame->width;
+  camera.sourceHeight = frame->height;
+  camera.mirror = mirror;
+  return camera;
+}
+
+// Exactly the tile at (column, row) is damaged.
+bool onlyTile(const TileDamageTracker &damage, int column, int row, const std::string &label) {
+  const std::vector<TileRect> runs = damage.runs(true);
+  if (damage.fullDamage() || damage.damagedTileCount() != 1u || runs.size() != 1u ||
+      runs[0].x != column * 32 || runs[0].y != row * 32 || runs[0].width != 32 || runs[0].height != 32) {
+    return fail(label + ": expected only tile " + std::to_string(column) + "," + std::to_string(row) +
+                ", got " + std::to_string(damage.damagedTileCount()) + " damaged");
+  }
+  return true;
+}
+
+bool checkCamera() {
+  TileDamageTracker damage;
+  VideoFrame camera = makeFrame(kWidth, kHeight, 1u);
+  damage.update(kWidth, kHeight, 7u, fullFrameCamera(&camera, nullptr, false), nullptr, nullptr);
+  if (!damage.fullDamage() || damage.damagedTileCount() != damage.tileCount() || damage.tileCount() != 12u) {
+    return fail("the first frame must damage all 12 tiles");
+  }
+
+  VideoFrame same = camera;
+  same.timestampNs = 2u;
+  damage.update(kWidth, kHeight, 7u, fullFrameCamera(&same, nullptr, false), nullptr, nullptr);
+  if (damage.fullDamage() || damage.damagedTileCount() != 0u || damage.runs(false).size() != 3u) {
+    return fail("an identical camera frame must not damage anything");
+  }
+
+  touch(same, 40u, 10u);
+  damage.update(kWidth, kHeight, 7u, fullFrameCamera(&same, nullptr, false), nullptr, nullptr);
+  if (!onlyTile(damage, 1, 0, "camera pixel")) {
+    return false;
+  }
+  size_t area = 0;
+  for (const bool damaged : {true, false}) {
+    for (const TileRect &run : damage.runs(damaged)) {
+      area += static_cast<size_t>(run.width) * static_cast<size_t>(run.height);
+    }
+  }
+  if (area != static_cast<size_t>(kWidth) * kHeight) {
+    return fail("damaged and undamaged runs must cover the frame exactly once");
+  }
+
+  // Mirrored, camera column 10 lands in output column 117 (tile 3).
+  damage.update(kWidth, kHeight, 7u, fullFrameCamera(&same, nullptr, true), nullptr, nullptr);
+  if (!damage.fullDamage()) {
+    return fail("switching the mirror must damage everything");
+  }
+  touch(same, 10u, 70u);
+  damage.update(kWidth, kHeight, 7u, fullFrameCamera(&same, nullptr, true), nullptr, nullptr);
+  if (!onlyTile(damage, 3, 2, "mirrored camera pixel")) {
+    return false;
+  }
+
+  damage.update(kWidth, kHeight, 8u, fullFrameCamera(&same, nullptr, true), nullptr, nullptr);
+  if (!damage.fullDamage()) {
+    return fail("a new scene key must damage everything");
+  }
+  damage.invalidate();
+  damage.update(kWidth, kHeight, 8u, fullFrameCamera(&same, nullptr, true), nullptr, nullptr);
+  if (!damage.fullDamage()) {
+    return fail("invalidate must damage everything");
+  }
+  return true;
+}
+
+bool checkMask() {
+  TileDamageTracker damage;
+  VideoFrame camera = makeFrame(kWidth, kHeight, 1u);
+  // Quarter-size mask: opaque over output columns 64.. (tiles 2 and 3).
+  AlphaMask mask;
+  mask.width = 32u;
+  mask.height = 24u;
+  mask.alpha.assign(static_cast<size_t>(mask.width) * mask.height, 0u);
+  for (uint32_t y = 0; y < mask.height; ++y) {
+    for (uint32_t x = 17u; x < mask.width; ++x) {
+      mask.alpha[static_cast<size_t>(y) * mask.width + x] = 255u;
+    }
+  }
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, &mask, false), nullptr, nullptr);
+
+  touch(camera, 5u, 40u);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, &mask, false), nullptr, nullptr);
+  if (damage.damagedTileCount() != 0u) {
+    return fail("camera changes under a fully transparent mask must not damage tiles");
+  }
+
+  touch(camera, 100u, 40u);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, &mask, false), nullptr, nullptr);
+  if (!onlyTile(damage, 3, 1, "visible camera pixel")) {
+    return false;
+  }
+
+  mask.alpha[static_cast<size_t>(20u) * mask.width + 2u] = 128u;
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, &mask, false), nullptr, nullptr);
+  if (!onlyTile(damage, 0, 2, "mask sample")) {
+    return false;
+  }
+  return true;
+}
+
+bool checkGraphics() {
+  TileDamageTracker damage;
+  VideoFrame camera = makeFrame(kWidth, kHeight, 1u);
+  VideoFrame front = makeFrame(kWidth, kHeight, 10u);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), nullptr, &front);
+
+  // A FrameBus frame only changes with its timestamp.
+  touch(front, 70u, 70u);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), nullptr, &front);
+  if (damage.damagedTileCount() != 0u) {
+    return fail("an unchanged graphics timestamp must not damage tiles");
+  }
+  front.timestampNs = 11u;
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), nullptr, &front);
+  if (!onlyTile(damage, 2, 2, "graphics pixel")) {
+    return false;
+  }
+
+  // Scaled back graphics damage the whole output whenever they change.
+  VideoFrame back = makeFrame(kWidth / 2u, kHeight / 2u, 20u);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), &back, &front);
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), &back, &front);
+  if (damage.damagedTileCount() != 0u) {
+    return fail("unchanged scaled graphics must not damage tiles");
+  }
+  back.timestampNs = 21u;
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), &back, &front);
+  if (!damage.fullDamage()) {
+    return fail("a new scaled graphics frame must damage everything");
+  }
+  damage.update(kWidth, kHeight, 1u, fullFrameCamera(&camera, nullptr, false), nullptr, &front);
+  if (!damage.fullDamage()) {
+    return fail("removing a graphics layer must damage everything");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  if (!checkCamera() || !checkMask() || !checkGraphics()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "tile damage ok" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "capture/yuv_convert.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using broadify::meeting::convertNv12ToRgba;
+using broadify::meeting::convertYuyvToRgba;
+
+namespace {
+
+// Plain per-pixel BT.601 limited range, the contract the SIMD paths match.
+void referencePixel(int y, int u, int v, uint8_t *out) {
+  const int c = 298 * (y - 16);
+  const int d = u - 128;
+  const int e = v - 128;
+  out[0] = static_cast<uint8_t>(std::clamp((c + 409 * e + 128) >> 8, 0, 255));
+  out[1] = static_cast<uint8_t>(std::clamp((c - 100 * d - 208 * e + 128) >> 8, 0, 255));
+  out[2] = static_cast<uint8_t>(std::clamp((c + 516 * d + 128) >> 8, 0, 255));
+  out[3] = 255;
+}
+
+int firstMismatch(const std::vector<uint8_t> &actual, const std::vector<uint8_t> &expected) {
+  for (size_t i = 0; i < actual.size(); ++i) {
+    if (actual[i] != expected[i]) {
+      std::cerr << "byte " << i << ": got " << int(actual[i]) << " expected " << int(expected[i]) << std::endl;
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+int main() {
+  // 38 wide exercises both the 8-pixel vector body and the scalar tail;
+  // strides are padded like real V4L2 buffers.
+  constexpr uint32_t kWidth = 38;
+  constexpr uint32_t kHeight = 6;
+  constexpr size_t kYuyvStride = kWidth * 2u + 12u;
+  constexpr size_t kPlaneStride = kWidth + 10u;
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::vector<uint8_t> yuyv(kYuyvStride * kHeight);
+  for (uint8_t &value : yuyv) {
+    value = static_cast<uint8_t>(byte(random));
+  }
+  std::vector<uint8_t> expected(kWidth * kHeight * 4u);
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    const uint8_t *row = yuyv.data() + y * kYuyvStride;
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      const uint32_t pair = x / 2u * 4u;
+      referencePixel(row[x * 2u], row[pair + 1u], row[pair + 3u], expected.data() + (y * kWidth + x) * 4u);
+    }
+  }
+  // Two bands, as the capture pool converts them.
+  std::vector<uint8_t> actual(expected.size(), 0);
+  convertYuyvToRgba(yuyv.data(), kYuyvStride, actual.data(), kWidth, 0, 4);
+  convertYuyvToRgba(yuyv.data(), kYuyvStride, actual.data(), kWidth, 4, kHeight);
+  if (firstMismatch(actual, expected) >= 0) {
+    std::cerr << "YUYV conversion differs from the reference" << std::endl;
+    return 1;
+  }
+
+  std::vector<uint8_t> nv12(kPlaneStride * kHeight + kPlaneStride * kHeight / 2u);
+  for (uint8_t &value : nv12) {
+    value = static_cast<uint8_t>(byte(random));
+  }
+  const uint8_t *uvPlane = nv12.data() + kPlaneStride * kHeight;
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      const uint8_t *chroma = uvPlane + (y / 2u) * kPlaneStride + x / 2u * 2u;
+      referencePixel(nv12[y * kPlaneStride + x], chroma[0], chroma[1], expected.data() + (y * kWidth + x) * 4u);
+    }
+  }
+  std::fill(actual.begin(), actual.end(), 0);
+  convertNv12ToRgba(nv12.data(), kPlaneStride, uvPlane, kPlaneStride, actual.data(), kWidth, 0, 2);
+  convertNv12ToRgba(nv12.data(), kPlaneStride, uvPlane, kPlaneStride, actual.data(), kWidth, 2, kHeight);
+  if (firstMismatch(actual, expected) >= 0) {
+    std::cerr << "NV12 conversion differs from the reference" << std::endl;
+    return 2;
+  }
+
+  // Reference white and black, and rows outside the band stay untouched.
+  const uint8_t whiteBlack[] = {235, 128, 16, 128, 235, 128, 16, 128, 235, 128, 16, 128, 235, 128, 16, 128};
+  std::vector<uint8_t> levels(8u * 2u * 4u, 7);
+  convertYuyvToRgba(whiteBlack, sizeof(whiteBlack), levels.data(), 8, 0, 1);
+  if (levels[0] != 255 || levels[1] != 255 || levels[2] != 255 || levels[3] != 255 ||
+      levels[4] != 0 || levels[5] != 0 || levels[6] != 0 || levels[7] != 255 ||
+      levels[8u * 4u] != 7) {
+    std::cerr << "limited-range white/black or band bounds are wrong" << std::endl;
+    return 3;
+  }
+
+  std::cout << "yuv convert test passed" << std::endl;
+  return 0;
+}
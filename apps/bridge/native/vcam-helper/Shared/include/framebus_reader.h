@@ -22,14 +22,19 @@ typedef struct framebus_reader framebus_reader_t;
 
 /*
  * Open an existing FrameBus shared-memory segment by name.
- * The name matches the writer's segment name (leading '/' optional).
- * Returns NULL when the segment does not exist or the header is invalid.
+ * The name matches the writer's segment name (leading '/' optional); the
+ * first live generation of it is opened (see FRAMEBUS_MAX_GENERATIONS in
+ * framebus.h). Returns NULL when no live segment exists or the header is
+ * invalid.
  */
 framebus_reader_t *framebus_reader_open(const char *name);
 
 void framebus_reader_close(framebus_reader_t *reader);
 
-/* Returns 0 on success, -1 when the reader is invalid. */
+/*
+ * Returns 0 on success, -1 when the reader is invalid. Reports the geometry
+ * captured at open time, which is what the copy functions use.
+ */
 int framebus_reader_get_info(const framebus_reader_t *reader,
                              uint32_t *width,
                              uint32_t *height,
@@ -49,7 +54,10 @@ uint64_t framebus_reader_seq(const framebus_reader_t *reader);
  *    1  frame copied
  *    0  no new frame available
  *   -1  invalid arguments / reader
- *   -2  torn frame (writer overran the reader; caller may retry)
+ *   -2  torn frame (the writer reached the slot again while it was being
+ *       copied; caller may retry)
+ *   -3  segment retired or reconfigured by the writer; close the reader and
+ *       reopen the name to pick up the new geometry
  */
 int framebus_reader_copy_latest_bgra(framebus_reader_t *reader,
                                      uint8_t *dst,
@@ -66,6 +74,41 @@ int framebus_reader_copy_latest_rgba(framebus_reader_t *reader,
                                      size_t dst_stride,
                                      uint64_t *last_seq);
 
+/* Byte order of each destination pixel for framebus_reader_copy_latest_region. */
+typedef enum framebus_copy_format {
+  FRAMEBUS_COPY_RGBA8 = 0,
+  FRAMEBUS_COPY_BGRA8 = 1, /* CoreVideo 32BGRA, SDL ARGB8888 on little endian */
+  FRAMEBUS_COPY_ARGB8 = 2, /* DeckLink bmdFormat8BitARGB, CoreVideo 32ARGB */
+  FRAMEBUS_COPY_ABGR8 = 3,
+} framebus_copy_format_t;
+
+/* Source sub-rectangle in frame pixels. */
+typedef struct framebus_copy_rect {
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+} framebus_copy_rect_t;
+
+/*
+ * Copy the latest frame, or the part of it selected by `rect` (NULL = whole
+ * frame), straight into a caller-owned buffer with any row stride, such as a
+ * CVPixelBuffer, SDL texture or DeckLink frame. The crop and the conversion to
+ * `format` happen in the same SIMD pass as the copy, so no intermediate
+ * full-frame buffer is needed.
+ *
+ * The region is written at dst's origin: dst must hold rect->height rows of
+ * dst_stride >= rect->width * 4 bytes. last_seq behaves as for
+ * framebus_reader_copy_latest_bgra, and so do the return values; -1 also
+ * covers a rect outside the frame or an unknown format.
+ */
+int framebus_reader_copy_latest_region(framebus_reader_t *reader,
+                                       uint8_t *dst,
+                                       size_t dst_stride,
+                                       framebus_copy_format_t format,
+                                       const framebus_copy_rect_t *rect,
+                                       uint64_t *last_seq);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,14 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAMEBUS_READER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FRAMEBUS_READER_NEON 1
+#endif
+
 #if defined(_WIN32)
 #include <windows.h>
 #else
@@ -24,6 +32,11 @@
 #define FRAMEBUS_VERSION 1u
 #define FRAMEBUS_HEADER_SIZE 128u
 #define FRAMEBUS_PIXELFORMAT_RGBA8 1u
+#define FRAMEBUS_FLAG_RETIRED 0x0001u
+/* Windows writers move to "<name>.<n>" while a reader still holds the
+ * previous segment under the name (see FRAMEBUS_MAX_GENERATIONS in
+ * framebus.h). */
+#define FRAMEBUS_MAX_GENERATIONS 8u
 
 #pragma pack(push, 1)
 typedef struct framebus_header {
@@ -48,6 +61,13 @@ struct framebus_reader {
   size_t map_size;
   uint8_t *base;
   const framebus_header_t *header;
+  /* Geometry captured at open; copies never trust live header fields, which
+   * the writer may rewrite when it reconfigures the segment. */
+  uint32_t width;
+  uint32_t height;
+  uint32_t fps;
+  uint32_t slot_count;
+  uint32_t slot_stride;
 #if defined(_WIN32)
   HANDLE mapping;
 #else
@@ -59,6 +79,17 @@ static uint64_t load_seq(const framebus_header_t *header) {
   return framebus_atomic_load_u64(&header->seq);
 }
 
+/* Call after load_seq: -3 once the writer retired or resized the segment. */
+static int check_segment(const framebus_reader_t *reader) {
+  const volatile framebus_header_t *header = reader->header;
+  if ((header->flags & FRAMEBUS_FLAG_RETIRED) != 0 || header->width != reader->width ||
+      header->height != reader->height || header->slot_count != reader->slot_count ||
+      header->slot_stride != reader->slot_stride) {
+    return -3;
+  }
+  return 0;
+}
+
 #if defined(_WIN32)
 static void normalize_mapping_name(const char *name, char *out, size_t out_size) {
   char sanitized[256];
@@ -102,6 +133,7 @@ static int validate_header(const framebus_header_t *header, size_t map_size) {
 
   if (header->magic != FRAMEBUS_MAGIC_LE || header->version != FRAMEBUS_VERSION ||
       header->header_size != FRAMEBUS_HEADER_SIZE ||
+      (header->flags & FRAMEBUS_FLAG_RETIRED) != 0 ||
       header->pixel_format != FRAMEBUS_PIXELFORMAT_RGBA8 ||
       header->slot_count == 0 || header->slot_stride < header->frame_size ||
       FRAMEBUS_HEADER_SIZE + slots_size > map_size) {
@@ -111,17 +143,8 @@ static int validate_header(const framebus_header_t *header, size_t map_size) {
   return 0;
 }
 
-framebus_reader_t *framebus_reader_open(const char *name) {
-  if (name == NULL || name[0] == '\0') {
-    return NULL;
-  }
-
-  char mapping_name[256];
-  normalize_mapping_name(name, mapping_name, sizeof(mapping_name));
-  if (mapping_name[0] == '\0') {
-    return NULL;
-  }
-
+/* Maps one segment object; NULL when it is missing, invalid or retired. */
+static framebus_reader_t *open_segment(const char *mapping_name) {
 #if defined(_WIN32)
   HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name);
   if (mapping == NULL) {
@@ -184,6 +207,11 @@ framebus_reader_t *framebus_reader_open(const char *name) {
   reader->map_size = map_size;
   reader->base = base;
   reader->header = header;
+  reader->width = header->width;
+  reader->height = header->height;
+  reader->fps = header->fps;
+  reader->slot_count = header->slot_count;
+  reader->slot_stride = header->slot_stride;
 #if defined(_WIN32)
   reader->mapping = mapping;
 #else
@@ -192,6 +220,33 @@ framebus_reader_t *framebus_reader_open(const char *name) {
   return reader;
 }
 
+framebus_reader_t *framebus_reader_open(const char *name) {
+  if (name == NULL || name[0] == '\0') {
+    return NULL;
+  }
+
+  char mapping_name[256];
+  normalize_mapping_name(name, mapping_name, sizeof(mapping_name));
+  if (mapping_name[0] == '\0') {
+    return NULL;
+  }
+
+  /* Earlier generations may be gone or retired; the writer only ever keeps
+   * one live segment per name. */
+  for (uint32_t generation = 0; generation < FRAMEBUS_MAX_GENERATIONS; generation++) {
+    char generation_name[272];
+    if (generation == 0u) {
+      snprintf(generation_name, sizeof(generation_name), "%s", mapping_name);
+    } else {
+      snprintf(generation_name, sizeof(generation_name), "%s.%u", mapping_name, (unsigned)generation);
+    }
+    framebus_reader_t *reader = open_segment(generation_name);
+    if (reader != NULL) {
+      return reader;
+    }
+  }
+  return NULL;
+}
 void framebus_reader_close(framebus_reader_t *reader) {
   if (reader == NULL) {
     return;
@@ -222,13 +277,13 @@ int framebus_reader_get_info(const framebus_reader_t *reader,
     return -1;
   }
   if (width != NULL) {
-    *width = reader->header->width;
+    *width = reader->width;
   }
   if (height != NULL) {
-    *height = reader->header->height;
+    *height = reader->height;
   }
   if (fps != NULL) {
-    *fps = reader->header->fps;
+    *fps = reader->fps;
   }
   return 0;
 }
@@ -240,86 +295,134 @@ uint64_t framebus_reader_seq(const framebus_reader_t *reader) {
   return load_seq(reader->header);
 }
 
-int framebus_reader_copy_latest_bgra(framebus_reader_t *reader,
-                                     uint8_t *dst,
-                                     size_t dst_stride,
-                                     uint64_t *last_seq) {
-  if (reader == NULL || reader->header == NULL || dst == NULL || last_seq == NULL) {
-    return -1;
-  }
-
-  const framebus_header_t *header = reader->header;
-  const size_t row_bytes = (size_t)header->width * 4u;
-  if (dst_stride < row_bytes) {
-    return -1;
-  }
+/* Destination byte i of each pixel is source (RGBA) byte kSwizzle[format][i]. */
+static const uint8_t kSwizzle[4][4] = {
+    {0, 1, 2, 3}, /* RGBA */
+    {2, 1, 0, 3}, /* BGRA */
+    {3, 0, 1, 2}, /* ARGB */
+    {3, 2, 1, 0}, /* ABGR */
+};
 
-  uint64_t seq = load_seq(header);
-  if (seq == 0 || seq <= *last_seq) {
-    return 0;
+/* Converts `count` RGBA8 pixels. SSE2 works on little-endian 32-bit lanes
+ * (R in the low byte), NEON de-interleaves planes; both match the table. */
+static void convert_row(const uint8_t *src, uint8_t *dst, uint32_t count, framebus_copy_format_t format) {
+  if (format == FRAMEBUS_COPY_RGBA8) {
+    memcpy(dst, src, (size_t)count * 4u);
+    return;
   }
-
-  const uint32_t slot_index = (uint32_t)((seq - 1) % header->slot_count);
-  const uint8_t *src =
-      reader->base + FRAMEBUS_HEADER_SIZE + (size_t)slot_index * header->slot_stride;
-
-  for (uint32_t y = 0; y < header->height; y++) {
-    const uint8_t *src_row = src + (size_t)y * row_bytes;
-    uint8_t *dst_row = dst + (size_t)y * dst_stride;
-    for (uint32_t x = 0; x < header->width; x++) {
-      const uint8_t r = src_row[x * 4 + 0];
-      const uint8_t g = src_row[x * 4 + 1];
-      const uint8_t b = src_row[x * 4 + 2];
-      const uint8_t a = src_row[x * 4 + 3];
-      dst_row[x * 4 + 0] = b;
-      dst_row[x * 4 + 1] = g;
-      dst_row[x * 4 + 2] = r;
-      dst_row[x * 4 + 3] = a;
+  uint32_t x = 0;
+#if defined(FRAMEBUS_READER_SSE2)
+  const __m128i low_byte = _mm_set1_epi32(0x000000ff);
+  const __m128i green_alpha = _mm_set1_epi32((int)0xff00ff00u);
+  for (; x + 4u <= count; x += 4u) {
+    const __m128i p = _mm_loadu_si128((const __m128i *)(src + (size_t)x * 4u));
+    __m128i out;
+    if (format == FRAMEBUS_COPY_BGRA8) {
+      out = _mm_or_si128(_mm_and_si128(p, green_alpha),
+                         _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), low_byte),
+                                      _mm_slli_epi32(_mm_and_si128(p, low_byte), 16)));
+    } else if (format == FRAMEBUS_COPY_ARGB8) {
+      out = _mm_or_si128(_mm_slli_epi32(p, 8), _mm_srli_epi32(p, 24));
+    } else {
+      /* ABGR is a byte swap of each lane. */
+      out = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(p, 24), _mm_srli_epi32(p, 24)),
+                         _mm_or_si128(_mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0x00ff0000)),
+                                      _mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0x0000ff00))));
     }
+    _mm_storeu_si128((__m128i *)(dst + (size_t)x * 4u), out);
+  }
+#elif defined(FRAMEBUS_READER_NEON)
+  const uint8_t *order = kSwizzle[format];
+  for (; x + 16u <= count; x += 16u) {
+    const uint8x16x4_t p = vld4q_u8(src + (size_t)x * 4u);
+    uint8x16x4_t out;
+    out.val[0] = p.val[order[0]];
+    out.val[1] = p.val[order[1]];
+    out.val[2] = p.val[order[2]];
+    out.val[3] = p.val[order[3]];
+    vst4q_u8(dst + (size_t)x * 4u, out);
   }
-
-  /* Detect a torn read: the writer may have lapped this slot meanwhile. */
-  const uint64_t seq_after = load_seq(header);
-  if (seq_after >= seq + header->slot_count) {
-    return -2;
+#endif
+  const uint8_t *swizzle = kSwizzle[format];
+  for (; x < count; x++) {
+    const uint8_t *s = src + (size_t)x * 4u;
+    uint8_t *d = dst + (size_t)x * 4u;
+    d[0] = s[swizzle[0]];
+    d[1] = s[swizzle[1]];
+    d[2] = s[swizzle[2]];
+    d[3] = s[swizzle[3]];
   }
-
-  *last_seq = seq;
-  return 1;
 }
 
-int framebus_reader_copy_latest_rgba(framebus_reader_t *reader,
-                                     uint8_t *dst,
-                                     size_t dst_stride,
-                                     uint64_t *last_seq) {
-  if (reader == NULL || reader->header == NULL || dst == NULL || last_seq == NULL) {
+int framebus_reader_copy_latest_region(framebus_reader_t *reader,
+                                       uint8_t *dst,
+                                       size_t dst_stride,
+                                       framebus_copy_format_t format,
+                                       const framebus_copy_rect_t *rect,
+                                       uint64_t *last_seq) {
+  if (reader == NULL || reader->header == NULL || dst == NULL || last_seq == NULL ||
+      (unsigned)format > (unsigned)FRAMEBUS_COPY_ABGR8) {
     return -1;
   }
 
-  const framebus_header_t *header = reader->header;
-  const size_t row_bytes = (size_t)header->width * 4u;
-  if (dst_stride < row_bytes) {
+  framebus_copy_rect_t region = {0u, 0u, reader->width, reader->height};
+  if (rect != NULL) {
+    region = *rect;
+    if (region.width == 0u || region.height == 0u || region.x > reader->width ||
+        region.width > reader->width - region.x || region.y > reader->height ||
+        region.height > reader->height - region.y) {
+      return -1;
+    }
+  }
+  if (dst_stride < (size_t)region.width * 4u) {
     return -1;
   }
 
+  const framebus_header_t *header = reader->header;
   uint64_t seq = load_seq(header);
+  if (check_segment(reader) != 0) {
+    return -3;
+  }
   if (seq == 0 || seq <= *last_seq) {
     return 0;
   }
 
-  const uint32_t slot_index = (uint32_t)((seq - 1) % header->slot_count);
-  const uint8_t *src =
-      reader->base + FRAMEBUS_HEADER_SIZE + (size_t)slot_index * header->slot_stride;
+  const uint32_t slot_index = (uint32_t)((seq - 1) % reader->slot_count);
+  const size_t src_stride = (size_t)reader->width * 4u;
+  const uint8_t *src = reader->base + FRAMEBUS_HEADER_SIZE + (size_t)slot_index * reader->slot_stride +
+                       (size_t)region.y * src_stride + (size_t)region.x * 4u;
 
-  for (uint32_t y = 0; y < header->height; y++) {
-    memcpy(dst + (size_t)y * dst_stride, src + (size_t)y * row_bytes, row_bytes);
+  if (format == FRAMEBUS_COPY_RGBA8 && region.width == reader->width && dst_stride == src_stride) {
+    memcpy(dst, src, src_stride * region.height);
+  } else {
+    for (uint32_t y = 0; y < region.height; y++) {
+      convert_row(src + (size_t)y * src_stride, dst + (size_t)y * dst_stride, region.width, format);
+    }
   }
 
+  /* Detect a torn read. The writer renders frame N in place in slot
+   * (N - 1) % slot_count as soon as it has committed N - 1, so this slot may
+   * be overwritten once seq reaches seq + slot_count - 1, not only once it is
+   * lapped. */
   const uint64_t seq_after = load_seq(header);
-  if (seq_after >= seq + header->slot_count) {
+  if (seq_after + 1u >= seq + reader->slot_count) {
     return -2;
   }
 
   *last_seq = seq;
   return 1;
 }
+
+int framebus_reader_copy_latest_bgra(framebus_reader_t *reader,
+                                     uint8_t *dst,
+                                     size_t dst_stride,
+                                     uint64_t *last_seq) {
+  return framebus_reader_copy_latest_region(reader, dst, dst_stride, FRAMEBUS_COPY_BGRA8, NULL, last_seq);
+}
+
+int framebus_reader_copy_latest_rgba(framebus_reader_t *reader,
+                                     uint8_t *dst,
+                                     size_t dst_stride,
+                                     uint64_t *last_seq) {
+  return framebus_reader_copy_latest_region(reader, dst, dst_stride, FRAMEBUS_COPY_RGBA8, NULL, last_seq);
+}
@@ -60,14 +60,21 @@ const mockClient = {
   cameraSelect: jest.fn(),
   cameraStart: jest.fn(),
   cameraStop: jest.fn(),
+  cameraMosaic: jest.fn(),
   keyerGet: jest.fn(),
   keyerConfigure: jest.fn(),
   keyerReset: jest.fn(),
+  keyerCapturePlate: jest.fn(),
+  keyerProfile: jest.fn(),
   programGet: jest.fn(),
   programUpdate: jest.fn(),
+  programPatch: jest.fn(),
+  programBatch: jest.fn(),
   framebusStart: jest.fn(),
   framebusStop: jest.fn(),
   framebusConfigure: jest.fn(),
+  diagnosticsThreads: jest.fn(),
+  diagnosticsCapacity: jest.fn(),
   virtualCameraStart: jest.fn(),
   virtualCameraStop: jest.fn(),
   virtualCameraConfigure: jest.fn(),
@@ -222,6 +229,29 @@ describe("meeting-command-handler", () => {
       });
     });
 
+    it("reads the camera mosaic layout", async () => {
+      const layout = {
+        width: 1280,
+        height: 360,
+        columns: 2,
+        rows: 1,
+        meter_height: 6,
+        tiles: [
+          { camera_index: 0, x: 0, y: 0, width: 640, height: 360, audio_level: 0.4 },
+          { camera_index: 2, x: 640, y: 0, width: 640, height: 360, audio_level: 0 },
+        ],
+      };
+      mockClient.cameraMosaic.mockResolvedValue({ ok: true, port: 9124, clients: 1, layout });
+
+      const result = await handleMeetingCommand("meeting_camera_mosaic", {});
+
+      expect(mockClient.cameraMosaic).toHaveBeenCalled();
+      expect(result).toEqual({
+        success: true,
+        data: { ok: true, port: 9124, clients: 1, layout },
+      });
+    });
+
     it("forwards keyer configuration", async () => {
       mockClient.keyerConfigure.mockResolvedValue({ enabled: true });
 
@@ -297,6 +327,66 @@ describe("meeting-command-handler", () => {
       expect(result.success).toBe(true);
     });
 
+    it("forwards chroma key configuration", async () => {
+      mockClient.keyerConfigure.mockResolvedValue({ enabled: true });
+
+      const payload = {
+        enabled: true,
+        model: "chroma_key",
+        chroma_key_color: "#00B140",
+        chroma_tolerance: 0.25,
+        chroma_softness: 0.15,
+        chroma_spill_suppression: 0.6,
+      };
+      const result = await handleMeetingCommand("meeting_keyer_configure", payload);
+
+      expect(mockClient.keyerConfigure).toHaveBeenCalledWith(payload);
+      expect(result.success).toBe(true);
+    });
+
+    it("captures a clean plate and forwards its settings", async () => {
+      mockClient.keyerConfigure.mockResolvedValue({ enabled: true });
+      mockClient.keyerCapturePlate.mockResolvedValue({
+        settings: { model: "clean_plate", clean_plate_revision: 1 },
+      });
+
+      const payload = {
+        enabled: true,
+        model: "clean_plate",
+        clean_plate_threshold: 0.12,
+        clean_plate_softness: 0.08,
+        clean_plate_adaptive: false,
+      };
+      await handleMeetingCommand("meeting_keyer_configure", payload);
+      const result = await handleMeetingCommand("meeting_keyer_capture_plate", {});
+
+      expect(mockClient.keyerConfigure).toHaveBeenCalledWith(payload);
+      expect(mockClient.keyerCapturePlate).toHaveBeenCalledTimes(1);
+      expect(result).toEqual({
+        success: true,
+        data: { settings: { model: "clean_plate", clean_plate_revision: 1 } },
+      });
+    });
+
+    it("starts a keyer operator profile", async () => {
+      mockClient.keyerProfile.mockResolvedValue({
+        started: true,
+        profile: { state: "pending", revision: 1, runs: 30 },
+      });
+
+      const result = await handleMeetingCommand("meeting_keyer_profile", { start: true, runs: 30 });
+
+      expect(mockClient.keyerProfile).toHaveBeenCalledWith({ start: true, runs: 30 });
+      expect(result.success).toBe(true);
+    });
+
+    it("rejects keyer profiles above 200 runs", async () => {
+      await expect(
+        handleMeetingCommand("meeting_keyer_profile", { start: true, runs: 500 }),
+      ).rejects.toThrow("Invalid payload for meeting_keyer_profile");
+      expect(mockClient.keyerProfile).not.toHaveBeenCalled();
+    });
+
     it("rejects invalid keyer configuration", async () => {
       await expect(
         handleMeetingCommand("meeting_keyer_configure", {
@@ -330,6 +420,13 @@ describe("meeting-command-handler", () => {
         }),
       ).rejects.toThrow("Invalid payload for meeting_keyer_configure");
 
+      await expect(
+        handleMeetingCommand("meeting_keyer_configure", {
+          model: "chroma_key",
+          chroma_key_color: "green",
+        }),
+      ).rejects.toThrow("Invalid payload for meeting_keyer_configure");
+
       expect(mockClient.keyerConfigure).not.toHaveBeenCalled();
     });
 
@@ -347,6 +444,101 @@ describe("meeting-command-handler", () => {
       expect(result.success).toBe(true);
     });
 
+    it("patches single program fields", async () => {
+      mockClient.programPatch.mockResolvedValue({ changed: ["x"] });
+
+      const result = await handleMeetingCommand("meeting_program_update", {
+        section: "cornerbug",
+        patch: { x: 0.6 },
+      });
+
+      expect(mockClient.programPatch).toHaveBeenCalledWith("cornerbug", {
+        x: 0.6,
+      });
+      expect(mockClient.programUpdate).not.toHaveBeenCalled();
+      expect(result.success).toBe(true);
+    });
+
+    it("applies batched section updates in one call", async () => {
+      mockClient.programBatch.mockResolvedValue({ field_revision: 7 });
+
+      const result = await handleMeetingCommand("meeting_program_update", {
+        updates: [
+          { section: "speaker_layout", values: { enabled: true, layout: "left" } },
+          { section: "cornerbug", patch: { enabled: false } },
+        ],
+      });
+
+      expect(mockClient.programBatch).toHaveBeenCalledWith([
+        { section: "speaker_layout", values: { enabled: true, layout: "left" } },
+        { section: "cornerbug", patch: { enabled: false } },
+      ]);
+      expect(mockClient.programUpdate).not.toHaveBeenCalled();
+      expect(result.success).toBe(true);
+    });
+
+    it("rejects batches with an invalid entry", async () => {
+      await expect(
+        handleMeetingCommand("meeting_program_update", {
+          updates: [
+            { section: "cornerbug", patch: { x: 0.5 } },
+            { section: "unknown", values: {} },
+          ],
+        }),
+      ).rejects.toThrow("Invalid payload for meeting_program_update");
+      expect(mockClient.programBatch).not.toHaveBeenCalled();
+    });
+
+    it("reads per-role thread CPU usage", async () => {
+      mockClient.diagnosticsThreads.mockResolvedValue({
+        window_ms: 2000,
+        process_cpu_percent: 180,
+        roles: [{ role: "keyer_ort", threads: 4, cpu_percent: 150 }],
+      });
+
+      const result = await handleMeetingCommand("meeting_diagnostics_threads", {});
+
+      expect(mockClient.diagnosticsThreads).toHaveBeenCalled();
+      expect(result).toEqual({
+        success: true,
+        data: {
+          window_ms: 2000,
+          process_cpu_percent: 180,
+          roles: [{ role: "keyer_ort", threads: 4, cpu_percent: 150 }],
+        },
+      });
+    });
+
+    it("starts a capacity benchmark run", async () => {
+      mockClient.diagnosticsCapacity.mockResolvedValue({
+        started: true,
+        running: true,
+        report: null,
+      });
+
+      const result = await handleMeetingCommand("meeting_diagnostics_capacity", {
+        start: true,
+        width: 1920,
+        height: 1080,
+        fps: 60,
+      });
+
+      expect(mockClient.diagnosticsCapacity).toHaveBeenCalledWith({
+        start: true,
+        width: 1920,
+        height: 1080,
+        fps: 60,
+      });
+      expect(result.success).toBe(true);
+    });
+
+    it("rejects capacity runs above 60 fps", async () => {
+      await expect(
+        handleMeetingCommand("meeting_diagnostics_capacity", { start: true, fps: 120 }),
+      ).rejects.toThrow("Invalid payload for meeting_diagnostics_capacity");
+      expect(mockClient.diagnosticsCapacity).not.toHaveBeenCalled();
+    });
+
     it("updates camera render settings", async () => {
       mockClient.programUpdate.mockResolvedValue({ mirror: false });
 
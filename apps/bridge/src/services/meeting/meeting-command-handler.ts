@@ -3,11 +3,14 @@ import {
   EmptyPayloadSchema,
 } from "../relay-command-schemas.js";
 import {
+  MeetingDiagnosticsCapacitySchema,
   MeetingEngineStartSchema,
   MeetingGraphicsConfigureOutputsSchema,
   MeetingKeyerConfigureSchema,
+  MeetingKeyerProfileSchema,
   MeetingOutputConfigureSchema,
   MeetingPassthroughSchema,
+  MeetingProgramGetSchema,
   MeetingProgramUpdateSchema,
   MeetingRecordingStartSchema,
   MeetingCallControlSchema,
@@ -268,6 +271,10 @@ export async function handleMeetingCommand(
       return runMeetingRpc(() => requireClient().cameraAudioLevels());
     }
 
+    case "meeting_camera_mosaic": {
+      return runMeetingRpc(() => requireClient().cameraMosaic());
+    }
+
     case "meeting_camera_auto_director": {
       const options = parseRelayPayload(
         MeetingPassthroughSchema,
@@ -394,9 +401,22 @@ export async function handleMeetingCommand(
       return { success: true, data: await requireClient().keyerReset() };
     }
 
+    case "meeting_keyer_capture_plate": {
+      return { success: true, data: await requireClient().keyerCapturePlate() };
+    }
+
+    case "meeting_keyer_profile": {
+      const params = parseRelayPayload(
+        MeetingKeyerProfileSchema,
+        payload ?? {},
+        "Invalid payload for meeting_keyer_profile",
+      );
+      return { success: true, data: await requireClient().keyerProfile(params) };
+    }
+
     case "meeting_program_get": {
       const { section } = parseRelayPayload(
-        MeetingProgramUpdateSchema.pick({ section: true }),
+        MeetingProgramGetSchema,
         payload ?? {},
         "Invalid payload for meeting_program_get",
       );
@@ -404,14 +424,23 @@ export async function handleMeetingCommand(
     }
 
     case "meeting_program_update": {
-      const { section, values } = parseRelayPayload(
+      const update = parseRelayPayload(
         MeetingProgramUpdateSchema,
         payload ?? {},
         "Invalid payload for meeting_program_update",
       );
+      if ("updates" in update) {
+        return {
+          success: true,
+          data: await requireClient().programBatch(update.updates),
+        };
+      }
+      const { section, values, patch } = update;
       return {
         success: true,
-        data: await requireClient().programUpdate(section, values),
+        data: patch
+          ? await requireClient().programPatch(section, patch)
+          : await requireClient().programUpdate(section, values ?? {}),
       };
     }
 
@@ -446,6 +475,22 @@ export async function handleMeetingCommand(
       };
     }
 
+    case "meeting_diagnostics_threads": {
+      return { success: true, data: await requireClient().diagnosticsThreads() };
+    }
+
+    case "meeting_diagnostics_capacity": {
+      const params = parseRelayPayload(
+        MeetingDiagnosticsCapacitySchema,
+        payload ?? {},
+        "Invalid payload for meeting_diagnostics_capacity",
+      );
+      return {
+        success: true,
+        data: await requireClient().diagnosticsCapacity(params),
+      };
+    }
+
     case "meeting_graphics_configure_outputs": {
       const {
         width = 1280,
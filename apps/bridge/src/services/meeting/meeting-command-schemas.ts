@@ -20,7 +20,9 @@ export const MeetingPassthroughSchema = z.record(z.unknown());
 export const MeetingKeyerConfigureSchema = z
   .object({
     enabled: z.boolean().optional(),
-    model: z.enum(["modnet", "vision_person_segmentation"]).optional(),
+    model: z
+      .enum(["modnet", "vision_person_segmentation", "chroma_key", "clean_plate"])
+      .optional(),
     background_mode: z
       .enum(["transparent", "gradient", "solid_light", "checkerboard"])
       .optional(),
@@ -42,6 +44,18 @@ export const MeetingKeyerConfigureSchema = z
     edge_stabilization_strength: z.number().min(0).max(1).optional(),
     fresh_mask_age_ms: z.number().min(0).max(500).optional(),
     max_mask_age_ms: z.number().min(0).max(2000).optional(),
+    // Green/blue screen keying, used when model is "chroma_key".
+    chroma_key_color: z
+      .string()
+      .regex(/^#[0-9a-fA-F]{6}$/)
+      .optional(),
+    chroma_tolerance: z.number().min(0).max(1).optional(),
+    chroma_softness: z.number().min(0).max(1).optional(),
+    chroma_spill_suppression: z.number().min(0).max(1).optional(),
+    // Locked-off camera keying against a captured plate ("clean_plate").
+    clean_plate_threshold: z.number().min(0).max(1).optional(),
+    clean_plate_softness: z.number().min(0).max(1).optional(),
+    clean_plate_adaptive: z.boolean().optional(),
     // Conference mode: never keys, and lets the native compositor draw content
     // over the un-keyed camera. Forwarded to the helper's keyer.configure.
     conference_mode: z.boolean().optional(),
@@ -55,17 +69,57 @@ export const MeetingKeyerConfigureSchema = z
     "fresh_mask_age_ms must be less than or equal to max_mask_age_ms",
   );
 
-export const MeetingProgramUpdateSchema = z.object({
+const MeetingProgramSectionSchema = z.object({
   section: z.enum(["camera", "cornerbug", "graphics", "speaker_layout", "media_layer"]),
-  values: z.record(z.unknown()),
+  values: z.record(z.unknown()).optional(),
+  patch: z.record(z.unknown()).optional(),
 });
 
+export const MeetingProgramGetSchema = MeetingProgramSectionSchema.pick({ section: true });
+
+// `values` replaces a section; `patch` changes only the listed fields.
+const MeetingProgramSectionUpdateSchema = MeetingProgramSectionSchema.refine(
+  (value) => (value.values === undefined) !== (value.patch === undefined),
+  { message: "Exactly one of values or patch is required" },
+);
+
+// `updates` applies several section updates atomically at one frame boundary.
+export const MeetingProgramUpdateSchema = z.union([
+  MeetingProgramSectionUpdateSchema,
+  z
+    .object({
+      updates: z.array(MeetingProgramSectionUpdateSchema).min(1).max(16),
+    })
+    .strict(),
+]);
+
 export const MeetingOutputConfigureSchema = z.object({
   target: z.enum(["framebus", "virtual_camera"]),
   action: z.enum(["start", "stop", "configure"]),
   settings: z.record(z.unknown()).optional(),
 });
 
+// `start` profiles the next `runs` MODNet inferences; without it the call
+// only reports the latest profile.
+export const MeetingKeyerProfileSchema = z
+  .object({
+    start: z.boolean().optional(),
+    runs: z.number().int().min(1).max(200).optional(),
+  })
+  .strict();
+
+// `start` launches a background run; without it the call only reports the
+// latest result. Geometry defaults to the live output config.
+export const MeetingDiagnosticsCapacitySchema = z
+  .object({
+    start: z.boolean().optional(),
+    width: z.number().int().min(64).max(3840).optional(),
+    height: z.number().int().min(64).max(2160).optional(),
+    fps: z.number().int().min(1).max(60).optional(),
+    iterations: z.number().int().min(1).max(60).optional(),
+  })
+  .strict();
+
 export const MeetingGraphicsConfigureOutputsSchema = z
   .object({
     width: z.number().int().min(160).max(7680).optional(),
@@ -121,6 +121,11 @@ export class MeetingHelperClient {
     return this.rpc("camera.audio_levels", {});
   }
 
+  /** Conference: tile layout + audio levels of the camera mosaic preview. */
+  async cameraMosaic(): Promise<Record<string, unknown>> {
+    return this.rpc("camera.mosaic", {});
+  }
+
   /** Conference auto-director: follow the loudest camera automatically. */
   async cameraAutoDirector(
     options: Record<string, unknown>,
@@ -160,6 +165,19 @@ export class MeetingHelperClient {
     return this.rpc("keyer.reset");
   }
 
+  async keyerCapturePlate(): Promise<Record<string, unknown>> {
+    return this.rpc("keyer.capture_plate");
+  }
+
+  /**
+   * Starts (with `start: true`) or polls an ONNX Runtime operator profile of
+   * the next `runs` MODNet inferences. `profile.state` turns "complete" or
+   * "failed" once the runs are done; the summary is attached when complete.
+   */
+  async keyerProfile(params: Record<string, unknown>): Promise<Record<string, unknown>> {
+    return this.rpc("keyer.profile", params);
+  }
+
   async programGet(
     section: MeetingProgramSectionT,
   ): Promise<Record<string, unknown>> {
@@ -173,6 +191,31 @@ export class MeetingHelperClient {
     return this.rpc("program.update", { section, values });
   }
 
+  /**
+   * Field-level program update: only the listed members change (null removes
+   * one), so live adjustments never re-send embedded images.
+   */
+  async programPatch(
+    section: MeetingProgramSectionT,
+    patch: Record<string, unknown>,
+  ): Promise<Record<string, unknown>> {
+    return this.rpc("program.update", { section, patch });
+  }
+
+  /**
+   * Applies several section updates as one transaction: a single field
+   * revision and re-render, so the program never shows a half-applied scene.
+   */
+  async programBatch(
+    updates: Array<{
+      section: MeetingProgramSectionT;
+      values?: Record<string, unknown>;
+      patch?: Record<string, unknown>;
+    }>,
+  ): Promise<Record<string, unknown>> {
+    return this.rpc("program.update_batch", { updates });
+  }
+
   async framebusStatus(): Promise<Record<string, unknown>> {
     return this.rpc("output.framebus.status");
   }
@@ -183,6 +226,25 @@ export class MeetingHelperClient {
     return this.rpc("output.framebus.configure", settings);
   }
 
+  /**
+   * CPU time per helper thread role (pipeline, keyer, ORT intra-op, MJPEG,
+   * raw frame and control servers, ...) since the previous sample.
+   */
+  async diagnosticsThreads(): Promise<Record<string, unknown>> {
+    return this.rpc("diagnostics.threads");
+  }
+
+  /**
+   * Starts (with `start: true`) or polls the on-box capacity benchmark. Runs
+   * take several seconds, so the call returns at once and `running` tells
+   * whether the attached report is final.
+   */
+  async diagnosticsCapacity(
+    params: Record<string, unknown>,
+  ): Promise<Record<string, unknown>> {
+    return this.rpc("diagnostics.capacity", params);
+  }
+
   async framebusStart(): Promise<Record<string, unknown>> {
     return this.rpc("output.framebus.start");
   }
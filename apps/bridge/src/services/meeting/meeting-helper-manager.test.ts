@@ -3,6 +3,7 @@ import { setBridgeContext } from "../bridge-context.js";
 import {
   __setMeetingHelperPathForTesting,
   findFreePort,
+  findFreePorts,
   MeetingHelperManager,
   resolveMeetingHelperPath,
   resolveMeetingHelperForwardedEnvArgs,
@@ -39,6 +40,12 @@ describe("meeting-helper-manager", () => {
       expect(port).toBeGreaterThan(0);
       expect(port).toBeLessThanOrEqual(65535);
     });
+
+    it("returns distinct ports when several are requested", async () => {
+      const ports = await findFreePorts(3);
+      expect(ports).toHaveLength(3);
+      expect(new Set(ports).size).toBe(3);
+    });
   });
 
   describe("resolveMeetingHelperPath", () => {
@@ -34,6 +34,7 @@ const CAMERA_PERMISSION_COMPLETION_POLL_ATTEMPTS = 120;
 const CAMERA_PERMISSION_COMPLETION_POLL_DELAY_MS = 500;
 const STALE_HELPER_PORT_RELEASE_TIMEOUT_MS = 1000;
 const MEETING_HELPER_FORWARDED_ENV_KEYS = [
+  "BROADIFY_MEETING_CAMERA_PASSTHROUGH",
   "BROADIFY_MEETING_COREML_UNITS",
   "BROADIFY_MEETING_GPU_COMPOSITOR",
   "BROADIFY_MEETING_GPU_COMPOSITOR_D3D11",
@@ -47,7 +48,10 @@ const MEETING_HELPER_FORWARDED_ENV_KEYS = [
   "BROADIFY_MEETING_GUIDED_EPSILON",
   "BROADIFY_MEETING_GUIDED_RADIUS",
   "BROADIFY_MEETING_GUIDED_REFINE",
+  "BROADIFY_MEETING_INCREMENTAL_COMPOSITOR",
   "BROADIFY_MEETING_KEYER_DML_LEGACY",
+  "BROADIFY_MEETING_KEYER_FLOAT_INPUT",
+  "BROADIFY_MEETING_STREAMING_COPY",
 ] as const;
 const MEETING_HELPER_ENV_VALUE_PATTERN = /^[A-Za-z0-9._+-]{1,64}$/;
 
@@ -66,6 +70,7 @@ type MeetingHelperStartOptionsT = {
 type MeetingHelperManagerStatusT = {
   state: MeetingHelperLifecycleStateT;
   port: number | null;
+  mosaicPort: number | null;
   pid: number | null;
   framebusName: string;
   previewPath: string;
@@ -95,6 +100,7 @@ type ReadyEventT = {
   type: "ready";
   framebus?: string;
   preview_port?: number;
+  mosaic_port?: number;
   control_socket?: string;
 };
 
@@ -329,25 +335,51 @@ export function __setMeetingHelperPathForTesting(path: string | null): void {
   testHelperPathOverride = path;
 }
 
-/**
- * Find a free localhost TCP port for the MJPEG preview server.
- */
-export function findFreePort(): Promise<number> {
+function listenOnFreePort(server: net.Server): Promise<number> {
   return new Promise((resolve, reject) => {
-    const server = net.createServer();
     server.once("error", reject);
     server.listen(0, "127.0.0.1", () => {
       const address = server.address();
       if (address && typeof address === "object") {
-        const port = address.port;
-        server.close(() => resolve(port));
+        resolve(address.port);
       } else {
-        server.close(() => reject(new Error("Failed to allocate port")));
+        reject(new Error("Failed to allocate port"));
       }
     });
   });
 }
 
+/**
+ * Find `count` distinct free localhost TCP ports. Each port stays bound until
+ * all of them are allocated, so one call never returns the same port twice.
+ */
+export async function findFreePorts(count: number): Promise<number[]> {
+  const servers: net.Server[] = [];
+  try {
+    const ports: number[] = [];
+    for (let i = 0; i < count; i += 1) {
+      const server = net.createServer();
+      servers.push(server);
+      ports.push(await listenOnFreePort(server));
+    }
+    return ports;
+  } finally {
+    await Promise.all(
+      servers.map(
+        (server) => new Promise<void>((resolve) => server.close(() => resolve())),
+      ),
+    );
+  }
+}
+
+/**
+ * Find a free localhost TCP port for the MJPEG preview server.
+ */
+export async function findFreePort(): Promise<number> {
+  const [port] = await findFreePorts(1);
+  return port;
+}
+
 function sleep(ms: number): Promise<void> {
   return new Promise((resolve) => setTimeout(resolve, ms));
 }
@@ -484,6 +516,7 @@ export class MeetingHelperManager {
   private process: ChildProcess | null = null;
   private client: MeetingHelperClient | null = null;
   private port: number | null = null;
+  private mosaicPort: number | null = null;
   private lastError: string | null = null;
   private statusPollTimer: NodeJS.Timeout | null = null;
   private lastPublishedStatus: string | null = null;
@@ -506,6 +539,7 @@ export class MeetingHelperManager {
     return {
       state: this.state,
       port: this.port,
+      mosaicPort: this.mosaicPort,
       pid: this.process?.pid ?? null,
       framebusName: this.getFramebusName(),
       previewPath: "/preview.mjpg",
@@ -548,6 +582,7 @@ export class MeetingHelperManager {
     this.killProcess();
     this.client = null;
     this.port = null;
+    this.mosaicPort = null;
     this.state = "stopped";
     this.lastRuntimeBackendStatus = null;
     await this.publishStatus("engine_stopped", true);
@@ -636,9 +671,12 @@ export class MeetingHelperManager {
     this.stdoutBuffer = "";
 
     try {
-      const port = await findFreePort();
+      // Allocated together so the preview and mosaic servers cannot be
+      // handed the same port.
+      const [port, mosaicPort] = await findFreePorts(2);
       const controlSocketPath = resolveControlSocketPath();
       this.port = port;
+      this.mosaicPort = mosaicPort;
 
       const width = options.width ?? 1920;
       const height = options.height ?? 1080;
@@ -653,6 +691,8 @@ export class MeetingHelperManager {
         controlSocketPath,
         "--framebus-name",
         this.getFramebusName(),
+        "--mosaic-port",
+        String(mosaicPort),
         "--vcam-frame-port",
         String(DEFAULT_MEETING_VCAM_FRAME_PORT),
         "--width",
@@ -672,6 +712,7 @@ export class MeetingHelperManager {
         MEETING_VCAM_FRAME_PORT: String(DEFAULT_MEETING_VCAM_FRAME_PORT),
         MEETING_CONTROL_SOCKET: controlSocketPath,
         MEETING_PREVIEW_PORT: String(port),
+        MEETING_MOSAIC_PORT: String(mosaicPort),
         MEETING_FRAME_WIDTH: String(width),
         MEETING_FRAME_HEIGHT: String(height),
         MEETING_FRAME_FPS: String(fps),
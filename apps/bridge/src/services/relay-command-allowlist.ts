@@ -32,13 +32,18 @@ export const RELAY_COMMAND_ALLOWLIST = [
   "meeting_camera_program_select",
   "meeting_camera_pip_set",
   "meeting_camera_audio_levels",
+  "meeting_camera_mosaic",
   "meeting_camera_auto_director",
   "meeting_keyer_get",
   "meeting_keyer_configure",
   "meeting_keyer_reset",
+  "meeting_keyer_capture_plate",
+  "meeting_keyer_profile",
   "meeting_program_get",
   "meeting_program_update",
   "meeting_output_configure",
+  "meeting_diagnostics_threads",
+  "meeting_diagnostics_capacity",
   "meeting_graphics_configure_outputs",
   "meeting_recording_microphones",
   "meeting_recording_pick_path",
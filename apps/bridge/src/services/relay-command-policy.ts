@@ -111,13 +111,18 @@ const RELAY_COMMAND_POLICY: Record<RelayCommand, RelayCommandPolicyT> = {
   meeting_camera_program_select: sideEffect("meeting_camera_program_select", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.camera", ["meeting.camera"]),
   meeting_camera_pip_set: sideEffect("meeting_camera_pip_set", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.camera", ["meeting.camera"]),
   meeting_camera_audio_levels: readOnly("meeting_camera_audio_levels", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.camera"]),
+  meeting_camera_mosaic: readOnly("meeting_camera_mosaic", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.camera"]),
   meeting_camera_auto_director: sideEffect("meeting_camera_auto_director", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.camera", ["meeting.camera"]),
   meeting_keyer_get: readOnly("meeting_keyer_get", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.keyer"]),
   meeting_keyer_configure: sideEffect("meeting_keyer_configure", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.keyer", ["meeting.keyer"]),
   meeting_keyer_reset: sideEffect("meeting_keyer_reset", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.keyer", ["meeting.keyer"], "after_state_check"),
+  meeting_keyer_capture_plate: sideEffect("meeting_keyer_capture_plate", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.keyer", ["meeting.keyer"]),
+  meeting_keyer_profile: sideEffect("meeting_keyer_profile", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.keyer", ["meeting.keyer"]),
   meeting_program_get: readOnly("meeting_program_get", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.program"]),
   meeting_program_update: sideEffect("meeting_program_update", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.program", ["meeting.program"]),
   meeting_output_configure: sideEffect("meeting_output_configure", "graphics", 20_000, 16_000, "meeting.graphics", ["meeting.graphics", "outputs"]),
+  meeting_diagnostics_threads: readOnly("meeting_diagnostics_threads", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.diagnostics"]),
+  meeting_diagnostics_capacity: sideEffect("meeting_diagnostics_capacity", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, "meeting.diagnostics", ["meeting.diagnostics"]),
   meeting_graphics_configure_outputs: sideEffect("meeting_graphics_configure_outputs", "graphics", 20_000, 16_000, "meeting.graphics", ["meeting.graphics", "outputs"]),
   meeting_recording_microphones: readOnly("meeting_recording_microphones", "fast", FAST_RELAY_TIMEOUT_MS, FAST_BRIDGE_LOCAL_SLA_MS, ["meeting.recording"]),
   meeting_recording_pick_path: sideEffect("meeting_recording_pick_path", "helper_start", 130_000, 125_000, "meeting.recording.dialog", ["meeting.recording"]),